@@ -0,0 +1,152 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestTemporalPrefetchPipeline.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test of vtkTemporalPrefetchPipeline
+// .SECTION Description
+// Steps a time source forwards and backwards through its time steps and
+// checks that the data of every step is correct, that the next step is
+// read ahead, and that a modified source is executed again.
+
+#include "vtkDataArray.h"
+#include "vtkImageAlgorithm.h"
+#include "vtkImageData.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkTemporalPrefetchPipeline.h"
+
+#define CHECK(b, errors) if(!(b)){ errors++; cerr<<"Error on Line "<<__LINE__<<":"<<endl;}
+
+class TestPrefetchSource : public vtkImageAlgorithm
+{
+public:
+  static TestPrefetchSource *New();
+  vtkTypeMacro(TestPrefetchSource, vtkImageAlgorithm);
+
+  int NumRequestData;
+
+protected:
+  TestPrefetchSource()
+  {
+    this->SetNumberOfInputPorts(0);
+    this->NumRequestData = 0;
+  }
+
+  virtual int RequestInformation(vtkInformation*, vtkInformationVector**,
+                                 vtkInformationVector* outputVector)
+  {
+    vtkInformation* outInfo = outputVector->GetInformationObject(0);
+    double steps[10];
+    for (int i = 0; i < 10; ++i)
+      {
+      steps[i] = i;
+      }
+    double range[2] = { 0, 9 };
+    int extent[6] = { 0, 1, 0, 1, 0, 0 };
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_STEPS(), steps, 10);
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_RANGE(), range, 2);
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent, 6);
+    vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_DOUBLE, 1);
+    return 1;
+  }
+
+  // Fill the image with the requested time. Only the information vector
+  // passed in is used, as the executive requires.
+  virtual int RequestData(vtkInformation*, vtkInformationVector**,
+                          vtkInformationVector* outputVector)
+  {
+    this->NumRequestData++;
+    vtkInformation* outInfo = outputVector->GetInformationObject(0);
+    vtkImageData* output = vtkImageData::GetData(outInfo);
+    double time =
+      outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP());
+    output->SetExtent(
+      outInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()));
+    output->AllocateScalars(VTK_DOUBLE, 1);
+    output->GetPointData()->GetScalars()->FillComponent(0, time);
+    output->GetInformation()->Set(vtkDataObject::DATA_TIME_STEP(), time);
+    return 1;
+  }
+
+private:
+  TestPrefetchSource(const TestPrefetchSource&);  // Not implemented.
+  void operator=(const TestPrefetchSource&);  // Not implemented.
+};
+vtkStandardNewMacro(TestPrefetchSource);
+
+static int CheckTime(TestPrefetchSource* source,
+                     vtkTemporalPrefetchPipeline* exec, double time)
+{
+  exec->SetUpdateTimeStep(0, time);
+  source->Update();
+  vtkImageData* output = source->GetOutput();
+  vtkDataArray* scalars = output->GetPointData()->GetScalars();
+  if (output->GetInformation()->Get(vtkDataObject::DATA_TIME_STEP()) != time ||
+      !scalars || scalars->GetNumberOfTuples() != 4 ||
+      scalars->GetComponent(3, 0) != time)
+    {
+    cerr << "Wrong output for time " << time << endl;
+    return 1;
+    }
+  return 0;
+}
+
+int TestTemporalPrefetchPipeline(int, char*[])
+{
+  int errors = 0;
+
+  vtkNew<TestPrefetchSource> source;
+  vtkNew<vtkTemporalPrefetchPipeline> exec;
+  source->SetExecutive(exec.GetPointer());
+  source->UpdateInformation();
+
+  // Forwards: only the first step is executed on demand, every later one
+  // was read ahead while the previous one was shown.
+  for (int t = 0; t < 5; ++t)
+    {
+    errors += CheckTime(source.GetPointer(), exec.GetPointer(), t);
+    }
+  exec->WaitForPrefetch();
+  CHECK(exec->GetNumberOfCacheHits() == 4, errors);
+  CHECK(exec->GetNumberOfPrefetches() == 5, errors);
+  CHECK(source->NumRequestData == 6, errors);
+
+  // Requesting the same step again is a plain pipeline no-op.
+  errors += CheckTime(source.GetPointer(), exec.GetPointer(), 4);
+  CHECK(source->NumRequestData == 6, errors);
+
+  // Backwards: step 3 was evicted, so it executes and step 2 is read ahead.
+  errors += CheckTime(source.GetPointer(), exec.GetPointer(), 3);
+  errors += CheckTime(source.GetPointer(), exec.GetPointer(), 2);
+  exec->WaitForPrefetch();
+  CHECK(exec->GetNumberOfCacheHits() == 5, errors);
+  CHECK(source->NumRequestData == 9, errors);
+
+  // A modified source must not be served from the cache.
+  source->Modified();
+  errors += CheckTime(source.GetPointer(), exec.GetPointer(), 1);
+  exec->WaitForPrefetch();
+  CHECK(exec->GetNumberOfCacheHits() == 5, errors);
+  CHECK(source->NumRequestData == 11, errors);
+
+  // Without room for a second step nothing is read ahead.
+  exec->SetCacheSize(1);
+  errors += CheckTime(source.GetPointer(), exec.GetPointer(), 5);
+  exec->WaitForPrefetch();
+  CHECK(source->NumRequestData == 12, errors);
+
+  return errors;
+}
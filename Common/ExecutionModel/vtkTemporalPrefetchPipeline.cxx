@@ -0,0 +1,499 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkTemporalPrefetchPipeline.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkTemporalPrefetchPipeline.h"
+
+#include "vtkAlgorithm.h"
+#include "vtkCompositeDataIterator.h"
+#include "vtkCompositeDataSet.h"
+#include "vtkDataObject.h"
+#include "vtkInformation.h"
+#include "vtkInformationExecutivePortKey.h"
+#include "vtkInformationExecutivePortVectorKey.h"
+#include "vtkInformationVector.h"
+#include "vtkMultiThreader.h"
+#include "vtkObjectFactory.h"
+
+#include <algorithm>
+#include <vector>
+
+vtkStandardNewMacro(vtkTemporalPrefetchPipeline);
+
+namespace
+{
+// What a cached time step was produced for. Data is only reused for a
+// request with the same piece and extent.
+struct vtkTemporalPrefetchKey
+{
+  double Time;
+  int Piece;
+  int NumberOfPieces;
+  int GhostLevels;
+  int HasExtent;
+  int Extent[6];
+
+  vtkTemporalPrefetchKey()
+  {
+    this->Time = 0.0;
+    this->Piece = 0;
+    this->NumberOfPieces = 1;
+    this->GhostLevels = 0;
+    this->HasExtent = 0;
+    std::fill(this->Extent, this->Extent + 6, 0);
+  }
+
+  explicit vtkTemporalPrefetchKey(vtkInformation* outInfo)
+  {
+    typedef vtkStreamingDemandDrivenPipeline SDDP;
+    this->Time = outInfo->Get(SDDP::UPDATE_TIME_STEP());
+    this->Piece = outInfo->Get(SDDP::UPDATE_PIECE_NUMBER());
+    this->NumberOfPieces = outInfo->Get(SDDP::UPDATE_NUMBER_OF_PIECES());
+    this->GhostLevels = outInfo->Get(SDDP::UPDATE_NUMBER_OF_GHOST_LEVELS());
+    this->HasExtent = outInfo->Has(SDDP::UPDATE_EXTENT());
+    std::fill(this->Extent, this->Extent + 6, 0);
+    if (this->HasExtent)
+      {
+      outInfo->Get(SDDP::UPDATE_EXTENT(), this->Extent);
+      }
+  }
+
+  bool operator==(const vtkTemporalPrefetchKey& other) const
+  {
+    return this->Time == other.Time &&
+      this->Piece == other.Piece &&
+      this->NumberOfPieces == other.NumberOfPieces &&
+      this->GhostLevels == other.GhostLevels &&
+      this->HasExtent == other.HasExtent &&
+      std::equal(this->Extent, this->Extent + 6, other.Extent);
+  }
+};
+
+struct vtkTemporalPrefetchEntry
+{
+  vtkTemporalPrefetchKey Key;
+  // Algorithm modification time the data was computed for.
+  unsigned long MTime;
+  // Larger is more recently used.
+  unsigned long LastUse;
+  vtkDataObject* Data;
+};
+
+// Shallow copy that also gives the destination its own leaf data objects,
+// so that neither side sees arrays added to or removed from the other's
+// blocks.
+void vtkTemporalPrefetchCopy(vtkDataObject* dst, vtkDataObject* src)
+{
+  dst->ShallowCopy(src);
+  vtkCompositeDataSet* cds = vtkCompositeDataSet::SafeDownCast(dst);
+  if (!cds)
+    {
+    return;
+    }
+  vtkCompositeDataIterator* iter = cds->NewIterator();
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+    vtkDataObject* leaf = iter->GetCurrentDataObject();
+    vtkDataObject* clone = leaf->NewInstance();
+    clone->ShallowCopy(leaf);
+    cds->SetDataSet(iter, clone);
+    clone->FastDelete();
+    }
+  iter->Delete();
+}
+}
+
+//----------------------------------------------------------------------------
+class vtkTemporalPrefetchPipelineInternals
+{
+public:
+  std::vector<vtkTemporalPrefetchEntry> Entries;
+  unsigned long UseCounter;
+
+  // The previously produced time, used to predict the direction of play.
+  int HasLastTime;
+  double LastTime;
+
+  // State of the pending prefetch. Only the background thread touches
+  // these between the spawn and the join.
+  vtkAlgorithm* Algorithm;
+  vtkInformation* Request;
+  vtkInformationVector** InInfoVec;
+  vtkInformationVector* OutInfoVec;
+  vtkTemporalPrefetchKey Key;
+  unsigned long MTime;
+  int Result;
+
+  vtkTemporalPrefetchPipelineInternals()
+  {
+    this->UseCounter = 0;
+    this->HasLastTime = 0;
+    this->LastTime = 0.0;
+    this->Algorithm = 0;
+    this->Request = 0;
+    this->InInfoVec = 0;
+    this->OutInfoVec = 0;
+    this->MTime = 0;
+    this->Result = 0;
+  }
+
+  vtkTemporalPrefetchEntry* Find(const vtkTemporalPrefetchKey& key,
+                                 unsigned long mtime)
+  {
+    for (size_t i = 0; i < this->Entries.size(); ++i)
+      {
+      if (this->Entries[i].MTime == mtime && this->Entries[i].Key == key)
+        {
+        return &this->Entries[i];
+        }
+      }
+    return 0;
+  }
+
+  void Insert(const vtkTemporalPrefetchKey& key, unsigned long mtime,
+              vtkDataObject* data, int capacity)
+  {
+    vtkTemporalPrefetchEntry entry;
+    entry.Key = key;
+    entry.MTime = mtime;
+    entry.LastUse = ++this->UseCounter;
+    entry.Data = data;
+    data->Register(0);
+    this->Entries.push_back(entry);
+    this->Shrink(capacity, mtime);
+  }
+
+  // Drop stale entries, then the least recently used ones until at most
+  // capacity remain.
+  void Shrink(int capacity, unsigned long mtime)
+  {
+    for (size_t i = 0; i < this->Entries.size();)
+      {
+      if (this->Entries[i].MTime != mtime)
+        {
+        this->Erase(i);
+        }
+      else
+        {
+        ++i;
+        }
+      }
+    while (static_cast<int>(this->Entries.size()) > capacity)
+      {
+      size_t oldest = 0;
+      for (size_t i = 1; i < this->Entries.size(); ++i)
+        {
+        if (this->Entries[i].LastUse < this->Entries[oldest].LastUse)
+          {
+          oldest = i;
+          }
+        }
+      this->Erase(oldest);
+      }
+  }
+
+  void Erase(size_t i)
+  {
+    this->Entries[i].Data->UnRegister(0);
+    this->Entries.erase(this->Entries.begin() + i);
+  }
+
+  void Clear()
+  {
+    while (!this->Entries.empty())
+      {
+      this->Erase(this->Entries.size() - 1);
+      }
+  }
+
+  void ReleasePrefetch()
+  {
+    if (this->Request)
+      {
+      this->Request->Delete();
+      this->Request = 0;
+      }
+    if (this->OutInfoVec)
+      {
+      this->OutInfoVec->Delete();
+      this->OutInfoVec = 0;
+      }
+    this->Algorithm = 0;
+    this->InInfoVec = 0;
+  }
+};
+
+//----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkTemporalPrefetchPipelineThread(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkTemporalPrefetchPipelineInternals* self =
+    static_cast<vtkTemporalPrefetchPipelineInternals*>(info->UserData);
+  self->Result = self->Algorithm->ProcessRequest(
+    self->Request, self->InInfoVec, self->OutInfoVec);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+vtkTemporalPrefetchPipeline::vtkTemporalPrefetchPipeline()
+{
+  this->CacheSize = 2;
+  this->Prefetch = 1;
+  this->NumberOfCacheHits = 0;
+  this->NumberOfPrefetches = 0;
+  this->Threader = vtkMultiThreader::New();
+  this->ThreadId = -1;
+  this->Internals = new vtkTemporalPrefetchPipelineInternals;
+}
+
+//----------------------------------------------------------------------------
+vtkTemporalPrefetchPipeline::~vtkTemporalPrefetchPipeline()
+{
+  this->WaitForPrefetch();
+  this->Internals->Clear();
+  delete this->Internals;
+  this->Threader->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkTemporalPrefetchPipeline::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "CacheSize: " << this->CacheSize << "\n";
+  os << indent << "Prefetch: " << this->Prefetch << "\n";
+  os << indent << "NumberOfCacheHits: " << this->NumberOfCacheHits << "\n";
+  os << indent << "NumberOfPrefetches: " << this->NumberOfPrefetches << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkTemporalPrefetchPipeline::SetCacheSize(int size)
+{
+  size = size < 0 ? 0 : size;
+  if (size == this->CacheSize)
+    {
+    return;
+    }
+  this->WaitForPrefetch();
+  this->CacheSize = size;
+  if (this->Algorithm)
+    {
+    this->Internals->Shrink(size, this->Algorithm->GetMTime());
+    }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkTemporalPrefetchPipeline::ClearCache()
+{
+  this->WaitForPrefetch();
+  this->Internals->Clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkTemporalPrefetchPipeline::WaitForPrefetch()
+{
+  this->JoinPrefetchThread();
+  if (!this->Internals->Request)
+    {
+    return;
+    }
+
+  // Keep the result only if the algorithm was not modified meanwhile.
+  vtkTemporalPrefetchPipelineInternals* internals = this->Internals;
+  vtkInformation* outInfo = internals->OutInfoVec->GetInformationObject(0);
+  vtkDataObject* data = outInfo->Get(vtkDataObject::DATA_OBJECT());
+  if (internals->Result && data && this->Algorithm &&
+      internals->MTime == this->Algorithm->GetMTime() &&
+      !internals->Find(internals->Key, internals->MTime))
+    {
+    internals->Insert(internals->Key, internals->MTime, data,
+                      this->CacheSize);
+    }
+  internals->ReleasePrefetch();
+}
+
+//----------------------------------------------------------------------------
+void vtkTemporalPrefetchPipeline::JoinPrefetchThread()
+{
+  if (this->ThreadId >= 0)
+    {
+    this->Threader->TerminateThread(this->ThreadId);
+    this->ThreadId = -1;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkTemporalPrefetchPipeline::ReportReferences(vtkGarbageCollector* collector)
+{
+  // Only join here; the result is moved into the cache on the next
+  // request, outside of the collection.
+  this->JoinPrefetchThread();
+  this->Superclass::ReportReferences(collector);
+}
+
+//----------------------------------------------------------------------------
+int vtkTemporalPrefetchPipeline::CallAlgorithm(vtkInformation* request,
+                                               int direction,
+                                               vtkInformationVector** inInfo,
+                                               vtkInformationVector* outInfo)
+{
+  // The algorithm must never run on two threads at once.
+  this->WaitForPrefetch();
+  return this->Superclass::CallAlgorithm(request, direction, inInfo, outInfo);
+}
+
+//----------------------------------------------------------------------------
+int vtkTemporalPrefetchPipeline::CanPrefetch()
+{
+  return this->Algorithm &&
+    this->Algorithm->GetNumberOfInputPorts() == 0 &&
+    this->Algorithm->GetNumberOfOutputPorts() == 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkTemporalPrefetchPipeline::ExecuteData(vtkInformation* request,
+                                             vtkInformationVector** inInfoVec,
+                                             vtkInformationVector* outInfoVec)
+{
+  vtkInformation* outInfo = outInfoVec->GetInformationObject(0);
+  if (!this->CanPrefetch() || this->CacheSize < 1 || this->ContinueExecuting ||
+      !outInfo || !outInfo->Has(UPDATE_TIME_STEP()))
+    {
+    return this->Superclass::ExecuteData(request, inInfoVec, outInfoVec);
+    }
+
+  this->WaitForPrefetch();
+
+  vtkTemporalPrefetchPipelineInternals* internals = this->Internals;
+  vtkTemporalPrefetchKey key(outInfo);
+  unsigned long mtime = this->Algorithm->GetMTime();
+  internals->Shrink(this->CacheSize, mtime);
+
+  vtkDataObject* output = outInfo->Get(vtkDataObject::DATA_OBJECT());
+  vtkTemporalPrefetchEntry* entry = internals->Find(key, mtime);
+  int result = 1;
+  if (entry && output && output->IsA(entry->Data->GetClassName()))
+    {
+    // Serve the request from the cache. The start and end steps still run
+    // so that events and the output information look like an execution.
+    this->ExecuteDataStart(request, inInfoVec, outInfoVec);
+    if (!outInfo->Get(DATA_NOT_GENERATED()))
+      {
+      vtkTemporalPrefetchCopy(output, entry->Data);
+      output->GetInformation()->Set(vtkDataObject::DATA_TIME_STEP(),
+                                    key.Time);
+      }
+    this->ExecuteDataEnd(request, inInfoVec, outInfoVec);
+    entry->LastUse = ++internals->UseCounter;
+    this->NumberOfCacheHits++;
+    }
+  else
+    {
+    result = this->Superclass::ExecuteData(request, inInfoVec, outInfoVec);
+    output = outInfo->Get(vtkDataObject::DATA_OBJECT());
+    if (result && output && !request->Get(CONTINUE_EXECUTING()))
+      {
+      vtkDataObject* copy = output->NewInstance();
+      vtkTemporalPrefetchCopy(copy, output);
+      // RequestData may touch the algorithm's modification time.
+      mtime = this->Algorithm->GetMTime();
+      internals->Insert(key, mtime, copy, this->CacheSize);
+      copy->Delete();
+      }
+    }
+
+  if (result)
+    {
+    this->StartPrefetch(request, outInfoVec);
+    }
+  return result;
+}
+
+//----------------------------------------------------------------------------
+void vtkTemporalPrefetchPipeline::StartPrefetch(vtkInformation* request,
+                                                vtkInformationVector* outInfoVec)
+{
+  vtkTemporalPrefetchPipelineInternals* internals = this->Internals;
+  vtkInformation* outInfo = outInfoVec->GetInformationObject(0);
+  vtkDataObject* output = outInfo->Get(vtkDataObject::DATA_OBJECT());
+  double time = outInfo->Get(UPDATE_TIME_STEP());
+
+  // Play continues backwards only if the last change of time was backwards.
+  int direction = 1;
+  if (internals->HasLastTime && time < internals->LastTime)
+    {
+    direction = -1;
+    }
+  if (!internals->HasLastTime || time != internals->LastTime)
+    {
+    internals->HasLastTime = 1;
+    internals->LastTime = time;
+    }
+
+  int numSteps = outInfo->Length(TIME_STEPS());
+  if (!this->Prefetch || this->CacheSize < 2 || numSteps < 2 || !output)
+    {
+    return;
+    }
+
+  // The step being shown is the last one not after the requested time.
+  double* steps = outInfo->Get(TIME_STEPS());
+  int index = static_cast<int>(
+    std::upper_bound(steps, steps + numSteps, time) - steps) - 1;
+  int next = index + direction;
+  if (index < 0 || next < 0 || next >= numSteps)
+    {
+    return;
+    }
+
+  vtkTemporalPrefetchKey key(outInfo);
+  key.Time = steps[next];
+  unsigned long mtime = this->Algorithm->GetMTime();
+  if (internals->Find(key, mtime))
+    {
+    return;
+    }
+
+  // The background request works on private copies. The references to
+  // the executives are dropped so that the copies do not hold the
+  // pipeline alive.
+  internals->Request = vtkInformation::New();
+  internals->Request->Copy(request, 1);
+  // Request keys are not copied.
+  internals->Request->Set(REQUEST_DATA());
+  internals->OutInfoVec = vtkInformationVector::New();
+  internals->OutInfoVec->Copy(outInfoVec, 1);
+  vtkInformation* prefetchInfo = internals->OutInfoVec->GetInformationObject(0);
+  PRODUCER()->Remove(prefetchInfo);
+  CONSUMERS()->Remove(prefetchInfo);
+  prefetchInfo->Set(UPDATE_TIME_STEP(), key.Time);
+  vtkDataObject* data = output->NewInstance();
+  data->CopyInformationFromPipeline(prefetchInfo);
+  prefetchInfo->Set(vtkDataObject::DATA_OBJECT(), data);
+  data->Delete();
+
+  internals->Algorithm = this->Algorithm;
+  internals->InInfoVec = this->GetInputInformation();
+  internals->Key = key;
+  internals->MTime = mtime;
+  internals->Result = 0;
+
+  this->NumberOfPrefetches++;
+  this->ThreadId = this->Threader->SpawnThread(
+    vtkTemporalPrefetchPipelineThread, internals);
+  if (this->ThreadId < 0)
+    {
+    internals->ReleasePrefetch();
+    }
+}
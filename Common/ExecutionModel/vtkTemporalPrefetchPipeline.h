@@ -0,0 +1,136 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkTemporalPrefetchPipeline.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkTemporalPrefetchPipeline - Executive that reads the next time step ahead
+// .SECTION Description
+// vtkTemporalPrefetchPipeline is an executive for time-aware sources such
+// as readers. After every REQUEST_DATA that honored an UPDATE_TIME_STEP it
+// predicts the next time step from the TIME_STEPS key, continuing in the
+// direction of the last two requests, and executes the algorithm for that
+// time on a background thread. The result, together with the data of the
+// most recent requests, is kept in a cache of CacheSize time steps. When a
+// later request asks for a cached time step with the same piece, number of
+// pieces, ghost levels and update extent, the cached data is shallow-copied
+// into the output instead of executing the algorithm.
+//
+// The executive only prefetches for algorithms with no input ports and a
+// single output port. For other algorithms it behaves like
+// vtkCompositeDataPipeline.
+//
+// .SECTION Caveats
+// The background execution calls the algorithm's ProcessRequest() with
+// private copies of the request and output information, so the algorithm
+// must work only from the information vectors it is given. Progress and
+// other events fired during a prefetch are invoked from the background
+// thread. Every request made by this executive on the algorithm first
+// waits for a pending prefetch, but the algorithm must not be modified
+// through its own API while a prefetch may be running; call
+// WaitForPrefetch() first. Data computed before the last modification of
+// the algorithm is never returned from the cache.
+//
+// .SECTION See Also
+// vtkCachedStreamingDemandDrivenPipeline vtkTemporalDataSetCache
+
+#ifndef vtkTemporalPrefetchPipeline_h
+#define vtkTemporalPrefetchPipeline_h
+
+#include "vtkCommonExecutionModelModule.h" // For export macro
+#include "vtkCompositeDataPipeline.h"
+
+class vtkMultiThreader;
+class vtkTemporalPrefetchPipelineInternals;
+
+class VTKCOMMONEXECUTIONMODEL_EXPORT vtkTemporalPrefetchPipeline :
+  public vtkCompositeDataPipeline
+{
+public:
+  static vtkTemporalPrefetchPipeline* New();
+  vtkTypeMacro(vtkTemporalPrefetchPipeline, vtkCompositeDataPipeline);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // The maximum number of time steps kept in memory, including the one
+  // being prefetched. It defaults to 2. A size below 2 disables
+  // prefetching.
+  void SetCacheSize(int size);
+  vtkGetMacro(CacheSize, int);
+
+  // Description:
+  // Turn prefetching of the next time step on or off. On by default.
+  // When off, the cache still serves time steps requested again.
+  vtkSetMacro(Prefetch, int);
+  vtkGetMacro(Prefetch, int);
+  vtkBooleanMacro(Prefetch, int);
+
+  // Description:
+  // Block until a pending prefetch has finished. Call this before
+  // modifying the algorithm directly.
+  void WaitForPrefetch();
+
+  // Description:
+  // Drop all cached time steps.
+  void ClearCache();
+
+  // Description:
+  // The number of requests served from the cache and the number of time
+  // steps executed in the background since the executive was created.
+  vtkGetMacro(NumberOfCacheHits, int);
+  vtkGetMacro(NumberOfPrefetches, int);
+
+protected:
+  vtkTemporalPrefetchPipeline();
+  ~vtkTemporalPrefetchPipeline();
+
+  virtual int ExecuteData(vtkInformation* request,
+                          vtkInformationVector** inInfoVec,
+                          vtkInformationVector* outInfoVec);
+  virtual int CallAlgorithm(vtkInformation* request, int direction,
+                            vtkInformationVector** inInfo,
+                            vtkInformationVector* outInfo);
+
+  // Garbage collection support. A pending prefetch is waited for before
+  // references are reported so the collector never breaks a reference the
+  // background thread is using.
+  virtual void ReportReferences(vtkGarbageCollector*);
+
+  // Description:
+  // Wait for the background thread without touching the cache.
+  void JoinPrefetchThread();
+
+  // Description:
+  // Returns true if the algorithm is a source with a single output.
+  int CanPrefetch();
+
+  // Description:
+  // Start executing the time step following the one requested in
+  // outInfoVec on the background thread, unless it is already cached.
+  void StartPrefetch(vtkInformation* request,
+                     vtkInformationVector* outInfoVec);
+
+  int CacheSize;
+  int Prefetch;
+  int NumberOfCacheHits;
+  int NumberOfPrefetches;
+
+  vtkMultiThreader* Threader;
+  int ThreadId;
+
+private:
+  vtkTemporalPrefetchPipelineInternals* Internals;
+
+  vtkTemporalPrefetchPipeline(const vtkTemporalPrefetchPipeline&);  // Not implemented.
+  void operator=(const vtkTemporalPrefetchPipeline&);  // Not implemented.
+};
+
+#endif
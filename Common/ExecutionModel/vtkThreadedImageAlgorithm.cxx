@@ -23,14 +23,25 @@
 #include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
+// The initial EnableSMP of new filters
+static bool vtkThreadedImageAlgorithmGlobalDefaultEnableSMP = false;
 
 //----------------------------------------------------------------------------
 vtkThreadedImageAlgorithm::vtkThreadedImageAlgorithm()
 {
   this->Threader = vtkMultiThreader::New();
   this->NumberOfThreads = this->Threader->GetNumberOfThreads();
+
+  this->EnableSMP = vtkThreadedImageAlgorithmGlobalDefaultEnableSMP;
+  this->SplitMode = SLAB;
+  this->MinimumPieceSize[0] = 16;
+  this->MinimumPieceSize[1] = 1;
+  this->MinimumPieceSize[2] = 1;
+  this->DesiredBytesPerPiece = 65536;
 }
 
 //----------------------------------------------------------------------------
@@ -45,6 +56,26 @@ void vtkThreadedImageAlgorithm::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "EnableSMP: " << (this->EnableSMP ? "On\n" : "Off\n");
+  os << indent << "SplitMode: "
+     << (this->SplitMode == SLAB ? "Slab\n" :
+         (this->SplitMode == BEAM ? "Beam\n" : "Block\n"));
+  os << indent << "MinimumPieceSize: " << this->MinimumPieceSize[0] << " "
+     << this->MinimumPieceSize[1] << " " << this->MinimumPieceSize[2] << "\n";
+  os << indent << "DesiredBytesPerPiece: "
+     << this->DesiredBytesPerPiece << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkThreadedImageAlgorithm::SetGlobalDefaultEnableSMP(bool enable)
+{
+  vtkThreadedImageAlgorithmGlobalDefaultEnableSMP = enable;
+}
+
+//----------------------------------------------------------------------------
+bool vtkThreadedImageAlgorithm::GetGlobalDefaultEnableSMP()
+{
+  return vtkThreadedImageAlgorithmGlobalDefaultEnableSMP;
 }
 
 struct vtkImageThreadStruct
@@ -79,6 +110,11 @@ int vtkThreadedImageAlgorithm::SplitExtent(int splitExt[6],
   // start with same extent
   memcpy(splitExt, startExt, 6 * sizeof(int));
 
+  if (this->SplitMode != SLAB)
+    {
+    return this->SplitExtentIntoBlocks(splitExt, startExt, num, total);
+    }
+
   splitAxis = 2;
   min = startExt[4];
   max = startExt[5];
@@ -120,23 +156,90 @@ int vtkThreadedImageAlgorithm::SplitExtent(int splitExt[6],
   return maxThreadIdUsed + 1;
 }
 
-
-// this mess is really a simple function. All it does is call
-// the ThreadedExecute method after setting the correct
-// extent for this thread. Its just a pain to calculate
-// the correct extent.
-static VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmThreadedExecute( void *arg )
+//----------------------------------------------------------------------------
+// Split into a grid of blocks for the BEAM and BLOCK modes. The number of
+// divisions along an axis is raised one at a time on the axis with the
+// longest pieces, as long as the pieces stay at least MinimumPieceSize and
+// the total stays at most total.
+int vtkThreadedImageAlgorithm::SplitExtentIntoBlocks(int splitExt[6],
+                                                     int startExt[6],
+                                                     int num, int total)
 {
-  vtkImageThreadStruct *str;
-  int ext[6], splitExt[6], total;
-  int threadId, threadCount;
+  int firstAxis = (this->SplitMode == BEAM ? 1 : 0);
+  int size[3];
+  int divs[3];
+  int maxDivs[3];
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    size[axis] = startExt[2*axis + 1] - startExt[2*axis] + 1;
+    if (size[axis] <= 0)
+      {
+      // empty extent so cannot split
+      return 1;
+      }
+    int minSize =
+      (this->MinimumPieceSize[axis] > 1 ? this->MinimumPieceSize[axis] : 1);
+    divs[axis] = 1;
+    maxDivs[axis] = (axis < firstAxis ? 1 : size[axis]/minSize);
+    }
 
-  threadId = static_cast<vtkMultiThreader::ThreadInfo *>(arg)->ThreadID;
-  threadCount = static_cast<vtkMultiThreader::ThreadInfo *>(arg)->NumberOfThreads;
+  int count = 1;
+  for (;;)
+    {
+    int bestAxis = -1;
+    double bestLength = 0.0;
+    for (int axis = 2; axis >= firstAxis; --axis)
+      {
+      double length = static_cast<double>(size[axis])/divs[axis];
+      if (divs[axis] < maxDivs[axis] &&
+          count/divs[axis]*(divs[axis] + 1) <= total &&
+          length > bestLength)
+        {
+        bestAxis = axis;
+        bestLength = length;
+        }
+      }
+    if (bestAxis < 0)
+      {
+      break;
+      }
+    count = count/divs[bestAxis]*(divs[bestAxis] + 1);
+    divs[bestAxis]++;
+    }
 
-  str = static_cast<vtkImageThreadStruct *>
-    (static_cast<vtkMultiThreader::ThreadInfo *>(arg)->UserData);
+  if (num >= count)
+    {
+    return count;
+    }
+
+  // X varies fastest over the pieces
+  int idx[3];
+  idx[0] = num % divs[0];
+  idx[1] = (num / divs[0]) % divs[1];
+  idx[2] = num / (divs[0]*divs[1]);
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    vtkIdType n = size[axis];
+    splitExt[2*axis] = startExt[2*axis] +
+      static_cast<int>(n*idx[axis]/divs[axis]);
+    splitExt[2*axis + 1] = startExt[2*axis] - 1 +
+      static_cast<int>(n*(idx[axis] + 1)/divs[axis]);
+    }
+
+  vtkDebugMacro("  Split Piece: ( " <<splitExt[0]<< ", " <<splitExt[1]<< ", "
+                << splitExt[2] << ", " << splitExt[3] << ", "
+                << splitExt[4] << ", " << splitExt[5] << ")");
+
+  return count;
+}
 
+//----------------------------------------------------------------------------
+// Get the extent that the threads split: the update extent of the output
+// port that made the request, or of the first connected input if the
+// filter has no outputs.
+static bool vtkThreadedImageAlgorithmGetExtent(vtkImageThreadStruct *str,
+                                               int ext[6])
+{
   // if we have an output
   if (str->Filter->GetNumberOfOutputPorts())
     {
@@ -148,7 +251,7 @@ static VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmThreadedExecute( void *ar
     // update directly, for now an error
     if (outputPort == -1)
       {
-      return VTK_THREAD_RETURN_VALUE;
+      return false;
       }
 
     // get the update extent from the output port
@@ -158,31 +261,46 @@ static VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmThreadedExecute( void *ar
     outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(),
                  updateExtent);
     memcpy(ext,updateExtent, sizeof(int)*6);
+    return true;
     }
-  else
+
+  // if there is no output, then use UE from input, use the first input
+  for (int inPort = 0; inPort < str->Filter->GetNumberOfInputPorts(); ++inPort)
     {
-    // if there is no output, then use UE from input, use the first input
-    int inPort;
-    bool found = false;
-    for (inPort = 0; inPort < str->Filter->GetNumberOfInputPorts(); ++inPort)
+    if (str->Filter->GetNumberOfInputConnections(inPort))
       {
-      if (str->Filter->GetNumberOfInputConnections(inPort))
-        {
-        int updateExtent[6];
-        str->InputsInfo[inPort]
-          ->GetInformationObject(0)
-          ->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(),
-                updateExtent);
-        memcpy(ext,updateExtent, sizeof(int)*6);
-        found = true;
-        break;
-        }
-      }
-    if (!found)
-      {
-      return VTK_THREAD_RETURN_VALUE;
+      int updateExtent[6];
+      str->InputsInfo[inPort]
+        ->GetInformationObject(0)
+        ->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(),
+              updateExtent);
+      memcpy(ext,updateExtent, sizeof(int)*6);
+      return true;
       }
     }
+  return false;
+}
+
+// this mess is really a simple function. All it does is call
+// the ThreadedExecute method after setting the correct
+// extent for this thread. Its just a pain to calculate
+// the correct extent.
+static VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmThreadedExecute( void *arg )
+{
+  vtkImageThreadStruct *str;
+  int ext[6], splitExt[6], total;
+  int threadId, threadCount;
+
+  threadId = static_cast<vtkMultiThreader::ThreadInfo *>(arg)->ThreadID;
+  threadCount = static_cast<vtkMultiThreader::ThreadInfo *>(arg)->NumberOfThreads;
+
+  str = static_cast<vtkImageThreadStruct *>
+    (static_cast<vtkMultiThreader::ThreadInfo *>(arg)->UserData);
+
+  if (!vtkThreadedImageAlgorithmGetExtent(str, ext))
+    {
+    return VTK_THREAD_RETURN_VALUE;
+    }
 
   // execute the actual method with appropriate extent
   // first find out how many pieces extent can be split into.
@@ -285,13 +403,24 @@ int vtkThreadedImageAlgorithm::RequestData(
     this->CopyAttributeData(str.Inputs[0][0],str.Outputs[0],inputVector);
     }
 
-  this->Threader->SetNumberOfThreads(this->NumberOfThreads);
-  this->Threader->SetSingleMethod(vtkThreadedImageAlgorithmThreadedExecute, &str);
-
   // always shut off debugging to avoid threading problems with GetMacros
   bool debug = this->Debug;
   this->Debug = false;
-  this->Threader->SingleMethodExecute();
+  if (this->EnableSMP)
+    {
+    int ext[6];
+    if (vtkThreadedImageAlgorithmGetExtent(&str, ext))
+      {
+      this->SMPRequestData(request, inputVector, outputVector,
+                           str.Inputs, str.Outputs, ext);
+      }
+    }
+  else
+    {
+    this->Threader->SetNumberOfThreads(this->NumberOfThreads);
+    this->Threader->SetSingleMethod(vtkThreadedImageAlgorithmThreadedExecute, &str);
+    this->Threader->SingleMethodExecute();
+    }
   this->Debug = debug;
 
   // free up the arrays
@@ -305,6 +434,138 @@ int vtkThreadedImageAlgorithm::RequestData(
   return 1;
 }
 
+//----------------------------------------------------------------------------
+// Runs the pieces of an extent through ThreadedRequestData. Every worker
+// thread of the SMP backend takes the next free thread id when it starts.
+class vtkThreadedImageAlgorithmFunctor
+{
+public:
+  vtkThreadedImageAlgorithmFunctor(vtkThreadedImageAlgorithm *algo,
+                                   vtkInformation *request,
+                                   vtkInformationVector **inputVector,
+                                   vtkInformationVector *outputVector,
+                                   vtkImageData ***inData,
+                                   vtkImageData **outData,
+                                   int extent[6], int numberOfPieces)
+    : Algorithm(algo), Request(request), InputsInfo(inputVector),
+      OutputsInfo(outputVector), Inputs(inData), Outputs(outData),
+      NumberOfPieces(numberOfPieces)
+  {
+    memcpy(this->Extent, extent, sizeof(int)*6);
+    this->NextThreadId = 0;
+  }
+
+  void Initialize()
+  {
+    this->ThreadId.Local() = ++this->NextThreadId - 1;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int threadId = this->ThreadId.Local();
+    for (vtkIdType piece = begin; piece < end; ++piece)
+      {
+      int splitExt[6];
+      this->Algorithm->SplitExtent(splitExt, this->Extent,
+                                   static_cast<int>(piece),
+                                   this->NumberOfPieces);
+      // skip empty pieces
+      if (splitExt[1] < splitExt[0] ||
+          splitExt[3] < splitExt[2] ||
+          splitExt[5] < splitExt[4])
+        {
+        continue;
+        }
+      this->Algorithm->ThreadedRequestData(this->Request,
+                                           this->InputsInfo, this->OutputsInfo,
+                                           this->Inputs, this->Outputs,
+                                           splitExt, threadId);
+      }
+  }
+
+  void Reduce()
+  {
+  }
+
+protected:
+  vtkThreadedImageAlgorithm *Algorithm;
+  vtkInformation *Request;
+  vtkInformationVector **InputsInfo;
+  vtkInformationVector *OutputsInfo;
+  vtkImageData ***Inputs;
+  vtkImageData **Outputs;
+  int Extent[6];
+  int NumberOfPieces;
+  vtkAtomicInt<int> NextThreadId;
+  vtkSMPThreadLocal<int> ThreadId;
+
+private:
+  vtkThreadedImageAlgorithmFunctor(const vtkThreadedImageAlgorithmFunctor&);  // Not implemented.
+  void operator=(const vtkThreadedImageAlgorithmFunctor&);  // Not implemented.
+};
+
+//----------------------------------------------------------------------------
+void vtkThreadedImageAlgorithm::SMPRequestData(
+  vtkInformation *request,
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector,
+  vtkImageData ***inData,
+  vtkImageData **outData,
+  int extent[6])
+{
+  // the bytes per voxel of the data that is split
+  vtkImageData *image = (outData ? outData[0] : 0);
+  if (!image && inData && inData[0])
+    {
+    image = inData[0][0];
+    }
+  vtkIdType bytesPerVoxel = 1;
+  if (image)
+    {
+    bytesPerVoxel = image->GetScalarSize()*
+      image->GetNumberOfScalarComponents();
+    }
+
+  vtkIdType voxels = 1;
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    voxels *= (extent[2*axis + 1] >= extent[2*axis] ?
+               extent[2*axis + 1] - extent[2*axis] + 1 : 0);
+    }
+  if (voxels == 0)
+    {
+    return;
+    }
+
+  vtkIdType pieces = voxels*bytesPerVoxel/this->DesiredBytesPerPiece;
+  if (this->SplitMode == SLAB)
+    {
+    // slabs along the outermost axis that can be split
+    int axis = 2;
+    while (axis > 0 && extent[2*axis] == extent[2*axis + 1])
+      {
+      --axis;
+      }
+    int minSize = (this->MinimumPieceSize[axis] > 1 ?
+                   this->MinimumPieceSize[axis] : 1);
+    vtkIdType maxPieces = (extent[2*axis + 1] - extent[2*axis] + 1)/minSize;
+    pieces = (pieces < maxPieces ? pieces : maxPieces);
+    }
+  pieces = (pieces < VTK_INT_MAX ? pieces : VTK_INT_MAX);
+  pieces = (pieces > 1 ? pieces : 1);
+
+  // ask for the number of pieces that the extent really splits into
+  int splitExt[6];
+  int total = static_cast<int>(pieces);
+  int numberOfPieces = this->SplitExtent(splitExt, extent, 0, total);
+
+  vtkThreadedImageAlgorithmFunctor functor(this, request,
+                                           inputVector, outputVector,
+                                           inData, outData,
+                                           extent, total);
+  vtkSMPTools::For(0, numberOfPieces, 1, functor);
+}
+
 //----------------------------------------------------------------------------
 // The execute method created by the subclass.
 void vtkThreadedImageAlgorithm::ThreadedRequestData(
@@ -59,8 +59,60 @@ public:
   vtkSetClampMacro( NumberOfThreads, int, 1, VTK_MAX_THREADS );
   vtkGetMacro( NumberOfThreads, int );
 
+  // Description:
+  // Execute the pieces through vtkSMPTools instead of spawning
+  // NumberOfThreads threads with vtkMultiThreader. The output extent is
+  // then split into many small pieces (see DesiredBytesPerPiece) that the
+  // SMP backend balances over its thread pool. The threadId passed to
+  // ThreadedRequestData() identifies the worker thread, so it is unique
+  // among the pieces that run concurrently but may be shared by many
+  // pieces, and it is not bounded by NumberOfThreads. Off by default, or
+  // as set with SetGlobalDefaultEnableSMP() when the filter was created.
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+
+  // Description:
+  // The initial value of EnableSMP for filters created afterwards.
+  static void SetGlobalDefaultEnableSMP(bool enable);
+  static bool GetGlobalDefaultEnableSMP();
+
+  enum SplitModeEnum
+  {
+    SLAB = 0,
+    BEAM = 1,
+    BLOCK = 2
+  };
+
+  // Description:
+  // How SplitExtent() divides an extent: SLAB splits along the outermost
+  // axis that can be split, BEAM along the Y and Z axes so that every piece
+  // holds whole rows, and BLOCK along all three axes. The default is SLAB.
+  vtkSetClampMacro(SplitMode, int, SLAB, BLOCK);
+  void SetSplitModeToSlab() { this->SetSplitMode(SLAB); }
+  void SetSplitModeToBeam() { this->SetSplitMode(BEAM); }
+  void SetSplitModeToBlock() { this->SetSplitMode(BLOCK); }
+  vtkGetMacro(SplitMode, int);
+
+  // Description:
+  // The smallest size along each axis of a piece created by the BEAM and
+  // BLOCK split modes, and the size of an SMP piece along the split axis in
+  // SLAB mode. The default is 16x1x1, which keeps pieces at least one
+  // cache line wide for 4-byte scalars.
+  vtkSetVector3Macro(MinimumPieceSize, int);
+  vtkGetVector3Macro(MinimumPieceSize, int);
+
+  // Description:
+  // The approximate size of the output scalars of one piece in SMP mode.
+  // Smaller pieces balance better but add per-piece overhead. The default
+  // is 65536 bytes.
+  vtkSetClampMacro(DesiredBytesPerPiece, vtkIdType, 1, VTK_ID_MAX);
+  vtkGetMacro(DesiredBytesPerPiece, vtkIdType);
+
   // Description:
   // Putting this here until I merge graphics and imaging streaming.
+  // Splits startExt into at most total pieces according to SplitMode and
+  // returns the number of pieces, splitExt receives piece num.
   virtual int SplitExtent(int splitExt[6], int startExt[6],
                           int num, int total);
 
@@ -71,6 +123,26 @@ protected:
   vtkMultiThreader *Threader;
   int NumberOfThreads;
 
+  bool EnableSMP;
+  int SplitMode;
+  int MinimumPieceSize[3];
+  vtkIdType DesiredBytesPerPiece;
+
+  // Description:
+  // Implements the BEAM and BLOCK modes of SplitExtent().
+  int SplitExtentIntoBlocks(int splitExt[6], int startExt[6],
+                            int num, int total);
+
+  // Description:
+  // Run ThreadedRequestData() on pieces of extent with vtkSMPTools.
+  // Called by RequestData() when EnableSMP is on.
+  virtual void SMPRequestData(vtkInformation *request,
+                              vtkInformationVector **inputVector,
+                              vtkInformationVector *outputVector,
+                              vtkImageData ***inData,
+                              vtkImageData **outData,
+                              int extent[6]);
+
   // Description:
   // This is called by the superclass.
   // This is the method you should override.
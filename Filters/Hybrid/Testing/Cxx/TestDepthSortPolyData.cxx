@@ -0,0 +1,129 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestDepthSortPolyData.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkDepthSortPolyData sorts the cells back to front with the
+// quick sort and with the radix sort, and reports the time of each.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDepthSortPolyData.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkTimerLog.h"
+
+#include <algorithm>
+#include <vector>
+
+// The output must be sorted back to front along the vector and have all
+// the cells of the input.
+static int CheckOrder(vtkPolyData *output, const double vector[3],
+                      vtkIdType numCells)
+{
+  vtkIdTypeArray *ids = vtkIdTypeArray::SafeDownCast(
+    output->GetCellData()->GetArray("Ids"));
+  if (!ids || output->GetNumberOfCells() != numCells)
+    {
+    cerr << "The output has " << output->GetNumberOfCells()
+         << " cells instead of " << numCells << endl;
+    return 1;
+    }
+  std::vector<char> seen(numCells, 0);
+  double lastDepth = 0.0;
+  vtkIdType npts;
+  vtkIdType *pts;
+  vtkCellArray *polys = output->GetPolys();
+  polys->InitTraversal();
+  for (vtkIdType cellId = 0; polys->GetNextCell(npts, pts); cellId++)
+    {
+    seen[ids->GetValue(cellId)] = 1;
+    double x[3];
+    output->GetPoint(pts[0], x);
+    double depth = vtkMath::Dot(x, vector);
+    if (cellId > 0 && depth > lastDepth + 1e-5)
+      {
+      cerr << "Cell " << cellId << " at depth " << depth
+           << " is out of order after " << lastDepth << endl;
+      return 1;
+      }
+    lastDepth = depth;
+    }
+  if (std::find(seen.begin(), seen.end(), 0) != seen.end())
+    {
+    cerr << "Cells are missing from the output" << endl;
+    return 1;
+    }
+  return 0;
+}
+
+int TestDepthSortPolyData(int, char *[])
+{
+  // random triangles
+  const vtkIdType numCells = 200000;
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> polys;
+  vtkNew<vtkIdTypeArray> ids;
+  ids->SetName("Ids");
+  vtkMath::RandomSeed(4567);
+  for (vtkIdType i = 0; i < numCells; i++)
+    {
+    vtkIdType tri[3];
+    for (int j = 0; j < 3; j++)
+      {
+      tri[j] = points->InsertNextPoint(vtkMath::Random(-10.0, 10.0),
+                                       vtkMath::Random(-10.0, 10.0),
+                                       vtkMath::Random(-10.0, 10.0));
+      }
+    polys->InsertNextCell(3, tri);
+    ids->InsertNextValue(i);
+    }
+  vtkNew<vtkPolyData> poly;
+  poly->SetPoints(points.GetPointer());
+  poly->SetPolys(polys.GetPointer());
+  poly->GetCellData()->AddArray(ids.GetPointer());
+
+  double vector[3] = { 0.3, -0.5, 0.8 };
+  vtkNew<vtkDepthSortPolyData> sorter;
+  sorter->SetInputData(poly.GetPointer());
+  sorter->SetDirectionToSpecifiedVector();
+  sorter->SetVector(vector);
+  sorter->SetDepthSortModeToFirstPoint();
+
+  vtkNew<vtkTimerLog> timer;
+  const char *names[2] = { "QuickSort", "RadixSort" };
+  int rval = 0;
+  for (int algorithm = 0; algorithm < 2; algorithm++)
+    {
+    sorter->SetSortAlgorithm(algorithm);
+    timer->StartTimer();
+    sorter->Update();
+    timer->StopTimer();
+    rval |= CheckOrder(sorter->GetOutput(), vector, numCells);
+    cout << "<DartMeasurement name=\"" << names[algorithm] << "\" "
+         << "type=\"numeric/double\">" << timer->GetElapsedTime()
+         << "</DartMeasurement>" << endl;
+    }
+
+  // the radix sort starts from the last order, which is now far from
+  // sorted
+  vector[0] = -vector[0];
+  vector[2] = -vector[2];
+  sorter->SetVector(vector);
+  sorter->Update();
+  rval |= CheckOrder(sorter->GetOutput(), vector, numCells);
+
+  return rval;
+}
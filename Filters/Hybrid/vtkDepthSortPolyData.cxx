@@ -15,8 +15,10 @@
 #include "vtkDepthSortPolyData.h"
 
 #include "vtkCamera.h"
+#include "vtkCellCenterRadixSort.h"
 #include "vtkCellData.h"
 #include "vtkGenericCell.h"
+#include "vtkIdTypeArray.h"
 #include "vtkMath.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
@@ -42,11 +44,14 @@ vtkDepthSortPolyData::vtkDepthSortPolyData()
   this->Origin[0] = this->Origin[1] = this->Origin[2] = 0.0;
   this->Transform = vtkTransform::New();
   this->SortScalars = 0;
+  this->SortAlgorithm = VTK_SORT_ALGORITHM_QUICK_SORT;
+  this->LastOrder = vtkIdTypeArray::New();
 }
 
 vtkDepthSortPolyData::~vtkDepthSortPolyData()
 {
   this->Transform->Delete();
+  this->LastOrder->Delete();
 
   if ( this->Camera )
     {
@@ -216,7 +221,36 @@ int vtkDepthSortPolyData::RequestData(
   this->UpdateProgress(0.20);
 
   // Sort the depths
-  if ( this->Direction == VTK_DIRECTION_FRONT_TO_BACK )
+  if ( this->SortAlgorithm == VTK_SORT_ALGORITHM_RADIX_SORT )
+    {
+    // Any order of the cells is a valid starting point, so the last one is
+    // kept as long as the number of cells has not changed.
+    if ( this->LastOrder->GetNumberOfTuples() != numCells )
+      {
+      this->LastOrder->SetNumberOfTuples(numCells);
+      for ( cellId=0; cellId < numCells; cellId++ )
+        {
+        this->LastOrder->SetValue(cellId, cellId);
+        }
+      }
+
+    // The radix sort orders by increasing key.
+    float *keys = new float [numCells];
+    double sign =
+      (this->Direction == VTK_DIRECTION_FRONT_TO_BACK ? 1.0 : -1.0);
+    for ( cellId=0; cellId < numCells; cellId++ )
+      {
+      keys[cellId] = static_cast<float>(sign*depth[cellId].z);
+      }
+    vtkIdType *order = this->LastOrder->GetPointer(0);
+    vtkCellCenterRadixSort::Sort(numCells, keys, order, 32);
+    for ( cellId=0; cellId < numCells; cellId++ )
+      {
+      depth[cellId].cellId = order[cellId];
+      }
+    delete [] keys;
+    }
+  else if ( this->Direction == VTK_DIRECTION_FRONT_TO_BACK )
     {
     qsort((void *)depth, numCells, sizeof(vtkSortValues),
           vtkCompareFrontToBack);
@@ -398,4 +432,14 @@ void vtkDepthSortPolyData::PrintSelf(ostream& os, vtkIndent indent)
     }
 
   os << indent << "Sort Scalars: " << (this->SortScalars ? "On\n" : "Off\n");
+
+  os << indent << "Sort Algorithm: ";
+  if ( this->SortAlgorithm == VTK_SORT_ALGORITHM_RADIX_SORT )
+    {
+    os << "Radix Sort" << endl;
+    }
+  else
+    {
+    os << "Quick Sort" << endl;
+    }
 }
@@ -20,6 +20,14 @@
 // direction vector along which to sort the cells. You can do this by
 // specifying a camera and/or prop to define a view direction; or
 // explicitly set a view direction.
+//
+// The cells are sorted with a quick sort by default.  With the radix sort
+// algorithm, the depths are quantized and sorted in parallel by
+// vtkCellCenterRadixSort, and the order of the previous execution is the
+// starting point of the sort as long as the number of cells has not
+// changed, so that the cells at the same depth keep their order.  Since any
+// order is a valid starting point, it is also kept when the cells or their
+// points change but their number does not.
 
 // .SECTION Caveats
 // The sort operation will not work well for long, thin primitives, or cells
@@ -39,7 +47,11 @@
 #define VTK_SORT_BOUNDS_CENTER 1
 #define VTK_SORT_PARAMETRIC_CENTER 2
 
+#define VTK_SORT_ALGORITHM_QUICK_SORT 0
+#define VTK_SORT_ALGORITHM_RADIX_SORT 1
+
 class vtkCamera;
+class vtkIdTypeArray;
 class vtkProp3D;
 class vtkTransform;
 
@@ -79,6 +91,18 @@ public:
   void SetDepthSortModeToParametricCenter()
     {this->SetDepthSortMode(VTK_SORT_PARAMETRIC_CENTER);}
 
+  // Description:
+  // Specify the algorithm used to sort the cells.  The radix sort runs in
+  // parallel and reuses the order of the previous execution, but it sorts
+  // depths quantized to 32 bits.  By default, the quick sort is used.
+  vtkSetClampMacro(SortAlgorithm,int,VTK_SORT_ALGORITHM_QUICK_SORT,
+                   VTK_SORT_ALGORITHM_RADIX_SORT);
+  vtkGetMacro(SortAlgorithm,int);
+  void SetSortAlgorithmToQuickSort()
+    {this->SetSortAlgorithm(VTK_SORT_ALGORITHM_QUICK_SORT);}
+  void SetSortAlgorithmToRadixSort()
+    {this->SetSortAlgorithm(VTK_SORT_ALGORITHM_RADIX_SORT);}
+
   // Description:
   // Specify a camera that is used to define a view direction along which
   // the cells are sorted. This ivar only has effect if the direction is set
@@ -138,6 +162,10 @@ protected:
   double Vector[3];
   double Origin[3];
   int SortScalars;
+  int SortAlgorithm;
+
+  // the order of the last radix sort
+  vtkIdTypeArray *LastOrder;
 
 private:
   vtkDepthSortPolyData(const vtkDepthSortPolyData&);  // Not implemented.
@@ -0,0 +1,423 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestEnSightGoldBinaryPartIndex.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkEnSightGoldBinaryReader reads the same multi-part binary
+// case with UsePartIndex on and off, and that the index is not reused once
+// the geometry file changes the number of elements of each type of a part
+// while the variable files keep their size and part offsets, or once the
+// parts of a geometry file of the same size and modification time move.
+
+#include "vtkCellData.h"
+#include "vtkCompositeDataSet.h"
+#include "vtkDataArray.h"
+#include "vtkDataSet.h"
+#include "vtkEnSightGoldBinaryReader.h"
+#include "vtkIdList.h"
+#include "vtkInformation.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkTestUtilities.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+# include <sys/utime.h>
+#else
+# include <utime.h>
+#endif
+#include <fstream>
+#include <string>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+
+const int NumberOfSteps = 2;
+const int NumberOfParts = 3;
+
+// Dimensions of the structured third part.
+const int Dimensions[3] = { 3, 2, 2 };
+const int NumberOfBlockPoints = 12;
+const int NumberOfBlockCells = 2;
+
+struct Part
+{
+  int NumberOfPoints;
+  int NumberOfTetras;
+  int NumberOfHexas;
+};
+
+void WriteString(std::ofstream& file, const char* str)
+{
+  char line[80];
+  memset(line, 0, 80);
+  strncpy(line, str, 79);
+  file.write(line, 80);
+}
+
+void WriteInt(std::ofstream& file, int value)
+{
+  file.write(reinterpret_cast<char*>(&value), sizeof(int));
+}
+
+void WriteFloats(std::ofstream& file, int count, float offset, float step)
+{
+  for (int i = 0; i < count; ++i)
+    {
+    float value = offset + step*i;
+    file.write(reinterpret_cast<char*>(&value), sizeof(float));
+    }
+}
+
+// Writes a case of two unstructured parts, whose first part has the given
+// number of points, tetras and hexas and shares 20 points with the second,
+// and of a structured part, with per node and per element variables at two
+// steps. The size of the files depends on the number of elements of each
+// type only, and the part offsets of the variable files on the number of
+// elements of each part.
+std::string WriteCase(const std::string& dir, int tetras, int variant,
+                      int points = 16)
+{
+  Part parts[2] = { { points, tetras, 4 - tetras }, { 20 - points, 1, 0 } };
+
+  std::string geoName = dir + "/TestEnSightGoldBinaryPartIndex.geo";
+  std::ofstream geo(geoName.c_str(), ios::out | ios::binary);
+  WriteString(geo, "C Binary");
+  WriteString(geo, "geometry");
+  WriteString(geo, "of three parts");
+  WriteString(geo, "node id off");
+  WriteString(geo, "element id off");
+  for (int p = 0; p < 2; ++p)
+    {
+    char name[16];
+    sprintf(name, "part %d", p + 1);
+    WriteString(geo, "part");
+    WriteInt(geo, p + 1);
+    WriteString(geo, name);
+    WriteString(geo, "coordinates");
+    WriteInt(geo, parts[p].NumberOfPoints);
+    for (int c = 0; c < 3; ++c)
+      {
+      WriteFloats(geo, parts[p].NumberOfPoints, c + p + 0.5f*variant,
+                  0.25f*(c + 1));
+      }
+    if (parts[p].NumberOfTetras)
+      {
+      WriteString(geo, "tetra4");
+      WriteInt(geo, parts[p].NumberOfTetras);
+      for (int i = 0; i < 4*parts[p].NumberOfTetras; ++i)
+        {
+        WriteInt(geo, i % parts[p].NumberOfPoints + 1);
+        }
+      }
+    if (parts[p].NumberOfHexas)
+      {
+      WriteString(geo, "hexa8");
+      WriteInt(geo, parts[p].NumberOfHexas);
+      for (int i = 0; i < 8*parts[p].NumberOfHexas; ++i)
+        {
+        WriteInt(geo, (3*i + variant) % parts[p].NumberOfPoints + 1);
+        }
+      }
+    }
+  WriteString(geo, "part");
+  WriteInt(geo, 3);
+  WriteString(geo, "block");
+  WriteString(geo, "block");
+  for (int c = 0; c < 3; ++c)
+    {
+    WriteInt(geo, Dimensions[c]);
+    }
+  for (int c = 0; c < 3; ++c)
+    {
+    WriteFloats(geo, NumberOfBlockPoints, c - 0.5f*variant, 0.125f);
+    }
+  geo.close();
+
+  for (int step = 0; step < NumberOfSteps; ++step)
+    {
+    char suffix[16];
+    sprintf(suffix, "%04d", step);
+    const char* names[4] = { "temperature", "velocity", "pressure", "force" };
+    for (int v = 0; v < 4; ++v)
+      {
+      std::string fileName = dir + "/TestEnSightGoldBinaryPartIndex_" +
+        names[v] + suffix;
+      std::ofstream var(fileName.c_str(), ios::out | ios::binary);
+      bool perElement = (v >= 2);
+      int components = (v % 2 ? 3 : 1);
+      WriteString(var, names[v]);
+      for (int p = 0; p < 2; ++p)
+        {
+        WriteString(var, "part");
+        WriteInt(var, p + 1);
+        float offset = 1000.0f*variant + 100.0f*step + 10.0f*p;
+        if (!perElement)
+          {
+          WriteString(var, "coordinates");
+          for (int c = 0; c < components; ++c)
+            {
+            WriteFloats(var, parts[p].NumberOfPoints, offset + c, 0.5f);
+            }
+          continue;
+          }
+        if (parts[p].NumberOfTetras)
+          {
+          WriteString(var, "tetra4");
+          for (int c = 0; c < components; ++c)
+            {
+            WriteFloats(var, parts[p].NumberOfTetras, offset + c, 0.5f);
+            }
+          }
+        if (parts[p].NumberOfHexas)
+          {
+          WriteString(var, "hexa8");
+          for (int c = 0; c < components; ++c)
+            {
+            WriteFloats(var, parts[p].NumberOfHexas, offset + c + 5, -0.5f);
+            }
+          }
+        }
+      WriteString(var, "part");
+      WriteInt(var, 3);
+      WriteString(var, "block");
+      for (int c = 0; c < components; ++c)
+        {
+        WriteFloats(var, perElement ? NumberOfBlockCells : NumberOfBlockPoints,
+                    200.0f*step + c, 0.25f);
+        }
+      }
+    }
+
+  std::string caseName = dir + "/TestEnSightGoldBinaryPartIndex.case";
+  std::ofstream caseFile(caseName.c_str());
+  caseFile << "FORMAT\n"
+           << "type: ensight gold\n\n"
+           << "GEOMETRY\n"
+           << "model: TestEnSightGoldBinaryPartIndex.geo\n\n"
+           << "VARIABLE\n"
+           << "scalar per node: temperature "
+              "TestEnSightGoldBinaryPartIndex_temperature****\n"
+           << "vector per node: velocity "
+              "TestEnSightGoldBinaryPartIndex_velocity****\n"
+           << "scalar per element: pressure "
+              "TestEnSightGoldBinaryPartIndex_pressure****\n"
+           << "vector per element: force "
+              "TestEnSightGoldBinaryPartIndex_force****\n\n"
+           << "TIME\n"
+           << "time set: 1\n"
+           << "number of steps: " << NumberOfSteps << "\n"
+           << "filename start number: 0\n"
+           << "filename increment: 1\n"
+           << "time values: 0 1\n";
+  return caseName;
+}
+
+int CompareArrays(vtkFieldData* a, vtkFieldData* b)
+{
+  if (a->GetNumberOfArrays() != b->GetNumberOfArrays())
+    {
+    cerr << "The numbers of arrays differ" << endl;
+    return 1;
+    }
+  for (int i = 0; i < a->GetNumberOfArrays(); ++i)
+    {
+    vtkDataArray* x = a->GetArray(i);
+    vtkDataArray* y = b->GetArray(x->GetName());
+    if (!y || x->GetNumberOfTuples() != y->GetNumberOfTuples() ||
+        x->GetNumberOfComponents() != y->GetNumberOfComponents())
+      {
+      cerr << "Array " << x->GetName() << " differs in size" << endl;
+      return 1;
+      }
+    for (vtkIdType t = 0; t < x->GetNumberOfTuples(); ++t)
+      {
+      for (int c = 0; c < x->GetNumberOfComponents(); ++c)
+        {
+        if (x->GetComponent(t, c) != y->GetComponent(t, c))
+          {
+          cerr << "Array " << x->GetName() << " differs at tuple " << t
+               << endl;
+          return 1;
+          }
+        }
+      }
+    }
+  return 0;
+}
+
+int CompareGeometry(vtkDataSet* a, vtkDataSet* b)
+{
+  if (strcmp(a->GetClassName(), b->GetClassName()) != 0)
+    {
+    cerr << "The part types differ" << endl;
+    return 1;
+    }
+  for (vtkIdType i = 0; i < a->GetNumberOfPoints(); ++i)
+    {
+    double x[3], y[3];
+    a->GetPoint(i, x);
+    b->GetPoint(i, y);
+    if (x[0] != y[0] || x[1] != y[1] || x[2] != y[2])
+      {
+      cerr << "Point " << i << " differs" << endl;
+      return 1;
+      }
+    }
+  vtkNew<vtkIdList> x;
+  vtkNew<vtkIdList> y;
+  for (vtkIdType i = 0; i < a->GetNumberOfCells(); ++i)
+    {
+    a->GetCellPoints(i, x.GetPointer());
+    b->GetCellPoints(i, y.GetPointer());
+    bool same = (a->GetCellType(i) == b->GetCellType(i) &&
+                 x->GetNumberOfIds() == y->GetNumberOfIds());
+    for (vtkIdType k = 0; same && k < x->GetNumberOfIds(); ++k)
+      {
+      same = (x->GetId(k) == y->GetId(k));
+      }
+    if (!same)
+      {
+      cerr << "Cell " << i << " differs" << endl;
+      return 1;
+      }
+    }
+  return 0;
+}
+
+int CompareOutputs(vtkMultiBlockDataSet* a, vtkMultiBlockDataSet* b)
+{
+  if (a->GetNumberOfBlocks() != b->GetNumberOfBlocks() ||
+      a->GetNumberOfBlocks() != NumberOfParts)
+    {
+    cerr << "Wrong number of parts" << endl;
+    return 1;
+    }
+  for (unsigned int i = 0; i < a->GetNumberOfBlocks(); ++i)
+    {
+    vtkDataSet* x = vtkDataSet::SafeDownCast(a->GetBlock(i));
+    vtkDataSet* y = vtkDataSet::SafeDownCast(b->GetBlock(i));
+    if (!x || !y || x->GetNumberOfPoints() != y->GetNumberOfPoints() ||
+        x->GetNumberOfCells() != y->GetNumberOfCells() ||
+        x->GetPointData()->GetNumberOfArrays() != 2 ||
+        x->GetCellData()->GetNumberOfArrays() != 2)
+      {
+      cerr << "Part " << i << " differs" << endl;
+      return 1;
+      }
+    const char* xName =
+      a->GetMetaData(i)->Get(vtkCompositeDataSet::NAME());
+    const char* yName =
+      b->GetMetaData(i)->Get(vtkCompositeDataSet::NAME());
+    if (!xName || !yName || strcmp(xName, yName) != 0)
+      {
+      cerr << "Part " << i << " is not named the same" << endl;
+      return 1;
+      }
+    if (CompareGeometry(x, y))
+      {
+      cerr << "in part " << i << endl;
+      return 1;
+      }
+    if (CompareArrays(x->GetPointData(), y->GetPointData()) ||
+        CompareArrays(x->GetCellData(), y->GetCellData()))
+      {
+      cerr << "in part " << i << endl;
+      return 1;
+      }
+    }
+  return 0;
+}
+
+// Reads every step with a reader indexing the parts and compares it with
+// a new reader parsing each file.
+int CompareSteps(vtkEnSightGoldBinaryReader* indexed,
+                 const std::string& caseName)
+{
+  for (int step = 0; step < NumberOfSteps; ++step)
+    {
+    vtkNew<vtkEnSightGoldBinaryReader> serial;
+    serial->SetCaseFileName(caseName.c_str());
+    serial->UsePartIndexOff();
+    serial->UpdateInformation();
+    serial->SetTimeValue(step);
+    serial->Update();
+
+    indexed->SetTimeValue(step);
+    indexed->Update();
+    if (CompareOutputs(indexed->GetOutput(), serial->GetOutput()))
+      {
+      cerr << "at step " << step << endl;
+      return 1;
+      }
+    }
+  return 0;
+}
+
+}
+
+int TestEnSightGoldBinaryPartIndex(int argc, char* argv[])
+{
+  char* tempDir = vtkTestUtilities::GetArgOrEnvOrDefault(
+    "-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  std::string dir = tempDir;
+  delete [] tempDir;
+
+  std::string caseName = WriteCase(dir, 3, 0);
+  vtkNew<vtkEnSightGoldBinaryReader> indexed;
+  indexed->SetCaseFileName(caseName.c_str());
+  indexed->UsePartIndexOn();
+  indexed->UpdateInformation();
+  if (CompareSteps(indexed.GetPointer(), caseName))
+    {
+    return 1;
+    }
+
+  // Moving elements of the first part from tetras to hexas keeps the size
+  // and the part offsets of every variable file.
+  WriteCase(dir, 1, 1);
+  indexed->Modified();
+  if (CompareSteps(indexed.GetPointer(), caseName))
+    {
+    cerr << "after the geometry changed" << endl;
+    return 1;
+    }
+
+  // Moving points from the first part to the second keeps the size of the
+  // geometry file but not the offset of the second part. The modification
+  // time is set back so that the index of the geometry is offered again.
+  std::string geoName = dir + "/TestEnSightGoldBinaryPartIndex.geo";
+  struct stat fs;
+  if (stat(geoName.c_str(), &fs) != 0)
+    {
+    cerr << "Cannot stat " << geoName << endl;
+    return 1;
+    }
+  WriteCase(dir, 1, 2, 12);
+  struct utimbuf times;
+  times.actime = fs.st_atime;
+  times.modtime = fs.st_mtime;
+  utime(geoName.c_str(), &times);
+  indexed->Modified();
+  if (CompareSteps(indexed.GetPointer(), caseName))
+    {
+    cerr << "after the parts of the geometry moved" << endl;
+    return 1;
+    }
+
+  return 0;
+}
@@ -3,6 +3,8 @@ vtk_module(vtkIOEnSight
     StandAlone
   DEPENDS
     vtkCommonExecutionModel
+  TEST_DEPENDS
+    vtkTestingCore
   KIT
     vtkIO
   )
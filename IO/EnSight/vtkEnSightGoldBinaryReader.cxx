@@ -17,19 +17,25 @@
 #include "vtkByteSwap.h"
 #include "vtkCellData.h"
 #include "vtkCharArray.h"
+#include "vtkDataSetAttributes.h"
 #include "vtkFloatArray.h"
 #include "vtkMultiBlockDataSet.h"
 #include "vtkIdList.h"
 #include "vtkImageData.h"
+#include "vtkInformation.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkRectilinearGrid.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
 #include "vtkStructuredGrid.h"
 #include "vtkUnstructuredGrid.h"
 
 #include <sys/stat.h>
+#include <algorithm>
 #include <ctype.h>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <map>
@@ -48,6 +54,89 @@ class vtkEnSightGoldBinaryReader::FileOffsetMapInternal
     std::map<MapKey, MapValue> Map;
 };
 
+// Layout of one variable file: for every part the offset of its "part"
+// keyword and, for every float array stored in the part, the offset of the
+// first value, the number of values, the component they belong to and the
+// element type whose cell ids map them to cells (-1 if they map to points
+// or to the cells of a structured block in order).
+class vtkEnSightGoldBinaryReader::FileLayoutInternal
+{
+  public:
+    struct Block
+    {
+      vtkTypeInt64 Offset;
+      int Count;
+      int Component;
+      int ElementType;
+    };
+    struct Part
+    {
+      int PartId;
+      vtkTypeInt64 Offset;
+      std::vector<Block> Blocks;
+    };
+
+    std::string FileName;
+    time_t ModifiedTime;
+    vtkIdType FileSize;
+    std::vector<Part> Parts;
+};
+
+class vtkEnSightGoldBinaryReader::PartIndexInternal
+{
+  public:
+    std::map<std::string, FileLayoutInternal> Map;
+};
+
+namespace
+{
+// Number of values decoded as one unit of parallel work.
+const int VTK_ENSIGHT_VALUES_PER_TASK = 65536;
+
+// A range of values of one indexed block, and where they go.
+struct vtkEnSightDecodeTask
+{
+  const char *Source;
+  int First;
+  int Last;
+  float *Target;
+  int NumberOfComponents;
+  int Component;
+  vtkIdList *CellIds;
+};
+
+// Decode the values of the tasks from the file buffer into the arrays.
+class vtkEnSightDecodeValues
+{
+public:
+  const vtkEnSightDecodeTask *Tasks;
+  bool BigEndian;
+
+  void operator()(vtkIdType t, vtkIdType end) const
+    {
+    for (; t < end; ++t)
+      {
+      const vtkEnSightDecodeTask &task = this->Tasks[t];
+      for (int i = task.First; i < task.Last; ++i)
+        {
+        float value;
+        memcpy(&value, task.Source + i*sizeof(float), sizeof(float));
+        if (this->BigEndian)
+          {
+          vtkByteSwap::Swap4BE(&value);
+          }
+        else
+          {
+          vtkByteSwap::Swap4LE(&value);
+          }
+        vtkIdType tuple = (task.CellIds ? task.CellIds->GetId(i) : i);
+        task.Target[tuple*task.NumberOfComponents + task.Component] = value;
+        }
+      }
+    }
+};
+}
+
 
 // This is half the precision of an int.
 #define MAXIMUM_PART_ID 65536
@@ -56,6 +145,8 @@ class vtkEnSightGoldBinaryReader::FileOffsetMapInternal
 vtkEnSightGoldBinaryReader::vtkEnSightGoldBinaryReader()
 {
   this->FileOffsets = new vtkEnSightGoldBinaryReader::FileOffsetMapInternal;
+  this->PartIndex = new vtkEnSightGoldBinaryReader::PartIndexInternal;
+  this->UsePartIndex = 0;
 
   this->IFile = NULL;
   this->FileSize = 0;
@@ -69,6 +160,7 @@ vtkEnSightGoldBinaryReader::vtkEnSightGoldBinaryReader()
 vtkEnSightGoldBinaryReader::~vtkEnSightGoldBinaryReader()
 {
   delete this->FileOffsets;
+  delete this->PartIndex;
 
   if (this->IFile)
     {
@@ -249,10 +341,19 @@ int vtkEnSightGoldBinaryReader::InitializeFile(const char* fileName)
 int vtkEnSightGoldBinaryReader::ReadGeometryFile(const char* fileName, int timeStep,
   vtkMultiBlockDataSet *output)
 {
-  char line[80], subLine[80], nameline[80];
+  char line[80], nameline[80];
   int partId, realId;
   int lineRead, i;
 
+  if (this->UsePartIndex && !this->UseFileSets)
+    {
+    int result = this->ReadIndexedGeometry(fileName, output);
+    if (result >= 0)
+      {
+      return result;
+      }
+    }
+
   if (!this->InitializeFile(fileName))
     {
     return 0;
@@ -296,6 +397,59 @@ int vtkEnSightGoldBinaryReader::ReadGeometryFile(const char* fileName, int timeS
     this->AddTimeStepToCache(fileName, timeStep-1, this->IFile->tellg());
     }
 
+  lineRead = this->ReadGeometryHeader(line);
+
+  while (lineRead > 0 && strncmp(line, "part", 4) == 0)
+    {
+    this->ReadPartId(&partId);
+    partId--; // EnSight starts #ing at 1.
+    if (partId < 0 || partId >= MAXIMUM_PART_ID)
+      {
+      vtkErrorMacro("Invalid part id; check that ByteOrder is set correctly.");
+      return 0;
+      }
+    realId = this->InsertNewPartId(partId);
+
+    // Increment the number of geoemtry parts such that the measured geomtry,
+    // if any, can be properly combined into a vtkMultiBlockDataSet object.
+    // --- fix to bug #7453
+    this->NumberOfGeometryParts ++;
+
+    this->ReadLine(line); // part description line
+
+    strncpy(nameline, line, 80); // 80 characters in line are allowed
+    nameline[79] = '\0'; // Ensure NULL character at end of part name
+    char *name = strdup(nameline);
+
+    // fix to bug #0008237
+    // The original "return 1" operation upon "strncmp(line, "interface", 9) == 0"
+    // was removed here as 'interface' is NOT a keyword of an EnSight Gold file.
+
+    this->ReadLine(line);
+    lineRead = this->CreatePartOutput(realId, line, name, output);
+    free(name);
+    }
+
+  if (this->IFile)
+    {
+    this->IFile->close();
+    delete this->IFile;
+    this->IFile = NULL;
+    }
+  if (lineRead < 0)
+    {
+    return 0;
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkEnSightGoldBinaryReader::ReadGeometryHeader(char line[80])
+{
+  char subLine[80];
+  int lineRead;
+
   // Skip the 2 description lines.
   this->ReadLine(line);
   this->ReadLine(line);
@@ -339,98 +493,37 @@ int vtkEnSightGoldBinaryReader::ReadGeometryFile(const char* fileName, int timeS
     lineRead = this->ReadLine(line); // "part"
     }
 
-  while (lineRead > 0 && strncmp(line, "part", 4) == 0)
-    {
-    this->ReadPartId(&partId);
-    partId--; // EnSight starts #ing at 1.
-    if (partId < 0 || partId >= MAXIMUM_PART_ID)
-      {
-      vtkErrorMacro("Invalid part id; check that ByteOrder is set correctly.");
-      return 0;
-      }
-    realId = this->InsertNewPartId(partId);
-
-    // Increment the number of geoemtry parts such that the measured geomtry,
-    // if any, can be properly combined into a vtkMultiBlockDataSet object.
-    // --- fix to bug #7453
-    this->NumberOfGeometryParts ++;
-
-    this->ReadLine(line); // part description line
-
-    strncpy(nameline, line, 80); // 80 characters in line are allowed
-    nameline[79] = '\0'; // Ensure NULL character at end of part name
-    char *name = strdup(nameline);
-
-    // fix to bug #0008237
-    // The original "return 1" operation upon "strncmp(line, "interface", 9) == 0"
-    // was removed here as 'interface' is NOT a keyword of an EnSight Gold file.
+  return lineRead;
+}
 
-    this->ReadLine(line);
+//----------------------------------------------------------------------------
+int vtkEnSightGoldBinaryReader::CreatePartOutput(int realId, char line[80],
+  const char* name, vtkMultiBlockDataSet *output)
+{
+  char subLine[80];
 
-    if (strncmp(line, "block", 5) == 0)
+  if (strncmp(line, "block", 5) == 0)
+    {
+    if (sscanf(line, " %*s %s", subLine) == 1)
       {
-      if (sscanf(line, " %*s %s", subLine) == 1)
+      if (strncmp(subLine, "rectilinear", 11) == 0)
         {
-        if (strncmp(subLine, "rectilinear", 11) == 0)
-          {
-          // block rectilinear
-          lineRead = this->CreateRectilinearGridOutput(realId, line, name,
-            output);
-          }
-        else if (strncmp(subLine, "uniform", 7) == 0)
-          {
-          // block uniform
-          lineRead = this->CreateImageDataOutput(realId, line, name,
-            output);
-          }
-        else
-          {
-          // block iblanked
-          lineRead = this->CreateStructuredGridOutput(realId, line, name,
-            output);
-          }
+        // block rectilinear
+        return this->CreateRectilinearGridOutput(realId, line, name, output);
         }
-      else
+      else if (strncmp(subLine, "uniform", 7) == 0)
         {
-        // block
-        lineRead = this->CreateStructuredGridOutput(realId, line, name,
-          output);
+        // block uniform
+        return this->CreateImageDataOutput(realId, line, name, output);
         }
+      // block iblanked
       }
-    else
-      {
-      lineRead = this->CreateUnstructuredGridOutput(realId, line, name,
-        output);
-      if (lineRead < 0)
-        {
-        free(name);
-        if (this->IFile)
-          {
-          this->IFile->close();
-          delete this->IFile;
-          this->IFile = NULL;
-          }
-        return 0;
-        }
-      }
-    free(name);
+    // block
+    return this->CreateStructuredGridOutput(realId, line, name, output);
     }
-
-  if (this->IFile)
-    {
-    this->IFile->close();
-    delete this->IFile;
-    this->IFile = NULL;
-    }
-  if (lineRead < 0)
-    {
-    return 0;
-    }
-
-  return 1;
+  return this->CreateUnstructuredGridOutput(realId, line, name, output);
 }
 
-
 //----------------------------------------------------------------------------
 int vtkEnSightGoldBinaryReader::CountTimeSteps()
 {
@@ -516,37 +609,7 @@ int vtkEnSightGoldBinaryReader::SkipTimeStep()
       }
     this->ReadLine(line); // part description line
     this->ReadLine(line);
-
-    if (strncmp(line, "block", 5) == 0)
-      {
-      if (sscanf(line, " %*s %s", subLine) == 1)
-        {
-        if (strncmp(subLine, "rectilinear", 11) == 0)
-          {
-          // block rectilinear
-          lineRead = this->SkipRectilinearGrid(line);
-          }
-        else if (strncmp(subLine, "uniform,", 7) == 0)
-          {
-          // block uniform
-          lineRead = this->SkipImageData(line);
-          }
-        else
-          {
-          // block iblanked
-          lineRead = this->SkipStructuredGrid(line);
-          }
-        }
-      else
-        {
-        // block
-        lineRead = this->SkipStructuredGrid(line);
-        }
-      }
-    else
-      {
-      lineRead = this->SkipUnstructuredGrid(line);
-      }
+    lineRead = this->SkipPart(line);
     }
 
   if (lineRead < 0)
@@ -563,6 +626,33 @@ int vtkEnSightGoldBinaryReader::SkipTimeStep()
   return 1;
 }
 
+//----------------------------------------------------------------------------
+int vtkEnSightGoldBinaryReader::SkipPart(char line[80])
+{
+  char subLine[80];
+
+  if (strncmp(line, "block", 5) == 0)
+    {
+    if (sscanf(line, " %*s %s", subLine) == 1)
+      {
+      if (strncmp(subLine, "rectilinear", 11) == 0)
+        {
+        // block rectilinear
+        return this->SkipRectilinearGrid(line);
+        }
+      else if (strncmp(subLine, "uniform", 7) == 0)
+        {
+        // block uniform
+        return this->SkipImageData(line);
+        }
+      // block iblanked
+      }
+    // block
+    return this->SkipStructuredGrid(line);
+    }
+  return this->SkipUnstructuredGrid(line);
+}
+
 //----------------------------------------------------------------------------
 int vtkEnSightGoldBinaryReader::SkipStructuredGrid(char line[256])
 {
@@ -605,6 +695,19 @@ int vtkEnSightGoldBinaryReader::SkipStructuredGrid(char line[256])
 
   // reading next line to check for EOF
   lineRead = this->ReadLine(line);
+
+  if (strncmp(line, "node_ids", 8) == 0)
+    { // skip node ids.
+    this->IFile->seekg(numPts*sizeof(int), ios::cur);
+    lineRead = this->ReadLine(line);
+    }
+  if (strncmp(line, "element_ids", 11) == 0)
+    { // skip element ids.
+    int numElements = (dimensions[0] - 1) * (dimensions[1] - 1) *
+      (dimensions[2] - 1);
+    this->IFile->seekg(numElements*sizeof(int), ios::cur);
+    lineRead = this->ReadLine(line);
+    }
   return lineRead;
 }
 
@@ -1326,6 +1429,17 @@ int vtkEnSightGoldBinaryReader::ReadScalarsPerNode(
     sfilename = fileName;
     }
 
+  if (this->UsePartIndex && !this->UseFileSets && !measured)
+    {
+    int result = this->ReadIndexedVariable(sfilename.c_str(), description,
+      0, 1, numberOfComponents, component,
+      vtkDataSetAttributes::SCALARS, compositeOutput);
+    if (result >= 0)
+      {
+      return result;
+      }
+    }
+
   if (this->OpenFile(sfilename.c_str()) == 0)
     {
     vtkErrorMacro("Unable to open file: " << sfilename.c_str());
@@ -1535,6 +1649,17 @@ int vtkEnSightGoldBinaryReader::ReadVectorsPerNode(
     sfilename = fileName;
     }
 
+  if (this->UsePartIndex && !this->UseFileSets && !measured)
+    {
+    int result = this->ReadIndexedVariable(sfilename.c_str(), description,
+      0, 3, 3, 0,
+      vtkDataSetAttributes::VECTORS, compositeOutput);
+    if (result >= 0)
+      {
+      return result;
+      }
+    }
+
   if (this->OpenFile(sfilename.c_str()) == 0)
     {
     vtkErrorMacro("Unable to open file: " << sfilename.c_str());
@@ -1724,6 +1849,16 @@ int vtkEnSightGoldBinaryReader::ReadTensorsPerNode(
     sfilename = fileName;
     }
 
+  if (this->UsePartIndex && !this->UseFileSets)
+    {
+    int result = this->ReadIndexedVariable(sfilename.c_str(), description,
+      0, 6, 6, 0, -1, compositeOutput);
+    if (result >= 0)
+      {
+      return result;
+      }
+    }
+
   if (this->OpenFile(sfilename.c_str()) == 0)
     {
     vtkErrorMacro("Unable to open file: " << sfilename.c_str());
@@ -1877,6 +2012,17 @@ int vtkEnSightGoldBinaryReader::ReadScalarsPerElement(
     sfilename = fileName;
     }
 
+  if (this->UsePartIndex && !this->UseFileSets)
+    {
+    int result = this->ReadIndexedVariable(sfilename.c_str(), description,
+      1, 1, numberOfComponents, component,
+      vtkDataSetAttributes::SCALARS, compositeOutput);
+    if (result >= 0)
+      {
+      return result;
+      }
+    }
+
   if (this->OpenFile(sfilename.c_str()) == 0)
     {
     vtkErrorMacro("Unable to open file: " << sfilename.c_str());
@@ -2123,6 +2269,17 @@ int vtkEnSightGoldBinaryReader::ReadVectorsPerElement(
     sfilename = fileName;
     }
 
+  if (this->UsePartIndex && !this->UseFileSets)
+    {
+    int result = this->ReadIndexedVariable(sfilename.c_str(), description,
+      1, 3, 3, 0,
+      vtkDataSetAttributes::VECTORS, compositeOutput);
+    if (result >= 0)
+      {
+      return result;
+      }
+    }
+
   if (this->OpenFile(sfilename.c_str()) == 0)
     {
     vtkErrorMacro("Unable to open file: " << sfilename.c_str());
@@ -2363,6 +2520,16 @@ int vtkEnSightGoldBinaryReader::ReadTensorsPerElement(
     sfilename = fileName;
     }
 
+  if (this->UsePartIndex && !this->UseFileSets)
+    {
+    int result = this->ReadIndexedVariable(sfilename.c_str(), description,
+      1, 6, 6, 0, -1, compositeOutput);
+    if (result >= 0)
+      {
+      return result;
+      }
+    }
+
   if (this->OpenFile(sfilename.c_str()) == 0)
     {
     vtkErrorMacro("Unable to open file: " << sfilename.c_str());
@@ -2587,6 +2754,637 @@ int vtkEnSightGoldBinaryReader::ReadTensorsPerElement(
   return 1;
 }
 
+//----------------------------------------------------------------------------
+int vtkEnSightGoldBinaryReader::BuildPartIndex(int perElement,
+  int fileComponents, vtkMultiBlockDataSet *compositeOutput,
+  FileLayoutInternal *layout)
+{
+  char line[80];
+  int partId;
+  // Fortran records carry a 4 byte length marker on both sides.
+  vtkTypeInt64 marker = (this->Fortran ? 4 : 0);
+
+  layout->FileSize = this->FileSize;
+  layout->Parts.clear();
+
+  this->ReadLine(line); // skip the description line
+  vtkTypeInt64 offset = this->IFile->tellg();
+  int lineRead = this->ReadLine(line);
+  while (lineRead && strncmp(line, "part", 4) == 0)
+    {
+    FileLayoutInternal::Part part;
+    part.Offset = offset + marker;
+    if (!this->ReadPartId(&partId))
+      {
+      return 0;
+      }
+    part.PartId = partId - 1; // EnSight starts #ing with 1.
+    int realId = this->InsertNewPartId(part.PartId);
+    vtkDataSet *output = this->GetDataSetFromBlock(compositeOutput, realId);
+    if (!output)
+      {
+      return 0;
+      }
+
+    vtkIdType numValues = (perElement ? output->GetNumberOfCells() :
+                           output->GetNumberOfPoints());
+    lineRead = 0;
+    if (numValues)
+      {
+      // "coordinates" or "block" for nodes, element type or "block" for
+      // elements.
+      lineRead = this->ReadLine(line);
+      int elementType = -1;
+      while (lineRead && strncmp(line, "part", 4) != 0 &&
+        strncmp(line, "END TIME STEP", 13) != 0)
+        {
+        vtkIdType count = numValues;
+        if (perElement && strncmp(line, "block", 5) != 0)
+          {
+          elementType = this->GetElementType(line);
+          if (elementType == -1)
+            {
+            vtkErrorMacro("Unknown element type \"" << line << "\"");
+            return 0;
+            }
+          int idx = this->UnstructuredPartIds->IsId(realId);
+          count = this->GetCellIds(idx, elementType)->GetNumberOfIds();
+          }
+        for (int c = 0; c < fileComponents; ++c)
+          {
+          FileLayoutInternal::Block block;
+          block.Offset = static_cast<vtkTypeInt64>(this->IFile->tellg()) +
+            marker;
+          block.Count = static_cast<int>(count);
+          block.Component = c;
+          block.ElementType = elementType;
+          part.Blocks.push_back(block);
+          this->IFile->seekg(sizeof(float)*count + 2*marker, ios::cur);
+          }
+
+        // Nodes and structured blocks hold a single section per part.
+        this->IFile->peek();
+        if (this->IFile->eof())
+          {
+          lineRead = 0;
+          break;
+          }
+        offset = this->IFile->tellg();
+        lineRead = this->ReadLine(line);
+        if (!perElement || elementType == -1)
+          {
+          break;
+          }
+        }
+      }
+    else
+      {
+      this->IFile->peek();
+      if (!this->IFile->eof())
+        {
+        offset = this->IFile->tellg();
+        lineRead = this->ReadLine(line);
+        }
+      }
+    if (this->IFile->fail() && !this->IFile->eof())
+      {
+      return 0;
+      }
+    layout->Parts.push_back(part);
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkEnSightGoldBinaryReader::CheckPartIndex(const char *buffer,
+  int perElement, vtkMultiBlockDataSet *compositeOutput,
+  FileLayoutInternal *layout)
+{
+  vtkTypeInt64 marker = (this->Fortran ? 4 : 0);
+  vtkTypeInt64 fileSize = this->FileSize;
+  vtkTypeInt64 valueSize = static_cast<vtkTypeInt64>(sizeof(float));
+  char line[81];
+  line[80] = '\0';
+
+  for (size_t p = 0; p < layout->Parts.size(); ++p)
+    {
+    // The "part" keyword and the part number.
+    const FileLayoutInternal::Part &part = layout->Parts[p];
+    vtkTypeInt64 idOffset = part.Offset + 80 + 2*marker;
+    if (part.Offset < 0 || idOffset + 4 > fileSize ||
+        strncmp(buffer + part.Offset, "part", 4) != 0)
+      {
+      return 0;
+      }
+    int partId;
+    memcpy(&partId, buffer + idOffset, sizeof(int));
+    if (this->ByteOrder == FILE_LITTLE_ENDIAN)
+      {
+      vtkByteSwap::Swap4LE(&partId);
+      }
+    else
+      {
+      vtkByteSwap::Swap4BE(&partId);
+      }
+    if (partId - 1 != part.PartId)
+      {
+      return 0;
+      }
+
+    // The values of each block must still add up to the points or cells
+    // of the part, which change with the geometry.
+    int realId = this->InsertNewPartId(part.PartId);
+    vtkDataSet *output = this->GetDataSetFromBlock(compositeOutput, realId);
+    if (!output)
+      {
+      return 0;
+      }
+    vtkIdType numValues = (perElement ? output->GetNumberOfCells() :
+                           output->GetNumberOfPoints());
+    int idx = this->UnstructuredPartIds->IsId(realId);
+    vtkIdType total = 0;
+    for (size_t b = 0; b < part.Blocks.size(); ++b)
+      {
+      const FileLayoutInternal::Block &block = part.Blocks[b];
+      if (block.Offset - 80 - 2*marker < part.Offset ||
+          block.Offset + valueSize*block.Count > fileSize)
+        {
+        return 0;
+        }
+      vtkIdType count = numValues;
+      if (block.ElementType >= 0)
+        {
+        if (idx < 0)
+          {
+          return 0;
+          }
+        count = this->GetCellIds(idx, block.ElementType)->GetNumberOfIds();
+        }
+      if (block.Count != count)
+        {
+        return 0;
+        }
+      if (block.Component != 0)
+        {
+        continue;
+        }
+
+      // The line naming the block precedes its first component.
+      memcpy(line, buffer + block.Offset - 80 - marker*2, 80);
+      if (block.ElementType >= 0 ?
+          this->GetElementType(line) != block.ElementType :
+          (strncmp(line, "coordinates", 11) != 0 &&
+           strncmp(line, "block", 5) != 0))
+        {
+        return 0;
+        }
+      total += count;
+      }
+    if (total != numValues)
+      {
+      return 0;
+      }
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkEnSightGoldBinaryReader::ReadIndexedVariable(const char* fileName,
+  const char* description, int perElement, int fileComponents,
+  int numberOfComponents, int component, int attributeType,
+  vtkMultiBlockDataSet *compositeOutput)
+{
+  if (this->OpenFile(fileName) == 0)
+    {
+    vtkErrorMacro("Unable to open file: " << fileName);
+    return 0;
+    }
+
+  // Complex variables read their real and imaginary files into different
+  // components of the same array, so the component is part of the key.
+  std::ostringstream key;
+  key << description << '/' << perElement << '/' << fileComponents << '/'
+      << component;
+  FileLayoutInternal &layout = this->PartIndex->Map[key.str()];
+
+  // An index is reused for the files of other time steps, but not for the
+  // file it was built from once that file has been modified.
+  struct stat fs;
+  time_t modifiedTime = (stat(fileName, &fs) == 0 ? fs.st_mtime : 0);
+  bool haveLayout = !layout.Parts.empty() &&
+    layout.FileSize == this->FileSize &&
+    (layout.FileName != fileName || layout.ModifiedTime == modifiedTime);
+  if (!haveLayout)
+    {
+    if (!this->BuildPartIndex(perElement, fileComponents, compositeOutput,
+                              &layout))
+      {
+      this->PartIndex->Map.erase(key.str());
+      this->IFile->close();
+      delete this->IFile;
+      this->IFile = NULL;
+      return -1;
+      }
+    layout.FileName = fileName;
+    layout.ModifiedTime = modifiedTime;
+    this->IFile->clear();
+    }
+
+  // Read the whole file with a single read.
+  std::vector<char> buffer(this->FileSize);
+  this->IFile->seekg(0, ios::beg);
+  if (this->FileSize > 0 && !this->IFile->read(&buffer[0], this->FileSize))
+    {
+    vtkErrorMacro("Read failed");
+    this->IFile->close();
+    delete this->IFile;
+    this->IFile = NULL;
+    return 0;
+    }
+
+  // Make sure the indexed parts are where the index says they are. If a
+  // reused index does not match the file, index this file and try again.
+  bool valid = (this->FileSize == 0 ||
+    this->CheckPartIndex(&buffer[0], perElement, compositeOutput, &layout));
+  this->IFile->close();
+  delete this->IFile;
+  this->IFile = NULL;
+  if (!valid)
+    {
+    this->PartIndex->Map.erase(key.str());
+    if (haveLayout)
+      {
+      return this->ReadIndexedVariable(fileName, description, perElement,
+        fileComponents, numberOfComponents, component, attributeType,
+        compositeOutput);
+      }
+    return -1;
+    }
+
+  // Create (or find, for the later components of complex variables) the
+  // arrays and cut the blocks into tasks.
+  std::vector<vtkEnSightDecodeTask> tasks;
+  std::vector<vtkDataSet*> outputs;
+  std::vector<vtkFloatArray*> arrays;
+  for (size_t p = 0; p < layout.Parts.size(); ++p)
+    {
+    const FileLayoutInternal::Part &part = layout.Parts[p];
+    if (part.Blocks.empty())
+      {
+      continue;
+      }
+    int realId = this->InsertNewPartId(part.PartId);
+    vtkDataSet *output = this->GetDataSetFromBlock(compositeOutput, realId);
+    vtkDataSetAttributes *attributes = (perElement ?
+      static_cast<vtkDataSetAttributes*>(output->GetCellData()) :
+      static_cast<vtkDataSetAttributes*>(output->GetPointData()));
+    vtkFloatArray *array = NULL;
+    if (component == 0)
+      {
+      array = vtkFloatArray::New();
+      array->SetNumberOfComponents(numberOfComponents);
+      array->SetNumberOfTuples(perElement ? output->GetNumberOfCells() :
+                               output->GetNumberOfPoints());
+      outputs.push_back(output);
+      arrays.push_back(array);
+      }
+    else
+      {
+      array = vtkFloatArray::SafeDownCast(attributes->GetArray(description));
+      }
+    if (!array)
+      {
+      continue;
+      }
+
+    int idx = this->UnstructuredPartIds->IsId(realId);
+    for (size_t b = 0; b < part.Blocks.size(); ++b)
+      {
+      const FileLayoutInternal::Block &block = part.Blocks[b];
+      vtkEnSightDecodeTask task;
+      task.Source = &buffer[block.Offset];
+      task.Target = array->GetPointer(0);
+      task.NumberOfComponents = numberOfComponents;
+      task.Component = component + block.Component;
+      task.CellIds = (block.ElementType >= 0 ?
+        this->GetCellIds(idx, block.ElementType) : NULL);
+      for (int first = 0; first < block.Count;
+           first += VTK_ENSIGHT_VALUES_PER_TASK)
+        {
+        task.First = first;
+        task.Last = std::min(first + VTK_ENSIGHT_VALUES_PER_TASK,
+                             block.Count);
+        tasks.push_back(task);
+        }
+      }
+    }
+
+  if (!tasks.empty())
+    {
+    vtkEnSightDecodeValues decode;
+    decode.Tasks = &tasks[0];
+    decode.BigEndian = (this->ByteOrder != FILE_LITTLE_ENDIAN);
+    vtkSMPTools::For(0, static_cast<vtkIdType>(tasks.size()), decode);
+    }
+
+  // Assemble the new arrays into the multiblock output.
+  for (size_t a = 0; a < arrays.size(); ++a)
+    {
+    vtkDataSetAttributes *attributes = (perElement ?
+      static_cast<vtkDataSetAttributes*>(outputs[a]->GetCellData()) :
+      static_cast<vtkDataSetAttributes*>(outputs[a]->GetPointData()));
+    arrays[a]->SetName(description);
+    attributes->AddArray(arrays[a]);
+    if (attributeType >= 0 && !attributes->GetAttribute(attributeType))
+      {
+      attributes->SetActiveAttribute(description, attributeType);
+      }
+    arrays[a]->Delete();
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkEnSightGoldBinaryReader::BuildGeometryIndex(char line[80],
+  FileLayoutInternal *layout)
+{
+  int partId;
+  int lineRead = 1;
+
+  layout->FileSize = this->FileSize;
+  layout->Parts.clear();
+
+  while (lineRead > 0 && strncmp(line, "part", 4) == 0)
+    {
+    FileLayoutInternal::Part part;
+    part.Offset = static_cast<vtkTypeInt64>(this->IFile->tellg()) - 80;
+    if (!this->ReadPartId(&partId))
+      {
+      return 0;
+      }
+    part.PartId = partId - 1; // EnSight starts #ing with 1.
+    if (part.PartId < 0 || part.PartId >= MAXIMUM_PART_ID)
+      {
+      return 0;
+      }
+    this->ReadLine(line); // part description line
+    this->ReadLine(line);
+    lineRead = this->SkipPart(line);
+    layout->Parts.push_back(part);
+    }
+
+  return (lineRead == 0 && !layout->Parts.empty());
+}
+
+//----------------------------------------------------------------------------
+int vtkEnSightGoldBinaryReader::ReadGeometryPart(vtkTypeInt64 offset,
+  vtkTypeInt64 end, int partId, int realId,
+  vtkMultiBlockDataSet *compositeOutput)
+{
+  char line[80], nameline[80];
+  int id;
+
+  this->IFile->clear();
+  this->IFile->seekg(offset, ios::beg);
+  if (!this->ReadLine(line) || strncmp(line, "part", 4) != 0 ||
+      !this->ReadInt(&id) || id - 1 != partId)
+    {
+    return -2;
+    }
+
+  this->ReadLine(line); // part description line
+  strncpy(nameline, line, 80); // 80 characters in line are allowed
+  nameline[79] = '\0'; // Ensure NULL character at end of part name
+
+  this->ReadLine(line);
+  int lineRead = this->CreatePartOutput(realId, line, nameline,
+                                        compositeOutput);
+  if (lineRead < 0)
+    {
+    return lineRead;
+    }
+
+  // The part must end where the next one starts, or at the end of the file.
+  if (end < 0)
+    {
+    return (lineRead == 0 ? 1 : -2);
+    }
+  if (lineRead == 0 || strncmp(line, "part", 4) != 0 ||
+      static_cast<vtkTypeInt64>(this->IFile->tellg()) - 80 != end)
+    {
+    return -2;
+    }
+  return lineRead;
+}
+
+//----------------------------------------------------------------------------
+// Parse a range of the indexed parts of a geometry file. A clone of the
+// reader, with its own stream and multiblock, parses the parts of each
+// range, and the outputs, names and cell ids of every part are kept for the
+// reader to assemble once all the ranges are done.
+class vtkEnSightGoldBinaryReader::GeometryPartsInternal
+{
+public:
+  vtkEnSightGoldBinaryReader *Reader;
+  const char *FileName;
+  const FileLayoutInternal *Layout;
+  const int *RealIds;
+  int *Results;
+  vtkSmartPointer<vtkDataSet> *Outputs;
+  std::string *Names;
+  vtkSmartPointer<vtkIdList> *CellIds;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+    {
+    vtkEnSightGoldBinaryReader *reader = this->Reader->NewInstance();
+    reader->SetDebug(this->Reader->GetDebug());
+    reader->ByteOrder = this->Reader->ByteOrder;
+    reader->Fortran = this->Reader->Fortran;
+    reader->NodeIdsListed = this->Reader->NodeIdsListed;
+    reader->ElementIdsListed = this->Reader->ElementIdsListed;
+    reader->FileSize = this->Reader->FileSize;
+    reader->SizeOfInt = this->Reader->SizeOfInt;
+    reader->IFile = new ifstream(this->FileName, ios::in | ios::binary);
+    vtkMultiBlockDataSet *blocks = vtkMultiBlockDataSet::New();
+
+    const std::vector<FileLayoutInternal::Part> &parts = this->Layout->Parts;
+    for (vtkIdType p = begin; p < end; ++p)
+      {
+      vtkTypeInt64 next = (p + 1 < static_cast<vtkIdType>(parts.size()) ?
+                           parts[p + 1].Offset : -1);
+      int realId = this->RealIds[p];
+      this->Results[p] = (reader->IFile->fail() ? -2 :
+        reader->ReadGeometryPart(parts[p].Offset, next, parts[p].PartId,
+                                 realId, blocks));
+      if (this->Results[p] < 0)
+        {
+        continue;
+        }
+      this->Outputs[p] = reader->GetDataSetFromBlock(blocks, realId);
+      const char *name = blocks->GetMetaData(static_cast<unsigned int>(
+        realId))->Get(vtkCompositeDataSet::NAME());
+      this->Names[p] = (name ? name : "");
+      int idx = reader->UnstructuredPartIds->IsId(realId);
+      if (idx >= 0)
+        {
+        for (int i = 0; i < vtkEnSightReader::NUMBER_OF_ELEMENT_TYPES; ++i)
+          {
+          this->CellIds[p*vtkEnSightReader::NUMBER_OF_ELEMENT_TYPES + i] =
+            reader->GetCellIds(idx, i);
+          }
+        }
+      }
+
+    blocks->Delete();
+    reader->Delete();
+    }
+};
+
+//----------------------------------------------------------------------------
+int vtkEnSightGoldBinaryReader::ReadIndexedGeometry(const char* fileName,
+  vtkMultiBlockDataSet *compositeOutput)
+{
+  char line[80];
+
+  if (!this->InitializeFile(fileName))
+    {
+    return 0;
+    }
+  // The part skipping methods do not know about Fortran record markers.
+  if (this->Fortran)
+    {
+    this->IFile->close();
+    delete this->IFile;
+    this->IFile = NULL;
+    return -1;
+    }
+
+  std::string path;
+  if (this->FilePath)
+    {
+    path = this->FilePath;
+    if (path.at(path.length()-1) != '/')
+      {
+      path += "/";
+      }
+    path += fileName;
+    }
+  else
+    {
+    path = fileName;
+    }
+
+  int lineRead = this->ReadGeometryHeader(line);
+  FileLayoutInternal &layout = this->PartIndex->Map["geometry/" + path];
+
+  // An index is reused as long as the file it was built from is not
+  // modified. Reading the parts checks it against the file in any case.
+  struct stat fs;
+  time_t modifiedTime = (stat(path.c_str(), &fs) == 0 ? fs.st_mtime : 0);
+  bool haveLayout = !layout.Parts.empty() &&
+    layout.FileSize == this->FileSize && layout.ModifiedTime == modifiedTime;
+  if (!haveLayout)
+    {
+    if (lineRead <= 0 || !this->BuildGeometryIndex(line, &layout))
+      {
+      this->PartIndex->Map.erase("geometry/" + path);
+      this->IFile->close();
+      delete this->IFile;
+      this->IFile = NULL;
+      return -1;
+      }
+    layout.FileName = path;
+    layout.ModifiedTime = modifiedTime;
+    }
+  this->IFile->close();
+  delete this->IFile;
+  this->IFile = NULL;
+
+  // Parts with the same id would share an output.
+  size_t numParts = layout.Parts.size();
+  std::vector<int> realIds(numParts);
+  std::vector<int> usedIds;
+  for (size_t p = 0; p < numParts; ++p)
+    {
+    realIds[p] = this->InsertNewPartId(layout.Parts[p].PartId);
+    usedIds.push_back(realIds[p]);
+    }
+  std::sort(usedIds.begin(), usedIds.end());
+  if (std::adjacent_find(usedIds.begin(), usedIds.end()) != usedIds.end())
+    {
+    return -1;
+    }
+
+  std::vector<int> results(numParts);
+  std::vector<vtkSmartPointer<vtkDataSet> > outputs(numParts);
+  std::vector<std::string> names(numParts);
+  std::vector<vtkSmartPointer<vtkIdList> > cellIds(
+    numParts*vtkEnSightReader::NUMBER_OF_ELEMENT_TYPES);
+  GeometryPartsInternal parse;
+  parse.Reader = this;
+  parse.FileName = path.c_str();
+  parse.Layout = &layout;
+  parse.RealIds = &realIds[0];
+  parse.Results = &results[0];
+  parse.Outputs = &outputs[0];
+  parse.Names = &names[0];
+  parse.CellIds = &cellIds[0];
+  vtkSMPTools::For(0, static_cast<vtkIdType>(numParts), parse);
+
+  for (size_t p = 0; p < numParts; ++p)
+    {
+    if (results[p] == -2)
+      {
+      // The index does not describe the file. Index it and try again.
+      this->PartIndex->Map.erase("geometry/" + path);
+      return (haveLayout ?
+              this->ReadIndexedGeometry(fileName, compositeOutput) : -1);
+      }
+    if (results[p] < 0)
+      {
+      return 0;
+      }
+    }
+
+  // Assemble the parts into the multiblock output, in part order.
+  for (size_t p = 0; p < numParts; ++p)
+    {
+    int realId = realIds[p];
+    this->NumberOfGeometryParts++;
+    this->NumberOfNewOutputs++;
+    // Replace the output of the last execution, if any.
+    compositeOutput->SetBlock(realId, outputs[p]);
+    this->SetBlockName(compositeOutput, realId, names[p].c_str());
+    if (!outputs[p]->IsA("vtkUnstructuredGrid"))
+      {
+      continue;
+      }
+    if (this->UnstructuredPartIds->IsId(realId) < 0)
+      {
+      this->UnstructuredPartIds->InsertNextId(realId);
+      }
+    int idx = this->UnstructuredPartIds->IsId(realId);
+    for (int i = 0; i < vtkEnSightReader::NUMBER_OF_ELEMENT_TYPES; ++i)
+      {
+      vtkIdList *ids =
+        cellIds[p*vtkEnSightReader::NUMBER_OF_ELEMENT_TYPES + i];
+      if (ids)
+        {
+        this->GetCellIds(idx, i)->DeepCopy(ids);
+        }
+      else
+        {
+        this->GetCellIds(idx, i)->Reset();
+        }
+      }
+    }
+
+  return 1;
+}
+
 //----------------------------------------------------------------------------
 int vtkEnSightGoldBinaryReader::CreateUnstructuredGridOutput(
   int partId, char line[80], const char* name,
@@ -4241,6 +5039,8 @@ int vtkEnSightGoldBinaryReader::ReadFloatArray(float *result,
 void vtkEnSightGoldBinaryReader::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "UsePartIndex: " << this->UsePartIndex << endl;
 }
 
 // Seeks the IFile to the cached timestep nearest the target timestep.
@@ -31,6 +31,23 @@
 // what types they will be.
 // This reader can only handle static EnSight datasets (both static geometry
 // and variables).
+//
+// When UsePartIndex is on, variable files are not parsed part by part.
+// Instead the byte offsets of every part are indexed the first time a file
+// of a variable is read; the file is then read with a single large read and
+// its parts are decoded concurrently with vtkSMPTools. The index is reused
+// for the files of the same variable at other time steps as long as the
+// file size matches, the part headers are found at the indexed offsets and
+// the number of values of each part matches the current geometry. It is
+// rebuilt when the file it was built from is modified.
+//
+// The geometry file is indexed the same way when UsePartIndex is on: the
+// offset of every part is recorded once per file, and the parts are then
+// parsed concurrently, each range of parts by a clone of the reader that
+// reads the file through its own stream. The outputs are added to the
+// multiblock in part order. A part that does not end where the next one
+// starts discards the index, and the file is parsed serially if a new
+// index does not describe it either.
 // .SECTION Thanks
 // Thanks to Yvan Fournier for providing the code to support nfaced elements.
 
@@ -50,6 +67,15 @@ public:
   vtkTypeMacro(vtkEnSightGoldBinaryReader, vtkEnSightReader);
   virtual void PrintSelf(ostream& os, vtkIndent indent);
 
+  // Description:
+  // Turn on/off indexed, concurrent reading of the parts of the geometry
+  // and variable files. Measured geometry and variables, file sets (several
+  // time steps per file) and Fortran binary files are always read
+  // serially. Off by default.
+  vtkSetMacro(UsePartIndex, int);
+  vtkGetMacro(UsePartIndex, int);
+  vtkBooleanMacro(UsePartIndex, int);
+
 protected:
   vtkEnSightGoldBinaryReader();
   ~vtkEnSightGoldBinaryReader();
@@ -117,6 +143,73 @@ protected:
   virtual int ReadTensorsPerElement(const char* fileName, const char* description,
     int timeStep, vtkMultiBlockDataSet *output);
 
+  // Description:
+  // Read a variable file through the part index, building the index first
+  // when there is none for this variable or the file layout changed.
+  // fileComponents is the number of float arrays stored per part (or per
+  // element type) in the file, and they are written to components
+  // component ... component+fileComponents-1 of an array with
+  // numberOfComponents components. attributeType is the vtkDataSetAttributes
+  // attribute the array is made active as if none is set yet, or -1.
+  // Returns 1 on success, 0 on error and -1 if the file cannot be read
+  // through the index, in which case the caller reads it serially.
+  int ReadIndexedVariable(const char* fileName, const char* description,
+    int perElement, int fileComponents, int numberOfComponents,
+    int component, int attributeType, vtkMultiBlockDataSet *output);
+
+  // Description:
+  // Record the offsets of the parts and value arrays of the variable file
+  // that is open in IFile. Returns 0 if the layout is not understood.
+  //BTX
+  class FileLayoutInternal;
+  int BuildPartIndex(int perElement, int fileComponents,
+    vtkMultiBlockDataSet *output, FileLayoutInternal *layout);
+  //ETX
+
+  // Description:
+  // Check the part headers of a variable file read into buffer against the
+  // layout, and the value counts against the current geometry. Returns 0 if
+  // the layout does not describe the file.
+  //BTX
+  int CheckPartIndex(const char *buffer, int perElement,
+    vtkMultiBlockDataSet *output, FileLayoutInternal *layout);
+  //ETX
+
+  // Description:
+  // Read the geometry file through the part index, building the index first
+  // when there is none for this file or the file changed. Returns 1 on
+  // success, 0 on error and -1 if the file cannot be read through the
+  // index, in which case the caller reads it serially.
+  int ReadIndexedGeometry(const char* fileName, vtkMultiBlockDataSet *output);
+
+  // Description:
+  // Record the offsets of the parts of the geometry file that is open in
+  // IFile, whose first "part" line has just been read into line. Returns 0
+  // if the layout is not understood.
+  //BTX
+  int BuildGeometryIndex(char line[80], FileLayoutInternal *layout);
+  //ETX
+
+  // Description:
+  // Parse the part of the open geometry file at offset, which must be the
+  // EnSight part partId, into block realId of output. end is the offset of
+  // the next part, or -1 for the last part of the file. Returns the result
+  // of the Create*Output method, or -2 if the part is not found at offset
+  // or does not end at end.
+  int ReadGeometryPart(vtkTypeInt64 offset, vtkTypeInt64 end, int partId,
+    int realId, vtkMultiBlockDataSet *output);
+
+  // Description:
+  // Read the header of the geometry file up to its first "part" line, which
+  // is left in line. Returns the result of reading that line.
+  int ReadGeometryHeader(char line[80]);
+
+  // Description:
+  // Create the output of the part whose first line (after the part
+  // description) is in line, with the Create*Output method for its type.
+  int CreatePartOutput(int realId, char line[80], const char* name,
+    vtkMultiBlockDataSet *output);
+
   // Description:
   // Read an unstructured part (partId) from the geometry file and create a
   // vtkUnstructuredGrid output.  Return 0 if EOF reached. Return -1 if
@@ -186,6 +279,7 @@ protected:
   int SkipUnstructuredGrid(char line[256]);
   int SkipRectilinearGrid(char line[256]);
   int SkipImageData(char line[256]);
+  int SkipPart(char line[80]);
 
   // Description:
   // Seeks the IFile to the nearest time step that is <= the target time step
@@ -210,8 +304,14 @@ protected:
   //BTX
   class FileOffsetMapInternal;
   FileOffsetMapInternal *FileOffsets;
+  class PartIndexInternal;
+  PartIndexInternal *PartIndex;
+  class GeometryPartsInternal;
+  friend class GeometryPartsInternal;
   //ETX
 
+  int UsePartIndex;
+
 private:
   int SizeOfInt;
   vtkEnSightGoldBinaryReader(const vtkEnSightGoldBinaryReader&);  // Not implemented.
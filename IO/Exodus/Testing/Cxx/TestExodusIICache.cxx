@@ -0,0 +1,257 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestExodusIICache.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Tests the byte accounting, scopes and statistics of vtkExodusIICache,
+// that arrays returned by FindArray() outlive their eviction, that readers
+// share the global cache by default, and that a reader
+// prefetching the next time step into a shared cache produces the same
+// output as one reading each step on demand.
+
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDataSet.h"
+#include "vtkDoubleArray.h"
+#include "vtkExodusIICache.h"
+#include "vtkExodusIIReader.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+
+static vtkDoubleArray* NewArray(vtkIdType numValues)
+{
+  vtkDoubleArray* arr = vtkDoubleArray::New();
+  arr->SetNumberOfTuples(numValues);
+  return arr;
+}
+
+static int TestCache()
+{
+  vtkNew<vtkExodusIICache> cache;
+  const vtkIdType numValues = 1024; // 8 KiB
+  cache->SetCacheCapacityInBytes(3 * numValues * 8);
+
+  int scopeA = vtkExodusIICache::NewScope();
+  int scopeB = vtkExodusIICache::NewScope();
+  if (scopeA == scopeB)
+    {
+    cerr << "NewScope returned the same scope twice\n";
+    return 1;
+    }
+
+  vtkExodusIICacheKey keys[4];
+  for (int i = 0; i < 4; ++i)
+    {
+    keys[i] = vtkExodusIICacheKey(0, vtkExodusIIReader::NODAL, 0, i % 2);
+    keys[i].Scope = i < 2 ? scopeA : scopeB;
+    vtkDoubleArray* arr = NewArray(numValues);
+    cache->Insert(keys[i], arr);
+    arr->Delete();
+    }
+
+  // The oldest entry must have been dropped to stay within 3 arrays.
+  if (cache->GetSizeInBytes() != 3 * numValues * 8 ||
+      cache->GetNumberOfInsertions() != 4 ||
+      cache->GetNumberOfEvictions() != 1)
+    {
+    cerr << "Wrong size (" << cache->GetSizeInBytes() << ") or counts after insertion\n";
+    return 1;
+    }
+  if (cache->FindArray(keys[0]) || !cache->FindArray(keys[1]) ||
+      !cache->FindArray(keys[2]) || !cache->FindArray(keys[3]))
+    {
+    cerr << "Wrong entry evicted\n";
+    return 1;
+    }
+  if (cache->GetNumberOfHits() != 3 || cache->GetNumberOfMisses() != 1)
+    {
+    cerr << "Wrong hit or miss count\n";
+    return 1;
+    }
+
+  // Keys with equal fields but different scopes are distinct, and an
+  // all-zero pattern only drops the entries of one scope.
+  vtkExodusIICacheKey all(0, 0, 0, 0);
+  all.Scope = scopeB;
+  if (cache->Invalidate(all, vtkExodusIICacheKey(0, 0, 0, 0)) != 2 ||
+      !cache->FindArray(keys[1]) || cache->GetSizeInBytes() != numValues * 8)
+    {
+    cerr << "Invalidating one scope touched another\n";
+    return 1;
+    }
+
+  cache->ResetStatistics();
+  vtkSmartPointer<vtkDataArray> found = cache->FindArray(keys[1]);
+  cache->SetCacheCapacityInBytes(0);
+  if (cache->GetSizeInBytes() != 0 || cache->GetNumberOfEvictions() != 1)
+    {
+    cerr << "Shrinking the cache did not evict\n";
+    return 1;
+    }
+  if (found->GetReferenceCount() != 1 ||
+      found->GetNumberOfTuples() != numValues)
+    {
+    cerr << "The array found was not kept alive after its eviction\n";
+    return 1;
+    }
+  return 0;
+}
+
+static int TestGlobalCache()
+{
+  vtkExodusIICache* global = vtkExodusIICache::GetGlobalCache();
+  vtkNew<vtkExodusIIReader> a;
+  vtkNew<vtkExodusIIReader> b;
+  if (a->GetCache() != global || b->GetCache() != global ||
+      vtkExodusIICache::GetGlobalCache() != global)
+    {
+    cerr << "The readers do not share the global cache\n";
+    return 1;
+    }
+
+  // The capacity of the global cache is the budget of all its readers.
+  double capacity = a->GetCacheSize();
+  a->SetCacheSize(capacity + 1);
+  if (b->GetCacheSize() != capacity + 1 ||
+      global->GetCacheCapacityInBytes() !=
+        static_cast<vtkTypeInt64>((capacity + 1) * 1048576.))
+    {
+    cerr << "The readers do not share the global capacity\n";
+    return 1;
+    }
+
+  b->SetCache(NULL);
+  if (b->GetCache() == global || b->GetCacheSize() != capacity + 1)
+    {
+    cerr << "Setting a NULL cache did not give a private cache\n";
+    return 1;
+    }
+  b->SetCacheSize(1);
+  a->SetCacheSize(capacity);
+  if (b->GetCacheSize() != 1 || global->GetCacheCapacityInBytes() !=
+        static_cast<vtkTypeInt64>(capacity * 1048576.))
+    {
+    cerr << "The private cache shares its capacity\n";
+    return 1;
+    }
+  return 0;
+}
+
+static int CompareArrays(vtkFieldData* a, vtkFieldData* b, int step)
+{
+  if (a->GetNumberOfArrays() != b->GetNumberOfArrays())
+    {
+    cerr << "Number of arrays differ at time step " << step << "\n";
+    return 1;
+    }
+  for (int i = 0; i < a->GetNumberOfArrays(); ++i)
+    {
+    vtkDataArray* x = a->GetArray(i);
+    vtkDataArray* y = x ? b->GetArray(x->GetName()) : 0;
+    if (!x || !y)
+      {
+      continue;
+      }
+    if (x->GetNumberOfTuples() != y->GetNumberOfTuples() ||
+        x->GetNumberOfComponents() != y->GetNumberOfComponents())
+      {
+      cerr << x->GetName() << " differs in size at time step " << step << "\n";
+      return 1;
+      }
+    for (vtkIdType t = 0; t < x->GetNumberOfTuples(); ++t)
+      {
+      for (int c = 0; c < x->GetNumberOfComponents(); ++c)
+        {
+        if (x->GetComponent(t, c) != y->GetComponent(t, c))
+          {
+          cerr << x->GetName() << " differs at time step " << step << "\n";
+          return 1;
+          }
+        }
+      }
+    }
+  return 0;
+}
+
+static vtkDataSet* GetFirstBlock(vtkExodusIIReader* rdr)
+{
+  vtkMultiBlockDataSet* blocks = vtkMultiBlockDataSet::SafeDownCast(
+    rdr->GetOutput()->GetBlock(0));
+  return blocks ? vtkDataSet::SafeDownCast(blocks->GetBlock(0)) : 0;
+}
+
+int TestExodusIICache(int argc, char* argv[])
+{
+  if (TestCache() || TestGlobalCache())
+    {
+    return 1;
+    }
+
+  char* fname = vtkTestUtilities::ExpandDataFileName(
+    argc, argv, "Data/box-noglom.ex2");
+  if (!fname)
+    {
+    cout << "Could not obtain filename for test data.\n";
+    return 1;
+    }
+
+  // Two readers share a cache; only one of them prefetches.
+  vtkNew<vtkExodusIICache> cache;
+  vtkNew<vtkExodusIIReader> prefetched;
+  vtkNew<vtkExodusIIReader> plain;
+  vtkExodusIIReader* readers[2] = { prefetched.GetPointer(), plain.GetPointer() };
+  for (int r = 0; r < 2; ++r)
+    {
+    readers[r]->SetFileName(fname);
+    readers[r]->SetCache(cache.GetPointer());
+    if (readers[r]->GetCache() != cache.GetPointer())
+      {
+      cerr << "The cache was not shared\n";
+      return 1;
+      }
+    readers[r]->SetCacheSize(64);
+    readers[r]->UpdateInformation();
+    readers[r]->SetAllArrayStatus(vtkExodusIIReader::NODAL, 1);
+    readers[r]->SetAllArrayStatus(vtkExodusIIReader::ELEM_BLOCK, 1);
+    }
+  delete[] fname;
+  prefetched->PrefetchNextTimeStepOn();
+
+  int range[2];
+  prefetched->GetTimeStepRange(range);
+  for (int step = range[0]; step <= range[1] && step < range[0] + 4; ++step)
+    {
+    // The prefetch thread of the previous step may still be running here.
+    prefetched->SetTimeStep(step);
+    prefetched->Update();
+    plain->SetTimeStep(step);
+    plain->Update();
+
+    vtkDataSet* a = GetFirstBlock(prefetched.GetPointer());
+    vtkDataSet* b = GetFirstBlock(plain.GetPointer());
+    if (!a || !b)
+      {
+      cerr << "Missing output at time step " << step << "\n";
+      return 1;
+      }
+    if (CompareArrays(a->GetPointData(), b->GetPointData(), step) ||
+        CompareArrays(a->GetCellData(), b->GetCellData(), step))
+      {
+      return 1;
+      }
+    }
+
+  return 0;
+}
@@ -67,171 +67,317 @@ void printLRUBack( vtkExodusIICacheRef& cit )
 
 vtkStandardNewMacro(vtkExodusIICache);
 
+static vtkSimpleCriticalSection vtkExodusIICacheScopeLock;
+static int vtkExodusIICacheLastScope = 0;
+static vtkExodusIICache* vtkExodusIICacheGlobal = 0;
+
+// Deletes the global cache when the program exits.
+class vtkExodusIICacheCleanup
+{
+public:
+  ~vtkExodusIICacheCleanup()
+    {
+    if ( vtkExodusIICacheGlobal )
+      {
+      vtkExodusIICacheGlobal->Delete();
+      vtkExodusIICacheGlobal = 0;
+      }
+    }
+};
+static vtkExodusIICacheCleanup vtkExodusIICacheCleanupGlobal;
+
 vtkExodusIICache::vtkExodusIICache()
 {
-  this->Size = 0.;
-  this->Capacity = 2.;
+  this->Size = 0;
+  this->Capacity = 2 << 20;
+  this->NumberOfHits = 0;
+  this->NumberOfMisses = 0;
+  this->NumberOfInsertions = 0;
+  this->NumberOfEvictions = 0;
 }
 
 vtkExodusIICache::~vtkExodusIICache()
 {
-  this->ReduceToSize( 0. );
+  while ( ! this->Cache.empty() )
+    {
+    this->Erase( this->Cache.begin() );
+    }
 }
 
 void vtkExodusIICache::PrintSelf( ostream& os, vtkIndent indent )
 {
   this->Superclass::PrintSelf( os, indent );
-  os << indent << "Capacity: " << this->Capacity << " MiB\n";
-  os << indent << "Size: " << this->Size << " MiB\n";
+  this->Lock.Lock();
+  os << indent << "Capacity: " << this->Capacity / 1048576. << " MiB\n";
+  os << indent << "Size: " << this->Size / 1048576. << " MiB\n";
   os << indent << "Cache: " << &this->Cache << " (" << this->Cache.size() << ")\n";
   os << indent << "LRU: " << &this->LRU << "\n";
+  os << indent << "Hits: " << this->NumberOfHits << "\n";
+  os << indent << "Misses: " << this->NumberOfMisses << "\n";
+  os << indent << "Insertions: " << this->NumberOfInsertions << "\n";
+  os << indent << "Evictions: " << this->NumberOfEvictions << "\n";
+  this->Lock.Unlock();
 }
 
 void vtkExodusIICache::Clear()
 {
   //printCache( this->Cache, this->LRU );
-  this->ReduceToSize( 0. );
+  this->Lock.Lock();
+  while ( ! this->Cache.empty() )
+    {
+    this->Erase( this->Cache.begin() );
+    }
+  this->Lock.Unlock();
 }
 
 void vtkExodusIICache::SetCacheCapacity( double sizeInMiB )
 {
-  if ( sizeInMiB == this->Capacity )
-    return;
+  this->SetCacheCapacityInBytes(
+    sizeInMiB < 0 ? 0 : static_cast<vtkTypeInt64>( sizeInMiB * 1048576. ) );
+}
 
-  if ( this->Size > sizeInMiB )
+void vtkExodusIICache::SetCacheCapacityInBytes( vtkTypeInt64 capacity )
+{
+  this->Lock.Lock();
+  if ( capacity < 0 )
     {
-    this->ReduceToSize( sizeInMiB );
+    capacity = 0;
     }
+  if ( this->Size > capacity )
+    {
+    this->ReduceToSizeInternal( capacity );
+    }
+  this->Capacity = capacity;
+  this->Lock.Unlock();
+}
 
-  this->Capacity =  sizeInMiB < 0 ? 0 : sizeInMiB;
+vtkTypeInt64 vtkExodusIICache::GetCacheCapacityInBytes()
+{
+  this->Lock.Lock();
+  vtkTypeInt64 capacity = this->Capacity;
+  this->Lock.Unlock();
+  return capacity;
+}
+
+vtkTypeInt64 vtkExodusIICache::GetSizeInBytes()
+{
+  this->Lock.Lock();
+  vtkTypeInt64 size = this->Size;
+  this->Lock.Unlock();
+  return size;
+}
+
+double vtkExodusIICache::GetSpaceLeft()
+{
+  this->Lock.Lock();
+  double left = ( this->Capacity - this->Size ) / 1048576.;
+  this->Lock.Unlock();
+  return left;
 }
 
 int vtkExodusIICache::ReduceToSize( double newSize )
+{
+  this->Lock.Lock();
+  int deletedSomething = this->ReduceToSizeInternal(
+    newSize < 0 ? 0 : static_cast<vtkTypeInt64>( newSize * 1048576. ) );
+  this->Lock.Unlock();
+  return deletedSomething;
+}
+
+int vtkExodusIICache::NewScope()
+{
+  vtkExodusIICacheScopeLock.Lock();
+  int scope = ++vtkExodusIICacheLastScope;
+  vtkExodusIICacheScopeLock.Unlock();
+  return scope;
+}
+
+vtkExodusIICache* vtkExodusIICache::GetGlobalCache()
+{
+  vtkExodusIICacheScopeLock.Lock();
+  if ( ! vtkExodusIICacheGlobal )
+    {
+    vtkExodusIICacheGlobal = vtkExodusIICache::New();
+    vtkExodusIICacheGlobal->SetCacheCapacity( 100. );
+    }
+  vtkExodusIICache* cache = vtkExodusIICacheGlobal;
+  vtkExodusIICacheScopeLock.Unlock();
+  return cache;
+}
+
+vtkTypeInt64 vtkExodusIICache::GetNumberOfHits()
+{
+  this->Lock.Lock();
+  vtkTypeInt64 n = this->NumberOfHits;
+  this->Lock.Unlock();
+  return n;
+}
+
+vtkTypeInt64 vtkExodusIICache::GetNumberOfMisses()
+{
+  this->Lock.Lock();
+  vtkTypeInt64 n = this->NumberOfMisses;
+  this->Lock.Unlock();
+  return n;
+}
+
+vtkTypeInt64 vtkExodusIICache::GetNumberOfInsertions()
+{
+  this->Lock.Lock();
+  vtkTypeInt64 n = this->NumberOfInsertions;
+  this->Lock.Unlock();
+  return n;
+}
+
+vtkTypeInt64 vtkExodusIICache::GetNumberOfEvictions()
+{
+  this->Lock.Lock();
+  vtkTypeInt64 n = this->NumberOfEvictions;
+  this->Lock.Unlock();
+  return n;
+}
+
+void vtkExodusIICache::ResetStatistics()
+{
+  this->Lock.Lock();
+  this->NumberOfHits = 0;
+  this->NumberOfMisses = 0;
+  this->NumberOfInsertions = 0;
+  this->NumberOfEvictions = 0;
+  this->Lock.Unlock();
+}
+
+vtkTypeInt64 vtkExodusIICache::GetArraySize( vtkDataArray* arr )
+{
+  // Account for the allocated storage rather than the number of values
+  // in use, since that is what the array actually holds on to.
+  return arr ?
+    static_cast<vtkTypeInt64>( arr->GetSize() ) * arr->GetDataTypeSize() : 0;
+}
+
+int vtkExodusIICache::ReduceToSizeInternal( vtkTypeInt64 newSize )
 {
   int deletedSomething = 0;
   while ( this->Size > newSize && ! this->LRU.empty() )
     {
     vtkExodusIICacheRef cit( this->LRU.back() );
-    vtkDataArray* arr = cit->second->Value;
-    if ( arr )
-      {
-      deletedSomething = 1;
-      double arrSz = (double) arr->GetActualMemorySize() / 1024.;
-      this->Size -= arrSz;
 #ifdef VTK_EXO_DBG_CACHE
-      cout << "Dropping " << VTK_EXO_PRT_KEY( cit->first ) << VTK_EXO_PRT_ARR( arr ) << "\n";
+    vtkDataArray* arr = cit->second->Value;
+    cout << "Dropping " << VTK_EXO_PRT_KEY( cit->first ) << VTK_EXO_PRT_ARR( arr ) << "\n";
 #endif // VTK_EXO_DBG_CACHE
-      if ( this->Size <= 0 )
-        {
-        if ( this->Cache.size() == 0 )
-          this->Size = 0.;
-        else
-          this->RecomputeSize(); // oops, FP roundoff
-        }
-      }
-    else
+    if ( cit->second->Value )
       {
-#ifdef VTK_EXO_DBG_CACHE
-      cout << "Dropping " << VTK_EXO_PRT_KEY( cit->first ) << VTK_EXO_PRT_ARR( arr ) << "\n";
-#endif // VTK_EXO_DBG_CACHE
+      deletedSomething = 1;
       }
-
-    delete cit->second;
-    this->Cache.erase( cit );
-    this->LRU.pop_back();
-    }
-
-  if ( this->Cache.size() == 0 )
-    {
-    this->Size = 0;
+    ++this->NumberOfEvictions;
+    this->Erase( cit );
     }
 
   return deletedSomething;
 }
 
+void vtkExodusIICache::Erase( vtkExodusIICacheRef it )
+{
+  this->LRU.erase( it->second->LRUEntry );
+  this->Size -= GetArraySize( it->second->Value );
+  delete it->second;
+  this->Cache.erase( it );
+}
+
 void vtkExodusIICache::Insert( vtkExodusIICacheKey& key, vtkDataArray* value )
 {
-  double vsize = value ? value->GetActualMemorySize() / 1024. : 0.;
+  vtkTypeInt64 vsize = GetArraySize( value );
 
+  this->Lock.Lock();
   vtkExodusIICacheRef it = this->Cache.find( key );
   if ( it != this->Cache.end() )
     {
     if ( it->second->Value == value )
+      {
+      this->Lock.Unlock();
       return;
+      }
 
     // Remove existing array and put in our new one.
-    this->Size -= vsize;
-    if ( this->Size <= 0 )
-      {
-      this->RecomputeSize();
-      }
-    this->ReduceToSize( this->Capacity - vsize );
-    it->second->Value->Delete();
-    it->second->Value = value;
-    it->second->Value->Register( 0 ); // Since we re-use the cache entry, the constructor's Register won't get called.
-    this->Size += vsize;
+    this->Erase( it );
+    }
+
+  // Even if the array is larger than the capacity, it is kept as the
+  // most recent insertion.
+  this->ReduceToSizeInternal( this->Capacity - vsize );
+  std::pair<const vtkExodusIICacheKey,vtkExodusIICacheEntry*> entry( key, new vtkExodusIICacheEntry(value) );
+  std::pair<vtkExodusIICacheSet::iterator, bool> iret = this->Cache.insert( entry );
+  this->Size += vsize;
+  ++this->NumberOfInsertions;
 #ifdef VTK_EXO_DBG_CACHE
-    cout << "Replacing " << VTK_EXO_PRT_KEY( it->first ) << VTK_EXO_PRT_ARR( value ) << "\n";
+  cout << "Adding " << VTK_EXO_PRT_KEY( key ) << VTK_EXO_PRT_ARR( value ) << "\n";
 #endif // VTK_EXO_DBG_CACHE
+  iret.first->second->LRUEntry = this->LRU.insert( this->LRU.begin(), iret.first );
+  //printCache( this->Cache, this->LRU );
+  this->Lock.Unlock();
+}
+
+vtkSmartPointer<vtkDataArray> vtkExodusIICache::FindArray( vtkExodusIICacheKey key )
+{
+  vtkSmartPointer<vtkDataArray> value;
+
+  this->Lock.Lock();
+  vtkExodusIICacheRef it = this->Cache.find( key );
+  if ( it != this->Cache.end() )
+    {
     this->LRU.erase( it->second->LRUEntry );
     it->second->LRUEntry = this->LRU.insert( this->LRU.begin(), it );
+    value = it->second->Value;
+    ++this->NumberOfHits;
     }
   else
     {
-    this->ReduceToSize( this->Capacity - vsize );
-    std::pair<const vtkExodusIICacheKey,vtkExodusIICacheEntry*> entry( key, new vtkExodusIICacheEntry(value) );
-    std::pair<vtkExodusIICacheSet::iterator, bool> iret = this->Cache.insert( entry );
-    this->Size += vsize;
-#ifdef VTK_EXO_DBG_CACHE
-    cout << "Adding " << VTK_EXO_PRT_KEY( key ) << VTK_EXO_PRT_ARR( value ) << "\n";
-#endif // VTK_EXO_DBG_CACHE
-    iret.first->second->LRUEntry = this->LRU.insert( this->LRU.begin(), iret.first );
+    ++this->NumberOfMisses;
     }
-  //printCache( this->Cache, this->LRU );
+  this->Lock.Unlock();
+
+  return value;
 }
 
+#ifndef VTK_LEGACY_REMOVE
 vtkDataArray*& vtkExodusIICache::Find( vtkExodusIICacheKey key )
 {
+  VTK_LEGACY_REPLACED_BODY(vtkExodusIICache::Find, "VTK 6.3",
+                           vtkExodusIICache::FindArray);
   static vtkDataArray* dummy = 0;
 
+  this->Lock.Lock();
   vtkExodusIICacheRef it = this->Cache.find( key );
   if ( it != this->Cache.end() )
     {
     this->LRU.erase( it->second->LRUEntry );
     it->second->LRUEntry = this->LRU.insert( this->LRU.begin(), it );
+    ++this->NumberOfHits;
+    this->Lock.Unlock();
     return it->second->Value;
     }
+  ++this->NumberOfMisses;
+  this->Lock.Unlock();
 
   dummy = 0;
   return dummy;
 }
+#endif
 
 int vtkExodusIICache::Invalidate( vtkExodusIICacheKey key )
 {
+  this->Lock.Lock();
   vtkExodusIICacheRef it = this->Cache.find( key );
   if ( it != this->Cache.end() )
     {
 #ifdef VTK_EXO_DBG_CACHE
     cout << "Dropping " << VTK_EXO_PRT_KEY( it->first ) << VTK_EXO_PRT_ARR( it->second->Value ) << "\n";
 #endif // VTK_EXO_DBG_CACHE
-    this->LRU.erase( it->second->LRUEntry );
-    if ( it->second->Value )
-      {
-      this->Size -= it->second->Value->GetActualMemorySize() / 1024.;
-      }
-    delete it->second;
-    this->Cache.erase( it );
-
-    if ( this->Size <= 0 )
-      {
-      if ( this->Cache.size() == 0 )
-        this->Size = 0.;
-      else
-        this->RecomputeSize(); // oops, FP roundoff
-      }
-
+    this->Erase( it );
+    this->Lock.Unlock();
     return 1;
     }
+  this->Lock.Unlock();
   return 0;
 }
 
@@ -239,6 +385,7 @@ int vtkExodusIICache::Invalidate( vtkExodusIICacheKey key, vtkExodusIICacheKey p
 {
   vtkExodusIICacheRef it;
   int nDropped = 0;
+  this->Lock.Lock();
   it = this->Cache.begin();
   while ( it != this->Cache.end() )
     {
@@ -251,37 +398,11 @@ int vtkExodusIICache::Invalidate( vtkExodusIICacheKey key, vtkExodusIICacheKey p
 #ifdef VTK_EXO_DBG_CACHE
     cout << "Dropping " << VTK_EXO_PRT_KEY( it->first ) << VTK_EXO_PRT_ARR( it->second->Value ) << "\n";
 #endif // VTK_EXO_DBG_CACHE
-    this->LRU.erase( it->second->LRUEntry );
-    if ( it->second->Value )
-      {
-      this->Size -= it->second->Value->GetActualMemorySize() / 1024.;
-      }
     vtkExodusIICacheRef tmpIt = it++;
-    delete tmpIt->second;
-    this->Cache.erase( tmpIt );
-
-    if ( this->Size <= 0 )
-      {
-      if ( this->Cache.size() == 0 )
-        this->Size = 0.;
-      else
-        this->RecomputeSize(); // oops, FP roundoff
-      }
+    this->Erase( tmpIt );
 
     ++nDropped;
     }
+  this->Lock.Unlock();
   return nDropped;
 }
-
-void vtkExodusIICache::RecomputeSize()
-{
-  this->Size = 0.;
-  vtkExodusIICacheRef it;
-  for ( it = this->Cache.begin(); it != this->Cache.end(); ++it )
-    {
-    if ( it->second->Value )
-      {
-      this->Size += (double)it->second->Value->GetActualMemorySize() / 1024.;
-      }
-    }
-}
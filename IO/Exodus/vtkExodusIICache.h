@@ -11,20 +11,36 @@
 // these containers are sorted for fast retrieval:
 // 1. The cache entries are indexed by the timestep, the
 //    object type (edge block, face set, ...), and the
-//    object ID (if one exists). When you call Find() to
+//    object ID (if one exists). When you call FindArray() to
 //    retrieve a cache entry, you provide a key containing
 //    this information and the array is returned if it exists.
 // 2. The list of cache references are stored in "least-recently-used"
 //    order. The least recently referenced array is the first in
-//    the list. Whenever you request an entry with Find(), it is
+//    the list. Whenever you request an entry with FindArray(), it is
 //    moved to the back of the list if it exists.
 // This makes retrieving arrays O(n log n) and popping LRU
 // entries O(1). Each cache entry stores an iterator into
 // the list of references so that it can be located quickly for
 // removal.
+//
+// The size of the cache is accounted in bytes (the allocated size
+// of each array) against a single budget, so one cache may be shared
+// by several readers (e.g., all the files of a vtkPExodusIIReader).
+// Keys carry a Scope that readers sharing a cache use to keep their
+// entries apart; call NewScope() to obtain one. All members lock the
+// cache, so it may be used from several threads at once (the reader
+// prefetches the next time step from a background thread). FindArray()
+// returns a reference to the array, so the array stays alive even if
+// another thread evicts it.
+//
+// Unless they are given a cache of their own, all readers share the
+// process-wide cache returned by GetGlobalCache(), so that a single
+// capacity bounds the memory held by the arrays cached for all of them.
 
 #include "vtkIOExodusModule.h" // For export macro
 #include "vtkObject.h"
+#include "vtkSimpleCriticalSection.h" // For Lock
+#include "vtkSmartPointer.h" // For FindArray
 
 #include <map> // used for cache storage
 #include <list> // use for LRU ordering
@@ -33,12 +49,14 @@
 class VTKIOEXODUS_EXPORT vtkExodusIICacheKey
 {
 public:
+  int Scope;
   int Time;
   int ObjectType;
   int ObjectId;
   int ArrayId;
   vtkExodusIICacheKey()
     {
+    Scope = 0;
     Time = -1;
     ObjectType = -1;
     ObjectId = -1;
@@ -46,6 +64,7 @@ public:
     }
   vtkExodusIICacheKey( int time, int objType, int objId, int arrId )
     {
+    Scope = 0;
     Time = time;
     ObjectType = objType;
     ObjectId = objId;
@@ -53,6 +72,7 @@ public:
     }
   vtkExodusIICacheKey( const vtkExodusIICacheKey& src )
     {
+    Scope = src.Scope;
     Time = src.Time;
     ObjectType = src.ObjectType;
     ObjectId = src.ObjectId;
@@ -60,14 +80,18 @@ public:
     }
   vtkExodusIICacheKey& operator = ( const vtkExodusIICacheKey& src )
     {
+    Scope = src.Scope;
     Time = src.Time;
     ObjectType = src.ObjectType;
     ObjectId = src.ObjectId;
     ArrayId = src.ArrayId;
     return *this;
     }
+  /// Keys of different scopes never match, whatever the pattern.
   bool match( const vtkExodusIICacheKey&other, const vtkExodusIICacheKey& pattern ) const
     {
+    if ( this->Scope != other.Scope )
+      return false;
     if ( pattern.Time && this->Time != other.Time )
       return false;
     if ( pattern.ObjectType && this->ObjectType != other.ObjectType )
@@ -80,6 +104,10 @@ public:
     }
   bool operator < ( const vtkExodusIICacheKey& other ) const
     {
+    if ( this->Scope < other.Scope )
+      return true;
+    else if ( this->Scope > other.Scope )
+      return false;
     if ( this->Time < other.Time )
       return true;
     else if ( this->Time > other.Time )
@@ -139,26 +167,67 @@ public:
   /// Set the maximum allowable cache size. This will remove cache entries if the capacity is reduced below the current size.
   void SetCacheCapacity( double sizeInMiB );
 
+  /// Set the maximum allowable cache size in bytes.
+  void SetCacheCapacityInBytes( vtkTypeInt64 capacity );
+
+  /// Get the maximum allowable cache size in bytes.
+  vtkTypeInt64 GetCacheCapacityInBytes();
+
+  /// Get the size of all the arrays currently held by the cache in bytes.
+  vtkTypeInt64 GetSizeInBytes();
+
   /** See how much cache space is left.
     * This is the difference between the capacity and the size of the cache.
     * The result is in MiB.
     */
-  double GetSpaceLeft()
-    { return this->Capacity - this->Size; }
+  double GetSpaceLeft();
 
   /** Remove cache entries until the size of the cache is at or below the given size.
     * Returns a nonzero value if deletions were required.
     */
   int ReduceToSize( double newSize );
 
+  /** Return a scope not used by any other client of any cache.
+    * Readers sharing a cache set the Scope of their keys to keep their entries apart.
+    */
+  static int NewScope();
+
+  /** Return the cache shared by all the readers that were not given a cache of their own.
+    * Its capacity, 100 MiB unless changed, is the budget of all those readers together.
+    */
+  static vtkExodusIICache* GetGlobalCache();
+
+  /// Number of FindArray() calls that returned an array.
+  vtkTypeInt64 GetNumberOfHits();
+
+  /// Number of FindArray() calls that returned NULL.
+  vtkTypeInt64 GetNumberOfMisses();
+
+  /// Number of arrays inserted into the cache.
+  vtkTypeInt64 GetNumberOfInsertions();
+
+  /// Number of arrays dropped to make space for others (not counting invalidations).
+  vtkTypeInt64 GetNumberOfEvictions();
+
+  /// Reset the hit, miss, insertion and eviction counts.
+  void ResetStatistics();
+
   //BTX
   /// Insert an entry into the cache (this can remove other cache entries to make space).
   void Insert( vtkExodusIICacheKey& key, vtkDataArray* value );
 
   /** Determine whether a cache entry exists. If it does, return it -- otherwise return NULL.
     * If a cache entry exists, it is marked as most recently used.
+    * The array is referenced before the cache is unlocked; hold on to the
+    * returned pointer for as long as the array is used.
+    */
+  vtkSmartPointer<vtkDataArray> FindArray( vtkExodusIICacheKey );
+
+  /** Determine whether a cache entry exists. If it does, return it -- otherwise return NULL.
+    * @deprecated The reference returned is not protected against another thread
+    * evicting the entry; use FindArray() instead.
     */
-  vtkDataArray*& Find( vtkExodusIICacheKey );
+  VTK_LEGACY(vtkDataArray*& Find( vtkExodusIICacheKey ));
 
   /** Invalidate a cache entry (drop it from the cache) if the key exists.
     * This does nothing if the cache entry does not exist.
@@ -169,7 +238,8 @@ public:
   /** Invalidate all cache entries matching a specified pattern, dropping all matches from the cache.
     * Any nonzero entry in the \a pattern forces a comparison between the corresponding value of \a key.
     * Any cache entries satisfying all the comparisons will be dropped.
-    * If pattern is entirely zero, this will empty the entire cache.
+    * Only entries in the scope of \a key are considered, so if pattern is
+    * entirely zero, this will drop all the entries of that scope.
     * This is useful for invalidating all entries of a given object type.
     *
     * Returns the number of cache entries dropped.
@@ -186,14 +256,28 @@ protected:
   ~vtkExodusIICache();
 
 
-  /// Avoid (some) FP problems
-  void RecomputeSize();
+  /// Drop least recently used entries until the size is at or below \a newSize bytes. The cache must be locked.
+  int ReduceToSizeInternal( vtkTypeInt64 newSize );
+
+  /// Drop an entry. The cache must be locked.
+  void Erase( vtkExodusIICacheRef it );
+
+  /// The number of bytes accounted for an array.
+  static vtkTypeInt64 GetArraySize( vtkDataArray* arr );
+
+  /// The capacity of the cache (i.e., the maximum size of all arrays it contains) in bytes.
+  vtkTypeInt64 Capacity;
+
+  /// The current size of the cache (i.e., the size of the all the arrays it currently contains) in bytes.
+  vtkTypeInt64 Size;
 
-  /// The capacity of the cache (i.e., the maximum size of all arrays it contains) in MiB.
-  double Capacity;
+  vtkTypeInt64 NumberOfHits;
+  vtkTypeInt64 NumberOfMisses;
+  vtkTypeInt64 NumberOfInsertions;
+  vtkTypeInt64 NumberOfEvictions;
 
-  /// The current size of the cache (i.e., the size of the all the arrays it currently contains) in MiB.
-  double Size;
+  /// Serializes access to all of the above and the containers below.
+  vtkSimpleCriticalSection Lock;
 
   //BTX
   /** A least-recently-used (LRU) cache to hold arrays.
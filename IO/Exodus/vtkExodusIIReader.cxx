@@ -32,11 +32,13 @@
 #include "vtkMath.h"
 #include "vtkMultiBlockDataSet.h"
 #include "vtkMutableDirectedGraph.h"
+#include "vtkMutexLock.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
 #include "vtkPolyData.h"
+#include "vtkSimpleCriticalSection.h"
 #include "vtkSortDataArray.h"
 #include "vtkStdString.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
@@ -207,6 +209,32 @@ extern "C" { typedef int (*vtkExodusIIGetMapFunc)( int, int* ); }
 #include "vtkExodusIIReaderPrivate.h"
 #include "vtkExodusIIReaderVariableCheck.h"
 
+// ExodusII and netCDF are not thread safe, so every reader (and every
+// prefetch thread) holds this lock while it has a file open.
+static vtkSimpleCriticalSection vtkExodusIIReaderFileLock;
+
+namespace
+{
+class vtkExodusIIReaderFileGuard
+{
+public:
+  vtkExodusIIReaderFileGuard() : Locked( true )
+    { vtkExodusIIReaderFileLock.Lock(); }
+  ~vtkExodusIIReaderFileGuard()
+    { this->Release(); }
+  void Release()
+    {
+    if ( this->Locked )
+      {
+      vtkExodusIIReaderFileLock.Unlock();
+      this->Locked = false;
+      }
+    }
+private:
+  bool Locked;
+};
+}
+
 // --------------------------------------------------- PRIVATE CLASS Implementations
 vtkExodusIIReaderPrivate::BlockSetInfoType::BlockSetInfoType(
   const vtkExodusIIReaderPrivate::BlockSetInfoType &block):
@@ -385,8 +413,15 @@ vtkExodusIIReaderPrivate::vtkExodusIIReaderPrivate()
   this->AppWordSize = 8;
   this->DiskWordSize = 8;
 
-  this->Cache = vtkExodusIICache::New();
-  this->CacheSize = 0;
+  this->Cache = vtkExodusIICache::GetGlobalCache();
+  this->Cache->Register( this );
+  this->CacheScope = vtkExodusIICache::NewScope();
+
+  this->PrefetchNextTimeStep = 0;
+  this->PrefetchThreader = vtkMultiThreader::New();
+  this->PrefetchThreadId = -1;
+  this->PrefetchTimeStep = -1;
+  this->PrefetchFinish = 0;
 
   this->HasModeShapes = 0;
   this->ModeShapeTime = -1.;
@@ -415,9 +450,12 @@ vtkExodusIIReaderPrivate::vtkExodusIIReaderPrivate()
 //-----------------------------------------------------------------------------
 vtkExodusIIReaderPrivate::~vtkExodusIIReaderPrivate()
 {
+  this->StopPrefetch();
+  this->PrefetchThreader->Delete();
   this->CloseFile();
-  this->Cache->Delete();
-  this->CacheSize = 0;
+  // The cache may be shared, so only drop our own entries.
+  this->Cache->Invalidate( this->ScopedCacheKey(), vtkExodusIICacheKey( 0, 0, 0, 0 ) );
+  this->Cache->UnRegister( this );
   this->ClearConnectivityCaches();
   if(this->Parser)
     {
@@ -1622,20 +1660,16 @@ void vtkExodusIIReaderPrivate::InsertSetSides(
 vtkDataArray* vtkExodusIIReaderPrivate::GetCacheOrRead( vtkExodusIICacheKey key )
 {
   vtkDataArray* arr;
+  key.Scope = this->CacheScope;
   // Never cache points deflected for a mode shape animation... doubles don't make good keys.
-  if ( this->HasModeShapes && key.ObjectType == vtkExodusIIReader::NODAL_COORDS )
-    {
-    arr = 0;
-    }
-  else
+  if ( ! this->HasModeShapes || key.ObjectType != vtkExodusIIReader::NODAL_COORDS )
     {
-    arr = this->Cache->Find( key );
-    }
-
-  if ( arr )
-    {
-    //
-    return arr;
+    vtkSmartPointer<vtkDataArray> cached = this->Cache->FindArray( key );
+    if ( cached )
+      {
+      this->HeldArrays.push_back( cached );
+      return cached;
+      }
     }
 
   int exoid = this->Exoid;
@@ -2851,11 +2885,10 @@ vtkDataArray* vtkExodusIIReaderPrivate::GetCacheOrRead( vtkExodusIICacheKey key
     }
 
   // Even if the array is larger than the allowable cache size, it will keep the most recent insertion.
-  // So, we delete our reference knowing that the Cache will keep the object "alive" until whatever
-  // called GetCacheOrRead() references the array. But, once you get an array from GetCacheOrRead(),
-  // you better start running!
+  // Another reader sharing the cache may evict it all the same, so we hold it until ReleaseArrays().
   if ( arr )
     {
+    this->HeldArrays.push_back( arr );
     this->Cache->Insert( key, arr );
     arr->FastDelete();
     }
@@ -3653,6 +3686,8 @@ void vtkExodusIIReaderPrivate::PrintData( ostream& os, vtkIndent indent )
 
   os << indent << "Array Cache:\n";
   this->Cache->PrintSelf( os, inden2 );
+  os << indent << "CacheScope: " << this->CacheScope << "\n";
+  os << indent << "PrefetchNextTimeStep: " << this->PrefetchNextTimeStep << "\n";
 
   os << indent << "SqueezePoints: " << this->SqueezePoints << "\n";
   os << indent << "ApplyDisplacements: " << this->ApplyDisplacements << "\n";
@@ -4492,6 +4527,7 @@ int vtkExodusIIReaderPrivate::SetUpEmptyGrid( vtkMultiBlockDataSet* output )
 
 void vtkExodusIIReaderPrivate::Reset()
 {
+  this->StopPrefetch();
   this->CloseFile();
   this->ResetCache(); // must come before BlockInfo and SetInfo are cleared.
   this->BlockInfo.clear();
@@ -4516,6 +4552,7 @@ void vtkExodusIIReaderPrivate::Reset()
 
 void vtkExodusIIReaderPrivate::ResetSettings()
 {
+  this->StopPrefetch();
   this->GenerateGlobalElementIdArray = 0;
   this->GenerateGlobalNodeIdArray = 0;
   this->GenerateImplicitElementIdArray = 0;
@@ -4539,21 +4576,181 @@ void vtkExodusIIReaderPrivate::ResetSettings()
 
 void vtkExodusIIReaderPrivate::ResetCache()
 {
-  this->Cache->Clear();
-  this->Cache->SetCacheCapacity(this->CacheSize); // FIXME: Perhaps Cache should have a Reset and a Clear method?
+  this->StopPrefetch();
+  this->ReleaseArrays();
+  // The cache may be shared with other readers, so only drop our own entries.
+  this->Cache->Invalidate( this->ScopedCacheKey(), vtkExodusIICacheKey( 0, 0, 0, 0 ) );
   this->ClearConnectivityCaches();
 }
 
+void vtkExodusIIReaderPrivate::SetCache( vtkExodusIICache* cache )
+{
+  if ( cache == this->Cache )
+    {
+    return;
+    }
+
+  this->StopPrefetch();
+  this->Cache->Invalidate( this->ScopedCacheKey(), vtkExodusIICacheKey( 0, 0, 0, 0 ) );
+  if ( cache )
+    {
+    this->Cache->UnRegister( this );
+    this->Cache = cache;
+    this->Cache->Register( this );
+    }
+  else
+    {
+    vtkTypeInt64 capacity = this->Cache->GetCacheCapacityInBytes();
+    this->Cache->UnRegister( this );
+    this->Cache = vtkExodusIICache::New();
+    this->Cache->SetCacheCapacityInBytes( capacity );
+    }
+  this->Modified();
+}
+
+vtkExodusIICacheKey vtkExodusIIReaderPrivate::ScopedCacheKey(
+  int time, int objType, int objId, int arrId )
+{
+  vtkExodusIICacheKey key( time, objType, objId, arrId );
+  key.Scope = this->CacheScope;
+  return key;
+}
+
+static VTK_THREAD_RETURN_TYPE vtkExodusIIReaderPrefetchThread( void* arg )
+{
+  vtkMultiThreader::ThreadInfo* info =
+    static_cast<vtkMultiThreader::ThreadInfo*>( arg );
+  static_cast<vtkExodusIIReaderPrivate*>( info->UserData )->Prefetch( info );
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+static bool vtkExodusIIReaderPrefetchStopped(
+  vtkMultiThreader::ThreadInfo* info, int finish )
+{
+  info->ActiveFlagLock->Lock();
+  int active = *info->ActiveFlag;
+  info->ActiveFlagLock->Unlock();
+  return ! active && ! finish;
+}
+
+void vtkExodusIIReaderPrivate::StartPrefetch( const char* filename, int timeStep )
+{
+  this->StopPrefetch();
+  if ( ! this->PrefetchNextTimeStep || this->HasModeShapes || ! filename ||
+    timeStep < 0 || timeStep >= this->GetNumberOfTimeSteps() )
+    {
+    return;
+    }
+
+  // Collect the keys here rather than on the prefetch thread so that the
+  // array and object selections are not read while the caller changes them.
+  this->PrefetchKeys.clear();
+  std::map<int,std::vector<ArrayInfoType> >::iterator ami;
+  for ( ami = this->ArrayInfo.begin(); ami != this->ArrayInfo.end(); ++ami )
+    {
+    int otyp = ami->first;
+    if ( otyp == vtkExodusIIReader::NODAL )
+      {
+      for ( int aidx = 0; aidx < static_cast<int>( ami->second.size() ); ++aidx )
+        {
+        if ( ami->second[aidx].Status )
+          {
+          this->PrefetchKeys.push_back(
+            vtkExodusIICacheKey( timeStep, vtkExodusIIReader::NODAL, 0, aidx ) );
+          }
+        }
+      continue;
+      }
+
+    int otypidx = this->GetObjectTypeIndexFromObjectType( otyp );
+    if ( otyp == vtkExodusIIReader::GLOBAL || otypidx < 0 )
+      {
+      continue;
+      }
+    int nObj = this->GetNumberOfObjectsAtTypeIndex( otypidx );
+    for ( int obj = 0; obj < nObj; ++obj )
+      {
+      if ( ! this->GetObjectInfo( otypidx, obj )->Status )
+        {
+        continue;
+        }
+      for ( int aidx = 0; aidx < static_cast<int>( ami->second.size() ); ++aidx )
+        {
+        ArrayInfoType& ainfo( ami->second[aidx] );
+        if ( ainfo.Status && obj < static_cast<int>( ainfo.ObjectTruth.size() ) &&
+          ainfo.ObjectTruth[obj] )
+          {
+          this->PrefetchKeys.push_back(
+            vtkExodusIICacheKey( timeStep, otyp, obj, aidx ) );
+          }
+        }
+      }
+    }
+
+  this->PrefetchFileName = filename;
+  this->PrefetchTimeStep = timeStep;
+  this->PrefetchThreadId = this->PrefetchThreader->SpawnThread(
+    vtkExodusIIReaderPrefetchThread, this );
+}
+
+void vtkExodusIIReaderPrivate::StopPrefetch( int timeStep )
+{
+  if ( this->PrefetchThreadId >= 0 )
+    {
+    // TerminateThread() locks the active flag after this is set, so the
+    // prefetch thread sees it as soon as it sees the flag cleared.
+    this->PrefetchFinish = ( timeStep >= 0 && timeStep == this->PrefetchTimeStep );
+    this->PrefetchThreader->TerminateThread( this->PrefetchThreadId );
+    this->PrefetchThreadId = -1;
+    this->PrefetchFinish = 0;
+    }
+}
+
+void vtkExodusIIReaderPrivate::Prefetch( vtkMultiThreader::ThreadInfo* info )
+{
+  vtkExodusIIReaderFileGuard guard;
+  if ( vtkExodusIIReaderPrefetchStopped( info, this->PrefetchFinish ) ||
+    ! this->OpenFile( this->PrefetchFileName.c_str() ) )
+    {
+    return;
+    }
+
+  std::vector<vtkExodusIICacheKey>::iterator it;
+  for ( it = this->PrefetchKeys.begin(); it != this->PrefetchKeys.end(); ++it )
+    {
+    if ( vtkExodusIIReaderPrefetchStopped( info, this->PrefetchFinish ) )
+      {
+      break;
+      }
+    this->GetCacheOrRead( *it );
+    }
+
+  // Displaced coordinates are cached per time step as well.
+  if ( it == this->PrefetchKeys.end() && this->ApplyDisplacements &&
+    this->FindDisplacementVectors( this->PrefetchTimeStep ) )
+    {
+    this->GetCacheOrRead( vtkExodusIICacheKey(
+      this->PrefetchTimeStep, vtkExodusIIReader::NODAL_COORDS, 0, 0 ) );
+    }
+
+  this->ReleaseArrays();
+  this->CloseFile();
+}
+
 void vtkExodusIIReaderPrivate::SetCacheSize( double size )
 {
-  if (this->CacheSize != size)
+  if (this->GetCacheSize() != size)
     {
-    this->CacheSize = size;
-    this->Cache->SetCacheCapacity(this->CacheSize);
+    this->Cache->SetCacheCapacity(size);
     this->Modified();
     }
 }
 
+double vtkExodusIIReaderPrivate::GetCacheSize()
+{
+  return this->Cache->GetCacheCapacityInBytes() / 1048576.;
+}
+
 bool vtkExodusIIReaderPrivate::IsXMLMetadataValid()
 {
   // Make sure that each block id referred to in the metadata arrays exist
@@ -4590,6 +4787,7 @@ void vtkExodusIIReaderPrivate::SetSqueezePoints( int sp )
   if ( this->SqueezePoints == sp )
     return;
 
+  this->StopPrefetch();
   this->SqueezePoints = sp;
   this->Modified();
 
@@ -4687,6 +4885,7 @@ void vtkExodusIIReaderPrivate::SetObjectStatus( int otyp, int k, int stat )
     { // no change => do nothing
     return;
     }
+  this->StopPrefetch();
   oinfop->Status = stat;
 
   this->Modified();
@@ -4706,6 +4905,7 @@ void vtkExodusIIReaderPrivate::SetUnsortedObjectStatus( int otyp, int k, int sta
     { // no change => do nothing
     return;
     }
+  this->StopPrefetch();
   oinfop->Status = stat;
 
   this->Modified();
@@ -4824,6 +5024,7 @@ void vtkExodusIIReaderPrivate::SetObjectArrayStatus( int otyp, int i, int stat )
       // no change => do nothing
       return;
       }
+    this->StopPrefetch();
     it->second[i].Status = stat;
     this->Modified();
     // FIXME: Mark something so we know what's changed since the last RequestData?!
@@ -4834,7 +5035,7 @@ void vtkExodusIIReaderPrivate::SetObjectArrayStatus( int otyp, int i, int stat )
     //vtkExodusIICacheKey key( 0, GLOBAL, 0, i );
     //vtkExodusIICacheKey pattern( 0, 1, 0, 1 );
     this->Cache->Invalidate(
-      vtkExodusIICacheKey( 0, vtkExodusIIReader::GLOBAL, otyp, i ),
+      this->ScopedCacheKey( 0, vtkExodusIIReader::GLOBAL, otyp, i ),
       vtkExodusIICacheKey( 0, 1, 1, 1 ) );
     }
   else
@@ -4981,6 +5182,7 @@ void vtkExodusIIReaderPrivate::SetObjectAttributeStatus( int otyp, int oi, int a
         {
         return;
         }
+      this->StopPrefetch();
       it->second[oi].AttributeStatus[ai] = status;
       this->Modified();
       }
@@ -4994,12 +5196,13 @@ void vtkExodusIIReaderPrivate::SetApplyDisplacements( int d )
   if ( this->ApplyDisplacements == d )
     return;
 
+  this->StopPrefetch();
   this->ApplyDisplacements = d;
   this->Modified();
 
   // Require the coordinates to be recomputed:
   this->Cache->Invalidate(
-    vtkExodusIICacheKey( 0, vtkExodusIIReader::NODAL_COORDS, 0, 0 ),
+    this->ScopedCacheKey( 0, vtkExodusIIReader::NODAL_COORDS, 0, 0 ),
     vtkExodusIICacheKey( 0, 1, 0, 0 ) );
 }
 
@@ -5008,12 +5211,13 @@ void vtkExodusIIReaderPrivate::SetDisplacementMagnitude( double s )
   if ( this->DisplacementMagnitude == s )
     return;
 
+  this->StopPrefetch();
   this->DisplacementMagnitude = s;
   this->Modified();
 
   // Require the coordinates to be recomputed:
   this->Cache->Invalidate(
-    vtkExodusIICacheKey( 0, vtkExodusIIReader::NODAL_COORDS, 0, 0 ),
+    this->ScopedCacheKey( 0, vtkExodusIIReader::NODAL_COORDS, 0, 0 ),
     vtkExodusIICacheKey( 0, 1, 0, 0 ) );
 }
 
@@ -5047,7 +5251,6 @@ vtkExodusIIReader::vtkExodusIIReader()
   this->XMLFileName = 0;
   this->Metadata = vtkExodusIIReaderPrivate::New();
   this->Metadata->Parent = this;
-  this->Metadata->SetCacheSize(0.0);
   this->TimeStep = 0;
   this->TimeStepRange[0] = 0;
   this->TimeStepRange[1] = 0;
@@ -5135,6 +5338,7 @@ unsigned long vtkExodusIIReader::GetMetadataMTime()
   if ( fname && this->propName && !strcmp( fname, this->propName ) ) \
     return; \
   modified = 1; \
+  this->Metadata->StopPrefetch(); \
   delete [] this->propName; \
   if ( fname ) \
     { \
@@ -5202,6 +5406,8 @@ int vtkExodusIIReader::RequestInformation(
   // If the metadata is older than the filename
   if ( this->GetMetadataMTime() < this->FileNameMTime )
     {
+    this->Metadata->StopPrefetch();
+    vtkExodusIIReaderFileGuard guard;
     if ( this->Metadata->OpenFile( this->FileName ) )
       {
       // We need to initialize the XML parser before calling RequestInformation
@@ -5266,12 +5472,6 @@ int vtkExodusIIReader::RequestData(
   vtkInformationVector** vtkNotUsed(inputVector),
   vtkInformationVector* outputVector )
 {
-  if ( ! this->FileName || ! this->Metadata->OpenFile( this->FileName ) )
-    {
-    vtkErrorMacro( "Unable to open file \"" << (this->FileName ? this->FileName : "(null)") << "\" to read data" );
-    return 0;
-    }
-
   vtkInformation* outInfo = outputVector->GetInformationObject(0);
   vtkMultiBlockDataSet *output = vtkMultiBlockDataSet::SafeDownCast( outInfo->Get( vtkDataObject::DATA_OBJECT() ) );
 
@@ -5323,8 +5523,24 @@ int vtkExodusIIReader::RequestData(
       }
     }
 
+  // Let a prefetch of the requested step finish, since that is the work
+  // we are about to do anyway.
+  this->Metadata->StopPrefetch( this->TimeStep );
+  vtkExodusIIReaderFileGuard guard;
+  if ( ! this->FileName || ! this->Metadata->OpenFile( this->FileName ) )
+    {
+    vtkErrorMacro( "Unable to open file \"" << (this->FileName ? this->FileName : "(null)") << "\" to read data" );
+    return 0;
+    }
+
   //cout << "Requesting step " << this->TimeStep << " for output " << output << "\n";
   this->Metadata->RequestData( this->TimeStep, output );
+  this->Metadata->ReleaseArrays();
+  this->Metadata->CloseFile();
+  guard.Release();
+
+  // Read ahead while the output is being processed downstream.
+  this->Metadata->StartPrefetch( this->FileName, this->TimeStep + 1 );
 
   return 1;
 }
@@ -6240,6 +6456,26 @@ double vtkExodusIIReader::GetCacheSize()
   return this->Metadata->GetCacheSize();
 }
 
+void vtkExodusIIReader::SetCache(vtkExodusIICache* cache)
+{
+  this->Metadata->SetCache(cache);
+}
+
+vtkExodusIICache* vtkExodusIIReader::GetCache()
+{
+  return this->Metadata->GetCache();
+}
+
+void vtkExodusIIReader::SetPrefetchNextTimeStep(int prefetch)
+{
+  this->Metadata->SetPrefetchNextTimeStep(prefetch);
+}
+
+int vtkExodusIIReader::GetPrefetchNextTimeStep()
+{
+  return this->Metadata->GetPrefetchNextTimeStep();
+}
+
 void vtkExodusIIReader::SetSqueezePoints(bool sp)
 {
   this->Metadata->SetSqueezePoints(sp ? 1 : 0);
@@ -6257,6 +6493,8 @@ void vtkExodusIIReader::ResetCache()
 
 void vtkExodusIIReader::UpdateTimeInformation()
 {
+  this->Metadata->StopPrefetch();
+  vtkExodusIIReaderFileGuard guard;
   if ( this->Metadata->OpenFile( this->FileName ) )
     {
     this->Metadata->UpdateTimeInformation();
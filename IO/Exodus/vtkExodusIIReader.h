@@ -661,13 +661,35 @@ public:
   void ResetCache();
 
   // Description:
-  // Set the size of the cache in MiB.
+  // Set the capacity of the cache in MiB. The cache is shared with other
+  // readers unless SetCache(NULL) was called, so this sets their capacity
+  // as well.
   void SetCacheSize(double CacheSize);
 
   // Description:
-  // Get the size of the cache in MiB.
+  // Get the capacity of the cache in MiB.
   double GetCacheSize();
 
+  // Description:
+  // Set/get the cache that holds the arrays read from the file. By default
+  // all readers share vtkExodusIICache::GetGlobalCache(), so the entries of
+  // all of them count against a single capacity. Several readers may also
+  // share another cache (vtkPExodusIIReader gives its files the cache of
+  // its own). Setting NULL gives the reader a cache of its own, with the
+  // capacity of the one it used before.
+  void SetCache(vtkExodusIICache*);
+  vtkExodusIICache* GetCache();
+
+  // Description:
+  // When on, each time a time step has been read, the arrays selected for
+  // output are read for the following time step on a background thread so
+  // that they are in the cache when that time step is requested. Only
+  // arrays that fit in the cache stay there, so this needs a CacheSize
+  // large enough for the arrays of two time steps. Off by default.
+  void SetPrefetchNextTimeStep(int);
+  int GetPrefetchNextTimeStep();
+  vtkBooleanMacro(PrefetchNextTimeStep, int);
+
   // Description:
   // Should the reader output only points used by elements in the output mesh,
   // or all the points. Outputting all the points is much faster since the
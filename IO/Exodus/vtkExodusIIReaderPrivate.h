@@ -5,10 +5,14 @@
 // from inside the ExodusII reader and its descendants.
 
 #include "vtkToolkits.h" // make sure VTK_USE_PARALLEL is properly set
+#include "vtkAtomicInt.h" // For PrefetchFinish
 #include "vtkExodusIICache.h"
+#include "vtkMultiThreader.h"
+#include "vtkSmartPointer.h" // For HeldArrays
 #include "vtksys/RegularExpression.hxx"
 
 #include <map>
+#include <string>
 #include <vector>
 
 #include "vtk_exodusII.h"
@@ -16,6 +20,19 @@
 class vtkExodusIIReaderParser;
 class vtkMutableDirectedGraph;
 
+// Like vtkSetMacro, but stops the prefetch thread before the value changes,
+// since the thread may read it.
+#define vtkExodusIIReaderPrivateSetMacro(name,type) \
+  virtual void Set##name( type _arg ) \
+    { \
+    if ( this->name != _arg ) \
+      { \
+      this->StopPrefetch(); \
+      this->name = _arg; \
+      this->Modified(); \
+      } \
+    }
+
 /** This class holds metadata for an Exodus file.
   *
   */
@@ -71,11 +88,50 @@ public:
   /// Clears out any data in the cache and restores it to its initial state.
   void ResetCache();
 
-  /// Set the size of the cache in MiB.
+  /// Set the capacity in MiB of the cache, which other readers may share.
   void SetCacheSize(double size);
 
-  /// Get the size of the cache in MiB.
-  vtkGetMacro(CacheSize, double);
+  /// Get the capacity in MiB of the cache.
+  double GetCacheSize();
+
+  /** Replace the array cache, e.g. with one shared by several readers.
+    * Entries this reader put in the old cache are dropped. Passing NULL
+    * gives the reader a cache of its own, with the capacity of the old one.
+    */
+  void SetCache( vtkExodusIICache* cache );
+
+  /// Return the array cache.
+  vtkExodusIICache* GetCache() { return this->Cache; }
+
+  /** Should StartPrefetch() read the arrays of a time step into the
+    * cache on a background thread? Off by default.
+    */
+  vtkExodusIIReaderPrivateSetMacro(PrefetchNextTimeStep,int);
+  vtkGetMacro(PrefetchNextTimeStep,int);
+  vtkBooleanMacro(PrefetchNextTimeStep,int);
+
+  /** Start reading the arrays that RequestData() would read for
+    * \a timeStep into the cache on a background thread.
+    * This does nothing unless PrefetchNextTimeStep is set and the
+    * time step exists. The thread opens \a filename itself and takes the
+    * lock that serializes all Exodus file access, so the caller must
+    * have closed the file and released that lock.
+    */
+  void StartPrefetch( const char* filename, int timeStep );
+
+  /** Stop the prefetch thread (if any) and wait for it to exit.
+    * If the thread is reading \a timeStep it is left to finish,
+    * otherwise it stops after the array it is reading.
+    * This must be called before anything else touches the file or
+    * the metadata that the prefetch thread reads.
+    */
+  void StopPrefetch( int timeStep = -1 );
+
+  /// Read the arrays listed by StartPrefetch(). Runs on the prefetch thread.
+  void Prefetch( vtkMultiThreader::ThreadInfo* info );
+
+  /// Release the arrays returned by GetCacheOrRead() so far.
+  void ReleaseArrays() { this->HeldArrays.clear(); }
 
   /** Return the number of time steps in the open file.
     * You must have called RequestInformation() before
@@ -209,34 +265,34 @@ public:
 
   /// Generate an array containing the block or set ID associated with each cell.
   vtkGetMacro(GenerateObjectIdArray,int);
-  vtkSetMacro(GenerateObjectIdArray,int);
+  vtkExodusIIReaderPrivateSetMacro(GenerateObjectIdArray,int);
   static const char* GetObjectIdArrayName() { return "ObjectId"; }
 
-  vtkSetMacro(GenerateGlobalElementIdArray,int);
+  vtkExodusIIReaderPrivateSetMacro(GenerateGlobalElementIdArray,int);
   vtkGetMacro(GenerateGlobalElementIdArray,int);
   static const char* GetGlobalElementIdArrayName() { return "GlobalElementId"; }
 
-  vtkSetMacro(GenerateGlobalNodeIdArray,int);
+  vtkExodusIIReaderPrivateSetMacro(GenerateGlobalNodeIdArray,int);
   vtkGetMacro(GenerateGlobalNodeIdArray,int);
   static const char* GetGlobalNodeIdArrayName() { return "GlobalNodeId"; }
 
-  vtkSetMacro(GenerateImplicitElementIdArray,int);
+  vtkExodusIIReaderPrivateSetMacro(GenerateImplicitElementIdArray,int);
   vtkGetMacro(GenerateImplicitElementIdArray,int);
   static const char* GetImplicitElementIdArrayName() { return "ImplicitElementId"; }
 
-  vtkSetMacro(GenerateImplicitNodeIdArray,int);
+  vtkExodusIIReaderPrivateSetMacro(GenerateImplicitNodeIdArray,int);
   vtkGetMacro(GenerateImplicitNodeIdArray,int);
   static const char* GetImplicitNodeIdArrayName() { return "ImplicitNodeId"; }
 
   /** Should we generate an array defined over all cells
     * (whether they are members of blocks or sets) indicating the source file?
     */
-  vtkSetMacro(GenerateFileIdArray,int);
+  vtkExodusIIReaderPrivateSetMacro(GenerateFileIdArray,int);
   vtkGetMacro(GenerateFileIdArray,int);
   static const char* GetFileIdArrayName() { return "FileId"; }
 
   /// Set/get the number that identifies this file in a series of files (defaults to 0).
-  vtkSetMacro(FileId,int);
+  vtkExodusIIReaderPrivateSetMacro(FileId,int);
   vtkGetMacro(FileId,int);
 
   static const char *GetGlobalVariableValuesArrayName()
@@ -250,13 +306,13 @@ public:
   virtual void SetDisplacementMagnitude( double s );
   vtkGetMacro(DisplacementMagnitude,double);
 
-  vtkSetMacro(HasModeShapes,int);
+  vtkExodusIIReaderPrivateSetMacro(HasModeShapes,int);
   vtkGetMacro(HasModeShapes,int);
 
-  vtkSetMacro(ModeShapeTime,double);
+  vtkExodusIIReaderPrivateSetMacro(ModeShapeTime,double);
   vtkGetMacro(ModeShapeTime,double);
 
-  vtkSetMacro(AnimateModeShapes, int);
+  vtkExodusIIReaderPrivateSetMacro(AnimateModeShapes,int);
   vtkGetMacro(AnimateModeShapes, int);
 
   vtkDataArray* FindDisplacementVectors( int timeStep );
@@ -601,9 +657,15 @@ protected:
     * read it from the file.
     * This function can still return 0 if you are foolish enough to request an
     * array not present in the file, grasshopper.
+    * The array is held until ReleaseArrays() is called, since another reader
+    * sharing the cache may evict it at any time.
     */
   vtkDataArray* GetCacheOrRead( vtkExodusIICacheKey );
 
+  /// Return a cache key in the scope of this reader.
+  vtkExodusIICacheKey ScopedCacheKey(
+    int time = 0, int objType = 0, int objId = 0, int arrId = 0 );
+
   /** Return the index of an object type (in a private list of all object types).
     * This returns a 0-based index if the object type was found and -1 if it
     * was not.
@@ -784,11 +846,24 @@ protected:
     */
   int FileId;
 
-  /// A least-recently-used cache to hold raw arrays.
+  /// A least-recently-used cache to hold raw arrays, by default the global one.
   vtkExodusIICache* Cache;
-  //
-  /// The size of the cache in MiB.
-  double CacheSize;
+
+  /// The scope of all the keys this reader puts into the (possibly shared) cache.
+  int CacheScope;
+
+  int PrefetchNextTimeStep;
+  vtkMultiThreader* PrefetchThreader;
+  /// The id of the running prefetch thread or -1.
+  int PrefetchThreadId;
+  std::string PrefetchFileName;
+  int PrefetchTimeStep;
+  /// Set while StopPrefetch() waits for the prefetch to complete.
+  vtkAtomicInt<vtkTypeInt32> PrefetchFinish;
+  /// Arrays to prefetch, collected by StartPrefetch() on the calling thread.
+  std::vector<vtkExodusIICacheKey> PrefetchKeys;
+  /// Arrays returned by GetCacheOrRead() since the last ReleaseArrays().
+  std::vector<vtkSmartPointer<vtkDataArray> > HeldArrays;
 
   int ApplyDisplacements;
   float DisplacementMagnitude;
@@ -0,0 +1,105 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestOpenFOAMReaderRefresh.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test of mesh caching in vtkOpenFOAMReader
+// .SECTION Description
+// Steps through the timesteps of a static mesh case and refreshes the
+// case, checking that the cached internal mesh is reused throughout and
+// that only the cell data is updated.
+
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkOpenFOAMReader.h"
+#include "vtkSmartPointer.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkTestUtilities.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <iostream>
+
+static void UpdateTimeStep(vtkOpenFOAMReader *reader, double time)
+{
+  vtkStreamingDemandDrivenPipeline::SafeDownCast(
+    reader->GetExecutive())->SetUpdateTimeStep(0, time);
+  reader->Update();
+}
+
+static vtkUnstructuredGrid *GetInternalMesh(vtkOpenFOAMReader *reader)
+{
+  return vtkUnstructuredGrid::SafeDownCast(reader->GetOutput()->GetBlock(0));
+}
+
+int TestOpenFOAMReaderRefresh(int argc, char* argv[])
+{
+  char* filename =
+    vtkTestUtilities::ExpandDataFileName(argc, argv,
+                                         "Data/OpenFOAM/cavity/cavity.foam");
+
+  vtkSmartPointer<vtkOpenFOAMReader> reader =
+    vtkSmartPointer<vtkOpenFOAMReader>::New();
+  reader->SetFileName(filename);
+  delete [] filename;
+  reader->UpdateInformation();
+  UpdateTimeStep(reader, 0.0);
+
+  // hold a reference so that a recreated mesh can not reuse the address
+  vtkSmartPointer<vtkUnstructuredGrid> mesh = GetInternalMesh(reader);
+  if (!mesh || !mesh->GetCellData()->GetArray("p"))
+    {
+    std::cerr << "No internal mesh or no p array at time 0." << std::endl;
+    return EXIT_FAILURE;
+    }
+  const vtkIdType numCells = mesh->GetNumberOfCells();
+  const double p0 = mesh->GetCellData()->GetArray("p")->GetComponent(0, 0);
+
+  UpdateTimeStep(reader, 0.5);
+  if (GetInternalMesh(reader) != mesh)
+    {
+    std::cerr << "Internal mesh was recreated on a timestep change."
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtkDataArray *p = mesh->GetCellData()->GetArray("p");
+  if (!p || p->GetNumberOfTuples() != numCells || p->GetComponent(0, 0) == p0)
+    {
+    std::cerr << "p was not updated at time 0.5." << std::endl;
+    return EXIT_FAILURE;
+    }
+  const double p05 = p->GetComponent(0, 0);
+
+  reader->SetRefresh();
+  reader->Update();
+  if (GetInternalMesh(reader) != mesh)
+    {
+    std::cerr << "Internal mesh was recreated on a refresh." << std::endl;
+    return EXIT_FAILURE;
+    }
+  p = mesh->GetCellData()->GetArray("p");
+  if (!p || p->GetNumberOfTuples() != numCells || p->GetComponent(0, 0) != p05)
+    {
+    std::cerr << "p differs after a refresh." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  UpdateTimeStep(reader, 0.0);
+  p = GetInternalMesh(reader)->GetCellData()->GetArray("p");
+  if (GetInternalMesh(reader) != mesh || !p || p->GetComponent(0, 0) != p0)
+    {
+    std::cerr << "Stepping back after a refresh failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
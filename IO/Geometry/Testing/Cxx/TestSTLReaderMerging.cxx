@@ -0,0 +1,123 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestSTLReaderMerging.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test of point merging in vtkSTLReader
+// .SECTION Description
+// Reads back a binary STL file with sort based merging and with the
+// default vtkMergePoints locator and checks that both give the same output.
+
+#include "vtkCellArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkPolyData.h"
+#include "vtkSTLReader.h"
+#include "vtkSTLWriter.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkTestUtilities.h"
+
+#include <iostream>
+#include <string>
+
+int TestSTLReaderMerging( int argc, char *argv[] )
+{
+  char *tempDir = vtkTestUtilities::GetArgOrEnvOrDefault(
+    "-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  std::string fileName = std::string(tempDir) + "/TestSTLReaderMerging.stl";
+  delete [] tempDir;
+
+  vtkSmartPointer<vtkSphereSource> sphereSource =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphereSource->SetThetaResolution(64);
+  sphereSource->SetPhiResolution(32);
+  sphereSource->Update();
+  vtkPolyData *sphere = sphereSource->GetOutput();
+
+  vtkSmartPointer<vtkSTLWriter> writer =
+    vtkSmartPointer<vtkSTLWriter>::New();
+  writer->SetInputData(sphere);
+  writer->SetFileTypeToBinary();
+  writer->SetFileName(fileName.c_str());
+  writer->Write();
+
+  vtkSmartPointer<vtkSTLReader> sortReader =
+    vtkSmartPointer<vtkSTLReader>::New();
+  sortReader->SetFileName(fileName.c_str());
+  sortReader->SortMergingOn();
+  sortReader->Update();
+  vtkPolyData *sorted = sortReader->GetOutput();
+
+  vtkSmartPointer<vtkSTLReader> locatorReader =
+    vtkSmartPointer<vtkSTLReader>::New();
+  locatorReader->SetFileName(fileName.c_str());
+  locatorReader->Update();
+  vtkPolyData *located = locatorReader->GetOutput();
+
+  vtkSmartPointer<vtkSTLReader> rawReader =
+    vtkSmartPointer<vtkSTLReader>::New();
+  rawReader->SetFileName(fileName.c_str());
+  rawReader->MergingOff();
+  rawReader->Update();
+  vtkPolyData *raw = rawReader->GetOutput();
+
+  if (raw->GetNumberOfPolys() != sphere->GetNumberOfPolys() ||
+      raw->GetNumberOfPoints() != 3*sphere->GetNumberOfPolys())
+    {
+    std::cerr << "Unmerged read gave " << raw->GetNumberOfPoints()
+              << " points and " << raw->GetNumberOfPolys()
+              << " triangles." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (sorted->GetNumberOfPoints() != sphere->GetNumberOfPoints() ||
+      sorted->GetNumberOfPolys() != sphere->GetNumberOfPolys())
+    {
+    std::cerr << "Merged read gave " << sorted->GetNumberOfPoints()
+              << " points and " << sorted->GetNumberOfPolys()
+              << " triangles, expected " << sphere->GetNumberOfPoints()
+              << " and " << sphere->GetNumberOfPolys() << "." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (sorted->GetNumberOfPoints() != located->GetNumberOfPoints() ||
+      sorted->GetNumberOfPolys() != located->GetNumberOfPolys())
+    {
+    std::cerr << "Sort and locator merging differ in size." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for (vtkIdType i = 0; i < sorted->GetNumberOfPoints(); ++i)
+    {
+    double x[3], y[3];
+    sorted->GetPoint(i, x);
+    located->GetPoint(i, y);
+    if (x[0] != y[0] || x[1] != y[1] || x[2] != y[2])
+      {
+      std::cerr << "Point " << i << " differs." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  vtkIdTypeArray *sortedCells = sorted->GetPolys()->GetData();
+  vtkIdTypeArray *locatedCells = located->GetPolys()->GetData();
+  for (vtkIdType i = 0; i < sortedCells->GetNumberOfTuples(); ++i)
+    {
+    if (sortedCells->GetValue(i) != locatedCells->GetValue(i))
+      {
+      std::cerr << "Connectivity entry " << i << " differs." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -41,6 +41,10 @@
 #define VTK_FOAMFILE_OUTBUFSIZE (131072)
 #define VTK_FOAMFILE_INCLUDE_STACK_SIZE (10)
 
+// The number of double precision values converted at a time when reading
+// binary scalar/vector lists.
+#define VTK_FOAMFILE_BINARY_CHUNK (4096)
+
 #if defined(_MSC_VER) && (_MSC_VER >= 1400)
 #define _CRT_SECURE_NO_WARNINGS 1
 #endif
@@ -169,6 +173,8 @@ public:
       vtkStringArray *, const bool);
   void SetupInformation(const vtkStdString &, const vtkStdString &,
       const vtkStdString &, vtkOpenFOAMReaderPrivate *);
+  // take over the cached mesh of a reader created before a refresh
+  void InheritCachedMesh(vtkOpenFOAMReaderPrivate *);
 
 private:
   struct vtkFoamBoundaryEntry
@@ -234,6 +240,9 @@ private:
   vtkMultiBlockDataSet *PointZoneMesh;
   vtkMultiBlockDataSet *FaceZoneMesh;
   vtkMultiBlockDataSet *CellZoneMesh;
+  // sizes and modification times of the polyMesh files the cached mesh
+  // was created from
+  vtkStdString MeshFileStamp;
 
   // for polyhedra handling
   int NumTotalAdditionalCells;
@@ -273,6 +282,7 @@ private:
   // search time directories for mesh
   void AppendMeshDirToArray(vtkStringArray *, const vtkStdString &, const int);
   void PopulatePolyMeshDirArrays();
+  vtkStdString MakeMeshFileStamp(const int) const;
 
   // search a time directory for field objects
   void GetFieldNames(const vtkStdString &, const bool, vtkStringArray *,
@@ -2167,12 +2177,21 @@ public:
         }
       else
         {
-        for (int i = 0; i < size; i++)
+        // read and convert in chunks rather than one tuple at a time
+        const int chunkSize = VTK_FOAMFILE_BINARY_CHUNK / nComponents;
+        double buffer[VTK_FOAMFILE_BINARY_CHUNK];
+        primitiveT *tuples = this->Ptr->GetPointer(0);
+        for (int i = 0; i < size; i += chunkSize)
           {
-          double buffer[nComponents];
+          const int nValues = nComponents
+              * (size - i < chunkSize ? size - i : chunkSize);
           io.Read(reinterpret_cast<unsigned char *>(buffer), sizeof(double)
-              * nComponents);
-          this->Ptr->SetTuple(i, buffer);
+              * nValues);
+          primitiveT *tupleI = tuples + nComponents * i;
+          for (int j = 0; j < nValues; j++)
+            {
+            tupleI[j] = static_cast<primitiveT>(buffer[j]);
+            }
           }
         }
     }
@@ -2514,11 +2533,19 @@ VTK_TEMPLATE_SPECIALIZE
 void vtkFoamEntryValue::listTraits<vtkFloatArray, float>::ReadBinaryList(
     vtkFoamIOobject& io, const int size)
 {
-  for (int i = 0; i < size; i++)
+  // read and convert in chunks rather than one value at a time
+  double buffer[VTK_FOAMFILE_BINARY_CHUNK];
+  float *values = this->Ptr->GetPointer(0);
+  for (int i = 0; i < size; i += VTK_FOAMFILE_BINARY_CHUNK)
     {
-    double buffer;
-    io.Read(reinterpret_cast<unsigned char *>(&buffer), sizeof(double));
-    this->Ptr->SetValue(i, static_cast<float>(buffer));
+    const int nValues = (size - i < VTK_FOAMFILE_BINARY_CHUNK ? size - i
+        : VTK_FOAMFILE_BINARY_CHUNK);
+    io.Read(reinterpret_cast<unsigned char *>(buffer), sizeof(double)
+        * nValues);
+    for (int j = 0; j < nValues; j++)
+      {
+      values[i + j] = static_cast<float>(buffer[j]);
+      }
     }
 }
 
@@ -3803,6 +3830,81 @@ void vtkOpenFOAMReaderPrivate::ClearMeshes()
 {
   this->ClearInternalMeshes();
   this->ClearBoundaryMeshes();
+  this->MeshFileStamp.erase();
+}
+
+//-----------------------------------------------------------------------------
+// move the cached mesh of a reader of the same region that was created
+// before the case was refreshed, so that a refresh of a static mesh case
+// does not reparse the polyMesh files. the cache is only taken over if the
+// time directory it was created at still exists, its mesh is located in the
+// same directories and none of the mesh files have changed since.
+void vtkOpenFOAMReaderPrivate::InheritCachedMesh(
+    vtkOpenFOAMReaderPrivate *old)
+{
+  if (old->TimeStepOld == -1 || old->MeshFileStamp == ""
+      || this->TimeStepOld != -1)
+    {
+    return;
+    }
+
+  const vtkStdString &timeName = old->TimeNames->GetValue(old->TimeStepOld);
+  int timeI = 0;
+  const int nSteps = this->TimeNames->GetNumberOfTuples();
+  while (timeI < nSteps && this->TimeNames->GetValue(timeI) != timeName)
+    {
+    timeI++;
+    }
+  if (timeI == nSteps || this->PolyMeshFacesDir->GetValue(timeI)
+      != old->PolyMeshFacesDir->GetValue(old->TimeStepOld)
+      || this->PolyMeshPointsDir->GetValue(timeI)
+          != old->PolyMeshPointsDir->GetValue(old->TimeStepOld)
+      || this->MakeMeshFileStamp(timeI) != old->MeshFileStamp)
+    {
+    return;
+    }
+
+  this->ClearMeshes();
+
+  this->NumCells = old->NumCells;
+  this->NumPoints = old->NumPoints;
+  this->FaceOwner = old->FaceOwner;
+  old->FaceOwner = NULL;
+  this->InternalMesh = old->InternalMesh;
+  old->InternalMesh = NULL;
+  this->PointZoneMesh = old->PointZoneMesh;
+  old->PointZoneMesh = NULL;
+  this->FaceZoneMesh = old->FaceZoneMesh;
+  old->FaceZoneMesh = NULL;
+  this->CellZoneMesh = old->CellZoneMesh;
+  old->CellZoneMesh = NULL;
+
+  this->NumTotalAdditionalCells = old->NumTotalAdditionalCells;
+  this->AdditionalCellIds = old->AdditionalCellIds;
+  old->AdditionalCellIds = NULL;
+  this->NumAdditionalCells = old->NumAdditionalCells;
+  old->NumAdditionalCells = NULL;
+  this->AdditionalCellPoints = old->AdditionalCellPoints;
+  old->AdditionalCellPoints = NULL;
+
+  this->BoundaryMesh = old->BoundaryMesh;
+  old->BoundaryMesh = NULL;
+  this->BoundaryPointMap = old->BoundaryPointMap;
+  old->BoundaryPointMap = NULL;
+  this->BoundaryDict = old->BoundaryDict;
+  this->InternalPoints = old->InternalPoints;
+  old->InternalPoints = NULL;
+  this->AllBoundaries = old->AllBoundaries;
+  old->AllBoundaries = NULL;
+  this->AllBoundariesPointMap = old->AllBoundariesPointMap;
+  old->AllBoundariesPointMap = NULL;
+
+  this->TimeStepOld = timeI;
+  this->InternalMeshSelectionStatus = old->InternalMeshSelectionStatus;
+  this->InternalMeshSelectionStatusOld = old->InternalMeshSelectionStatusOld;
+  this->MeshFileStamp = old->MeshFileStamp;
+  old->TimeStepOld = -1;
+  old->MeshFileStamp.erase();
 }
 
 void vtkOpenFOAMReaderPrivate::SetTimeValue(const double requestedTime)
@@ -4598,6 +4700,39 @@ void vtkOpenFOAMReaderPrivate::PopulatePolyMeshDirArrays()
   return;
 }
 
+//-----------------------------------------------------------------------------
+// create a string identifying the state of the polyMesh files of a
+// timestep by their sizes and modification times
+vtkStdString vtkOpenFOAMReaderPrivate::MakeMeshFileStamp(const int timeI) const
+{
+  static const char *meshFiles[] =
+    {
+    "points", "faces", "owner", "neighbour", "boundary", "pointZones",
+    "faceZones", "cellZones", NULL
+    };
+  static const char *suffixes[] = {"", ".gz"};
+
+  vtksys_ios::ostringstream os;
+  for (int fileI = 0; meshFiles[fileI] != NULL; fileI++)
+    {
+    // points may be located in a different time directory than the others
+    vtkStringArray *dir
+        = (fileI == 0 ? this->PolyMeshPointsDir : this->PolyMeshFacesDir);
+    const vtkStdString path(this->CasePath + dir->GetValue(timeI)
+        + this->RegionPath() + "/polyMesh/" + meshFiles[fileI]);
+    for (int suffixI = 0; suffixI < 2; suffixI++)
+      {
+      const vtkStdString file(path + suffixes[suffixI]);
+      if (vtksys::SystemTools::FileExists(file.c_str(), true))
+        {
+        os << file << ' ' << vtksys::SystemTools::FileLength(file) << ' '
+            << vtksys::SystemTools::ModifiedTime(file) << '\n';
+        }
+      }
+    }
+  return os.str();
+}
+
 //-----------------------------------------------------------------------------
 // read the points file into a vtkFloatArray
 vtkFloatArray* vtkOpenFOAMReaderPrivate::ReadPointsFile()
@@ -8093,6 +8228,7 @@ int vtkOpenFOAMReaderPrivate::RequestData(vtkMultiBlockDataSet *output,
 
   if (this->Parent->GetCacheMesh())
     {
+    this->MeshFileStamp = this->MakeMeshFileStamp(this->TimeStep);
     this->TimeStepOld = this->TimeStep;
     }
   else
@@ -8456,6 +8592,19 @@ void vtkOpenFOAMReader::SetTimeInformation(vtkInformationVector *outputVector,
 int vtkOpenFOAMReader::MakeInformationVector(
     vtkInformationVector *outputVector, const vtkStdString& procName)
 {
+  // keep the readers of a refreshed case so that their cached meshes can
+  // be taken over by the new readers
+  vtkCollection *oldReaders = vtkCollection::New();
+  if (*this->FileNameOld == this->FileName)
+    {
+    this->Readers->InitTraversal();
+    vtkObject *oldReader;
+    while ((oldReader = this->Readers->GetNextItemAsObject()) != NULL)
+      {
+      oldReaders->AddItem(oldReader);
+      }
+    }
+
   *this->FileNameOld = vtkStdString(this->FileName);
 
   // clear prior case information
@@ -8470,6 +8619,7 @@ int vtkOpenFOAMReader::MakeInformationVector(
       this->Parent))
     {
     masterReader->Delete();
+    oldReaders->Delete();
     return 0;
     }
 
@@ -8477,6 +8627,7 @@ int vtkOpenFOAMReader::MakeInformationVector(
     {
     vtkErrorMacro(<< this->FileName << " contains no timestep data.");
     masterReader->Delete();
+    oldReaders->Delete();
     return 0;
     }
 
@@ -8493,6 +8644,7 @@ int vtkOpenFOAMReader::MakeInformationVector(
   if (!dir->Open(constantPath.c_str()))
     {
     vtkErrorMacro(<< "Can't open " << constantPath.c_str());
+    oldReaders->Delete();
     return 0;
     }
   for (int fileI = 0; fileI < dir->GetNumberOfFiles(); fileI++)
@@ -8515,6 +8667,26 @@ int vtkOpenFOAMReader::MakeInformationVector(
   masterReader->Delete();
   this->Parent->NumberOfReaders += this->Readers->GetNumberOfItems();
 
+  // take over the cached meshes of the regions that are still there
+  this->Readers->InitTraversal();
+  vtkOpenFOAMReaderPrivate *reader;
+  while ((reader = vtkOpenFOAMReaderPrivate::SafeDownCast(
+      this->Readers->GetNextItemAsObject())) != NULL)
+    {
+    oldReaders->InitTraversal();
+    vtkOpenFOAMReaderPrivate *oldReader;
+    while ((oldReader = vtkOpenFOAMReaderPrivate::SafeDownCast(
+        oldReaders->GetNextItemAsObject())) != NULL)
+      {
+      if (oldReader->GetRegionName() == reader->GetRegionName())
+        {
+        reader->InheritCachedMesh(oldReader);
+        break;
+        }
+      }
+    }
+  oldReaders->Delete();
+
   if (this->Parent == this)
     {
     this->CreateCharArrayFromString(this->CasePath, "CasePath", casePath);
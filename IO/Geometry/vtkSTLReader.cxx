@@ -19,19 +19,23 @@
 #include "vtkCellData.h"
 #include "vtkErrorCode.h"
 #include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
 #include "vtkIncrementalPointLocator.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMergePoints.h"
 #include "vtkObjectFactory.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
+#include "vtkSortMergePoints.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <algorithm>
 #include <ctype.h>
 #include <stdexcept>
 #include <string>
+#include <vector>
 #include <vtksys/SystemTools.hxx>
 
 vtkStandardNewMacro(vtkSTLReader);
@@ -47,6 +51,7 @@ vtkSTLReader::vtkSTLReader()
 {
   this->FileName = NULL;
   this->Merging = 1;
+  this->SortMerging = 0;
   this->ScalarTags = 0;
   this->Locator = NULL;
 
@@ -153,53 +158,30 @@ int vtkSTLReader::RequestData(
 
   fclose(fp);
 
-  // If merging is on, create hash table and merge points/triangles.
+  // If merging is on, merge coincident points and drop the triangles that
+  // collapse. The points are inserted into a locator one by one, unless
+  // sort merging was asked for without a user supplied locator.
   vtkPoints *mergedPts = newPts;
   vtkCellArray *mergedPolys = newPolys;
   vtkFloatArray *mergedScalars = newScalars;
   if (this->Merging)
     {
     mergedPts = vtkPoints::New();
-    mergedPts->Allocate(newPts->GetNumberOfPoints() /2);
     mergedPolys = vtkCellArray::New();
-    mergedPolys->Allocate(newPolys->GetSize());
     if (newScalars)
       {
       mergedScalars = vtkFloatArray::New();
-      mergedScalars->Allocate(newPolys->GetSize());
       }
 
-    vtkSmartPointer<vtkIncrementalPointLocator> locator = this->Locator;
-    if (this->Locator == NULL)
+    if (this->SortMerging && this->Locator == NULL)
       {
-      locator.TakeReference(this->NewDefaultLocator());
+      this->SortMerge(newPts, newPolys, newScalars,
+                      mergedPts, mergedPolys, mergedScalars);
       }
-    locator->InitPointInsertion(mergedPts, newPts->GetBounds());
-
-    int nextCell = 0;
-    vtkIdType *pts = 0;
-    vtkIdType npts;
-    for (newPolys->InitTraversal(); newPolys->GetNextCell(npts, pts);)
+    else
       {
-      vtkIdType nodes[3];
-      for (int i = 0; i < 3; i++)
-        {
-        double x[3];
-        newPts->GetPoint(pts[i], x);
-        locator->InsertUniquePoint(x, nodes[i]);
-        }
-
-      if (nodes[0] != nodes[1] &&
-        nodes[0] != nodes[2] &&
-        nodes[1] != nodes[2])
-        {
-        mergedPolys->InsertNextCell(3, nodes);
-        if (newScalars)
-          {
-          mergedScalars->InsertNextValue(newScalars->GetValue(nextCell));
-          }
-        }
-      nextCell++;
+      this->LocatorMerge(newPts, newPolys, newScalars,
+                         mergedPts, mergedPolys, mergedScalars);
       }
 
     newPts->Delete();
@@ -237,12 +219,155 @@ int vtkSTLReader::RequestData(
   return 1;
 }
 
+//------------------------------------------------------------------------------
+void vtkSTLReader::SortMerge(vtkPoints *newPts, vtkCellArray *newPolys,
+                             vtkFloatArray *newScalars, vtkPoints *mergedPts,
+                             vtkCellArray *mergedPolys,
+                             vtkFloatArray *mergedScalars)
+{
+  std::vector<vtkIdType> pointMap(newPts->GetNumberOfPoints() + 1);
+  vtkSortMergePoints::MergePoints(newPts, mergedPts, &pointMap[0]);
+
+  // Every cell of newPolys is a triangle, so the connectivity can be walked
+  // directly in strides of four.
+  vtkIdType numTris = newPolys->GetNumberOfCells();
+  const vtkIdType *pts = newPolys->GetPointer();
+  vtkSmartPointer<vtkIdTypeArray> cells =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  cells->SetNumberOfValues(4*numTris);
+  vtkIdType *nodes = cells->GetPointer(0);
+  if (mergedScalars)
+    {
+    mergedScalars->SetNumberOfValues(numTris);
+    }
+
+  vtkIdType numMerged = 0;
+  for (vtkIdType i = 0; i < numTris; ++i, pts += 4)
+    {
+    vtkIdType n0 = pointMap[pts[1]];
+    vtkIdType n1 = pointMap[pts[2]];
+    vtkIdType n2 = pointMap[pts[3]];
+    if (n0 != n1 && n0 != n2 && n1 != n2)
+      {
+      nodes[0] = 3;
+      nodes[1] = n0;
+      nodes[2] = n1;
+      nodes[3] = n2;
+      nodes += 4;
+      if (mergedScalars)
+        {
+        mergedScalars->SetValue(numMerged, newScalars->GetValue(i));
+        }
+      ++numMerged;
+      }
+    }
+
+  cells->SetNumberOfValues(4*numMerged);
+  mergedPolys->SetCells(numMerged, cells);
+  if (mergedScalars)
+    {
+    mergedScalars->SetNumberOfValues(numMerged);
+    }
+}
+
+//------------------------------------------------------------------------------
+void vtkSTLReader::LocatorMerge(vtkPoints *newPts, vtkCellArray *newPolys,
+                                vtkFloatArray *newScalars,
+                                vtkPoints *mergedPts,
+                                vtkCellArray *mergedPolys,
+                                vtkFloatArray *mergedScalars)
+{
+  mergedPts->Allocate(newPts->GetNumberOfPoints() /2);
+  mergedPolys->Allocate(newPolys->GetSize());
+  if (mergedScalars)
+    {
+    mergedScalars->Allocate(newPolys->GetSize());
+    }
+
+  vtkSmartPointer<vtkIncrementalPointLocator> locator = this->Locator;
+  if (this->Locator == NULL)
+    {
+    locator.TakeReference(this->NewDefaultLocator());
+    }
+  locator->InitPointInsertion(mergedPts, newPts->GetBounds());
+
+  int nextCell = 0;
+  vtkIdType *pts = 0;
+  vtkIdType npts;
+  for (newPolys->InitTraversal(); newPolys->GetNextCell(npts, pts);)
+    {
+    vtkIdType nodes[3];
+    for (int i = 0; i < 3; i++)
+      {
+      double x[3];
+      newPts->GetPoint(pts[i], x);
+      locator->InsertUniquePoint(x, nodes[i]);
+      }
+
+    if (nodes[0] != nodes[1] &&
+      nodes[0] != nodes[2] &&
+      nodes[1] != nodes[2])
+      {
+      mergedPolys->InsertNextCell(3, nodes);
+      if (mergedScalars)
+        {
+        mergedScalars->InsertNextValue(newScalars->GetValue(nextCell));
+        }
+      }
+    nextCell++;
+    }
+}
+
+//------------------------------------------------------------------------------
+namespace
+{
+// Size in bytes of one facet record of a binary STL file: the normal and
+// the three vertices as 32-bit floats followed by the 16-bit attribute
+// byte count.
+const vtkIdType VTK_STL_FACET_SIZE = 50;
+
+// Number of facets fetched from disk with a single fread.
+const vtkIdType VTK_STL_FACETS_PER_BLOCK = 1 << 20;
+
+// Decode a block of facet records straight into the point coordinates and
+// the triangle connectivity of the output.
+class vtkSTLDecodeFacets
+{
+public:
+  const unsigned char *Buffer;
+  float *Points;
+  vtkIdType *Cells;
+  vtkIdType FirstPointId;
+
+  vtkSTLDecodeFacets(const unsigned char *buffer, float *points,
+                     vtkIdType *cells, vtkIdType firstPointId) :
+    Buffer(buffer), Points(points), Cells(cells), FirstPointId(firstPointId) {}
+
+  void operator()(vtkIdType i, vtkIdType end) const
+    {
+    for (; i < end; ++i)
+      {
+      // Skip the facet normal, it is recomputed downstream when needed.
+      float *x = this->Points + 9*i;
+      memcpy(x, this->Buffer + VTK_STL_FACET_SIZE*i + 3*sizeof(float),
+             9*sizeof(float));
+      vtkByteSwap::Swap4LERange(x, 9);
+
+      vtkIdType *cell = this->Cells + 4*i;
+      vtkIdType ptId = this->FirstPointId + 3*i;
+      cell[0] = 3;
+      cell[1] = ptId;
+      cell[2] = ptId + 1;
+      cell[3] = ptId + 2;
+      }
+    }
+};
+}
+
 //------------------------------------------------------------------------------
 bool vtkSTLReader::ReadBinarySTL(FILE *fp, vtkPoints *newPts,
                                  vtkCellArray *newPolys)
 {
-  typedef struct { float  n[3], v1[3], v2[3], v3[3]; } facet_t;
-
   vtkDebugMacro(<< "Reading BINARY STL file");
 
   //  File is read to obtain raw information as well as bounding box
@@ -264,69 +389,53 @@ bool vtkSTLReader::ReadBinarySTL(FILE *fp, vtkPoints *newPts,
     }
   vtkByteSwap::Swap4LE(&ulint);
 
-  // Many .stl files contain bogus count.  Hence we will ignore and read
-  //   until end of file.
+  // Many .stl files contain bogus count.  Hence we will ignore it and read
+  //   every complete facet record up to the end of file.
   //
-  int numTris = static_cast<int>(ulint);
-  if (numTris <= 0)
-    {
-    vtkDebugMacro(<< "Bad binary count: attempting to correct("
-      << numTris << ")");
-    }
+  vtkTypeUInt32 numTrisInHeader = static_cast<vtkTypeUInt32>(ulint);
 
-  // Verify the numTris with the length of the file
+  // 80 byte - header, 4 byte - triangle count, 50 byte per facet - twelve
+  // 32-bit-floating point numbers + 2 byte for attribute byte count
   unsigned long ulFileLength = vtksys::SystemTools::FileLength(this->FileName);
-  ulFileLength -= (80 + 4); // 80 byte - header, 4 byte - tringle count
-  ulFileLength /= 50;       // 50 byte - twelve 32-bit-floating point numbers + 2 byte for attribute byte count
-
-  if (numTris < static_cast<int>(ulFileLength))
+  vtkIdType numTris = 0;
+  if (ulFileLength > 80 + 4)
     {
-    numTris = static_cast<int>(ulFileLength);
+    numTris = static_cast<vtkIdType>((ulFileLength - 80 - 4) /
+                                     VTK_STL_FACET_SIZE);
+    }
+  if (numTris != static_cast<vtkIdType>(numTrisInHeader))
+    {
+    vtkDebugMacro(<< "Bad binary count: attempting to correct("
+      << numTrisInHeader << " to " << numTris << ")");
     }
 
-  // now we can allocate the memory we need for this STL file
-  newPts->Allocate(numTris * 3);
-  newPolys->Allocate(numTris);
-
-  facet_t facet;
-  for (int i = 0; fread(&facet, 48, 1, fp) > 0; i++)
+  // now we can allocate the memory we need for this STL file and fill
+  // the arrays directly
+  newPts->SetDataTypeToFloat();
+  newPts->SetNumberOfPoints(3*numTris);
+  float *pts = static_cast<float*>(newPts->GetData()->GetVoidPointer(0));
+  vtkIdType *cells = newPolys->WritePointer(numTris, 4*numTris);
+
+  // Read the facets in large blocks and decode each block in parallel.
+  std::vector<unsigned char> buffer(
+    VTK_STL_FACET_SIZE*std::min(numTris, VTK_STL_FACETS_PER_BLOCK));
+  for (vtkIdType first = 0; first < numTris;
+       first += VTK_STL_FACETS_PER_BLOCK)
     {
-    unsigned short ibuff2;
-    if (fread(&ibuff2, 2, 1, fp) != 1) //read extra junk
+    vtkIdType num = std::min(VTK_STL_FACETS_PER_BLOCK, numTris - first);
+    if (fread(&buffer[0], VTK_STL_FACET_SIZE, num, fp) !=
+        static_cast<size_t>(num))
       {
       vtkErrorMacro("STLReader error reading file: " << this->FileName
-        << " Premature EOF while reading extra junk.");
+        << " Premature EOF while reading facets.");
       return false;
       }
 
-    vtkByteSwap::Swap4LE(facet.n);
-    vtkByteSwap::Swap4LE(facet.n+1);
-    vtkByteSwap::Swap4LE(facet.n+2);
-
-    vtkByteSwap::Swap4LE(facet.v1);
-    vtkByteSwap::Swap4LE(facet.v1+1);
-    vtkByteSwap::Swap4LE(facet.v1+2);
-
-    vtkByteSwap::Swap4LE(facet.v2);
-    vtkByteSwap::Swap4LE(facet.v2+1);
-    vtkByteSwap::Swap4LE(facet.v2+2);
-
-    vtkByteSwap::Swap4LE(facet.v3);
-    vtkByteSwap::Swap4LE(facet.v3+1);
-    vtkByteSwap::Swap4LE(facet.v3+2);
+    vtkSMPTools::For(0, num, vtkSTLDecodeFacets(&buffer[0], pts + 9*first,
+                                                cells + 4*first, 3*first));
 
-    vtkIdType pts[3];
-    pts[0] = newPts->InsertNextPoint(facet.v1);
-    pts[1] = newPts->InsertNextPoint(facet.v2);
-    pts[2] = newPts->InsertNextPoint(facet.v3);
-
-    newPolys->InsertNextCell(3, pts);
-
-    if ((i % 5000) == 0 && i != 0)
-      {
-      vtkDebugMacro(<< "triangle# " << i);
-      this->UpdateProgress(static_cast<double>(i) / numTris);
-      }
+    vtkDebugMacro(<< "triangle# " << first + num);
+    this->UpdateProgress(static_cast<double>(first + num) / numTris);
     }
 
   return true;
@@ -486,8 +595,8 @@ int vtkSTLReader::GetSTLFileType(const char *filename)
 }
 
 //------------------------------------------------------------------------------
-// Specify a spatial locator for merging points. By
-// default an instance of vtkMergePoints is used.
+// Create a vtkMergePoints locator, used to merge the points when none is
+// specified with SetLocator().
 vtkIncrementalPointLocator* vtkSTLReader::NewDefaultLocator()
 {
   return vtkMergePoints::New();
@@ -502,6 +611,7 @@ void vtkSTLReader::PrintSelf(ostream& os, vtkIndent indent)
      <<(this->FileName ? this->FileName : "(none)") << "\n";
 
   os << indent << "Merging: " <<(this->Merging ? "On\n" : "Off\n");
+  os << indent << "SortMerging: " <<(this->SortMerging ? "On\n" : "Off\n");
   os << indent << "ScalarTags: " <<(this->ScalarTags ? "On\n" : "Off\n");
   os << indent << "Locator: ";
   if (this->Locator)
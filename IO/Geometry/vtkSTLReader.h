@@ -22,8 +22,13 @@
 // .stl files are quite inefficient since they duplicate vertex
 // definitions. By setting the Merging boolean you can control whether the
 // point data is merged after reading. Merging is performed by default,
-// however, merging requires a large amount of temporary storage since a
-// 3D hash table must be constructed.
+// by inserting the points one at a time into the Locator, or into a
+// vtkMergePoints locator when none is specified. With SortMerging on and
+// no Locator, coincident points are found by sorting the points in
+// parallel instead (see vtkSortMergePoints).
+//
+// Binary files are read in large blocks and decoded in parallel directly
+// into the point and connectivity arrays of the output.
 
 // .SECTION Caveats
 // Binary files written on one system may not be readable on other systems.
@@ -68,8 +73,19 @@ public:
   vtkBooleanMacro(ScalarTags,int);
 
   // Description:
-  // Specify a spatial locator for merging points. By
-  // default an instance of vtkMergePoints is used.
+  // Turn on/off merging of points by sorting them in parallel when no
+  // Locator is specified. This is much faster than inserting the points
+  // into a vtkMergePoints locator on large files, and gives the same output
+  // except that points with NaN coordinates are merged together, where the
+  // locator keeps each of them. It also requires temporary storage for two
+  // ids per point read. Off by default.
+  vtkSetMacro(SortMerging,int);
+  vtkGetMacro(SortMerging,int);
+  vtkBooleanMacro(SortMerging,int);
+
+  // Description:
+  // Specify a spatial locator for merging points. By default an instance
+  // of vtkMergePoints is used.
   void SetLocator(vtkIncrementalPointLocator *locator);
   vtkGetObjectMacro(Locator,vtkIncrementalPointLocator);
 
@@ -78,10 +94,11 @@ protected:
   ~vtkSTLReader();
 
   // Description:
-  // Create default locator. Used to create one when none is specified.
+  // Create default locator, an instance of vtkMergePoints.
   vtkIncrementalPointLocator* NewDefaultLocator();
 
   int Merging;
+  int SortMerging;
   int ScalarTags;
   vtkIncrementalPointLocator *Locator;
 
@@ -90,6 +107,17 @@ protected:
   bool ReadASCIISTL(FILE *fp, vtkPoints*, vtkCellArray*,
                     vtkFloatArray* scalars=0);
   int GetSTLFileType(const char *filename);
+
+  // Description:
+  // Merge coincident points of newPts into mergedPts and renumber the
+  // triangles, dropping the ones that become degenerate. SortMerge uses
+  // vtkSortMergePoints, LocatorMerge uses the Locator or a default one.
+  void SortMerge(vtkPoints *newPts, vtkCellArray *newPolys,
+                 vtkFloatArray *newScalars, vtkPoints *mergedPts,
+                 vtkCellArray *mergedPolys, vtkFloatArray *mergedScalars);
+  void LocatorMerge(vtkPoints *newPts, vtkCellArray *newPolys,
+                    vtkFloatArray *newScalars, vtkPoints *mergedPts,
+                    vtkCellArray *mergedPolys, vtkFloatArray *mergedScalars);
 private:
   vtkSTLReader(const vtkSTLReader&);  // Not implemented.
   void operator=(const vtkSTLReader&);  // Not implemented.
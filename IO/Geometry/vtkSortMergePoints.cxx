@@ -0,0 +1,260 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSortMergePoints.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkSortMergePoints.h"
+
+#include "vtkDataArray.h"
+#include "vtkObjectFactory.h"
+#include "vtkPoints.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <vector>
+
+vtkStandardNewMacro(vtkSortMergePoints);
+
+namespace
+{
+// Below this many points per thread the sort is done serially.
+const vtkIdType VTK_SORT_MERGE_MIN_CHUNK = 65536;
+
+//----------------------------------------------------------------------------
+// Three-way comparison of two coordinates. NaN compares greater than any
+// number and equal to itself so that the ordering stays strict-weak.
+template <class T>
+inline int vtkSortMergeCompare(T x, T y)
+{
+  if (x < y)
+    {
+    return -1;
+    }
+  if (y < x)
+    {
+    return 1;
+    }
+  bool xnan = (x != x);
+  bool ynan = (y != y);
+  return (xnan == ynan ? 0 : (xnan ? 1 : -1));
+}
+
+//----------------------------------------------------------------------------
+// Orders point ids lexicographically on their coordinates. Ties are broken
+// on the id, so the first id of every run of coincident points is the point
+// that appears first in the input.
+template <class T>
+class vtkSortMergeLess
+{
+public:
+  const T *Points;
+
+  vtkSortMergeLess(const T *pts) : Points(pts) {}
+
+  bool operator()(vtkIdType a, vtkIdType b) const
+    {
+    const T *p = this->Points + 3*a;
+    const T *q = this->Points + 3*b;
+    for (int i = 0; i < 3; ++i)
+      {
+      int c = vtkSortMergeCompare(p[i], q[i]);
+      if (c != 0)
+        {
+        return c < 0;
+        }
+      }
+    return a < b;
+    }
+
+  bool Coincident(vtkIdType a, vtkIdType b) const
+    {
+    const T *p = this->Points + 3*a;
+    const T *q = this->Points + 3*b;
+    return (vtkSortMergeCompare(p[0], q[0]) == 0 &&
+            vtkSortMergeCompare(p[1], q[1]) == 0 &&
+            vtkSortMergeCompare(p[2], q[2]) == 0);
+    }
+};
+
+//----------------------------------------------------------------------------
+// Sort each chunk of the id array independently.
+template <class T>
+class vtkSortMergeSortChunks
+{
+public:
+  vtkIdType *Ids;
+  vtkIdType NumberOfIds;
+  vtkIdType ChunkSize;
+  vtkSortMergeLess<T> Less;
+
+  vtkSortMergeSortChunks(vtkIdType *ids, vtkIdType num, vtkIdType chunkSize,
+                         const T *pts) :
+    Ids(ids), NumberOfIds(num), ChunkSize(chunkSize), Less(pts) {}
+
+  void operator()(vtkIdType chunk, vtkIdType end) const
+    {
+    for (; chunk < end; ++chunk)
+      {
+      vtkIdType first = chunk*this->ChunkSize;
+      vtkIdType last = std::min(first + this->ChunkSize, this->NumberOfIds);
+      std::sort(this->Ids + first, this->Ids + last, this->Less);
+      }
+    }
+};
+
+//----------------------------------------------------------------------------
+// Merge neighboring pairs of sorted runs of length Width.
+template <class T>
+class vtkSortMergeMergeRuns
+{
+public:
+  vtkIdType *Ids;
+  vtkIdType NumberOfIds;
+  vtkIdType Width;
+  vtkSortMergeLess<T> Less;
+
+  vtkSortMergeMergeRuns(vtkIdType *ids, vtkIdType num, vtkIdType width,
+                        const T *pts) :
+    Ids(ids), NumberOfIds(num), Width(width), Less(pts) {}
+
+  void operator()(vtkIdType pair, vtkIdType end) const
+    {
+    for (; pair < end; ++pair)
+      {
+      vtkIdType first = 2*pair*this->Width;
+      vtkIdType middle = std::min(first + this->Width, this->NumberOfIds);
+      vtkIdType last = std::min(middle + this->Width, this->NumberOfIds);
+      if (middle < last)
+        {
+        std::inplace_merge(this->Ids + first, this->Ids + middle,
+                           this->Ids + last, this->Less);
+        }
+      }
+    }
+};
+
+//----------------------------------------------------------------------------
+class vtkSortMergeInitializeIds
+{
+public:
+  vtkIdType *Ids;
+
+  vtkSortMergeInitializeIds(vtkIdType *ids) : Ids(ids) {}
+
+  void operator()(vtkIdType i, vtkIdType end) const
+    {
+    for (; i < end; ++i)
+      {
+      this->Ids[i] = i;
+      }
+    }
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+vtkIdType vtkSortMergePointsExecute(const T *inPts, vtkIdType numPts,
+                                    vtkPoints *outPts, vtkIdType *pointMap)
+{
+  std::vector<vtkIdType> ids(numPts);
+  vtkIdType *idPtr = &ids[0];
+  vtkSMPTools::For(0, numPts, vtkSortMergeInitializeIds(idPtr));
+
+  // Parallel merge sort: sort one chunk per thread, then merge the sorted
+  // runs pairwise until a single run remains.
+  vtkIdType numChunks = vtkSMPTools::GetEstimatedNumberOfThreads();
+  numChunks = std::min(numChunks, numPts / VTK_SORT_MERGE_MIN_CHUNK);
+  numChunks = std::max(numChunks, static_cast<vtkIdType>(1));
+  vtkIdType chunkSize = (numPts + numChunks - 1) / numChunks;
+  vtkSMPTools::For(0, numChunks, 1,
+    vtkSortMergeSortChunks<T>(idPtr, numPts, chunkSize, inPts));
+  for (vtkIdType width = chunkSize; width < numPts; width *= 2)
+    {
+    vtkIdType numPairs = (numPts + 2*width - 1) / (2*width);
+    vtkSMPTools::For(0, numPairs, 1,
+      vtkSortMergeMergeRuns<T>(idPtr, numPts, width, inPts));
+    }
+
+  // Point every id at the first (smallest) id of its run.
+  vtkSortMergeLess<T> less(inPts);
+  vtkIdType numUnique = 0;
+  vtkIdType runStart = 0;
+  for (vtkIdType k = 0; k < numPts; ++k)
+    {
+    if (k == 0 || !less.Coincident(idPtr[k], runStart))
+      {
+      runStart = idPtr[k];
+      ++numUnique;
+      }
+    pointMap[idPtr[k]] = runStart;
+    }
+  ids.clear();
+
+  // Number the unique points in order of first occurrence. A run's first id
+  // is always smaller than the other ids of the run, so its new id has been
+  // assigned by the time the others are visited.
+  outPts->SetNumberOfPoints(numUnique);
+  T *out = static_cast<T*>(outPts->GetData()->GetVoidPointer(0));
+  vtkIdType nextId = 0;
+  for (vtkIdType i = 0; i < numPts; ++i)
+    {
+    if (pointMap[i] == i)
+      {
+      const T *x = inPts + 3*i;
+      out[3*nextId] = x[0];
+      out[3*nextId+1] = x[1];
+      out[3*nextId+2] = x[2];
+      pointMap[i] = nextId++;
+      }
+    else
+      {
+      pointMap[i] = pointMap[pointMap[i]];
+      }
+    }
+
+  return numUnique;
+}
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkSortMergePoints::MergePoints(vtkPoints *inPts, vtkPoints *outPts,
+                                          vtkIdType *pointMap)
+{
+  outPts->Initialize();
+  outPts->SetDataType(inPts->GetDataType());
+
+  vtkIdType numPts = inPts->GetNumberOfPoints();
+  if (numPts < 1)
+    {
+    return 0;
+    }
+
+  void *inPtr = inPts->GetData()->GetVoidPointer(0);
+  vtkIdType numUnique = 0;
+  switch (inPts->GetDataType())
+    {
+    vtkTemplateMacro(
+      numUnique = vtkSortMergePointsExecute(static_cast<VTK_TT*>(inPtr),
+                                            numPts, outPts, pointMap));
+    default:
+      vtkGenericWarningMacro("Unsupported point data type "
+                             << inPts->GetDataType());
+      return 0;
+    }
+
+  return numUnique;
+}
+
+//----------------------------------------------------------------------------
+void vtkSortMergePoints::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+}
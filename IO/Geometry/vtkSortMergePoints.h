@@ -0,0 +1,67 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSortMergePoints.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkSortMergePoints - merge coincident points with a parallel sort
+// .SECTION Description
+// vtkSortMergePoints is a helper used by readers of "triangle soup" formats
+// (STL, PLY) to merge exactly coincident points after all of the points
+// have been read. Instead of inserting points one at a time into a
+// vtkIncrementalPointLocator, the point ids are sorted lexicographically on
+// their coordinates with a parallel merge sort built on vtkSMPTools, and
+// runs of equal coordinates are collapsed into a single point.
+//
+// The merged points are numbered in order of first occurrence in the input,
+// which is the same numbering vtkMergePoints produces when the points are
+// inserted in order. Only exactly coincident points are merged; there is
+// no tolerance. Unlike vtkMergePoints, which never finds a point with a NaN
+// coordinate again, points whose coordinates are NaN at the same places
+// and equal elsewhere are merged.
+
+// .SECTION See Also
+// vtkMergePoints vtkSTLReader vtkPLYReader vtkSMPTools
+
+#ifndef vtkSortMergePoints_h
+#define vtkSortMergePoints_h
+
+#include "vtkIOGeometryModule.h" // For export macro
+#include "vtkObject.h"
+
+class vtkPoints;
+
+class VTKIOGEOMETRY_EXPORT vtkSortMergePoints : public vtkObject
+{
+public:
+  static vtkSortMergePoints *New();
+  vtkTypeMacro(vtkSortMergePoints,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Merge the coincident points of inPts. The unique points are appended
+  // to outPts (which is reset first and given the data type of inPts) and
+  // pointMap, which must hold inPts->GetNumberOfPoints() entries, receives
+  // for every input point the id of the output point it was merged into.
+  // Returns the number of unique points.
+  static vtkIdType MergePoints(vtkPoints *inPts, vtkPoints *outPts,
+                               vtkIdType *pointMap);
+
+protected:
+  vtkSortMergePoints() {}
+  ~vtkSortMergePoints() {}
+
+private:
+  vtkSortMergePoints(const vtkSortMergePoints&);  // Not implemented.
+  void operator=(const vtkSortMergePoints&);  // Not implemented.
+};
+
+#endif
@@ -0,0 +1,278 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPLYReaderBinaryMerging.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkPLYReader reads binary files of either byte order, which
+// are decoded in bulk, the same as the ASCII file read element by element,
+// and that merging points gives the same output as inserting the points
+// read into a vtkMergePoints locator.
+
+#include "vtkAppendPolyData.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMergePoints.h"
+#include "vtkNew.h"
+#include "vtkPLYReader.h"
+#include "vtkPLYWriter.h"
+#include "vtkPlaneSource.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkUnsignedCharArray.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Two grids of quads sharing an edge, whose points and cells are colored.
+// The coordinates are multiples of one half, so that the ASCII file holds
+// them exactly and the points of the shared edge are exactly coincident.
+vtkSmartPointer<vtkPolyData> MakeInput()
+{
+  vtkNew<vtkAppendPolyData> append;
+  for (int i = 0; i < 2; ++i)
+    {
+    vtkNew<vtkPlaneSource> plane;
+    plane->SetOrigin(16.0*i, 0.0, 0.0);
+    plane->SetPoint1(16.0*(i + 1), 0.0, 8.0*i);
+    plane->SetPoint2(16.0*i, 16.0, 0.0);
+    plane->SetResolution(16, 16);
+    plane->Update();
+    append->AddInputData(plane->GetOutput());
+    }
+  append->Update();
+
+  vtkSmartPointer<vtkPolyData> input = vtkSmartPointer<vtkPolyData>::New();
+  input->ShallowCopy(append->GetOutput());
+  input->GetPointData()->Initialize();
+  input->GetCellData()->Initialize();
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkIdType numCells = input->GetNumberOfCells();
+  vtkNew<vtkUnsignedCharArray> pointColors;
+  pointColors->SetName("Colors");
+  pointColors->SetNumberOfComponents(3);
+  pointColors->SetNumberOfTuples(numPts);
+  for (vtkIdType i = 0; i < 3*numPts; ++i)
+    {
+    pointColors->SetValue(i, static_cast<unsigned char>((7*i) % 256));
+    }
+  vtkNew<vtkUnsignedCharArray> cellColors;
+  cellColors->SetName("Colors");
+  cellColors->SetNumberOfComponents(3);
+  cellColors->SetNumberOfTuples(numCells);
+  for (vtkIdType i = 0; i < 3*numCells; ++i)
+    {
+    cellColors->SetValue(i, static_cast<unsigned char>((11*i) % 256));
+    }
+  input->GetPointData()->AddArray(pointColors.GetPointer());
+  input->GetCellData()->AddArray(cellColors.GetPointer());
+  return input;
+}
+
+void Write(vtkPolyData* input, const std::string& fileName, int fileType,
+           int byteOrder)
+{
+  vtkNew<vtkPLYWriter> writer;
+  writer->SetInputData(input);
+  writer->SetFileName(fileName.c_str());
+  writer->SetFileType(fileType);
+  writer->SetDataByteOrder(byteOrder);
+  writer->SetArrayName("Colors");
+  writer->Write();
+}
+
+vtkSmartPointer<vtkPolyData> Read(const std::string& fileName, bool merging)
+{
+  vtkNew<vtkPLYReader> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->SetMerging(merging);
+  reader->Update();
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(reader->GetOutput());
+  return output;
+}
+
+int CompareArrays(vtkFieldData* a, vtkFieldData* b)
+{
+  if (a->GetNumberOfArrays() != b->GetNumberOfArrays())
+    {
+    cerr << "The numbers of arrays differ" << endl;
+    return 1;
+    }
+  for (int i = 0; i < a->GetNumberOfArrays(); ++i)
+    {
+    vtkDataArray* x = a->GetArray(i);
+    vtkDataArray* y = b->GetArray(x->GetName());
+    if (!y || x->GetNumberOfTuples() != y->GetNumberOfTuples() ||
+        x->GetNumberOfComponents() != y->GetNumberOfComponents())
+      {
+      cerr << "Array " << x->GetName() << " differs in size" << endl;
+      return 1;
+      }
+    for (vtkIdType t = 0; t < x->GetNumberOfTuples(); ++t)
+      {
+      for (int c = 0; c < x->GetNumberOfComponents(); ++c)
+        {
+        if (x->GetComponent(t, c) != y->GetComponent(t, c))
+          {
+          cerr << "Array " << x->GetName() << " differs at tuple " << t
+               << endl;
+          return 1;
+          }
+        }
+      }
+    }
+  return 0;
+}
+
+int CompareOutputs(vtkPolyData* a, vtkPolyData* b, const char* what)
+{
+  if (a->GetNumberOfPoints() != b->GetNumberOfPoints() ||
+      a->GetNumberOfPolys() != b->GetNumberOfPolys())
+    {
+    cerr << what << ": " << a->GetNumberOfPoints() << " points and "
+         << a->GetNumberOfPolys() << " polygons instead of "
+         << b->GetNumberOfPoints() << " and " << b->GetNumberOfPolys()
+         << endl;
+    return 1;
+    }
+  for (vtkIdType i = 0; i < a->GetNumberOfPoints(); ++i)
+    {
+    double x[3], y[3];
+    a->GetPoint(i, x);
+    b->GetPoint(i, y);
+    if (x[0] != y[0] || x[1] != y[1] || x[2] != y[2])
+      {
+      cerr << what << ": point " << i << " differs" << endl;
+      return 1;
+      }
+    }
+  vtkIdTypeArray* x = a->GetPolys()->GetData();
+  vtkIdTypeArray* y = b->GetPolys()->GetData();
+  if (x->GetNumberOfTuples() != y->GetNumberOfTuples())
+    {
+    cerr << what << ": the connectivity differs in size" << endl;
+    return 1;
+    }
+  for (vtkIdType i = 0; i < x->GetNumberOfTuples(); ++i)
+    {
+    if (x->GetValue(i) != y->GetValue(i))
+      {
+      cerr << what << ": connectivity entry " << i << " differs" << endl;
+      return 1;
+      }
+    }
+  if (CompareArrays(a->GetPointData(), b->GetPointData()) ||
+      CompareArrays(a->GetCellData(), b->GetCellData()))
+    {
+    cerr << what << ": the attributes differ" << endl;
+    return 1;
+    }
+  return 0;
+}
+
+// Merges the points of an unmerged output by inserting them in order into
+// a vtkMergePoints locator, keeping the point attributes of the first point
+// of every group of coincident points.
+vtkSmartPointer<vtkPolyData> LocatorMerge(vtkPolyData* input)
+{
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkNew<vtkPoints> points;
+  points->SetDataType(input->GetPoints()->GetDataType());
+  vtkNew<vtkMergePoints> locator;
+  locator->InitPointInsertion(points.GetPointer(), input->GetBounds());
+  vtkPointData* inPD = input->GetPointData();
+  vtkNew<vtkPointData> outPD;
+  outPD->CopyAllocate(inPD, numPts);
+  std::vector<vtkIdType> pointMap(numPts);
+  for (vtkIdType i = 0; i < numPts; ++i)
+    {
+    if (locator->InsertUniquePoint(input->GetPoint(i), pointMap[i]))
+      {
+      outPD->CopyData(inPD, i, pointMap[i]);
+      }
+    }
+
+  vtkNew<vtkCellArray> polys;
+  polys->DeepCopy(input->GetPolys());
+  vtkIdTypeArray* cells = polys->GetData();
+  for (vtkIdType i = 0; i < cells->GetNumberOfTuples();)
+    {
+    vtkIdType npts = cells->GetValue(i++);
+    for (vtkIdType k = 0; k < npts; ++k, ++i)
+      {
+      cells->SetValue(i, pointMap[cells->GetValue(i)]);
+      }
+    }
+
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->SetPoints(points.GetPointer());
+  output->SetPolys(polys.GetPointer());
+  output->GetPointData()->ShallowCopy(outPD.GetPointer());
+  output->GetCellData()->ShallowCopy(input->GetCellData());
+  return output;
+}
+
+}
+
+int TestPLYReaderBinaryMerging(int argc, char* argv[])
+{
+  char* tempDir = vtkTestUtilities::GetArgOrEnvOrDefault(
+    "-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  std::string prefix = std::string(tempDir) + "/TestPLYReaderBinaryMerging";
+  delete [] tempDir;
+
+  vtkSmartPointer<vtkPolyData> input = MakeInput();
+  std::string asciiName = prefix + "ASCII.ply";
+  std::string littleName = prefix + "LE.ply";
+  std::string bigName = prefix + "BE.ply";
+  Write(input, asciiName, VTK_ASCII, VTK_LITTLE_ENDIAN);
+  Write(input, littleName, VTK_BINARY, VTK_LITTLE_ENDIAN);
+  Write(input, bigName, VTK_BINARY, VTK_BIG_ENDIAN);
+
+  vtkSmartPointer<vtkPolyData> ascii = Read(asciiName, false);
+  if (ascii->GetNumberOfPoints() != input->GetNumberOfPoints() ||
+      ascii->GetNumberOfPolys() != input->GetNumberOfPolys() ||
+      ascii->GetPointData()->GetNumberOfArrays() != 1 ||
+      ascii->GetCellData()->GetNumberOfArrays() != 1)
+    {
+    cerr << "The ASCII file was not read back" << endl;
+    return 1;
+    }
+  if (CompareOutputs(Read(littleName, false), ascii, "Little endian") ||
+      CompareOutputs(Read(bigName, false), ascii, "Big endian"))
+    {
+    return 1;
+    }
+
+  vtkSmartPointer<vtkPolyData> located = LocatorMerge(ascii);
+  if (located->GetNumberOfPoints() != 2*17*17 - 17)
+    {
+    cerr << "The locator merged " << located->GetNumberOfPoints()
+         << " points" << endl;
+    return 1;
+    }
+  if (CompareOutputs(Read(asciiName, true), located, "ASCII merged") ||
+      CompareOutputs(Read(littleName, true), located, "Binary merged"))
+    {
+    return 1;
+    }
+
+  return 0;
+}
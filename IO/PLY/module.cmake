@@ -6,6 +6,8 @@ vtk_module(vtkIOPLY
     vtkCommonExecutionModel
     vtkIOGeometry
   TEST_DEPENDS
+    vtkFiltersCore
+    vtkFiltersSources
     vtkRendering${VTK_RENDERING_BACKEND}
     vtkIOImage
     vtkTestingRendering
@@ -14,19 +14,25 @@
 =========================================================================*/
 #include "vtkPLYReader.h"
 
+#include "vtkByteSwap.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkPointData.h"
 #include "vtkFloatArray.h"
+#include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 #include "vtkPLY.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
+#include "vtkSortMergePoints.h"
 
+#include <algorithm>
 #include <ctype.h>
 #include <cstddef>
+#include <vector>
 
 vtkStandardNewMacro(vtkPLYReader);
 
@@ -35,6 +41,7 @@ vtkStandardNewMacro(vtkPLYReader);
 vtkPLYReader::vtkPLYReader()
 {
   this->FileName = NULL;
+  this->Merging = 0;
 
   this->SetNumberOfInputPorts(0);
 }
@@ -62,6 +69,384 @@ typedef struct _plyFace {
   int *verts;             // vertex index list
 } plyFace;
 
+namespace
+{
+// Size in bytes of the PLY scalar types, indexed by PLY_CHAR ... PLY_DOUBLE.
+const int vtkPLYTypeSize[] = { 0, 1, 2, 4, 4, 1, 2, 4, 1, 4, 4, 8 };
+
+// Number of vertices fetched from disk with a single fread, and number of
+// faces decoded as one unit of parallel work.
+const vtkIdType VTK_PLY_VERTICES_PER_BLOCK = 1 << 20;
+const vtkIdType VTK_PLY_FACES_PER_BLOCK = 1 << 14;
+
+// Names of the vertex and face properties the reader knows about, in the
+// order used by the layout tables below.
+const char *vtkPLYVertexNames[] = {
+  "x", "y", "z", "u", "v", "nx", "ny", "nz", "red", "green", "blue" };
+const int VTK_PLY_NUM_VERTEX_NAMES = 11;
+const char *vtkPLYFaceNames[] = { "intensity", "red", "green", "blue" };
+const int VTK_PLY_NUM_FACE_NAMES = 4;
+
+// Decode one binary item of the given PLY type stored at ptr.
+template <class T>
+inline T vtkPLYGetBinaryItem(const unsigned char *ptr, int type, bool swapBE)
+{
+  switch (type)
+    {
+    case PLY_CHAR:
+      {
+      vtkTypeInt8 value;
+      memcpy(&value, ptr, sizeof(value));
+      return static_cast<T>(value);
+      }
+    case PLY_UCHAR:
+    case PLY_UINT8:
+      {
+      vtkTypeUInt8 value;
+      memcpy(&value, ptr, sizeof(value));
+      return static_cast<T>(value);
+      }
+    case PLY_SHORT:
+      {
+      vtkTypeInt16 value;
+      memcpy(&value, ptr, sizeof(value));
+      swapBE ? vtkByteSwap::Swap2BE(&value) : vtkByteSwap::Swap2LE(&value);
+      return static_cast<T>(value);
+      }
+    case PLY_USHORT:
+      {
+      vtkTypeUInt16 value;
+      memcpy(&value, ptr, sizeof(value));
+      swapBE ? vtkByteSwap::Swap2BE(&value) : vtkByteSwap::Swap2LE(&value);
+      return static_cast<T>(value);
+      }
+    case PLY_INT:
+    case PLY_INT32:
+      {
+      vtkTypeInt32 value;
+      memcpy(&value, ptr, sizeof(value));
+      swapBE ? vtkByteSwap::Swap4BE(&value) : vtkByteSwap::Swap4LE(&value);
+      return static_cast<T>(value);
+      }
+    case PLY_UINT:
+      {
+      vtkTypeUInt32 value;
+      memcpy(&value, ptr, sizeof(value));
+      swapBE ? vtkByteSwap::Swap4BE(&value) : vtkByteSwap::Swap4LE(&value);
+      return static_cast<T>(value);
+      }
+    case PLY_FLOAT:
+    case PLY_FLOAT32:
+      {
+      vtkTypeFloat32 value;
+      memcpy(&value, ptr, sizeof(value));
+      swapBE ? vtkByteSwap::Swap4BE(&value) : vtkByteSwap::Swap4LE(&value);
+      return static_cast<T>(value);
+      }
+    case PLY_DOUBLE:
+      {
+      vtkTypeFloat64 value;
+      memcpy(&value, ptr, sizeof(value));
+      swapBE ? vtkByteSwap::Swap8BE(&value) : vtkByteSwap::Swap8LE(&value);
+      return static_cast<T>(value);
+      }
+    }
+  return static_cast<T>(0);
+}
+
+// Byte layout of a binary element record. Offsets are relative to the start
+// of the record, or for face properties stored after the vertex list, to the
+// end of the list. Offset is -1 for properties missing from the file. Size
+// is the size of the record without the list items.
+struct vtkPLYRecordLayout
+{
+  int Offset[VTK_PLY_NUM_VERTEX_NAMES];
+  int Type[VTK_PLY_NUM_VERTEX_NAMES];
+  bool AfterList[VTK_PLY_NUM_VERTEX_NAMES];
+  int Size;
+  int ListOffset;    // offset of the list count, faces only
+  int CountType;
+  int IndexType;
+};
+
+// Compute the layout of a binary element whose properties are looked up by
+// the given names. Returns false if the element cannot be decoded in bulk,
+// that is when it has a list property other than a single vertex_indices.
+bool vtkPLYGetRecordLayout(PlyElement *elem, const char **names, int numNames,
+                           vtkPLYRecordLayout &layout)
+{
+  for (int k = 0; k < VTK_PLY_NUM_VERTEX_NAMES; ++k)
+    {
+    layout.Offset[k] = -1;
+    layout.Type[k] = 0;
+    layout.AfterList[k] = false;
+    }
+  layout.ListOffset = -1;
+  layout.CountType = layout.IndexType = 0;
+
+  int offset = 0;
+  bool afterList = false;
+  for (int j = 0; j < elem->nprops; ++j)
+    {
+    PlyProperty *prop = elem->props[j];
+    if (prop->external_type <= PLY_START_TYPE ||
+        prop->external_type >= PLY_END_TYPE)
+      {
+      return false;
+      }
+    if (prop->is_list)
+      {
+      if (afterList || !vtkPLY::equal_strings(prop->name, "vertex_indices") ||
+          prop->count_external <= PLY_START_TYPE ||
+          prop->count_external >= PLY_END_TYPE)
+        {
+        return false;
+        }
+      layout.ListOffset = offset;
+      layout.CountType = prop->count_external;
+      layout.IndexType = prop->external_type;
+      offset = 0;
+      afterList = true;
+      continue;
+      }
+    for (int k = 0; k < numNames; ++k)
+      {
+      if (vtkPLY::equal_strings(prop->name, names[k]))
+        {
+        layout.Offset[k] = offset;
+        layout.Type[k] = prop->external_type;
+        layout.AfterList[k] = afterList;
+        }
+      }
+    offset += vtkPLYTypeSize[prop->external_type];
+    }
+  layout.Size = offset;
+  if (afterList)
+    {
+    layout.Size += layout.ListOffset + vtkPLYTypeSize[layout.CountType];
+    }
+
+  return true;
+}
+
+// Decode a block of fixed size vertex records into the output arrays.
+class vtkPLYDecodeVertices
+{
+public:
+  const unsigned char *Buffer;
+  const vtkPLYRecordLayout *Layout;
+  bool SwapBE;
+  float *Points;
+  float *TCoords;
+  float *Normals;
+  unsigned char *Colors;
+
+  void operator()(vtkIdType i, vtkIdType end) const
+    {
+    const vtkPLYRecordLayout &l = *this->Layout;
+    for (; i < end; ++i)
+      {
+      const unsigned char *rec = this->Buffer + i*l.Size;
+      for (int k = 0; k < 3; ++k)
+        {
+        this->Points[3*i+k] = vtkPLYGetBinaryItem<float>(
+          rec + l.Offset[k], l.Type[k], this->SwapBE);
+        }
+      if (this->TCoords)
+        {
+        for (int k = 0; k < 2; ++k)
+          {
+          this->TCoords[2*i+k] = vtkPLYGetBinaryItem<float>(
+            rec + l.Offset[3+k], l.Type[3+k], this->SwapBE);
+          }
+        }
+      if (this->Normals)
+        {
+        for (int k = 0; k < 3; ++k)
+          {
+          this->Normals[3*i+k] = vtkPLYGetBinaryItem<float>(
+            rec + l.Offset[5+k], l.Type[5+k], this->SwapBE);
+          }
+        }
+      if (this->Colors)
+        {
+        for (int k = 0; k < 3; ++k)
+          {
+          this->Colors[3*i+k] = vtkPLYGetBinaryItem<unsigned char>(
+            rec + l.Offset[8+k], l.Type[8+k], this->SwapBE);
+          }
+        }
+      }
+    }
+};
+
+// Decode blocks of variable size face records into the connectivity array
+// and the cell attributes. BlockStart and BlockCells hold, for every block
+// of VTK_PLY_FACES_PER_BLOCK faces, the byte offset of its first record and
+// the offset of its first cell in the connectivity array.
+class vtkPLYDecodeFaces
+{
+public:
+  const unsigned char *Buffer;
+  const vtkPLYRecordLayout *Layout;
+  bool SwapBE;
+  const vtkIdType *BlockStart;
+  const vtkIdType *BlockCells;
+  vtkIdType NumberOfFaces;
+  vtkIdType *Cells;
+  unsigned char *Intensity;
+  unsigned char *Colors;
+
+  void operator()(vtkIdType block, vtkIdType end) const
+    {
+    const vtkPLYRecordLayout &l = *this->Layout;
+    int countSize = vtkPLYTypeSize[l.CountType];
+    int indexSize = vtkPLYTypeSize[l.IndexType];
+    for (; block < end; ++block)
+      {
+      const unsigned char *rec = this->Buffer + this->BlockStart[block];
+      vtkIdType *cell = this->Cells + this->BlockCells[block];
+      vtkIdType j = block*VTK_PLY_FACES_PER_BLOCK;
+      vtkIdType last = std::min(j + VTK_PLY_FACES_PER_BLOCK,
+                                this->NumberOfFaces);
+      for (; j < last; ++j)
+        {
+        const unsigned char *list = rec + l.ListOffset;
+        vtkIdType npts = vtkPLYGetBinaryItem<vtkIdType>(
+          list, l.CountType, this->SwapBE);
+        const unsigned char *listEnd = list + countSize + npts*indexSize;
+        *cell++ = npts;
+        for (vtkIdType k = 0; k < npts; ++k)
+          {
+          *cell++ = vtkPLYGetBinaryItem<vtkIdType>(
+            list + countSize + k*indexSize, l.IndexType, this->SwapBE);
+          }
+        if (this->Intensity)
+          {
+          this->Intensity[j] = this->GetUChar(rec, listEnd, 0);
+          }
+        if (this->Colors)
+          {
+          for (int k = 0; k < 3; ++k)
+            {
+            this->Colors[3*j+k] = this->GetUChar(rec, listEnd, 1+k);
+            }
+          }
+        rec = listEnd + (l.Size - l.ListOffset - countSize);
+        }
+      }
+    }
+
+  unsigned char GetUChar(const unsigned char *rec,
+                         const unsigned char *listEnd, int k) const
+    {
+    const vtkPLYRecordLayout &l = *this->Layout;
+    const unsigned char *ptr = (l.AfterList[k] ? listEnd : rec) + l.Offset[k];
+    return vtkPLYGetBinaryItem<unsigned char>(ptr, l.Type[k], this->SwapBE);
+    }
+};
+// Read numPts fixed size vertex records in large blocks and decode each
+// block in parallel. Arrays that are not wanted are NULL.
+bool vtkPLYReadBinaryVertices(PlyFile *ply, const vtkPLYRecordLayout &layout,
+                              vtkIdType numPts, float *points, float *tcoords,
+                              float *normals, unsigned char *colors)
+{
+  vtkPLYDecodeVertices decode;
+  decode.Layout = &layout;
+  decode.SwapBE = (ply->file_type == PLY_BINARY_BE);
+
+  std::vector<unsigned char> buffer(
+    layout.Size*std::min(numPts, VTK_PLY_VERTICES_PER_BLOCK));
+  for (vtkIdType first = 0; first < numPts;
+       first += VTK_PLY_VERTICES_PER_BLOCK)
+    {
+    vtkIdType num = std::min(VTK_PLY_VERTICES_PER_BLOCK, numPts - first);
+    if (fread(&buffer[0], layout.Size, num, ply->fp) !=
+        static_cast<size_t>(num))
+      {
+      return false;
+      }
+    decode.Buffer = &buffer[0];
+    decode.Points = points + 3*first;
+    decode.TCoords = (tcoords ? tcoords + 2*first : NULL);
+    decode.Normals = (normals ? normals + 3*first : NULL);
+    decode.Colors = (colors ? colors + 3*first : NULL);
+    vtkSMPTools::For(0, num, decode);
+    }
+
+  return true;
+}
+
+// Read the remainder of the file and decode numPolys face records from it.
+// Faces have a variable size, so a serial pass first locates the start of
+// every block of faces, then the blocks are decoded in parallel.
+bool vtkPLYReadBinaryFaces(PlyFile *ply, const vtkPLYRecordLayout &layout,
+                           vtkIdType numPolys, vtkCellArray *polys,
+                           unsigned char *intensity, unsigned char *colors)
+{
+  const size_t chunkSize = 1 << 26;
+  std::vector<unsigned char> buffer;
+  size_t size = 0;
+  for (;;)
+    {
+    buffer.resize(size + chunkSize);
+    size_t num = fread(&buffer[size], 1, chunkSize, ply->fp);
+    size += num;
+    if (num < chunkSize)
+      {
+      break;
+      }
+    }
+
+  bool swapBE = (ply->file_type == PLY_BINARY_BE);
+  vtkIdType indexSize = vtkPLYTypeSize[layout.IndexType];
+  vtkIdType numBlocks =
+    (numPolys + VTK_PLY_FACES_PER_BLOCK - 1) / VTK_PLY_FACES_PER_BLOCK;
+  std::vector<vtkIdType> blockStart(numBlocks + 1);
+  std::vector<vtkIdType> blockCells(numBlocks + 1);
+  vtkIdType pos = 0;
+  vtkIdType connSize = 0;
+  for (vtkIdType j = 0; j < numPolys; ++j)
+    {
+    if (j % VTK_PLY_FACES_PER_BLOCK == 0)
+      {
+      blockStart[j / VTK_PLY_FACES_PER_BLOCK] = pos;
+      blockCells[j / VTK_PLY_FACES_PER_BLOCK] = connSize;
+      }
+    if (pos + layout.Size > static_cast<vtkIdType>(size))
+      {
+      return false;
+      }
+    vtkIdType npts = vtkPLYGetBinaryItem<vtkIdType>(
+      &buffer[pos + layout.ListOffset], layout.CountType, swapBE);
+    if (npts < 0)
+      {
+      return false;
+      }
+    pos += layout.Size + npts*indexSize;
+    connSize += npts + 1;
+    }
+  if (pos > static_cast<vtkIdType>(size))
+    {
+    return false;
+    }
+
+  vtkPLYDecodeFaces decode;
+  decode.Buffer = (size > 0 ? &buffer[0] : NULL);
+  decode.Layout = &layout;
+  decode.SwapBE = swapBE;
+  decode.BlockStart = &blockStart[0];
+  decode.BlockCells = &blockCells[0];
+  decode.NumberOfFaces = numPolys;
+  decode.Cells = polys->WritePointer(numPolys, connSize);
+  decode.Intensity = intensity;
+  decode.Colors = colors;
+  vtkSMPTools::For(0, numBlocks, 1, decode);
+
+  return true;
+}
+}
+
 int vtkPLYReader::RequestData(
   vtkInformation *vtkNotUsed(request),
   vtkInformationVector **vtkNotUsed(inputVector),
@@ -208,16 +593,23 @@ int vtkPLYReader::RequestData(
     output->GetPointData()->SetTCoords(TexCoordsPoints);
     }
 
-  // Okay, now we can grab the data
+  // Okay, now we can grab the data. Binary elements whose layout is known
+  // up front are read in bulk and decoded in parallel, everything else goes
+  // through the element-by-element PLY library calls.
+  bool binary = (fileType == PLY_BINARY_BE || fileType == PLY_BINARY_LE);
   int numPts = 0, numPolys = 0;
+  bool readError = false;
   for (int i = 0; i < nelems; i++)
     {
     //get the description of the first element */
     elemName = elist[i];
     vtkPLY::ply_get_element_description (ply, elemName, &numElems, &nprops);
 
+    PlyElement *plyElem = vtkPLY::find_element(ply, elemName);
+    vtkPLYRecordLayout layout;
+
     // if we're on vertex elements, read them in
-    if ( elemName && !strcmp ("vertex", elemName) )
+    if ( elemName && !strcmp ("vertex", elemName) && !readError )
       {
       // Create a list of points
       numPts = numElems;
@@ -225,103 +617,163 @@ int vtkPLYReader::RequestData(
       pts->SetDataTypeToFloat();
       pts->SetNumberOfPoints(numPts);
 
-      // Setup to read the PLY elements
-      vtkPLY::ply_get_property (ply, elemName, &vertProps[0]);
-      vtkPLY::ply_get_property (ply, elemName, &vertProps[1]);
-      vtkPLY::ply_get_property (ply, elemName, &vertProps[2]);
-
       if ( TexCoordsPointsAvailable )
         {
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[3]);
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[4]);
         TexCoordsPoints->SetNumberOfTuples(numPts);
         }
-
       if ( NormalPointsAvailable )
         {
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[5]);
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[6]);
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[7]);
         Normals->SetNumberOfTuples(numPts);
         }
-
       if ( RGBPointsAvailable )
         {
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[8]);
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[9]);
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[10]);
         RGBPoints->SetNumberOfTuples(numPts);
         }
 
-      plyVertex vertex;
-      for (int j=0; j < numPts; j++)
+      if ( binary &&
+           vtkPLYGetRecordLayout(plyElem, vtkPLYVertexNames,
+                                 VTK_PLY_NUM_VERTEX_NAMES, layout) &&
+           layout.ListOffset < 0 )
         {
-        vtkPLY::ply_get_element (ply, (void *) &vertex);
-        pts->SetPoint (j, vertex.x);
+        if ( !vtkPLYReadBinaryVertices(ply, layout, numPts,
+               static_cast<float*>(pts->GetData()->GetVoidPointer(0)),
+               TexCoordsPointsAvailable ? TexCoordsPoints->GetPointer(0) : NULL,
+               NormalPointsAvailable ? Normals->GetPointer(0) : NULL,
+               RGBPointsAvailable ? RGBPoints->GetPointer(0) : NULL) )
+          {
+          vtkErrorMacro(<<"Premature EOF while reading vertices");
+          readError = true;
+          }
+        }
+      else
+        {
+        // Setup to read the PLY elements
+        vtkPLY::ply_get_property (ply, elemName, &vertProps[0]);
+        vtkPLY::ply_get_property (ply, elemName, &vertProps[1]);
+        vtkPLY::ply_get_property (ply, elemName, &vertProps[2]);
+
         if ( TexCoordsPointsAvailable )
           {
-          TexCoordsPoints->SetTuple2(j, vertex.tex[0], vertex.tex[1]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[3]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[4]);
           }
+
         if ( NormalPointsAvailable )
           {
-          Normals->SetTuple3(j, vertex.normal[0], vertex.normal[1], vertex.normal[2]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[5]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[6]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[7]);
           }
+
         if ( RGBPointsAvailable )
           {
-          RGBPoints->SetTuple3(j, vertex.red, vertex.green, vertex.blue);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[8]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[9]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[10]);
+          }
+
+        plyVertex vertex;
+        for (int j=0; j < numPts; j++)
+          {
+          vtkPLY::ply_get_element (ply, (void *) &vertex);
+          pts->SetPoint (j, vertex.x);
+          if ( TexCoordsPointsAvailable )
+            {
+            TexCoordsPoints->SetTuple2(j, vertex.tex[0], vertex.tex[1]);
+            }
+          if ( NormalPointsAvailable )
+            {
+            Normals->SetTuple3(j, vertex.normal[0], vertex.normal[1], vertex.normal[2]);
+            }
+          if ( RGBPointsAvailable )
+            {
+            RGBPoints->SetTuple3(j, vertex.red, vertex.green, vertex.blue);
+            }
           }
         }
       output->SetPoints(pts);
       pts->Delete();
       }//if vertex
 
-    else if ( elemName && !strcmp ("face", elemName) )
+    else if ( elemName && !strcmp ("face", elemName) && !readError )
       {
       // Create a polygonal array
       numPolys = numElems;
       vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
-      polys->Allocate(polys->EstimateSize(numPolys,3),numPolys/2);
-      plyFace face;
-      vtkIdType vtkVerts[256];
 
-      // Get the face properties
-      vtkPLY::ply_get_property (ply, elemName, &faceProps[0]);
       if ( intensityAvailable )
         {
-        vtkPLY::ply_get_property (ply, elemName, &faceProps[1]);
-        RGBCells->SetNumberOfComponents(1);
-        RGBCells->SetNumberOfTuples(numPolys);
+        intensity->SetNumberOfComponents(1);
+        intensity->SetNumberOfTuples(numPolys);
         }
       if ( RGBCellsAvailable )
         {
-        vtkPLY::ply_get_property (ply, elemName, &faceProps[2]);
-        vtkPLY::ply_get_property (ply, elemName, &faceProps[3]);
-        vtkPLY::ply_get_property (ply, elemName, &faceProps[4]);
         RGBCells->SetNumberOfComponents(3);
         RGBCells->SetNumberOfTuples(numPolys);
         }
 
-      // grab all the face elements
-      for (int j=0; j < numPolys; j++)
+      // The bulk face reader consumes the rest of the file, so it is only
+      // used when the vertices have already been read.
+      bool bulk = binary &&
+        vtkPLYGetRecordLayout(plyElem, vtkPLYFaceNames,
+                              VTK_PLY_NUM_FACE_NAMES, layout) &&
+        layout.ListOffset >= 0;
+      for (int k = i+1; k < nelems && bulk; k++)
         {
-        //grab and element from the file
-        vtkPLY::ply_get_element (ply, (void *) &face);
-        for (int k=0; k < face.nverts; k++)
+        bulk = (strcmp ("vertex", elist[k]) != 0);
+        }
+
+      if ( bulk )
+        {
+        if ( !vtkPLYReadBinaryFaces(ply, layout, numPolys, polys,
+               intensityAvailable ? intensity->GetPointer(0) : NULL,
+               RGBCellsAvailable ? RGBCells->GetPointer(0) : NULL) )
           {
-          vtkVerts[k] = face.verts[k];
+          vtkErrorMacro(<<"Premature EOF while reading faces");
+          readError = true;
           }
-        free(face.verts); // allocated in vtkPLY::ascii/binary_get_element
+        }
+      else
+        {
+        polys->Allocate(polys->EstimateSize(numPolys,3),numPolys/2);
+        plyFace face;
+        vtkIdType vtkVerts[256];
 
-        polys->InsertNextCell(face.nverts,vtkVerts);
+        // Get the face properties
+        vtkPLY::ply_get_property (ply, elemName, &faceProps[0]);
         if ( intensityAvailable )
           {
-          intensity->SetValue(j,face.intensity);
+          vtkPLY::ply_get_property (ply, elemName, &faceProps[1]);
           }
         if ( RGBCellsAvailable )
           {
-          RGBCells->SetValue(3*j,face.red);
-          RGBCells->SetValue(3*j+1,face.green);
-          RGBCells->SetValue(3*j+2,face.blue);
+          vtkPLY::ply_get_property (ply, elemName, &faceProps[2]);
+          vtkPLY::ply_get_property (ply, elemName, &faceProps[3]);
+          vtkPLY::ply_get_property (ply, elemName, &faceProps[4]);
+          }
+
+        // grab all the face elements
+        for (int j=0; j < numPolys; j++)
+          {
+          //grab and element from the file
+          vtkPLY::ply_get_element (ply, (void *) &face);
+          for (int k=0; k < face.nverts; k++)
+            {
+            vtkVerts[k] = face.verts[k];
+            }
+          free(face.verts); // allocated in vtkPLY::ascii/binary_get_element
+
+          polys->InsertNextCell(face.nverts,vtkVerts);
+          if ( intensityAvailable )
+            {
+            intensity->SetValue(j,face.intensity);
+            }
+          if ( RGBCellsAvailable )
+            {
+            RGBCells->SetValue(3*j,face.red);
+            RGBCells->SetValue(3*j+1,face.green);
+            RGBCells->SetValue(3*j+2,face.blue);
+            }
           }
         }
       output->SetPolys(polys);
@@ -333,6 +785,18 @@ int vtkPLYReader::RequestData(
     }//for all elements of the PLY file
   free(elist); //allocated by ply_open_for_reading
 
+  if ( readError )
+    {
+    vtkPLY::ply_close (ply);
+    output->Initialize();
+    return 0;
+    }
+
+  if ( this->Merging && output->GetPoints() )
+    {
+    this->MergePoints(output);
+    }
+
   vtkDebugMacro( <<"Read: " << numPts << " points, "
                  << numPolys << " polygons");
 
@@ -342,6 +806,59 @@ int vtkPLYReader::RequestData(
   return 1;
 }
 
+// Merge coincident points of the output, keeping the point attributes of
+// the first point of every group of coincident points.
+void vtkPLYReader::MergePoints(vtkPolyData *output)
+{
+  vtkPoints *pts = output->GetPoints();
+  vtkIdType numPts = pts->GetNumberOfPoints();
+  std::vector<vtkIdType> pointMap(numPts + 1);
+  vtkSmartPointer<vtkPoints> mergedPts = vtkSmartPointer<vtkPoints>::New();
+  vtkIdType numMerged =
+    vtkSortMergePoints::MergePoints(pts, mergedPts, &pointMap[0]);
+  if (numMerged == numPts)
+    {
+    return;
+    }
+
+  // Renumber the polygons in place.
+  vtkCellArray *polys = output->GetPolys();
+  vtkIdType *cells = polys->GetPointer();
+  vtkIdType *cellsEnd = cells + polys->GetNumberOfConnectivityEntries();
+  while (cells < cellsEnd)
+    {
+    vtkIdType npts = *cells++;
+    for (vtkIdType k = 0; k < npts; ++k, ++cells)
+      {
+      *cells = pointMap[*cells];
+      }
+    }
+
+  // New ids are handed out in order of first occurrence.
+  vtkSmartPointer<vtkIdList> firstIds = vtkSmartPointer<vtkIdList>::New();
+  firstIds->SetNumberOfIds(numMerged);
+  for (vtkIdType i = 0, nextId = 0; i < numPts; ++i)
+    {
+    if (pointMap[i] == nextId)
+      {
+      firstIds->SetId(nextId++, i);
+      }
+    }
+
+  vtkPointData *pd = output->GetPointData();
+  vtkSmartPointer<vtkPointData> mergedPD = vtkSmartPointer<vtkPointData>::New();
+  mergedPD->CopyAllocate(pd, numMerged);
+  for (vtkIdType i = 0; i < numMerged; ++i)
+    {
+    mergedPD->CopyData(pd, firstIds->GetId(i), i);
+    }
+
+  output->SetPoints(mergedPts);
+  pd->ShallowCopy(mergedPD);
+
+  vtkDebugMacro( <<"Merged to: " << numMerged << " points");
+}
+
 int vtkPLYReader::CanReadFile(const char *filename)
 {
   FILE *fd = fopen(filename, "rb");
@@ -359,4 +876,5 @@ void vtkPLYReader::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "File Name: "
      << (this->FileName ? this->FileName : "(none)") << "\n";
+  os << indent << "Merging: " << (this->Merging ? "On\n" : "Off\n");
 }
@@ -23,6 +23,13 @@
 // element has the properties "intensity" and/or the triplet "red",
 // "green", and "blue"; these are read and added as scalars to the
 // output data.
+//
+// Binary files whose vertex and face elements have a fixed layout (scalar
+// properties plus a single "vertex_indices" list) are read in large blocks
+// and decoded in parallel directly into the output arrays. Other files are
+// read one element at a time through vtkPLY.
+//
+// Coincident points can optionally be merged after reading, see Merging.
 
 // .SECTION See Also
 // vtkPLYWriter
@@ -47,10 +54,28 @@ public:
   // A simple, non-exhaustive check to see if a file is a valid ply file.
   static int CanReadFile(const char *filename);
 
+  // Description:
+  // Turn on/off merging of coincident points after reading. Points are
+  // merged with a parallel sort (see vtkSortMergePoints) and the polygons
+  // are renumbered accordingly; the point attributes of the first point of
+  // each merged group are kept. Degenerate polygons are not removed. The
+  // output is the one inserting the points into a vtkMergePoints locator
+  // gives, except that points with NaN coordinates are merged too. Off by
+  // default.
+  vtkSetMacro(Merging,int);
+  vtkGetMacro(Merging,int);
+  vtkBooleanMacro(Merging,int);
+
 protected:
   vtkPLYReader();
   ~vtkPLYReader();
 
+  int Merging;
+
+  // Description:
+  // Merge coincident points of the output and renumber its polygons.
+  void MergePoints(vtkPolyData *output);
+
   int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
 private:
   vtkPLYReader(const vtkPLYReader&);  // Not implemented.
@@ -471,6 +471,9 @@ int vtkPExodusIIReader::RequestData(
       progress->SetIndex( reader_idx );
       er->AddObserver( vtkCommand::ProgressEvent, progress );
       progress->Delete();
+      // All files share one cache so that VariableCacheSize bounds the
+      // memory used by all of them rather than by each one.
+      er->SetCache( this->GetCache() );
 
       this->ReaderList.push_back( er );
       }
@@ -500,13 +503,6 @@ int vtkPExodusIIReader::RequestData(
   this->Dump();
 #endif // DBG_PEXOIIRDR
 
-  //setup the cache size for each reader
-  double fractionalCacheSize = 0;
-  if (this->VariableCacheSize > 0 )
-    {
-    fractionalCacheSize = this->VariableCacheSize / static_cast<int>( this->ReaderList.size() );
-    }
-
   // This constructs the filenames
   for ( fileIndex = min, reader_idx=0; fileIndex <= max; ++fileIndex, ++reader_idx )
     {
@@ -642,15 +638,12 @@ int vtkPExodusIIReader::RequestData(
         }
       }
 
-    //set this reader to use the full amount of the cache
+    //the readers share the cache, which holds VariableCacheSize in total
     this->ReaderList[reader_idx]->SetCacheSize(this->VariableCacheSize);
 
     //call the reader
     this->ReaderList[reader_idx]->Update();
 
-    //set the reader back to the fractional amount
-    this->ReaderList[reader_idx]->SetCacheSize(fractionalCacheSize);
-
 #if 0
     vtkCompositeDataSet* subgrid = this->ReaderList[reader_idx]->GetOutput();
     //subgrid->ShallowCopy( this->ReaderList[reader_idx]->GetOutput() );
@@ -118,14 +118,11 @@ public:
   virtual void Broadcast( vtkMultiProcessController* ctrl );
 
   //Description:
-  //The size of the variable cache in MegaByes. This represents the maximum
-  //size of cache that a single partition reader can have while reading. When
-  //a reader is finished its cache size will be set to a fraction of this based
-  //on the number of partitions.
+  //The size of the variable cache in MegaByes. The readers of all the
+  //partitions share the cache of this reader, which is the global cache of
+  //vtkExodusIICache unless SetCache() was called, and this is applied as its
+  //capacity when reading.
   //The Default for this is 100MiB.
-  //Note that because each reader still holds
-  //a fraction of the cache size after reading the total amount of data cached
-  //can be at most twice this size.
   vtkGetMacro(VariableCacheSize,double);
   vtkSetMacro(VariableCacheSize,double);
 
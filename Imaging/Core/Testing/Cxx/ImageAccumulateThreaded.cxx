@@ -0,0 +1,238 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    ImageAccumulateThreaded.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test of the threaded reduction of vtkImageAccumulate
+// .SECTION Description
+// Compares the bins and the statistics of vtkImageAccumulate with those
+// computed serially, for one to three components, with and without a
+// stencil, a reversed stencil and IgnoreZero, and for several numbers of
+// threads.  Also checks the standard deviation of data with a large mean.
+
+#include "vtkImageAccumulate.h"
+#include "vtkImageData.h"
+#include "vtkImageStencilData.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+
+#include <math.h>
+#include <vector>
+
+static const int imageExtent[6] = { -3, 40, 2, 30, 0, 17 };
+
+// Only some of each row is in the stencil, and some rows are empty.
+static bool IsInStencil(int i, int j, int k)
+{
+  int x0 = imageExtent[0] + (j*3 + k) % 11;
+  int x1 = x0 + (j*k) % 29;
+  return ((j + k) % 5 != 0 && i >= x0 && i <= x1);
+}
+
+static int TestAccumulate(int numC, bool useStencil, bool reverse,
+                          bool ignoreZero, int numThreads)
+{
+  const int binExt[6] = { 0, 12, -2, 9, 1, 5 };
+  const double binOrigin[3] = { -5.0, 3.0, -1.0 };
+  const double binSpacing[3] = { 2.5, 1.0, 0.5 };
+
+  vtkNew<vtkImageData> image;
+  image->SetExtent(const_cast<int *>(imageExtent));
+  image->AllocateScalars(VTK_FLOAT, numC);
+  float *ptr = static_cast<float *>(image->GetScalarPointer());
+  vtkIdType n = image->GetNumberOfPoints();
+  for (vtkIdType i = 0; i < n*numC; ++i)
+    {
+    int v = static_cast<int>((i*7919 + (i*i) % 1013) % 53) - 20;
+    ptr[i] = (v % 3 == 0 ? 0.0f : 0.5f*v);
+    }
+
+  vtkNew<vtkImageStencilData> stencil;
+  stencil->SetExtent(const_cast<int *>(imageExtent));
+  stencil->AllocateExtents();
+  for (int k = imageExtent[4]; k <= imageExtent[5]; ++k)
+    {
+    for (int j = imageExtent[2]; j <= imageExtent[3]; ++j)
+      {
+      for (int i = imageExtent[0]; i <= imageExtent[1]; ++i)
+        {
+        if (IsInStencil(i, j, k))
+          {
+          stencil->InsertNextExtent(i, i, j, k);
+          }
+        }
+      }
+    }
+
+  vtkNew<vtkImageAccumulate> accumulate;
+  accumulate->SetInputData(image.GetPointer());
+  if (useStencil)
+    {
+    accumulate->SetStencilData(stencil.GetPointer());
+    }
+  accumulate->SetReverseStencil(reverse);
+  accumulate->SetIgnoreZero(ignoreZero);
+  accumulate->SetComponentExtent(const_cast<int *>(binExt));
+  accumulate->SetComponentOrigin(const_cast<double *>(binOrigin));
+  accumulate->SetComponentSpacing(const_cast<double *>(binSpacing));
+  accumulate->SetNumberOfThreads(numThreads);
+  accumulate->Update();
+
+  // compute everything serially
+  int nx = binExt[1] - binExt[0] + 1;
+  int ny = binExt[3] - binExt[2] + 1;
+  int nz = binExt[5] - binExt[4] + 1;
+  std::vector<vtkIdType> bins(nx*ny*nz, 0);
+  std::vector<double> values[3];
+  vtkIdType idx = 0;
+  for (int k = imageExtent[4]; k <= imageExtent[5]; ++k)
+    {
+    for (int j = imageExtent[2]; j <= imageExtent[3]; ++j)
+      {
+      for (int i = imageExtent[0]; i <= imageExtent[1]; ++i, ++idx)
+        {
+        if (useStencil && (IsInStencil(i, j, k) == reverse))
+          {
+          continue;
+          }
+        int b[3] = { binExt[0], binExt[2], binExt[4] };
+        bool inside = true;
+        for (int c = 0; c < numC; ++c)
+          {
+          double v = ptr[idx*numC + c];
+          if (!ignoreZero || v != 0)
+            {
+            values[c].push_back(v);
+            }
+          b[c] = vtkMath::Floor((v - binOrigin[c])/binSpacing[c]);
+          inside &= (b[c] >= binExt[2*c] && b[c] <= binExt[2*c + 1]);
+          }
+        if (inside)
+          {
+          bins[((b[2] - binExt[4])*ny + b[1] - binExt[2])*nx +
+               b[0] - binExt[0]]++;
+          }
+        }
+      }
+    }
+
+  const vtkIdType *result =
+    static_cast<vtkIdType *>(accumulate->GetOutput()->GetScalarPointer());
+  for (size_t i = 0; i < bins.size(); ++i)
+    {
+    if (result[i] != bins[i])
+      {
+      cerr << numC << " components, " << numThreads << " threads: bin "
+           << i << " is " << result[i] << " instead of " << bins[i] << endl;
+      return 1;
+      }
+    }
+
+  vtkIdType voxelCount = 0;
+  for (int c = 0; c < numC; ++c)
+    {
+    voxelCount += static_cast<vtkIdType>(values[c].size());
+    double mean = 0.0;
+    double min = VTK_DOUBLE_MAX;
+    double max = VTK_DOUBLE_MIN;
+    for (size_t i = 0; i < values[c].size(); ++i)
+      {
+      mean += values[c][i];
+      min = (values[c][i] < min ? values[c][i] : min);
+      max = (values[c][i] > max ? values[c][i] : max);
+      }
+    mean /= values[c].size();
+    double var = 0.0;
+    for (size_t i = 0; i < values[c].size(); ++i)
+      {
+      var += (values[c][i] - mean)*(values[c][i] - mean);
+      }
+    double stdDev = sqrt(var/(values[c].size() - 1));
+
+    if (fabs(accumulate->GetMean()[c] - mean) > 1e-12 ||
+        fabs(accumulate->GetStandardDeviation()[c] - stdDev) > 1e-12 ||
+        accumulate->GetMin()[c] != min || accumulate->GetMax()[c] != max)
+      {
+      cerr << numC << " components, " << numThreads << " threads: "
+           << "statistics of component " << c << " are "
+           << accumulate->GetMean()[c] << ", "
+           << accumulate->GetStandardDeviation()[c] << ", "
+           << accumulate->GetMin()[c] << ", " << accumulate->GetMax()[c]
+           << " instead of " << mean << ", " << stdDev << ", " << min
+           << ", " << max << endl;
+      return 1;
+      }
+    }
+
+  if (accumulate->GetVoxelCount() != voxelCount)
+    {
+    cerr << numC << " components, " << numThreads << " threads: voxel count "
+         << "is " << accumulate->GetVoxelCount() << " instead of "
+         << voxelCount << endl;
+    return 1;
+    }
+
+  return 0;
+}
+
+// A sum of squares loses all of the precision of data like this.
+static int TestLargeMean(int numThreads)
+{
+  vtkNew<vtkImageData> image;
+  image->SetExtent(0, 63, 0, 63, 0, 15);
+  image->AllocateScalars(VTK_DOUBLE, 1);
+  double *ptr = static_cast<double *>(image->GetScalarPointer());
+  vtkIdType n = image->GetNumberOfPoints();
+  for (vtkIdType i = 0; i < n; ++i)
+    {
+    ptr[i] = 1e9 + (i % 2);
+    }
+
+  vtkNew<vtkImageAccumulate> accumulate;
+  accumulate->SetInputData(image.GetPointer());
+  accumulate->SetNumberOfThreads(numThreads);
+  accumulate->Update();
+
+  double mean = 1e9 + 0.5;
+  double stdDev = sqrt(0.25*n/(n - 1));
+  if (fabs(accumulate->GetMean()[0] - mean) > 1e-6 ||
+      fabs(accumulate->GetStandardDeviation()[0] - stdDev) > 1e-6)
+    {
+    cerr << numThreads << " threads: mean and standard deviation are "
+         << accumulate->GetMean()[0] << ", "
+         << accumulate->GetStandardDeviation()[0] << " instead of "
+         << mean << ", " << stdDev << endl;
+    return 1;
+    }
+
+  return 0;
+}
+
+int ImageAccumulateThreaded(int, char *[])
+{
+  static const int threads[3] = { 1, 4, 7 };
+
+  int rval = 0;
+  for (int t = 0; t < 3; ++t)
+    {
+    for (int numC = 1; numC <= 3; ++numC)
+      {
+      rval |= TestAccumulate(numC, false, false, false, threads[t]);
+      rval |= TestAccumulate(numC, false, false, true, threads[t]);
+      rval |= TestAccumulate(numC, true, false, false, threads[t]);
+      rval |= TestAccumulate(numC, true, true, true, threads[t]);
+      }
+    rval |= TestLargeMean(threads[t]);
+    }
+
+  return rval;
+}
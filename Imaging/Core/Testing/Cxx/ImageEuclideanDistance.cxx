@@ -0,0 +1,162 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    ImageEuclideanDistance.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test of the Felzenszwalb algorithm of vtkImageEuclideanDistance
+// .SECTION Description
+// Compares the squared distances of the Felzenszwalb algorithm with a
+// brute force search, with and without anisotropy and in 2D, and checks
+// that the feature transform points to a zero voxel at the computed
+// distance.  Without anisotropy, the result must also equal that of
+// Saito's algorithm.
+
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkImageEuclideanDistance.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+
+#include <math.h>
+#include <vector>
+
+static int TestDistance(const int dims[3], int dimensionality,
+                        bool anisotropy)
+{
+  const double spacing[3] = { 0.7, 1.3, 2.0 };
+
+  // a few scattered zero voxels, none in the last slice
+  vtkNew<vtkImageData> image;
+  image->SetExtent(2, dims[0] + 1, 0, dims[1] - 1, 3, dims[2] + 2);
+  image->SetSpacing(spacing[0], spacing[1], spacing[2]);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char *ptr = static_cast<unsigned char *>(image->GetScalarPointer());
+  int n = dims[0]*dims[1]*dims[2];
+  std::vector<int> zeros;
+  for (int i = 0; i < n; ++i)
+    {
+    int x = i % dims[0];
+    int z = i / (dims[0]*dims[1]);
+    bool zero = ((i*7919) % 211 == 0 && x < dims[0]/2 && z < dims[2] - 1);
+    ptr[i] = (zero ? 0 : 1);
+    if (zero)
+      {
+      zeros.push_back(i);
+      }
+    }
+
+  vtkNew<vtkImageEuclideanDistance> saito;
+  saito->SetInputData(image.GetPointer());
+  saito->SetDimensionality(dimensionality);
+  saito->SetConsiderAnisotropy(anisotropy);
+  saito->SetAlgorithmToSaito();
+  saito->Update();
+
+  vtkNew<vtkImageEuclideanDistance> edt;
+  edt->SetInputData(image.GetPointer());
+  edt->SetDimensionality(dimensionality);
+  edt->SetConsiderAnisotropy(anisotropy);
+  edt->SetAlgorithmToFelzenszwalb();
+  edt->ComputeFeatureTransformOn();
+  edt->Update();
+
+  vtkImageData *output = edt->GetOutput();
+  const double *result = static_cast<double *>(output->GetScalarPointer());
+  const double *expected =
+    static_cast<double *>(saito->GetOutput()->GetScalarPointer());
+  vtkIdTypeArray *features = vtkIdTypeArray::SafeDownCast(
+    output->GetPointData()->GetArray("FeatureIndex"));
+  if (!features || features->GetNumberOfTuples() != n)
+    {
+    cerr << "The feature transform is missing" << endl;
+    return 1;
+    }
+
+  double s[3] = { 1.0, 1.0, 1.0 };
+  if (anisotropy)
+    {
+    s[0] = spacing[0];
+    s[1] = spacing[1];
+    s[2] = spacing[2];
+    }
+  for (int i = 0; i < n; ++i)
+    {
+    int p[3] = { i % dims[0], (i / dims[0]) % dims[1],
+                 i / (dims[0]*dims[1]) };
+
+    // the nearest zero, in 2D only within the same slice
+    double best = VTK_INT_MAX;
+    for (size_t j = 0; j < zeros.size(); ++j)
+      {
+      int q = zeros[j];
+      int d[3] = { q % dims[0] - p[0], (q / dims[0]) % dims[1] - p[1],
+                   q / (dims[0]*dims[1]) - p[2] };
+      if (dimensionality == 2 && d[2] != 0)
+        {
+        continue;
+        }
+      double dist = 0.0;
+      for (int k = 0; k < 3; ++k)
+        {
+        dist += d[k]*d[k]*s[k]*s[k];
+        }
+      best = (dist < best ? dist : best);
+      }
+
+    if (fabs(result[i] - best) > 1e-9*best ||
+        (!anisotropy && result[i] != expected[i]))
+      {
+      cerr << "Distance at " << i << " is " << result[i] << " instead of "
+           << best << " (Saito: " << expected[i] << ")" << endl;
+      return 1;
+      }
+
+    vtkIdType f = features->GetValue(i);
+    if (best >= VTK_INT_MAX)
+      {
+      if (f != -1)
+        {
+        cerr << "Feature at " << i << " is " << f << " instead of -1" << endl;
+        return 1;
+        }
+      continue;
+      }
+    int q[3] = { static_cast<int>(f % dims[0]),
+                 static_cast<int>((f / dims[0]) % dims[1]),
+                 static_cast<int>(f / (dims[0]*dims[1])) };
+    double dist = 0.0;
+    for (int k = 0; k < 3; ++k)
+      {
+      dist += (q[k] - p[k])*(q[k] - p[k])*s[k]*s[k];
+      }
+    if (f < 0 || f >= n || ptr[f] != 0 || fabs(dist - best) > 1e-9*best)
+      {
+      cerr << "Feature at " << i << " is " << f << ", which is not a "
+           << "nearest zero voxel" << endl;
+      return 1;
+      }
+    }
+
+  return 0;
+}
+
+int ImageEuclideanDistance(int, char *[])
+{
+  static const int volume[3] = { 31, 24, 17 };
+  static const int slices[3] = { 40, 33, 3 };
+
+  int rval = 0;
+  rval |= TestDistance(volume, 3, true);
+  rval |= TestDistance(volume, 3, false);
+  rval |= TestDistance(slices, 2, true);
+  return rval;
+}
@@ -0,0 +1,153 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    ImageFFT.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test of vtkImageFFT and vtkImageRFFT
+// .SECTION Description
+// Compares vtkImageFFTPlan with a direct evaluation of the DFT for many
+// lengths, including prime lengths that use Bluestein's algorithm, and
+// checks that vtkImageRFFT undoes vtkImageFFT for an image whose sizes
+// are not powers of two.
+
+#include "vtkImageData.h"
+#include "vtkImageFFT.h"
+#include "vtkImageFFTPlan.h"
+#include "vtkImageRFFT.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+
+#include <math.h>
+#include <vector>
+
+static double TestFFTPlan(int n, int fb)
+{
+  std::vector<vtkImageComplex> data(2*n);
+  for (int line = 0; line < 2; ++line)
+    {
+    for (int k = 0; k < n; ++k)
+      {
+      data[line*n + k].Real = sin(0.37*k*(line + 1)) + 0.1*(k % 5);
+      data[line*n + k].Imag = cos(1.3*k) - 0.05*line;
+      }
+    }
+  std::vector<vtkImageComplex> expected(2*n);
+  for (int line = 0; line < 2; ++line)
+    {
+    for (int p = 0; p < n; ++p)
+      {
+      double re = 0.0;
+      double im = 0.0;
+      for (int k = 0; k < n; ++k)
+        {
+        vtkTypeInt64 pk = (static_cast<vtkTypeInt64>(p)*k) % n;
+        double a = -2.0*vtkMath::Pi()*fb*pk/n;
+        const vtkImageComplex &x = data[line*n + k];
+        re += x.Real*cos(a) - x.Imag*sin(a);
+        im += x.Real*sin(a) + x.Imag*cos(a);
+        }
+      if (fb == -1)
+        {
+        re /= n;
+        im /= n;
+        }
+      expected[line*n + p].Real = re;
+      expected[line*n + p].Imag = im;
+      }
+    }
+
+  vtkImageFFTPlan plan;
+  plan.Initialize(n, fb);
+  std::vector<vtkImageComplex> work(plan.GetWorkSize() + 1);
+  plan.Execute(&data[0], 2, &work[0]);
+
+  double maxError = 0.0;
+  for (int i = 0; i < 2*n; ++i)
+    {
+    double e = fabs(data[i].Real - expected[i].Real) +
+               fabs(data[i].Imag - expected[i].Imag);
+    maxError = (e > maxError ? e : maxError);
+    }
+  return maxError;
+}
+
+int ImageFFT(int, char *[])
+{
+  static const int sizes[] = { 1, 2, 3, 5, 8, 12, 16, 30, 49, 64, 97, 100,
+                               128, 210, 251, 256, 1000 };
+  for (size_t i = 0; i < sizeof(sizes)/sizeof(sizes[0]); ++i)
+    {
+    for (int fb = 1; fb >= -1; fb -= 2)
+      {
+      double error = TestFFTPlan(sizes[i], fb);
+      if (error > 1e-9*sizes[i])
+        {
+        cerr << "FFT of size " << sizes[i] << " direction " << fb
+             << " has error " << error << endl;
+        return 1;
+        }
+      }
+    }
+
+  vtkNew<vtkImageData> image;
+  image->SetExtent(0, 23, 0, 9, 0, 6);
+  image->AllocateScalars(VTK_SHORT, 1);
+  short *ptr = static_cast<short *>(image->GetScalarPointer());
+  for (int k = 0; k < 7; ++k)
+    {
+    for (int j = 0; j < 10; ++j)
+      {
+      for (int i = 0; i < 24; ++i)
+        {
+        *ptr++ = static_cast<short>((i*7 + j*j*3 + k*11) % 23 - 5);
+        }
+      }
+    }
+
+  vtkNew<vtkImageFFT> fft;
+  fft->SetInputData(image.GetPointer());
+  fft->SetNumberOfThreads(3);
+  vtkNew<vtkImageRFFT> rfft;
+  rfft->SetInputConnection(fft->GetOutputPort());
+  rfft->SetNumberOfThreads(3);
+  rfft->Update();
+
+  // The DC term is the sum of all values.
+  double sum = 0.0;
+  ptr = static_cast<short *>(image->GetScalarPointer());
+  for (int i = 0; i < 24*10*7; ++i)
+    {
+    sum += ptr[i];
+    }
+  double *dc = static_cast<double *>(fft->GetOutput()->GetScalarPointer());
+  if (fabs(dc[0] - sum) > 1e-9*fabs(sum) + 1e-9 || fabs(dc[1]) > 1e-9)
+    {
+    cerr << "The DC term is " << dc[0] << ", " << dc[1]
+         << " instead of " << sum << endl;
+    return 1;
+    }
+
+  double *result =
+    static_cast<double *>(rfft->GetOutput()->GetScalarPointer());
+  for (int i = 0; i < 24*10*7; ++i)
+    {
+    if (fabs(result[2*i] - ptr[i]) > 1e-9 || fabs(result[2*i + 1]) > 1e-9)
+      {
+      cerr << "The inverse transform differs at " << i << ": "
+           << result[2*i] << ", " << result[2*i + 1] << " instead of "
+           << ptr[i] << endl;
+      return 1;
+      }
+    }
+
+  return 0;
+}
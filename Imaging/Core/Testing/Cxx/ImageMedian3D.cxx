@@ -0,0 +1,116 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    ImageMedian3D.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test of the histogram algorithm of vtkImageMedian3D
+// .SECTION Description
+// Compares the output of the histogram algorithm with a median computed
+// by sorting, for integer data (histograms) as well as for data with a
+// wide range and for floating point data (selection), with two components
+// and with neighborhoods that are clipped by the image boundaries.
+
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkImageMedian3D.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+
+#include <algorithm>
+#include <vector>
+
+static int TestMedian(int scalarType, double scale, double offset)
+{
+  const int dims[3] = { 23, 17, 9 };
+  const int kernel[3] = { 5, 3, 4 };
+  const int numComp = 2;
+
+  vtkNew<vtkImageData> image;
+  image->SetExtent(-3, dims[0] - 4, 0, dims[1] - 1, 2, dims[2] + 1);
+  image->AllocateScalars(scalarType, numComp);
+  vtkDataArray *scalars = image->GetPointData()->GetScalars();
+  vtkIdType n = scalars->GetNumberOfTuples();
+  for (vtkIdType i = 0; i < n; ++i)
+    {
+    for (int c = 0; c < numComp; ++c)
+      {
+      double v = ((i*37 + c*11 + (i*i) % 101) % 61)*scale + offset;
+      scalars->SetComponent(i, c, v);
+      }
+    }
+
+  vtkNew<vtkImageMedian3D> median;
+  median->SetInputData(image.GetPointer());
+  median->SetKernelSize(kernel[0], kernel[1], kernel[2]);
+  median->SetAlgorithmToHistogram();
+  median->SetNumberOfThreads(4);
+  median->Update();
+  vtkDataArray *output =
+    median->GetOutput()->GetPointData()->GetScalars();
+
+  std::vector<double> values;
+  for (int k = 0; k < dims[2]; ++k)
+    {
+    for (int j = 0; j < dims[1]; ++j)
+      {
+      for (int i = 0; i < dims[0]; ++i)
+        {
+        for (int c = 0; c < numComp; ++c)
+          {
+          values.clear();
+          for (int kk = k - kernel[2]/2; kk < k - kernel[2]/2 + kernel[2];
+               ++kk)
+            {
+            for (int jj = j - kernel[1]/2; jj < j - kernel[1]/2 + kernel[1];
+                 ++jj)
+              {
+              for (int ii = i - kernel[0]/2;
+                   ii < i - kernel[0]/2 + kernel[0]; ++ii)
+                {
+                if (ii >= 0 && ii < dims[0] && jj >= 0 && jj < dims[1] &&
+                    kk >= 0 && kk < dims[2])
+                  {
+                  values.push_back(scalars->GetComponent(
+                    (kk*dims[1] + jj)*dims[0] + ii, c));
+                  }
+                }
+              }
+            }
+          std::sort(values.begin(), values.end());
+          double expected = values[values.size()/2];
+          double result =
+            output->GetComponent((k*dims[1] + j)*dims[0] + i, c);
+          if (result != expected)
+            {
+            cerr << "Type " << scalarType << ": median at " << i << ", "
+                 << j << ", " << k << " is " << result << " instead of "
+                 << expected << endl;
+            return 1;
+            }
+          }
+        }
+      }
+    }
+
+  return 0;
+}
+
+int ImageMedian3D(int, char *[])
+{
+  int rval = 0;
+  rval |= TestMedian(VTK_UNSIGNED_CHAR, 4.0, 0.0);
+  rval |= TestMedian(VTK_SHORT, 97.0, -1024.0);
+  rval |= TestMedian(VTK_INT, 100000.0, -1000000.0);
+  rval |= TestMedian(VTK_FLOAT, 0.25, -3.0);
+  rval |= TestMedian(VTK_DOUBLE, 1.5, 10.0);
+  return rval;
+}
@@ -0,0 +1,286 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    ImageResliceOblique.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test and benchmark of the line interpolation kernels
+// .SECTION Description
+// Compares vtkImageInterpolator::InterpolateLineIJK with sampling one point
+// at a time via InterpolateIJK along oblique lines within the bounds of the
+// image, for every interpolation mode, border mode and several data types,
+// and reports the time taken by each.  Then checks that vtkImageReslice
+// gives the same result for an oblique matrix with an interpolator that
+// uses the line kernels as with one that samples one point at a time.
+// The line kernels compute the sample positions, the floors and the
+// weights with the same arithmetic as the per-point functions, so the
+// results must match exactly.
+
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkImageInterpolator.h"
+#include "vtkImageReslice.h"
+#include "vtkMatrix4x4.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkTimerLog.h"
+#include "vtkTransform.h"
+
+#include <math.h>
+#include <string>
+#include <vector>
+
+static const int LINE_LENGTH = 400;
+static const int LINE_START = -20;
+static const int NUMBER_OF_LINES = 400;
+
+// An interpolator without line kernels, which samples lines one point at
+// a time.
+class vtkPointImageInterpolator : public vtkImageInterpolator
+{
+public:
+  static vtkPointImageInterpolator *New();
+  vtkTypeMacro(vtkPointImageInterpolator, vtkImageInterpolator);
+
+protected:
+  virtual void GetLineInterpolationFunc(
+    void (**)(vtkInterpolationInfo *, const double [3], const double [3],
+              int, double *, int)) {}
+  virtual void GetLineInterpolationFunc(
+    void (**)(vtkInterpolationInfo *, const float [3], const float [3],
+              int, float *, int)) {}
+};
+
+vtkStandardNewMacro(vtkPointImageInterpolator);
+
+// Fill an image with a smooth pattern plus some noise.
+static void FillImage(vtkImageData *image, int scalarType, int numComp)
+{
+  image->SetExtent(0, 63, 0, 47, 0, 39);
+  image->AllocateScalars(scalarType, numComp);
+  vtkDataArray *scalars = image->GetPointData()->GetScalars();
+  vtkIdType n = scalars->GetNumberOfTuples();
+  for (vtkIdType i = 0; i < n; ++i)
+    {
+    for (int c = 0; c < numComp; ++c)
+      {
+      double v = 60.0 + 50.0*sin(0.11*(i % 64) + 0.7*c)*cos(0.05*(i/64)) +
+        (i*7919 + c*31) % 17;
+      scalars->SetComponent(i, c, v);
+      }
+    }
+}
+
+// Get the starting point of an oblique line through the image.  Every
+// sample of the lines lies within the extent, as InterpolateLineIJK needs.
+static void LinePoint(int line, double point[3])
+{
+  point[0] = 3.2 + 0.0007*line;
+  point[1] = 0.5 + 0.0951*line;
+  point[2] = 5.0 + 0.0843*line;
+}
+
+template<class F>
+static int TestLines(vtkImageInterpolator *interpolator,
+                     const char *name, bool report)
+{
+  int numComp = interpolator->GetNumberOfComponents();
+  std::vector<F> lineValues(LINE_LENGTH*numComp);
+  std::vector<F> pointValues(LINE_LENGTH*numComp);
+  F step[3] = { F(0.157), F(0.0223), F(-0.0131) };
+  vtkNew<vtkTimerLog> timer;
+
+  // compare the line kernels with point-by-point interpolation
+  double pointTime = 0.0;
+  double lineTime = 0.0;
+  for (int line = 0; line < NUMBER_OF_LINES; ++line)
+    {
+    double p[3];
+    LinePoint(line, p);
+    F point[3] = { F(p[0]), F(p[1]), F(p[2]) };
+
+    // the samples are monotonic, so the first and last bound the line
+    for (int k = 0; k < 2; ++k)
+      {
+      int i = LINE_START + k*(LINE_LENGTH - 1);
+      F x[3];
+      x[0] = point[0] + i*step[0];
+      x[1] = point[1] + i*step[1];
+      x[2] = point[2] + i*step[2];
+      if (!interpolator->CheckBoundsIJK(x))
+        {
+        cerr << name << ": line " << line << " leaves the image" << endl;
+        return 1;
+        }
+      }
+
+    timer->StartTimer();
+    interpolator->InterpolateLineIJK(
+      point, step, LINE_START, &lineValues[0], LINE_LENGTH);
+    timer->StopTimer();
+    lineTime += timer->GetElapsedTime();
+
+    timer->StartTimer();
+    F *outPtr = &pointValues[0];
+    for (int i = LINE_START; i < LINE_START + LINE_LENGTH; ++i)
+      {
+      F x[3];
+      x[0] = point[0] + i*step[0];
+      x[1] = point[1] + i*step[1];
+      x[2] = point[2] + i*step[2];
+      interpolator->InterpolateIJK(x, outPtr);
+      outPtr += numComp;
+      }
+    timer->StopTimer();
+    pointTime += timer->GetElapsedTime();
+
+    for (int i = 0; i < LINE_LENGTH*numComp; ++i)
+      {
+      if (lineValues[i] != pointValues[i])
+        {
+        cerr << name << ": line sample " << i << " is " << lineValues[i]
+             << " instead of " << pointValues[i] << endl;
+        return 1;
+        }
+      }
+    }
+
+  if (report)
+    {
+    cout << "<DartMeasurement name=\"" << name << "Point\" "
+         << "type=\"numeric/double\">" << pointTime << "</DartMeasurement>\n"
+         << "<DartMeasurement name=\"" << name << "Line\" "
+         << "type=\"numeric/double\">" << lineTime << "</DartMeasurement>"
+         << endl;
+    }
+
+  return 0;
+}
+
+// Reslice an image with an oblique matrix through the given interpolator.
+static vtkDataArray *Reslice(vtkImageReslice *reslice, vtkImageData *image,
+                             vtkImageInterpolator *interpolator, int mode)
+{
+  vtkNew<vtkTransform> transform;
+  transform->Translate(20.0, 30.0, 25.0);
+  transform->RotateWXYZ(37.0, 0.3, 0.5, 0.8);
+  transform->Translate(-20.0, -30.0, -25.0);
+
+  interpolator->SetInterpolationMode(mode);
+  reslice->SetInputData(image);
+  reslice->SetInterpolator(interpolator);
+  reslice->SetResliceAxes(transform->GetMatrix());
+  reslice->SetOutputScalarType(VTK_DOUBLE);
+  reslice->SetBackgroundLevel(-1000.0);
+  reslice->SetOutputExtent(0, 59, 0, 44, 0, 35);
+  reslice->SetOutputSpacing(1.0, 1.0, 1.0);
+  reslice->SetOutputOrigin(-3.0, 4.0, 3.0);
+  reslice->SetNumberOfThreads(2);
+  reslice->Update();
+  return reslice->GetOutput()->GetPointData()->GetScalars();
+}
+
+static int TestReslice(int scalarType, int mode)
+{
+  vtkNew<vtkImageData> image;
+  FillImage(image.GetPointer(), scalarType, 1);
+  image->SetSpacing(0.9, 1.1, 1.3);
+  image->SetOrigin(-5.0, 3.0, 2.0);
+
+  // the output extent covers both samples inside and outside the image
+  vtkNew<vtkImageInterpolator> lineInterpolator;
+  vtkNew<vtkImageReslice> lineReslice;
+  vtkDataArray *a = Reslice(lineReslice.GetPointer(), image.GetPointer(),
+                            lineInterpolator.GetPointer(), mode);
+  vtkNew<vtkPointImageInterpolator> pointInterpolator;
+  vtkNew<vtkImageReslice> pointReslice;
+  vtkDataArray *b = Reslice(pointReslice.GetPointer(), image.GetPointer(),
+                            pointInterpolator.GetPointer(), mode);
+
+  vtkIdType n = a->GetNumberOfTuples();
+  if (n != b->GetNumberOfTuples())
+    {
+    cerr << "Reslice outputs have different sizes" << endl;
+    return 1;
+    }
+  vtkIdType inside = 0;
+  for (vtkIdType i = 0; i < n; ++i)
+    {
+    if (a->GetComponent(i, 0) != b->GetComponent(i, 0))
+      {
+      cerr << "Reslice with mode " << mode << " and type " << scalarType
+           << " gives " << a->GetComponent(i, 0) << " instead of "
+           << b->GetComponent(i, 0) << " at sample " << i << endl;
+      return 1;
+      }
+    inside += (a->GetComponent(i, 0) != -1000.0);
+    }
+  if (inside == 0 || inside == n)
+    {
+    cerr << "Reslice output is not partly inside the image" << endl;
+    return 1;
+    }
+
+  return 0;
+}
+
+int ImageResliceOblique(int, char *[])
+{
+  static const int types[4] = {
+    VTK_UNSIGNED_CHAR, VTK_SHORT, VTK_FLOAT, VTK_DOUBLE };
+  static const char *typeNames[4] = { "UChar", "Short", "Float", "Double" };
+  static const int modes[3] = {
+    VTK_NEAREST_INTERPOLATION, VTK_LINEAR_INTERPOLATION,
+    VTK_CUBIC_INTERPOLATION };
+  static const char *modeNames[3] = { "Nearest", "Linear", "Cubic" };
+  static const int borders[3] = {
+    VTK_IMAGE_BORDER_CLAMP, VTK_IMAGE_BORDER_REPEAT,
+    VTK_IMAGE_BORDER_MIRROR };
+
+  int rval = 0;
+  for (int t = 0; t < 4; ++t)
+    {
+    for (int numComp = 1; numComp <= 3; numComp += 2)
+      {
+      vtkNew<vtkImageData> image;
+      FillImage(image.GetPointer(), types[t], numComp);
+      for (int m = 0; m < 3; ++m)
+        {
+        for (int b = 0; b < 3; ++b)
+          {
+          vtkNew<vtkImageInterpolator> interpolator;
+          interpolator->SetInterpolationMode(modes[m]);
+          interpolator->SetBorderMode(borders[b]);
+          interpolator->Initialize(image.GetPointer());
+          interpolator->Update();
+
+          std::string name = std::string(modeNames[m]) + typeNames[t];
+          bool report = (numComp == 1 && b == 0);
+          rval |= TestLines<double>(interpolator.GetPointer(),
+                                    name.c_str(), report);
+          rval |= TestLines<float>(interpolator.GetPointer(),
+                                   (name + "Float").c_str(), report);
+          }
+        }
+      }
+    }
+
+  for (int t = 0; t < 4; ++t)
+    {
+    for (int m = 0; m < 3; ++m)
+      {
+      rval |= TestReslice(types[t], modes[m]);
+      }
+    }
+
+  return rval;
+}
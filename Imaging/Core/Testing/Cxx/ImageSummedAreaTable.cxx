@@ -0,0 +1,287 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    ImageSummedAreaTable.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test of vtkImageSummedAreaTable and the box statistics filters
+// .SECTION Description
+// Compares the tables of vtkImageSummedAreaTable, for the whole image and
+// for a piece, in 2D and 3D, with sums computed by brute force, and does
+// the same for vtkImageBoxMean3D and for the BoxKernel option of
+// vtkImageVariance3D and vtkImageRange3D, also for values with a large
+// offset.  Also reports the time taken by the box mean with a small and
+// with a large kernel.
+
+#include "vtkDataArray.h"
+#include "vtkImageBoxMean3D.h"
+#include "vtkImageData.h"
+#include "vtkImageRange3D.h"
+#include "vtkImageSummedAreaTable.h"
+#include "vtkImageVariance3D.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkTimerLog.h"
+
+#include <math.h>
+
+static void FillImage(vtkImageData *image, int scalarType, int numComp,
+                      double offset = 0.0)
+{
+  image->SetExtent(-2, 25, 1, 19, -3, 9);
+  image->AllocateScalars(scalarType, numComp);
+  vtkDataArray *scalars = image->GetPointData()->GetScalars();
+  vtkIdType n = scalars->GetNumberOfTuples();
+  for (vtkIdType i = 0; i < n; ++i)
+    {
+    for (int c = 0; c < numComp; ++c)
+      {
+      int v = static_cast<int>((i*7919 + c*104729 + (i*i) % 1013) % 97);
+      scalars->SetComponent(
+        i, c, v - (scalarType == VTK_UNSIGNED_CHAR ? 0 : 40) + offset);
+      }
+    }
+}
+
+// The sum over a box by brute force, of the values or of their squares.
+static double BoxSum(vtkImageData *image, const int box[6], int c,
+                     bool squares)
+{
+  double sum = 0.0;
+  for (int k = box[4]; k <= box[5]; ++k)
+    {
+    for (int j = box[2]; j <= box[3]; ++j)
+      {
+      for (int i = box[0]; i <= box[1]; ++i)
+        {
+        double v = image->GetScalarComponentAsDouble(i, j, k, c);
+        sum += (squares ? v*v : v);
+        }
+      }
+    }
+  return sum;
+}
+
+static int TestTable(int dimensionality)
+{
+  vtkNew<vtkImageData> image;
+  FillImage(image.GetPointer(), VTK_SHORT, 2);
+  int *ext = image->GetExtent();
+
+  vtkNew<vtkImageSummedAreaTable> table;
+  table->SetInputData(image.GetPointer());
+  table->SetDimensionality(dimensionality);
+  table->ComputeSquaredSumsOn();
+  table->Update();
+
+  // a piece needs the input from the start of the whole extent
+  vtkNew<vtkImageSummedAreaTable> pieceTable;
+  pieceTable->SetInputData(image.GetPointer());
+  pieceTable->SetDimensionality(dimensionality);
+  int pieceExt[6] = { 3, 17, 4, 9, 2, 7 };
+  pieceTable->UpdateInformation();
+  pieceTable->SetUpdateExtent(pieceExt);
+  pieceTable->Update();
+
+  vtkImageData *outputs[2] = { table->GetOutput(), pieceTable->GetOutput() };
+  const int *extents[2] = { ext, pieceExt };
+  for (int t = 0; t < 2; ++t)
+    {
+    vtkImageData *output = outputs[t];
+    const int *outExt = extents[t];
+    vtkDataArray *squares = output->GetPointData()->GetArray("SquaredSums");
+    if (output->GetScalarType() != VTK_DOUBLE || (t == 0 && !squares))
+      {
+      cerr << "The table has the wrong type or no squared sums" << endl;
+      return 1;
+      }
+    for (int k = outExt[4]; k <= outExt[5]; ++k)
+      {
+      for (int j = outExt[2]; j <= outExt[3]; ++j)
+        {
+        for (int i = outExt[0]; i <= outExt[1]; ++i)
+          {
+          int box[6] = { ext[0], i, ext[2], j, ext[4], k };
+          if (dimensionality == 2)
+            {
+            box[4] = k;
+            }
+          for (int c = 0; c < 2; ++c)
+            {
+            double sum = BoxSum(image.GetPointer(), box, c, false);
+            double result = output->GetScalarComponentAsDouble(i, j, k, c);
+            double sqrSum = BoxSum(image.GetPointer(), box, c, true);
+            double sqrResult = sqrSum;
+            if (squares)
+              {
+              int ijk[3] = { i, j, k };
+              sqrResult = squares->GetComponent(
+                output->ComputePointId(ijk), c);
+              }
+            if (result != sum || sqrResult != sqrSum)
+              {
+              cerr << "Table of dimensionality " << dimensionality
+                   << " at " << i << ", " << j << ", " << k << " is "
+                   << result << ", " << sqrResult << " instead of " << sum
+                   << ", " << sqrSum << endl;
+              return 1;
+              }
+            }
+          }
+        }
+      }
+    }
+
+  return 0;
+}
+
+// Compare the box filters with brute force for one kernel size.  The
+// values are exact in the input for the offsets used, but the mean is
+// rounded to float in the output, relative to the offset.
+static int TestBoxFilters(int scalarType, const int size[3], int numThreads,
+                          double offset = 0.0)
+{
+  vtkNew<vtkImageData> image;
+  FillImage(image.GetPointer(), scalarType, 2, offset);
+  int *ext = image->GetExtent();
+
+  vtkNew<vtkImageBoxMean3D> mean;
+  mean->SetInputData(image.GetPointer());
+  mean->SetKernelSize(size[0], size[1], size[2]);
+  mean->SetNumberOfThreads(numThreads);
+  mean->Update();
+
+  vtkNew<vtkImageVariance3D> variance;
+  variance->SetInputData(image.GetPointer());
+  variance->SetKernelSize(size[0], size[1], size[2]);
+  variance->BoxKernelOn();
+  variance->SetNumberOfThreads(numThreads);
+  variance->Update();
+
+  vtkNew<vtkImageRange3D> range;
+  range->SetInputData(image.GetPointer());
+  range->SetKernelSize(size[0], size[1], size[2]);
+  range->BoxKernelOn();
+  range->SetNumberOfThreads(numThreads);
+  range->Update();
+
+  for (int k = ext[4]; k <= ext[5]; ++k)
+    {
+    for (int j = ext[2]; j <= ext[3]; ++j)
+      {
+      for (int i = ext[0]; i <= ext[1]; ++i)
+        {
+        // the box, clipped to the image
+        int p[3] = { i, j, k };
+        int box[6];
+        double count = 1.0;
+        for (int a = 0; a < 3; ++a)
+          {
+          box[2*a] = p[a] - size[a]/2;
+          box[2*a+1] = box[2*a] + size[a] - 1;
+          box[2*a] = (box[2*a] > ext[2*a] ? box[2*a] : ext[2*a]);
+          box[2*a+1] =
+            (box[2*a+1] < ext[2*a+1] ? box[2*a+1] : ext[2*a+1]);
+          count *= box[2*a+1] - box[2*a] + 1;
+          }
+        for (int c = 0; c < 2; ++c)
+          {
+          double center = image->GetScalarComponentAsDouble(i, j, k, c);
+          double expectedMean = 0.0;
+          double expectedVariance = 0.0;
+          double expectedMin = center;
+          double expectedMax = center;
+          for (int kk = box[4]; kk <= box[5]; ++kk)
+            {
+            for (int jj = box[2]; jj <= box[3]; ++jj)
+              {
+              for (int ii = box[0]; ii <= box[1]; ++ii)
+                {
+                double v = image->GetScalarComponentAsDouble(ii, jj, kk, c);
+                expectedMean += v;
+                expectedVariance += (v - center)*(v - center);
+                expectedMin = (v < expectedMin ? v : expectedMin);
+                expectedMax = (v > expectedMax ? v : expectedMax);
+                }
+              }
+            }
+          expectedMean /= count;
+          expectedVariance /= count;
+
+          double m =
+            mean->GetOutput()->GetScalarComponentAsDouble(i, j, k, c);
+          double v =
+            variance->GetOutput()->GetScalarComponentAsDouble(i, j, k, c);
+          double r =
+            range->GetOutput()->GetScalarComponentAsDouble(i, j, k, c);
+          if (fabs(m - expectedMean) > 1e-4 + 1e-7*fabs(offset) ||
+              fabs(v - expectedVariance) > 1e-5*(1.0 + expectedVariance) ||
+              r != expectedMax - expectedMin)
+            {
+            cerr << "Kernel " << size[0] << "x" << size[1] << "x" << size[2]
+                 << ": mean, variance and range at " << i << ", " << j
+                 << ", " << k << " are " << m << ", " << v << ", " << r
+                 << " instead of " << expectedMean << ", "
+                 << expectedVariance << ", " << expectedMax - expectedMin
+                 << endl;
+            return 1;
+            }
+          }
+        }
+      }
+    }
+
+  return 0;
+}
+
+int ImageSummedAreaTable(int, char *[])
+{
+  static const int sizes[4][3] = {
+    { 3, 3, 3 }, { 4, 1, 5 }, { 1, 6, 2 }, { 41, 5, 31 } };
+  static const int types[2] = { VTK_UNSIGNED_CHAR, VTK_FLOAT };
+
+  int rval = 0;
+  rval |= TestTable(3);
+  rval |= TestTable(2);
+  for (int s = 0; s < 4; ++s)
+    {
+    rval |= TestBoxFilters(types[s % 2], sizes[s], 1 + s);
+    }
+
+  // the variance of large values must not lose the small differences
+  rval |= TestBoxFilters(VTK_FLOAT, sizes[0], 2, 1.0e6);
+  rval |= TestBoxFilters(VTK_DOUBLE, sizes[3], 2, 1.0e9);
+
+  // time the box mean with a small and a large kernel
+  vtkNew<vtkImageData> image;
+  image->SetExtent(0, 127, 0, 127, 0, 63);
+  image->AllocateScalars(VTK_SHORT, 1);
+  vtkNew<vtkImageBoxMean3D> mean;
+  mean->SetInputData(image.GetPointer());
+  vtkNew<vtkTimerLog> timer;
+  double times[2];
+  for (int t = 0; t < 2; ++t)
+    {
+    int size = (t == 0 ? 3 : 31);
+    mean->SetKernelSize(size, size, size);
+    timer->StartTimer();
+    mean->Update();
+    timer->StopTimer();
+    times[t] = timer->GetElapsedTime();
+    }
+  cout << "<DartMeasurement name=\"BoxMean3\" "
+       << "type=\"numeric/double\">" << times[0] << "</DartMeasurement>\n"
+       << "<DartMeasurement name=\"BoxMean31\" "
+       << "type=\"numeric/double\">" << times[1] << "</DartMeasurement>"
+       << endl;
+
+  return rval;
+}
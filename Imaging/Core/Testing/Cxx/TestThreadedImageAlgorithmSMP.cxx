@@ -0,0 +1,205 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestThreadedImageAlgorithmSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test of the SMP mode of vtkThreadedImageAlgorithm
+// .SECTION Description
+// Checks that every split mode covers an extent exactly once, and that
+// executing a filter through vtkSMPTools with many small pieces gives the
+// same output as executing it with vtkMultiThreader. vtkImageDifference,
+// which keeps its errors per thread, must never execute through SMP.
+
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkImageDifference.h"
+#include "vtkImageReslice.h"
+#include "vtkImageShiftScale.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTransform.h"
+
+#include <vector>
+
+static int TestSplitMode(vtkThreadedImageAlgorithm *filter, int mode)
+{
+  int extent[6] = { 2, 40, -3, 17, 0, 9 };
+  int dims[3] = { 39, 21, 10 };
+  filter->SetSplitMode(mode);
+
+  for (int total = 1; total <= 200; total += 7)
+    {
+    std::vector<int> hits(dims[0]*dims[1]*dims[2], 0);
+    int splitExt[6];
+    int count = filter->SplitExtent(splitExt, extent, 0, total);
+    if (count < 1 || count > total)
+      {
+      cerr << "Mode " << mode << " made " << count << " pieces for "
+           << total << endl;
+      return 1;
+      }
+    for (int piece = 0; piece < count; ++piece)
+      {
+      filter->SplitExtent(splitExt, extent, piece, total);
+      for (int k = splitExt[4]; k <= splitExt[5]; ++k)
+        {
+        for (int j = splitExt[2]; j <= splitExt[3]; ++j)
+          {
+          for (int i = splitExt[0]; i <= splitExt[1]; ++i)
+            {
+            hits[((k - extent[4])*dims[1] + (j - extent[2]))*dims[0] +
+                 (i - extent[0])]++;
+            }
+          }
+        }
+      if (mode == vtkThreadedImageAlgorithm::BEAM &&
+          (splitExt[0] != extent[0] || splitExt[1] != extent[1]))
+        {
+        cerr << "A beam does not contain whole rows" << endl;
+        return 1;
+        }
+      }
+    for (size_t i = 0; i < hits.size(); ++i)
+      {
+      if (hits[i] != 1)
+        {
+        cerr << "Mode " << mode << " covers a voxel " << hits[i]
+             << " times with " << total << " pieces" << endl;
+        return 1;
+        }
+      }
+    }
+  return 0;
+}
+
+static int CompareOutputs(vtkImageData *a, vtkImageData *b)
+{
+  vtkDataArray *x = a->GetPointData()->GetScalars();
+  vtkDataArray *y = b->GetPointData()->GetScalars();
+  if (!x || !y || x->GetNumberOfTuples() != y->GetNumberOfTuples() ||
+      x->GetNumberOfComponents() != y->GetNumberOfComponents())
+    {
+    return 1;
+    }
+  vtkIdType n = x->GetNumberOfTuples()*x->GetNumberOfComponents();
+  for (vtkIdType i = 0; i < n; ++i)
+    {
+    if (x->GetComponent(i, 0) != y->GetComponent(i, 0))
+      {
+      return 1;
+      }
+    }
+  return 0;
+}
+
+int TestThreadedImageAlgorithmSMP(int, char *[])
+{
+  vtkNew<vtkImageShiftScale> shiftScale;
+  for (int mode = vtkThreadedImageAlgorithm::SLAB;
+       mode <= vtkThreadedImageAlgorithm::BLOCK; ++mode)
+    {
+    if (TestSplitMode(shiftScale.GetPointer(), mode))
+      {
+      return 1;
+      }
+    }
+
+  vtkNew<vtkImageData> image;
+  image->SetExtent(0, 63, 0, 47, 0, 15);
+  image->AllocateScalars(VTK_FLOAT, 1);
+  float *ptr = static_cast<float *>(image->GetScalarPointer());
+  for (int k = 0; k < 16; ++k)
+    {
+    for (int j = 0; j < 48; ++j)
+      {
+      for (int i = 0; i < 64; ++i)
+        {
+        *ptr++ = static_cast<float>((i*j) % 17 + k);
+        }
+      }
+    }
+
+  vtkNew<vtkTransform> transform;
+  transform->RotateZ(25.0);
+  transform->RotateX(10.0);
+
+  vtkNew<vtkImageReslice> reference;
+  reference->SetInputData(image.GetPointer());
+  reference->SetResliceTransform(transform.GetPointer());
+  reference->SetInterpolationModeToCubic();
+  reference->SetOutputExtent(-8, 71, -4, 51, 0, 15);
+  reference->EnableSMPOff();
+  reference->Update();
+
+  for (int mode = vtkThreadedImageAlgorithm::SLAB;
+       mode <= vtkThreadedImageAlgorithm::BLOCK; ++mode)
+    {
+    vtkNew<vtkImageReslice> reslice;
+    reslice->SetInputData(image.GetPointer());
+    reslice->SetResliceTransform(transform.GetPointer());
+    reslice->SetInterpolationModeToCubic();
+    reslice->SetOutputExtent(-8, 71, -4, 51, 0, 15);
+    reslice->EnableSMPOn();
+    reslice->SetSplitMode(mode);
+    reslice->SetDesiredBytesPerPiece(1024);
+    reslice->Update();
+    if (CompareOutputs(reference->GetOutput(), reslice->GetOutput()))
+      {
+      cerr << "SMP output differs in split mode " << mode << endl;
+      return 1;
+      }
+    }
+
+  // The global default applies to filters created afterwards.
+  vtkThreadedImageAlgorithm::SetGlobalDefaultEnableSMP(true);
+  vtkSmartPointer<vtkImageShiftScale> smpFilter =
+    vtkSmartPointer<vtkImageShiftScale>::New();
+  vtkThreadedImageAlgorithm::SetGlobalDefaultEnableSMP(false);
+  if (!smpFilter->GetEnableSMP() || shiftScale->GetEnableSMP())
+    {
+    cerr << "The global default of EnableSMP was not applied" << endl;
+    return 1;
+    }
+
+  vtkThreadedImageAlgorithm::SetGlobalDefaultEnableSMP(true);
+  vtkSmartPointer<vtkImageDifference> difference =
+    vtkSmartPointer<vtkImageDifference>::New();
+  vtkThreadedImageAlgorithm::SetGlobalDefaultEnableSMP(false);
+  difference->EnableSMPOn();
+  if (difference->GetEnableSMP())
+    {
+    cerr << "vtkImageDifference accepted EnableSMP" << endl;
+    return 1;
+    }
+  vtkNew<vtkImageData> rgb;
+  rgb->SetExtent(0, 63, 0, 47, 0, 0);
+  rgb->AllocateScalars(VTK_UNSIGNED_CHAR, 3);
+  unsigned char *rgbPtr =
+    static_cast<unsigned char *>(rgb->GetScalarPointer());
+  for (int i = 0; i < 64*48*3; ++i)
+    {
+    rgbPtr[i] = static_cast<unsigned char>((i*i) % 251);
+    }
+  difference->SetInputData(rgb.GetPointer());
+  difference->SetImageData(rgb.GetPointer());
+  difference->SetNumberOfThreads(4);
+  difference->Update();
+  if (difference->GetError() != 0.0)
+    {
+    cerr << "vtkImageDifference found an error of "
+         << difference->GetError() << " between identical images" << endl;
+    return 1;
+    }
+
+  return 0;
+}
@@ -18,6 +18,7 @@ vtk_module(vtkImagingCore
     vtkInteractionImage
     vtkImagingMath # Move tests
     vtkImagingStencil # Move tests
+    vtkImagingFourier # Move tests
     vtkImagingGeneral # Move tests
     vtkImagingSources
     vtkImagingStatistics # Move tests
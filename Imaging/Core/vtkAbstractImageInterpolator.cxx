@@ -48,6 +48,28 @@ void vtkInterpolateNOP<F>::RowInterpolationFunc(
 {
 }
 
+//----------------------------------------------------------------------------
+// sample a line one point at a time, for interpolators that do not
+// provide a line interpolation function
+template<class F>
+void vtkInterpolateLineByPoint(
+  void (*interpolate)(vtkInterpolationInfo *, const F [3], F *),
+  vtkInterpolationInfo *info, const F point[3], const F step[3], int idX,
+  F *outPtr, int n)
+{
+  int numscalars = info->NumberOfComponents;
+  for (int i = 0; i < n; i++)
+    {
+    int idx = idX + i;
+    F p[3];
+    p[0] = point[0] + idx*step[0];
+    p[1] = point[1] + idx*step[1];
+    p[2] = point[2] + idx*step[2];
+    interpolate(info, p, outPtr);
+    outPtr += numscalars;
+    }
+}
+
 } // end anonymous namespace
 
 //----------------------------------------------------------------------------
@@ -89,6 +111,8 @@ vtkAbstractImageInterpolator::vtkAbstractImageInterpolator()
     &(vtkInterpolateNOP<double>::RowInterpolationFunc);
   this->RowInterpolationFuncFloat =
     &(vtkInterpolateNOP<float>::RowInterpolationFunc);
+  this->LineInterpolationFuncDouble = NULL;
+  this->LineInterpolationFuncFloat = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -302,6 +326,8 @@ void vtkAbstractImageInterpolator::Update()
       &(vtkInterpolateNOP<double>::RowInterpolationFunc);
     this->RowInterpolationFuncFloat =
       &(vtkInterpolateNOP<float>::RowInterpolationFunc);
+    this->LineInterpolationFuncDouble = NULL;
+    this->LineInterpolationFuncFloat = NULL;
 
     return;
     }
@@ -379,6 +405,42 @@ void vtkAbstractImageInterpolator::Update()
   this->GetInterpolationFunc(&this->InterpolationFuncFloat);
   this->GetRowInterpolationFunc(&this->RowInterpolationFuncDouble);
   this->GetRowInterpolationFunc(&this->RowInterpolationFuncFloat);
+  this->LineInterpolationFuncDouble = NULL;
+  this->LineInterpolationFuncFloat = NULL;
+  this->GetLineInterpolationFunc(&this->LineInterpolationFuncDouble);
+  this->GetLineInterpolationFunc(&this->LineInterpolationFuncFloat);
+}
+
+//----------------------------------------------------------------------------
+void vtkAbstractImageInterpolator::InterpolateLineIJK(
+  const double point[3], const double step[3], int idX, double *value, int n)
+{
+  if (this->LineInterpolationFuncDouble)
+    {
+    this->LineInterpolationFuncDouble(
+      this->InterpolationInfo, point, step, idX, value, n);
+    }
+  else
+    {
+    vtkInterpolateLineByPoint(this->InterpolationFuncDouble,
+      this->InterpolationInfo, point, step, idX, value, n);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkAbstractImageInterpolator::InterpolateLineIJK(
+  const float point[3], const float step[3], int idX, float *value, int n)
+{
+  if (this->LineInterpolationFuncFloat)
+    {
+    this->LineInterpolationFuncFloat(
+      this->InterpolationInfo, point, step, idX, value, n);
+    }
+  else
+    {
+    vtkInterpolateLineByPoint(this->InterpolationFuncFloat,
+      this->InterpolationInfo, point, step, idX, value, n);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -463,6 +525,20 @@ void vtkAbstractImageInterpolator::GetRowInterpolationFunc(
 {
 }
 
+//----------------------------------------------------------------------------
+void vtkAbstractImageInterpolator::GetLineInterpolationFunc(
+  void (**)(vtkInterpolationInfo *, const double [3], const double [3], int,
+            double *, int))
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkAbstractImageInterpolator::GetLineInterpolationFunc(
+  void (**)(vtkInterpolationInfo *, const float [3], const float [3], int,
+            float *, int))
+{
+}
+
 //----------------------------------------------------------------------------
 void vtkAbstractImageInterpolator::PrecomputeWeightsForExtent(
   const double [16], const int [6], int [6], vtkInterpolationWeights *&)
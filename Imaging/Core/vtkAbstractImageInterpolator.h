@@ -128,6 +128,18 @@ public:
   void InterpolateIJK(const double point[3], double *value);
   void InterpolateIJK(const float point[3], float *value);
 
+  // Description:
+  // Interpolate n samples along a line in structured coords.  The samples
+  // are taken at point + i*step for i = idX, idX + 1, ..., idX + n - 1,
+  // and each sample must be within the bounds checked by CheckBoundsIJK.
+  // This is faster than calling InterpolateIJK for each sample,
+  // since the interpolators can compute the positions and weights for
+  // several samples at once.
+  void InterpolateLineIJK(const double point[3], const double step[3],
+                          int idX, double *value, int n);
+  void InterpolateLineIJK(const float point[3], const float step[3],
+                          int idX, float *value, int n);
+
   // Description:
   // Check an x,y,z point to see if it is within the bounds for the
   // structured coords of the image.  This is meant to be called prior
@@ -245,6 +257,18 @@ protected:
     void (**floatfunc)(
       vtkInterpolationWeights *, int, int, int, float *, int));
 
+  // Description:
+  // Get the line interpolation functions.  Subclasses that do not
+  // provide these will have their lines sampled one point at a time.
+  virtual void GetLineInterpolationFunc(
+    void (**doublefunc)(
+      vtkInterpolationInfo *, const double [3], const double [3], int,
+      double *, int));
+  virtual void GetLineInterpolationFunc(
+    void (**floatfunc)(
+      vtkInterpolationInfo *, const float [3], const float [3], int,
+      float *, int));
+
   vtkDataArray *Scalars;
   double StructuredBoundsDouble[6];
   float StructuredBoundsFloat[6];
@@ -272,6 +296,12 @@ protected:
   void (*RowInterpolationFuncFloat)(
     vtkInterpolationWeights *weights, int idX, int idY, int idZ,
     float *outPtr, int n);
+  void (*LineInterpolationFuncDouble)(
+    vtkInterpolationInfo *info, const double point[3],
+    const double step[3], int idX, double *outPtr, int n);
+  void (*LineInterpolationFuncFloat)(
+    vtkInterpolationInfo *info, const float point[3],
+    const float step[3], int idX, float *outPtr, int n);
 
 private:
 
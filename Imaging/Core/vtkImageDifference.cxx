@@ -35,6 +35,8 @@ vtkImageDifference::vtkImageDifference()
   this->AllowShift = 1;
   this->Averaging = 1;
   this->SetNumberOfInputPorts(2);
+  // See SetEnableSMP(); the global default must not turn SMP on either.
+  this->EnableSMP = false;
 }
 
 
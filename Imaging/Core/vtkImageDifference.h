@@ -90,6 +90,12 @@ public:
   vtkGetMacro(Averaging,int);
   vtkBooleanMacro(Averaging,int);
 
+  // Description:
+  // The errors are accumulated per thread and reset for every piece, so
+  // each thread must execute exactly one piece. This filter therefore
+  // always uses vtkMultiThreader and ignores requests to enable SMP.
+  virtual void SetEnableSMP(bool) {}
+
 protected:
   vtkImageDifference();
   ~vtkImageDifference() {}
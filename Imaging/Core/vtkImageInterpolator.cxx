@@ -510,6 +510,469 @@ void vtkImageInterpolatorGetInterpolationFunc(
     }
 }
 
+//----------------------------------------------------------------------------
+// Interpolation along a line of samples.  The samples are processed in
+// blocks, and for each block the positions, indices and weights are first
+// computed for all of the samples by simple loops that the compiler can
+// vectorize, after which the voxel values are gathered and weighted.
+
+// the number of samples in each block
+#define VTK_INTERPOLATE_LINE_BLOCK 32
+
+template <class F, class T>
+struct vtkImageNLCLineInterpolate
+{
+  static void Nearest(
+    vtkInterpolationInfo *info, const F point[3], const F step[3],
+    int idX, F *outPtr, int n);
+
+  static void Trilinear(
+    vtkInterpolationInfo *info, const F point[3], const F step[3],
+    int idX, F *outPtr, int n);
+
+  static void Tricubic(
+    vtkInterpolationInfo *info, const F point[3], const F step[3],
+    int idX, F *outPtr, int n);
+};
+
+//----------------------------------------------------------------------------
+// Compute an integer-valued bias that makes x + bias positive for all of
+// the samples x0 + i*dx, i = idX ... idX + n - 1.  The samples are
+// monotonic in i, so only the first and the last must be checked.
+template<class F>
+double vtkInterpolateLineBias(F x0, F dx, int idX, int n)
+{
+  F xa = x0 + idX*dx;
+  F xb = x0 + (idX + n - 1)*dx;
+  double lo = (xa < xb ? xa : xb);
+  return 2.0 - vtkMath::Floor(lo);
+}
+
+//----------------------------------------------------------------------------
+// Compute vtkInterpolationMath::Floor for the samples x0 + i*dx of a block.
+// The large constant is added and subtracted to round off the value in the
+// same way as Floor() does, and the bias makes the value positive so that
+// truncation gives the floor.  All of the operations after the first are
+// exact, so the result is identical to that of Floor().
+template<class F>
+void vtkInterpolateLineFloor(
+  F x0, F dx, int idX, int m, double bias, int *ids, F *fs)
+{
+  const double big = 103079215104.0;
+  const double add = big + VTK_INTERPOLATE_FLOOR_TOL;
+  const int ibias = static_cast<int>(bias);
+  for (int i = 0; i < m; i++)
+    {
+    F x = x0 + (idX + i)*dx;
+    double v = ((x + add) - big) + bias;
+    int j = static_cast<int>(v);
+    fs[i] = static_cast<F>(v - j);
+    ids[i] = j - ibias;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Compute vtkInterpolationMath::Round for the samples of a block.
+template<class F>
+void vtkInterpolateLineRound(
+  F x0, F dx, int idX, int m, double bias, int *ids)
+{
+  const double big = 103079215104.0;
+  const double add = big + 0.5 + VTK_INTERPOLATE_FLOOR_TOL;
+  const int ibias = static_cast<int>(bias);
+  for (int i = 0; i < m; i++)
+    {
+    F x = x0 + (idX + i)*dx;
+    double v = ((x + add) - big) + bias;
+    ids[i] = static_cast<int>(v) - ibias;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Apply the border mode to a block of indices, and subtract the minimum.
+inline void vtkInterpolateLineBorder(
+  int *ids, int m, int minX, int maxX, int borderMode)
+{
+  switch (borderMode)
+    {
+    case VTK_IMAGE_BORDER_REPEAT:
+      for (int i = 0; i < m; i++)
+        {
+        ids[i] = vtkInterpolationMath::Wrap(ids[i], minX, maxX);
+        }
+      break;
+
+    case VTK_IMAGE_BORDER_MIRROR:
+      for (int i = 0; i < m; i++)
+        {
+        ids[i] = vtkInterpolationMath::Mirror(ids[i], minX, maxX);
+        }
+      break;
+
+    default:
+      for (int i = 0; i < m; i++)
+        {
+        ids[i] = vtkInterpolationMath::Clamp(ids[i], minX, maxX);
+        }
+      break;
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class F, class T>
+void vtkImageNLCLineInterpolate<F, T>::Nearest(
+  vtkInterpolationInfo *info, const F point[3], const F step[3],
+  int idX, F *outPtr, int n)
+{
+  const T *inPtr = static_cast<const T *>(info->Pointer);
+  int *inExt = info->Extent;
+  vtkIdType *inInc = info->Increments;
+  int numscalars = info->NumberOfComponents;
+  int borderMode = info->BorderMode;
+
+  double bias[3];
+  for (int j = 0; j < 3; j++)
+    {
+    bias[j] = vtkInterpolateLineBias(point[j], step[j], idX, n);
+    }
+
+  int ids[VTK_INTERPOLATE_LINE_BLOCK];
+  vtkIdType offsets[VTK_INTERPOLATE_LINE_BLOCK];
+
+  for (int i0 = 0; i0 < n; i0 += VTK_INTERPOLATE_LINE_BLOCK)
+    {
+    int m = n - i0;
+    m = (m < VTK_INTERPOLATE_LINE_BLOCK ? m : VTK_INTERPOLATE_LINE_BLOCK);
+
+    for (int i = 0; i < m; i++)
+      {
+      offsets[i] = 0;
+      }
+
+    for (int j = 0; j < 3; j++)
+      {
+      vtkInterpolateLineRound(point[j], step[j], idX + i0, m, bias[j], ids);
+      vtkInterpolateLineBorder(ids, m, inExt[2*j], inExt[2*j+1], borderMode);
+      vtkIdType inc = inInc[j];
+      for (int i = 0; i < m; i++)
+        {
+        offsets[i] += ids[i]*inc;
+        }
+      }
+
+    for (int i = 0; i < m; i++)
+      {
+      const T *tmpPtr = inPtr + offsets[i];
+      int c = numscalars;
+      do
+        {
+        *outPtr++ = *tmpPtr++;
+        }
+      while (--c);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class F, class T>
+void vtkImageNLCLineInterpolate<F, T>::Trilinear(
+  vtkInterpolationInfo *info, const F point[3], const F step[3],
+  int idX, F *outPtr, int n)
+{
+  const T *inPtr = static_cast<const T *>(info->Pointer);
+  int *inExt = info->Extent;
+  vtkIdType *inInc = info->Increments;
+  int numscalars = info->NumberOfComponents;
+  int borderMode = info->BorderMode;
+
+  double bias[3];
+  for (int j = 0; j < 3; j++)
+    {
+    bias[j] = vtkInterpolateLineBias(point[j], step[j], idX, n);
+    }
+
+  int ids0[VTK_INTERPOLATE_LINE_BLOCK];
+  int ids1[VTK_INTERPOLATE_LINE_BLOCK];
+  F fs[3][VTK_INTERPOLATE_LINE_BLOCK];
+  vtkIdType fact[3][2][VTK_INTERPOLATE_LINE_BLOCK];
+  vtkIdType offsets[4][VTK_INTERPOLATE_LINE_BLOCK];
+  F w[4][VTK_INTERPOLATE_LINE_BLOCK];
+  T v[8][VTK_INTERPOLATE_LINE_BLOCK];
+
+  for (int i0 = 0; i0 < n; i0 += VTK_INTERPOLATE_LINE_BLOCK)
+    {
+    int m = n - i0;
+    m = (m < VTK_INTERPOLATE_LINE_BLOCK ? m : VTK_INTERPOLATE_LINE_BLOCK);
+
+    for (int j = 0; j < 3; j++)
+      {
+      F *f = fs[j];
+      vtkInterpolateLineFloor(point[j], step[j], idX + i0, m, bias[j],
+                              ids0, f);
+      for (int i = 0; i < m; i++)
+        {
+        ids1[i] = ids0[i] + (f[i] != 0);
+        }
+      vtkInterpolateLineBorder(ids0, m, inExt[2*j], inExt[2*j+1], borderMode);
+      vtkInterpolateLineBorder(ids1, m, inExt[2*j], inExt[2*j+1], borderMode);
+      vtkIdType inc = inInc[j];
+      for (int i = 0; i < m; i++)
+        {
+        fact[j][0][i] = ids0[i]*inc;
+        fact[j][1][i] = ids1[i]*inc;
+        }
+      }
+
+    // the offsets to the four rows and the weights for the rows
+    for (int i = 0; i < m; i++)
+      {
+      offsets[0][i] = fact[1][0][i] + fact[2][0][i];
+      offsets[1][i] = fact[1][0][i] + fact[2][1][i];
+      offsets[2][i] = fact[1][1][i] + fact[2][0][i];
+      offsets[3][i] = fact[1][1][i] + fact[2][1][i];
+
+      F fy = fs[1][i];
+      F fz = fs[2][i];
+      F ry = 1 - fy;
+      F rz = 1 - fz;
+      w[0][i] = ry*rz;
+      w[1][i] = ry*fz;
+      w[2][i] = fy*rz;
+      w[3][i] = fy*fz;
+      }
+
+    for (int c = 0; c < numscalars; c++)
+      {
+      // gather the values of the eight corners for all samples
+      const T *tmpPtr = inPtr + c;
+      for (int i = 0; i < m; i++)
+        {
+        const T *inPtr0 = tmpPtr + fact[0][0][i];
+        const T *inPtr1 = tmpPtr + fact[0][1][i];
+        v[0][i] = inPtr0[offsets[0][i]];
+        v[1][i] = inPtr0[offsets[1][i]];
+        v[2][i] = inPtr0[offsets[2][i]];
+        v[3][i] = inPtr0[offsets[3][i]];
+        v[4][i] = inPtr1[offsets[0][i]];
+        v[5][i] = inPtr1[offsets[1][i]];
+        v[6][i] = inPtr1[offsets[2][i]];
+        v[7][i] = inPtr1[offsets[3][i]];
+        }
+
+      // compute the weighted sums for all samples
+      F *tmpOutPtr = outPtr + c;
+      for (int i = 0; i < m; i++)
+        {
+        F fx = fs[0][i];
+        F rx = 1 - fx;
+        tmpOutPtr[i*numscalars] =
+          (rx*(w[0][i]*v[0][i] + w[1][i]*v[1][i] +
+               w[2][i]*v[2][i] + w[3][i]*v[3][i]) +
+           fx*(w[0][i]*v[4][i] + w[1][i]*v[5][i] +
+               w[2][i]*v[6][i] + w[3][i]*v[7][i]));
+        }
+      }
+
+    outPtr += m*numscalars;
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class F, class T>
+void vtkImageNLCLineInterpolate<F, T>::Tricubic(
+  vtkInterpolationInfo *info, const F point[3], const F step[3],
+  int idX, F *outPtr, int n)
+{
+  const T *inPtr = static_cast<const T *>(info->Pointer);
+  int *inExt = info->Extent;
+  vtkIdType *inInc = info->Increments;
+  int numscalars = info->NumberOfComponents;
+  int borderMode = info->BorderMode;
+
+  double bias[3];
+  for (int j = 0; j < 3; j++)
+    {
+    bias[j] = vtkInterpolateLineBias(point[j], step[j], idX, n);
+    }
+
+  // check if only one slice in a particular direction
+  int multipleY = (inExt[2] != inExt[3]);
+  int multipleZ = (inExt[4] != inExt[5]);
+
+  // the limits to use when doing the interpolation
+  int j1 = 1 - multipleY;
+  int j2 = 1 + 2*multipleY;
+
+  int k1 = 1 - multipleZ;
+  int k2 = 1 + 2*multipleZ;
+
+  int ids[VTK_INTERPOLATE_LINE_BLOCK];
+  int idk[VTK_INTERPOLATE_LINE_BLOCK];
+  F fs[VTK_INTERPOLATE_LINE_BLOCK];
+  F fw[4];
+  vtkIdType fact[3][4][VTK_INTERPOLATE_LINE_BLOCK];
+  F weights[3][4][VTK_INTERPOLATE_LINE_BLOCK];
+  vtkIdType offsets[VTK_INTERPOLATE_LINE_BLOCK];
+  F wzy[VTK_INTERPOLATE_LINE_BLOCK];
+  F val[VTK_INTERPOLATE_LINE_BLOCK];
+  T v[4][VTK_INTERPOLATE_LINE_BLOCK];
+
+  for (int i0 = 0; i0 < n; i0 += VTK_INTERPOLATE_LINE_BLOCK)
+    {
+    int m = n - i0;
+    m = (m < VTK_INTERPOLATE_LINE_BLOCK ? m : VTK_INTERPOLATE_LINE_BLOCK);
+
+    for (int j = 0; j < 3; j++)
+      {
+      vtkInterpolateLineFloor(point[j], step[j], idX + i0, m, bias[j],
+                              ids, fs);
+      vtkIdType inc = inInc[j];
+      for (int k = 0; k < 4; k++)
+        {
+        for (int i = 0; i < m; i++)
+          {
+          idk[i] = ids[i] + k - 1;
+          }
+        vtkInterpolateLineBorder(idk, m, inExt[2*j], inExt[2*j+1],
+                                 borderMode);
+        vtkIdType *f = fact[j][k];
+        for (int i = 0; i < m; i++)
+          {
+          f[i] = idk[i]*inc;
+          }
+        }
+      for (int i = 0; i < m; i++)
+        {
+        vtkTricubicInterpWeights(fw, fs[i]);
+        weights[j][0][i] = fw[0];
+        weights[j][1][i] = fw[1];
+        weights[j][2][i] = fw[2];
+        weights[j][3][i] = fw[3];
+        }
+      }
+
+    // if only one coefficient will be used
+    if (multipleY == 0)
+      {
+      for (int i = 0; i < m; i++)
+        {
+        weights[1][1][i] = 1;
+        }
+      }
+    if (multipleZ == 0)
+      {
+      for (int i = 0; i < m; i++)
+        {
+        weights[2][1][i] = 1;
+        }
+      }
+
+    const F *fX0 = weights[0][0];
+    const F *fX1 = weights[0][1];
+    const F *fX2 = weights[0][2];
+    const F *fX3 = weights[0][3];
+    const vtkIdType *factX0 = fact[0][0];
+    const vtkIdType *factX1 = fact[0][1];
+    const vtkIdType *factX2 = fact[0][2];
+    const vtkIdType *factX3 = fact[0][3];
+
+    for (int c = 0; c < numscalars; c++)
+      {
+      for (int i = 0; i < m; i++)
+        {
+        val[i] = 0;
+        }
+
+      int k = k1;
+      do // loop over z
+        {
+        int j = j1;
+        do // loop over y
+          {
+          for (int i = 0; i < m; i++)
+            {
+            offsets[i] = fact[2][k][i] + fact[1][j][i];
+            wzy[i] = weights[2][k][i]*weights[1][j][i];
+            }
+
+          // gather four values along x for all samples
+          const T *tmpPtr = inPtr + c;
+          for (int i = 0; i < m; i++)
+            {
+            const T *rowPtr = tmpPtr + offsets[i];
+            v[0][i] = rowPtr[factX0[i]];
+            v[1][i] = rowPtr[factX1[i]];
+            v[2][i] = rowPtr[factX2[i]];
+            v[3][i] = rowPtr[factX3[i]];
+            }
+
+          for (int i = 0; i < m; i++)
+            {
+            val[i] += wzy[i]*(fX0[i]*v[0][i] + fX1[i]*v[1][i] +
+                              fX2[i]*v[2][i] + fX3[i]*v[3][i]);
+            }
+          }
+        while (++j <= j2);
+        }
+      while (++k <= k2);
+
+      F *tmpOutPtr = outPtr + c;
+      for (int i = 0; i < m; i++)
+        {
+        tmpOutPtr[i*numscalars] = val[i];
+        }
+      }
+
+    outPtr += m*numscalars;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Get the line interpolation function for the specified data types
+template<class F>
+void vtkImageInterpolatorGetLineInterpolationFunc(
+  void (**interpolate)(vtkInterpolationInfo *, const F [3], const F [3],
+                       int, F *, int),
+  int dataType, int interpolationMode)
+{
+  switch (interpolationMode)
+    {
+    case VTK_NEAREST_INTERPOLATION:
+      switch (dataType)
+        {
+        vtkTemplateAliasMacro(
+          *interpolate =
+            &(vtkImageNLCLineInterpolate<F, VTK_TT>::Nearest)
+          );
+        default:
+          *interpolate = 0;
+        }
+      break;
+    case VTK_LINEAR_INTERPOLATION:
+      switch (dataType)
+        {
+        vtkTemplateAliasMacro(
+          *interpolate =
+            &(vtkImageNLCLineInterpolate<F, VTK_TT>::Trilinear)
+          );
+        default:
+          *interpolate = 0;
+        }
+      break;
+    case VTK_CUBIC_INTERPOLATION:
+      switch (dataType)
+        {
+        vtkTemplateAliasMacro(
+          *interpolate =
+            &(vtkImageNLCLineInterpolate<F, VTK_TT>::Tricubic)
+          );
+        default:
+          *interpolate = 0;
+        }
+      break;
+    }
+}
+
 //----------------------------------------------------------------------------
 // Interpolation for precomputed weights
 
@@ -1062,6 +1525,24 @@ void vtkImageInterpolator::GetInterpolationFunc(
     func, this->InterpolationInfo->ScalarType, this->InterpolationMode);
 }
 
+//----------------------------------------------------------------------------
+void vtkImageInterpolator::GetLineInterpolationFunc(
+  void (**func)(vtkInterpolationInfo *, const double [3], const double [3],
+                int, double *, int))
+{
+  vtkImageInterpolatorGetLineInterpolationFunc(
+    func, this->InterpolationInfo->ScalarType, this->InterpolationMode);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageInterpolator::GetLineInterpolationFunc(
+  void (**func)(vtkInterpolationInfo *, const float [3], const float [3],
+                int, float *, int))
+{
+  vtkImageInterpolatorGetLineInterpolationFunc(
+    func, this->InterpolationInfo->ScalarType, this->InterpolationMode);
+}
+
 //----------------------------------------------------------------------------
 void vtkImageInterpolator::GetRowInterpolationFunc(
   void (**func)(vtkInterpolationWeights *, int, int, int, double *, int))
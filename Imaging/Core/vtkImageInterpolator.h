@@ -111,6 +111,17 @@ protected:
     void (**floatfunc)(
       vtkInterpolationWeights *, int, int, int, float *, int));
 
+  // Description:
+  // Get the line interpolation functions.
+  virtual void GetLineInterpolationFunc(
+    void (**doublefunc)(
+      vtkInterpolationInfo *, const double [3], const double [3], int,
+      double *, int));
+  virtual void GetLineInterpolationFunc(
+    void (**floatfunc)(
+      vtkInterpolationInfo *, const float [3], const float [3], int,
+      float *, int));
+
   int InterpolationMode;
 
 private:
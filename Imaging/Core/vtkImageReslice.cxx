@@ -2083,6 +2083,11 @@ void vtkImageResliceExecute(vtkImageReslice *self,
     optimizeNearest = 1;
     }
 
+  // for affine transformations without slabs, the in-bounds segments of
+  // each row can be interpolated as lines
+  bool optimizeLine = (!optimizeNearest && !newtrans && !perspective &&
+                       nsamples <= 1);
+
   // get Increments to march through data
   vtkIdType outIncX, outIncY, outIncZ;
   outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
@@ -2170,7 +2175,69 @@ void vtkImageResliceExecute(vtkImageReslice *self,
                                      outPtr, background, outComponents,
                                      setpixels, iter))
         {
-        if (!optimizeNearest)
+        if (optimizeLine)
+          {
+          int idX = idXmin;
+          while (idX <= idXmax)
+            {
+            // find a segment that is either in bounds or out of bounds
+            int startIdX = idX;
+            bool isInBounds = false;
+            for (; idX <= idXmax; idX++)
+              {
+              F inPoint[3];
+              inPoint[0] = inPoint1[0] + idX*xAxis[0];
+              inPoint[1] = inPoint1[1] + idX*xAxis[1];
+              inPoint[2] = inPoint1[2] + idX*xAxis[2];
+              bool check = interpolator->CheckBoundsIJK(inPoint);
+              if (idX > startIdX && check != isInBounds)
+                {
+                break;
+                }
+              isInBounds = check;
+              }
+
+            int numpixels = idX - startIdX;
+
+            if (isInBounds)
+              {
+              if (outputStencil)
+                {
+                outputStencil->InsertNextExtent(startIdX, idX - 1, idY, idZ);
+                }
+
+              interpolator->InterpolateLineIJK(
+                inPoint1, xAxis, startIdX, floatPtr, numpixels);
+
+              if (rescaleScalars)
+                {
+                vtkImageResliceRescaleScalars(floatPtr, inComponents,
+                                              numpixels,
+                                              scalarShift, scalarScale);
+                }
+
+              if (convertScalars)
+                {
+                (self->*convertScalars)(floatPtr, outPtr,
+                                        vtkTypeTraits<F>::VTKTypeID(),
+                                        inComponents, numpixels,
+                                        startIdX, idY, idZ, threadId);
+
+                outPtr = static_cast<void *>(static_cast<char *>(outPtr)
+                           + numpixels*outComponents*scalarSize);
+                }
+              else
+                {
+                convertpixels(outPtr, floatPtr, outComponents, numpixels);
+                }
+              }
+            else
+              {
+              setpixels(outPtr, background, outComponents, numpixels);
+              }
+            }
+          }
+        else if (!optimizeNearest)
           {
           bool wasInBounds = 1;
           bool isInBounds = 1;
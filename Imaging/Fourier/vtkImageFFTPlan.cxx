@@ -0,0 +1,337 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageFFTPlan.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkImageFFTPlan.h"
+
+#include "vtkMath.h"
+
+#include <math.h>
+
+// Prime factors above this are not done with a generic butterfly, the
+// whole transform uses Bluestein's algorithm instead.
+#define VTK_FFT_MAX_GENERIC_RADIX 64
+
+//----------------------------------------------------------------------------
+vtkImageFFTPlan::vtkImageFFTPlan()
+{
+  this->Size = 0;
+  this->Direction = 1;
+  this->WorkSize = 0;
+  this->NumberOfRadices = 0;
+  this->Twiddles = 0;
+  this->Chirp = 0;
+  this->ChirpTransform = 0;
+  this->ConvolutionPlan = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkImageFFTPlan::~vtkImageFFTPlan()
+{
+  this->Clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageFFTPlan::Clear()
+{
+  delete [] this->Twiddles;
+  delete [] this->Chirp;
+  delete [] this->ChirpTransform;
+  delete this->ConvolutionPlan;
+  this->Twiddles = 0;
+  this->Chirp = 0;
+  this->ChirpTransform = 0;
+  this->ConvolutionPlan = 0;
+  this->NumberOfRadices = 0;
+  this->WorkSize = 0;
+  this->Size = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageFFTPlan::Initialize(int n, int fb)
+{
+  if (n == this->Size && fb == this->Direction)
+    {
+    return;
+    }
+  this->Clear();
+  this->Direction = fb;
+  if (n < 1)
+    {
+    return;
+    }
+  this->Size = n;
+
+  // Radix 4 stages are the cheapest per value, then 2 and 3, then the
+  // generic butterfly for the remaining small primes.
+  int rest = n;
+  while (rest % 4 == 0)
+    {
+    this->Radices[this->NumberOfRadices++] = 4;
+    rest /= 4;
+    }
+  for (int p = 2; p <= VTK_FFT_MAX_GENERIC_RADIX && rest > 1; ++p)
+    {
+    while (rest % p == 0)
+      {
+      this->Radices[this->NumberOfRadices++] = p;
+      rest /= p;
+      }
+    }
+
+  if (rest == 1)
+    {
+    this->Twiddles = new vtkImageComplex[n];
+    double step = -2.0*vtkMath::Pi()*fb/n;
+    for (int k = 0; k < n; ++k)
+      {
+      vtkImageComplexEuclidSet(this->Twiddles[k], cos(step*k), sin(step*k));
+      }
+    this->WorkSize = n;
+    return;
+    }
+
+  // A large prime factor: convolve with a chirp of power-of-two length.
+  this->NumberOfRadices = 0;
+  int m = 1;
+  while (m < 2*n - 1)
+    {
+    m *= 2;
+    }
+  this->ConvolutionPlan = new vtkImageFFTPlan;
+  this->ConvolutionPlan->Initialize(m, 1);
+
+  // The exponent k^2 is reduced modulo 2n to keep the angles accurate.
+  this->Chirp = new vtkImageComplex[n];
+  double step = -vtkMath::Pi()*fb/n;
+  for (int k = 0; k < n; ++k)
+    {
+    vtkTypeInt64 kk = (static_cast<vtkTypeInt64>(k)*k) % (2*n);
+    vtkImageComplexEuclidSet(this->Chirp[k], cos(step*kk), sin(step*kk));
+    }
+
+  this->ChirpTransform = new vtkImageComplex[m];
+  for (int k = 0; k < m; ++k)
+    {
+    vtkImageComplexEuclidSet(this->ChirpTransform[k], 0.0, 0.0);
+    }
+  for (int k = 0; k < n; ++k)
+    {
+    vtkImageComplexConjugate(this->Chirp[k], this->ChirpTransform[k]);
+    if (k > 0)
+      {
+      this->ChirpTransform[m - k] = this->ChirpTransform[k];
+      }
+    }
+  vtkImageComplex *work = new vtkImageComplex[m];
+  this->ConvolutionPlan->Execute(this->ChirpTransform, 1, work);
+  delete [] work;
+
+  this->WorkSize = 2*static_cast<vtkIdType>(m);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageFFTPlan::Execute(vtkImageComplex *data, int count,
+                              vtkImageComplex *work)
+{
+  int n = this->Size;
+  if (n < 1)
+    {
+    return;
+    }
+
+  for (int line = 0; line < count; ++line)
+    {
+    vtkImageComplex *p = data + static_cast<vtkIdType>(line)*n;
+    if (this->ConvolutionPlan)
+      {
+      this->ExecuteBluestein(p, work);
+      }
+    else
+      {
+      this->ExecuteStockham(p, work);
+      }
+    if (this->Direction == -1)
+      {
+      double scale = 1.0/n;
+      for (int k = 0; k < n; ++k)
+        {
+        vtkImageComplexScale(p[k], scale, p[k]);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// One pass per radix R over all values. Pass s reads the R inputs of a
+// butterfly a quarter, third, ... of the array apart, applies the twiddle
+// factors of its position k within the sub-transforms of length ns that
+// are complete so far, and writes the R outputs ns apart so that the
+// sub-transforms grow to length ns*R in natural order. No bit reversal
+// is needed, the passes alternate between data and work.
+void vtkImageFFTPlan::ExecuteStockham(vtkImageComplex *data,
+                                      vtkImageComplex *work)
+{
+  const int n = this->Size;
+  const double fb = this->Direction;
+  const vtkImageComplex *w = this->Twiddles;
+  vtkImageComplex *src = data;
+  vtkImageComplex *dst = work;
+  int ns = 1;
+
+  for (int s = 0; s < this->NumberOfRadices; ++s)
+    {
+    const int r = this->Radices[s];
+    const int m = n/r;
+    const int tstep = n/(ns*r);
+
+    for (int j0 = 0; j0 < m; j0 += ns)
+      {
+      vtkImageComplex *out = dst + j0*r;
+      for (int k = 0; k < ns; ++k)
+        {
+        const int j = j0 + k;
+        const int t = k*tstep;
+        if (r == 4)
+          {
+          vtkImageComplex x0 = src[j];
+          vtkImageComplex x1, x2, x3;
+          vtkImageComplexMultiply(src[j + m], w[t], x1);
+          vtkImageComplexMultiply(src[j + 2*m], w[2*t], x2);
+          vtkImageComplexMultiply(src[j + 3*m], w[3*t], x3);
+          vtkImageComplex t0, t1, t2, t3;
+          vtkImageComplexAdd(x0, x2, t0);
+          vtkImageComplexSubtract(x0, x2, t1);
+          vtkImageComplexAdd(x1, x3, t2);
+          // (x1 - x3) times exp(-pi i fb/2) = -i fb
+          t3.Real = fb*(x1.Imag - x3.Imag);
+          t3.Imag = -fb*(x1.Real - x3.Real);
+          vtkImageComplexAdd(t0, t2, out[k]);
+          vtkImageComplexAdd(t1, t3, out[k + ns]);
+          vtkImageComplexSubtract(t0, t2, out[k + 2*ns]);
+          vtkImageComplexSubtract(t1, t3, out[k + 3*ns]);
+          }
+        else if (r == 2)
+          {
+          vtkImageComplex x0 = src[j];
+          vtkImageComplex x1;
+          vtkImageComplexMultiply(src[j + m], w[t], x1);
+          vtkImageComplexAdd(x0, x1, out[k]);
+          vtkImageComplexSubtract(x0, x1, out[k + ns]);
+          }
+        else if (r == 3)
+          {
+          // exp(-2 pi i fb/3) = -1/2 - i fb sqrt(3)/2
+          const double s3 = 0.86602540378443864676*fb;
+          vtkImageComplex x0 = src[j];
+          vtkImageComplex x1, x2;
+          vtkImageComplexMultiply(src[j + m], w[t], x1);
+          vtkImageComplexMultiply(src[j + 2*m], w[2*t], x2);
+          vtkImageComplex t1, t2, t3;
+          vtkImageComplexAdd(x1, x2, t1);
+          t2.Real = x0.Real - 0.5*t1.Real;
+          t2.Imag = x0.Imag - 0.5*t1.Imag;
+          t3.Real = s3*(x1.Imag - x2.Imag);
+          t3.Imag = -s3*(x1.Real - x2.Real);
+          vtkImageComplexAdd(x0, t1, out[k]);
+          vtkImageComplexAdd(t2, t3, out[k + ns]);
+          vtkImageComplexSubtract(t2, t3, out[k + 2*ns]);
+          }
+        else
+          {
+          // a direct DFT of length r with roots from the twiddle table
+          vtkImageComplex x[VTK_FFT_MAX_GENERIC_RADIX];
+          x[0] = src[j];
+          for (int q = 1; q < r; ++q)
+            {
+            vtkImageComplexMultiply(src[j + q*m], w[q*t], x[q]);
+            }
+          const int rstep = n/r;
+          for (int p = 0; p < r; ++p)
+            {
+            vtkImageComplex sum = x[0];
+            int e = 0;
+            for (int q = 1; q < r; ++q)
+              {
+              e += p;
+              if (e >= r)
+                {
+                e -= r;
+                }
+              vtkImageComplex prod;
+              vtkImageComplexMultiply(x[q], w[e*rstep], prod);
+              vtkImageComplexAdd(sum, prod, sum);
+              }
+            out[k + p*ns] = sum;
+            }
+          }
+        }
+      }
+
+    ns *= r;
+    vtkImageComplex *tmp = src;
+    src = dst;
+    dst = tmp;
+    }
+
+  // If the results ended up in the work array, copy them back.
+  if (src != data)
+    {
+    for (int k = 0; k < n; ++k)
+      {
+      data[k] = src[k];
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// X[k] = c[k] * sum_j (x[j] c[j]) conj(c[k - j]) with the chirp
+// c[k] = exp(-pi i fb k^2 / n), the sum being a cyclic convolution of
+// power-of-two length. The inverse transform of the convolution is done
+// with the forward plan on conjugated values.
+void vtkImageFFTPlan::ExecuteBluestein(vtkImageComplex *data,
+                                       vtkImageComplex *work)
+{
+  const int n = this->Size;
+  vtkImageFFTPlan *conv = this->ConvolutionPlan;
+  const int m = conv->GetSize();
+  vtkImageComplex *a = work;
+  vtkImageComplex *convWork = work + m;
+
+  for (int k = 0; k < n; ++k)
+    {
+    vtkImageComplexMultiply(data[k], this->Chirp[k], a[k]);
+    }
+  for (int k = n; k < m; ++k)
+    {
+    vtkImageComplexEuclidSet(a[k], 0.0, 0.0);
+    }
+
+  conv->Execute(a, 1, convWork);
+  for (int k = 0; k < m; ++k)
+    {
+    vtkImageComplex prod;
+    vtkImageComplexMultiply(a[k], this->ChirpTransform[k], prod);
+    vtkImageComplexConjugate(prod, a[k]);
+    }
+  conv->Execute(a, 1, convWork);
+
+  double scale = 1.0/m;
+  for (int k = 0; k < n; ++k)
+    {
+    vtkImageComplex conv_k;
+    conv_k.Real = a[k].Real*scale;
+    conv_k.Imag = -a[k].Imag*scale;
+    vtkImageComplexMultiply(conv_k, this->Chirp[k], data[k]);
+    }
+}
@@ -0,0 +1,91 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageFFTPlan.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkImageFFTPlan - FFT engine for lines of a fixed length
+// .SECTION Description
+// vtkImageFFTPlan computes one dimensional discrete Fourier transforms of
+// a fixed length for the vtkImageFourierFilter subclasses. Initialize()
+// factors the length and builds the twiddle table once, after which
+// Execute() transforms any number of lines without further allocation.
+//
+// Lengths whose prime factors are all at most 64 use an iterative
+// self-sorting (Stockham) mixed-radix algorithm with radix 4, 2 and 3
+// butterflies and a generic butterfly for the other factors. Any other
+// length is computed with Bluestein's algorithm as a convolution of
+// power-of-two length, so that every length costs O(n log n).
+//
+// A plan is not thread safe, every thread must use its own.
+
+#ifndef vtkImageFFTPlan_h
+#define vtkImageFFTPlan_h
+
+#include "vtkImagingFourierModule.h" // For export macro
+#include "vtkImageFourierFilter.h" // For vtkImageComplex
+
+class VTKIMAGINGFOURIER_EXPORT vtkImageFFTPlan
+{
+public:
+  vtkImageFFTPlan();
+  ~vtkImageFFTPlan();
+
+  // Description:
+  // Prepare the tables for transforms of length n. The transform is
+  // forward for fb = 1, and reverse, including the scaling by 1/n, for
+  // fb = -1.
+  void Initialize(int n, int fb);
+
+  // Description:
+  // The length of the lines and the direction of the transform.
+  int GetSize() { return this->Size; }
+  int GetDirection() { return this->Direction; }
+
+  // Description:
+  // The number of complex values of scratch space that Execute() needs.
+  vtkIdType GetWorkSize() { return this->WorkSize; }
+
+  // Description:
+  // Transform count lines of GetSize() values that follow each other in
+  // data. The result replaces the input. The work array must hold
+  // GetWorkSize() values.
+  void Execute(vtkImageComplex *data, int count, vtkImageComplex *work);
+
+protected:
+  void ExecuteStockham(vtkImageComplex *data, vtkImageComplex *work);
+  void ExecuteBluestein(vtkImageComplex *data, vtkImageComplex *work);
+  void Clear();
+
+  int Size;
+  int Direction;
+  vtkIdType WorkSize;
+
+  // Radices of the Stockham stages, in order.
+  int NumberOfRadices;
+  int Radices[32];
+
+  // exp(-2 pi i fb k / Size) for k < Size.
+  vtkImageComplex *Twiddles;
+
+  // For Bluestein's algorithm: the chirp exp(-pi i fb k^2 / Size), the
+  // transform of the conjugate chirp, and the plan of the convolution.
+  vtkImageComplex *Chirp;
+  vtkImageComplex *ChirpTransform;
+  vtkImageFFTPlan *ConvolutionPlan;
+
+private:
+  vtkImageFFTPlan(const vtkImageFFTPlan&);  // Not implemented.
+  void operator=(const vtkImageFFTPlan&);  // Not implemented.
+};
+
+#endif
+// VTK-HeaderTest-Exclude: vtkImageFFTPlan.h
@@ -14,9 +14,14 @@
 =========================================================================*/
 #include "vtkImageFourierFilter.h"
 
+#include "vtkImageData.h"
+#include "vtkImageFFTPlan.h"
 #include "vtkMath.h"
 #include <math.h>
 
+// The number of lines that are transformed together.
+#define VTK_FFT_LINE_BATCH 16
+
 /*=========================================================================
         Vectors of complex numbers.
 =========================================================================*/
@@ -144,69 +149,209 @@ void vtkImageFourierFilter::ExecuteFftStepN(vtkImageComplex *p_in,
 
 //----------------------------------------------------------------------------
 // This function calculates the whole fft (or rfft) of an array.
-// The contents of the input array are changed.
-// It is engineered for no decimation so input and output cannot be equal.
+// The input array is not changed, and may be equal to the output.
 // (fb = 1) => fft, (fb = -1) => rfft;
 void vtkImageFourierFilter::ExecuteFftForwardBackward(vtkImageComplex *in,
                                                       vtkImageComplex *out,
                                                       int N, int fb)
 {
-  vtkImageComplex *p1, *p2, *p3;
-  int block_size = 1;
-  int rest_size = N;
-  int n = 2;
-  int idx;
-
-  // If this is a reverse transform (scale accordingly).
-  if(fb == -1)
+  if (N < 1)
     {
-    p1 = in;
-    for(idx = 0; idx < N; ++idx)
+    return;
+    }
+  if (out != in)
+    {
+    for (int idx = 0; idx < N; ++idx)
       {
-      p1->Real = p1->Real / N;
-      p1->Imag = p1->Imag / N;
-      ++p1;
+      out[idx] = in[idx];
       }
     }
-  p1 = in;
-  p2 = out;
-  while(block_size < N && n <= N)
+  vtkImageFFTPlan plan;
+  plan.Initialize(N, fb);
+  vtkImageComplex *work = new vtkImageComplex[plan.GetWorkSize()];
+  plan.Execute(out, 1, work);
+  delete [] work;
+}
+
+//----------------------------------------------------------------------------
+// Copy a batch of count lines of size values into buffer, one line after
+// the other. When the lines are closer to each other in memory than the
+// values of a line (an FFT along y or z), the batch is read across the
+// lines so that the reads move through memory in order.
+template <class T>
+void vtkImageFourierFilterGather(T *inPtr, vtkIdType inInc0,
+                                 vtkIdType inInc1, int numberOfComponents,
+                                 int size, int count,
+                                 vtkImageComplex *buffer)
+{
+  if (inInc0 > inInc1)
     {
-    if((rest_size % n) == 0)
+    for (int idx0 = 0; idx0 < size; ++idx0)
       {
-      // n is a prime factor, perform one "butterfly" stage of the fft.
-      if(n == 2)
+      T *inPtr1 = inPtr + idx0*inInc0;
+      vtkImageComplex *pComplex = buffer + idx0;
+      for (int line = 0; line < count; ++line)
         {
-        this->ExecuteFftStep2(p1, p2, N, block_size, fb);
+        pComplex->Real = static_cast<double>(*inPtr1);
+        pComplex->Imag = (numberOfComponents > 1 ?
+                          static_cast<double>(inPtr1[1]) : 0.0);
+        inPtr1 += inInc1;
+        pComplex += size;
         }
-      else
+      }
+    }
+  else
+    {
+    vtkImageComplex *pComplex = buffer;
+    for (int line = 0; line < count; ++line)
+      {
+      T *inPtr0 = inPtr + line*inInc1;
+      for (int idx0 = 0; idx0 < size; ++idx0)
         {
-        this->ExecuteFftStepN(p1, p2, N, block_size, n, fb);
+        pComplex->Real = static_cast<double>(*inPtr0);
+        pComplex->Imag = (numberOfComponents > 1 ?
+                          static_cast<double>(inPtr0[1]) : 0.0);
+        inPtr0 += inInc0;
+        ++pComplex;
         }
-      block_size = block_size * n;
-      rest_size = rest_size / n;
-      // switch input and output.
-      p3 = p1;
-      p1 = p2;
-      p2 = p3;
       }
-    else
+    }
+}
+
+//----------------------------------------------------------------------------
+// The counterpart of the gather: copy the values [offset, offset+size)
+// of every line in the buffer to the output.
+static void vtkImageFourierFilterScatter(const vtkImageComplex *buffer,
+                                         int lineSize, int offset,
+                                         int size, int count,
+                                         double *outPtr, vtkIdType outInc0,
+                                         vtkIdType outInc1)
+{
+  if (outInc0 > outInc1)
+    {
+    for (int idx0 = 0; idx0 < size; ++idx0)
       {
-      // n is not a prime factor. increment n to see if n+1 is.
-      ++n;
+      double *outPtr1 = outPtr + idx0*outInc0;
+      const vtkImageComplex *pComplex = buffer + offset + idx0;
+      for (int line = 0; line < count; ++line)
+        {
+        outPtr1[0] = pComplex->Real;
+        outPtr1[1] = pComplex->Imag;
+        outPtr1 += outInc1;
+        pComplex += lineSize;
+        }
       }
     }
-  // If the results ended up in the input, copy to output.
-  if(p1 != out)
+  else
     {
-    for(n = 0; n < N; ++n)
+    for (int line = 0; line < count; ++line)
       {
-      *out++ = *p1++;
+      double *outPtr0 = outPtr + line*outInc1;
+      const vtkImageComplex *pComplex = buffer + line*lineSize + offset;
+      for (int idx0 = 0; idx0 < size; ++idx0)
+        {
+        outPtr0[0] = pComplex->Real;
+        outPtr0[1] = pComplex->Imag;
+        outPtr0 += outInc0;
+        ++pComplex;
+        }
       }
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkImageFourierFilter::ExecuteFftLines(vtkImageData *inData,
+                                            int inExt[6],
+                                            vtkImageData *outData,
+                                            int outExt[6],
+                                            int fb, int threadId)
+{
+  int inMin0, inMax0, inMin1, inMax1, inMin2, inMax2;
+  int outMin0, outMax0, outMin1, outMax1, outMin2, outMax2;
+  vtkIdType inInc0, inInc1, inInc2;
+  vtkIdType outInc0, outInc1, outInc2;
+
+  // Reorder axes
+  this->PermuteExtent(inExt, inMin0, inMax0, inMin1, inMax1, inMin2, inMax2);
+  this->PermuteExtent(outExt, outMin0, outMax0, outMin1, outMax1,
+                      outMin2, outMax2);
+  this->PermuteIncrements(inData->GetIncrements(), inInc0, inInc1, inInc2);
+  this->PermuteIncrements(outData->GetIncrements(), outInc0, outInc1, outInc2);
+
+  // Input has to have real components at least.
+  int numberOfComponents = inData->GetNumberOfScalarComponents();
+  if (numberOfComponents < 1)
+    {
+    vtkWarningMacro("No real components");
+    return;
+    }
+
+  int inSize0 = inMax0 - inMin0 + 1;
+  int outSize0 = outMax0 - outMin0 + 1;
+  void *inPtr = inData->GetScalarPointerForExtent(inExt);
+  double *outPtr =
+    static_cast<double *>(outData->GetScalarPointerForExtent(outExt));
+
+  vtkImageFFTPlan plan;
+  plan.Initialize(inSize0, fb);
+  vtkImageComplex *buffer =
+    new vtkImageComplex[static_cast<vtkIdType>(inSize0)*VTK_FFT_LINE_BATCH];
+  vtkImageComplex *work = new vtkImageComplex[plan.GetWorkSize()];
 
+  double startProgress =
+    this->GetIteration()/static_cast<double>(this->GetNumberOfIterations());
+  unsigned long target = static_cast<unsigned long>(
+    (outMax2-outMin2+1)*(outMax1-outMin1+1)*this->GetNumberOfIterations()/50.0);
+  target++;
+  unsigned long count = 0;
+  unsigned long nextProgress = 0;
+
+  for (int idx2 = outMin2; idx2 <= outMax2; ++idx2)
+    {
+    for (int idx1 = outMin1; !this->AbortExecute && idx1 <= outMax1;
+         idx1 += VTK_FFT_LINE_BATCH)
+      {
+      int lines = outMax1 - idx1 + 1;
+      if (lines > VTK_FFT_LINE_BATCH)
+        {
+        lines = VTK_FFT_LINE_BATCH;
+        }
+      if (!threadId)
+        {
+        if (count >= nextProgress)
+          {
+          this->UpdateProgress(count/(50.0*target) + startProgress);
+          nextProgress += target;
+          }
+        count += lines;
+        }
+
+      vtkIdType inOffset = (idx2 - outMin2)*inInc2 + (idx1 - outMin1)*inInc1;
+      switch (inData->GetScalarType())
+        {
+        vtkTemplateMacro(
+          vtkImageFourierFilterGather(
+            static_cast<VTK_TT *>(inPtr) + inOffset, inInc0, inInc1,
+            numberOfComponents, inSize0, lines, buffer));
+        default:
+          vtkErrorMacro(<< "Execute: Unknown ScalarType");
+          delete [] buffer;
+          delete [] work;
+          return;
+        }
+
+      plan.Execute(buffer, lines, work);
+
+      vtkImageFourierFilterScatter(
+        buffer, inSize0, outMin0 - inMin0, outSize0, lines,
+        outPtr + (idx2 - outMin2)*outInc2 + (idx1 - outMin1)*outInc1,
+        outInc0, outInc1);
+      }
+    }
+
+  delete [] buffer;
+  delete [] work;
+}
 
 //----------------------------------------------------------------------------
 // This function calculates the whole fft of an array.
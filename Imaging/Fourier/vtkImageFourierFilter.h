@@ -25,6 +25,7 @@
 #include "vtkImagingFourierModule.h" // For export macro
 #include "vtkImageDecomposeFilter.h"
 
+class vtkImageData;
 
 //BTX
 /*******************************************************************
@@ -119,6 +120,17 @@ protected:
                        int N, int bsize, int n, int fb);
   void ExecuteFftForwardBackward(vtkImageComplex *in, vtkImageComplex *out,
                                  int N, int fb);
+
+  // Description:
+  // Transform all lines of outExt along the axis of the current iteration,
+  // forward for fb = 1 and reverse for fb = -1. The lines are done in
+  // batches, which are gathered into a contiguous buffer first so that
+  // axes other than x are read a cache line at a time. The input may have
+  // one (real) or two (real, imaginary) components of any type, the output
+  // must be two component doubles.
+  void ExecuteFftLines(vtkImageData *inData, int inExt[6],
+                       vtkImageData *outData, int outExt[6],
+                       int fb, int threadId);
   //ETX
 private:
   vtkImageFourierFilter(const vtkImageFourierFilter&);  // Not implemented.
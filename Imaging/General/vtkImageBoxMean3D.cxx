@@ -0,0 +1,123 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageBoxMean3D.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkImageBoxMean3D.h"
+
+#include "vtkImageData.h"
+#include "vtkImageSummedAreaTable.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkObjectFactory.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+
+vtkStandardNewMacro(vtkImageBoxMean3D);
+
+//----------------------------------------------------------------------------
+vtkImageBoxMean3D::vtkImageBoxMean3D()
+{
+  this->HandleBoundaries = 1;
+  this->KernelSize[0] = 1;
+  this->KernelSize[1] = 1;
+  this->KernelSize[2] = 1;
+  this->KernelMiddle[0] = 0;
+  this->KernelMiddle[1] = 0;
+  this->KernelMiddle[2] = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkImageBoxMean3D::~vtkImageBoxMean3D()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkImageBoxMean3D::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+}
+
+//----------------------------------------------------------------------------
+// This method sets the size of the neighborhood.  It also sets the
+// default middle of the neighborhood.
+void vtkImageBoxMean3D::SetKernelSize(int size0, int size1, int size2)
+{
+  int size[3] = { size0, size1, size2 };
+  int modified = 0;
+
+  for (int idx = 0; idx < 3; ++idx)
+    {
+    if (this->KernelSize[idx] != size[idx])
+      {
+      modified = 1;
+      this->KernelSize[idx] = size[idx];
+      this->KernelMiddle[idx] = size[idx] / 2;
+      }
+    }
+
+  if (modified)
+    {
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+// Output is always float
+int vtkImageBoxMean3D::RequestInformation (vtkInformation *request,
+                                           vtkInformationVector **inputVector,
+                                           vtkInformationVector *outputVector)
+{
+  int retval =
+    this->Superclass::RequestInformation(request, inputVector, outputVector);
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_FLOAT, -1);
+  return retval;
+}
+
+//----------------------------------------------------------------------------
+// This method computes the summed area table of the input extent that is
+// needed for outExt, and gets the means from it.
+// It handles image boundaries, so the image does not shrink.
+void vtkImageBoxMean3D::ThreadedRequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *vtkNotUsed(outputVector),
+  vtkImageData ***inData,
+  vtkImageData **outData,
+  int outExt[6], int vtkNotUsed(id))
+{
+  int inExt[6], wholeExt[6];
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
+  this->InternalRequestUpdateExtent(inExt,outExt,wholeExt);
+
+  vtkDataArray *inArray = this->GetInputArrayToProcess(0,inputVector);
+  if (!inArray)
+    {
+    vtkErrorMacro(<< "Execute: no input scalars");
+    return;
+    }
+
+  // this filter expects the output to be float
+  if (outData[0]->GetScalarType() != VTK_FLOAT)
+    {
+    vtkErrorMacro(<< "Execute: output ScalarType, "
+      << vtkImageScalarTypeNameMacro(outData[0]->GetScalarType())
+      << " must be float");
+    return;
+    }
+
+  vtkImageSummedAreaTable::ExecuteBoxMean(inData[0][0], inArray, inExt,
+                                          outData[0], outExt,
+                                          this->KernelSize,
+                                          this->KernelMiddle);
+}
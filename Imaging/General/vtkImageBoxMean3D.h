@@ -0,0 +1,64 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageBoxMean3D.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkImageBoxMean3D - Mean over a box neighborhood.
+// .SECTION Description
+// vtkImageBoxMean3D replaces each pixel with the mean of the pixels in a
+// box of KernelSize pixels centered on that pixel.  At the boundaries of
+// the image, only the pixels of the box that are within the image are
+// used.  The means are computed from a summed area table of each piece of
+// the input, so the time taken does not depend on the kernel size.  The
+// output is float.
+// .SECTION See Also
+// vtkImageSummedAreaTable vtkImageVariance3D
+
+#ifndef vtkImageBoxMean3D_h
+#define vtkImageBoxMean3D_h
+
+#include "vtkImagingGeneralModule.h" // For export macro
+#include "vtkImageSpatialAlgorithm.h"
+
+class VTKIMAGINGGENERAL_EXPORT vtkImageBoxMean3D :
+  public vtkImageSpatialAlgorithm
+{
+public:
+  static vtkImageBoxMean3D *New();
+  vtkTypeMacro(vtkImageBoxMean3D,vtkImageSpatialAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // This method sets the size of the neighborhood.  It also sets the
+  // default middle of the neighborhood.
+  void SetKernelSize(int size0, int size1, int size2);
+
+protected:
+  vtkImageBoxMean3D();
+  ~vtkImageBoxMean3D();
+
+  virtual int RequestInformation (vtkInformation *request,
+                                  vtkInformationVector **inputVector,
+                                  vtkInformationVector *outputVector);
+
+  void ThreadedRequestData(vtkInformation *request,
+                           vtkInformationVector **inputVector,
+                           vtkInformationVector *outputVector,
+                           vtkImageData ***inData, vtkImageData **outData,
+                           int extent[6], int id);
+
+private:
+  vtkImageBoxMean3D(const vtkImageBoxMean3D&);  // Not implemented.
+  void operator=(const vtkImageBoxMean3D&);  // Not implemented.
+};
+
+#endif
@@ -0,0 +1,485 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageBoxMorphology.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkImageBoxMorphology.h"
+
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkPointData.h"
+#include "vtkTypeTraits.h"
+
+#include <string.h>
+#include <vector>
+
+namespace {
+
+// The number of scalars in each bundle of rows for the y and z passes,
+// which keeps the work arrays small enough to stay in the cache.
+const int VTK_IMAGE_BOX_BUNDLE_SIZE = 256;
+
+template<class T>
+struct vtkImageBoxMaximum
+{
+  static T Identity() { return vtkTypeTraits<T>::Min(); }
+  static T Apply(T a, T b) { return (a < b ? b : a); }
+};
+
+template<class T>
+struct vtkImageBoxMinimum
+{
+  static T Identity() { return vtkTypeTraits<T>::Max(); }
+  static T Apply(T a, T b) { return (b < a ? b : a); }
+};
+
+// A region of an image: the pointer to its first scalar, its extent and
+// its increments.
+template<class T>
+struct vtkImageBoxRegion
+{
+  T *Pointer;
+  int Extent[6];
+  vtkIdType Increments[3];
+};
+
+//----------------------------------------------------------------------------
+// Filter a bundle of lines whose elements are inStep apart in the input
+// and outStep apart in the output, and whose corresponding elements are
+// next to each other.  The lines have n input elements, and the outputs
+// o0 to o1 (counted from the first input element) are computed.  The work
+// array must hold 2*(n + k - 1)*width values.
+template<class T, class TOp>
+void vtkImageBoxMorphologyBundle(
+  const T *in, vtkIdType inStep, T *out, vtkIdType outStep, int width,
+  int n, int o0, int o1, int k, int m, T *work)
+{
+  // The line is padded with m identity values before it and k - m - 1
+  // after it, so that the window of output o is [o, o + k - 1] in padded
+  // positions.  Within each block of k positions, g holds the result from
+  // the start of the block and h holds the result to the end of the block,
+  // so that the result for a window is the combination of h at its start
+  // and g at its end.
+  int size = n + k - 1;
+  T *g = work;
+  T *h = work + static_cast<vtkIdType>(size)*width;
+  T identity = TOp::Identity();
+
+  // forward, for the ends of the windows
+  int pEnd = o1 + k - 1;
+  for (int p = ((o0 + k - 1)/k)*k; p <= pEnd; ++p)
+    {
+    T *gp = g + static_cast<vtkIdType>(p)*width;
+    int i = p - m;
+    const T *src = (i >= 0 && i < n ? in + i*inStep : 0);
+    if (p % k == 0)
+      {
+      if (src)
+        {
+        for (int w = 0; w < width; ++w)
+          {
+          gp[w] = src[w];
+          }
+        }
+      else
+        {
+        for (int w = 0; w < width; ++w)
+          {
+          gp[w] = identity;
+          }
+        }
+      }
+    else
+      {
+      const T *gq = gp - width;
+      if (src)
+        {
+        for (int w = 0; w < width; ++w)
+          {
+          gp[w] = TOp::Apply(gq[w], src[w]);
+          }
+        }
+      else
+        {
+        for (int w = 0; w < width; ++w)
+          {
+          gp[w] = gq[w];
+          }
+        }
+      }
+    }
+
+  // backward, for the starts of the windows
+  int pStart = (o1/k)*k + k - 1;
+  pStart = (pStart < size ? pStart : size - 1);
+  for (int p = pStart; p >= o0; --p)
+    {
+    T *hp = h + static_cast<vtkIdType>(p)*width;
+    int i = p - m;
+    const T *src = (i >= 0 && i < n ? in + i*inStep : 0);
+    if (p == pStart || p % k == k - 1)
+      {
+      if (src)
+        {
+        for (int w = 0; w < width; ++w)
+          {
+          hp[w] = src[w];
+          }
+        }
+      else
+        {
+        for (int w = 0; w < width; ++w)
+          {
+          hp[w] = identity;
+          }
+        }
+      }
+    else
+      {
+      const T *hq = hp + width;
+      if (src)
+        {
+        for (int w = 0; w < width; ++w)
+          {
+          hp[w] = TOp::Apply(hq[w], src[w]);
+          }
+        }
+      else
+        {
+        for (int w = 0; w < width; ++w)
+          {
+          hp[w] = hq[w];
+          }
+        }
+      }
+    }
+
+  // combine
+  for (int o = o0; o <= o1; ++o)
+    {
+    const T *hp = h + static_cast<vtkIdType>(o)*width;
+    const T *gp = g + static_cast<vtkIdType>(o + k - 1)*width;
+    T *dst = out + (o - o0)*outStep;
+    for (int w = 0; w < width; ++w)
+      {
+      dst[w] = TOp::Apply(hp[w], gp[w]);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Filter along one axis.  The destination has the same extent as the
+// source, except along the axis.
+template<class T, class TOp>
+void vtkImageBoxMorphologyPass(
+  const vtkImageBoxRegion<T>& src, const vtkImageBoxRegion<T>& dst,
+  int axis, int numComp, int k, int m, std::vector<T>& work)
+{
+  int n = src.Extent[2*axis+1] - src.Extent[2*axis] + 1;
+  int o0 = dst.Extent[2*axis] - src.Extent[2*axis];
+  int o1 = dst.Extent[2*axis+1] - src.Extent[2*axis];
+  int size = n + k - 1;
+
+  if (axis == 0)
+    {
+    // the components of each x row make up a bundle
+    work.resize(2*static_cast<size_t>(size)*numComp);
+    for (int z = 0; z <= src.Extent[5] - src.Extent[4]; ++z)
+      {
+      for (int y = 0; y <= src.Extent[3] - src.Extent[2]; ++y)
+        {
+        vtkImageBoxMorphologyBundle<T, TOp>(
+          src.Pointer + y*src.Increments[1] + z*src.Increments[2],
+          src.Increments[0],
+          dst.Pointer + y*dst.Increments[1] + z*dst.Increments[2],
+          dst.Increments[0], numComp, n, o0, o1, k, m, &work[0]);
+        }
+      }
+    }
+  else
+    {
+    // pieces of the x rows make up the bundles, looping over the other
+    // axis that is not x
+    int other = 3 - axis;
+    int rowSize = (src.Extent[1] - src.Extent[0] + 1)*numComp;
+    int bundleSize = (rowSize < VTK_IMAGE_BOX_BUNDLE_SIZE ?
+                      rowSize : VTK_IMAGE_BOX_BUNDLE_SIZE);
+    work.resize(2*static_cast<size_t>(size)*bundleSize);
+    for (int j = 0; j <= src.Extent[2*other+1] - src.Extent[2*other]; ++j)
+      {
+      for (int c = 0; c < rowSize; c += bundleSize)
+        {
+        int width = rowSize - c;
+        width = (width < bundleSize ? width : bundleSize);
+        vtkImageBoxMorphologyBundle<T, TOp>(
+          src.Pointer + j*src.Increments[other] + c, src.Increments[axis],
+          dst.Pointer + j*dst.Increments[other] + c, dst.Increments[axis],
+          width, n, o0, o1, k, m, &work[0]);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Filter along each axis with a kernel larger than one voxel.  All but the
+// last pass write to contiguous buffers.
+template<class T, class TOp>
+void vtkImageBoxMorphologyExecute(
+  vtkImageBoxRegion<T> src, const vtkImageBoxRegion<T>& dst, int numComp,
+  const int kernelSize[3], const int kernelMiddle[3])
+{
+  // along the axes that are not filtered, only the output extent is used
+  int axes[3];
+  int numAxes = 0;
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    if (kernelSize[axis] > 1)
+      {
+      axes[numAxes++] = axis;
+      }
+    else
+      {
+      src.Pointer += (dst.Extent[2*axis] - src.Extent[2*axis])*
+        src.Increments[axis];
+      src.Extent[2*axis] = dst.Extent[2*axis];
+      src.Extent[2*axis+1] = dst.Extent[2*axis+1];
+      }
+    }
+
+  if (numAxes == 0)
+    {
+    size_t rowSize = (dst.Extent[1] - dst.Extent[0] + 1)*numComp*sizeof(T);
+    for (int z = 0; z <= dst.Extent[5] - dst.Extent[4]; ++z)
+      {
+      for (int y = 0; y <= dst.Extent[3] - dst.Extent[2]; ++y)
+        {
+        memcpy(dst.Pointer + y*dst.Increments[1] + z*dst.Increments[2],
+               src.Pointer + y*src.Increments[1] + z*src.Increments[2],
+               rowSize);
+        }
+      }
+    return;
+    }
+
+  std::vector<T> work;
+  std::vector<T> buffers[2];
+  vtkImageBoxRegion<T> current = src;
+  for (int i = 0; i < numAxes; ++i)
+    {
+    int axis = axes[i];
+    vtkImageBoxRegion<T> next = dst;
+    if (i < numAxes - 1)
+      {
+      vtkIdType inc = numComp;
+      for (int j = 0; j < 3; ++j)
+        {
+        next.Extent[2*j] = current.Extent[2*j];
+        next.Extent[2*j+1] = current.Extent[2*j+1];
+        if (j == axis)
+          {
+          next.Extent[2*j] = dst.Extent[2*j];
+          next.Extent[2*j+1] = dst.Extent[2*j+1];
+          }
+        next.Increments[j] = inc;
+        inc *= next.Extent[2*j+1] - next.Extent[2*j] + 1;
+        }
+      buffers[i % 2].resize(inc);
+      next.Pointer = &buffers[i % 2][0];
+      }
+    vtkImageBoxMorphologyPass<T, TOp>(
+      current, next, axis, numComp, kernelSize[axis], kernelMiddle[axis],
+      work);
+    current = next;
+    }
+}
+
+//----------------------------------------------------------------------------
+template<class T>
+void vtkImageBoxMorphologyGetRegion(
+  vtkImageData *data, vtkDataArray *array, const int extent[6],
+  vtkImageBoxRegion<T> *region)
+{
+  int *dataExt = data->GetExtent();
+  data->GetArrayIncrements(array, region->Increments);
+  region->Pointer = static_cast<T *>(array->GetVoidPointer(
+    (extent[0] - dataExt[0])*region->Increments[0] +
+    (extent[2] - dataExt[2])*region->Increments[1] +
+    (extent[4] - dataExt[4])*region->Increments[2]));
+  for (int i = 0; i < 6; ++i)
+    {
+    region->Extent[i] = extent[i];
+    }
+}
+
+//----------------------------------------------------------------------------
+template<class T>
+void vtkImageBoxMorphologyExecuteGrey(
+  vtkImageData *inData, vtkDataArray *inArray, const int inExt[6],
+  vtkImageData *outData, const int outExt[6], const int kernelSize[3],
+  const int kernelMiddle[3], int operation, T *)
+{
+  vtkImageBoxRegion<T> src;
+  vtkImageBoxRegion<T> dst;
+  vtkImageBoxMorphologyGetRegion(inData, inArray, inExt, &src);
+  vtkImageBoxMorphologyGetRegion(
+    outData, outData->GetPointData()->GetScalars(), outExt, &dst);
+  int numComp = inArray->GetNumberOfComponents();
+
+  if (operation == VTK_IMAGE_BOX_MINIMUM)
+    {
+    vtkImageBoxMorphologyExecute<T, vtkImageBoxMinimum<T> >(
+      src, dst, numComp, kernelSize, kernelMiddle);
+    }
+  else
+    {
+    vtkImageBoxMorphologyExecute<T, vtkImageBoxMaximum<T> >(
+      src, dst, numComp, kernelSize, kernelMiddle);
+    }
+}
+
+//----------------------------------------------------------------------------
+// The voxels that have the dilate value are marked with ones in a mask,
+// which is dilated with a box maximum and then used to set the voxels
+// with the erode value.
+template<class T>
+void vtkImageBoxMorphologyExecuteDilateErode(
+  vtkImageData *inData, vtkDataArray *inArray, const int inExt[6],
+  vtkImageData *outData, const int outExt[6], const int kernelSize[3],
+  const int kernelMiddle[3], double dilateValue, double erodeValue, T *)
+{
+  vtkImageBoxRegion<T> src;
+  vtkImageBoxRegion<T> dst;
+  vtkImageBoxMorphologyGetRegion(inData, inArray, inExt, &src);
+  vtkImageBoxMorphologyGetRegion(
+    outData, outData->GetPointData()->GetScalars(), outExt, &dst);
+  int numComp = inArray->GetNumberOfComponents();
+  T dilate = static_cast<T>(dilateValue);
+  T erode = static_cast<T>(erodeValue);
+
+  // mark the voxels with the dilate value
+  vtkImageBoxRegion<unsigned char> mask;
+  vtkImageBoxRegion<unsigned char> dilated;
+  std::vector<unsigned char> buffers[2];
+  vtkIdType inc = numComp;
+  for (int j = 0; j < 3; ++j)
+    {
+    mask.Increments[j] = inc;
+    inc *= inExt[2*j+1] - inExt[2*j] + 1;
+    }
+  buffers[0].resize(inc);
+  mask.Pointer = &buffers[0][0];
+  inc = numComp;
+  for (int j = 0; j < 3; ++j)
+    {
+    dilated.Increments[j] = inc;
+    inc *= outExt[2*j+1] - outExt[2*j] + 1;
+    }
+  buffers[1].resize(inc);
+  dilated.Pointer = &buffers[1][0];
+  for (int i = 0; i < 6; ++i)
+    {
+    mask.Extent[i] = inExt[i];
+    dilated.Extent[i] = outExt[i];
+    }
+
+  int rowSize = (inExt[1] - inExt[0] + 1)*numComp;
+  for (int z = 0; z <= inExt[5] - inExt[4]; ++z)
+    {
+    for (int y = 0; y <= inExt[3] - inExt[2]; ++y)
+      {
+      const T *inPtr = src.Pointer + y*src.Increments[1] +
+        z*src.Increments[2];
+      unsigned char *maskPtr = mask.Pointer + y*mask.Increments[1] +
+        z*mask.Increments[2];
+      for (int i = 0; i < rowSize; ++i)
+        {
+        maskPtr[i] = (inPtr[i] == dilate);
+        }
+      }
+    }
+
+  vtkImageBoxMorphologyExecute<unsigned char,
+    vtkImageBoxMaximum<unsigned char> >(
+      mask, dilated, numComp, kernelSize, kernelMiddle);
+
+  // the input, offset to the output extent
+  src.Pointer += (outExt[0] - inExt[0])*src.Increments[0] +
+    (outExt[2] - inExt[2])*src.Increments[1] +
+    (outExt[4] - inExt[4])*src.Increments[2];
+  rowSize = (outExt[1] - outExt[0] + 1)*numComp;
+  for (int z = 0; z <= outExt[5] - outExt[4]; ++z)
+    {
+    for (int y = 0; y <= outExt[3] - outExt[2]; ++y)
+      {
+      const T *inPtr = src.Pointer + y*src.Increments[1] +
+        z*src.Increments[2];
+      const unsigned char *maskPtr = dilated.Pointer +
+        y*dilated.Increments[1] + z*dilated.Increments[2];
+      T *outPtr = dst.Pointer + y*dst.Increments[1] + z*dst.Increments[2];
+      for (int i = 0; i < rowSize; ++i)
+        {
+        outPtr[i] = ((inPtr[i] == erode && maskPtr[i]) ? dilate : inPtr[i]);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageBoxMorphologyClipExtent(
+  const int extent[6], const int dataExt[6], int clippedExt[6])
+{
+  for (int i = 0; i < 3; ++i)
+    {
+    clippedExt[2*i] = (extent[2*i] > dataExt[2*i] ?
+                       extent[2*i] : dataExt[2*i]);
+    clippedExt[2*i+1] = (extent[2*i+1] < dataExt[2*i+1] ?
+                         extent[2*i+1] : dataExt[2*i+1]);
+    }
+}
+
+} // end anonymous namespace
+
+//----------------------------------------------------------------------------
+void vtkImageBoxMorphology::Execute(
+  vtkImageData *inData, vtkDataArray *inArray, const int inputExt[6],
+  vtkImageData *outData, const int outExt[6], const int kernelSize[3],
+  const int kernelMiddle[3], int operation)
+{
+  int inExt[6];
+  vtkImageBoxMorphologyClipExtent(inputExt, inData->GetExtent(), inExt);
+
+  switch (inArray->GetDataType())
+    {
+    vtkTemplateMacro(
+      vtkImageBoxMorphologyExecuteGrey(
+        inData, inArray, inExt, outData, outExt, kernelSize, kernelMiddle,
+        operation, static_cast<VTK_TT *>(0)));
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageBoxMorphology::ExecuteDilateErode(
+  vtkImageData *inData, vtkDataArray *inArray, const int inputExt[6],
+  vtkImageData *outData, const int outExt[6], const int kernelSize[3],
+  const int kernelMiddle[3], double dilateValue, double erodeValue)
+{
+  int inExt[6];
+  vtkImageBoxMorphologyClipExtent(inputExt, inData->GetExtent(), inExt);
+
+  switch (inArray->GetDataType())
+    {
+    vtkTemplateMacro(
+      vtkImageBoxMorphologyExecuteDilateErode(
+        inData, inArray, inExt, outData, outExt, kernelSize, kernelMiddle,
+        dilateValue, erodeValue, static_cast<VTK_TT *>(0)));
+    }
+}
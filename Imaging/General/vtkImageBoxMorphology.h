@@ -0,0 +1,81 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageBoxMorphology.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkImageBoxMorphology - Morphology with box kernels of any size
+// .SECTION Description
+// vtkImageBoxMorphology computes the maximum or minimum of an image over
+// a box kernel for the morphological filters and for vtkImageRange3D
+// when their BoxKernel option is on.  The box is separable, so it is done
+// as one pass per axis, and each pass uses the van Herk/Gil-Werman
+// algorithm: the lines are divided into blocks as long as the kernel, and
+// the running maximum forward and backward within each block give the
+// maximum over any window with two comparisons per voxel, whatever the
+// size of the kernel.
+//
+// The y and z passes work on bundles of neighboring x rows at once, so
+// that the inner loops are over contiguous memory and vectorize.  Voxels
+// outside of the input extent are ignored, like the other morphological
+// filters do at the image boundaries.
+//
+// References:
+//
+// M. van Herk. A fast algorithm for local minimum and maximum filters on
+// rectangular and octagonal kernels. Pattern Recognition Letters, 13(7).
+// pp. 517--521, 1992.
+//
+// J. Gil and M. Werman. Computing 2-D min, median, and max filters. IEEE
+// Transactions on Pattern Analysis and Machine Intelligence, 15(5).
+// pp. 504--507, 1993.
+
+#ifndef vtkImageBoxMorphology_h
+#define vtkImageBoxMorphology_h
+
+#include "vtkImagingGeneralModule.h" // For export macro
+#include "vtkSystemIncludes.h"
+
+#define VTK_IMAGE_BOX_MAXIMUM 0
+#define VTK_IMAGE_BOX_MINIMUM 1
+
+class vtkDataArray;
+class vtkImageData;
+
+class VTKIMAGINGGENERAL_EXPORT vtkImageBoxMorphology
+{
+public:
+  // Description:
+  // Set each voxel of outExt in outData to the maximum or the minimum,
+  // according to the operation, of inArray over the box of kernelSize
+  // voxels that starts kernelMiddle voxels before it.  Only the voxels
+  // within inExt and within inData are considered, and these must contain
+  // the output extent.  The output must have the same type and number of
+  // components as inArray.
+  static void Execute(vtkImageData *inData, vtkDataArray *inArray,
+                      const int inExt[6], vtkImageData *outData,
+                      const int outExt[6], const int kernelSize[3],
+                      const int kernelMiddle[3], int operation);
+
+  // Description:
+  // Binary dilation and erosion as done by vtkImageDilateErode3D: each
+  // voxel that has the erode value is set to the dilate value if there
+  // is a voxel with the dilate value in its box, and other voxels are
+  // copied.
+  static void ExecuteDilateErode(vtkImageData *inData, vtkDataArray *inArray,
+                                 const int inExt[6], vtkImageData *outData,
+                                 const int outExt[6], const int kernelSize[3],
+                                 const int kernelMiddle[3],
+                                 double dilateValue, double erodeValue);
+};
+
+#endif
+// VTK-HeaderTest-Exclude: vtkImageBoxMorphology.h
@@ -14,13 +14,17 @@
 =========================================================================*/
 #include "vtkImageEuclideanDistance.h"
 
+#include "vtkIdTypeArray.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <math.h>
+#include <vector>
 
 vtkStandardNewMacro(vtkImageEuclideanDistance);
 
@@ -32,6 +36,7 @@ vtkImageEuclideanDistance::vtkImageEuclideanDistance()
   this->Initialize = 1;
   this->ConsiderAnisotropy = 1;
   this->Algorithm = VTK_EDT_SAITO;
+  this->ComputeFeatureTransform = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -554,6 +559,154 @@ static void vtkImageEuclideanDistanceExecuteSaitoCached(
   free(temp);
   free(sq);
 }
+
+//----------------------------------------------------------------------------
+// Execute one pass of Felzenszwalb's algorithm along a set of rows.  The
+// distance at each voxel is the lower envelope of the parabolas that are
+// rooted at the voxels of the row, which is built in a single sweep.
+//
+// P. Felzenszwalb and D. Huttenlocher. Distance Transforms of Sampled
+// Functions. Theory of Computing, 8(19). pp. 415--428, 2012.
+//
+class vtkImageEuclideanDistanceFelzenszwalbFunctor
+{
+public:
+  double *OutPtr;
+  vtkIdType *FeaturePtr;
+  int Size0;
+  int Size1;
+  vtkIdType Inc0;
+  vtkIdType Inc1;
+  vtkIdType Inc2;
+  double Spacing;
+  double MaximumDistance;
+
+  void operator()(vtkIdType begin, vtkIdType end);
+};
+
+void vtkImageEuclideanDistanceFelzenszwalbFunctor::operator()(
+  vtkIdType begin, vtkIdType end)
+{
+  int n = this->Size0;
+  double spacing = this->Spacing;
+  double maxDist = this->MaximumDistance;
+  vtkIdType inc0 = this->Inc0;
+
+  // the row, the parabolas of the envelope and where each of them begins
+  std::vector<double> f(n);
+  std::vector<double> g(n);
+  std::vector<int> v(n);
+  std::vector<double> z(n);
+  std::vector<vtkIdType> features(this->FeaturePtr ? n : 0);
+
+  for (vtkIdType row = begin; row < end; ++row)
+    {
+    vtkIdType offset = (row % this->Size1)*this->Inc1 +
+                       (row / this->Size1)*this->Inc2;
+    double *outPtr0 = this->OutPtr + offset;
+
+    // build the lower envelope, skipping voxels that cannot be reached
+    int k = -1;
+    for (int q = 0; q < n; ++q)
+      {
+      f[q] = outPtr0[q*inc0];
+      if (f[q] >= maxDist)
+        {
+        continue;
+        }
+      g[q] = f[q] + spacing*q*q;
+      double s = -VTK_DOUBLE_MAX;
+      while (k >= 0)
+        {
+        s = (g[q] - g[v[k]])/(2*spacing*(q - v[k]));
+        if (s > z[k])
+          {
+          break;
+          }
+        s = -VTK_DOUBLE_MAX;
+        --k;
+        }
+      ++k;
+      v[k] = q;
+      z[k] = s;
+      }
+
+    if (k < 0)
+      {
+      continue;
+      }
+
+    if (this->FeaturePtr)
+      {
+      vtkIdType *featurePtr0 = this->FeaturePtr + offset;
+      for (int q = 0; q < n; ++q)
+        {
+        features[q] = featurePtr0[q*inc0];
+        }
+      int j = 0;
+      for (int p = 0; p < n; ++p)
+        {
+        while (j < k && z[j+1] < p)
+          {
+          ++j;
+          }
+        int d = p - v[j];
+        double m = f[v[j]] + spacing*d*d;
+        if (m < f[p])
+          {
+          outPtr0[p*inc0] = m;
+          featurePtr0[p*inc0] = features[v[j]];
+          }
+        }
+      }
+    else
+      {
+      int j = 0;
+      for (int p = 0; p < n; ++p)
+        {
+        while (j < k && z[j+1] < p)
+          {
+          ++j;
+          }
+        int d = p - v[j];
+        double m = f[v[j]] + spacing*d*d;
+        if (m < f[p])
+          {
+          outPtr0[p*inc0] = m;
+          }
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+static void vtkImageEuclideanDistanceExecuteFelzenszwalb(
+  vtkImageEuclideanDistance *self,
+  vtkImageData *outData, int outExt[6], double *outPtr,
+  vtkIdType *featurePtr, double spacing)
+{
+  int outMin0, outMax0, outMin1, outMax1, outMin2, outMax2;
+  vtkIdType outInc0, outInc1, outInc2;
+
+  self->PermuteExtent(outExt, outMin0,outMax0,outMin1,outMax1,outMin2,outMax2);
+  self->PermuteIncrements(outData->GetIncrements(), outInc0, outInc1, outInc2);
+
+  vtkImageEuclideanDistanceFelzenszwalbFunctor functor;
+  functor.OutPtr = outPtr;
+  functor.FeaturePtr = featurePtr;
+  functor.Size0 = outMax0 - outMin0 + 1;
+  functor.Size1 = outMax1 - outMin1 + 1;
+  functor.Inc0 = outInc0;
+  functor.Inc1 = outInc1;
+  functor.Inc2 = outInc2;
+  functor.Spacing = spacing*spacing;
+  functor.MaximumDistance = self->GetMaximumDistance();
+
+  vtkIdType numRows = static_cast<vtkIdType>(functor.Size1)*
+    (outMax2 - outMin2 + 1);
+  vtkSMPTools::For(0, numRows, functor);
+}
+
 //----------------------------------------------------------------------------
 void vtkImageEuclideanDistance::AllocateOutputScalars(vtkImageData *outData,
                                                       int outExt[6],
@@ -612,6 +765,18 @@ int vtkImageEuclideanDistance::IterativeRequestData(
     return 1;
     }
 
+  bool computeFeatures = (this->ComputeFeatureTransform != 0);
+  if (computeFeatures && this->Algorithm != VTK_EDT_FELZENSZWALB)
+    {
+    if (this->GetIteration() == 0)
+      {
+      vtkWarningMacro(<< "Execute: The feature transform needs the "
+                      "Felzenszwalb algorithm");
+      }
+    computeFeatures = false;
+    }
+  outData->GetPointData()->RemoveArray("FeatureIndex");
+
   if ( this->GetIteration() == 0 )
     {
     switch (inData->GetScalarType())
@@ -641,6 +806,43 @@ int vtkImageEuclideanDistance::IterativeRequestData(
         }
     }
 
+  // The feature transform starts with each voxel that is within reach
+  // pointing to itself, and is then carried from one iteration to the next.
+  vtkIdType *featurePtr = 0;
+  if (computeFeatures)
+    {
+    vtkIdTypeArray *features = vtkIdTypeArray::New();
+    features->SetName("FeatureIndex");
+    if ( this->GetIteration() == 0 )
+      {
+      vtkIdType n = outData->GetNumberOfPoints();
+      double maxDist = this->MaximumDistance;
+      double *distPtr = static_cast<double *>(outPtr);
+      features->SetNumberOfValues(n);
+      featurePtr = features->GetPointer(0);
+      for (vtkIdType i = 0; i < n; ++i)
+        {
+        featurePtr[i] = (distPtr[i] < maxDist ? i : -1);
+        }
+      }
+    else
+      {
+      vtkIdTypeArray *inFeatures = vtkIdTypeArray::SafeDownCast(
+        inData->GetPointData()->GetArray("FeatureIndex"));
+      if (!inFeatures ||
+          inFeatures->GetNumberOfTuples() != outData->GetNumberOfPoints())
+        {
+        vtkErrorMacro(<< "Execute: Missing feature transform");
+        features->Delete();
+        return 1;
+        }
+      features->DeepCopy(inFeatures);
+      featurePtr = features->GetPointer(0);
+      }
+    outData->GetPointData()->AddArray(features);
+    features->Delete();
+    }
+
   // Call the specific algorithms.
   switch( this->GetAlgorithm() )
     {
@@ -652,6 +854,21 @@ int vtkImageEuclideanDistance::IterativeRequestData(
       vtkImageEuclideanDistanceExecuteSaitoCached( this, outData, outExt,
                                                    static_cast<double *>(outPtr) );
       break;
+    case VTK_EDT_FELZENSZWALB:
+      {
+      // the spacing is taken from the pipeline, since it has not been
+      // set on the output yet
+      double spacing = 1.0;
+      if ( this->ConsiderAnisotropy &&
+           outInfo->Has(vtkDataObject::SPACING()) )
+        {
+        spacing = outInfo->Get(vtkDataObject::SPACING())[this->Iteration];
+        }
+      vtkImageEuclideanDistanceExecuteFelzenszwalb( this, outData, outExt,
+                                                    static_cast<double *>(outPtr),
+                                                    featurePtr, spacing );
+      }
+      break;
     default:
       vtkErrorMacro(<< "Execute: Unknown Algorithm");
     }
@@ -747,10 +964,17 @@ void vtkImageEuclideanDistance::PrintSelf(ostream& os, vtkIndent indent)
     {
     os << "Saito\n";
     }
+  else if ( this->Algorithm == VTK_EDT_FELZENSZWALB )
+    {
+    os << "Felzenszwalb\n";
+    }
   else
     {
     os << "Saito Cached\n";
     }
+
+  os << indent << "Compute Feature Transform: "
+     << (this->ComputeFeatureTransform ? "On\n" : "Off\n");
 }
 
 
@@ -29,6 +29,13 @@
 // slow it very significantly. In that case, one should use
 // ::SetAlgorithmToSaitoCached() instead for better performance.
 //
+// The Felzenszwalb algorithm computes the exact distance in linear time
+// per row, as the lower envelope of the parabolas rooted at each voxel of
+// the row, so its cost does not depend on the distances in the image.
+// The rows of each pass are processed in parallel via vtkSMPTools.  This
+// algorithm can also compute the feature transform, i.e. the index of the
+// nearest zero voxel, see ComputeFeatureTransform.
+//
 // References:
 //
 // T. Saito and J.I. Toriwaki. New algorithms for Euclidean distance
@@ -38,6 +45,9 @@
 // O. Cuisenaire. Distance Transformation: fast algorithms and applications
 // to medical image processing. PhD Thesis, Universite catholique de Louvain,
 // October 1999. http://ltswww.epfl.ch/~cuisenai/papers/oc_thesis.pdf
+//
+// P. Felzenszwalb and D. Huttenlocher. Distance Transforms of Sampled
+// Functions. Theory of Computing, 8(19). pp. 415--428, 2012.
 
 
 #ifndef vtkImageEuclideanDistance_h
@@ -48,6 +58,7 @@
 
 #define VTK_EDT_SAITO_CACHED 0
 #define VTK_EDT_SAITO 1
+#define VTK_EDT_FELZENSZWALB 2
 
 class VTKIMAGINGGENERAL_EXPORT vtkImageEuclideanDistance : public vtkImageDecomposeFilter
 {
@@ -93,13 +104,26 @@ public:
   // Selects a Euclidean DT algorithm.
   // 1. Saito
   // 2. Saito-cached
-  // More algorithms will be added later on.
+  // 3. Felzenszwalb
   vtkSetMacro(Algorithm, int);
   vtkGetMacro(Algorithm, int);
   void SetAlgorithmToSaito ()
     { this->SetAlgorithm(VTK_EDT_SAITO); }
   void SetAlgorithmToSaitoCached ()
     { this->SetAlgorithm(VTK_EDT_SAITO_CACHED); }
+  void SetAlgorithmToFelzenszwalb ()
+    { this->SetAlgorithm(VTK_EDT_FELZENSZWALB); }
+
+  // Description:
+  // Also compute the feature transform, which is added to the output as
+  // a vtkIdTypeArray called "FeatureIndex".  For each voxel, it holds the
+  // point id (within the output extent) of the nearest voxel whose initial
+  // distance was below MaximumDistance, i.e. the nearest zero voxel if
+  // Initialize is on, or -1 if there is no such voxel within the maximum
+  // distance.  This is only supported by the Felzenszwalb algorithm.
+  vtkSetMacro(ComputeFeatureTransform, int);
+  vtkGetMacro(ComputeFeatureTransform, int);
+  vtkBooleanMacro(ComputeFeatureTransform, int);
 
   virtual int IterativeRequestData(vtkInformation*,
                                    vtkInformationVector**,
@@ -113,6 +137,7 @@ protected:
   int Initialize;
   int ConsiderAnisotropy;
   int Algorithm;
+  int ComputeFeatureTransform;
 
   // Replaces "EnlargeOutputUpdateExtent"
   virtual void AllocateOutputScalars(vtkImageData *outData,
@@ -17,10 +17,20 @@
 #include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <math.h>
+#include <vector>
+
+// The number of lines that the recursive filter does together.
+#define VTK_GAUSSIAN_RECURSIVE_LINES 8
+
+// Below this standard deviation the recursive filter is a poor fit of the
+// sampled gaussian, so the truncated kernel is used instead.
+#define VTK_GAUSSIAN_RECURSIVE_MIN_STD 1.0
 
 vtkStandardNewMacro(vtkImageGaussianSmooth);
 
@@ -34,6 +44,7 @@ vtkImageGaussianSmooth::vtkImageGaussianSmooth()
   this->RadiusFactors[0] = 1.5;
   this->RadiusFactors[1] = 1.5;
   this->RadiusFactors[2] = 1.5;
+  this->RecursiveFilter = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -61,6 +72,9 @@ void vtkImageGaussianSmooth::PrintSelf(ostream& os, vtkIndent indent)
      << this->StandardDeviations[0] << ", "
      << this->StandardDeviations[1] << ", "
      << this->StandardDeviations[2] << " )\n";
+
+  os << indent << "RecursiveFilter: "
+     << (this->RecursiveFilter ? "On\n" : "Off\n");
 }
 
 //----------------------------------------------------------------------------
@@ -125,6 +139,13 @@ void vtkImageGaussianSmooth::InternalRequestUpdateExtent(int *inExt,
   // Expand filtered axes
   for (idx = 0; idx < this->Dimensionality; ++idx)
     {
+    if (this->RecursiveFilter)
+      {
+      // the recursive filter needs whole lines
+      inExt[idx*2] = wholeExtent[idx*2];
+      inExt[idx*2+1] = wholeExtent[idx*2+1];
+      continue;
+      }
     radius = static_cast<int>(this->StandardDeviations[idx]
                               * this->RadiusFactors[idx]);
     inExt[idx*2] -= radius;
@@ -461,3 +482,645 @@ void vtkImageGaussianSmooth::ThreadedRequestData(
       break;
     }
 }
+
+//----------------------------------------------------------------------------
+// The recursive filter for one axis (Young and van Vliet, "Recursive
+// implementation of the Gaussian filter", Signal Processing 44, 1995,
+// with the poles and scaling of van Vliet, Young and Verbeek, "Recursive
+// Gaussian derivative filters", ICPR 1998).
+// A causal pass w[i] = B x[i] + a1 w[i-1] + a2 w[i-2] + a3 w[i-3] is
+// followed by the same pass backwards. The line is padded with zeros:
+// the causal pass starts from zero, and the backward pass starts from the
+// exact continuation of the causal pass into the padding (Triggs and
+// Sdika, IEEE Trans. Signal Processing 54, 2006). The result is divided
+// by the response to a line of ones, which renormalizes the filter at the
+// ends of the line like the truncated kernel is renormalized. For small
+// standard deviations the lines are convolved with the truncated kernel.
+class vtkImageGaussianSmoothLineFilter
+{
+public:
+  vtkImageGaussianSmoothLineFilter() : B(1.0), Size(0), Radius(0) {}
+
+  void Initialize(double sigma, int radius, int n);
+
+  // Filter a group of lines in place. Value l of position i of the
+  // group is at p[i*step + l].
+  void Execute(double *p, vtkIdType step, int lines) const;
+
+  int GetSize() const { return this->Size; }
+
+protected:
+  double B;
+  double A[3];
+  // Maps the last three values of the causal pass to the first three
+  // values of the backward pass beyond the end of the line.
+  double M[3][3];
+  int Size;
+  std::vector<double> InverseNorm;
+  // The kernel, if the recursive filter is not used.
+  int Radius;
+  std::vector<double> Kernel;
+
+  void InitializeRecursive(double sigma);
+  void ExecuteKernel(double *p, vtkIdType step, int lines) const;
+};
+
+//----------------------------------------------------------------------------
+void vtkImageGaussianSmoothLineFilter::Initialize(double sigma, int radius,
+                                                  int n)
+{
+  this->Size = n;
+  this->Kernel.clear();
+  if (sigma < VTK_GAUSSIAN_RECURSIVE_MIN_STD)
+    {
+    this->Radius = radius;
+    this->Kernel.resize(2*radius + 1);
+    for (int k = -radius; k <= radius; ++k)
+      {
+      this->Kernel[k + radius] = (sigma == 0.0 ? (k == 0) :
+        exp(-static_cast<double>(k*k)/(sigma*sigma*2.0)));
+      }
+    }
+  else
+    {
+    this->InitializeRecursive(sigma);
+    }
+
+  // The response to a line of ones.
+  this->InverseNorm.assign(n, 1.0);
+  std::vector<double> ones(n, 1.0);
+  this->Execute(&ones[0], 1, 1);
+  for (int i = 0; i < n; ++i)
+    {
+    this->InverseNorm[i] = 1.0/ones[i];
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageGaussianSmoothLineFilter::InitializeRecursive(double sigma)
+{
+  // The poles for a standard deviation of 2, in the z^-1 plane, are
+  // scaled by the power 1/q that gives the exact variance sigma^2. The
+  // variance of the forward-backward filter is the sum of 2d/(d-1)^2 over
+  // the poles d.
+  const double d1Abs0 = sqrt(1.41650*1.41650 + 1.00829*1.00829);
+  const double d1Arg0 = atan2(1.00829, 1.41650);
+  const double d30 = 1.86543;
+  double d1Abs = d1Abs0;
+  double d1Arg = d1Arg0;
+  double d3 = d30;
+  double q = sigma/2.0;
+  for (int iter = 0; iter < 20; ++iter)
+    {
+    d1Abs = pow(d1Abs0, 1.0/q);
+    d1Arg = d1Arg0/q;
+    d3 = pow(d30, 1.0/q);
+    double re = d1Abs*cos(d1Arg);
+    double im = d1Abs*sin(d1Arg);
+    // 2d/(d-1)^2 for the complex pole, the conjugate adds the same real
+    // part again
+    double er = re - 1.0;
+    double ei = im;
+    double denRe = er*er - ei*ei;
+    double denIm = 2.0*er*ei;
+    double den2 = denRe*denRe + denIm*denIm;
+    double variance = 4.0*(re*denRe + im*denIm)/den2 +
+      2.0*d3/((d3 - 1.0)*(d3 - 1.0));
+    double ratio = sigma/sqrt(variance);
+    q *= ratio;
+    if (fabs(ratio - 1.0) < 1e-12)
+      {
+      break;
+      }
+    }
+  d1Abs = pow(d1Abs0, 1.0/q);
+  d1Arg = d1Arg0/q;
+  d3 = pow(d30, 1.0/q);
+  double d1Re = d1Abs*cos(d1Arg);
+  double scale = 1.0/(d1Abs*d1Abs*d3);
+  this->A[0] = (d1Abs*d1Abs + 2.0*d1Re*d3)*scale;
+  this->A[1] = -(2.0*d1Re + d3)*scale;
+  this->A[2] = scale;
+  this->B = 1.0 - (this->A[0] + this->A[1] + this->A[2]);
+
+  // Run the filter into the zero padding for each of the three possible
+  // last causal values, until the values have decayed.
+  for (int j = 0; j < 3; ++j)
+    {
+    std::vector<double> w(3, 0.0);
+    w[2 - j] = 1.0;
+    double last = 1.0;
+    while (last > 1e-20 || w.size() < 6)
+      {
+      size_t k = w.size();
+      w.push_back(this->A[0]*w[k-1] + this->A[1]*w[k-2] + this->A[2]*w[k-3]);
+      last = fabs(w[k]) + fabs(w[k-1]) + fabs(w[k-2]);
+      if (k > 1000000)
+        {
+        break;
+        }
+      }
+    double y1 = 0.0;
+    double y2 = 0.0;
+    double y3 = 0.0;
+    for (size_t k = w.size() - 1; k >= 3; --k)
+      {
+      double y = this->B*w[k] + this->A[0]*y1 + this->A[1]*y2 +
+        this->A[2]*y3;
+      y3 = y2;
+      y2 = y1;
+      y1 = y;
+      }
+    this->M[0][j] = y1;
+    this->M[1][j] = y2;
+    this->M[2][j] = y3;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageGaussianSmoothLineFilter::Execute(double *p, vtkIdType step,
+                                        int lines) const
+{
+  if (!this->Kernel.empty())
+    {
+    this->ExecuteKernel(p, step, lines);
+    return;
+    }
+
+  const int n = this->Size;
+  const double b = this->B;
+  const double a1 = this->A[0];
+  const double a2 = this->A[1];
+  const double a3 = this->A[2];
+  double s1[VTK_GAUSSIAN_RECURSIVE_LINES];
+  double s2[VTK_GAUSSIAN_RECURSIVE_LINES];
+  double s3[VTK_GAUSSIAN_RECURSIVE_LINES];
+
+  // the causal pass, the lines are independent so the inner loop
+  // can be vectorized
+  for (int l = 0; l < lines; ++l)
+    {
+    s1[l] = 0.0;
+    s2[l] = 0.0;
+    s3[l] = 0.0;
+    }
+  double *q = p;
+  for (int i = 0; i < n; ++i)
+    {
+    for (int l = 0; l < lines; ++l)
+      {
+      double v = b*q[l] + a1*s1[l] + a2*s2[l] + a3*s3[l];
+      s3[l] = s2[l];
+      s2[l] = s1[l];
+      s1[l] = v;
+      q[l] = v;
+      }
+    q += step;
+    }
+
+  // the backward pass
+  for (int l = 0; l < lines; ++l)
+    {
+    double w1 = s1[l];
+    double w2 = s2[l];
+    double w3 = s3[l];
+    s1[l] = this->M[0][0]*w1 + this->M[0][1]*w2 + this->M[0][2]*w3;
+    s2[l] = this->M[1][0]*w1 + this->M[1][1]*w2 + this->M[1][2]*w3;
+    s3[l] = this->M[2][0]*w1 + this->M[2][1]*w2 + this->M[2][2]*w3;
+    }
+  for (int i = n - 1; i >= 0; --i)
+    {
+    q -= step;
+    double f = this->InverseNorm[i];
+    for (int l = 0; l < lines; ++l)
+      {
+      double v = b*q[l] + a1*s1[l] + a2*s2[l] + a3*s3[l];
+      s3[l] = s2[l];
+      s2[l] = s1[l];
+      s1[l] = v;
+      q[l] = v*f;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageGaussianSmoothLineFilter::ExecuteKernel(double *p,
+                                                     vtkIdType step,
+                                                     int lines) const
+{
+  const int n = this->Size;
+  const int radius = this->Radius;
+  std::vector<double> copy(static_cast<size_t>(n)*lines);
+  for (int i = 0; i < n; ++i)
+    {
+    for (int l = 0; l < lines; ++l)
+      {
+      copy[i*lines + l] = p[i*step + l];
+      }
+    }
+  for (int i = 0; i < n; ++i)
+    {
+    int kmin = (i - radius < 0 ? -i : -radius);
+    int kmax = (i + radius >= n ? n - 1 - i : radius);
+    double *q = p + i*step;
+    for (int l = 0; l < lines; ++l)
+      {
+      q[l] = 0.0;
+      }
+    for (int k = kmin; k <= kmax; ++k)
+      {
+      double w = this->Kernel[k + radius];
+      const double *c = &copy[(i + k)*lines];
+      for (int l = 0; l < lines; ++l)
+        {
+        q[l] += w*c[l];
+        }
+      }
+    double f = this->InverseNorm[i];
+    for (int l = 0; l < lines; ++l)
+      {
+      q[l] *= f;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Copy between the image and the buffer of the recursive filter, which
+// holds doubles with the components in separate blocks.
+template <class T>
+void vtkImageGaussianSmoothCopyIn(vtkImageData *inData, T *inPtr,
+                                  double *buffer, const int bufExt[6],
+                                  int numComp, int idx2)
+{
+  vtkIdType inc[3];
+  inData->GetIncrements(inc);
+  int n0 = bufExt[1] - bufExt[0] + 1;
+  int n1 = bufExt[3] - bufExt[2] + 1;
+  vtkIdType blockSize =
+    static_cast<vtkIdType>(n0)*n1*(bufExt[5] - bufExt[4] + 1);
+  for (int idx1 = 0; idx1 < n1; ++idx1)
+    {
+    T *ptr = inPtr + idx1*inc[1] + idx2*inc[2];
+    double *out = buffer + (static_cast<vtkIdType>(idx2)*n1 + idx1)*n0;
+    for (int idx0 = 0; idx0 < n0; ++idx0)
+      {
+      for (int c = 0; c < numComp; ++c)
+        {
+        out[c*blockSize] = static_cast<double>(ptr[c]);
+        }
+      ptr += inc[0];
+      ++out;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageGaussianSmoothCopyOut(const double *buffer,
+                                   const int bufExt[6],
+                                   vtkImageData *outData, T *outPtr,
+                                   const int outExt[6], int numComp,
+                                   int idx2)
+{
+  vtkIdType inc[3];
+  outData->GetIncrements(inc);
+  int n0 = bufExt[1] - bufExt[0] + 1;
+  int n1 = bufExt[3] - bufExt[2] + 1;
+  vtkIdType blockSize =
+    static_cast<vtkIdType>(n0)*n1*(bufExt[5] - bufExt[4] + 1);
+  for (int idx1 = outExt[2]; idx1 <= outExt[3]; ++idx1)
+    {
+    T *ptr = outPtr + (idx1 - outExt[2])*inc[1] + (idx2 - outExt[4])*inc[2];
+    const double *in = buffer +
+      (static_cast<vtkIdType>(idx2 - bufExt[4])*n1 + (idx1 - bufExt[2]))*n0 +
+      (outExt[0] - bufExt[0]);
+    for (int idx0 = outExt[0]; idx0 <= outExt[1]; ++idx0)
+      {
+      for (int c = 0; c < numComp; ++c)
+        {
+        ptr[c] = static_cast<T>(in[c*blockSize]);
+        }
+      ptr += inc[0];
+      ++in;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// The work of the recursive filter, as independent jobs: copying a slice
+// into or out of the buffer, or filtering a group of lines.
+class vtkImageGaussianSmoothRecursiveFunctor
+{
+public:
+  enum { COPY_IN, FILTER, COPY_OUT };
+
+  int Task;
+  vtkImageData *Data;
+  void *DataPointer;
+  int DataExtent[6];
+  double *Buffer;
+  int BufferExtent[6];
+  int NumberOfComponents;
+  // For FILTER: the axis, its filter, and the ranges of the other axes
+  int Axis;
+  const vtkImageGaussianSmoothLineFilter *Filter;
+  int Range[6];
+
+  // The number of jobs of the current task.
+  vtkIdType GetNumberOfJobs()
+  {
+    if (this->Task == COPY_IN)
+      {
+      return this->BufferExtent[5] - this->BufferExtent[4] + 1;
+      }
+    else if (this->Task == COPY_OUT)
+      {
+      return this->DataExtent[5] - this->DataExtent[4] + 1;
+      }
+    int inner = (this->Axis == 0 ? 1 : 0);
+    int outer = 3 - this->Axis - inner;
+    vtkIdType groups = (this->Range[2*inner+1] - this->Range[2*inner] +
+                        VTK_GAUSSIAN_RECURSIVE_LINES)/
+                       VTK_GAUSSIAN_RECURSIVE_LINES;
+    return groups*(this->Range[2*outer+1] - this->Range[2*outer] + 1)*
+      this->NumberOfComponents;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    if (this->Task == COPY_IN)
+      {
+      for (vtkIdType job = begin; job < end; ++job)
+        {
+        switch (this->Data->GetScalarType())
+          {
+          vtkTemplateMacro(
+            vtkImageGaussianSmoothCopyIn(
+              this->Data, static_cast<VTK_TT *>(this->DataPointer),
+              this->Buffer,
+              this->BufferExtent, this->NumberOfComponents,
+              static_cast<int>(job)));
+          }
+        }
+      return;
+      }
+    if (this->Task == COPY_OUT)
+      {
+      for (vtkIdType job = begin; job < end; ++job)
+        {
+        switch (this->Data->GetScalarType())
+          {
+          vtkTemplateMacro(
+            vtkImageGaussianSmoothCopyOut(
+              this->Buffer, this->BufferExtent, this->Data,
+              static_cast<VTK_TT *>(this->DataPointer), this->DataExtent,
+              this->NumberOfComponents,
+              this->DataExtent[4] + static_cast<int>(job)));
+          }
+        }
+      return;
+      }
+
+    const int *e = this->BufferExtent;
+    vtkIdType stride[4];
+    stride[0] = 1;
+    stride[1] = e[1] - e[0] + 1;
+    stride[2] = stride[1]*(e[3] - e[2] + 1);
+    stride[3] = stride[2]*(e[5] - e[4] + 1);
+    int axis = this->Axis;
+    int inner = (axis == 0 ? 1 : 0);
+    int outer = 3 - axis - inner;
+    int n = this->Filter->GetSize();
+    int innerSize = this->Range[2*inner+1] - this->Range[2*inner] + 1;
+    int outerSize = this->Range[2*outer+1] - this->Range[2*outer] + 1;
+    vtkIdType groups = (innerSize + VTK_GAUSSIAN_RECURSIVE_LINES - 1)/
+      VTK_GAUSSIAN_RECURSIVE_LINES;
+
+    // lines along x are copied into a group with interleaved values
+    std::vector<double> work;
+    if (axis == 0)
+      {
+      work.resize(static_cast<size_t>(n)*VTK_GAUSSIAN_RECURSIVE_LINES);
+      }
+
+    for (vtkIdType job = begin; job < end; ++job)
+      {
+      vtkIdType group = job % groups;
+      vtkIdType rest = job / groups;
+      int outerIdx = static_cast<int>(rest % outerSize) + this->Range[2*outer];
+      int c = static_cast<int>(rest / outerSize);
+      int innerIdx = this->Range[2*inner] +
+        static_cast<int>(group)*VTK_GAUSSIAN_RECURSIVE_LINES;
+      int lines = this->Range[2*inner+1] - innerIdx + 1;
+      if (lines > VTK_GAUSSIAN_RECURSIVE_LINES)
+        {
+        lines = VTK_GAUSSIAN_RECURSIVE_LINES;
+        }
+      double *ptr = this->Buffer + c*stride[3] +
+        (outerIdx - e[2*outer])*stride[outer] +
+        (innerIdx - e[2*inner])*stride[inner];
+
+      if (axis != 0)
+        {
+        // the lines of the group are next to each other in memory
+        this->Filter->Execute(ptr, stride[axis], lines);
+        }
+      else
+        {
+        for (int l = 0; l < lines; ++l)
+          {
+          const double *lptr = ptr + l*stride[inner];
+          double *w = &work[l];
+          for (int i = 0; i < n; ++i)
+            {
+            *w = lptr[i];
+            w += VTK_GAUSSIAN_RECURSIVE_LINES;
+            }
+          }
+        this->Filter->Execute(&work[0], VTK_GAUSSIAN_RECURSIVE_LINES, lines);
+        for (int l = 0; l < lines; ++l)
+          {
+          double *lptr = ptr + l*stride[inner];
+          const double *w = &work[l];
+          for (int i = 0; i < n; ++i)
+            {
+            lptr[i] = *w;
+            w += VTK_GAUSSIAN_RECURSIVE_LINES;
+            }
+          }
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+struct vtkImageGaussianSmoothThreadStruct
+{
+  vtkImageGaussianSmoothRecursiveFunctor *Functor;
+  vtkIdType NumberOfJobs;
+};
+
+//----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkImageGaussianSmoothThreadedExecute(
+  void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkImageGaussianSmoothThreadStruct *str =
+    static_cast<vtkImageGaussianSmoothThreadStruct *>(info->UserData);
+  vtkIdType n = str->NumberOfJobs;
+  vtkIdType begin = n*info->ThreadID/info->NumberOfThreads;
+  vtkIdType end = n*(info->ThreadID + 1)/info->NumberOfThreads;
+  if (begin < end)
+    {
+    (*str->Functor)(begin, end);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// Smooth with the recursive filter. Every step is split into jobs that
+// run through vtkSMPTools if EnableSMP is on, and on NumberOfThreads
+// threads otherwise.
+void vtkImageGaussianSmooth::ExecuteRecursive(vtkImageData *inData,
+                                              int inExt[6],
+                                              vtkImageData *outData,
+                                              int outExt[6])
+{
+  int numComp = inData->GetNumberOfScalarComponents();
+  vtkIdType bufferSize = numComp;
+  for (int i = 0; i < 3; ++i)
+    {
+    bufferSize *= inExt[2*i+1] - inExt[2*i] + 1;
+    }
+  double *buffer = new double[bufferSize];
+
+  vtkImageGaussianSmoothRecursiveFunctor functor;
+  functor.Buffer = buffer;
+  memcpy(functor.BufferExtent, inExt, sizeof(int)*6);
+  functor.NumberOfComponents = numComp;
+  functor.Axis = 0;
+  functor.Filter = 0;
+
+  // the steps: copy in, smooth z, y, x, copy out
+  int axes[3];
+  int numAxes = 0;
+  for (int axis = 2; axis >= 0; --axis)
+    {
+    // nothing to do if the kernel would be a single voxel
+    if (axis < this->Dimensionality &&
+        (this->StandardDeviations[axis] >= VTK_GAUSSIAN_RECURSIVE_MIN_STD ||
+         static_cast<int>(this->StandardDeviations[axis]*
+                          this->RadiusFactors[axis]) > 0))
+      {
+      axes[numAxes++] = axis;
+      }
+    }
+
+  // the other axes that a pass covers: all of the buffer for the axes that
+  // are still to be smoothed, only the output for the others
+  int range[6];
+  memcpy(range, inExt, sizeof(int)*6);
+
+  vtkImageGaussianSmoothLineFilter filter;
+  int numSteps = numAxes + 2;
+  for (int step = 0; step < numSteps && !this->AbortExecute; ++step)
+    {
+    if (step == 0)
+      {
+      functor.Task = vtkImageGaussianSmoothRecursiveFunctor::COPY_IN;
+      functor.Data = inData;
+      functor.DataPointer = inData->GetScalarPointerForExtent(inExt);
+      memcpy(functor.DataExtent, inExt, sizeof(int)*6);
+      }
+    else if (step == numSteps - 1)
+      {
+      functor.Task = vtkImageGaussianSmoothRecursiveFunctor::COPY_OUT;
+      functor.Data = outData;
+      functor.DataPointer = outData->GetScalarPointerForExtent(outExt);
+      memcpy(functor.DataExtent, outExt, sizeof(int)*6);
+      }
+    else
+      {
+      int axis = axes[step - 1];
+      filter.Initialize(this->StandardDeviations[axis],
+                        static_cast<int>(this->StandardDeviations[axis]*
+                                         this->RadiusFactors[axis]),
+                        inExt[2*axis+1] - inExt[2*axis] + 1);
+      functor.Task = vtkImageGaussianSmoothRecursiveFunctor::FILTER;
+      functor.Axis = axis;
+      functor.Filter = &filter;
+      memcpy(functor.Range, range, sizeof(int)*6);
+      range[2*axis] = outExt[2*axis];
+      range[2*axis+1] = outExt[2*axis+1];
+      }
+
+    vtkIdType numJobs = functor.GetNumberOfJobs();
+    if (this->EnableSMP)
+      {
+      vtkSMPTools::For(0, numJobs, functor);
+      }
+    else
+      {
+      vtkImageGaussianSmoothThreadStruct str;
+      str.Functor = &functor;
+      str.NumberOfJobs = numJobs;
+      this->Threader->SetNumberOfThreads(this->NumberOfThreads);
+      this->Threader->SetSingleMethod(
+        vtkImageGaussianSmoothThreadedExecute, &str);
+      this->Threader->SingleMethodExecute();
+      }
+
+    this->UpdateProgress(static_cast<double>(step + 1)/numSteps);
+    }
+
+  delete [] buffer;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageGaussianSmooth::RequestData(
+  vtkInformation *request,
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
+  if (!this->RecursiveFilter)
+    {
+    return this->Superclass::RequestData(request, inputVector, outputVector);
+    }
+
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkImageData *inData = vtkImageData::GetData(inInfo);
+  vtkImageData *outData = vtkImageData::GetData(outInfo);
+
+  int outExt[6];
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), outExt);
+  this->AllocateOutputData(outData, outInfo, outExt);
+  this->CopyAttributeData(inData, outData, inputVector);
+
+  if (inData->GetScalarType() != outData->GetScalarType())
+    {
+    vtkErrorMacro("Execute: input ScalarType, "
+                  << inData->GetScalarType()
+                  << ", must match out ScalarType "
+                  << outData->GetScalarType());
+    return 1;
+    }
+  if (outExt[0] > outExt[1] || outExt[2] > outExt[3] || outExt[4] > outExt[5])
+    {
+    return 1;
+    }
+
+  int wholeExt[6], inExt[6];
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
+  memcpy(inExt, outExt, sizeof(int)*6);
+  this->InternalRequestUpdateExtent(inExt, wholeExt);
+
+  // always shut off debugging to avoid threading problems with GetMacros
+  bool debug = (this->Debug != 0);
+  this->Debug = false;
+  this->ExecuteRecursive(inData, inExt, outData, outExt);
+  this->Debug = debug;
+
+  return 1;
+}
@@ -16,6 +16,19 @@
 // .SECTION Description
 // vtkImageGaussianSmooth implements a convolution of the input image
 // with a gaussian. Supports from one to three dimensional convolutions.
+//
+// By default every axis is convolved with a kernel that is truncated at
+// StandardDeviation * RadiusFactor, so the cost grows with the width of
+// the blur. With RecursiveFilter on, every axis is instead filtered with
+// the third order recursive approximation of Young and van Vliet, whose
+// cost per voxel does not depend on the standard deviation, and which
+// approximates the untruncated gaussian. Its result differs from that of
+// the kernel with RadiusFactors of 4 or more by less than 2% of the range
+// of the input, and by less than 0.5% for standard deviations of 4 or
+// more. Axes whose standard deviation is below 1, where the recursive
+// filter is a poor fit, still use the kernel. Because the recursive
+// filter needs whole lines, it asks for the whole input extent along the
+// smoothed axes.
 
 #ifndef vtkImageGaussianSmooth_h
 #define vtkImageGaussianSmooth_h
@@ -70,6 +83,13 @@ public:
   vtkSetMacro(Dimensionality, int);
   vtkGetMacro(Dimensionality, int);
 
+  // Description:
+  // Use a recursive (IIR) filter instead of a truncated kernel, see the
+  // description above. It is off by default.
+  vtkSetMacro(RecursiveFilter, int);
+  vtkBooleanMacro(RecursiveFilter, int);
+  vtkGetMacro(RecursiveFilter, int);
+
 protected:
   vtkImageGaussianSmooth();
   ~vtkImageGaussianSmooth();
@@ -77,6 +97,7 @@ protected:
   int Dimensionality;
   double StandardDeviations[3];
   double RadiusFactors[3];
+  int RecursiveFilter;
 
   void ComputeKernel(double *kernel, int min, int max, double std);
   virtual int RequestUpdateExtent (vtkInformation *, vtkInformationVector **, vtkInformationVector *);
@@ -91,6 +112,12 @@ protected:
                            vtkImageData ***inData, vtkImageData **outData,
                            int outExt[6], int id);
 
+  virtual int RequestData(vtkInformation *request,
+                          vtkInformationVector **inputVector,
+                          vtkInformationVector *outputVector);
+  void ExecuteRecursive(vtkImageData *inData, int inExt[6],
+                        vtkImageData *outData, int outExt[6]);
+
 private:
   vtkImageGaussianSmooth(const vtkImageGaussianSmooth&);  // Not implemented.
   void operator=(const vtkImageGaussianSmooth&);  // Not implemented.
@@ -23,6 +23,13 @@
 #include "vtkPointData.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+// The most memory that the column histograms of one thread may use.
+#define VTK_IMAGE_MEDIAN3D_MAX_HISTOGRAM_BYTES 67108864
+
 vtkStandardNewMacro(vtkImageMedian3D);
 
 //-----------------------------------------------------------------------------
@@ -30,6 +37,7 @@ vtkStandardNewMacro(vtkImageMedian3D);
 vtkImageMedian3D::vtkImageMedian3D()
 {
   this->NumberOfElements = 0;
+  this->Algorithm = VTK_IMAGE_MEDIAN3D_SORT;
   this->SetKernelSize(1,1,1);
   this->HandleBoundaries = 1;
 }
@@ -45,6 +53,21 @@ void vtkImageMedian3D::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
 
   os << indent << "NumberOfElements: " << this->NumberOfElements << endl;
+  os << indent << "Algorithm: " << this->GetAlgorithmAsString() << endl;
+}
+
+//-----------------------------------------------------------------------------
+const char *vtkImageMedian3D::GetAlgorithmAsString()
+{
+  switch (this->Algorithm)
+    {
+    case VTK_IMAGE_MEDIAN3D_SORT:
+      return "Sort";
+    case VTK_IMAGE_MEDIAN3D_HISTOGRAM:
+      return "Histogram";
+    default:
+      return "";
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -369,6 +392,374 @@ void vtkImageMedian3DExecute(vtkImageMedian3D *self,
   delete [] Sort;
 }
 
+//-----------------------------------------------------------------------------
+// The part of the input that the neighborhoods of the output voxels
+// lo..hi along one axis cover, clipped by the input extent.
+static void vtkImageMedian3DHoodRange(int lo, int hi, int middle, int size,
+                                      int inMin, int inMax,
+                                      int &hoodLo, int &hoodHi)
+{
+  hoodLo = lo - middle;
+  hoodHi = hi - middle + size - 1;
+  hoodLo = (hoodLo > inMin ? hoodLo : inMin);
+  hoodHi = (hoodHi < inMax ? hoodHi : inMax);
+}
+
+//-----------------------------------------------------------------------------
+// Compute the median of every neighborhood with a selection algorithm,
+// which needs linear instead of n log n time in the kernel volume.
+template <class T>
+void vtkImageMedian3DSelectExecute(vtkImageMedian3D *self,
+                                   vtkImageData *inData, T *inPtr,
+                                   vtkImageData *outData, T *outPtr,
+                                   int outExt[6], int id, int numComp)
+{
+  int *kernelMiddle = self->GetKernelMiddle();
+  int *kernelSize = self->GetKernelSize();
+  int *inExt = inData->GetExtent();
+  vtkIdType inInc[3];
+  vtkIdType outInc[3];
+  inData->GetIncrements(inInc);
+  outData->GetIncrements(outInc);
+
+  std::vector<T> values(self->GetNumberOfElements() + 1);
+
+  unsigned long count = 0;
+  unsigned long target = static_cast<unsigned long>(
+    (outExt[5] - outExt[4] + 1)*(outExt[3] - outExt[2] + 1)/50.0);
+  target++;
+
+  for (int idx2 = outExt[4]; idx2 <= outExt[5]; ++idx2)
+    {
+    int hoodMin2, hoodMax2;
+    vtkImageMedian3DHoodRange(idx2, idx2, kernelMiddle[2], kernelSize[2],
+                              inExt[4], inExt[5], hoodMin2, hoodMax2);
+    for (int idx1 = outExt[2];
+         !self->AbortExecute && idx1 <= outExt[3]; ++idx1)
+      {
+      if (!id)
+        {
+        if (!(count%target))
+          {
+          self->UpdateProgress(count/(50.0*target));
+          }
+        count++;
+        }
+      int hoodMin1, hoodMax1;
+      vtkImageMedian3DHoodRange(idx1, idx1, kernelMiddle[1], kernelSize[1],
+                                inExt[2], inExt[3], hoodMin1, hoodMax1);
+      T *outPtr0 = outPtr + (idx2 - outExt[4])*outInc[2] +
+                            (idx1 - outExt[2])*outInc[1];
+      for (int idx0 = outExt[0]; idx0 <= outExt[1]; ++idx0)
+        {
+        int hoodMin0, hoodMax0;
+        vtkImageMedian3DHoodRange(idx0, idx0, kernelMiddle[0], kernelSize[0],
+                                  inExt[0], inExt[1], hoodMin0, hoodMax0);
+        for (int c = 0; c < numComp; ++c)
+          {
+          int n = 0;
+          for (int hoodIdx2 = hoodMin2; hoodIdx2 <= hoodMax2; ++hoodIdx2)
+            {
+            for (int hoodIdx1 = hoodMin1; hoodIdx1 <= hoodMax1; ++hoodIdx1)
+              {
+              T *tmpPtr = inPtr + c + (hoodIdx2 - inExt[4])*inInc[2] +
+                                      (hoodIdx1 - inExt[2])*inInc[1] +
+                                      (hoodMin0 - inExt[0])*inInc[0];
+              for (int hoodIdx0 = hoodMin0; hoodIdx0 <= hoodMax0; ++hoodIdx0)
+                {
+                values[n++] = *tmpPtr;
+                tmpPtr += inInc[0];
+                }
+              }
+            }
+          std::nth_element(values.begin(), values.begin() + n/2,
+                           values.begin() + n);
+          *outPtr0++ = values[n/2];
+          }
+        }
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Compute the median of every neighborhood from histograms. Every column
+// of the kernel (the voxels with the same x) has its own histogram, and
+// the histogram of the kernel is the sum of the histograms of its columns.
+// Along a row, one column histogram is added to and one is removed from
+// the kernel histogram per voxel, and from one row to the next each column
+// histogram gains and loses one line of kernelSize[2] voxels. Histograms
+// have two levels: the coarse bins are kept current and locate the median,
+// the fine bins of a coarse bin are brought up to date only when the
+// median falls into it. Returns false, without touching the output, if
+// the value range or the memory needed is too large.
+template <class T>
+bool vtkImageMedian3DHistogramExecute(vtkImageMedian3D *self,
+                                      vtkImageData *inData, T *inPtr,
+                                      vtkImageData *outData, T *outPtr,
+                                      int outExt[6], int id, int numComp)
+{
+  int *kernelMiddle = self->GetKernelMiddle();
+  int *kernelSize = self->GetKernelSize();
+  int *inExt = inData->GetExtent();
+  vtkIdType inInc[3];
+  vtkIdType outInc[3];
+  inData->GetIncrements(inInc);
+  outData->GetIncrements(outInc);
+
+  // The part of the input that this piece reads.
+  int hoodExt[6];
+  for (int i = 0; i < 3; ++i)
+    {
+    vtkImageMedian3DHoodRange(outExt[2*i], outExt[2*i+1], kernelMiddle[i],
+                              kernelSize[i], inExt[2*i], inExt[2*i+1],
+                              hoodExt[2*i], hoodExt[2*i+1]);
+    if (hoodExt[2*i] > hoodExt[2*i+1])
+      {
+      return false;
+      }
+    }
+
+  // The value range of every component, which sets the histogram size.
+  std::vector<T> minValue(numComp);
+  int maxRange = 1;
+  for (int c = 0; c < numComp; ++c)
+    {
+    T lo = inPtr[c + (hoodExt[4] - inExt[4])*inInc[2] +
+                 (hoodExt[2] - inExt[2])*inInc[1] +
+                 (hoodExt[0] - inExt[0])*inInc[0]];
+    T hi = lo;
+    for (int idx2 = hoodExt[4]; idx2 <= hoodExt[5]; ++idx2)
+      {
+      for (int idx1 = hoodExt[2]; idx1 <= hoodExt[3]; ++idx1)
+        {
+        T *tmpPtr = inPtr + c + (idx2 - inExt[4])*inInc[2] +
+                                (idx1 - inExt[2])*inInc[1] +
+                                (hoodExt[0] - inExt[0])*inInc[0];
+        for (int idx0 = hoodExt[0]; idx0 <= hoodExt[1]; ++idx0)
+          {
+          lo = (*tmpPtr < lo ? *tmpPtr : lo);
+          hi = (*tmpPtr > hi ? *tmpPtr : hi);
+          tmpPtr += inInc[0];
+          }
+        }
+      }
+    if (static_cast<double>(hi) - static_cast<double>(lo) >= 65536.0)
+      {
+      return false;
+      }
+    minValue[c] = lo;
+    int range = static_cast<int>(hi - lo) + 1;
+    maxRange = (range > maxRange ? range : maxRange);
+    }
+
+  // Split the bins into coarse bins of about sqrt(range) fine bins.
+  int bits = 0;
+  while ((1 << bits) < maxRange)
+    {
+    ++bits;
+    }
+  int shift = bits/2;
+  int fineSize = (1 << shift);
+  int numCoarse = ((maxRange - 1) >> shift) + 1;
+  int numFine = (numCoarse << shift);
+
+  int numColumns = hoodExt[1] - hoodExt[0] + 1;
+  double bytes = static_cast<double>(numColumns)*(numCoarse + numFine)*
+    sizeof(int);
+  if (bytes > VTK_IMAGE_MEDIAN3D_MAX_HISTOGRAM_BYTES)
+    {
+    return false;
+    }
+
+  std::vector<int> columnFine(static_cast<size_t>(numColumns)*numFine);
+  std::vector<int> columnCoarse(static_cast<size_t>(numColumns)*numCoarse);
+  std::vector<int> kernelFine(numFine);
+  std::vector<int> kernelCoarse(numCoarse);
+  // For every coarse bin, the columns that its fine bins in kernelFine
+  // hold, and the row for which they were computed.
+  std::vector<int> fineLo(numCoarse);
+  std::vector<int> fineHi(numCoarse);
+  std::vector<int> fineRow(numCoarse);
+  int row = 0;
+
+  unsigned long count = 0;
+  unsigned long target = static_cast<unsigned long>(
+    numComp*(outExt[5] - outExt[4] + 1)*(outExt[3] - outExt[2] + 1)/50.0);
+  target++;
+
+  for (int c = 0; c < numComp; ++c)
+    {
+    T minVal = minValue[c];
+    for (int idx2 = outExt[4]; idx2 <= outExt[5]; ++idx2)
+      {
+      int hoodMin2, hoodMax2;
+      vtkImageMedian3DHoodRange(idx2, idx2, kernelMiddle[2], kernelSize[2],
+                                inExt[4], inExt[5], hoodMin2, hoodMax2);
+
+      // Start the column histograms with the lines of the first row.
+      std::fill(columnFine.begin(), columnFine.end(), 0);
+      std::fill(columnCoarse.begin(), columnCoarse.end(), 0);
+      int hoodMin1 = inExt[2];
+      int hoodMax1 = inExt[2] - 1;
+
+      for (int idx1 = outExt[2];
+           !self->AbortExecute && idx1 <= outExt[3]; ++idx1)
+        {
+        if (!id)
+          {
+          if (!(count%target))
+            {
+            self->UpdateProgress(count/(50.0*target));
+            }
+          count++;
+          }
+
+        // Move the column histograms to the new row.
+        int newMin1, newMax1;
+        vtkImageMedian3DHoodRange(idx1, idx1, kernelMiddle[1], kernelSize[1],
+                                  inExt[2], inExt[3], newMin1, newMax1);
+        for (int pass = 0; pass < 2; ++pass)
+          {
+          int lineMin = hoodMin1;
+          int lineMax = (newMin1 - 1 < hoodMax1 ? newMin1 - 1 : hoodMax1);
+          int delta = -1;
+          if (pass == 1)
+            {
+            lineMin = (hoodMax1 + 1 > newMin1 ? hoodMax1 + 1 : newMin1);
+            lineMax = newMax1;
+            delta = 1;
+            }
+          for (int hoodIdx1 = lineMin; hoodIdx1 <= lineMax; ++hoodIdx1)
+            {
+            for (int hoodIdx2 = hoodMin2; hoodIdx2 <= hoodMax2; ++hoodIdx2)
+              {
+              T *tmpPtr = inPtr + c + (hoodIdx2 - inExt[4])*inInc[2] +
+                                      (hoodIdx1 - inExt[2])*inInc[1] +
+                                      (hoodExt[0] - inExt[0])*inInc[0];
+              int *fine = &columnFine[0];
+              int *coarse = &columnCoarse[0];
+              for (int col = 0; col < numColumns; ++col)
+                {
+                int bin = static_cast<int>(*tmpPtr - minVal);
+                fine[bin] += delta;
+                coarse[bin >> shift] += delta;
+                fine += numFine;
+                coarse += numCoarse;
+                tmpPtr += inInc[0];
+                }
+              }
+            }
+          }
+        hoodMin1 = newMin1;
+        hoodMax1 = newMax1;
+
+        // Sweep the kernel histogram along the row. Columns are numbered
+        // from hoodExt[0].
+        ++row;
+        std::fill(kernelCoarse.begin(), kernelCoarse.end(), 0);
+        int windowLo = 0;
+        int windowHi = -1;
+        int planeSize = (hoodMax1 - hoodMin1 + 1)*(hoodMax2 - hoodMin2 + 1);
+        T *outPtr0 = outPtr + c + (idx2 - outExt[4])*outInc[2] +
+                                  (idx1 - outExt[2])*outInc[1];
+        for (int idx0 = outExt[0]; idx0 <= outExt[1]; ++idx0)
+          {
+          int newLo, newHi;
+          vtkImageMedian3DHoodRange(idx0, idx0, kernelMiddle[0],
+                                    kernelSize[0], inExt[0], inExt[1],
+                                    newLo, newHi);
+          newLo -= hoodExt[0];
+          newHi -= hoodExt[0];
+          for (int col = windowLo; col < newLo && col <= windowHi; ++col)
+            {
+            const int *coarse = &columnCoarse[col*numCoarse];
+            for (int b = 0; b < numCoarse; ++b)
+              {
+              kernelCoarse[b] -= coarse[b];
+              }
+            }
+          int firstNew = (windowHi + 1 > newLo ? windowHi + 1 : newLo);
+          for (int col = firstNew; col <= newHi; ++col)
+            {
+            const int *coarse = &columnCoarse[col*numCoarse];
+            for (int b = 0; b < numCoarse; ++b)
+              {
+              kernelCoarse[b] += coarse[b];
+              }
+            }
+          windowLo = newLo;
+          windowHi = newHi;
+
+          // Find the coarse bin of the median.
+          int rank = (windowHi - windowLo + 1)*planeSize/2;
+          int sum = 0;
+          int cbin = 0;
+          while (sum + kernelCoarse[cbin] <= rank)
+            {
+            sum += kernelCoarse[cbin++];
+            }
+
+          // Bring the fine bins of that coarse bin up to date.
+          int *kfine = &kernelFine[cbin << shift];
+          if (fineRow[cbin] != row || fineHi[cbin] < windowLo)
+            {
+            std::fill(kfine, kfine + fineSize, 0);
+            fineLo[cbin] = windowLo;
+            fineHi[cbin] = windowLo - 1;
+            }
+          for (int col = fineLo[cbin]; col < windowLo; ++col)
+            {
+            const int *fine = &columnFine[col*numFine + (cbin << shift)];
+            for (int b = 0; b < fineSize; ++b)
+              {
+              kfine[b] -= fine[b];
+              }
+            }
+          for (int col = fineHi[cbin] + 1; col <= windowHi; ++col)
+            {
+            const int *fine = &columnFine[col*numFine + (cbin << shift)];
+            for (int b = 0; b < fineSize; ++b)
+              {
+              kfine[b] += fine[b];
+              }
+            }
+          fineLo[cbin] = windowLo;
+          fineHi[cbin] = windowHi;
+          fineRow[cbin] = row;
+
+          int fbin = 0;
+          while (sum + kfine[fbin] <= rank)
+            {
+            sum += kfine[fbin++];
+            }
+
+          *outPtr0 = static_cast<T>(minVal + ((cbin << shift) + fbin));
+          outPtr0 += numComp;
+          }
+        }
+      }
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// The histogram algorithm for integer types, otherwise selection.
+template <class T>
+void vtkImageMedian3DFastExecute(vtkImageMedian3D *self,
+                                 vtkImageData *inData, T *inPtr,
+                                 vtkImageData *outData, T *outPtr,
+                                 int outExt[6], int id, int numComp)
+{
+  if (!std::numeric_limits<T>::is_integer ||
+      !vtkImageMedian3DHistogramExecute(self, inData, inPtr, outData,
+                                        outPtr, outExt, id, numComp))
+    {
+    vtkImageMedian3DSelectExecute(self, inData, inPtr, outData, outPtr,
+                                  outExt, id, numComp);
+    }
+}
+
 //-----------------------------------------------------------------------------
 // This method contains the first switch statement that calls the correct
 // templated function for the input and output region types.
@@ -400,6 +791,23 @@ void vtkImageMedian3D::ThreadedRequestData(
     return;
     }
 
+  if (this->Algorithm == VTK_IMAGE_MEDIAN3D_HISTOGRAM)
+    {
+    switch (inArray->GetDataType())
+      {
+      vtkTemplateMacro(
+        vtkImageMedian3DFastExecute(this, inData[0][0],
+                                    static_cast<VTK_TT *>(inPtr),
+                                    outData[0],
+                                    static_cast<VTK_TT *>(outPtr),
+                                    outExt, id,
+                                    inArray->GetNumberOfComponents()));
+      default:
+        vtkErrorMacro(<< "Execute: Unknown input ScalarType");
+      }
+    return;
+    }
+
   switch (inArray->GetDataType())
     {
     vtkTemplateMacro(
@@ -19,6 +19,18 @@
 // Neighborhoods can be no more than 3 dimensional.  Setting one
 // axis of the neighborhood kernelSize to 1 changes the filter
 // into a 2D median.
+//
+// The default algorithm keeps a sorted list of the neighborhood for every
+// output voxel, so its cost grows with the kernel volume. The histogram
+// algorithm keeps a histogram of every column of the kernel and moves them
+// with the kernel (after Perreault and Hebert), so that for integer data
+// the cost per voxel is almost independent of the kernel size. It needs
+// memory for one histogram of the value range per column, and is used
+// when that range is at most 65536 values wide and the histograms of one
+// thread fit in 64 MB. Otherwise, and for floating point data, it selects
+// the median without sorting the neighborhood. When the neighborhood has
+// an even number of values, as it does at the image boundaries, the
+// histogram algorithm always uses the upper of the two middle values.
 
 
 #ifndef vtkImageMedian3D_h
@@ -28,7 +40,11 @@
 #include "vtkImagingGeneralModule.h" // For export macro
 #include "vtkImageSpatialAlgorithm.h"
 
-class VTKIMAGINGGENERAL_EXPORT vtkImageMedian3D : public vtkImageSpatialAlgorithm
+#define VTK_IMAGE_MEDIAN3D_SORT 0
+#define VTK_IMAGE_MEDIAN3D_HISTOGRAM 1
+
+class VTKIMAGINGGENERAL_EXPORT vtkImageMedian3D
+  : public vtkImageSpatialAlgorithm
 {
 public:
   static vtkImageMedian3D *New();
@@ -44,11 +60,24 @@ public:
   // Return the number of elements in the median mask
   vtkGetMacro(NumberOfElements,int);
 
+  // Description:
+  // Set the algorithm that computes the median.  The choices are "Sort"
+  // and "Histogram", see the description above.  The default is "Sort".
+  vtkSetClampMacro(Algorithm, int, VTK_IMAGE_MEDIAN3D_SORT,
+                   VTK_IMAGE_MEDIAN3D_HISTOGRAM);
+  void SetAlgorithmToSort() {
+    this->SetAlgorithm(VTK_IMAGE_MEDIAN3D_SORT); };
+  void SetAlgorithmToHistogram() {
+    this->SetAlgorithm(VTK_IMAGE_MEDIAN3D_HISTOGRAM); };
+  vtkGetMacro(Algorithm, int);
+  const char *GetAlgorithmAsString();
+
 protected:
   vtkImageMedian3D();
   ~vtkImageMedian3D();
 
   int NumberOfElements;
+  int Algorithm;
 
   void ThreadedRequestData(vtkInformation *request,
                            vtkInformationVector **inputVector,
@@ -14,11 +14,14 @@
 =========================================================================*/
 #include "vtkImageRange3D.h"
 
+#include "vtkDataArray.h"
+#include "vtkImageBoxMorphology.h"
 #include "vtkImageData.h"
 #include "vtkImageEllipsoidSource.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
+#include "vtkPointData.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 vtkStandardNewMacro(vtkImageRange3D);
@@ -29,6 +32,7 @@ vtkStandardNewMacro(vtkImageRange3D);
 vtkImageRange3D::vtkImageRange3D()
 {
   this->HandleBoundaries = 1;
+  this->BoxKernel = 0;
   this->KernelSize[0] = 1;
   this->KernelSize[1] = 1;
   this->KernelSize[2] = 1;
@@ -52,6 +56,8 @@ vtkImageRange3D::~vtkImageRange3D()
 void vtkImageRange3D::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "BoxKernel: " << (this->BoxKernel ? "On\n" : "Off\n");
 }
 
 //----------------------------------------------------------------------------
@@ -280,6 +286,53 @@ void vtkImageRange3DExecute(vtkImageRange3D *self,
     }
 }
 
+//----------------------------------------------------------------------------
+// Set the output to the maximum minus the minimum over the box, which are
+// computed by vtkImageBoxMorphology into images of the output extent.
+template <class T>
+void vtkImageRange3DBoxExecute(vtkImageData *inData, const int inExt[6],
+                               vtkImageData *outData, const int outExt[6],
+                               const int kernelSize[3],
+                               const int kernelMiddle[3], T *)
+{
+  vtkDataArray *inArray = inData->GetPointData()->GetScalars();
+  int numComps = inArray->GetNumberOfComponents();
+
+  vtkImageData *maxData = vtkImageData::New();
+  maxData->SetExtent(const_cast<int *>(outExt));
+  maxData->AllocateScalars(inArray->GetDataType(), numComps);
+  vtkImageBoxMorphology::Execute(inData, inArray, inExt, maxData, outExt,
+                                 kernelSize, kernelMiddle,
+                                 VTK_IMAGE_BOX_MAXIMUM);
+  vtkImageData *minData = vtkImageData::New();
+  minData->SetExtent(const_cast<int *>(outExt));
+  minData->AllocateScalars(inArray->GetDataType(), numComps);
+  vtkImageBoxMorphology::Execute(inData, inArray, inExt, minData, outExt,
+                                 kernelSize, kernelMiddle,
+                                 VTK_IMAGE_BOX_MINIMUM);
+
+  const T *maxPtr = static_cast<T *>(maxData->GetScalarPointer());
+  const T *minPtr = static_cast<T *>(minData->GetScalarPointer());
+  int rowSize = (outExt[1] - outExt[0] + 1)*numComps;
+  for (int idx2 = outExt[4]; idx2 <= outExt[5]; ++idx2)
+    {
+    for (int idx1 = outExt[2]; idx1 <= outExt[3]; ++idx1)
+      {
+      float *outPtr = static_cast<float *>(
+        outData->GetScalarPointer(outExt[0], idx1, idx2));
+      for (int i = 0; i < rowSize; ++i)
+        {
+        outPtr[i] = static_cast<float>(maxPtr[i] - minPtr[i]);
+        }
+      maxPtr += rowSize;
+      minPtr += rowSize;
+      }
+    }
+
+  maxData->Delete();
+  minData->Delete();
+}
+
 //----------------------------------------------------------------------------
 // This method contains the first switch statement that calls the correct
 // templated function for the input and output Data types.
@@ -317,6 +370,20 @@ void vtkImageRange3D::ThreadedRequestData(
     return;
     }
 
+  if (this->BoxKernel)
+    {
+    switch (inData[0][0]->GetScalarType())
+      {
+      vtkTemplateMacro(
+        vtkImageRange3DBoxExecute(inData[0][0], inExt, outData[0], outExt,
+                                  this->KernelSize, this->KernelMiddle,
+                                  static_cast<VTK_TT *>(0)));
+      default:
+        vtkErrorMacro(<< "Execute: Unknown ScalarType");
+      }
+    return;
+    }
+
   switch (inData[0][0]->GetScalarType())
     {
     vtkTemplateMacro(
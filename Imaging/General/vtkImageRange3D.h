@@ -40,11 +40,21 @@ public:
   // default middle of the neighborhood and computes the elliptical foot print.
   void SetKernelSize(int size0, int size1, int size2);
 
+  // Description:
+  // Use a box of KernelSize voxels instead of an ellipsoid.  The maximum
+  // and minimum over the box are computed one axis at a time with the van
+  // Herk/Gil-Werman algorithm, so the time taken does not depend on the
+  // kernel size.  The default is off.
+  vtkSetMacro(BoxKernel, int);
+  vtkGetMacro(BoxKernel, int);
+  vtkBooleanMacro(BoxKernel, int);
+
 protected:
   vtkImageRange3D();
   ~vtkImageRange3D();
 
   vtkImageEllipsoidSource *Ellipse;
+  int BoxKernel;
 
   virtual int RequestInformation (vtkInformation *request,
                                   vtkInformationVector **inputVector,
@@ -0,0 +1,611 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageSummedAreaTable.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkImageSummedAreaTable.h"
+
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkSMPTools.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+
+#include <vector>
+
+vtkStandardNewMacro(vtkImageSummedAreaTable);
+
+//----------------------------------------------------------------------------
+vtkImageSummedAreaTable::vtkImageSummedAreaTable()
+{
+  this->Dimensionality = 3;
+  this->ComputeSquaredSums = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkImageSummedAreaTable::~vtkImageSummedAreaTable()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSummedAreaTable::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "Dimensionality: " << this->Dimensionality << "\n";
+  os << indent << "ComputeSquaredSums: "
+     << (this->ComputeSquaredSums ? "On\n" : "Off\n");
+}
+
+//----------------------------------------------------------------------------
+// anonymous namespace for internal classes and functions
+namespace {
+
+// The number of values of a row that each task of the passes along y and
+// z adds, so that there are enough tasks even for a single slice.
+const vtkIdType VTK_SUMMED_AREA_CHUNK_SIZE = 4096;
+
+// The size along each axis of the tiles of the output of the box
+// statistics, each of which has tables of its own input.
+const int VTK_SUMMED_AREA_TILE_SIZE = 32;
+
+// A table: the pointer to the value of its first voxel, its increments
+// and its dimensions.  The components of each row are contiguous.
+struct vtkSummedAreaTableRegion
+{
+  double *Pointer;
+  vtkIdType Increments[3];
+  int Dimensions[3];
+};
+
+//----------------------------------------------------------------------------
+// The pass along x, which sets each row of the tables to the running sums
+// of the row of the input, less the reference of each component if set.
+template<class T>
+class vtkSummedAreaTableRows
+{
+public:
+  const T *Input;
+  vtkIdType InIncrements[3];
+  int NumberOfComponents;
+  const double *Reference;
+  vtkSummedAreaTableRegion Sums;
+  vtkSummedAreaTableRegion Squares;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    int nx = this->Sums.Dimensions[0];
+    int ny = this->Sums.Dimensions[1];
+    int numComp = this->NumberOfComponents;
+    for (vtkIdType row = begin; row < end; ++row)
+      {
+      vtkIdType j = row % ny;
+      vtkIdType k = row / ny;
+      const T *inPtr = this->Input + j*this->InIncrements[1] +
+        k*this->InIncrements[2];
+      double *sumPtr = this->Sums.Pointer + j*this->Sums.Increments[1] +
+        k*this->Sums.Increments[2];
+      for (int c = 0; c < numComp; ++c)
+        {
+        double r = (this->Reference ? this->Reference[c] : 0.0);
+        double s = 0.0;
+        for (int i = 0; i < nx; ++i)
+          {
+          s += static_cast<double>(inPtr[i*this->InIncrements[0] + c]) - r;
+          sumPtr[i*numComp + c] = s;
+          }
+        }
+      if (this->Squares.Pointer)
+        {
+        double *sqrPtr = this->Squares.Pointer +
+          j*this->Squares.Increments[1] + k*this->Squares.Increments[2];
+        for (int c = 0; c < numComp; ++c)
+          {
+          double r = (this->Reference ? this->Reference[c] : 0.0);
+          double s = 0.0;
+          for (int i = 0; i < nx; ++i)
+            {
+            double v =
+              static_cast<double>(inPtr[i*this->InIncrements[0] + c]) - r;
+            s += v*v;
+            sqrPtr[i*numComp + c] = s;
+            }
+          }
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// The passes along y and z, which add each row of a table to the next one
+// along the axis.  Each task does one chunk of the rows of one slice (for
+// y) or of one column of rows (for z).
+class vtkSummedAreaTableColumns
+{
+public:
+  double *Pointer;
+  vtkIdType RowLength;
+  vtkIdType LineIncrement;
+  int LineCount;
+  vtkIdType OtherIncrement;
+  vtkIdType NumberOfChunks;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for (vtkIdType task = begin; task < end; ++task)
+      {
+      vtkIdType other = task / this->NumberOfChunks;
+      vtkIdType start =
+        (task % this->NumberOfChunks)*VTK_SUMMED_AREA_CHUNK_SIZE;
+      vtkIdType length = this->RowLength - start;
+      length = (length < VTK_SUMMED_AREA_CHUNK_SIZE ?
+                length : VTK_SUMMED_AREA_CHUNK_SIZE);
+      double *prev = this->Pointer + other*this->OtherIncrement + start;
+      for (int l = 1; l < this->LineCount; ++l)
+        {
+        double *next = prev + this->LineIncrement;
+        for (vtkIdType e = 0; e < length; ++e)
+          {
+          next[e] += prev[e];
+          }
+        prev = next;
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Compute the tables of the input, and of its squares if squares.Pointer
+// is set, with a pass along each axis.  If reference is set, it is
+// subtracted from each component of the input first.
+template<class T>
+void vtkSummedAreaTableBuild(
+  const T *inPtr, const vtkIdType inIncs[3], int numComp,
+  int dimensionality, const vtkSummedAreaTableRegion& sums,
+  const vtkSummedAreaTableRegion& squares, const double *reference = 0)
+{
+  const int *dims = sums.Dimensions;
+
+  vtkSummedAreaTableRows<T> rows;
+  rows.Input = inPtr;
+  rows.InIncrements[0] = inIncs[0];
+  rows.InIncrements[1] = inIncs[1];
+  rows.InIncrements[2] = inIncs[2];
+  rows.NumberOfComponents = numComp;
+  rows.Reference = reference;
+  rows.Sums = sums;
+  rows.Squares = squares;
+  vtkSMPTools::For(0, static_cast<vtkIdType>(dims[1])*dims[2], rows);
+
+  const vtkSummedAreaTableRegion *tables[2] = { &sums, &squares };
+  for (int t = 0; t < 2; ++t)
+    {
+    const vtkSummedAreaTableRegion *table = tables[t];
+    if (!table->Pointer)
+      {
+      continue;
+      }
+
+    vtkSummedAreaTableColumns columns;
+    columns.Pointer = table->Pointer;
+    columns.RowLength = static_cast<vtkIdType>(dims[0])*numComp;
+    columns.NumberOfChunks =
+      (columns.RowLength + VTK_SUMMED_AREA_CHUNK_SIZE - 1)/
+      VTK_SUMMED_AREA_CHUNK_SIZE;
+
+    columns.LineIncrement = table->Increments[1];
+    columns.LineCount = dims[1];
+    columns.OtherIncrement = table->Increments[2];
+    vtkSMPTools::For(0, dims[2]*columns.NumberOfChunks, columns);
+
+    if (dimensionality == 3)
+      {
+      columns.LineIncrement = table->Increments[2];
+      columns.LineCount = dims[2];
+      columns.OtherIncrement = table->Increments[1];
+      vtkSMPTools::For(0, dims[1]*columns.NumberOfChunks, columns);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Get the pointer to the first scalar of extent within an array of data,
+// and the increments of the array.
+template<class T>
+T *vtkSummedAreaTableGetPointer(
+  vtkImageData *data, vtkDataArray *array, const int extent[6],
+  vtkIdType increments[3])
+{
+  int *dataExt = data->GetExtent();
+  data->GetArrayIncrements(array, increments);
+  return static_cast<T *>(array->GetVoidPointer(
+    (extent[0] - dataExt[0])*increments[0] +
+    (extent[2] - dataExt[2])*increments[1] +
+    (extent[4] - dataExt[4])*increments[2]));
+}
+
+//----------------------------------------------------------------------------
+template<class T>
+void vtkSummedAreaTableExecute(
+  vtkImageData *inData, vtkDataArray *inArray, const int extent[6],
+  int dimensionality, double *sums, double *squares)
+{
+  vtkIdType inIncs[3];
+  const T *inPtr =
+    vtkSummedAreaTableGetPointer<T>(inData, inArray, extent, inIncs);
+  int numComp = inArray->GetNumberOfComponents();
+
+  vtkSummedAreaTableRegion sumTable;
+  vtkIdType inc = numComp;
+  for (int a = 0; a < 3; ++a)
+    {
+    sumTable.Dimensions[a] = extent[2*a+1] - extent[2*a] + 1;
+    sumTable.Increments[a] = inc;
+    inc *= sumTable.Dimensions[a];
+    }
+  sumTable.Pointer = sums;
+  vtkSummedAreaTableRegion sqrTable = sumTable;
+  sqrTable.Pointer = squares;
+
+  vtkSummedAreaTableBuild(
+    inPtr, inIncs, numComp, dimensionality, sumTable, sqrTable);
+}
+
+//----------------------------------------------------------------------------
+// The sum over a box, from the offsets of the corners in the table.
+inline double vtkSummedAreaTableBoxSum(
+  const double *p, vtkIdType x0, vtkIdType x1, vtkIdType y0, vtkIdType y1,
+  vtkIdType z0, vtkIdType z1)
+{
+  return (p[x1 + y1 + z1] - p[x0 + y1 + z1] - p[x1 + y0 + z1] +
+          p[x0 + y0 + z1] - p[x1 + y1 + z0] + p[x0 + y1 + z0] +
+          p[x1 + y0 + z0] - p[x0 + y0 + z0]);
+}
+
+//----------------------------------------------------------------------------
+// Compute the mean, or the mean squared difference from the center, over
+// the box around each voxel of one tile of the output, from tables of the
+// input of the tile, inExt, which is within the input data.  The input is
+// centered on its mean before it is summed, so that the sums stay small
+// even for large values, and the tables are only as large as the tile.
+template<class T>
+void vtkSummedAreaTableBoxTile(
+  const T *inPtr, const vtkIdType inIncs[3], int numComp, const int inExt[6],
+  float *outPtr, const vtkIdType outIncs[3], const int outExt[6],
+  const int kernelSize[3], const int kernelMiddle[3], bool variance)
+{
+  // the mean of the input of the tile, as the reference of each component
+  vtkIdType count = 1;
+  for (int a = 0; a < 3; ++a)
+    {
+    count *= inExt[2*a+1] - inExt[2*a] + 1;
+    }
+  std::vector<double> reference(numComp, 0.0);
+  for (int k = 0; k <= inExt[5] - inExt[4]; ++k)
+    {
+    for (int j = 0; j <= inExt[3] - inExt[2]; ++j)
+      {
+      const T *inPtr0 = inPtr + j*inIncs[1] + k*inIncs[2];
+      for (int i = 0; i <= inExt[1] - inExt[0]; ++i)
+        {
+        for (int c = 0; c < numComp; ++c)
+          {
+          reference[c] += static_cast<double>(inPtr0[i*inIncs[0] + c]);
+          }
+        }
+      }
+    }
+  for (int c = 0; c < numComp; ++c)
+    {
+    reference[c] /= count;
+    }
+
+  // the tables have a border of zeros before the first voxel of each axis,
+  // so that the sums over boxes at the boundaries need no special cases
+  vtkSummedAreaTableRegion sums;
+  vtkIdType inc = numComp;
+  vtkIdType start = 0;
+  for (int a = 0; a < 3; ++a)
+    {
+    sums.Dimensions[a] = inExt[2*a+1] - inExt[2*a] + 1;
+    sums.Increments[a] = inc;
+    start += inc;
+    inc *= sums.Dimensions[a] + 1;
+    }
+  std::vector<double> buffers[2];
+  buffers[0].assign(inc, 0.0);
+  sums.Pointer = &buffers[0][start];
+  vtkSummedAreaTableRegion squares = sums;
+  squares.Pointer = 0;
+  if (variance)
+    {
+    buffers[1].assign(inc, 0.0);
+    squares.Pointer = &buffers[1][start];
+    }
+
+  vtkSummedAreaTableBuild(inPtr, inIncs, numComp, 3, sums, squares,
+                          &reference[0]);
+
+  // the offsets of the table values before and at the ends of the box of
+  // each output index, and the number of voxels of the box, along each axis
+  std::vector<vtkIdType> offsets[3];
+  std::vector<int> counts[3];
+  for (int a = 0; a < 3; ++a)
+    {
+    int n = outExt[2*a+1] - outExt[2*a] + 1;
+    offsets[a].resize(2*n);
+    counts[a].resize(n);
+    for (int idx = 0; idx < n; ++idx)
+      {
+      int b0 = outExt[2*a] + idx - kernelMiddle[a];
+      int b1 = b0 + kernelSize[a] - 1;
+      b0 = (b0 > inExt[2*a] ? b0 : inExt[2*a]);
+      b1 = (b1 < inExt[2*a+1] ? b1 : inExt[2*a+1]);
+      offsets[a][2*idx] = (b0 - inExt[2*a] - 1)*sums.Increments[a];
+      offsets[a][2*idx+1] = (b1 - inExt[2*a])*sums.Increments[a];
+      counts[a][idx] = b1 - b0 + 1;
+      }
+    }
+
+  // the input, offset to the output extent
+  inPtr += (outExt[0] - inExt[0])*inIncs[0] +
+    (outExt[2] - inExt[2])*inIncs[1] + (outExt[4] - inExt[4])*inIncs[2];
+
+  for (int k = 0; k <= outExt[5] - outExt[4]; ++k)
+    {
+    vtkIdType z0 = offsets[2][2*k];
+    vtkIdType z1 = offsets[2][2*k+1];
+    for (int j = 0; j <= outExt[3] - outExt[2]; ++j)
+      {
+      vtkIdType y0 = offsets[1][2*j];
+      vtkIdType y1 = offsets[1][2*j+1];
+      double countYZ = static_cast<double>(counts[1][j])*counts[2][k];
+      const T *inPtr0 = inPtr + j*inIncs[1] + k*inIncs[2];
+      float *outPtr0 = outPtr + j*outIncs[1] + k*outIncs[2];
+      for (int i = 0; i <= outExt[1] - outExt[0]; ++i)
+        {
+        vtkIdType x0 = offsets[0][2*i];
+        vtkIdType x1 = offsets[0][2*i+1];
+        double scale = 1.0/(countYZ*counts[0][i]);
+        for (int c = 0; c < numComp; ++c)
+          {
+          double mean = scale*vtkSummedAreaTableBoxSum(
+            sums.Pointer + c, x0, x1, y0, y1, z0, z1);
+          if (variance)
+            {
+            // the mean of (x - v)^2 is the variance of x plus the square
+            // of the difference between the mean of x and v, and the
+            // variance, computed from the centered sums, is clamped at
+            // zero against the rounding errors
+            double meanSqr = scale*vtkSummedAreaTableBoxSum(
+              squares.Pointer + c, x0, x1, y0, y1, z0, z1);
+            double var = meanSqr - mean*mean;
+            double d = mean -
+              (static_cast<double>(inPtr0[i*inIncs[0] + c]) - reference[c]);
+            outPtr0[i*outIncs[0] + c] =
+              static_cast<float>((var > 0.0 ? var : 0.0) + d*d);
+            }
+          else
+            {
+            outPtr0[i*outIncs[0] + c] =
+              static_cast<float>(mean + reference[c]);
+            }
+          }
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Compute the box statistics of the output extent tile by tile, each from
+// the part of the input that the boxes of the tile cover.
+template<class T>
+void vtkSummedAreaTableBoxExecute(
+  vtkImageData *inData, vtkDataArray *inArray, const int inExt[6],
+  vtkImageData *outData, const int outExt[6], const int kernelSize[3],
+  const int kernelMiddle[3], bool variance, T *)
+{
+  vtkIdType inIncs[3];
+  const T *inPtr =
+    vtkSummedAreaTableGetPointer<T>(inData, inArray, inExt, inIncs);
+  int numComp = inArray->GetNumberOfComponents();
+
+  vtkIdType outIncs[3];
+  float *outPtr = vtkSummedAreaTableGetPointer<float>(
+    outData, outData->GetPointData()->GetScalars(), outExt, outIncs);
+
+  const int tileSize = VTK_SUMMED_AREA_TILE_SIZE;
+  int tileOutExt[6];
+  int tileInExt[6];
+  for (tileOutExt[4] = outExt[4]; tileOutExt[4] <= outExt[5];
+       tileOutExt[4] += tileSize)
+    {
+    for (tileOutExt[2] = outExt[2]; tileOutExt[2] <= outExt[3];
+         tileOutExt[2] += tileSize)
+      {
+      for (tileOutExt[0] = outExt[0]; tileOutExt[0] <= outExt[1];
+           tileOutExt[0] += tileSize)
+        {
+        for (int a = 0; a < 3; ++a)
+          {
+          int e = tileOutExt[2*a] + tileSize - 1;
+          tileOutExt[2*a+1] = (e < outExt[2*a+1] ? e : outExt[2*a+1]);
+          int b0 = tileOutExt[2*a] - kernelMiddle[a];
+          int b1 = tileOutExt[2*a+1] - kernelMiddle[a] + kernelSize[a] - 1;
+          tileInExt[2*a] = (b0 > inExt[2*a] ? b0 : inExt[2*a]);
+          tileInExt[2*a+1] = (b1 < inExt[2*a+1] ? b1 : inExt[2*a+1]);
+          }
+
+        vtkSummedAreaTableBoxTile(
+          inPtr + (tileInExt[0] - inExt[0])*inIncs[0] +
+            (tileInExt[2] - inExt[2])*inIncs[1] +
+            (tileInExt[4] - inExt[4])*inIncs[2],
+          inIncs, numComp, tileInExt,
+          outPtr + (tileOutExt[0] - outExt[0])*outIncs[0] +
+            (tileOutExt[2] - outExt[2])*outIncs[1] +
+            (tileOutExt[4] - outExt[4])*outIncs[2],
+          outIncs, tileOutExt, kernelSize, kernelMiddle, variance);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSummedAreaTableClipExtent(
+  const int extent[6], const int dataExt[6], int clippedExt[6])
+{
+  for (int i = 0; i < 3; ++i)
+    {
+    clippedExt[2*i] = (extent[2*i] > dataExt[2*i] ?
+                       extent[2*i] : dataExt[2*i]);
+    clippedExt[2*i+1] = (extent[2*i+1] < dataExt[2*i+1] ?
+                         extent[2*i+1] : dataExt[2*i+1]);
+    }
+}
+
+} // end anonymous namespace
+
+//----------------------------------------------------------------------------
+void vtkImageSummedAreaTable::ExecuteBoxMean(
+  vtkImageData *inData, vtkDataArray *inArray, const int inputExt[6],
+  vtkImageData *outData, const int outExt[6], const int kernelSize[3],
+  const int kernelMiddle[3])
+{
+  int inExt[6];
+  vtkSummedAreaTableClipExtent(inputExt, inData->GetExtent(), inExt);
+
+  switch (inArray->GetDataType())
+    {
+    vtkTemplateMacro(
+      vtkSummedAreaTableBoxExecute(
+        inData, inArray, inExt, outData, outExt, kernelSize, kernelMiddle,
+        false, static_cast<VTK_TT *>(0)));
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSummedAreaTable::ExecuteBoxVariance(
+  vtkImageData *inData, vtkDataArray *inArray, const int inputExt[6],
+  vtkImageData *outData, const int outExt[6], const int kernelSize[3],
+  const int kernelMiddle[3])
+{
+  int inExt[6];
+  vtkSummedAreaTableClipExtent(inputExt, inData->GetExtent(), inExt);
+
+  switch (inArray->GetDataType())
+    {
+    vtkTemplateMacro(
+      vtkSummedAreaTableBoxExecute(
+        inData, inArray, inExt, outData, outExt, kernelSize, kernelMiddle,
+        true, static_cast<VTK_TT *>(0)));
+    }
+}
+
+//----------------------------------------------------------------------------
+// The output is always double.
+int vtkImageSummedAreaTable::RequestInformation(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **vtkNotUsed(inputVector),
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_DOUBLE, -1);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// Each voxel of the table needs the input from the start of the whole
+// extent, along the axes of the table.
+int vtkImageSummedAreaTable::RequestUpdateExtent(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+
+  int inExt[6], wholeExt[6];
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt);
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
+  for (int a = 0; a < this->Dimensionality; ++a)
+    {
+    inExt[2*a] = wholeExt[2*a];
+    }
+  inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt, 6);
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// The table is computed over the whole input extent, which contains the
+// requested extent.
+int vtkImageSummedAreaTable::RequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  vtkImageData *inData = vtkImageData::SafeDownCast(
+    inInfo->Get(vtkDataObject::DATA_OBJECT()));
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkImageData *outData = vtkImageData::SafeDownCast(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  vtkDataArray *inArray = this->GetInputArrayToProcess(0, inputVector);
+  if (!inArray)
+    {
+    vtkErrorMacro("No scalars to compute the table of.");
+    return 0;
+    }
+
+  int extent[6];
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), extent);
+  int numComp = inArray->GetNumberOfComponents();
+
+  outData->SetExtent(extent);
+  outData->AllocateScalars(VTK_DOUBLE, numComp);
+  double *sums = static_cast<double *>(
+    outData->GetPointData()->GetScalars()->GetVoidPointer(0));
+
+  double *squares = 0;
+  if (this->ComputeSquaredSums)
+    {
+    vtkDoubleArray *squaredSums = vtkDoubleArray::New();
+    squaredSums->SetName("SquaredSums");
+    squaredSums->SetNumberOfComponents(numComp);
+    squaredSums->SetNumberOfTuples(outData->GetNumberOfPoints());
+    squares = squaredSums->GetPointer(0);
+    outData->GetPointData()->AddArray(squaredSums);
+    squaredSums->Delete();
+    }
+
+  if (outData->GetNumberOfPoints() == 0)
+    {
+    return 1;
+    }
+
+  switch (inArray->GetDataType())
+    {
+    vtkTemplateMacro(
+      vtkSummedAreaTableExecute<VTK_TT>(
+        inData, inArray, extent, this->Dimensionality, sums, squares));
+    default:
+      vtkErrorMacro(<< "Execute: Unknown ScalarType");
+      return 0;
+    }
+
+  return 1;
+}
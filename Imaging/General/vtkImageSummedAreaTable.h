@@ -0,0 +1,105 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageSummedAreaTable.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkImageSummedAreaTable - Summed area tables of an image.
+// .SECTION Description
+// vtkImageSummedAreaTable computes the summed area table, or integral
+// image, of its input: each voxel of the output is the sum of the input
+// over the box from the first voxel of the input extent to that voxel.
+// The sum over any box of the input is then given by eight values of the
+// table, whatever the size of the box.  With a Dimensionality of 2, each
+// slice has its own table.  The output is double, with the same number of
+// components as the input.  If ComputeSquaredSums is on, the table of the
+// squared values is also computed, as the "SquaredSums" array.
+//
+// The table is computed with one pass along each axis, and each pass is
+// done in parallel with vtkSMPTools.  The static methods are used by
+// vtkImageBoxMean3D and vtkImageVariance3D to compute local statistics
+// over boxes from tables of the input.
+// .SECTION See Also
+// vtkImageBoxMean3D vtkImageVariance3D
+
+#ifndef vtkImageSummedAreaTable_h
+#define vtkImageSummedAreaTable_h
+
+#include "vtkImagingGeneralModule.h" // For export macro
+#include "vtkImageAlgorithm.h"
+
+class vtkDataArray;
+
+class VTKIMAGINGGENERAL_EXPORT vtkImageSummedAreaTable :
+  public vtkImageAlgorithm
+{
+public:
+  static vtkImageSummedAreaTable *New();
+  vtkTypeMacro(vtkImageSummedAreaTable,vtkImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Compute tables of the slices (2) or of the volume (3).  The default
+  // is 3.
+  vtkSetClampMacro(Dimensionality, int, 2, 3);
+  vtkGetMacro(Dimensionality, int);
+
+  // Description:
+  // Also compute the table of the squared values, as the "SquaredSums"
+  // array of the output.  The default is off.
+  vtkSetMacro(ComputeSquaredSums, int);
+  vtkGetMacro(ComputeSquaredSums, int);
+  vtkBooleanMacro(ComputeSquaredSums, int);
+
+  // Description:
+  // Set each voxel of outExt in outData, which must be float, to the mean
+  // of inArray over the box of kernelSize voxels that starts kernelMiddle
+  // voxels before it.  Only the voxels within inExt and within inData are
+  // considered, and these must contain the output extent.  The output is
+  // computed in tiles, from tables of the input of each tile centered on
+  // its mean, so that the sums do not lose the precision of large values.
+  static void ExecuteBoxMean(vtkImageData *inData, vtkDataArray *inArray,
+                             const int inExt[6], vtkImageData *outData,
+                             const int outExt[6], const int kernelSize[3],
+                             const int kernelMiddle[3]);
+
+  // Description:
+  // Like ExecuteBoxMean(), but set each voxel to the mean of the squared
+  // differences between the voxels of the box and the voxel itself, which
+  // is what vtkImageVariance3D computes.
+  static void ExecuteBoxVariance(vtkImageData *inData, vtkDataArray *inArray,
+                                 const int inExt[6], vtkImageData *outData,
+                                 const int outExt[6], const int kernelSize[3],
+                                 const int kernelMiddle[3]);
+
+protected:
+  vtkImageSummedAreaTable();
+  ~vtkImageSummedAreaTable();
+
+  virtual int RequestInformation(vtkInformation *request,
+                                 vtkInformationVector **inputVector,
+                                 vtkInformationVector *outputVector);
+  virtual int RequestUpdateExtent(vtkInformation *request,
+                                  vtkInformationVector **inputVector,
+                                  vtkInformationVector *outputVector);
+  virtual int RequestData(vtkInformation *request,
+                          vtkInformationVector **inputVector,
+                          vtkInformationVector *outputVector);
+
+  int Dimensionality;
+  int ComputeSquaredSums;
+
+private:
+  vtkImageSummedAreaTable(const vtkImageSummedAreaTable&);  // Not implemented.
+  void operator=(const vtkImageSummedAreaTable&);  // Not implemented.
+};
+
+#endif
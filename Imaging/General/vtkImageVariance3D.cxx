@@ -16,9 +16,11 @@
 
 #include "vtkImageEllipsoidSource.h"
 #include "vtkImageData.h"
+#include "vtkImageSummedAreaTable.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
+#include "vtkPointData.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 vtkStandardNewMacro(vtkImageVariance3D);
@@ -27,6 +29,7 @@ vtkStandardNewMacro(vtkImageVariance3D);
 vtkImageVariance3D::vtkImageVariance3D()
 {
   this->HandleBoundaries = 1;
+  this->BoxKernel = 0;
   this->KernelSize[0] = 1;
   this->KernelSize[1] = 1;
   this->KernelSize[2] = 1;
@@ -50,6 +53,8 @@ vtkImageVariance3D::~vtkImageVariance3D()
 void vtkImageVariance3D::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "BoxKernel: " << (this->BoxKernel ? "On\n" : "Off\n");
 }
 
 //----------------------------------------------------------------------------
@@ -315,6 +320,14 @@ void vtkImageVariance3D::ThreadedRequestData(
     return;
     }
 
+  if (this->BoxKernel)
+    {
+    vtkImageSummedAreaTable::ExecuteBoxVariance(
+      inData[0][0], inData[0][0]->GetPointData()->GetScalars(), inExt,
+      outData[0], outExt, this->KernelSize, this->KernelMiddle);
+    return;
+    }
+
   switch (inData[0][0]->GetScalarType())
     {
     vtkTemplateMacro(
@@ -43,11 +43,20 @@ public:
   // middle of the neighborhood and computes the Elliptical foot print.
   void SetKernelSize(int size0, int size1, int size2);
 
+  // Description:
+  // Use a box of KernelSize voxels instead of an ellipsoid.  The sums over
+  // the boxes are computed from summed area tables of the input, so the
+  // time taken does not depend on the kernel size.  The default is off.
+  vtkSetMacro(BoxKernel, int);
+  vtkGetMacro(BoxKernel, int);
+  vtkBooleanMacro(BoxKernel, int);
+
 protected:
   vtkImageVariance3D();
   ~vtkImageVariance3D();
 
   vtkImageEllipsoidSource *Ellipse;
+  int BoxKernel;
 
   virtual int RequestInformation (vtkInformation *request,
                                   vtkInformationVector **inputVector,
@@ -0,0 +1,245 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    ImageBoxMorphology.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test of the box kernels of the morphological filters
+// .SECTION Description
+// Compares vtkImageContinuousDilate3D, vtkImageContinuousErode3D,
+// vtkImageDilateErode3D and vtkImageOpenClose3D with box kernels against
+// a brute force search of the box, for several types, two components,
+// odd and even kernel sizes, kernels larger than the image, and a piece
+// of the output.  Also reports the time taken with an ellipsoid kernel
+// and with a box kernel.
+
+#include "vtkDataArray.h"
+#include "vtkImageContinuousDilate3D.h"
+#include "vtkImageContinuousErode3D.h"
+#include "vtkImageData.h"
+#include "vtkImageDilateErode3D.h"
+#include "vtkImageOpenClose3D.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkTimerLog.h"
+
+static void FillImage(vtkImageData *image, int scalarType, int numComp,
+                      bool binary)
+{
+  image->SetExtent(-2, 30, 1, 22, 0, 12);
+  image->AllocateScalars(scalarType, numComp);
+  vtkDataArray *scalars = image->GetPointData()->GetScalars();
+  vtkIdType n = scalars->GetNumberOfTuples();
+  for (vtkIdType i = 0; i < n; ++i)
+    {
+    for (int c = 0; c < numComp; ++c)
+      {
+      int v = static_cast<int>((i*7919 + c*104729 + (i*i) % 1013) % 97);
+      if (binary)
+        {
+        // mostly 255, some 0, and a few other labels
+        v = (v < 9 ? 0 : (v < 12 ? 7 : 255));
+        }
+      scalars->SetComponent(i, c, v - (binary ? 0 : 40));
+      }
+    }
+}
+
+// Compute the box result for one voxel, by brute force.  The operation
+// is 0 for maximum, 1 for minimum, and 2 for dilate-erode of 0 into 255.
+static double BoxValue(vtkImageData *image, const int size[3], int i, int j,
+                       int k, int c, int operation)
+{
+  int *ext = image->GetExtent();
+  double center = image->GetScalarComponentAsDouble(i, j, k, c);
+  double result = center;
+  for (int kk = k - size[2]/2; kk < k - size[2]/2 + size[2]; ++kk)
+    {
+    for (int jj = j - size[1]/2; jj < j - size[1]/2 + size[1]; ++jj)
+      {
+      for (int ii = i - size[0]/2; ii < i - size[0]/2 + size[0]; ++ii)
+        {
+        if (ii < ext[0] || ii > ext[1] || jj < ext[2] || jj > ext[3] ||
+            kk < ext[4] || kk > ext[5])
+          {
+          continue;
+          }
+        double v = image->GetScalarComponentAsDouble(ii, jj, kk, c);
+        if (operation == 0)
+          {
+          result = (v > result ? v : result);
+          }
+        else if (operation == 1)
+          {
+          result = (v < result ? v : result);
+          }
+        else if (center == 255 && v == 0)
+          {
+          result = 0;
+          }
+        }
+      }
+    }
+  return result;
+}
+
+static int CompareBox(vtkImageData *image, vtkImageData *output,
+                      const int size[3], const int extent[6], int operation,
+                      const char *name)
+{
+  int numComp = image->GetNumberOfScalarComponents();
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        for (int c = 0; c < numComp; ++c)
+          {
+          double expected = BoxValue(image, size, i, j, k, c, operation);
+          double result = output->GetScalarComponentAsDouble(i, j, k, c);
+          if (result != expected)
+            {
+            cerr << name << " with kernel " << size[0] << "x" << size[1]
+                 << "x" << size[2] << ": value at " << i << ", " << j
+                 << ", " << k << " is " << result << " instead of "
+                 << expected << endl;
+            return 1;
+            }
+          }
+        }
+      }
+    }
+  return 0;
+}
+
+static int TestGrey(int scalarType, const int size[3])
+{
+  vtkNew<vtkImageData> image;
+  FillImage(image.GetPointer(), scalarType, 2, false);
+  int *ext = image->GetExtent();
+
+  vtkNew<vtkImageContinuousDilate3D> dilate;
+  dilate->SetInputData(image.GetPointer());
+  dilate->SetKernelSize(size[0], size[1], size[2]);
+  dilate->BoxKernelOn();
+  dilate->SetNumberOfThreads(3);
+  dilate->Update();
+
+  vtkNew<vtkImageContinuousErode3D> erode;
+  erode->SetInputData(image.GetPointer());
+  erode->SetKernelSize(size[0], size[1], size[2]);
+  erode->BoxKernelOn();
+  erode->Update();
+
+  int rval = 0;
+  rval |= CompareBox(image.GetPointer(), dilate->GetOutput(), size, ext, 0,
+                     "Dilate");
+  rval |= CompareBox(image.GetPointer(), erode->GetOutput(), size, ext, 1,
+                     "Erode");
+
+  // a piece of the output only needs part of the input
+  int pieceExt[6] = { 3, 17, 4, 9, 2, 7 };
+  dilate->UpdateInformation();
+  dilate->SetUpdateExtent(pieceExt);
+  dilate->Update();
+  rval |= CompareBox(image.GetPointer(), dilate->GetOutput(), size, pieceExt,
+                     0, "Dilate piece");
+
+  return rval;
+}
+
+static int TestBinary(int scalarType, const int size[3])
+{
+  vtkNew<vtkImageData> image;
+  FillImage(image.GetPointer(), scalarType, 1, true);
+  int *ext = image->GetExtent();
+
+  vtkNew<vtkImageDilateErode3D> dilateErode;
+  dilateErode->SetInputData(image.GetPointer());
+  dilateErode->SetKernelSize(size[0], size[1], size[2]);
+  dilateErode->SetDilateValue(0);
+  dilateErode->SetErodeValue(255);
+  dilateErode->BoxKernelOn();
+  dilateErode->Update();
+
+  int rval = CompareBox(image.GetPointer(), dilateErode->GetOutput(), size,
+                        ext, 2, "DilateErode");
+
+  // closing of 0 is a dilate-erode of 0 followed by one of 255
+  vtkNew<vtkImageDilateErode3D> second;
+  second->SetInputData(dilateErode->GetOutput());
+  second->SetKernelSize(size[0], size[1], size[2]);
+  second->SetDilateValue(255);
+  second->SetErodeValue(0);
+  second->BoxKernelOn();
+  second->Update();
+  vtkNew<vtkImageOpenClose3D> close;
+  close->SetInputData(image.GetPointer());
+  close->SetKernelSize(size[0], size[1], size[2]);
+  close->SetCloseValue(0);
+  close->SetOpenValue(255);
+  close->BoxKernelOn();
+  close->Update();
+  vtkDataArray *a = close->GetOutput()->GetPointData()->GetScalars();
+  vtkDataArray *b = second->GetOutput()->GetPointData()->GetScalars();
+  for (vtkIdType i = 0; i < a->GetNumberOfTuples(); ++i)
+    {
+    if (a->GetComponent(i, 0) != b->GetComponent(i, 0))
+      {
+      cerr << "Closing differs at " << i << endl;
+      return 1;
+      }
+    }
+
+  return rval;
+}
+
+int ImageBoxMorphology(int, char *[])
+{
+  static const int sizes[5][3] = {
+    { 3, 3, 3 }, { 4, 1, 5 }, { 1, 6, 1 }, { 7, 9, 2 }, { 40, 1, 27 } };
+  static const int types[3] = { VTK_UNSIGNED_CHAR, VTK_SHORT, VTK_FLOAT };
+
+  int rval = 0;
+  for (int s = 0; s < 5; ++s)
+    {
+    for (int t = 0; t < 3; ++t)
+      {
+      rval |= TestGrey(types[t], sizes[s]);
+      rval |= TestBinary(types[t], sizes[s]);
+      }
+    }
+
+  // time a large kernel with an ellipsoid and with a box
+  vtkNew<vtkImageData> image;
+  FillImage(image.GetPointer(), VTK_SHORT, 1, false);
+  vtkNew<vtkImageContinuousDilate3D> dilate;
+  dilate->SetInputData(image.GetPointer());
+  dilate->SetKernelSize(15, 15, 15);
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  dilate->Update();
+  timer->StopTimer();
+  double ellipsoidTime = timer->GetElapsedTime();
+  dilate->BoxKernelOn();
+  timer->StartTimer();
+  dilate->Update();
+  timer->StopTimer();
+  double boxTime = timer->GetElapsedTime();
+  cout << "<DartMeasurement name=\"EllipsoidDilate\" "
+       << "type=\"numeric/double\">" << ellipsoidTime << "</DartMeasurement>\n"
+       << "<DartMeasurement name=\"BoxDilate\" "
+       << "type=\"numeric/double\">" << boxTime << "</DartMeasurement>"
+       << endl;
+
+  return rval;
+}
@@ -0,0 +1,264 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    ImageConnectivityFilter.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME Test of vtkImageConnectivityFilter
+// .SECTION Description
+// Compares the labels, sizes and extents that are found by the filter with
+// those found by a flood fill, for each connectivity, for a volume and for
+// a single slice, and checks the extraction of the largest regions.
+
+#include "vtkImageConnectivityFilter.h"
+#include "vtkImageData.h"
+#include "vtkIdTypeArray.h"
+#include "vtkIntArray.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
+
+#include <algorithm>
+#include <vector>
+
+// Label the regions of a binary volume by flood fill, in the order in
+// which they are first encountered.
+static int FloodFill(const int dims[3], const std::vector<int>& mask,
+                     int connectivity, std::vector<int>& labels)
+{
+  labels.assign(mask.size(), 0);
+  std::vector<int> stack;
+  int numLabels = 0;
+  for (int start = 0; start < static_cast<int>(mask.size()); ++start)
+    {
+    if (!mask[start] || labels[start])
+      {
+      continue;
+      }
+    labels[start] = ++numLabels;
+    stack.push_back(start);
+    while (!stack.empty())
+      {
+      int idx = stack.back();
+      stack.pop_back();
+      int x = idx % dims[0];
+      int y = (idx / dims[0]) % dims[1];
+      int z = idx / (dims[0]*dims[1]);
+      for (int dz = -1; dz <= 1; ++dz)
+        {
+        for (int dy = -1; dy <= 1; ++dy)
+          {
+          for (int dx = -1; dx <= 1; ++dx)
+            {
+            int d = (dx != 0) + (dy != 0) + (dz != 0);
+            if (d == 0 || (d > 1 && connectivity == 6) ||
+                (d > 2 && connectivity == 18))
+              {
+              continue;
+              }
+            int xx = x + dx;
+            int yy = y + dy;
+            int zz = z + dz;
+            if (xx < 0 || xx >= dims[0] || yy < 0 || yy >= dims[1] ||
+                zz < 0 || zz >= dims[2])
+              {
+              continue;
+              }
+            int nidx = (zz*dims[1] + yy)*dims[0] + xx;
+            if (mask[nidx] && !labels[nidx])
+              {
+              labels[nidx] = numLabels;
+              stack.push_back(nidx);
+              }
+            }
+          }
+        }
+      }
+    }
+  return numLabels;
+}
+
+static int TestConnectivity(const int dims[3], int connectivity,
+                            int numThreads)
+{
+  const int origin[3] = { -4, 3, 1 };
+
+  // a sparse random pattern gives many regions of all shapes
+  vtkNew<vtkImageData> image;
+  image->SetExtent(origin[0], origin[0] + dims[0] - 1,
+                   origin[1], origin[1] + dims[1] - 1,
+                   origin[2], origin[2] + dims[2] - 1);
+  image->AllocateScalars(VTK_SHORT, 2);
+  short *ptr = static_cast<short *>(image->GetScalarPointer());
+  int n = dims[0]*dims[1]*dims[2];
+  std::vector<int> mask(n);
+  unsigned int seed = 12345;
+  for (int i = 0; i < n; ++i)
+    {
+    seed = seed*1103515245u + 12345u;
+    short v = static_cast<short>((seed >> 16) % 100);
+    ptr[2*i] = static_cast<short>(i % 7);
+    ptr[2*i + 1] = v;
+    mask[i] = (v >= 60 && v <= 90);
+    }
+
+  std::vector<int> expected;
+  int numExpected = FloodFill(dims, mask, connectivity, expected);
+
+  // the sizes and extents of the regions, in order of first encounter
+  std::vector<vtkIdType> sizes(numExpected, 0);
+  std::vector<int> extents(6*numExpected);
+  for (int r = 0; r < numExpected; ++r)
+    {
+    for (int j = 0; j < 3; ++j)
+      {
+      extents[6*r + 2*j] = VTK_INT_MAX;
+      extents[6*r + 2*j + 1] = VTK_INT_MIN;
+      }
+    }
+  for (int i = 0; i < n; ++i)
+    {
+    if (expected[i])
+      {
+      int r = expected[i] - 1;
+      int p[3];
+      p[0] = i % dims[0] + origin[0];
+      p[1] = (i / dims[0]) % dims[1] + origin[1];
+      p[2] = i / (dims[0]*dims[1]) + origin[2];
+      sizes[r]++;
+      for (int j = 0; j < 3; ++j)
+        {
+        extents[6*r + 2*j] = std::min(extents[6*r + 2*j], p[j]);
+        extents[6*r + 2*j + 1] = std::max(extents[6*r + 2*j + 1], p[j]);
+        }
+      }
+    }
+
+  // the filter labels by decreasing size, ties in order of first encounter
+  std::vector<int> labelOfRegion(numExpected);
+  for (int r = 0; r < numExpected; ++r)
+    {
+    int label = 1;
+    for (int s = 0; s < numExpected; ++s)
+      {
+      if (sizes[s] > sizes[r] || (sizes[s] == sizes[r] && s < r))
+        {
+        label++;
+        }
+      }
+    labelOfRegion[r] = label;
+    }
+
+  int defaultThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numThreads);
+
+  vtkNew<vtkImageConnectivityFilter> filter;
+  filter->SetInputData(image.GetPointer());
+  filter->SetActiveComponent(1);
+  filter->SetScalarRange(60, 90);
+  filter->SetConnectivity(connectivity);
+  filter->SetLabelScalarTypeToInt();
+  filter->Update();
+
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(defaultThreads);
+
+  if (filter->GetNumberOfRegions() != numExpected ||
+      filter->GetNumberOfExtractedRegions() != numExpected)
+    {
+    cerr << "Connectivity " << connectivity << ": found "
+         << filter->GetNumberOfRegions() << " regions instead of "
+         << numExpected << endl;
+    return 1;
+    }
+
+  const int *labels =
+    static_cast<const int *>(filter->GetOutput()->GetScalarPointer());
+  for (int i = 0; i < n; ++i)
+    {
+    int label = (expected[i] ? labelOfRegion[expected[i] - 1] : 0);
+    if (labels[i] != label)
+      {
+      cerr << "Connectivity " << connectivity << ": label at " << i
+           << " is " << labels[i] << " instead of " << label << endl;
+      return 1;
+      }
+    }
+
+  vtkIdTypeArray *regionSizes = filter->GetExtractedRegionSizes();
+  vtkIntArray *regionExtents = filter->GetExtractedRegionExtents();
+  for (int r = 0; r < numExpected; ++r)
+    {
+    int l = labelOfRegion[r] - 1;
+    if (regionSizes->GetValue(l) != sizes[r])
+      {
+      cerr << "Connectivity " << connectivity << ": size of region "
+           << l + 1 << " is " << regionSizes->GetValue(l) << " instead of "
+           << sizes[r] << endl;
+      return 1;
+      }
+    for (int j = 0; j < 6; ++j)
+      {
+      if (regionExtents->GetValue(6*l + j) != extents[6*r + j])
+        {
+        cerr << "Connectivity " << connectivity << ": extent of region "
+             << l + 1 << " is wrong" << endl;
+        return 1;
+        }
+      }
+    }
+
+  // keep only the three largest regions
+  filter->SetExtractionModeToLargestRegions();
+  filter->SetNumberOfLargestRegions(3);
+  filter->SetLabelScalarTypeToUnsignedChar();
+  filter->Update();
+
+  vtkIdType numKept = std::min(numExpected, 3);
+  if (filter->GetNumberOfExtractedRegions() != numKept)
+    {
+    cerr << "Connectivity " << connectivity << ": extracted "
+         << filter->GetNumberOfExtractedRegions() << " regions instead of "
+         << numKept << endl;
+    return 1;
+    }
+  const unsigned char *largest = static_cast<const unsigned char *>(
+    filter->GetOutput()->GetScalarPointer());
+  for (int i = 0; i < n; ++i)
+    {
+    int label = (expected[i] ? labelOfRegion[expected[i] - 1] : 0);
+    label = (label <= numKept ? label : 0);
+    if (largest[i] != label)
+      {
+      cerr << "Connectivity " << connectivity << ": largest label at " << i
+           << " is " << static_cast<int>(largest[i]) << " instead of "
+           << label << endl;
+      return 1;
+      }
+    }
+
+  return 0;
+}
+
+int ImageConnectivityFilter(int, char *[])
+{
+  static const int volume[3] = { 37, 29, 23 };
+  static const int slice[3] = { 61, 47, 1 };
+  static const int connectivities[3] = { 6, 18, 26 };
+
+  int rval = 0;
+  for (int c = 0; c < 3; ++c)
+    {
+    rval |= TestConnectivity(volume, connectivities[c], 1);
+    rval |= TestConnectivity(volume, connectivities[c], 16);
+    rval |= TestConnectivity(slice, connectivities[c], 4);
+    }
+
+  return rval;
+}
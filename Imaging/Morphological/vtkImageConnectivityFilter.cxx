@@ -0,0 +1,707 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageConnectivityFilter.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkImageConnectivityFilter.h"
+
+#include "vtkDataArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkIntArray.h"
+#include "vtkMultiThreader.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkSMPTools.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkTemplateAliasMacro.h"
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+vtkStandardNewMacro(vtkImageConnectivityFilter);
+
+//----------------------------------------------------------------------------
+vtkImageConnectivityFilter::vtkImageConnectivityFilter()
+{
+  this->ScalarRange[0] = 0.5;
+  this->ScalarRange[1] = VTK_DOUBLE_MAX;
+  this->ActiveComponent = 0;
+  this->Connectivity = 6;
+  this->ExtractionMode = VTK_IMAGE_CONNECTIVITY_ALL_REGIONS;
+  this->NumberOfLargestRegions = 1;
+  this->LabelScalarType = VTK_UNSIGNED_SHORT;
+  this->NumberOfRegions = 0;
+
+  this->ExtractedRegionSizes = vtkIdTypeArray::New();
+  this->ExtractedRegionExtents = vtkIntArray::New();
+  this->ExtractedRegionExtents->SetNumberOfComponents(6);
+}
+
+//----------------------------------------------------------------------------
+vtkImageConnectivityFilter::~vtkImageConnectivityFilter()
+{
+  this->ExtractedRegionSizes->Delete();
+  this->ExtractedRegionExtents->Delete();
+}
+
+//----------------------------------------------------------------------------
+const char *vtkImageConnectivityFilter::GetExtractionModeAsString()
+{
+  switch (this->ExtractionMode)
+    {
+    case VTK_IMAGE_CONNECTIVITY_ALL_REGIONS:
+      return "AllRegions";
+    case VTK_IMAGE_CONNECTIVITY_LARGEST_REGIONS:
+      return "LargestRegions";
+    }
+  return "";
+}
+
+//----------------------------------------------------------------------------
+const char *vtkImageConnectivityFilter::GetLabelScalarTypeAsString()
+{
+  return vtkImageScalarTypeNameMacro(this->LabelScalarType);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageConnectivityFilter::GetNumberOfExtractedRegions()
+{
+  return this->ExtractedRegionSizes->GetNumberOfTuples();
+}
+
+//----------------------------------------------------------------------------
+int vtkImageConnectivityFilter::RequestInformation(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **vtkNotUsed(inputVector),
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkDataObject::SetPointDataActiveScalarInfo(
+    outInfo, this->LabelScalarType, 1);
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// The regions cannot be found without the whole input.
+int vtkImageConnectivityFilter::RequestUpdateExtent(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *vtkNotUsed(outputVector))
+{
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+
+  int inExt[6];
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), inExt);
+  inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt, 6);
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+namespace {
+
+// A run of consecutive voxels along a row that are within the range.
+struct vtkICFRun
+{
+  int X0;
+  int X1;
+};
+
+// The rows are divided into slabs, and each slab stores its runs and,
+// for each row, the index of the first run of the row.  While the slab
+// is being built, the union-find parents of its runs are local indices.
+struct vtkICFSlab
+{
+  vtkIdType FirstRow;
+  vtkIdType EndRow;
+  std::vector<vtkICFRun> Runs;
+  std::vector<vtkIdType> RowStart;
+  std::vector<vtkIdType> Parent;
+  vtkIdType Offset;
+};
+
+// The neighbor rows that come before a row in the image: the row offsets
+// along y and z, and the dilation of the runs along x.
+struct vtkICFNeighbor
+{
+  int DY;
+  int DZ;
+  int DX;
+};
+
+static const vtkICFNeighbor vtkICFNeighbors6[2] = {
+  { -1, 0, 0 }, { 0, -1, 0 } };
+static const vtkICFNeighbor vtkICFNeighbors18[4] = {
+  { -1, 0, 1 }, { 0, -1, 1 }, { -1, -1, 0 }, { 1, -1, 0 } };
+static const vtkICFNeighbor vtkICFNeighbors26[4] = {
+  { -1, 0, 1 }, { 0, -1, 1 }, { -1, -1, 1 }, { 1, -1, 1 } };
+
+//----------------------------------------------------------------------------
+// Union-find with union by minimum index, so that the root of each set is
+// its first run and a single pass in run order can resolve all sets.
+inline vtkIdType vtkICFFind(vtkIdType *parent, vtkIdType i)
+{
+  while (parent[i] != i)
+    {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+    }
+  return i;
+}
+
+inline void vtkICFUnion(vtkIdType *parent, vtkIdType a, vtkIdType b)
+{
+  a = vtkICFFind(parent, a);
+  b = vtkICFFind(parent, b);
+  if (a < b)
+    {
+    parent[b] = a;
+    }
+  else if (b < a)
+    {
+    parent[a] = b;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Join the runs of a row with the runs of a neighbor row, where the runs
+// are connected if they overlap after the neighbor runs are dilated by dx.
+// The runs are given as index ranges into the parent array.
+void vtkICFJoinRows(
+  const vtkICFRun *a, vtkIdType ia, vtkIdType na,
+  const vtkICFRun *b, vtkIdType ib, vtkIdType nb,
+  int dx, vtkIdType *parent)
+{
+  vtkIdType i = 0;
+  vtkIdType j = 0;
+  while (i < na && j < nb)
+    {
+    if (b[j].X1 + dx < a[i].X0)
+      {
+      j++;
+      }
+    else if (a[i].X1 < b[j].X0 - dx)
+      {
+      i++;
+      }
+    else
+      {
+      vtkICFUnion(parent, ia + i, ib + j);
+      if (a[i].X1 < b[j].X1 + dx)
+        {
+        i++;
+        }
+      else
+        {
+        j++;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Information shared by all of the stages of the algorithm.
+struct vtkICFInfo
+{
+  int Extent[6];
+  vtkIdType NY;
+  vtkIdType NumberOfRows;
+  vtkIdType RowsPerSlab;
+  const vtkICFNeighbor *Neighbors;
+  int NumberOfNeighbors;
+  std::vector<vtkICFSlab> Slabs;
+  std::vector<vtkIdType> Parent;
+
+  // get the slab that contains a row
+  vtkICFSlab *GetSlab(vtkIdType row)
+    {
+    return &this->Slabs[row/this->RowsPerSlab];
+    }
+};
+
+//----------------------------------------------------------------------------
+// Extract the runs of each slab, and join the runs within the slab.
+template<class T>
+class vtkICFExtractRuns
+{
+public:
+  vtkICFExtractRuns(vtkICFInfo *info, vtkImageData *inData,
+                    const double range[2], int component) :
+    Info(info), InData(inData), Component(component)
+    {
+    this->Range[0] = range[0];
+    this->Range[1] = range[1];
+    }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType s = begin; s < end; s++)
+      {
+      this->ExtractSlab(&this->Info->Slabs[s]);
+      }
+    }
+
+  void ExtractSlab(vtkICFSlab *slab);
+
+private:
+  vtkICFInfo *Info;
+  vtkImageData *InData;
+  double Range[2];
+  int Component;
+};
+
+template<class T>
+void vtkICFExtractRuns<T>::ExtractSlab(vtkICFSlab *slab)
+{
+  const int *extent = this->Info->Extent;
+  vtkIdType ny = this->Info->NY;
+  int nx = extent[1] - extent[0] + 1;
+  vtkIdType inInc[3];
+  this->InData->GetIncrements(inInc);
+  const T *inPtr = static_cast<const T *>(
+    this->InData->GetScalarPointerForExtent(const_cast<int *>(extent)));
+  inPtr += this->Component;
+  double lo = this->Range[0];
+  double hi = this->Range[1];
+
+  std::vector<vtkICFRun>& runs = slab->Runs;
+  std::vector<vtkIdType>& rowStart = slab->RowStart;
+  rowStart.resize(slab->EndRow - slab->FirstRow + 1);
+
+  for (vtkIdType row = slab->FirstRow; row < slab->EndRow; row++)
+    {
+    vtkIdType y = row % ny;
+    vtkIdType z = row / ny;
+    const T *ptr = inPtr + y*inInc[1] + z*inInc[2];
+    rowStart[row - slab->FirstRow] = static_cast<vtkIdType>(runs.size());
+
+    // find the runs of voxels that are within the range
+    int x = 0;
+    while (x < nx)
+      {
+      while (x < nx && !(ptr[x*inInc[0]] >= lo && ptr[x*inInc[0]] <= hi))
+        {
+        x++;
+        }
+      if (x < nx)
+        {
+        vtkICFRun run;
+        run.X0 = x;
+        while (x < nx && ptr[x*inInc[0]] >= lo && ptr[x*inInc[0]] <= hi)
+          {
+          x++;
+          }
+        run.X1 = x - 1;
+        runs.push_back(run);
+        }
+      }
+    }
+  rowStart[slab->EndRow - slab->FirstRow] =
+    static_cast<vtkIdType>(runs.size());
+
+  // initialize the union-find for the slab
+  vtkIdType n = static_cast<vtkIdType>(runs.size());
+  slab->Parent.resize(n);
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    slab->Parent[i] = i;
+    }
+  if (n == 0)
+    {
+    return;
+    }
+
+  // join each row with the preceding neighbor rows within the slab
+  vtkIdType *parent = &slab->Parent[0];
+  for (vtkIdType row = slab->FirstRow; row < slab->EndRow; row++)
+    {
+    vtkIdType y = row % ny;
+    vtkIdType ia = rowStart[row - slab->FirstRow];
+    vtkIdType na = rowStart[row - slab->FirstRow + 1] - ia;
+    if (na == 0)
+      {
+      continue;
+      }
+    for (int k = 0; k < this->Info->NumberOfNeighbors; k++)
+      {
+      const vtkICFNeighbor& nbr = this->Info->Neighbors[k];
+      vtkIdType nrow = row + nbr.DY + nbr.DZ*ny;
+      if (y + nbr.DY < 0 || y + nbr.DY >= ny || nrow < slab->FirstRow)
+        {
+        continue;
+        }
+      vtkIdType ib = rowStart[nrow - slab->FirstRow];
+      vtkIdType nb = rowStart[nrow - slab->FirstRow + 1] - ib;
+      vtkICFJoinRows(&runs[ia], ia, na, &runs[ib], ib, nb, nbr.DX, parent);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Copy the parents of each slab into the global union-find.
+class vtkICFGatherParents
+{
+public:
+  vtkICFGatherParents(vtkICFInfo *info) : Info(info) {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType s = begin; s < end; s++)
+      {
+      vtkICFSlab *slab = &this->Info->Slabs[s];
+      vtkIdType n = static_cast<vtkIdType>(slab->Parent.size());
+      vtkIdType offset = slab->Offset;
+      vtkIdType *parent = &this->Info->Parent[0] + offset;
+      for (vtkIdType i = 0; i < n; i++)
+        {
+        parent[i] = slab->Parent[i] + offset;
+        }
+      std::vector<vtkIdType>().swap(slab->Parent);
+      }
+    }
+
+private:
+  vtkICFInfo *Info;
+};
+
+//----------------------------------------------------------------------------
+// Write the labels of the runs into the output.
+template<class T>
+class vtkICFWriteLabels
+{
+public:
+  vtkICFWriteLabels(vtkICFInfo *info, vtkImageData *outData,
+                    const std::vector<vtkIdType>& labels) :
+    Info(info), OutData(outData), Labels(labels) {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+    {
+    const int *extent = this->Info->Extent;
+    vtkIdType ny = this->Info->NY;
+    int nx = extent[1] - extent[0] + 1;
+    vtkIdType outInc[3];
+    this->OutData->GetIncrements(outInc);
+    T *outPtr = static_cast<T *>(
+      this->OutData->GetScalarPointerForExtent(const_cast<int *>(extent)));
+    const vtkIdType *parent = &this->Info->Parent[0];
+
+    for (vtkIdType s = begin; s < end; s++)
+      {
+      vtkICFSlab *slab = &this->Info->Slabs[s];
+      for (vtkIdType row = slab->FirstRow; row < slab->EndRow; row++)
+        {
+        T *ptr = outPtr + (row % ny)*outInc[1] + (row / ny)*outInc[2];
+        std::fill(ptr, ptr + nx, static_cast<T>(0));
+        vtkIdType i0 = slab->RowStart[row - slab->FirstRow];
+        vtkIdType i1 = slab->RowStart[row - slab->FirstRow + 1];
+        for (vtkIdType i = i0; i < i1; i++)
+          {
+          const vtkICFRun& run = slab->Runs[i];
+          T label = static_cast<T>(this->Labels[parent[slab->Offset + i]]);
+          if (label != 0)
+            {
+            std::fill(ptr + run.X0, ptr + run.X1 + 1, label);
+            }
+          }
+        }
+      }
+    }
+
+private:
+  vtkICFInfo *Info;
+  vtkImageData *OutData;
+  const std::vector<vtkIdType>& Labels;
+};
+
+//----------------------------------------------------------------------------
+// For sorting the regions by decreasing size.
+struct vtkICFCompareSizes
+{
+  vtkICFCompareSizes(const std::vector<vtkIdType>& sizes) : Sizes(sizes) {}
+
+  bool operator()(vtkIdType a, vtkIdType b) const
+    {
+    return (this->Sizes[a] > this->Sizes[b] ||
+            (this->Sizes[a] == this->Sizes[b] && a < b));
+    }
+
+  const std::vector<vtkIdType>& Sizes;
+};
+
+} // end anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageConnectivityFilter::RequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+
+  vtkImageData *outData = static_cast<vtkImageData *>(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+  vtkImageData *inData = static_cast<vtkImageData *>(
+    inInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  this->NumberOfRegions = 0;
+  this->ExtractedRegionSizes->Reset();
+  this->ExtractedRegionExtents->Reset();
+
+  vtkICFInfo info;
+  switch (this->Connectivity)
+    {
+    case 6:
+      info.Neighbors = vtkICFNeighbors6;
+      info.NumberOfNeighbors = 2;
+      break;
+    case 18:
+      info.Neighbors = vtkICFNeighbors18;
+      info.NumberOfNeighbors = 4;
+      break;
+    case 26:
+      info.Neighbors = vtkICFNeighbors26;
+      info.NumberOfNeighbors = 4;
+      break;
+    default:
+      vtkErrorMacro("Connectivity must be 6, 18, or 26, not "
+                    << this->Connectivity);
+      return 0;
+    }
+
+  int labelType = this->LabelScalarType;
+  if (labelType != VTK_UNSIGNED_CHAR && labelType != VTK_SHORT &&
+      labelType != VTK_UNSIGNED_SHORT && labelType != VTK_INT)
+    {
+    vtkErrorMacro("LabelScalarType must be unsigned char, short, "
+                  "unsigned short, or int");
+    return 0;
+    }
+
+  int *extent = inData->GetExtent();
+  this->AllocateOutputData(outData, outInfo, extent);
+  if (extent[0] > extent[1] || extent[2] > extent[3] ||
+      extent[4] > extent[5])
+    {
+    return 1;
+    }
+
+  int numComp = inData->GetNumberOfScalarComponents();
+  if (this->ActiveComponent < 0 || this->ActiveComponent >= numComp)
+    {
+    vtkErrorMacro("ActiveComponent " << this->ActiveComponent
+                  << " is not in the input, which has " << numComp
+                  << " components");
+    return 0;
+    }
+
+  // divide the rows into slabs, several per thread for load balancing
+  for (int i = 0; i < 6; i++)
+    {
+    info.Extent[i] = extent[i];
+    }
+  info.NY = extent[3] - extent[2] + 1;
+  info.NumberOfRows = info.NY*(extent[5] - extent[4] + 1);
+  vtkIdType numSlabs = 4*vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  numSlabs = (numSlabs < info.NumberOfRows ? numSlabs : info.NumberOfRows);
+  info.RowsPerSlab = (info.NumberOfRows + numSlabs - 1)/numSlabs;
+  numSlabs = (info.NumberOfRows + info.RowsPerSlab - 1)/info.RowsPerSlab;
+  info.Slabs.resize(numSlabs);
+  for (vtkIdType s = 0; s < numSlabs; s++)
+    {
+    info.Slabs[s].FirstRow = s*info.RowsPerSlab;
+    info.Slabs[s].EndRow = std::min((s + 1)*info.RowsPerSlab,
+                                    info.NumberOfRows);
+    }
+
+  // extract and join the runs within each slab
+  switch (inData->GetScalarType())
+    {
+    vtkTemplateAliasMacro(
+      vtkICFExtractRuns<VTK_TT> extractor(
+        &info, inData, this->ScalarRange, this->ActiveComponent);
+      vtkSMPTools::For(0, numSlabs, 1, extractor));
+    default:
+      vtkErrorMacro("Execute: Unknown input ScalarType");
+      return 0;
+    }
+
+  // build the global union-find from the slabs
+  vtkIdType numRuns = 0;
+  for (vtkIdType s = 0; s < numSlabs; s++)
+    {
+    info.Slabs[s].Offset = numRuns;
+    numRuns += static_cast<vtkIdType>(info.Slabs[s].Runs.size());
+    }
+  if (numRuns == 0)
+    {
+    void *outPtr = outData->GetScalarPointer();
+    memset(outPtr, 0, outData->GetNumberOfPoints()*outData->GetScalarSize());
+    return 1;
+    }
+  info.Parent.resize(numRuns);
+  vtkICFGatherParents gather(&info);
+  vtkSMPTools::For(0, numSlabs, 1, gather);
+
+  // join the runs at the boundaries between the slabs
+  vtkIdType *parent = &info.Parent[0];
+  vtkIdType ny = info.NY;
+  for (vtkIdType s = 1; s < numSlabs; s++)
+    {
+    vtkICFSlab *slab = &info.Slabs[s];
+    vtkIdType lastRow = std::min(slab->EndRow, slab->FirstRow + ny + 1);
+    for (vtkIdType row = slab->FirstRow; row < lastRow; row++)
+      {
+      vtkIdType y = row % ny;
+      vtkIdType ia = slab->RowStart[row - slab->FirstRow];
+      vtkIdType na = slab->RowStart[row - slab->FirstRow + 1] - ia;
+      if (na == 0)
+        {
+        continue;
+        }
+      for (int k = 0; k < info.NumberOfNeighbors; k++)
+        {
+        const vtkICFNeighbor& nbr = info.Neighbors[k];
+        vtkIdType nrow = row + nbr.DY + nbr.DZ*ny;
+        if (y + nbr.DY < 0 || y + nbr.DY >= ny || nrow < 0 ||
+            nrow >= slab->FirstRow)
+          {
+          continue;
+          }
+        vtkICFSlab *nslab = info.GetSlab(nrow);
+        vtkIdType ib = nslab->RowStart[nrow - nslab->FirstRow];
+        vtkIdType nb = nslab->RowStart[nrow - nslab->FirstRow + 1] - ib;
+        vtkICFJoinRows(&slab->Runs[ia], slab->Offset + ia, na,
+                       &nslab->Runs[ib], nslab->Offset + ib, nb,
+                       nbr.DX, parent);
+        }
+      }
+    }
+
+  // replace the parent of each run with the index of its region, which
+  // works in a single pass because each root precedes its set
+  vtkIdType numRegions = 0;
+  for (vtkIdType i = 0; i < numRuns; i++)
+    {
+    vtkIdType p = parent[i];
+    parent[i] = (p == i ? numRegions++ : parent[p]);
+    }
+  this->NumberOfRegions = numRegions;
+
+  // compute the size and extent of each region
+  std::vector<vtkIdType> sizes(numRegions, 0);
+  std::vector<int> extents(6*numRegions);
+  for (vtkIdType r = 0; r < numRegions; r++)
+    {
+    int *ext = &extents[6*r];
+    ext[0] = ext[2] = ext[4] = VTK_INT_MAX;
+    ext[1] = ext[3] = ext[5] = VTK_INT_MIN;
+    }
+  for (vtkIdType s = 0; s < numSlabs; s++)
+    {
+    vtkICFSlab *slab = &info.Slabs[s];
+    for (vtkIdType row = slab->FirstRow; row < slab->EndRow; row++)
+      {
+      int y = static_cast<int>(row % ny) + extent[2];
+      int z = static_cast<int>(row / ny) + extent[4];
+      vtkIdType i0 = slab->RowStart[row - slab->FirstRow];
+      vtkIdType i1 = slab->RowStart[row - slab->FirstRow + 1];
+      for (vtkIdType i = i0; i < i1; i++)
+        {
+        const vtkICFRun& run = slab->Runs[i];
+        vtkIdType r = parent[slab->Offset + i];
+        sizes[r] += run.X1 - run.X0 + 1;
+        int *ext = &extents[6*r];
+        ext[0] = std::min(ext[0], run.X0 + extent[0]);
+        ext[1] = std::max(ext[1], run.X1 + extent[0]);
+        ext[2] = std::min(ext[2], y);
+        ext[3] = std::max(ext[3], y);
+        ext[4] = std::min(ext[4], z);
+        ext[5] = std::max(ext[5], z);
+        }
+      }
+    }
+
+  // sort the regions by size, and decide which ones to keep
+  std::vector<vtkIdType> order(numRegions);
+  for (vtkIdType r = 0; r < numRegions; r++)
+    {
+    order[r] = r;
+    }
+  std::sort(order.begin(), order.end(), vtkICFCompareSizes(sizes));
+
+  vtkIdType numKept = numRegions;
+  if (this->ExtractionMode == VTK_IMAGE_CONNECTIVITY_LARGEST_REGIONS &&
+      numKept > this->NumberOfLargestRegions)
+    {
+    numKept = this->NumberOfLargestRegions;
+    }
+  vtkIdType maxLabel = static_cast<vtkIdType>(
+    outData->GetScalarTypeMax());
+  if (numKept > maxLabel)
+    {
+    vtkWarningMacro("Only the " << maxLabel << " largest of the "
+                    << numKept << " regions can be labelled with type "
+                    << this->GetLabelScalarTypeAsString());
+    numKept = maxLabel;
+    }
+
+  std::vector<vtkIdType> labels(numRegions, 0);
+  this->ExtractedRegionSizes->SetNumberOfTuples(numKept);
+  this->ExtractedRegionExtents->SetNumberOfTuples(numKept);
+  for (vtkIdType l = 0; l < numKept; l++)
+    {
+    vtkIdType r = order[l];
+    labels[r] = l + 1;
+    this->ExtractedRegionSizes->SetValue(l, sizes[r]);
+    for (int j = 0; j < 6; j++)
+      {
+      this->ExtractedRegionExtents->SetValue(6*l + j, extents[6*r + j]);
+      }
+    }
+
+  // write the labels to the output
+  switch (labelType)
+    {
+    vtkTemplateAliasMacro(
+      vtkICFWriteLabels<VTK_TT> writer(&info, outData, labels);
+      vtkSMPTools::For(0, numSlabs, 1, writer));
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageConnectivityFilter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "ScalarRange: " << this->ScalarRange[0] << " "
+     << this->ScalarRange[1] << "\n";
+  os << indent << "ActiveComponent: " << this->ActiveComponent << "\n";
+  os << indent << "Connectivity: " << this->Connectivity << "\n";
+  os << indent << "ExtractionMode: "
+     << this->GetExtractionModeAsString() << "\n";
+  os << indent << "NumberOfLargestRegions: "
+     << this->NumberOfLargestRegions << "\n";
+  os << indent << "LabelScalarType: "
+     << this->GetLabelScalarTypeAsString() << "\n";
+  os << indent << "NumberOfRegions: " << this->NumberOfRegions << "\n";
+  os << indent << "NumberOfExtractedRegions: "
+     << this->GetNumberOfExtractedRegions() << "\n";
+}
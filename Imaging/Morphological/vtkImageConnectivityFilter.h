@@ -0,0 +1,165 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageConnectivityFilter.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkImageConnectivityFilter - Label all connected regions in an image.
+// .SECTION Description
+// vtkImageConnectivityFilter labels every connected region of the voxels
+// whose values are within the ScalarRange.  Unlike the seed-based filters
+// vtkImageSeedConnectivity and vtkImageThresholdConnectivity, it finds
+// all of the regions in a single pass.  The output is a label image in
+// which the voxels of each region are set to the region's label and all
+// other voxels are set to zero.  The regions are labelled in order of
+// decreasing size, so the largest region has label 1.  Regions of equal
+// size are labelled in the order in which they are first encountered.
+//
+// The regions are found by extracting the runs of voxels along each row
+// of the image, and then joining runs of neighboring rows with a union-find
+// structure.  The rows are divided into slabs that are processed in
+// parallel via vtkSMPTools, after which the slabs are joined at their
+// boundaries.  The memory that is needed, beyond that of the output,
+// is proportional to the number of runs rather than to the number of
+// voxels.
+//
+// The size and the extent of each region that is kept can be retrieved
+// after the filter has executed.
+// .SECTION See also
+// vtkImageSeedConnectivity vtkImageThresholdConnectivity
+
+#ifndef vtkImageConnectivityFilter_h
+#define vtkImageConnectivityFilter_h
+
+#include "vtkImagingMorphologicalModule.h" // For export macro
+#include "vtkImageAlgorithm.h"
+
+#define VTK_IMAGE_CONNECTIVITY_ALL_REGIONS 0
+#define VTK_IMAGE_CONNECTIVITY_LARGEST_REGIONS 1
+
+class vtkIdTypeArray;
+class vtkIntArray;
+
+class VTKIMAGINGMORPHOLOGICAL_EXPORT vtkImageConnectivityFilter :
+  public vtkImageAlgorithm
+{
+public:
+  static vtkImageConnectivityFilter *New();
+  vtkTypeMacro(vtkImageConnectivityFilter, vtkImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // The range of values that are part of the regions.  The default range
+  // is [0.5, VTK_DOUBLE_MAX], which selects all nonzero voxels of images
+  // with unsigned scalars.
+  vtkSetVector2Macro(ScalarRange, double);
+  vtkGetVector2Macro(ScalarRange, double);
+
+  // Description:
+  // For multi-component images, the component that will be checked
+  // against the ScalarRange.  The default is zero.
+  vtkSetMacro(ActiveComponent, int);
+  vtkGetMacro(ActiveComponent, int);
+
+  // Description:
+  // The number of neighbors of each voxel: 6 (voxels that share a face),
+  // 18 (voxels that share a face or an edge), or 26 (voxels that share a
+  // face, an edge or a corner).  The default is 6.
+  vtkSetMacro(Connectivity, int);
+  void SetConnectivityTo6() { this->SetConnectivity(6); }
+  void SetConnectivityTo18() { this->SetConnectivity(18); }
+  void SetConnectivityTo26() { this->SetConnectivity(26); }
+  vtkGetMacro(Connectivity, int);
+
+  // Description:
+  // Choose whether to keep all regions, or only the largest regions.
+  // The default is to keep all regions.
+  vtkSetClampMacro(ExtractionMode, int, VTK_IMAGE_CONNECTIVITY_ALL_REGIONS,
+                   VTK_IMAGE_CONNECTIVITY_LARGEST_REGIONS);
+  void SetExtractionModeToAllRegions() {
+    this->SetExtractionMode(VTK_IMAGE_CONNECTIVITY_ALL_REGIONS); };
+  void SetExtractionModeToLargestRegions() {
+    this->SetExtractionMode(VTK_IMAGE_CONNECTIVITY_LARGEST_REGIONS); };
+  vtkGetMacro(ExtractionMode, int);
+  const char *GetExtractionModeAsString();
+
+  // Description:
+  // The number of regions to keep when the ExtractionMode is set to
+  // LargestRegions.  The default is 1.
+  vtkSetClampMacro(NumberOfLargestRegions, int, 1, VTK_INT_MAX);
+  vtkGetMacro(NumberOfLargestRegions, int);
+
+  // Description:
+  // The scalar type of the label image.  The default is unsigned short.
+  // If there are more regions than the type can label, then only the
+  // largest regions are kept and a warning is issued.
+  vtkSetMacro(LabelScalarType, int);
+  void SetLabelScalarTypeToUnsignedChar() {
+    this->SetLabelScalarType(VTK_UNSIGNED_CHAR); }
+  void SetLabelScalarTypeToShort() {
+    this->SetLabelScalarType(VTK_SHORT); }
+  void SetLabelScalarTypeToUnsignedShort() {
+    this->SetLabelScalarType(VTK_UNSIGNED_SHORT); }
+  void SetLabelScalarTypeToInt() {
+    this->SetLabelScalarType(VTK_INT); }
+  vtkGetMacro(LabelScalarType, int);
+  const char *GetLabelScalarTypeAsString();
+
+  // Description:
+  // The number of regions that were found, including any that were
+  // not kept because of the ExtractionMode.
+  vtkGetMacro(NumberOfRegions, vtkIdType);
+
+  // Description:
+  // The number of regions in the output.  The labels of these regions
+  // are 1 to NumberOfExtractedRegions.
+  vtkIdType GetNumberOfExtractedRegions();
+
+  // Description:
+  // The number of voxels in each region of the output.  The value at
+  // index i is the size of the region with label i + 1.
+  vtkIdTypeArray *GetExtractedRegionSizes() {
+    return this->ExtractedRegionSizes; }
+
+  // Description:
+  // The extent of each region of the output, as a six-component array.
+  // The tuple at index i is the extent of the region with label i + 1.
+  vtkIntArray *GetExtractedRegionExtents() {
+    return this->ExtractedRegionExtents; }
+
+protected:
+  vtkImageConnectivityFilter();
+  ~vtkImageConnectivityFilter();
+
+  double ScalarRange[2];
+  int ActiveComponent;
+  int Connectivity;
+  int ExtractionMode;
+  int NumberOfLargestRegions;
+  int LabelScalarType;
+  vtkIdType NumberOfRegions;
+
+  vtkIdTypeArray *ExtractedRegionSizes;
+  vtkIntArray *ExtractedRegionExtents;
+
+  virtual int RequestInformation(vtkInformation *, vtkInformationVector **,
+                                 vtkInformationVector *);
+  virtual int RequestUpdateExtent(vtkInformation *, vtkInformationVector **,
+                                  vtkInformationVector *);
+  virtual int RequestData(vtkInformation *, vtkInformationVector **,
+                          vtkInformationVector *);
+
+private:
+  vtkImageConnectivityFilter(const vtkImageConnectivityFilter&);  // Not implemented.
+  void operator=(const vtkImageConnectivityFilter&);  // Not implemented.
+};
+
+#endif
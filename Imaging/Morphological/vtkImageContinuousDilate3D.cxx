@@ -15,6 +15,7 @@
 #include "vtkImageContinuousDilate3D.h"
 
 #include "vtkDataArray.h"
+#include "vtkImageBoxMorphology.h"
 #include "vtkImageData.h"
 #include "vtkImageEllipsoidSource.h"
 #include "vtkInformation.h"
@@ -31,6 +32,7 @@ vtkStandardNewMacro(vtkImageContinuousDilate3D);
 vtkImageContinuousDilate3D::vtkImageContinuousDilate3D()
 {
   this->HandleBoundaries = 1;
+  this->BoxKernel = 0;
   this->KernelSize[0] = 0;
   this->KernelSize[1] = 0;
   this->KernelSize[2] = 0;
@@ -54,6 +56,7 @@ vtkImageContinuousDilate3D::~vtkImageContinuousDilate3D()
 void vtkImageContinuousDilate3D::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "BoxKernel: " << (this->BoxKernel ? "On\n" : "Off\n");
 }
 
 //----------------------------------------------------------------------------
@@ -321,6 +324,14 @@ void vtkImageContinuousDilate3D::ThreadedRequestData(
     return;
     }
 
+  if (this->BoxKernel)
+    {
+    vtkImageBoxMorphology::Execute(inData[0][0], inArray, inExt,
+                                   outData[0], outExt, this->KernelSize,
+                                   this->KernelMiddle, VTK_IMAGE_BOX_MAXIMUM);
+    return;
+    }
+
   switch (inArray->GetDataType())
     {
     vtkTemplateMacro(
@@ -15,6 +15,7 @@
 #include "vtkImageContinuousErode3D.h"
 
 #include "vtkDataArray.h"
+#include "vtkImageBoxMorphology.h"
 #include "vtkImageData.h"
 #include "vtkImageEllipsoidSource.h"
 #include "vtkInformation.h"
@@ -31,6 +32,7 @@ vtkStandardNewMacro(vtkImageContinuousErode3D);
 vtkImageContinuousErode3D::vtkImageContinuousErode3D()
 {
   this->HandleBoundaries = 1;
+  this->BoxKernel = 0;
   this->KernelSize[0] = 1;
   this->KernelSize[1] = 1;
   this->KernelSize[2] = 1;
@@ -54,6 +56,7 @@ vtkImageContinuousErode3D::~vtkImageContinuousErode3D()
 void vtkImageContinuousErode3D::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "BoxKernel: " << (this->BoxKernel ? "On\n" : "Off\n");
 }
 
 //----------------------------------------------------------------------------
@@ -319,6 +322,14 @@ void vtkImageContinuousErode3D::ThreadedRequestData(
     return;
     }
 
+  if (this->BoxKernel)
+    {
+    vtkImageBoxMorphology::Execute(inData[0][0], inArray, inExt,
+                                   outData[0], outExt, this->KernelSize,
+                                   this->KernelMiddle, VTK_IMAGE_BOX_MINIMUM);
+    return;
+    }
+
   switch (inArray->GetDataType())
     {
     vtkTemplateMacro(
@@ -13,11 +13,13 @@
 
 =========================================================================*/
 #include "vtkImageDilateErode3D.h"
+#include "vtkImageBoxMorphology.h"
 #include "vtkImageData.h"
 #include "vtkImageEllipsoidSource.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
+#include "vtkPointData.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 vtkStandardNewMacro(vtkImageDilateErode3D);
@@ -28,6 +30,7 @@ vtkStandardNewMacro(vtkImageDilateErode3D);
 vtkImageDilateErode3D::vtkImageDilateErode3D()
 {
   this->HandleBoundaries = 1;
+  this->BoxKernel = 0;
   this->KernelSize[0] = 1;
   this->KernelSize[1] = 1;
   this->KernelSize[2] = 1;
@@ -54,6 +57,7 @@ vtkImageDilateErode3D::~vtkImageDilateErode3D()
 void vtkImageDilateErode3D::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "BoxKernel: " << (this->BoxKernel ? "On\n" : "Off\n");
 
   os << indent << "DilateValue: " << this->DilateValue << "\n";
   os << indent << "ErodeValue: " << this->ErodeValue << "\n";
@@ -306,6 +310,15 @@ void vtkImageDilateErode3D::ThreadedRequestData(
     return;
     }
 
+  if (this->BoxKernel)
+    {
+    vtkImageBoxMorphology::ExecuteDilateErode(
+      inData[0][0], inData[0][0]->GetPointData()->GetScalars(), inExt,
+      outData[0], outExt, this->KernelSize, this->KernelMiddle,
+      this->DilateValue, this->ErodeValue);
+    return;
+    }
+
   switch (inData[0][0]->GetScalarType())
     {
     vtkTemplateMacro(
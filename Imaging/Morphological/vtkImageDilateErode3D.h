@@ -45,6 +45,15 @@ public:
   // default middle of the neighborhood and computes the elliptical foot print.
   void SetKernelSize(int size0, int size1, int size2);
 
+  // Description:
+  // Use a box of KernelSize voxels instead of an ellipsoid.  The box is
+  // computed one axis at a time with the van Herk/Gil-Werman algorithm,
+  // so the time taken does not depend on the kernel size.  The default
+  // is off.
+  vtkSetMacro(BoxKernel, int);
+  vtkGetMacro(BoxKernel, int);
+  vtkBooleanMacro(BoxKernel, int);
+
 
   // Description:
   // Set/Get the Dilate and Erode values to be used by this filter.
@@ -58,6 +67,7 @@ protected:
   ~vtkImageDilateErode3D();
 
   vtkImageEllipsoidSource *Ellipse;
+  int BoxKernel;
   double DilateValue;
   double ErodeValue;
 
@@ -245,6 +245,32 @@ void vtkImageOpenClose3D::SetKernelSize(int size0, int size1, int size2)
   // Sub filters take care of modified.
 }
 
+//----------------------------------------------------------------------------
+// Selects a box kernel, which is fast for any kernel size.
+void vtkImageOpenClose3D::SetBoxKernel(int box)
+{
+  if ( ! this->Filter0 || ! this->Filter1)
+    {
+    vtkErrorMacro(<< "SetBoxKernel: Sub filter not created yet.");
+    return;
+    }
+
+  this->Filter0->SetBoxKernel(box);
+  this->Filter1->SetBoxKernel(box);
+}
+
+//----------------------------------------------------------------------------
+int vtkImageOpenClose3D::GetBoxKernel()
+{
+  if ( ! this->Filter0)
+    {
+    vtkErrorMacro(<< "GetBoxKernel: Sub filter not created yet.");
+    return 0;
+    }
+
+  return this->Filter0->GetBoxKernel();
+}
+
 //----------------------------------------------------------------------------
 // Determines the value that will closed.
 // Close value is first dilated, and then eroded
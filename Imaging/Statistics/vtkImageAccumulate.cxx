@@ -20,6 +20,7 @@
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMath.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
@@ -124,55 +125,63 @@ vtkImageStencilData *vtkImageAccumulate::GetStencil()
 
 
 //----------------------------------------------------------------------------
-// This templated function executes the filter for any type of data.
-template <class T>
-void vtkImageAccumulateExecute(vtkImageAccumulate *self,
-                               vtkImageData *inData, T *,
-                               vtkImageData *outData, vtkIdType *outPtr,
-                               double min[3], double max[3],
-                               double mean[3],
-                               double standardDeviation[3],
-                               vtkIdType *voxelCount,
-                               int* updateExtent)
-{
-  // variables used to compute statistics (filter handles max 3 components)
-  double sum[3];
-  sum[0] = sum[1] = sum[2] = 0.0;
-  double sumSqr[3];
-  sumSqr[0] = sumSqr[1] = sumSqr[2] = 0.0;
-  min[0] = min[1] = min[2] = VTK_DOUBLE_MAX;
-  max[0] = max[1] = max[2] = VTK_DOUBLE_MIN;
-  standardDeviation[0] = standardDeviation[1] = standardDeviation[2] = 0.0;
-  *voxelCount = 0;
-
-  // input's number of components is used as output dimensionality
-  int numC = inData->GetNumberOfScalarComponents();
+// anonymous namespace for internal classes and functions
+namespace {
 
-  // get information for output data
-  int outExtent[6];
-  outData->GetExtent(outExtent);
-  vtkIdType outIncs[3];
-  outData->GetIncrements(outIncs);
-  double origin[3];
-  outData->GetOrigin(origin);
-  double spacing[3];
-  outData->GetSpacing(spacing);
+struct vtkImageAccumulateThreadStruct
+{
+  vtkImageAccumulate *Algorithm;
+  vtkInformation *Request;
+  vtkInformationVector **InputsInfo;
+  vtkInformationVector *OutputsInfo;
+};
 
-  // zero count in every bin
-  vtkIdType size = 1;
-  size *= (outExtent[1] - outExtent[0] + 1);
-  size *= (outExtent[3] - outExtent[2] + 1);
-  size *= (outExtent[5] - outExtent[4] + 1);
-  for (vtkIdType j = 0; j < size; j++)
+//----------------------------------------------------------------------------
+// override from vtkThreadedImageAlgorithm to split input extent, instead
+// of splitting the output extent
+VTK_THREAD_RETURN_TYPE vtkImageAccumulateThreadedExecute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *ti =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkImageAccumulateThreadStruct *ts =
+    static_cast<vtkImageAccumulateThreadStruct *>(ti->UserData);
+
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  vtkInformation *inInfo = ts->InputsInfo[0]->GetInformationObject(0);
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), extent);
+
+  // execute the actual method with appropriate extent
+  // first find out how many pieces extent can be split into.
+  int splitExt[6];
+  int total = ts->Algorithm->SplitExtent(
+    splitExt, extent, ti->ThreadID, ti->NumberOfThreads);
+
+  if (ti->ThreadID < total &&
+      splitExt[1] >= splitExt[0] &&
+      splitExt[3] >= splitExt[2] &&
+      splitExt[5] >= splitExt[4])
     {
-    outPtr[j] = 0;
+    ts->Algorithm->ThreadedRequestData(
+      ts->Request, ts->InputsInfo, ts->OutputsInfo, NULL, NULL,
+      splitExt, ti->ThreadID);
     }
 
-  vtkImageStencilData *stencil = self->GetStencil();
-  bool reverseStencil = (self->GetReverseStencil() != 0);
-  bool ignoreZero = (self->GetIgnoreZero() != 0);
+  return VTK_THREAD_RETURN_VALUE;
+}
 
-  vtkImageStencilIterator<T> inIter(inData, stencil, updateExtent, self);
+//----------------------------------------------------------------------------
+// Compute the statistics of a piece of the image, and the range of all
+// of the values within the stencil, which gives the bins that are used.
+template <class T>
+void vtkImageAccumulateExecuteStatistics(
+  vtkImageData *inData, vtkImageStencilData *stencil, int extent[6],
+  bool reverseStencil, bool ignoreZero, double range[3][2],
+  vtkIdType count[3], double mean[3], double sumOfSquares[3],
+  double min[3], double max[3])
+{
+  int numC = inData->GetNumberOfScalarComponents();
+
+  vtkImageStencilIterator<T> inIter(inData, stencil, extent, NULL);
 
   while (!inIter.IsAtEnd())
     {
@@ -183,17 +192,18 @@ void vtkImageAccumulateExecute(vtkImageAccumulate *self,
 
       while (inPtr != spanEndPtr)
         {
-        // find the bin for this pixel.
-        bool outOfBounds = false;
-        vtkIdType *outPtrC = outPtr;
         for (int idxC = 0; idxC < numC; ++idxC)
           {
           double v = static_cast<double>(*inPtr++);
+          range[idxC][0] = (v < range[idxC][0] ? v : range[idxC][0]);
+          range[idxC][1] = (v > range[idxC][1] ? v : range[idxC][1]);
+
           if (!ignoreZero || v != 0)
             {
-            // gather statistics
-            sum[idxC] += v;
-            sumSqr[idxC] += v*v;
+            // Welford's update of the mean and the sum of squares
+            double delta = v - mean[idxC];
+            mean[idxC] += delta/(++count[idxC]);
+            sumOfSquares[idxC] += delta*(v - mean[idxC]);
             if (v > max[idxC])
               {
               max[idxC] = v;
@@ -202,16 +212,56 @@ void vtkImageAccumulateExecute(vtkImageAccumulate *self,
               {
               min[idxC] = v;
               }
-            (*voxelCount)++;
             }
+          }
+        }
+      }
+
+    inIter.NextSpan();
+    }
+}
+
+//----------------------------------------------------------------------------
+// Count the values of a piece of the image in the bins of binExt.
+template <class T>
+void vtkImageAccumulateExecuteBins(
+  vtkImageAccumulate *self, vtkImageData *inData,
+  vtkImageStencilData *stencil, int extent[6], bool reverseStencil,
+  const double origin[3], const double spacing[3], const int binExt[6],
+  vtkIdType *outPtr, int threadId)
+{
+  int numC = inData->GetNumberOfScalarComponents();
+
+  vtkIdType binIncs[3];
+  binIncs[0] = 1;
+  binIncs[1] = binIncs[0]*(binExt[1] - binExt[0] + 1);
+  binIncs[2] = binIncs[1]*(binExt[3] - binExt[2] + 1);
+
+  vtkImageStencilIterator<T> inIter(inData, stencil, extent, self, threadId);
+
+  while (!inIter.IsAtEnd())
+    {
+    if (inIter.IsInStencil() ^ reverseStencil)
+      {
+      T *inPtr = inIter.BeginSpan();
+      T *spanEndPtr = inIter.EndSpan();
+
+      while (inPtr != spanEndPtr)
+        {
+        // find the bin for this pixel.
+        bool outOfBounds = false;
+        vtkIdType *outPtrC = outPtr;
+        for (int idxC = 0; idxC < numC; ++idxC)
+          {
+          double v = static_cast<double>(*inPtr++);
 
           // compute the index
           int outIdx = vtkMath::Floor((v - origin[idxC]) / spacing[idxC]);
 
           // verify that it is in range
-          if (outIdx >= outExtent[idxC*2] && outIdx <= outExtent[idxC*2+1])
+          if (outIdx >= binExt[idxC*2] && outIdx <= binExt[idxC*2+1])
             {
-            outPtrC += (outIdx - outExtent[idxC*2]) * outIncs[idxC];
+            outPtrC += (outIdx - binExt[idxC*2]) * binIncs[idxC];
             }
           else
             {
@@ -229,53 +279,42 @@ void vtkImageAccumulateExecute(vtkImageAccumulate *self,
 
     inIter.NextSpan();
     }
+}
 
-  // initialize the statistics
-  mean[0] = 0;
-  mean[1] = 0;
-  mean[2] = 0;
-
-  standardDeviation[0] = 0;
-  standardDeviation[1] = 0;
-  standardDeviation[2] = 0;
-
-  if (*voxelCount != 0) // avoid the div0
+//----------------------------------------------------------------------------
+// Get the bin of a value, clamped to one past the ends of [lo, hi] so that
+// values far out of range cannot overflow the int.
+int vtkImageAccumulateClampedBin(double v, double origin, double spacing,
+                                 int lo, int hi)
+{
+  double x = (v - origin) / spacing;
+  if (!(x >= lo - 1.0))
     {
-    double n = static_cast<double>(*voxelCount);
-    mean[0] = sum[0]/n;
-    mean[1] = sum[1]/n;
-    mean[2] = sum[2]/n;
-
-    if (*voxelCount - 1 != 0) // avoid the div0
-      {
-      double m = static_cast<double>(*voxelCount - 1);
-      standardDeviation[0] = sqrt((sumSqr[0] - mean[0]*mean[0]*n)/m);
-      standardDeviation[1] = sqrt((sumSqr[1] - mean[1]*mean[1]*n)/m);
-      standardDeviation[2] = sqrt((sumSqr[2] - mean[2]*mean[2]*n)/m);
-      }
+    return lo - 1;
     }
-
+  if (x > hi + 1.0)
+    {
+    return hi + 1;
+    }
+  return vtkMath::Floor(x);
 }
 
+} // end anonymous namespace
 
 //----------------------------------------------------------------------------
 // This method is passed a input and output Data, and executes the filter
 // algorithm to fill the output from the input.
-// It just executes a switch statement to call the correct function for
-// the Datas data types.
+// It sets up the threads, and then merges the bins and the statistics
+// that each thread has computed for its piece of the input.
 int vtkImageAccumulate::RequestData(
-  vtkInformation* vtkNotUsed( request ),
+  vtkInformation* request,
   vtkInformationVector** inputVector,
   vtkInformationVector* outputVector)
 {
-  void *inPtr;
-  void *outPtr;
-
   // get the input
   vtkInformation* in1Info = inputVector[0]->GetInformationObject(0);
   vtkImageData *inData = vtkImageData::SafeDownCast(
     in1Info->Get(vtkDataObject::DATA_OBJECT()));
-  int *uExt = in1Info->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT());
 
   // get the output
   vtkInformation *outInfo = outputVector->GetInformationObject(0);
@@ -289,10 +328,6 @@ int vtkImageAccumulate::RequestData(
   outData->SetExtent(outInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()));
   outData->AllocateScalars(outInfo);
 
-  vtkDataArray *inArray = this->GetInputArrayToProcess(0,inputVector);
-  inPtr = inData->GetArrayPointerForExtent(inArray, uExt);
-  outPtr = outData->GetScalarPointer();
-
   // Components turned into x, y and z
   if (inData->GetNumberOfScalarComponents() > 3)
     {
@@ -308,26 +343,238 @@ int vtkImageAccumulate::RequestData(
     return 1;
     }
 
+  // clear the thread outputs
+  int n = this->GetNumberOfThreads();
+  for (int k = 0; k < n; k++)
+    {
+    this->ThreadOutput[k] = 0;
+    for (int idxC = 0; idxC < 3; ++idxC)
+      {
+      this->ThreadBinExtent[k][2*idxC] = 0;
+      this->ThreadBinExtent[k][2*idxC+1] = -1;
+      this->ThreadCount[k][idxC] = 0;
+      this->ThreadMean[k][idxC] = 0.0;
+      this->ThreadSumOfSquares[k][idxC] = 0.0;
+      this->ThreadMin[k][idxC] = VTK_DOUBLE_MAX;
+      this->ThreadMax[k][idxC] = VTK_DOUBLE_MIN;
+      }
+    }
+
+  // setup the threads structure
+  vtkImageAccumulateThreadStruct ts;
+  ts.Algorithm = this;
+  ts.Request = request;
+  ts.InputsInfo = inputVector;
+  ts.OutputsInfo = outputVector;
+
+  this->Threader->SetNumberOfThreads(n);
+  this->Threader->SetSingleMethod(vtkImageAccumulateThreadedExecute, &ts);
+
+  // always shut off debugging to avoid threading problems with GetMacros
+  bool debug = this->Debug;
+  this->Debug = false;
+  this->Threader->SingleMethodExecute();
+  this->Debug = debug;
+
+  // zero count in every bin
+  int outExt[6];
+  outData->GetExtent(outExt);
+  vtkIdType outIncs[3];
+  outData->GetIncrements(outIncs);
+  vtkIdType *outPtr = static_cast<vtkIdType *>(outData->GetScalarPointer());
+  vtkIdType size = 1;
+  size *= (outExt[1] - outExt[0] + 1);
+  size *= (outExt[3] - outExt[2] + 1);
+  size *= (outExt[5] - outExt[4] + 1);
+  for (vtkIdType j = 0; j < size; j++)
+    {
+    outPtr[j] = 0;
+    }
+
+  // merge the results of the threads, in order so that the result does
+  // not depend on the timing of the threads
+  vtkIdType count[3] = { 0, 0, 0 };
+  double sumOfSquares[3] = { 0.0, 0.0, 0.0 };
+  for (int idxC = 0; idxC < 3; ++idxC)
+    {
+    this->Min[idxC] = VTK_DOUBLE_MAX;
+    this->Max[idxC] = VTK_DOUBLE_MIN;
+    this->Mean[idxC] = 0.0;
+    this->StandardDeviation[idxC] = 0.0;
+    }
+
+  for (int k = 0; k < n; k++)
+    {
+    vtkIdType *binPtr = this->ThreadOutput[k];
+    if (binPtr)
+      {
+      int *binExt = this->ThreadBinExtent[k];
+      for (int idxZ = binExt[4]; idxZ <= binExt[5]; ++idxZ)
+        {
+        for (int idxY = binExt[2]; idxY <= binExt[3]; ++idxY)
+          {
+          vtkIdType *outPtrX = outPtr + (idxZ - outExt[4])*outIncs[2] +
+            (idxY - outExt[2])*outIncs[1] + (binExt[0] - outExt[0]);
+          for (int idxX = binExt[0]; idxX <= binExt[1]; ++idxX)
+            {
+            *outPtrX++ += *binPtr++;
+            }
+          }
+        }
+      delete [] this->ThreadOutput[k];
+      this->ThreadOutput[k] = 0;
+      }
+
+    for (int idxC = 0; idxC < 3; ++idxC)
+      {
+      vtkIdType countB = this->ThreadCount[k][idxC];
+      if (countB == 0)
+        {
+        continue;
+        }
+      // Chan's formula for the union of two sets
+      vtkIdType countA = count[idxC];
+      double total = static_cast<double>(countA + countB);
+      double delta = this->ThreadMean[k][idxC] - this->Mean[idxC];
+      this->Mean[idxC] += delta*(countB/total);
+      sumOfSquares[idxC] += this->ThreadSumOfSquares[k][idxC] +
+        delta*delta*(countA/total)*countB;
+      count[idxC] += countB;
+
+      if (this->ThreadMin[k][idxC] < this->Min[idxC])
+        {
+        this->Min[idxC] = this->ThreadMin[k][idxC];
+        }
+      if (this->ThreadMax[k][idxC] > this->Max[idxC])
+        {
+        this->Max[idxC] = this->ThreadMax[k][idxC];
+        }
+      }
+    }
+
+  this->VoxelCount = count[0] + count[1] + count[2];
+  for (int idxC = 0; idxC < 3; ++idxC)
+    {
+    if (count[idxC] > 1) // avoid the div0
+      {
+      this->StandardDeviation[idxC] =
+        sqrt(sumOfSquares[idxC]/(count[idxC] - 1));
+      }
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// This method accumulates one piece of the input into the bins and the
+// statistics of the thread.  It first computes the range of the values in
+// the piece, so that it only needs bins for that range.
+void vtkImageAccumulate::ThreadedRequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector,
+  vtkImageData ***vtkNotUsed(inData),
+  vtkImageData **vtkNotUsed(outData),
+  int extent[6], int threadId)
+{
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  vtkImageData *inData = vtkImageData::SafeDownCast(
+    inInfo->Get(vtkDataObject::DATA_OBJECT()));
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkImageData *outData = vtkImageData::SafeDownCast(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  vtkImageStencilData *stencil = this->GetStencil();
+  bool reverseStencil = (this->ReverseStencil != 0);
+  bool ignoreZero = (this->IgnoreZero != 0);
+  int numC = inData->GetNumberOfScalarComponents();
+
+  double range[3][2];
+  for (int idxC = 0; idxC < 3; ++idxC)
+    {
+    range[idxC][0] = VTK_DOUBLE_MAX;
+    range[idxC][1] = VTK_DOUBLE_MIN;
+    }
+
   switch (inData->GetScalarType())
     {
-    vtkTemplateMacro(vtkImageAccumulateExecute( this,
-                                                inData,
-                                                static_cast<VTK_TT *>(inPtr),
-                                                outData,
-                                                static_cast<vtkIdType *>(outPtr),
-                                                this->Min, this->Max,
-                                                this->Mean,
-                                                this->StandardDeviation,
-                                                &this->VoxelCount,
-                                                uExt ));
+    vtkTemplateMacro(
+      vtkImageAccumulateExecuteStatistics<VTK_TT>(
+        inData, stencil, extent, reverseStencil, ignoreZero, range,
+        this->ThreadCount[threadId], this->ThreadMean[threadId],
+        this->ThreadSumOfSquares[threadId], this->ThreadMin[threadId],
+        this->ThreadMax[threadId]));
     default:
       vtkErrorMacro(<< "Execute: Unknown ScalarType");
-      return 1;
+      return;
     }
 
-  return 1;
-}
+  // if no voxels (e.g. due to stencil) then return
+  if (range[0][0] > range[0][1])
+    {
+    return;
+    }
+
+  // the bins that are needed for the range, within the output extent
+  double origin[3];
+  outData->GetOrigin(origin);
+  double spacing[3];
+  outData->GetSpacing(spacing);
+  int outExt[6];
+  outData->GetExtent(outExt);
+  int *binExt = this->ThreadBinExtent[threadId];
+  vtkIdType binCount = 1;
+  for (int idxC = 0; idxC < 3; ++idxC)
+    {
+    int lo = outExt[2*idxC];
+    int hi = outExt[2*idxC+1];
+    if (idxC < numC)
+      {
+      int b0 = vtkImageAccumulateClampedBin(
+        range[idxC][0], origin[idxC], spacing[idxC], lo, hi);
+      int b1 = vtkImageAccumulateClampedBin(
+        range[idxC][1], origin[idxC], spacing[idxC], lo, hi);
+      if (b0 > b1)
+        {
+        // the spacing is negative
+        int tmp = b0;
+        b0 = b1;
+        b1 = tmp;
+        }
+      lo = (b0 > lo ? b0 : lo);
+      hi = (b1 < hi ? b1 : hi);
+      }
+    else
+      {
+      // the unused axes of the output get the first bin
+      hi = lo;
+      }
+    if (lo > hi)
+      {
+      // no values fall into the bins
+      return;
+      }
+    binExt[2*idxC] = lo;
+    binExt[2*idxC+1] = hi;
+    binCount *= hi - lo + 1;
+    }
+
+  // allocate the bins
+  vtkIdType *bins = new vtkIdType[binCount];
+  this->ThreadOutput[threadId] = bins;
+  for (vtkIdType j = 0; j < binCount; j++)
+    {
+    bins[j] = 0;
+    }
 
+  switch (inData->GetScalarType())
+    {
+    vtkTemplateMacro(
+      vtkImageAccumulateExecuteBins<VTK_TT>(
+        this, inData, stencil, extent, reverseStencil, origin, spacing,
+        binExt, bins, threadId));
+    }
+}
 
 //----------------------------------------------------------------------------
 int vtkImageAccumulate::RequestInformation (
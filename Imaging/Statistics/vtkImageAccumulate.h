@@ -26,6 +26,13 @@
 // computed on an arbitrary portion of the input data.
 // See the documentation for vtkImageStencilData for more information.
 //
+// The input is split into pieces that are accumulated by separate threads,
+// each into its own bins and statistics, and these are merged at the end.
+// The mean and standard deviation of each piece are computed with
+// Welford's method and are combined with the pairwise formula of Chan et
+// al., which avoids the cancellation of the sum of squares for data with
+// a large mean.
+//
 // This filter also supports ignoring pixels with value equal to 0. Using this
 // option with vtkImageMask may result in results being slightly off since 0
 // could be a valid value from your input.
@@ -36,15 +43,16 @@
 #define vtkImageAccumulate_h
 
 #include "vtkImagingStatisticsModule.h" // For export macro
-#include "vtkImageAlgorithm.h"
+#include "vtkThreadedImageAlgorithm.h"
 
 class vtkImageStencilData;
 
-class VTKIMAGINGSTATISTICS_EXPORT vtkImageAccumulate : public vtkImageAlgorithm
+class VTKIMAGINGSTATISTICS_EXPORT vtkImageAccumulate :
+  public vtkThreadedImageAlgorithm
 {
 public:
   static vtkImageAccumulate *New();
-  vtkTypeMacro(vtkImageAccumulate,vtkImageAlgorithm);
+  vtkTypeMacro(vtkImageAccumulate,vtkThreadedImageAlgorithm);
   void PrintSelf(ostream& os, vtkIndent indent);
 
   // Description:
@@ -100,6 +108,9 @@ public:
   // Description:
   // Get the statistics information for the data.
   // The values only make sense after the execution of the filter.
+  // The statistics of each component are computed over the values of
+  // that component that are not ignored, and VoxelCount is the number
+  // of these values summed over all components.
   // Initial values are 0.
   vtkGetVector3Macro(Min, double);
   vtkGetVector3Macro(Max, double);
@@ -113,6 +124,15 @@ public:
   vtkGetMacro(IgnoreZero, int);
   vtkBooleanMacro(IgnoreZero, int);
 
+  // Description:
+  // This is part of the executive, but is public so that it can be accessed
+  // by non-member functions.
+  virtual void ThreadedRequestData(vtkInformation *request,
+                                   vtkInformationVector **inputVector,
+                                   vtkInformationVector *outputVector,
+                                   vtkImageData ***inData,
+                                   vtkImageData **outData, int ext[6], int id);
+
 protected:
   vtkImageAccumulate();
   ~vtkImageAccumulate();
@@ -140,6 +160,16 @@ protected:
 
   int ReverseStencil;
 
+  // The bins and the statistics of the piece done by each thread, the
+  // bins cover ThreadBinExtent, which is empty if there are none.
+  vtkIdType *ThreadOutput[VTK_MAX_THREADS];
+  int ThreadBinExtent[VTK_MAX_THREADS][6];
+  vtkIdType ThreadCount[VTK_MAX_THREADS][3];
+  double ThreadMean[VTK_MAX_THREADS][3];
+  double ThreadSumOfSquares[VTK_MAX_THREADS][3];
+  double ThreadMin[VTK_MAX_THREADS][3];
+  double ThreadMax[VTK_MAX_THREADS][3];
+
   virtual int FillInputPortInformation(int port, vtkInformation* info);
 
 private:
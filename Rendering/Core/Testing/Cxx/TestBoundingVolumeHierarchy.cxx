@@ -0,0 +1,240 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestBoundingVolumeHierarchy.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks the items vtkBoundingVolumeHierarchy finds in a frustum against
+// testing every item, before and after moving some of them, and checks
+// that vtkFrustumCoverageCuller culls the same props with and without its
+// hierarchy.
+
+#include "vtkBoundingVolumeHierarchy.h"
+#include "vtkCamera.h"
+#include "vtkFrustumCoverageCuller.h"
+#include "vtkIdList.h"
+#include "vtkMath.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkProp.h"
+#include "vtkRenderer.h"
+#include "vtkSmartPointer.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+// A prop with given bounds.
+class BoundsProp : public vtkProp
+{
+public:
+  static BoundsProp *New();
+  vtkTypeMacro(BoundsProp, vtkProp);
+  double *GetBounds() { return this->Bounds; }
+  double Bounds[6];
+};
+vtkStandardNewMacro(BoundsProp);
+
+const int NumberOfItems = 5000;
+
+void RandomBounds(vtkMinimalStandardRandomSequence *random, double scale,
+                  double bounds[6])
+{
+  for (int j = 0; j < 3; ++j)
+    {
+    random->Next();
+    double center = random->GetRangeValue(-100.0, 100.0);
+    random->Next();
+    double size = random->GetRangeValue(0.0, scale);
+    bounds[2*j] = center - size;
+    bounds[2*j + 1] = center + size;
+    }
+}
+
+bool IntersectsFrustum(const double planes[24], const double b[6])
+{
+  for (int i = 0; i < 6; ++i)
+    {
+    const double *p = planes + 4*i;
+    if (p[0]*(p[0] > 0.0 ? b[1] : b[0]) + p[1]*(p[1] > 0.0 ? b[3] : b[2]) +
+        p[2]*(p[2] > 0.0 ? b[5] : b[4]) + p[3] < 0.0)
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+// The coverage vtkFrustumCoverageCuller computes for the bounding sphere.
+double Coverage(const double planes[24], const double b[6])
+{
+  double center[3] = { 0.5*(b[0] + b[1]), 0.5*(b[2] + b[3]),
+                       0.5*(b[4] + b[5]) };
+  double radius = 0.5*sqrt((b[1] - b[0])*(b[1] - b[0]) +
+                           (b[3] - b[2])*(b[3] - b[2]) +
+                           (b[5] - b[4])*(b[5] - b[4]));
+  double d[4];
+  for (int i = 0; i < 4; ++i)
+    {
+    d[i] = vtkMath::Dot(planes + 4*i, center) + planes[4*i + 3] - radius;
+    }
+  double fullW = d[0] + d[1] + 2.0*radius;
+  double fullH = d[2] + d[3] + 2.0*radius;
+  double partW = fullW - (d[0] > 0.0 ? d[0] : 0.0) - (d[1] > 0.0 ? d[1] : 0.0);
+  double partH = fullH - (d[2] > 0.0 ? d[2] : 0.0) - (d[3] > 0.0 ? d[3] : 0.0);
+  return (fullW*fullH != 0.0 ? partW*partH/(fullW*fullH) : 0.0);
+}
+
+int CheckItems(vtkBoundingVolumeHierarchy *bvh, vtkCamera *camera,
+               double minimumCoverage, const char *what)
+{
+  double planes[24];
+  camera->GetFrustumPlanes(1.0, planes);
+  vtkNew<vtkIdList> items;
+  bvh->FindItemsInFrustum(planes, minimumCoverage, items.GetPointer());
+
+  std::vector<char> found(bvh->GetNumberOfItems(), 0);
+  for (vtkIdType i = 0; i < items->GetNumberOfIds(); ++i)
+    {
+    found[items->GetId(i)] = 1;
+    }
+  vtkIdType numInFrustum = 0;
+  for (vtkIdType id = 0; id < bvh->GetNumberOfItems(); ++id)
+    {
+    double b[6];
+    bvh->GetItemBounds(id, b);
+    bool inFrustum = IntersectsFrustum(planes, b);
+    numInFrustum += (inFrustum ? 1 : 0);
+    // without coverage, exactly the items in the frustum are found, and
+    // with coverage, the items covering enough at least
+    if ((found[id] && !inFrustum) ||
+        (!found[id] && inFrustum &&
+         (minimumCoverage == 0.0 || Coverage(planes, b) >= minimumCoverage)))
+      {
+      cerr << what << ": item " << id << " is " << (found[id] ? "" : "not ")
+           << "found" << endl;
+      return 1;
+      }
+    }
+  cout << what << ": " << items->GetNumberOfIds() << " items found of "
+       << numInFrustum << " in the frustum, "
+       << bvh->GetNumberOfVisitedNodes() << " nodes visited" << endl;
+  return 0;
+}
+
+}
+
+int TestBoundingVolumeHierarchy(int, char *[])
+{
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  vtkNew<vtkBoundingVolumeHierarchy> bvh;
+  bvh->SetNumberOfItems(NumberOfItems);
+  for (int id = 0; id < NumberOfItems; ++id)
+    {
+    double bounds[6];
+    RandomBounds(random.GetPointer(), 1.0, bounds);
+    bvh->SetItemBounds(id, bounds);
+    }
+
+  // close to the items, few of them are in view
+  vtkNew<vtkCamera> camera;
+  camera->SetPosition(0.0, 0.0, 120.0);
+  camera->SetFocalPoint(0.0, 0.0, 0.0);
+  camera->SetViewAngle(10.0);
+  camera->SetClippingRange(1.0, 100.0);
+  int rval = CheckItems(bvh.GetPointer(), camera.GetPointer(), 0.0, "Near");
+  if (bvh->GetNumberOfVisitedNodes() >= NumberOfItems/4)
+    {
+    cerr << "Too many nodes visited" << endl;
+    rval = 1;
+    }
+
+  // all of them and the coverage
+  camera->SetPosition(0.0, 0.0, 600.0);
+  camera->SetViewAngle(30.0);
+  camera->SetClippingRange(300.0, 900.0);
+  rval |= CheckItems(bvh.GetPointer(), camera.GetPointer(), 0.0, "Far");
+  rval |= CheckItems(bvh.GetPointer(), camera.GetPointer(), 1e-4,
+                     "Far with coverage");
+  camera->SetPosition(-10.0, 200.0, 50.0);
+  camera->SetFocalPoint(20.0, 0.0, -30.0);
+  camera->SetClippingRange(10.0, 400.0);
+  rval |= CheckItems(bvh.GetPointer(), camera.GetPointer(), 1e-5,
+                     "Inside with coverage");
+
+  // moving a few items refits the tree, moving them all builds it again
+  int buildCount = bvh->GetBuildCount();
+  for (int id = 0; id < NumberOfItems; id += 100)
+    {
+    double bounds[6];
+    bvh->GetItemBounds(id, bounds);
+    bounds[0] -= 0.5;
+    bounds[3] += 0.5;
+    bvh->SetItemBounds(id, bounds);
+    }
+  rval |= CheckItems(bvh.GetPointer(), camera.GetPointer(), 0.0, "Refit");
+  if (bvh->GetBuildCount() != buildCount)
+    {
+    cerr << "Moving a few items built the tree again" << endl;
+    rval = 1;
+    }
+  for (int id = 0; id < NumberOfItems; ++id)
+    {
+    double bounds[6];
+    RandomBounds(random.GetPointer(), 1.0, bounds);
+    bvh->SetItemBounds(id, bounds);
+    }
+  rval |= CheckItems(bvh.GetPointer(), camera.GetPointer(), 0.0, "Moved");
+  if (bvh->GetBuildCount() != buildCount + 1)
+    {
+    cerr << "Moving all the items did not build the tree again" << endl;
+    rval = 1;
+    }
+
+  // the culler culls the same props with and without the hierarchy
+  vtkNew<vtkRenderer> renderer;
+  renderer->SetActiveCamera(camera.GetPointer());
+  std::vector<vtkSmartPointer<BoundsProp> > props(NumberOfItems);
+  for (int id = 0; id < NumberOfItems; ++id)
+    {
+    props[id] = vtkSmartPointer<BoundsProp>::New();
+    RandomBounds(random.GetPointer(), 5.0, props[id]->Bounds);
+    }
+  vtkNew<vtkFrustumCoverageCuller> culler;
+  culler->SetMinimumCoverage(1e-4);
+  culler->SetSortingStyleToFrontToBack();
+  std::vector<vtkProp*> lists[2];
+  int lengths[2];
+  for (int useHierarchy = 0; useHierarchy < 2; ++useHierarchy)
+    {
+    culler->SetUseHierarchy(useHierarchy);
+    lists[useHierarchy].assign(props.begin(), props.end());
+    lengths[useHierarchy] = NumberOfItems;
+    int initialized = 0;
+    culler->Cull(renderer.GetPointer(), &lists[useHierarchy][0],
+                 lengths[useHierarchy], initialized);
+    }
+  cout << "Culler: " << lengths[1] << " props of " << NumberOfItems
+       << " kept" << endl;
+  if (lengths[0] != lengths[1] ||
+      !std::equal(lists[0].begin(), lists[0].begin() + lengths[0],
+                  lists[1].begin()))
+    {
+    cerr << "The culler kept " << lengths[1] << " props with its hierarchy "
+         << "and " << lengths[0] << " without" << endl;
+    rval = 1;
+    }
+
+  return rval;
+}
@@ -0,0 +1,162 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCellCenterRadixSort.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkCellCenterRadixSort returns all the cells back to front,
+// up to the quantization of the depths, that it does no pass when sorting
+// again with the same camera, and that its static Sort() is stable.
+
+#include "vtkCamera.h"
+#include "vtkCellCenterRadixSort.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkTimerLog.h"
+
+#include <algorithm>
+#include <vector>
+
+static int TestSortIds()
+{
+  const vtkIdType n = 100000;
+  std::vector<float> depths(n);
+  std::vector<vtkIdType> ids(n);
+  vtkMath::RandomSeed(1234);
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    // few distinct depths, so that many are equal
+    depths[i] = static_cast<float>(static_cast<int>(vtkMath::Random(0, 50)));
+    ids[i] = n - 1 - i;
+    }
+
+  int passes = vtkCellCenterRadixSort::Sort(n, &depths[0], &ids[0], 16);
+  std::vector<char> seen(n, 0);
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    seen[ids[i]] = 1;
+    if (i > 0 && (depths[ids[i]] < depths[ids[i-1]] ||
+                  (depths[ids[i]] == depths[ids[i-1]] && ids[i] > ids[i-1])))
+      {
+      cerr << "Ids " << ids[i-1] << " and " << ids[i] << " are out of order"
+           << endl;
+      return 1;
+      }
+    }
+  if (std::find(seen.begin(), seen.end(), 0) != seen.end() || passes < 1)
+    {
+    cerr << "The sort lost ids, or did " << passes << " passes" << endl;
+    return 1;
+    }
+  if (vtkCellCenterRadixSort::Sort(n, &depths[0], &ids[0], 16) != 0)
+    {
+    cerr << "Sorting sorted ids again should do no pass" << endl;
+    return 1;
+    }
+  return 0;
+}
+
+int TestCellCenterRadixSort(int, char *[])
+{
+  int rval = TestSortIds();
+
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(61, 41, 31);
+  image->SetSpacing(1.0, 0.5, 0.75);
+  vtkIdType numCells = image->GetNumberOfCells();
+
+  vtkNew<vtkCamera> camera;
+  camera->SetPosition(-20.0, 50.0, 80.0);
+  camera->SetFocalPoint(30.0, 10.0, 11.0);
+
+  vtkNew<vtkCellCenterRadixSort> sort;
+  sort->SetInput(image.GetPointer());
+  sort->SetCamera(camera.GetPointer());
+  sort->SetDirectionToBackToFront();
+  sort->SetMaxCellsReturned(1000);
+
+  // the distance to the camera along the view direction
+  double direction[3];
+  camera->GetDirectionOfProjection(direction);
+  double *position = camera->GetPosition();
+
+  vtkNew<vtkTimerLog> timer;
+  std::vector<vtkIdType> lastOrder;
+  for (int frame = 0; frame < 2; frame++)
+    {
+    timer->StartTimer();
+    sort->InitTraversal();
+    timer->StopTimer();
+    if (frame == 1 && sort->GetNumberOfPasses() != 0)
+      {
+      cerr << "Sorting again did " << sort->GetNumberOfPasses()
+           << " passes" << endl;
+      rval = 1;
+      }
+
+    std::vector<vtkIdType> order;
+    std::vector<char> seen(numCells, 0);
+    double lastDistance = VTK_DOUBLE_MAX;
+    for (vtkIdTypeArray *cells = sort->GetNextCells(); cells != NULL;
+         cells = sort->GetNextCells())
+      {
+      if (cells->GetNumberOfTuples() > 1000)
+        {
+        cerr << "Too many cells returned at once" << endl;
+        return 1;
+        }
+      for (vtkIdType i = 0; i < cells->GetNumberOfTuples(); i++)
+        {
+        vtkIdType cellId = cells->GetValue(i);
+        order.push_back(cellId);
+        seen[cellId] = 1;
+        int ijk[3] = { static_cast<int>(cellId % 60),
+                       static_cast<int>((cellId / 60) % 40),
+                       static_cast<int>(cellId / 2400) };
+        double center[3] = { ijk[0] + 0.5, (ijk[1] + 0.5)*0.5,
+                             (ijk[2] + 0.5)*0.75 };
+        double distance = 0.0;
+        for (int j = 0; j < 3; j++)
+          {
+          distance += (center[j] - position[j])*direction[j];
+          }
+        // back to front, up to the quantization of the depths
+        if (distance > lastDistance + 1e-4)
+          {
+          cerr << "Cell " << cellId << " at " << distance
+               << " is behind the previous one at " << lastDistance << endl;
+          return 1;
+          }
+        lastDistance = distance;
+        }
+      }
+    if (static_cast<vtkIdType>(order.size()) != numCells ||
+        std::find(seen.begin(), seen.end(), 0) != seen.end())
+      {
+      cerr << "Not all the cells were returned" << endl;
+      return 1;
+      }
+    if (frame == 1 && order != lastOrder)
+      {
+      cerr << "Sorting again changed the order" << endl;
+      rval = 1;
+      }
+    lastOrder = order;
+
+    cout << "<DartMeasurement name=\"RadixSort" << frame << "\" "
+         << "type=\"numeric/double\">" << timer->GetElapsedTime()
+         << "</DartMeasurement>" << endl;
+    }
+
+  return rval;
+}
@@ -0,0 +1,481 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkBoundingVolumeHierarchy.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkBoundingVolumeHierarchy.h"
+
+#include "vtkIdList.h"
+#include "vtkMath.h"
+#include "vtkObjectFactory.h"
+
+#include <algorithm>
+#include <vector>
+
+vtkStandardNewMacro(vtkBoundingVolumeHierarchy);
+
+//----------------------------------------------------------------------------
+class vtkBoundingVolumeHierarchyInternals
+{
+public:
+  // A leaf holds the items Order[Start] to Order[Start + Count - 1], an
+  // inner node, with Count 0, its two children.
+  struct Node
+  {
+    double Bounds[6];
+    vtkIdType Start;
+    vtkIdType Count;
+    int Left;
+    int Right;
+    int Parent;
+  };
+
+  vtkBoundingVolumeHierarchyInternals()
+  {
+    this->NeedBuild = true;
+    this->BuiltArea = 0.0;
+    this->Area = 0.0;
+  }
+
+  bool IsValid(vtkIdType id)
+  {
+    return vtkMath::AreBoundsInitialized(&this->ItemBounds[6*id]) != 0;
+  }
+
+  void Build(int maxLeafSize);
+  int BuildNode(vtkIdType start, vtkIdType end, int parent, int maxLeafSize);
+  void ComputeNodeBounds(int node);
+  void Refit();
+
+  std::vector<double> ItemBounds;
+  std::vector<int> ItemLeaf;
+  std::vector<unsigned char> ItemModified;
+  std::vector<vtkIdType> ModifiedItems;
+  std::vector<vtkIdType> Order;
+  std::vector<Node> Nodes;
+  bool NeedBuild;
+
+  // the sum of the surface areas of the nodes, when built and now
+  double BuiltArea;
+  double Area;
+};
+
+namespace
+{
+//----------------------------------------------------------------------------
+double SurfaceArea(const double b[6])
+{
+  double dx = b[1] - b[0];
+  double dy = b[3] - b[2];
+  double dz = b[5] - b[4];
+  return 2.0*(dx*dy + dy*dz + dz*dx);
+}
+
+//----------------------------------------------------------------------------
+// The smallest value of the plane function over the box.
+double MinimumOverBox(const double plane[4], const double b[6])
+{
+  return plane[0]*(plane[0] > 0.0 ? b[0] : b[1]) +
+    plane[1]*(plane[1] > 0.0 ? b[2] : b[3]) +
+    plane[2]*(plane[2] > 0.0 ? b[4] : b[5]) + plane[3];
+}
+
+//----------------------------------------------------------------------------
+// The largest value of the plane function over the box.
+double MaximumOverBox(const double plane[4], const double b[6])
+{
+  return plane[0]*(plane[0] > 0.0 ? b[1] : b[0]) +
+    plane[1]*(plane[1] > 0.0 ? b[3] : b[2]) +
+    plane[2]*(plane[2] > 0.0 ? b[5] : b[4]) + plane[3];
+}
+
+//----------------------------------------------------------------------------
+// Orders the items by the center of their bounds along an axis.
+class CenterLess
+{
+public:
+  CenterLess(const double *bounds, int axis)
+    : Bounds(bounds), Axis(axis) {}
+  bool operator()(vtkIdType a, vtkIdType b) const
+  {
+    const double *ba = this->Bounds + 6*a + 2*this->Axis;
+    const double *bb = this->Bounds + 6*b + 2*this->Axis;
+    return ba[0] + ba[1] < bb[0] + bb[1];
+  }
+  const double *Bounds;
+  int Axis;
+};
+}
+
+//----------------------------------------------------------------------------
+void vtkBoundingVolumeHierarchyInternals::Build(int maxLeafSize)
+{
+  vtkIdType numItems = static_cast<vtkIdType>(this->ItemLeaf.size());
+  this->Order.resize(0);
+  for (vtkIdType id = 0; id < numItems; ++id)
+    {
+    this->ItemLeaf[id] = -1;
+    this->ItemModified[id] = 0;
+    if (this->IsValid(id))
+      {
+      this->Order.push_back(id);
+      }
+    }
+  this->ModifiedItems.resize(0);
+  this->Nodes.resize(0);
+  this->Area = 0.0;
+  if (!this->Order.empty())
+    {
+    this->BuildNode(0, static_cast<vtkIdType>(this->Order.size()), -1,
+                    maxLeafSize);
+    }
+  this->BuiltArea = this->Area;
+  this->NeedBuild = false;
+}
+
+//----------------------------------------------------------------------------
+// Split the items at the median of their centers along the longest axis of
+// the box of the centers.
+int vtkBoundingVolumeHierarchyInternals::BuildNode(vtkIdType start,
+                                                   vtkIdType end, int parent,
+                                                   int maxLeafSize)
+{
+  int node = static_cast<int>(this->Nodes.size());
+  this->Nodes.push_back(Node());
+  this->Nodes[node].Parent = parent;
+  this->Nodes[node].Start = start;
+  this->Nodes[node].Count = end - start;
+  this->Nodes[node].Left = -1;
+  this->Nodes[node].Right = -1;
+
+  if (end - start > maxLeafSize)
+    {
+    double centers[6];
+    vtkMath::UninitializeBounds(centers);
+    for (vtkIdType i = start; i < end; ++i)
+      {
+      const double *b = &this->ItemBounds[6*this->Order[i]];
+      for (int j = 0; j < 3; ++j)
+        {
+        double c = 0.5*(b[2*j] + b[2*j + 1]);
+        centers[2*j] = (i == start || c < centers[2*j] ? c : centers[2*j]);
+        centers[2*j + 1] =
+          (i == start || c > centers[2*j + 1] ? c : centers[2*j + 1]);
+        }
+      }
+    int axis = 0;
+    for (int j = 1; j < 3; ++j)
+      {
+      if (centers[2*j + 1] - centers[2*j] >
+          centers[2*axis + 1] - centers[2*axis])
+        {
+        axis = j;
+        }
+      }
+
+    vtkIdType middle = start + (end - start)/2;
+    std::nth_element(this->Order.begin() + start,
+                     this->Order.begin() + middle,
+                     this->Order.begin() + end,
+                     CenterLess(&this->ItemBounds[0], axis));
+    int left = this->BuildNode(start, middle, node, maxLeafSize);
+    int right = this->BuildNode(middle, end, node, maxLeafSize);
+    this->Nodes[node].Count = 0;
+    this->Nodes[node].Left = left;
+    this->Nodes[node].Right = right;
+    }
+  else
+    {
+    for (vtkIdType i = start; i < end; ++i)
+      {
+      this->ItemLeaf[this->Order[i]] = node;
+      }
+    }
+
+  this->ComputeNodeBounds(node);
+  this->Area += SurfaceArea(this->Nodes[node].Bounds);
+  return node;
+}
+
+//----------------------------------------------------------------------------
+void vtkBoundingVolumeHierarchyInternals::ComputeNodeBounds(int node)
+{
+  Node &n = this->Nodes[node];
+  if (n.Count)
+    {
+    std::copy(&this->ItemBounds[6*this->Order[n.Start]],
+              &this->ItemBounds[6*this->Order[n.Start]] + 6, n.Bounds);
+    for (vtkIdType i = n.Start + 1; i < n.Start + n.Count; ++i)
+      {
+      const double *b = &this->ItemBounds[6*this->Order[i]];
+      for (int j = 0; j < 3; ++j)
+        {
+        n.Bounds[2*j] = std::min(n.Bounds[2*j], b[2*j]);
+        n.Bounds[2*j + 1] = std::max(n.Bounds[2*j + 1], b[2*j + 1]);
+        }
+      }
+    }
+  else
+    {
+    const double *l = this->Nodes[n.Left].Bounds;
+    const double *r = this->Nodes[n.Right].Bounds;
+    for (int j = 0; j < 3; ++j)
+      {
+      n.Bounds[2*j] = std::min(l[2*j], r[2*j]);
+      n.Bounds[2*j + 1] = std::max(l[2*j + 1], r[2*j + 1]);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Refit the leaves of the modified items and their ancestors, stopping at
+// the first node whose box does not change.
+void vtkBoundingVolumeHierarchyInternals::Refit()
+{
+  for (size_t i = 0; i < this->ModifiedItems.size(); ++i)
+    {
+    vtkIdType id = this->ModifiedItems[i];
+    this->ItemModified[id] = 0;
+    if ((this->ItemLeaf[id] >= 0) != this->IsValid(id))
+      {
+      // an item enters or leaves the tree
+      this->NeedBuild = true;
+      }
+    }
+  if (this->NeedBuild)
+    {
+    return;
+    }
+
+  for (size_t i = 0; i < this->ModifiedItems.size(); ++i)
+    {
+    int node = this->ItemLeaf[this->ModifiedItems[i]];
+    while (node >= 0)
+      {
+      double bounds[6];
+      std::copy(this->Nodes[node].Bounds, this->Nodes[node].Bounds + 6,
+                bounds);
+      this->ComputeNodeBounds(node);
+      if (std::equal(bounds, bounds + 6, this->Nodes[node].Bounds))
+        {
+        break;
+        }
+      this->Area += SurfaceArea(this->Nodes[node].Bounds) -
+        SurfaceArea(bounds);
+      node = this->Nodes[node].Parent;
+      }
+    }
+  this->ModifiedItems.resize(0);
+}
+
+//----------------------------------------------------------------------------
+vtkBoundingVolumeHierarchy::vtkBoundingVolumeHierarchy()
+{
+  this->MaximumLeafSize = 4;
+  this->MaximumRefitGrowth = 2.0;
+  this->NumberOfVisitedNodes = 0;
+  this->BuildCount = 0;
+  this->Internals = new vtkBoundingVolumeHierarchyInternals;
+}
+
+//----------------------------------------------------------------------------
+vtkBoundingVolumeHierarchy::~vtkBoundingVolumeHierarchy()
+{
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+void vtkBoundingVolumeHierarchy::SetNumberOfItems(vtkIdType numItems)
+{
+  vtkBoundingVolumeHierarchyInternals *internals = this->Internals;
+  vtkIdType oldNumItems = this->GetNumberOfItems();
+  if (numItems == oldNumItems)
+    {
+    return;
+    }
+  internals->ItemBounds.resize(6*numItems);
+  for (vtkIdType id = oldNumItems; id < numItems; ++id)
+    {
+    vtkMath::UninitializeBounds(&internals->ItemBounds[6*id]);
+    }
+  internals->ItemLeaf.resize(numItems, -1);
+  internals->ItemModified.resize(numItems, 0);
+  internals->NeedBuild = true;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkBoundingVolumeHierarchy::GetNumberOfItems()
+{
+  return static_cast<vtkIdType>(this->Internals->ItemLeaf.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkBoundingVolumeHierarchy::SetItemBounds(vtkIdType id,
+                                               const double bounds[6])
+{
+  vtkBoundingVolumeHierarchyInternals *internals = this->Internals;
+  if (id < 0 || id >= this->GetNumberOfItems())
+    {
+    vtkErrorMacro("No item " << id);
+    return;
+    }
+  double *itemBounds = &internals->ItemBounds[6*id];
+  if (std::equal(bounds, bounds + 6, itemBounds))
+    {
+    return;
+    }
+  std::copy(bounds, bounds + 6, itemBounds);
+  if (!internals->ItemModified[id] && !internals->NeedBuild)
+    {
+    internals->ItemModified[id] = 1;
+    internals->ModifiedItems.push_back(id);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkBoundingVolumeHierarchy::GetItemBounds(vtkIdType id,
+                                               double bounds[6])
+{
+  if (id < 0 || id >= this->GetNumberOfItems())
+    {
+    vtkErrorMacro("No item " << id);
+    return;
+    }
+  const double *itemBounds = &this->Internals->ItemBounds[6*id];
+  std::copy(itemBounds, itemBounds + 6, bounds);
+}
+
+//----------------------------------------------------------------------------
+void vtkBoundingVolumeHierarchy::Update()
+{
+  vtkBoundingVolumeHierarchyInternals *internals = this->Internals;
+  if (!internals->NeedBuild && !internals->ModifiedItems.empty())
+    {
+    internals->Refit();
+    if (internals->Area >
+        internals->BuiltArea*this->MaximumRefitGrowth)
+      {
+      vtkDebugMacro("Refitting made the boxes too loose");
+      internals->NeedBuild = true;
+      }
+    }
+  if (internals->NeedBuild)
+    {
+    internals->Build(this->MaximumLeafSize);
+    this->BuildCount++;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkBoundingVolumeHierarchy::FindItemsInFrustum(const double planes[24],
+                                                    double minimumCoverage,
+                                                    vtkIdList *items)
+{
+  vtkBoundingVolumeHierarchyInternals *internals = this->Internals;
+  this->Update();
+  items->Reset();
+  this->NumberOfVisitedNodes = 0;
+  if (internals->Nodes.empty())
+    {
+    return;
+    }
+
+  // The width and height of the slice through the frustum at a point are
+  // the sums of its distances to the left and right, and to the bottom and
+  // top planes, both linear in the point.  A sphere inside the box of a
+  // node is at most as wide as its diagonal, and the slice at its center
+  // at least as wide as the smallest width over the box.
+  double width[4];
+  double height[4];
+  for (int j = 0; j < 4; ++j)
+    {
+    width[j] = planes[j] + planes[4 + j];
+    height[j] = planes[8 + j] + planes[12 + j];
+    }
+
+  std::vector<int> stack(1, 0);
+  while (!stack.empty())
+    {
+    const vtkBoundingVolumeHierarchyInternals::Node &node =
+      internals->Nodes[stack.back()];
+    stack.pop_back();
+    this->NumberOfVisitedNodes++;
+
+    bool outside = false;
+    for (int i = 0; i < 6 && !outside; ++i)
+      {
+      outside = (MaximumOverBox(planes + 4*i, node.Bounds) < 0.0);
+      }
+    if (outside)
+      {
+      continue;
+      }
+    if (minimumCoverage > 0.0)
+      {
+      const double *b = node.Bounds;
+      double w = MinimumOverBox(width, b);
+      double h = MinimumOverBox(height, b);
+      double diagonal2 = (b[1] - b[0])*(b[1] - b[0]) +
+        (b[3] - b[2])*(b[3] - b[2]) + (b[5] - b[4])*(b[5] - b[4]);
+      if (w > 0.0 && h > 0.0 && diagonal2 < minimumCoverage*w*h)
+        {
+        continue;
+        }
+      }
+
+    if (!node.Count)
+      {
+      stack.push_back(node.Right);
+      stack.push_back(node.Left);
+      continue;
+      }
+    for (vtkIdType i = node.Start; i < node.Start + node.Count; ++i)
+      {
+      vtkIdType id = internals->Order[i];
+      const double *b = &internals->ItemBounds[6*id];
+      bool visible = true;
+      for (int j = 0; j < 6 && visible; ++j)
+        {
+        visible = (MaximumOverBox(planes + 4*j, b) >= 0.0);
+        }
+      if (visible && minimumCoverage > 0.0)
+        {
+        double center[3] = { 0.5*(b[0] + b[1]), 0.5*(b[2] + b[3]),
+                             0.5*(b[4] + b[5]) };
+        double w = vtkMath::Dot(width, center) + width[3];
+        double h = vtkMath::Dot(height, center) + height[3];
+        double diagonal2 = (b[1] - b[0])*(b[1] - b[0]) +
+          (b[3] - b[2])*(b[3] - b[2]) + (b[5] - b[4])*(b[5] - b[4]);
+        visible = !(w > 0.0 && h > 0.0 && diagonal2 < minimumCoverage*w*h);
+        }
+      if (visible)
+        {
+        items->InsertNextId(id);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkBoundingVolumeHierarchy::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Number Of Items: " << this->GetNumberOfItems() << "\n";
+  os << indent << "Maximum Leaf Size: " << this->MaximumLeafSize << "\n";
+  os << indent << "Maximum Refit Growth: " << this->MaximumRefitGrowth
+     << "\n";
+  os << indent << "Number Of Visited Nodes: " << this->NumberOfVisitedNodes
+     << "\n";
+  os << indent << "Build Count: " << this->BuildCount << "\n";
+}
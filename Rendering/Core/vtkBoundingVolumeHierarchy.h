@@ -0,0 +1,114 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkBoundingVolumeHierarchy.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkBoundingVolumeHierarchy - a hierarchy of bounding boxes for
+// culling
+//
+// .SECTION Description
+// vtkBoundingVolumeHierarchy is a binary tree of axis aligned boxes over a
+// set of items, such as the props of a renderer or the blocks of a
+// composite dataset, that finds the items in a view frustum by visiting
+// the nodes that intersect it only.  Items are identified by their index,
+// from 0 to NumberOfItems - 1, and items whose bounds are not initialized
+// are left out of the tree.
+//
+// The tree is built when first queried.  When only the bounds of some items
+// change, the boxes of their leaves and of the ancestors of these leaves
+// are refit, so that moving a few items costs little.  The tree is built
+// again when the items are added or removed, and when refitting has made
+// its boxes grow too loose, as measured by the sum of their surface areas.
+//
+// .SECTION See Also
+// vtkFrustumCoverageCuller vtkCamera
+
+#ifndef vtkBoundingVolumeHierarchy_h
+#define vtkBoundingVolumeHierarchy_h
+
+#include "vtkRenderingCoreModule.h" // For export macro
+#include "vtkObject.h"
+
+class vtkBoundingVolumeHierarchyInternals;
+class vtkIdList;
+
+class VTKRENDERINGCORE_EXPORT vtkBoundingVolumeHierarchy : public vtkObject
+{
+public:
+  static vtkBoundingVolumeHierarchy *New();
+  vtkTypeMacro(vtkBoundingVolumeHierarchy, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Set/Get the number of items.  New items have uninitialized bounds, and
+  // changing the number of items builds the tree again at the next query.
+  void SetNumberOfItems(vtkIdType numItems);
+  vtkIdType GetNumberOfItems();
+
+  // Description:
+  // Set/Get the bounds of an item.  Setting the bounds it already has does
+  // nothing, so they can be set at each render.  For speed, this does not
+  // modify the hierarchy.
+  void SetItemBounds(vtkIdType id, const double bounds[6]);
+  void GetItemBounds(vtkIdType id, double bounds[6]);
+
+  // Description:
+  // Set/Get the largest number of items in a leaf.  The default is 4.
+  vtkSetClampMacro(MaximumLeafSize, int, 1, 256);
+  vtkGetMacro(MaximumLeafSize, int);
+
+  // Description:
+  // Set/Get how much the sum of the surface areas of the boxes may grow by
+  // refitting, relative to that of the last built tree, before the tree is
+  // built again.  The default is 2.
+  vtkSetClampMacro(MaximumRefitGrowth, double, 1.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(MaximumRefitGrowth, double);
+
+  // Description:
+  // Find the items whose boxes intersect the frustum, given by its six
+  // planes as returned by vtkCamera::GetFrustumPlanes, with their normals
+  // pointing inside.  If minimumCoverage is positive, the items whose
+  // bounding spheres cover less than this fraction of the slice through the
+  // frustum at their center, as computed by vtkFrustumCoverageCuller, are
+  // left out too.  The coverage is overestimated, so that no item covering
+  // more is left out, and whole subtrees of tiny items are skipped at once.
+  void FindItemsInFrustum(const double planes[24], double minimumCoverage,
+                          vtkIdList *items);
+
+  // Description:
+  // Build or refit the tree now rather than at the next query.
+  void Update();
+
+  // Description:
+  // The number of nodes visited by the last query, and the number of times
+  // the tree has been built.
+  vtkGetMacro(NumberOfVisitedNodes, vtkIdType);
+  vtkGetMacro(BuildCount, int);
+
+protected:
+  vtkBoundingVolumeHierarchy();
+  ~vtkBoundingVolumeHierarchy();
+
+  int MaximumLeafSize;
+  double MaximumRefitGrowth;
+  vtkIdType NumberOfVisitedNodes;
+  int BuildCount;
+
+  vtkBoundingVolumeHierarchyInternals *Internals;
+
+private:
+  vtkBoundingVolumeHierarchy(
+    const vtkBoundingVolumeHierarchy&);  // Not implemented.
+  void operator=(const vtkBoundingVolumeHierarchy&);  // Not implemented.
+};
+
+#endif
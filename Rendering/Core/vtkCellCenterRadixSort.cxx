@@ -0,0 +1,455 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkCellCenterRadixSort.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkCellCenterRadixSort.h"
+
+#include "vtkDataSet.h"
+#include "vtkFloatArray.h"
+#include "vtkGenericCell.h"
+#include "vtkIdTypeArray.h"
+#include "vtkObjectFactory.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+vtkStandardNewMacro(vtkCellCenterRadixSort);
+
+//-----------------------------------------------------------------------------
+namespace
+{
+
+// The ids are split into pieces of this size, each piece has its own
+// histograms and is scattered by one thread.
+const vtkIdType RadixChunkSize = 16384;
+
+// Each pass sorts 8 bits of the keys.
+const int RadixDigitBits = 8;
+const int RadixDigits = 1 << RadixDigitBits;
+
+// Compute the range of the depths of each piece.
+class DepthRangeFunctor
+{
+public:
+  const float *Depths;
+  const vtkIdType *Ids;
+  vtkIdType NumberOfIds;
+  float *Ranges;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for (vtkIdType chunk = begin; chunk < end; chunk++)
+      {
+      vtkIdType first = chunk*RadixChunkSize;
+      vtkIdType last = std::min(first + RadixChunkSize, this->NumberOfIds);
+      float low = VTK_FLOAT_MAX;
+      float high = -VTK_FLOAT_MAX;
+      for (vtkIdType i = first; i < last; i++)
+        {
+        float depth = this->Depths[this->Ids[i]];
+        low = (depth < low ? depth : low);
+        high = (depth > high ? depth : high);
+        }
+      this->Ranges[2*chunk] = low;
+      this->Ranges[2*chunk + 1] = high;
+      }
+  }
+};
+
+// Quantize the depths, in the current order of the ids, and check whether
+// each piece is still sorted, including its first id with respect to the
+// last id of the previous piece.
+class QuantizeFunctor
+{
+public:
+  const float *Depths;
+  const vtkIdType *Ids;
+  vtkIdType NumberOfIds;
+  double Low;
+  double Scale;
+  double MaxKey;
+  unsigned int *Keys;
+  unsigned char *Sorted;
+
+  unsigned int Quantize(float depth) const
+  {
+    double key = (depth - this->Low)*this->Scale;
+    if (!(key > 0.0))
+      {
+      return 0;
+      }
+    return static_cast<unsigned int>(key < this->MaxKey ? key : this->MaxKey);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for (vtkIdType chunk = begin; chunk < end; chunk++)
+      {
+      vtkIdType first = chunk*RadixChunkSize;
+      vtkIdType last = std::min(first + RadixChunkSize, this->NumberOfIds);
+      unsigned int previous =
+        (first > 0 ? this->Quantize(this->Depths[this->Ids[first - 1]]) : 0);
+      unsigned char sorted = 1;
+      for (vtkIdType i = first; i < last; i++)
+        {
+        unsigned int key = this->Quantize(this->Depths[this->Ids[i]]);
+        sorted &= (key >= previous);
+        this->Keys[i] = key;
+        previous = key;
+        }
+      this->Sorted[chunk] = sorted;
+      }
+  }
+};
+
+// Count the digits of the keys of each piece.
+class HistogramFunctor
+{
+public:
+  const unsigned int *Keys;
+  vtkIdType NumberOfIds;
+  int Shift;
+  vtkIdType *Counts;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for (vtkIdType chunk = begin; chunk < end; chunk++)
+      {
+      vtkIdType *counts = this->Counts + chunk*RadixDigits;
+      std::fill(counts, counts + RadixDigits, 0);
+      vtkIdType first = chunk*RadixChunkSize;
+      vtkIdType last = std::min(first + RadixChunkSize, this->NumberOfIds);
+      for (vtkIdType i = first; i < last; i++)
+        {
+        counts[(this->Keys[i] >> this->Shift) & (RadixDigits - 1)]++;
+        }
+      }
+  }
+};
+
+// Move the keys and ids of each piece to their place for this digit, the
+// offsets of each piece having been computed from the histograms.
+class ScatterFunctor
+{
+public:
+  const unsigned int *Keys;
+  const vtkIdType *Ids;
+  vtkIdType NumberOfIds;
+  int Shift;
+  const vtkIdType *Offsets;
+  unsigned int *OutKeys;
+  vtkIdType *OutIds;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    vtkIdType offsets[RadixDigits];
+    for (vtkIdType chunk = begin; chunk < end; chunk++)
+      {
+      std::copy(this->Offsets + chunk*RadixDigits,
+                this->Offsets + (chunk + 1)*RadixDigits, offsets);
+      vtkIdType first = chunk*RadixChunkSize;
+      vtkIdType last = std::min(first + RadixChunkSize, this->NumberOfIds);
+      for (vtkIdType i = first; i < last; i++)
+        {
+        unsigned int key = this->Keys[i];
+        vtkIdType j = offsets[(key >> this->Shift) & (RadixDigits - 1)]++;
+        this->OutKeys[j] = key;
+        this->OutIds[j] = this->Ids[i];
+        }
+      }
+  }
+};
+
+// Compute the centers of the cells.  Each thread computes those of the
+// ranges of cells that vtkSMPTools::For gives it, with its own cell and
+// weights.
+class CellCentersFunctor
+{
+public:
+  vtkDataSet *Input;
+  float *Centers;
+  vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+  vtkSMPThreadLocal<std::vector<double> > Weights;
+
+  void Initialize()
+  {
+    this->Weights.Local().resize(
+      std::max(this->Input->GetMaxCellSize(), 1));
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkGenericCell *cell = this->Cell.Local();
+    double *weights = &this->Weights.Local()[0];
+    for (vtkIdType i = begin; i < end; i++)
+      {
+      this->Input->GetCell(i, cell);
+      double pcenter[3];
+      double center[3];
+      int subId = cell->GetParametricCenter(pcenter);
+      cell->EvaluateLocation(subId, pcenter, center, weights);
+      this->Centers[3*i] = static_cast<float>(center[0]);
+      this->Centers[3*i + 1] = static_cast<float>(center[1]);
+      this->Centers[3*i + 2] = static_cast<float>(center[2]);
+      }
+  }
+
+  void Reduce()
+  {
+  }
+};
+
+// Project the centers of the cells on the sort vector.
+class CellDepthsFunctor
+{
+public:
+  const float *Centers;
+  const float *Vector;
+  float *Depths;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for (vtkIdType i = begin; i < end; i++)
+      {
+      const float *center = this->Centers + 3*i;
+      this->Depths[i] = center[0]*this->Vector[0] +
+        center[1]*this->Vector[1] + center[2]*this->Vector[2];
+      }
+  }
+};
+
+}
+
+//-----------------------------------------------------------------------------
+vtkCellCenterRadixSort::vtkCellCenterRadixSort()
+{
+  this->KeyBits = 24;
+  this->NumberOfPasses = 0;
+  this->NextCell = 0;
+}
+
+//-----------------------------------------------------------------------------
+vtkCellCenterRadixSort::~vtkCellCenterRadixSort()
+{
+}
+
+//-----------------------------------------------------------------------------
+void vtkCellCenterRadixSort::PrintSelf(ostream &os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "KeyBits: " << this->KeyBits << endl;
+  os << indent << "NumberOfPasses: " << this->NumberOfPasses << endl;
+}
+
+//-----------------------------------------------------------------------------
+int vtkCellCenterRadixSort::Sort(vtkIdType numIds, const float *depths,
+                                 vtkIdType *ids, int keyBits)
+{
+  if (numIds < 2)
+    {
+    return 0;
+    }
+  keyBits = std::max(std::min(keyBits, 32), 1);
+  vtkIdType numChunks = (numIds + RadixChunkSize - 1)/RadixChunkSize;
+
+  // the range of the depths
+  std::vector<float> ranges(2*numChunks);
+  DepthRangeFunctor rangeFunctor;
+  rangeFunctor.Depths = depths;
+  rangeFunctor.Ids = ids;
+  rangeFunctor.NumberOfIds = numIds;
+  rangeFunctor.Ranges = &ranges[0];
+  vtkSMPTools::For(0, numChunks, 1, rangeFunctor);
+  float low = VTK_FLOAT_MAX;
+  float high = -VTK_FLOAT_MAX;
+  for (vtkIdType chunk = 0; chunk < numChunks; chunk++)
+    {
+    low = std::min(low, ranges[2*chunk]);
+    high = std::max(high, ranges[2*chunk + 1]);
+    }
+  if (!(high > low))
+    {
+    // all the depths are equal
+    return 0;
+    }
+
+  // quantize the depths, and keep the previous order if it is sorted
+  std::vector<unsigned int> keys(numIds);
+  std::vector<unsigned char> sorted(numChunks);
+  QuantizeFunctor quantizeFunctor;
+  quantizeFunctor.Depths = depths;
+  quantizeFunctor.Ids = ids;
+  quantizeFunctor.NumberOfIds = numIds;
+  quantizeFunctor.Low = low;
+  quantizeFunctor.MaxKey = ldexp(1.0, keyBits) - 1.0;
+  quantizeFunctor.Scale =
+    quantizeFunctor.MaxKey/(static_cast<double>(high) - low);
+  quantizeFunctor.Keys = &keys[0];
+  quantizeFunctor.Sorted = &sorted[0];
+  vtkSMPTools::For(0, numChunks, 1, quantizeFunctor);
+  if (std::find(sorted.begin(), sorted.end(), 0) == sorted.end())
+    {
+    return 0;
+    }
+
+  // one pass per digit, skipping the digits that are the same for all keys
+  std::vector<unsigned int> outKeys(numIds);
+  std::vector<vtkIdType> outIds(numIds);
+  std::vector<vtkIdType> counts(numChunks*RadixDigits);
+  unsigned int *keysIn = &keys[0];
+  unsigned int *keysOut = &outKeys[0];
+  vtkIdType *idsIn = ids;
+  vtkIdType *idsOut = &outIds[0];
+  int numPasses = 0;
+  for (int shift = 0; shift < keyBits; shift += RadixDigitBits)
+    {
+    HistogramFunctor histogramFunctor;
+    histogramFunctor.Keys = keysIn;
+    histogramFunctor.NumberOfIds = numIds;
+    histogramFunctor.Shift = shift;
+    histogramFunctor.Counts = &counts[0];
+    vtkSMPTools::For(0, numChunks, 1, histogramFunctor);
+
+    // the offsets of each digit of each piece, in place of the counts
+    vtkIdType offset = 0;
+    bool singleDigit = false;
+    for (int digit = 0; digit < RadixDigits && !singleDigit; digit++)
+      {
+      vtkIdType start = offset;
+      for (vtkIdType chunk = 0; chunk < numChunks; chunk++)
+        {
+        vtkIdType count = counts[chunk*RadixDigits + digit];
+        counts[chunk*RadixDigits + digit] = offset;
+        offset += count;
+        }
+      singleDigit = (offset - start == numIds);
+      }
+    if (singleDigit)
+      {
+      continue;
+      }
+
+    ScatterFunctor scatterFunctor;
+    scatterFunctor.Keys = keysIn;
+    scatterFunctor.Ids = idsIn;
+    scatterFunctor.NumberOfIds = numIds;
+    scatterFunctor.Shift = shift;
+    scatterFunctor.Offsets = &counts[0];
+    scatterFunctor.OutKeys = keysOut;
+    scatterFunctor.OutIds = idsOut;
+    vtkSMPTools::For(0, numChunks, 1, scatterFunctor);
+    std::swap(keysIn, keysOut);
+    std::swap(idsIn, idsOut);
+    numPasses++;
+    }
+
+  if (idsIn != ids)
+    {
+    std::copy(idsIn, idsIn + numIds, ids);
+    }
+
+  return numPasses;
+}
+
+//-----------------------------------------------------------------------------
+void vtkCellCenterRadixSort::ComputeCellCenters()
+{
+  vtkIdType numcells = this->Input->GetNumberOfCells();
+  this->CellCenters->SetNumberOfTuples(numcells);
+  if (numcells == 0)
+    {
+    return;
+    }
+
+  // build the cell structures of the input before using it from threads
+  vtkGenericCell *cell = vtkGenericCell::New();
+  this->Input->GetCell(0, cell);
+  cell->Delete();
+
+  CellCentersFunctor functor;
+  functor.Input = this->Input;
+  functor.Centers = this->CellCenters->GetPointer(0);
+  vtkSMPTools::For(0, numcells, functor);
+}
+
+//-----------------------------------------------------------------------------
+void vtkCellCenterRadixSort::ComputeDepths()
+{
+  CellDepthsFunctor functor;
+  functor.Centers = this->CellCenters->GetPointer(0);
+  functor.Vector = this->ComputeProjectionVector();
+  functor.Depths = this->CellDepths->GetPointer(0);
+  vtkSMPTools::For(0, this->Input->GetNumberOfCells(), functor);
+}
+
+//-----------------------------------------------------------------------------
+void vtkCellCenterRadixSort::InitTraversal()
+{
+  vtkDebugMacro("InitTraversal");
+
+  vtkIdType numcells = this->Input->GetNumberOfCells();
+
+  if (   (this->LastSortTime < this->Input->GetMTime())
+      || (this->LastSortTime < this->MTime)
+      || (this->SortedCells->GetNumberOfTuples() != numcells) )
+    {
+    vtkDebugMacro("Building cell centers array.");
+
+    // Data may have changed.  Recompute cell centers, and start again
+    // from the order of the cells.
+    this->ComputeCellCenters();
+    this->CellDepths->SetNumberOfTuples(numcells);
+    this->SortedCells->SetNumberOfTuples(numcells);
+    vtkIdType *id = this->SortedCells->GetPointer(0);
+    for (vtkIdType i = 0; i < numcells; i++)
+      {
+      id[i] = i;
+      }
+    }
+
+  vtkDebugMacro("Calculating depths.");
+  this->ComputeDepths();
+
+  // the cells are sorted by increasing depth, in the previous order
+  this->NumberOfPasses = vtkCellCenterRadixSort::Sort(
+    numcells, this->CellDepths->GetPointer(0),
+    this->SortedCells->GetPointer(0), this->KeyBits);
+  this->NextCell = 0;
+
+  this->LastSortTime.Modified();
+}
+
+//-----------------------------------------------------------------------------
+vtkIdTypeArray *vtkCellCenterRadixSort::GetNextCells()
+{
+  vtkIdType numcells = this->SortedCells->GetNumberOfTuples();
+  if (this->NextCell >= numcells)
+    {
+    // Already returned everything.
+    return NULL;
+    }
+
+  vtkIdType count = std::min(numcells - this->NextCell,
+                             static_cast<vtkIdType>(this->MaxCellsReturned));
+  this->SortedCellPartition->SetArray(
+    this->SortedCells->GetPointer(this->NextCell), count, 1);
+  this->SortedCellPartition->SetNumberOfTuples(count);
+  this->NextCell += count;
+
+  return this->SortedCellPartition;
+}
@@ -0,0 +1,87 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkCellCenterRadixSort.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkCellCenterRadixSort - A parallel radix sort of the cell centers.
+//
+// .SECTION Description
+// vtkCellCenterRadixSort sorts the cells by the depth of their centers,
+// like vtkCellCenterDepthSort, but it quantizes the depths to integer keys
+// of KeyBits bits and sorts them with a least significant digit radix sort
+// whose passes are done in parallel with vtkSMPTools.  The cell centers
+// and depths are also computed in parallel.
+//
+// The order of the last sort is the starting point of the next one, as
+// long as the input and the sort have not been modified.  Since the radix
+// sort is stable, the cells whose keys are equal keep their previous
+// order, which avoids flickering, and when the camera has moved little
+// enough for the previous order to still be sorted, no pass is done at
+// all.
+//
+// .SECTION See Also
+// vtkCellCenterDepthSort vtkDepthSortPolyData
+
+#ifndef vtkCellCenterRadixSort_h
+#define vtkCellCenterRadixSort_h
+
+#include "vtkRenderingCoreModule.h" // For export macro
+#include "vtkCellCenterDepthSort.h"
+
+class VTKRENDERINGCORE_EXPORT vtkCellCenterRadixSort :
+  public vtkCellCenterDepthSort
+{
+public:
+  vtkTypeMacro(vtkCellCenterRadixSort, vtkCellCenterDepthSort);
+  virtual void PrintSelf(ostream &os, vtkIndent indent);
+  static vtkCellCenterRadixSort *New();
+
+  virtual void InitTraversal();
+  virtual vtkIdTypeArray *GetNextCells();
+
+  // Description:
+  // Set/Get the number of bits the depths are quantized to, between 8 and
+  // 32.  Each group of 8 bits is one pass of the sort.  The default is 24.
+  vtkSetClampMacro(KeyBits, int, 8, 32);
+  vtkGetMacro(KeyBits, int);
+
+  // Description:
+  // The number of radix passes done by the last sort, which is 0 when the
+  // previous order was still sorted.
+  vtkGetMacro(NumberOfPasses, int);
+
+  // Description:
+  // Sort the numIds ids in order of increasing depth, where depths is
+  // indexed by id, with a parallel radix sort of the depths quantized to
+  // keyBits bits.  The order of the ids on input is the starting point:
+  // the ids with equal keys keep their order, and nothing is done if they
+  // are already sorted.  Returns the number of radix passes done.
+  static int Sort(vtkIdType numIds, const float *depths, vtkIdType *ids,
+                  int keyBits);
+
+protected:
+  vtkCellCenterRadixSort();
+  ~vtkCellCenterRadixSort();
+
+  virtual void ComputeCellCenters();
+  virtual void ComputeDepths();
+
+  int KeyBits;
+  int NumberOfPasses;
+  vtkIdType NextCell;
+
+private:
+  vtkCellCenterRadixSort(const vtkCellCenterRadixSort &);  // Not implemented.
+  void operator=(const vtkCellCenterRadixSort &);  // Not implemented.
+};
+
+#endif
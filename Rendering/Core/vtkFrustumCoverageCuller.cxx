@@ -14,7 +14,9 @@
 =========================================================================*/
 #include "vtkFrustumCoverageCuller.h"
 
+#include "vtkBoundingVolumeHierarchy.h"
 #include "vtkCamera.h"
+#include "vtkIdList.h"
 #include "vtkMath.h"
 #include "vtkObjectFactory.h"
 #include "vtkProp.h"
@@ -28,6 +30,13 @@ vtkFrustumCoverageCuller::vtkFrustumCoverageCuller()
   this->MinimumCoverage = 0.0;
   this->MaximumCoverage = 1.0;
   this->SortingStyle    = VTK_CULLER_SORT_NONE;
+  this->UseHierarchy    = 1;
+  this->Hierarchy       = vtkBoundingVolumeHierarchy::New();
+}
+
+vtkFrustumCoverageCuller::~vtkFrustumCoverageCuller()
+{
+  this->Hierarchy->Delete();
 }
 
 // The coverage is computed for each prop, and a resulting allocated
@@ -53,6 +62,7 @@ double vtkFrustumCoverageCuller::Cull( vtkRenderer *ren,
   double               *distanceList;
   int                 index1, index2;
   double               tmp;
+  unsigned char       *candidateList = NULL;
 
   // We will create a center distance entry for each prop in the list
   // If SortingStyle is set to BackToFront or FrontToBack we will then
@@ -72,6 +82,48 @@ double vtkFrustumCoverageCuller::Cull( vtkRenderer *ren,
   // props later
   allocatedTimeList = new double[listLength];
 
+  // Look up the props that may be in view in the hierarchy of the boxes
+  // around their bounding spheres. The others would be culled by the plane
+  // or coverage tests below, and are not tested.
+  if ( this->UseHierarchy )
+    {
+    candidateList = new unsigned char[listLength];
+    this->Hierarchy->SetNumberOfItems( listLength );
+    for ( propLoop = 0; propLoop < listLength; propLoop++ )
+      {
+      bounds = propList[propLoop]->GetBounds();
+      double sphereBounds[6];
+      vtkMath::UninitializeBounds( sphereBounds );
+      if ( bounds && vtkMath::AreBoundsInitialized(bounds) )
+        {
+        radius = 0.5 * sqrt( ( bounds[1] - bounds[0] ) *
+                             ( bounds[1] - bounds[0] ) +
+                             ( bounds[3] - bounds[2] ) *
+                             ( bounds[3] - bounds[2] ) +
+                             ( bounds[5] - bounds[4] ) *
+                             ( bounds[5] - bounds[4] ) );
+        for ( i = 0; i < 3; i++ )
+          {
+          center[i] = (bounds[2*i] + bounds[2*i + 1]) / 2.0;
+          sphereBounds[2*i] = center[i] - radius;
+          sphereBounds[2*i + 1] = center[i] + radius;
+          }
+        }
+      this->Hierarchy->SetItemBounds( propLoop, sphereBounds );
+      // 2D props are never culled
+      candidateList[propLoop] = ( bounds ? 0 : 1 );
+      }
+
+    vtkIdList *candidates = vtkIdList::New();
+    this->Hierarchy->FindItemsInFrustum( planes, this->MinimumCoverage,
+                                         candidates );
+    for ( i = 0; i < candidates->GetNumberOfIds(); i++ )
+      {
+      candidateList[candidates->GetId(i)] = 1;
+      }
+    candidates->Delete();
+    }
+
   // For each prop, compute coverage
   for ( propLoop = 0; propLoop < listLength; propLoop++ )
     {
@@ -106,6 +158,10 @@ double vtkFrustumCoverageCuller::Cull( vtkRenderer *ren,
         {
         coverage = 0.0;
         }
+      else if ( candidateList && !candidateList[propLoop] )
+        {
+        coverage = 0.0;
+        }
       else
         {
         center[0] = (bounds[0] + bounds[1]) / 2.0;
@@ -322,6 +378,7 @@ double vtkFrustumCoverageCuller::Cull( vtkRenderer *ren,
   initialized = 1;
   delete [] allocatedTimeList;
   delete [] distanceList;
+  delete [] candidateList;
   return total_time;
 }
 
@@ -360,4 +417,7 @@ void vtkFrustumCoverageCuller::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Sorting Style: "
      << this->GetSortingStyleAsString() << endl;
 
+  os << indent << "Use Hierarchy: "
+     << (this->UseHierarchy ? "On" : "Off") << endl;
+
 }
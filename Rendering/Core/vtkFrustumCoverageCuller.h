@@ -25,10 +25,16 @@
 // for that prop is set to zero. If it is greater than the MaximumCoverage,
 // the allocated render time is set to 1.0. In between, a linear ramp is used
 // to convert coverage into allocated render time.
-
+//
+// When UseHierarchy is on, the props are first looked up in a
+// vtkBoundingVolumeHierarchy of their bounding spheres, which is refit as
+// their bounds change, and only the props it finds in the frustum, with
+// enough coverage, are tested one by one.  The result is the same as
+// testing all the props, at a cost that follows the number of props in
+// view.
 
 // .SECTION see also
-// vtkCuller
+// vtkCuller vtkBoundingVolumeHierarchy
 
 #ifndef vtkFrustumCoverageCuller_h
 #define vtkFrustumCoverageCuller_h
@@ -40,6 +46,7 @@
 #define VTK_CULLER_SORT_FRONT_TO_BACK 1
 #define VTK_CULLER_SORT_BACK_TO_FRONT 2
 
+class vtkBoundingVolumeHierarchy;
 class vtkProp;
 class vtkRenderer;
 
@@ -76,6 +83,13 @@ public:
     {this->SetSortingStyle(VTK_CULLER_SORT_FRONT_TO_BACK);};
   const char *GetSortingStyleAsString(void);
 
+  // Description:
+  // Turn on/off looking up the props in a hierarchy of their bounds before
+  // testing them one by one.  On by default.
+  vtkSetMacro(UseHierarchy, int);
+  vtkGetMacro(UseHierarchy, int);
+  vtkBooleanMacro(UseHierarchy, int);
+
 //BTX
   // Description:
   // WARNING: INTERNAL METHOD - NOT INTENDED FOR GENERAL USE
@@ -89,11 +103,14 @@ public:
 
 protected:
   vtkFrustumCoverageCuller();
-  ~vtkFrustumCoverageCuller() {}
+  ~vtkFrustumCoverageCuller();
 
   double       MinimumCoverage;
   double       MaximumCoverage;
   int          SortingStyle;
+  int          UseHierarchy;
+
+  vtkBoundingVolumeHierarchy *Hierarchy;
 private:
   vtkFrustumCoverageCuller(const vtkFrustumCoverageCuller&);  // Not implemented.
   void operator=(const vtkFrustumCoverageCuller&);  // Not implemented.
@@ -0,0 +1,140 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestProgressiveLODActor.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkProgressiveLODActor renders at full resolution while its
+// levels are built, then uses the coarsest level when the sphere is far
+// away, and refines one level per render when it comes back near.
+
+#include "vtkCamera.h"
+#include "vtkNew.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataMapper.h"
+#include "vtkProgressiveLODActor.h"
+#include "vtkRenderWindow.h"
+#include "vtkRenderer.h"
+#include "vtkSphereSource.h"
+
+static int CheckLevel(vtkRenderWindow *renWin, vtkProgressiveLODActor *actor,
+                      int expected, const char *what)
+{
+  renWin->Render();
+  if (actor->GetCurrentLevel() != expected)
+    {
+    cerr << what << ": level " << actor->GetCurrentLevel()
+         << " was rendered instead of " << expected << endl;
+    return 1;
+    }
+  return 0;
+}
+
+int TestProgressiveLODActor(int, char *[])
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(200);
+  sphere->SetPhiResolution(200);
+  vtkNew<vtkPolyDataMapper> mapper;
+  mapper->SetInputConnection(sphere->GetOutputPort());
+  vtkNew<vtkProgressiveLODActor> actor;
+  actor->SetMapper(mapper.GetPointer());
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddActor(actor.GetPointer());
+  vtkNew<vtkRenderWindow> renWin;
+  renWin->SetSize(300, 300);
+  renWin->AddRenderer(renderer.GetPointer());
+  renderer->ResetCamera();
+
+  vtkRenderWindow *win = renWin.GetPointer();
+  vtkProgressiveLODActor *lod = actor.GetPointer();
+  int rval = CheckLevel(win, lod, 0, "First render");
+
+  actor->WaitForLevels();
+  if (actor->GetNumberOfBuiltLevels() != actor->GetNumberOfLevels())
+    {
+    cerr << "Only " << actor->GetNumberOfBuiltLevels() << " levels built"
+         << endl;
+    return 1;
+    }
+  for (int level = 1; level < actor->GetNumberOfLevels(); ++level)
+    {
+    cout << "Level " << level << ": "
+         << actor->GetLevelNumberOfCells(level) << " cells" << endl;
+    if (actor->GetLevelNumberOfCells(level) <= 0 ||
+        actor->GetLevelNumberOfCells(level) >=
+        actor->GetLevelNumberOfCells(level - 1))
+      {
+      cerr << "Level " << level << " is not coarser than the previous one"
+           << endl;
+      return 1;
+      }
+    }
+  int coarsest = actor->GetNumberOfLevels() - 1;
+
+  // A few pixels on the screen need the coarsest level only.
+  vtkCamera *camera = renderer->GetActiveCamera();
+  camera->Dolly(0.01);
+  renderer->ResetCameraClippingRange();
+  rval |= CheckLevel(win, lod, coarsest, "Far away");
+
+  // Back near, the levels are refined one per render.
+  camera->Dolly(100.0);
+  renderer->ResetCameraClippingRange();
+  for (int level = coarsest - 1; level >= 0; --level)
+    {
+    rval |= CheckLevel(win, lod, level, "Refining");
+    }
+
+  // Without progressive refinement the full resolution comes at once.
+  camera->Dolly(0.01);
+  renderer->ResetCameraClippingRange();
+  rval |= CheckLevel(win, lod, coarsest, "Far away again");
+  actor->ProgressiveRefinementOff();
+  camera->Dolly(100.0);
+  renderer->ResetCameraClippingRange();
+  rval |= CheckLevel(win, lod, 0, "Near without refinement");
+
+  // New data has its levels built again.
+  sphere->SetThetaResolution(100);
+  camera->Dolly(0.01);
+  renderer->ResetCameraClippingRange();
+  renWin->Render();
+  actor->WaitForLevels();
+  if (actor->GetLevelNumberOfCells(0) !=
+      sphere->GetOutput()->GetNumberOfCells())
+    {
+    cerr << "The levels were not rebuilt for the new data" << endl;
+    rval = 1;
+    }
+  rval |= CheckLevel(win, lod, coarsest, "New data far away");
+
+  // Data changed while its levels are built drops the build, and the
+  // levels of the latest data are built after it.
+  sphere->SetThetaResolution(400);
+  sphere->SetPhiResolution(400);
+  renWin->Render();
+  sphere->SetThetaResolution(50);
+  sphere->SetPhiResolution(50);
+  renWin->Render();
+  actor->WaitForLevels();
+  if (actor->GetNumberOfBuiltLevels() != actor->GetNumberOfLevels() ||
+      actor->GetLevelNumberOfCells(0) !=
+      sphere->GetOutput()->GetNumberOfCells() ||
+      actor->GetLevelNumberOfCells(1) >= actor->GetLevelNumberOfCells(0))
+    {
+    cerr << "The levels were not built for the latest data" << endl;
+    rval = 1;
+    }
+
+  return rval;
+}
@@ -0,0 +1,696 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkProgressiveLODActor.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkProgressiveLODActor.h"
+
+#include "vtkAtomicInt.h"
+#include "vtkCallbackCommand.h"
+#include "vtkCamera.h"
+#include "vtkMath.h"
+#include "vtkMatrix4x4.h"
+#include "vtkMultiThreader.h"
+#include "vtkMutexLock.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataMapper.h"
+#include "vtkProperty.h"
+#include "vtkQuadricClustering.h"
+#include "vtkRenderWindow.h"
+#include "vtkRenderWindowInteractor.h"
+#include "vtkRenderer.h"
+#include "vtkSmartPointer.h"
+#include "vtkTexture.h"
+#include "vtkWeakPointer.h"
+
+#include <cmath>
+#include <vector>
+
+vtkStandardNewMacro(vtkProgressiveLODActor);
+
+//----------------------------------------------------------------------------
+// The levels built from one version of the data, by one worker thread.
+class vtkProgressiveLODActorBuild
+{
+public:
+  vtkProgressiveLODActorBuild()
+    : Abort(0), Done(0)
+  {
+    this->ThreadId = -1;
+    this->Lock = vtkSmartPointer<vtkMutexLock>::New();
+    this->Divisions = 0;
+  }
+
+  // Run on the worker thread: decimate Input into Levels, coarsest first.
+  void BuildLevels();
+
+  // Abort is set by the render thread to drop the build, Done by the
+  // worker thread when it returns. Input and Divisions are only written
+  // before the thread starts, Levels and BinSizes are guarded by Lock.
+  vtkAtomicInt<vtkTypeInt32> Abort;
+  vtkAtomicInt<vtkTypeInt32> Done;
+  int ThreadId;
+  vtkSmartPointer<vtkMutexLock> Lock;
+  vtkSmartPointer<vtkPolyData> Input;
+  int Divisions;
+  std::vector<vtkSmartPointer<vtkPolyData> > Levels;
+  std::vector<double> BinSizes;
+};
+
+//----------------------------------------------------------------------------
+class vtkProgressiveLODActorInternals
+{
+public:
+  vtkProgressiveLODActorInternals()
+  {
+    this->Threader = vtkSmartPointer<vtkMultiThreader>::New();
+    this->Current = NULL;
+    this->Source = NULL;
+    this->SourceMTime = 0;
+    this->SourceNumberOfCells = 0;
+    this->BuiltNumberOfLevels = 0;
+    this->BuiltFinestDivisions = 0;
+    this->DataLength = 0.0;
+    this->SecondsPerCell = 0.0;
+    this->ObserverTag = 0;
+    this->TimerId = 0;
+    this->TimerCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+  }
+
+  // Start the thread of the current build, unless it has nothing to
+  // build, has already run or an aborted build still runs.
+  void Start();
+
+  // Abort the current build and drop it without waiting for its thread.
+  void Abandon();
+
+  // Delete the aborted builds whose threads are done, waiting for them
+  // if wait is set.
+  void Reap(bool wait);
+
+  // Wait for the current build to be done.
+  void Join();
+
+  // The build of the current data, and the aborted builds whose threads
+  // have not been joined yet.
+  vtkSmartPointer<vtkMultiThreader> Threader;
+  vtkProgressiveLODActorBuild *Current;
+  std::vector<vtkProgressiveLODActorBuild*> Abandoned;
+
+  // The data the levels are built from, and the levels handed to the
+  // mappers, with their number of cells or -1 when they are not ready.
+  vtkPolyData *Source;
+  unsigned long SourceMTime;
+  vtkIdType SourceNumberOfCells;
+  int BuiltNumberOfLevels;
+  int BuiltFinestDivisions;
+  double DataLength;
+  std::vector<vtkSmartPointer<vtkPolyDataMapper> > Mappers;
+  std::vector<vtkIdType> NumberOfCells;
+  std::vector<double> ReadyBinSizes;
+  vtkTimeStamp MapperCopyTime;
+
+  // The measured cost of drawing a cell.
+  double SecondsPerCell;
+
+  // The one shot timer that asks for the next refinement.
+  vtkWeakPointer<vtkRenderWindowInteractor> Interactor;
+  unsigned long ObserverTag;
+  int TimerId;
+  vtkSmartPointer<vtkCallbackCommand> TimerCallback;
+};
+
+//----------------------------------------------------------------------------
+// Make a decimation of an aborted build stop where it can.
+static void vtkProgressiveLODActorCheckAbort(vtkObject *caller,
+                                             unsigned long vtkNotUsed(eventId),
+                                             void *clientData,
+                                             void *vtkNotUsed(callData))
+{
+  if (static_cast<vtkProgressiveLODActorBuild*>(clientData)->Abort)
+    {
+    static_cast<vtkAlgorithm*>(caller)->SetAbortExecute(1);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkProgressiveLODActorBuild::BuildLevels()
+{
+  double bounds[6];
+  this->Input->GetBounds(bounds);
+  double extent = bounds[1] - bounds[0];
+  extent = (bounds[3] - bounds[2] > extent ? bounds[3] - bounds[2] : extent);
+  extent = (bounds[5] - bounds[4] > extent ? bounds[5] - bounds[4] : extent);
+
+  vtkNew<vtkCallbackCommand> checkAbort;
+  checkAbort->SetCallback(vtkProgressiveLODActorCheckAbort);
+  checkAbort->SetClientData(this);
+
+  // The coarse levels are the quickest to build and the first needed.
+  int numLevels = static_cast<int>(this->Levels.size());
+  for (int level = numLevels - 1; level > 0 && !this->Abort; --level)
+    {
+    int divisions = this->Divisions >> (level - 1);
+    divisions = (divisions < 2 ? 2 : divisions);
+    vtkNew<vtkQuadricClustering> filter;
+    filter->UseInputPointsOn();
+    filter->CopyCellDataOn();
+    filter->UseInternalTrianglesOff();
+    filter->SetNumberOfDivisions(divisions, divisions, divisions);
+    filter->SetInputData(this->Input);
+    filter->AddObserver(vtkCommand::ProgressEvent, checkAbort.GetPointer());
+    filter->Update();
+    if (this->Abort)
+      {
+      break;
+      }
+
+    vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+    output->ShallowCopy(filter->GetOutput());
+    this->Lock->Lock();
+    this->Levels[level] = output;
+    this->BinSizes[level] = extent/divisions;
+    this->Lock->Unlock();
+    }
+  this->Done = 1;
+}
+
+//----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkProgressiveLODActorThread(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  static_cast<vtkProgressiveLODActorBuild*>(info->UserData)->BuildLevels();
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+void vtkProgressiveLODActorInternals::Start()
+{
+  // Waiting for the aborted builds keeps a single decimation running.
+  vtkProgressiveLODActorBuild *build = this->Current;
+  if (build && build->Input && build->ThreadId < 0 && !build->Done &&
+      this->Abandoned.empty())
+    {
+    build->ThreadId =
+      this->Threader->SpawnThread(vtkProgressiveLODActorThread, build);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkProgressiveLODActorInternals::Abandon()
+{
+  vtkProgressiveLODActorBuild *build = this->Current;
+  this->Current = NULL;
+  if (build && build->ThreadId >= 0)
+    {
+    build->Abort = 1;
+    this->Abandoned.push_back(build);
+    }
+  else
+    {
+    delete build;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkProgressiveLODActorInternals::Reap(bool wait)
+{
+  size_t i = 0;
+  while (i < this->Abandoned.size())
+    {
+    vtkProgressiveLODActorBuild *build = this->Abandoned[i];
+    if (wait || build->Done)
+      {
+      this->Threader->TerminateThread(build->ThreadId);
+      delete build;
+      this->Abandoned.erase(this->Abandoned.begin() + i);
+      }
+    else
+      {
+      ++i;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkProgressiveLODActorInternals::Join()
+{
+  this->Reap(true);
+  this->Start();
+  vtkProgressiveLODActorBuild *build = this->Current;
+  if (build && build->ThreadId >= 0)
+    {
+    this->Threader->TerminateThread(build->ThreadId);
+    build->ThreadId = -1;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Render again when the refinement timer expires.
+static void vtkProgressiveLODActorRefine(vtkObject *caller,
+                                         unsigned long vtkNotUsed(eventId),
+                                         void *clientData, void *callData)
+{
+  vtkProgressiveLODActorInternals *internals =
+    static_cast<vtkProgressiveLODActorInternals*>(clientData);
+  int *timerId = static_cast<int*>(callData);
+  if (!timerId || *timerId != internals->TimerId)
+    {
+    return;
+    }
+  internals->TimerId = 0;
+  static_cast<vtkRenderWindowInteractor*>(caller)->Render();
+}
+
+//----------------------------------------------------------------------------
+// The number of pixels a unit of the data covers near the prop.
+static double vtkProgressiveLODActorPixelsPerUnit(vtkRenderer *ren,
+                                                  vtkProp3D *prop,
+                                                  double dataLength)
+{
+  vtkCamera *camera = ren->GetActiveCamera();
+  int *size = ren->GetSize();
+  double pixels;
+  if (camera->GetParallelProjection())
+    {
+    pixels = size[1]/(2.0*camera->GetParallelScale());
+    }
+  else
+    {
+    // the distance to the nearest point of the bounding sphere
+    double *center = prop->GetCenter();
+    double distance = sqrt(vtkMath::Distance2BetweenPoints(
+      center, camera->GetPosition())) - 0.5*prop->GetLength();
+    double *range = camera->GetClippingRange();
+    distance = (distance < range[0] ? range[0] : distance);
+    double tangent =
+      tan(vtkMath::RadiansFromDegrees(0.5*camera->GetViewAngle()));
+    pixels = size[1]/(2.0*distance*tangent);
+    }
+
+  // The bins are sized in data coordinates, which the prop may scale.
+  if (dataLength > 0.0)
+    {
+    pixels *= prop->GetLength()/dataLength;
+    }
+  return pixels;
+}
+
+//----------------------------------------------------------------------------
+vtkProgressiveLODActor::vtkProgressiveLODActor()
+{
+  this->NumberOfLevels = 4;
+  this->FinestDivisions = 64;
+  this->PixelsPerBin = 2.0;
+  this->ProgressiveRefinement = 1;
+  this->RefinementDelay = 10;
+  this->CurrentLevel = 0;
+
+  this->Device = vtkActor::New();
+  vtkMatrix4x4 *m = vtkMatrix4x4::New();
+  this->Device->SetUserMatrix(m);
+  m->Delete();
+
+  this->Internals = new vtkProgressiveLODActorInternals;
+  this->Internals->TimerCallback->SetCallback(vtkProgressiveLODActorRefine);
+  this->Internals->TimerCallback->SetClientData(this->Internals);
+}
+
+//----------------------------------------------------------------------------
+vtkProgressiveLODActor::~vtkProgressiveLODActor()
+{
+  vtkProgressiveLODActorInternals *internals = this->Internals;
+  internals->Abandon();
+  internals->Reap(true);
+  if (internals->Interactor)
+    {
+    if (internals->TimerId)
+      {
+      internals->Interactor->DestroyTimer(internals->TimerId);
+      }
+    internals->Interactor->RemoveObserver(internals->ObserverTag);
+    }
+  delete internals;
+  this->Device->Delete();
+}
+
+//----------------------------------------------------------------------------
+int vtkProgressiveLODActor::RenderOpaqueGeometry(vtkViewport *vp)
+{
+  int renderedSomething = 0;
+  vtkRenderer* ren = static_cast<vtkRenderer*>(vp);
+
+  if (!this->Mapper)
+    {
+    return 0;
+    }
+
+  // is this actor opaque ?
+  // Do this check only when not in selection mode
+  if (this->GetIsOpaque() ||
+    (ren->GetSelector() && this->Property->GetOpacity() > 0.0))
+    {
+    this->GetProperty()->Render(this, ren);
+
+    // render the backface property
+    if (this->BackfaceProperty)
+      {
+      this->BackfaceProperty->BackfaceRender(this, ren);
+      }
+
+    // render the texture
+    if (this->Texture)
+      {
+      this->Texture->Render(ren);
+      }
+    this->Render(ren, this->Mapper);
+
+    renderedSomething = 1;
+    }
+
+  return renderedSomething;
+}
+
+//----------------------------------------------------------------------------
+void vtkProgressiveLODActor::StartBuild(vtkPolyData *input)
+{
+  // The levels of the previous data are of no use any more, so rather than
+  // wait for them the render thread lets their build end on its own.
+  vtkProgressiveLODActorInternals *internals = this->Internals;
+  internals->Abandon();
+  internals->Reap(false);
+
+  int numLevels = this->NumberOfLevels;
+  internals->Source = input;
+  internals->SourceMTime = input->GetMTime();
+  internals->SourceNumberOfCells = input->GetNumberOfCells();
+  internals->BuiltNumberOfLevels = numLevels;
+  internals->BuiltFinestDivisions = this->FinestDivisions;
+  internals->DataLength = input->GetLength();
+  internals->NumberOfCells.assign(numLevels, -1);
+  internals->NumberOfCells[0] = internals->SourceNumberOfCells;
+  internals->ReadyBinSizes.assign(numLevels, 0.0);
+  while (static_cast<int>(internals->Mappers.size()) < numLevels)
+    {
+    internals->Mappers.push_back(vtkSmartPointer<vtkPolyDataMapper>::New());
+    }
+  for (size_t level = 1; level < internals->Mappers.size(); ++level)
+    {
+    internals->Mappers[level]->SetInputData(NULL);
+    }
+
+  vtkProgressiveLODActorBuild *build = new vtkProgressiveLODActorBuild;
+  build->Levels.assign(numLevels, NULL);
+  build->BinSizes.assign(numLevels, 0.0);
+  internals->Current = build;
+  if (internals->SourceNumberOfCells == 0)
+    {
+    return;
+    }
+
+  vtkDebugMacro("Building " << numLevels - 1 << " levels of detail");
+  build->Input = vtkSmartPointer<vtkPolyData>::New();
+  build->Input->DeepCopy(input);
+  build->Divisions = this->FinestDivisions;
+  internals->Start();
+}
+
+//----------------------------------------------------------------------------
+void vtkProgressiveLODActor::UpdateLevels(vtkPolyData *input)
+{
+  vtkProgressiveLODActorInternals *internals = this->Internals;
+  if (!input)
+    {
+    internals->Abandon();
+    internals->Reap(false);
+    internals->Source = NULL;
+    internals->NumberOfCells.clear();
+    return;
+    }
+  if (input != internals->Source ||
+      input->GetMTime() != internals->SourceMTime ||
+      this->NumberOfLevels != internals->BuiltNumberOfLevels ||
+      this->FinestDivisions != internals->BuiltFinestDivisions)
+    {
+    this->StartBuild(input);
+    }
+  else
+    {
+    // The build may be waiting for an aborted one to end.
+    internals->Reap(false);
+    internals->Start();
+    }
+
+  // Hand the new levels to their mappers, which otherwise follow the
+  // settings of the mapper of this actor.
+  vtkProgressiveLODActorBuild *build = internals->Current;
+  bool copySettings = this->Mapper->GetMTime() > internals->MapperCopyTime;
+  build->Lock->Lock();
+  for (int level = 1; level < internals->BuiltNumberOfLevels; ++level)
+    {
+    vtkPolyData *data = build->Levels[level];
+    vtkPolyDataMapper *mapper = internals->Mappers[level];
+    if (data && (copySettings || data != mapper->GetInput()))
+      {
+      mapper->ShallowCopy(this->Mapper);
+      mapper->SetInputData(data);
+      internals->NumberOfCells[level] = data->GetNumberOfCells();
+      internals->ReadyBinSizes[level] = build->BinSizes[level];
+      }
+    }
+  build->Lock->Unlock();
+  if (copySettings)
+    {
+    internals->MapperCopyTime.Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkProgressiveLODActor::SelectLevel(vtkRenderer *ren, double allowedTime)
+{
+  vtkProgressiveLODActorInternals *internals = this->Internals;
+  int numLevels = static_cast<int>(internals->NumberOfCells.size());
+  if (numLevels == 0)
+    {
+    return 0;
+    }
+
+  // The coarsest level whose bins are small enough on the screen.
+  int level = 0;
+  double pixelsPerUnit =
+    vtkProgressiveLODActorPixelsPerUnit(ren, this, internals->DataLength);
+  for (int i = 1; i < numLevels; ++i)
+    {
+    if (internals->NumberOfCells[i] >= 0 &&
+        internals->ReadyBinSizes[i]*pixelsPerUnit <= this->PixelsPerBin)
+      {
+      level = i;
+      }
+    }
+
+  // Coarser still if it cannot be drawn in time, down to the coarsest
+  // level that is ready.
+  if (internals->SecondsPerCell > 0.0)
+    {
+    for (int i = level; i < numLevels; ++i)
+      {
+      if (internals->NumberOfCells[i] >= 0)
+        {
+        level = i;
+        if (internals->NumberOfCells[i]*internals->SecondsPerCell <=
+            allowedTime)
+          {
+          break;
+          }
+        }
+      }
+    }
+  return level;
+}
+
+//----------------------------------------------------------------------------
+void vtkProgressiveLODActor::ScheduleRefinement(vtkRenderer *ren)
+{
+  vtkProgressiveLODActorInternals *internals = this->Internals;
+  vtkRenderWindow *renWin = ren->GetRenderWindow();
+  vtkRenderWindowInteractor *iren = (renWin ? renWin->GetInteractor() : NULL);
+  if (!iren)
+    {
+    return;
+    }
+  if (internals->Interactor != iren)
+    {
+    if (internals->Interactor)
+      {
+      internals->Interactor->RemoveObserver(internals->ObserverTag);
+      }
+    internals->Interactor = iren;
+    internals->ObserverTag = iren->AddObserver(vtkCommand::TimerEvent,
+                                               internals->TimerCallback);
+    internals->TimerId = 0;
+    }
+  if (!internals->TimerId)
+    {
+    internals->TimerId = iren->CreateOneShotTimer(this->RefinementDelay);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkProgressiveLODActor::Render(vtkRenderer *ren, vtkMapper *vtkNotUsed(m))
+{
+  if (!this->Mapper)
+    {
+    vtkErrorMacro("No mapper for actor.");
+    return;
+    }
+
+  vtkProgressiveLODActorInternals *internals = this->Internals;
+  this->Mapper->Update();
+  this->UpdateLevels(
+    vtkPolyData::SafeDownCast(this->Mapper->GetInputDataObject(0, 0)));
+
+  // A still render is allocated far more time than an interactive one.
+  double allowedTime = this->AllocatedRenderTime;
+  bool still = (allowedTime > 1.0);
+  int target = this->SelectLevel(ren, allowedTime);
+  int level = target;
+  int numLevels = static_cast<int>(internals->NumberOfCells.size());
+  if (still && this->ProgressiveRefinement && this->CurrentLevel > target)
+    {
+    // one level finer than the last render, among the ready ones
+    level = (this->CurrentLevel < numLevels ?
+             this->CurrentLevel : numLevels) - 1;
+    while (level > target && internals->NumberOfCells[level] < 0)
+      {
+      --level;
+      }
+    }
+  vtkMapper *mapper = this->Mapper;
+  if (level > 0)
+    {
+    mapper = internals->Mappers[level];
+    }
+  vtkDebugMacro("Level " << level << " of " << numLevels
+                << ", allowed time " << allowedTime);
+
+  // render the property
+  if (!this->Property)
+    {
+    // force creation of a property
+    this->GetProperty();
+    }
+  this->Property->Render(this, ren);
+  if (this->BackfaceProperty)
+    {
+    this->BackfaceProperty->BackfaceRender(this, ren);
+    this->Device->SetBackfaceProperty(this->BackfaceProperty);
+    }
+  this->Device->SetProperty(this->Property);
+
+  // render the texture
+  if (this->Texture)
+    {
+    this->Texture->Render(ren);
+    }
+
+  vtkMatrix4x4 *matrix = this->Device->GetUserMatrix();
+  this->GetMatrix(matrix);
+  this->Device->Render(ren, mapper);
+  this->EstimatedRenderTime = mapper->GetTimeToDraw();
+
+  // What a cell costs to draw, to pick the levels of the next renders.
+  vtkIdType numCells = (level < numLevels ?
+                        internals->NumberOfCells[level] : 0);
+  if (numCells > 0 && mapper->GetTimeToDraw() > 0.0)
+    {
+    internals->SecondsPerCell = mapper->GetTimeToDraw()/numCells;
+    }
+
+  this->CurrentLevel = level;
+  if (still && level > target)
+    {
+    this->ScheduleRefinement(ren);
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkProgressiveLODActor::GetNumberOfBuiltLevels()
+{
+  vtkProgressiveLODActorInternals *internals = this->Internals;
+  vtkProgressiveLODActorBuild *build = internals->Current;
+  int numLevels = (internals->Source ? 1 : 0);
+  if (!build)
+    {
+    return numLevels;
+    }
+  build->Lock->Lock();
+  for (size_t level = 1; level < build->Levels.size(); ++level)
+    {
+    numLevels += (build->Levels[level] ? 1 : 0);
+    }
+  build->Lock->Unlock();
+  return numLevels;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkProgressiveLODActor::GetLevelNumberOfCells(int level)
+{
+  vtkProgressiveLODActorInternals *internals = this->Internals;
+  vtkProgressiveLODActorBuild *build = internals->Current;
+  if (!build || level < 0 || level >= static_cast<int>(build->Levels.size()))
+    {
+    return -1;
+    }
+  if (level == 0)
+    {
+    return internals->SourceNumberOfCells;
+    }
+  build->Lock->Lock();
+  vtkPolyData *data = build->Levels[level];
+  vtkIdType numCells = (data ? data->GetNumberOfCells() : -1);
+  build->Lock->Unlock();
+  return numCells;
+}
+
+//----------------------------------------------------------------------------
+void vtkProgressiveLODActor::WaitForLevels()
+{
+  this->Internals->Join();
+}
+
+//----------------------------------------------------------------------------
+void vtkProgressiveLODActor::ReleaseGraphicsResources(vtkWindow *renWin)
+{
+  this->vtkActor::ReleaseGraphicsResources(renWin);
+  this->Device->ReleaseGraphicsResources(renWin);
+  for (size_t level = 1; level < this->Internals->Mappers.size(); ++level)
+    {
+    this->Internals->Mappers[level]->ReleaseGraphicsResources(renWin);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkProgressiveLODActor::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Number Of Levels: " << this->NumberOfLevels << "\n";
+  os << indent << "Finest Divisions: " << this->FinestDivisions << "\n";
+  os << indent << "Pixels Per Bin: " << this->PixelsPerBin << "\n";
+  os << indent << "Progressive Refinement: "
+     << (this->ProgressiveRefinement ? "On\n" : "Off\n");
+  os << indent << "Refinement Delay: " << this->RefinementDelay << "\n";
+  os << indent << "Current Level: " << this->CurrentLevel << "\n";
+}
@@ -0,0 +1,160 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkProgressiveLODActor.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkProgressiveLODActor - an actor with a hierarchy of levels of
+// detail built in the background
+// .SECTION Description
+// vtkProgressiveLODActor renders its polygonal data with one of
+// NumberOfLevels levels of detail.  Level 0 is the data itself, and the
+// other levels are decimated with vtkQuadricClustering, with FinestDivisions
+// divisions for level 1 and half as many for each following level.  The
+// levels are built on a worker thread as soon as the actor sees new data,
+// coarsest first, so that the render thread never waits for a decimation;
+// until a level is ready it is simply not used. When the data changes
+// during a build, the build is aborted and its levels are dropped without
+// waiting for it, and the build of the new data starts once the worker
+// thread of the old one has returned.
+//
+// At each render the level is the coarsest one whose bins project to at
+// most PixelsPerBin pixels, made coarser if needed so that it draws within
+// the time allocated to the actor, estimated from the time it took to draw
+// the previous frames.  When the interaction stops, which is when the
+// allocated time goes above one second as with the StillUpdateRate of
+// vtkRenderWindowInteractor, the actor refines from the level of the last
+// interactive frame one level per render if ProgressiveRefinement is on,
+// and asks the interactor, if any, for the next render after
+// RefinementDelay milliseconds.
+//
+// .SECTION Caveats
+// The data is copied for the worker thread, which is thus free to decimate
+// it while the pipeline modifies the original.  Only vtkPolyData input is
+// decimated, other data is always rendered at full resolution.
+//
+// .SECTION See Also
+// vtkLODActor vtkQuadricLODActor vtkQuadricClustering
+
+#ifndef vtkProgressiveLODActor_h
+#define vtkProgressiveLODActor_h
+
+#include "vtkRenderingLODModule.h" // For export macro
+#include "vtkActor.h"
+
+class vtkPolyData;
+class vtkProgressiveLODActorInternals;
+
+class VTKRENDERINGLOD_EXPORT vtkProgressiveLODActor : public vtkActor
+{
+public:
+  static vtkProgressiveLODActor *New();
+  vtkTypeMacro(vtkProgressiveLODActor, vtkActor);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // The number of levels, including the full resolution one. The default
+  // is 4.
+  vtkSetClampMacro(NumberOfLevels, int, 2, 8);
+  vtkGetMacro(NumberOfLevels, int);
+
+  // Description:
+  // The number of quadric clustering divisions along each axis of level 1,
+  // halved at each following level. The default is 64.
+  vtkSetClampMacro(FinestDivisions, int, 4, 256);
+  vtkGetMacro(FinestDivisions, int);
+
+  // Description:
+  // A level is fine enough for the view when its bins project to at most
+  // this many pixels. The default is 2. Set it to 0 to select the level on
+  // the allocated render time only.
+  vtkSetClampMacro(PixelsPerBin, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(PixelsPerBin, double);
+
+  // Description:
+  // Refine one level per render once the interaction stops, rather than
+  // going to the selected level at once. On by default.
+  vtkSetMacro(ProgressiveRefinement, int);
+  vtkGetMacro(ProgressiveRefinement, int);
+  vtkBooleanMacro(ProgressiveRefinement, int);
+
+  // Description:
+  // The delay, in milliseconds, of the render the interactor is asked for
+  // while refining. The default is 10.
+  vtkSetClampMacro(RefinementDelay, int, 0, VTK_INT_MAX);
+  vtkGetMacro(RefinementDelay, int);
+
+  // Description:
+  // The level drawn by the last render, 0 being full resolution.
+  vtkGetMacro(CurrentLevel, int);
+
+  // Description:
+  // The number of levels that are ready to render, including the full
+  // resolution one, and the number of cells of a level, or -1 if it is
+  // not ready.
+  int GetNumberOfBuiltLevels();
+  vtkIdType GetLevelNumberOfCells(int level);
+
+  // Description:
+  // Block until the worker thread has built all the levels.
+  void WaitForLevels();
+
+  // Description:
+  // This causes the actor to be rendered with the level of detail
+  // selected for the view and the allocated render time.
+  virtual void Render(vtkRenderer *, vtkMapper *);
+
+  // Description:
+  // This method is used internally by the rendering process. We overide
+  // the superclass method to properly set the estimated render time.
+  int RenderOpaqueGeometry(vtkViewport *viewport);
+
+  // Description:
+  // Release any graphics resources that are being consumed by this actor.
+  void ReleaseGraphicsResources(vtkWindow *);
+
+protected:
+  vtkProgressiveLODActor();
+  ~vtkProgressiveLODActor();
+
+  // Description:
+  // Start building the levels of the given data on the worker thread, after
+  // abandoning any build in progress, and hand the levels that are ready to
+  // their mappers.
+  void UpdateLevels(vtkPolyData *input);
+  void StartBuild(vtkPolyData *input);
+
+  // Description:
+  // The level for the view of the renderer and the allocated time.
+  int SelectLevel(vtkRenderer *ren, double allowedTime);
+
+  // Description:
+  // Ask the interactor of the renderer for another render.
+  void ScheduleRefinement(vtkRenderer *ren);
+
+  int NumberOfLevels;
+  int FinestDivisions;
+  double PixelsPerBin;
+  int ProgressiveRefinement;
+  int RefinementDelay;
+  int CurrentLevel;
+
+  // Renders the selected mapper with the matrix of this actor.
+  vtkActor *Device;
+
+  vtkProgressiveLODActorInternals *Internals;
+
+private:
+  vtkProgressiveLODActor(const vtkProgressiveLODActor&);  // Not implemented.
+  void operator=(const vtkProgressiveLODActor&);  // Not implemented.
+};
+
+#endif
@@ -0,0 +1,243 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestLabelPlacementMapperReuse.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkLabelPlacementMapper places labels that do not overlap,
+// and that it reuses the labels it placed when the view has not changed,
+// or has changed less than its placement reuse tolerance, only.
+
+#include "vtkActor2D.h"
+#include "vtkCamera.h"
+#include "vtkDoubleArray.h"
+#include "vtkFreeTypeLabelRenderStrategy.h"
+#include "vtkLabelPlacementMapper.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPointSetToLabelHierarchy.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkRenderWindow.h"
+#include "vtkRenderer.h"
+#include "vtkStringArray.h"
+#include "vtkTextProperty.h"
+
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+struct Placement
+{
+  int Position[2];
+  double Bounds[4];
+  vtkStdString Label;
+
+  bool operator==(const Placement& other) const
+  {
+    return this->Position[0] == other.Position[0] &&
+      this->Position[1] == other.Position[1] && this->Label == other.Label;
+  }
+};
+
+// Records the labels rendered rather than rendering them.
+class RecordingStrategy : public vtkFreeTypeLabelRenderStrategy
+{
+public:
+  static RecordingStrategy *New();
+  vtkTypeMacro(RecordingStrategy, vtkFreeTypeLabelRenderStrategy);
+
+  using vtkFreeTypeLabelRenderStrategy::RenderLabel;
+  virtual void RenderLabel(int x[2], vtkTextProperty* tprop,
+                           vtkUnicodeString label)
+  {
+    Placement p;
+    p.Position[0] = x[0];
+    p.Position[1] = x[1];
+    p.Label = label.utf8_str();
+    this->ComputeLabelBounds(tprop, label, p.Bounds);
+    this->Placements.push_back(p);
+  }
+
+  std::vector<Placement> Placements;
+};
+vtkStandardNewMacro(RecordingStrategy);
+
+// The placed labels overlap as the mapper tests them.
+bool Overlap(const std::vector<Placement>& placements)
+{
+  size_t n = placements.size();
+  std::vector<double> rects(4*n);
+  for (size_t i = 0; i < n; ++i)
+    {
+    const Placement& p = placements[i];
+    rects[4*i] = static_cast<int>(p.Position[0] + p.Bounds[0]);
+    rects[4*i + 1] = rects[4*i] + (p.Bounds[1] - p.Bounds[0]);
+    rects[4*i + 2] = static_cast<int>(p.Position[1] + p.Bounds[2]);
+    rects[4*i + 3] = rects[4*i + 2] + (p.Bounds[3] - p.Bounds[2]);
+    }
+  for (size_t i = 0; i < n; ++i)
+    {
+    for (size_t j = 0; j < i; ++j)
+      {
+      if (rects[4*i] < rects[4*j + 1] && rects[4*j] < rects[4*i + 1] &&
+          rects[4*i + 2] < rects[4*j + 3] && rects[4*j + 2] < rects[4*i + 3])
+        {
+        cerr << "Labels " << placements[j].Label << " and "
+             << placements[i].Label << " overlap" << endl;
+        return true;
+        }
+      }
+    }
+  return false;
+}
+
+int Check(vtkRenderWindow *renWin, vtkLabelPlacementMapper *mapper,
+          RecordingStrategy *strategy, bool reuse, const char *what)
+{
+  strategy->Placements.clear();
+  renWin->Render();
+  cout << what << ": " << mapper->GetNumberOfPlacedLabels()
+       << " labels placed" << (mapper->GetPlacementsReused() ? ", reused" : "")
+       << endl;
+  if (mapper->GetPlacementsReused() != reuse)
+    {
+    cerr << what << ": the labels should " << (reuse ? "" : "not ")
+         << "have been reused" << endl;
+    return 1;
+    }
+  if (strategy->Placements.empty() ||
+      static_cast<int>(strategy->Placements.size()) !=
+        mapper->GetNumberOfPlacedLabels() ||
+      Overlap(strategy->Placements))
+    {
+    cerr << what << ": wrong labels placed" << endl;
+    return 1;
+    }
+  return 0;
+}
+
+}
+
+int TestLabelPlacementMapperReuse(int, char *[])
+{
+  // many labels of random priorities, most of which overlap
+  const int numLabels = 20000;
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkStringArray> labels;
+  labels->SetName("Labels");
+  vtkNew<vtkDoubleArray> priorities;
+  priorities->SetName("Priority");
+  for (int i = 0; i < numLabels; ++i)
+    {
+    double x[3] = { 0.0, 0.0, 0.0 };
+    for (int j = 0; j < 2; ++j)
+      {
+      random->Next();
+      x[j] = random->GetRangeValue(-100.0, 100.0);
+      }
+    points->InsertNextPoint(x);
+    random->Next();
+    priorities->InsertNextValue(random->GetValue());
+    std::ostringstream label;
+    label << "Label " << i;
+    labels->InsertNextValue(label.str());
+    }
+  vtkNew<vtkPolyData> polyData;
+  polyData->SetPoints(points.GetPointer());
+  polyData->GetPointData()->AddArray(labels.GetPointer());
+  polyData->GetPointData()->AddArray(priorities.GetPointer());
+
+  vtkNew<vtkTextProperty> tprop;
+  tprop->SetFontSize(12);
+  vtkNew<vtkPointSetToLabelHierarchy> hierarchy;
+  hierarchy->SetInputData(polyData.GetPointer());
+  hierarchy->SetLabelArrayName("Labels");
+  hierarchy->SetPriorityArrayName("Priority");
+  hierarchy->SetTextProperty(tprop.GetPointer());
+
+  vtkNew<RecordingStrategy> strategy;
+  vtkNew<vtkLabelPlacementMapper> mapper;
+  mapper->SetInputConnection(hierarchy->GetOutputPort());
+  mapper->SetRenderStrategy(strategy.GetPointer());
+  vtkNew<vtkActor2D> actor;
+  actor->SetMapper(mapper.GetPointer());
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddActor(actor.GetPointer());
+  vtkNew<vtkRenderWindow> renWin;
+  renWin->SetSize(400, 400);
+  renWin->AddRenderer(renderer.GetPointer());
+  vtkCamera *camera = renderer->GetActiveCamera();
+  camera->SetPosition(0.0, 0.0, 300.0);
+  camera->SetFocalPoint(0.0, 0.0, 0.0);
+  camera->SetViewUp(0.0, 1.0, 0.0);
+  camera->SetClippingRange(100.0, 500.0);
+
+  int rval = Check(renWin.GetPointer(), mapper.GetPointer(),
+                   strategy.GetPointer(), false, "First frame");
+  std::vector<Placement> placed = strategy->Placements;
+
+  // the same view places the same labels
+  rval |= Check(renWin.GetPointer(), mapper.GetPointer(),
+                strategy.GetPointer(), true, "Same view");
+  if (strategy->Placements != placed)
+    {
+    cerr << "The labels reused differ from those placed" << endl;
+    rval = 1;
+    }
+
+  // any motion places the labels again without tolerance
+  camera->Azimuth(0.05);
+  rval |= Check(renWin.GetPointer(), mapper.GetPointer(),
+                strategy.GetPointer(), false, "Small motion");
+
+  // but not with one, unless the motion is too large
+  mapper->SetPlacementReuseTolerance(3.0);
+  rval |= Check(renWin.GetPointer(), mapper.GetPointer(),
+                strategy.GetPointer(), false, "Tolerance set");
+  placed = strategy->Placements;
+  camera->Azimuth(0.05);
+  rval |= Check(renWin.GetPointer(), mapper.GetPointer(),
+                strategy.GetPointer(), true, "Small motion with tolerance");
+  for (size_t i = 0; i < strategy->Placements.size(); ++i)
+    {
+    bool found = false;
+    for (size_t j = 0; j < placed.size() && !found; ++j)
+      {
+      found = (strategy->Placements[i].Label == placed[j].Label);
+      }
+    if (!found)
+      {
+      cerr << "Label " << strategy->Placements[i].Label
+           << " was not placed in the frame reused" << endl;
+      rval = 1;
+      break;
+      }
+    }
+  camera->Azimuth(10.0);
+  rval |= Check(renWin.GetPointer(), mapper.GetPointer(),
+                strategy.GetPointer(), false, "Large motion with tolerance");
+
+  // changing the labels places them again
+  tprop->SetFontSize(18);
+  rval |= Check(renWin.GetPointer(), mapper.GetPointer(),
+                strategy.GetPointer(), false, "Larger font");
+  rval |= Check(renWin.GetPointer(), mapper.GetPointer(),
+                strategy.GetPointer(), true, "Larger font again");
+
+  return rval;
+}
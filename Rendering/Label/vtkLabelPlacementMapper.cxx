@@ -40,11 +40,14 @@
 #include "vtkRenderer.h"
 #include "vtkRenderWindow.h"
 #include "vtkSelectVisiblePoints.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkTextProperty.h"
 #include "vtkTimerLog.h"
 #include "vtkTransformCoordinateSystems.h"
 
+#include <vector>
+
 // From: http://www.flipcode.com/archives/2D_OBB_Intersection.shtml
 class LabelRect
 {
@@ -69,6 +72,8 @@ public:
   // origin[a] = corner[0].dot(axis[a]);
   double Origin[2];
 
+  LabelRect() { }
+
   LabelRect(double center[2], const double w, const double h, double rotation)
   {
     double X[2];
@@ -332,9 +337,9 @@ public:
     std::vector<LabelRect> Labels;
     ScreenTile() { }
     /// Is there space to place the given rectangle in this tile so that it doesn't overlap any labels in this tile?
-    bool IsSpotOpen( const LabelRect& r )
+    bool IsSpotOpen( const LabelRect& r ) const
       {
-      for ( std::vector<LabelRect>::iterator it = this->Labels.begin(); it != this->Labels.end(); ++ it )
+      for ( std::vector<LabelRect>::const_iterator it = this->Labels.begin(); it != this->Labels.end(); ++ it )
         {
         if (r.Overlaps(*it))
           {
@@ -351,68 +356,240 @@ public:
       this->Labels.push_back( rect );
       }
     };
+
+  /// A label to place, with what is needed to place and render it.
+  struct Candidate
+    {
+    vtkLabelHierarchy* Hierarchy;
+    vtkIdType LabelId;
+    vtkIdType Type;
+    double Point[3];
+    int Origin[2];
+    double Bounds[4];
+    double LowerLeft[2];
+    double UpperRight[2];
+    double Orientation;
+    /// The width of a label of bounded size, 0 for the others.
+    int BoundedWidth;
+    vtkStdString Label;
+    vtkUnicodeString UnicodeLabel;
+    };
+
+  /// Tests the labels of a band against those placed before the band.
+  struct BandTester
+    {
+    const Internal* Self;
+    const Candidate* Band;
+    std::vector<LabelRect>* Rects;
+    std::vector<char>* Open;
+    const float* Frame;
+    bool PlaceAll;
+
+    void operator()( vtkIdType begin, vtkIdType end ) const
+      {
+      for ( vtkIdType i = begin; i < end; ++ i )
+        {
+        const Candidate& c = this->Band[i];
+        if ( c.BoundedWidth > 0 )
+          {
+          continue;
+          }
+        (*this->Rects)[i] = Internal::MakeRect( c, this->Frame );
+        (*this->Open)[i] =
+          this->PlaceAll || this->Self->IsSpotOpen( (*this->Rects)[i] );
+        }
+      }
+    };
+
+  /// The size, in pixels, of the cells of the occupancy map.
+  enum { CellSize = 8 };
+
   std::vector<std::vector<ScreenTile> > Tiles;
   float ScreenOrigin[2];
   float TileSize[2];
   int NumTiles[2];
+  /// One flag per cell of the screen, set when a placed label touches it.
+  /// Labels touching no set cell overlap no placed label.
+  std::vector<unsigned char> Occupied;
+  int NumCells[2];
   vtkSmartPointer<vtkIdTypeArray> NewLabelsPlaced;
   vtkSmartPointer<vtkIdTypeArray> LastLabelsPlaced;
 
+  /// The labels placed in the last full placement, in order, and what they
+  /// depend on, to reuse them in the next frames.
+  std::vector<Candidate> Placements;
+  bool PlacementsValid;
+  unsigned long PlacementTime;
+  float PlacementFrame[4];
+  int PlacementCoordinateSystem;
+
   Internal( float viewport[4], float tilesize[2] )
     {
     this->NewLabelsPlaced = vtkSmartPointer<vtkIdTypeArray>::New();
     this->LastLabelsPlaced = vtkSmartPointer<vtkIdTypeArray>::New();
-    this->ScreenOrigin[0] = viewport[0];
-    this->ScreenOrigin[1] = viewport[2];
-    this->TileSize[0] = tilesize[0];
-    this->TileSize[1] = tilesize[1];
-    this->NumTiles[0] = static_cast<int>( ceil( ( viewport[1] - viewport[0] ) / tilesize[0] ) );
-    this->NumTiles[1] = static_cast<int>( ceil( ( viewport[3] - viewport[2] ) / tilesize[1] ) );
-    this->Tiles.resize( this->NumTiles[0] );
-    for ( int i = 0; i < this->NumTiles[0]; ++ i )
-      this->Tiles[i].resize( this->NumTiles[1] );
+    this->NumTiles[0] = 0;
+    this->NumTiles[1] = 0;
+    this->PlacementsValid = false;
+    this->PlacementTime = 0;
+    this->PlacementCoordinateSystem = 0;
+    this->Reset( viewport, tilesize );
     }
 
-  bool PlaceLabel( const LabelRect& r )
+  /// Computes the tiles intersected by r, or returns false if it is not on
+  /// the screen.
+  bool GetTileRange( const LabelRect& r, int t[4] ) const
     {
-    // Determine intersected tiles
-    float rx0 = r.Bounds[0] / TileSize[0];
-    float rx1 = r.Bounds[1] / TileSize[0];
-    float ry0 = r.Bounds[2] / TileSize[1];
-    float ry1 = r.Bounds[3] / TileSize[1];
-    int tx0 = static_cast<int>( floor( rx0 ) );
-    int tx1 = static_cast<int>( ceil(  rx1 ) );
-    int ty0 = static_cast<int>( floor( ry0 ) );
-    int ty1 = static_cast<int>( ceil(  ry1 ) );
-    if ( tx0 > NumTiles[0] || tx1 < 0 || ty0 > NumTiles[1] || ty1 < 0 )
+    t[0] = static_cast<int>( floor( r.Bounds[0] / TileSize[0] ) );
+    t[1] = static_cast<int>( ceil(  r.Bounds[1] / TileSize[0] ) );
+    t[2] = static_cast<int>( floor( r.Bounds[2] / TileSize[1] ) );
+    t[3] = static_cast<int>( ceil(  r.Bounds[3] / TileSize[1] ) );
+    if ( t[0] > NumTiles[0] || t[1] < 0 || t[2] > NumTiles[1] || t[3] < 0 )
       return false; // Don't intersect screen.
-    if ( tx0 < 0 ) { tx0 = 0; rx0 = 0.; }
-    if ( ty0 < 0 ) { ty0 = 0; ry0 = 0.; }
-    if ( tx1 >= this->NumTiles[0] ) { tx1 = this->NumTiles[0] - 1; rx1 = tx1; }
-    if ( ty1 >= this->NumTiles[1] ) { ty1 = this->NumTiles[1] - 1; ry1 = ty1; }
+    if ( t[0] < 0 ) { t[0] = 0; }
+    if ( t[2] < 0 ) { t[2] = 0; }
+    if ( t[1] >= this->NumTiles[0] ) { t[1] = this->NumTiles[0] - 1; }
+    if ( t[3] >= this->NumTiles[1] ) { t[3] = this->NumTiles[1] - 1; }
+    return true;
+    }
+
+  /// Computes the cells of the occupancy map touched by the bounds of r,
+  /// clamped to the screen.
+  void GetCellRange( const LabelRect& r, int c[4] ) const
+    {
+    for ( int i = 0; i < 4; ++ i )
+      {
+      c[i] = static_cast<int>( floor( r.Bounds[i] / CellSize ) );
+      int last = this->NumCells[i / 2] - 1;
+      c[i] = c[i] < 0 ? 0 : ( c[i] > last ? last : c[i] );
+      }
+    }
+
+  /// Is there space to place r so that it doesn't overlap any placed label?
+  /// This only reads, so labels may be tested from several threads at once.
+  bool IsSpotOpen( const LabelRect& r ) const
+    {
+    int t[4];
+    if ( ! this->GetTileRange( r, t ) )
+      return false;
+    // Two labels overlapping touch a common cell, so if none of the cells
+    // of r is occupied, there is no need to look at the labels of the tiles.
+    int c[4];
+    this->GetCellRange( r, c );
+    bool occupied = false;
+    for ( int cy = c[2]; cy <= c[3] && ! occupied; ++ cy )
+      {
+      const unsigned char* row = &this->Occupied[cy * this->NumCells[0]];
+      for ( int cx = c[0]; cx <= c[1]; ++ cx )
+        {
+        if ( row[cx] )
+          {
+          occupied = true;
+          break;
+          }
+        }
+      }
+    if ( ! occupied )
+      return true;
     // Check all applicable tiles for overlap.
-    for ( int tx = tx0; tx <= tx1; ++ tx )
+    for ( int tx = t[0]; tx <= t[1]; ++ tx )
       {
-      for ( int ty = ty0; ty <= ty1; ++ ty )
+      for ( int ty = t[2]; ty <= t[3]; ++ ty )
         {
-        std::vector<ScreenTile>* trow = &this->Tiles[tx];
-        // Do this check here for speed, even though we repeat w/ small mod below.
-        if ( ! (*trow)[ty].IsSpotOpen( r ) )
+        if ( ! this->Tiles[tx][ty].IsSpotOpen( r ) )
           return false;
         }
       }
-    // OK, we made it this far... we can place the label.
-    // Add it to each tile it overlaps.
-    for ( int tx = tx0; tx <= tx1; ++ tx )
+    return true;
+    }
+
+  /// Adds r to each tile it overlaps, and marks its cells as occupied.
+  void Insert( const LabelRect& r )
+    {
+    int t[4];
+    if ( ! this->GetTileRange( r, t ) )
+      return;
+    for ( int tx = t[0]; tx <= t[1]; ++ tx )
       {
-      for ( int ty = ty0; ty <= ty1; ++ ty )
+      for ( int ty = t[2]; ty <= t[3]; ++ ty )
         {
         this->Tiles[tx][ty].Insert( r );
         }
       }
+    int c[4];
+    this->GetCellRange( r, c );
+    for ( int cy = c[2]; cy <= c[3]; ++ cy )
+      {
+      unsigned char* row = &this->Occupied[cy * this->NumCells[0]];
+      for ( int cx = c[0]; cx <= c[1]; ++ cx )
+        {
+        row[cx] = 1;
+        }
+      }
+    }
+
+  bool PlaceLabel( const LabelRect& r )
+    {
+    if ( ! this->IsSpotOpen( r ) )
+      return false;
+    // OK, we made it this far... we can place the label.
+    this->Insert( r );
     return true;
     }
 
+  /// Computes the corners of a label anchored at origin, translated so that
+  /// the frame starts at 0, or returns false if it has no size or is out of
+  /// the frame.
+  static bool ComputeCorners( const int origin[2], const double bds[4],
+    const float frame[4], double ll[2], double ur[2] )
+    {
+    // Offset display position by lower left corner of bounding box
+    int dispx[2];
+    dispx[0] = static_cast<int>(origin[0] + bds[0]);
+    dispx[1] = static_cast<int>(origin[1] + bds[2]);
+
+    double sz[2];
+    sz[0] = bds[1] - bds[0];
+    sz[1] = bds[3] - bds[2];
+
+    if ( sz[0] < 0 ) sz[0] = -sz[0];
+    if ( sz[1] < 0 ) sz[1] = -sz[1];
+
+    // If it has no size, skip it
+    if ( sz[0] == 0.0 || sz[1] == 0.0 )
+      {
+      return false;
+      }
+
+    ll[0] = dispx[0];
+    ll[1] = dispx[1];
+    ur[0] = dispx[0] + sz[0];
+    ur[1] = dispx[1] + sz[1];
+
+    if ( ll[1] > frame[3] || ur[1] < frame[2] || ll[0] > frame[1] || ll[1] < frame[0] )
+      {
+      return false; // cull label not in frame
+      }
+    return true;
+    }
+
+  /// The rectangle of a label, translated to the origin to simplify
+  /// bucketing.
+  static LabelRect MakeRect( const Candidate& c, const float frame[4] )
+    {
+    double xTrans[4];
+    xTrans[0] = c.LowerLeft[0] - frame[0];
+    xTrans[1] = c.UpperRight[0] - frame[0];
+    xTrans[2] = c.LowerLeft[1] - frame[2];
+    xTrans[3] = c.UpperRight[1] - frame[2];
+
+    double originTrans[2];
+    originTrans[0] = c.Origin[0] - frame[0];
+    originTrans[1] = c.Origin[1] - frame[2];
+
+    double orientRad = vtkMath::RadiansFromDegrees(c.Orientation);
+    return LabelRect( xTrans, originTrans, orientRad );
+    }
+
   void Reset( float viewport[4], float tileSize[2] )
     {
     // Clear out any tiles we get to reuse
@@ -433,6 +610,10 @@ public:
     for ( int i = 0; i < this->NumTiles[0]; ++ i )
       this->Tiles[i].resize( this->NumTiles[1] );
 
+    this->NumCells[0] = static_cast<int>( ceil( ( viewport[1] - viewport[0] ) / CellSize ) ) + 1;
+    this->NumCells[1] = static_cast<int>( ceil( ( viewport[3] - viewport[2] ) / CellSize ) ) + 1;
+    this->Occupied.assign( this->NumCells[0] * this->NumCells[1], 0 );
+
     // Save labels from the last frame for use later...
     vtkSmartPointer<vtkIdTypeArray> tmp = this->LastLabelsPlaced;
     this->LastLabelsPlaced = this->NewLabelsPlaced;
@@ -441,6 +622,44 @@ public:
     }
 };
 
+namespace
+{
+
+// The number of labels taken from the hierarchies at once.
+const size_t BandSize = 1024;
+
+// The time the labels placed were last modified: that of the mapper, its
+// render strategy, and its inputs and their text properties.
+unsigned long GetPlacementTime( vtkLabelPlacementMapper* self )
+{
+  unsigned long time = self->GetMTime();
+  if ( self->GetRenderStrategy() )
+    {
+    unsigned long t = self->GetRenderStrategy()->GetMTime();
+    time = t > time ? t : time;
+    }
+  int numInputs = self->GetNumberOfInputConnections( 0 );
+  for ( int i = 0; i < numInputs; ++i )
+    {
+    vtkLabelHierarchy* inData = vtkLabelHierarchy::SafeDownCast(
+      self->GetInputDataObject( 0, i ) );
+    if ( ! inData )
+      {
+      continue;
+      }
+    unsigned long t = inData->GetMTime();
+    time = t > time ? t : time;
+    if ( inData->GetTextProperty() )
+      {
+      t = inData->GetTextProperty()->GetMTime();
+      time = t > time ? t : time;
+      }
+    }
+  return time;
+}
+
+}
+
 vtkStandardNewMacro(vtkLabelPlacementMapper);
 vtkCxxSetObjectMacro(vtkLabelPlacementMapper, AnchorTransform, vtkCoordinate);
 vtkCxxSetObjectMacro(vtkLabelPlacementMapper, RenderStrategy, vtkLabelRenderStrategy);
@@ -480,6 +699,11 @@ vtkLabelPlacementMapper::vtkLabelPlacementMapper()
   this->LastCameraViewUp[1] = 0.0;
   this->LastCameraViewUp[2] = 0.0;
   this->LastCameraParallelScale = 0.0;
+  this->LastCameraViewAngle = 0.0;
+  this->LastCameraParallelProjection = 0;
+  this->PlacementReuseTolerance = 0.0;
+  this->NumberOfPlacedLabels = 0;
+  this->PlacementsReused = false;
 
   this->UseDepthBuffer = false;
 
@@ -573,6 +797,7 @@ void vtkLabelPlacementMapper::RenderOverlay(vtkViewport *viewport,
     this->Buckets->NumTiles[0] * this->Buckets->TileSize[0] < tvpsz[2] ||
     this->Buckets->NumTiles[1] * this->Buckets->TileSize[1] < tvpsz[3] )
     {
+    delete this->Buckets;
     this->Buckets = new Internal( kdbounds, tileSize );
     }
   else
@@ -580,16 +805,89 @@ void vtkLabelPlacementMapper::RenderOverlay(vtkViewport *viewport,
     this->Buckets->Reset( kdbounds, tileSize );
     }
 
+  // The labels placed last are reused when nothing they depend on has
+  // changed since the last frame and the camera has moved little enough.
+  double* eye = cam->GetPosition();
+  double* dir = cam->GetViewPlaneNormal();
+  double camVec[3];
+  if ( this->PositionsAsNormals )
+    {
+    cam->GetViewPlaneNormal( camVec );
+    }
+  double* camFocalPoint = cam->GetFocalPoint();
+  double* camViewUp = cam->GetViewUp();
+  bool cameraUnchanged =
+    renSize[0] == this->LastRendererSize[0] &&
+    renSize[1] == this->LastRendererSize[1] &&
+    eye[0] == this->LastCameraPosition[0] &&
+    eye[1] == this->LastCameraPosition[1] &&
+    eye[2] == this->LastCameraPosition[2] &&
+    camFocalPoint[0] == this->LastCameraFocalPoint[0] &&
+    camFocalPoint[1] == this->LastCameraFocalPoint[1] &&
+    camFocalPoint[2] == this->LastCameraFocalPoint[2] &&
+    camViewUp[0] == this->LastCameraViewUp[0] &&
+    camViewUp[1] == this->LastCameraViewUp[1] &&
+    camViewUp[2] == this->LastCameraViewUp[2] &&
+    cam->GetParallelScale() == this->LastCameraParallelScale &&
+    cam->GetViewAngle() == this->LastCameraViewAngle &&
+    cam->GetParallelProjection() == this->LastCameraParallelProjection;
+  bool reuse =
+    this->Buckets->PlacementsValid &&
+    ! this->UseDepthBuffer && ! this->OutputTraversedBounds &&
+    GetPlacementTime( this ) <= this->Buckets->PlacementTime &&
+    this->AnchorTransform->GetCoordinateSystem() ==
+      this->Buckets->PlacementCoordinateSystem &&
+    kdbounds[0] == this->Buckets->PlacementFrame[0] &&
+    kdbounds[1] == this->Buckets->PlacementFrame[1] &&
+    kdbounds[2] == this->Buckets->PlacementFrame[2] &&
+    kdbounds[3] == this->Buckets->PlacementFrame[3] &&
+    ( cameraUnchanged ||
+      ( this->PlacementReuseTolerance > 0.0 &&
+        ! this->Buckets->Placements.empty() ) );
+
+  // When the camera has moved, the labels are moved to their new anchors,
+  // unless an anchor has moved too far.
+  std::vector<Internal::Candidate> moved;
+  if ( reuse && ! cameraUnchanged )
+    {
+    double tolerance2 =
+      this->PlacementReuseTolerance * this->PlacementReuseTolerance;
+    moved.reserve( this->Buckets->Placements.size() );
+    std::vector<Internal::Candidate>::const_iterator it;
+    for ( it = this->Buckets->Placements.begin();
+          reuse && it != this->Buckets->Placements.end(); ++ it )
+      {
+      Internal::Candidate c = *it;
+      this->AnchorTransform->SetValue( c.Point );
+      int* originPtr = this->AnchorTransform->GetComputedDisplayValue( ren );
+      double dx = originPtr[0] - c.Origin[0];
+      double dy = originPtr[1] - c.Origin[1];
+      if ( dx * dx + dy * dy > tolerance2 )
+        {
+        reuse = false;
+        break;
+        }
+      c.Origin[0] = originPtr[0];
+      c.Origin[1] = originPtr[1];
+      const double* x = c.Point;
+      if ( ( x[0] - eye[0] ) * dir[0] + ( x[1] - eye[1] ) * dir[1] + ( x[2] - eye[2] ) * dir[2] > 0 ||
+           ( this->PositionsAsNormals &&
+             camVec[0] * x[0] + camVec[1] * x[1] + camVec[2] * x[2] < 0. ) ||
+           ! Internal::ComputeCorners(
+             c.Origin, c.Bounds, kdbounds, c.LowerLeft, c.UpperRight ) )
+        {
+        continue;
+        }
+      moved.push_back( c );
+      }
+    }
+  const std::vector<Internal::Candidate>& reused =
+    cameraUnchanged ? this->Buckets->Placements : moved;
+
   float * zPtr = NULL;
   int placed = 0;
   int occluded = 0;
 
-  double ll[2];
-  double ur[2];
-  double x[3];
-  double sz[4];
-  int origin[2];
-  int dispx[2];
   double frustumPlanes[24];
   double aspect = ren->GetTiledAspectRatio();
   cam->GetFrustumPlanes( aspect, frustumPlanes );
@@ -598,11 +896,6 @@ void vtkLabelPlacementMapper::RenderOverlay(vtkViewport *viewport,
   (void)allowableLabelArea;
   unsigned long renderedLabelArea = 0;
   unsigned long iteratedLabelArea = 0;
-  double camVec[3];
-  if ( this->PositionsAsNormals )
-    {
-    cam->GetViewPlaneNormal( camVec );
-    }
 
   // Make a composite iterator that will iterate over all the input
   // label hierarchies in a round-robin sequence.
@@ -619,27 +912,33 @@ void vtkLabelPlacementMapper::RenderOverlay(vtkViewport *viewport,
     inIter->SetTraversedBounds( boundsPoly );
     }
 
-  int numInputs = this->GetNumberOfInputConnections( 0 );
-  for ( int i = 0; i < numInputs; ++i )
-    {
-    vtkLabelHierarchy* inData = vtkLabelHierarchy::SafeDownCast(
-        this->GetInputDataObject( 0, i ) );
-    vtkLabelHierarchyIterator* it = inData->NewIterator(
-      this->IteratorType, ren, cam, frustumPlanes, this->PositionsAsNormals, tileSize );
-    inIter->AddIterator( it );
-    it->Delete();
-    }
-
   vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
   timer->StartTimer();
 
-  inIter->Begin( this->Buckets->LastLabelsPlaced );
-  this->Buckets->NewLabelsPlaced->Initialize();
-
-  if ( this->UseDepthBuffer )
+  if ( ! reuse )
     {
-    this->VisiblePoints->SetRenderer( ren );
-    zPtr = this->VisiblePoints->Initialize( true );
+    int numInputs = this->GetNumberOfInputConnections( 0 );
+    for ( int i = 0; i < numInputs; ++i )
+      {
+      vtkLabelHierarchy* inData = vtkLabelHierarchy::SafeDownCast(
+          this->GetInputDataObject( 0, i ) );
+      vtkLabelHierarchyIterator* it = inData->NewIterator(
+        this->IteratorType, ren, cam, frustumPlanes, this->PositionsAsNormals, tileSize );
+      inIter->AddIterator( it );
+      it->Delete();
+      }
+
+    inIter->Begin( this->Buckets->LastLabelsPlaced );
+    this->Buckets->NewLabelsPlaced->Initialize();
+
+    if ( this->UseDepthBuffer )
+      {
+      this->VisiblePoints->SetRenderer( ren );
+      zPtr = this->VisiblePoints->Initialize( true );
+      }
+
+    this->Buckets->Placements.clear();
+    this->Buckets->PlacementsValid = true;
     }
 
   // Start rendering labels
@@ -652,196 +951,252 @@ void vtkLabelPlacementMapper::RenderOverlay(vtkViewport *viewport,
 
   vtkSmartPointer<vtkTextProperty> tpropCopy = vtkSmartPointer<vtkTextProperty>::New();
 
-  for ( ; ! inIter->IsAtEnd(); inIter->Next() )
+  // The labels are taken in bands, either from the hierarchies in order of
+  // priority or from those placed last, tested in parallel against the
+  // labels placed before the band, and then placed in order.
+  std::vector<Internal::Candidate> band;
+  std::vector<LabelRect> rects;
+  std::vector<char> open;
+  std::vector<LabelRect> bandPlaced;
+  size_t nextReused = 0;
+  for (;;)
     {
-    // Ignore labels that don't have text or an icon.
-    vtkIdType labelType = inIter->GetType();
-    if ( labelType < 0 || labelType > 1 )
+    const Internal::Candidate* first;
+    size_t numCandidates;
+    if ( reuse )
       {
-      vtkDebugMacro("Arf. Bad label type " << labelType);
-      continue;
+      first = reused.empty() ? 0 : &reused[0] + nextReused;
+      numCandidates = reused.size() - nextReused;
+      numCandidates = numCandidates < BandSize ? numCandidates : BandSize;
+      nextReused += numCandidates;
       }
-
-    inIter->GetPoint( x );
-    // Cull points behind the camera. Cannot rely on hither-yon planes because the camera
-    // position gets changed during vtkInteractorStyle::Dolly() and RequestData() called from
-    // within ResetCameraClippingRange() before the frustum planes are updated.
-    // Cull points outside hither-yon planes (other planes get tested below)
-    double* eye = cam->GetPosition();
-    double* dir = cam->GetViewPlaneNormal();
-    if ( ( x[0] - eye[0] ) * dir[0] + ( x[1] - eye[1] ) * dir[1] + ( x[2] - eye[2] ) * dir[2] > 0 )
-      {
-      continue;
-      }
-
-    // Ignore labels pointing the wrong direction (HACK)
-    if ( this->PositionsAsNormals )
+    else
       {
-      if ( camVec[0] * x[0] + camVec[1] * x[1] + camVec[2] * x[2] < 0. )
+      band.clear();
+      Internal::Candidate c;
+      for ( ; band.size() < BandSize && ! inIter->IsAtEnd(); inIter->Next() )
         {
-        continue;
-        }
-      }
+        // Ignore labels that don't have text or an icon.
+        vtkIdType labelType = inIter->GetType();
+        if ( labelType < 0 || labelType > 1 )
+          {
+          vtkDebugMacro("Arf. Bad label type " << labelType);
+          continue;
+          }
 
-    // Test for occlusion using the z-buffer
-    if (this->UseDepthBuffer && !this->VisiblePoints->IsPointOccluded(x, zPtr))
-      {
-      occluded++;
-      continue;
-      }
+        double* x = c.Point;
+        inIter->GetPoint( x );
+        // Cull points behind the camera. Cannot rely on hither-yon planes because the camera
+        // position gets changed during vtkInteractorStyle::Dolly() and RequestData() called from
+        // within ResetCameraClippingRange() before the frustum planes are updated.
+        // Cull points outside hither-yon planes (other planes get tested below)
+        if ( ( x[0] - eye[0] ) * dir[0] + ( x[1] - eye[1] ) * dir[1] + ( x[2] - eye[2] ) * dir[2] > 0 )
+          {
+          continue;
+          }
 
-    this->AnchorTransform->SetValue( x );
-    int* originPtr = this->AnchorTransform->GetComputedDisplayValue( ren );
-    origin[0] = originPtr[0];
-    origin[1] = originPtr[1];
+        // Ignore labels pointing the wrong direction (HACK)
+        if ( this->PositionsAsNormals )
+          {
+          if ( camVec[0] * x[0] + camVec[1] * x[1] + camVec[2] * x[2] < 0. )
+            {
+            continue;
+            }
+          }
 
-    // Determine the label bounds
-    vtkTextProperty* tprop = inIter->GetHierarchy()->GetTextProperty();
-    tpropCopy->ShallowCopy( tprop );
+        // Test for occlusion using the z-buffer
+        if (this->UseDepthBuffer && !this->VisiblePoints->IsPointOccluded(x, zPtr))
+          {
+          occluded++;
+          continue;
+          }
 
-    if ( this->RenderStrategy->SupportsRotation() && inIter->GetHierarchy()->GetOrientations() )
-      {
-      tpropCopy->SetOrientation( inIter->GetOrientation() );
-      }
+        this->AnchorTransform->SetValue( x );
+        int* originPtr = this->AnchorTransform->GetComputedDisplayValue( ren );
+        c.Origin[0] = originPtr[0];
+        c.Origin[1] = originPtr[1];
 
-    double bds[4];
-    if ( this->UseUnicodeStrings )
-      {
-      this->RenderStrategy->ComputeLabelBounds( tpropCopy, inIter->GetUnicodeLabel(), bds );
-      }
-    else
-      {
-      this->RenderStrategy->ComputeLabelBounds( tpropCopy, inIter->GetLabel(), bds );
-      }
-
-    // Offset display position by lower left corner of bounding box
-    dispx[0] = static_cast<int>(origin[0] + bds[0]);
-    dispx[1] = static_cast<int>(origin[1] + bds[2]);
+        // Determine the label bounds
+        vtkTextProperty* tprop = inIter->GetHierarchy()->GetTextProperty();
+        tpropCopy->ShallowCopy( tprop );
 
-    sz[0] = bds[1] - bds[0];
-    sz[1] = bds[3] - bds[2];
+        if ( this->RenderStrategy->SupportsRotation() && inIter->GetHierarchy()->GetOrientations() )
+          {
+          tpropCopy->SetOrientation( inIter->GetOrientation() );
+          }
 
-    if ( sz[0] < 0 ) sz[0] = -sz[0];
-    if ( sz[1] < 0 ) sz[1] = -sz[1];
+        double* bds = c.Bounds;
+        if ( this->UseUnicodeStrings )
+          {
+          c.UnicodeLabel = inIter->GetUnicodeLabel();
+          this->RenderStrategy->ComputeLabelBounds( tpropCopy, c.UnicodeLabel, bds );
+          }
+        else
+          {
+          c.Label = inIter->GetLabel();
+          this->RenderStrategy->ComputeLabelBounds( tpropCopy, c.Label, bds );
+          }
 
-    // If it has no size, skip it
-    if ( sz[0] == 0.0 || sz[1] == 0.0 )
-      {
-      continue;
-      }
+        if ( ! Internal::ComputeCorners( c.Origin, bds, kdbounds, c.LowerLeft, c.UpperRight ) )
+          {
+          continue;
+          }
 
-    ll[0] = dispx[0];
-    ll[1] = dispx[1];
-    ur[0] = dispx[0] + sz[0];
-    ur[1] = dispx[1] + sz[1];
+        // Special case: if there are bounded sizes, try to render every one we encounter.
+        c.BoundedWidth = 0;
+        if ( this->RenderStrategy->SupportsBoundedSize() && inIter->GetHierarchy()->GetBoundedSizes() )
+          {
+          double p[3] = { static_cast<double>(c.Origin[0]), static_cast<double>(c.Origin[1]), 0.0 };
+          double boundedSize[2];
+          inIter->GetBoundedSize( boundedSize );
+
+          // Figure out if width is too small to fit
+          double xWidth[3] = {x[0] + boundedSize[0], x[1], x[2]};
+          this->AnchorTransform->SetValue( xWidth );
+          int* origin2 = this->AnchorTransform->GetComputedDisplayValue( ren );
+          double pWidth[3] = { static_cast<double>(origin2[0]), static_cast<double>(origin2[1]), 0.0 };
+          int width = static_cast<int>(sqrt(vtkMath::Distance2BetweenPoints(p, pWidth)));
+          if ( width < 20 )
+            {
+            continue;
+            }
+
+          // Figure out if height is too small to fit
+          double xHeight[3] = {x[0], x[1] + boundedSize[1], x[2]};
+          this->AnchorTransform->SetValue( xHeight );
+          origin2 = this->AnchorTransform->GetComputedDisplayValue( ren );
+          double pHeight[3] = { static_cast<double>(origin2[0]), static_cast<double>(origin2[1]), 0.0 };
+          int height = static_cast<int>(sqrt(vtkMath::Distance2BetweenPoints(p, pHeight)));
+          if ( height < bds[3] - bds[2] )
+            {
+            continue;
+            }
+
+          // Label is not text
+          if ( labelType != 0 )
+            {
+            continue;
+            }
+
+          c.BoundedWidth = width;
+          }
 
-    if ( ll[1] > kdbounds[3] || ur[1] < kdbounds[2] || ll[0] > kdbounds[1] || ll[1] < kdbounds[0] )
+        c.Hierarchy = inIter->GetHierarchy();
+        c.LabelId = inIter->GetLabelId();
+        c.Type = labelType;
+        c.Orientation = tpropCopy->GetOrientation();
+        band.push_back( c );
+        }
+      first = band.empty() ? 0 : &band[0];
+      numCandidates = band.size();
+      }
+    if ( numCandidates == 0 )
       {
-      continue; // cull label not in frame
+      break;
       }
 
-    // Special case: if there are bounded sizes, try to render every one we encounter.
-    if ( this->RenderStrategy->SupportsBoundedSize() && inIter->GetHierarchy()->GetBoundedSizes() )
+    // Labels overlapping one placed before the band are rejected in
+    // parallel, as the labels placed only ever grow.
+    rects.resize( numCandidates );
+    open.assign( numCandidates, 0 );
+    Internal::BandTester tester;
+    tester.Self = this->Buckets;
+    tester.Band = first;
+    tester.Rects = &rects;
+    tester.Open = &open;
+    tester.Frame = kdbounds;
+    tester.PlaceAll = this->PlaceAllLabels;
+    vtkSMPTools::For( 0, static_cast<vtkIdType>( numCandidates ), tester );
+
+    bandPlaced.clear();
+    for ( size_t i = 0; i < numCandidates; ++ i )
       {
-      double p[3] = { static_cast<double>(origin[0]), static_cast<double>(origin[1]), 0.0 };
-      double boundedSize[2];
-      inIter->GetBoundedSize( boundedSize );
-
-      // Figure out if width is too small to fit
-      double xWidth[3] = {x[0] + boundedSize[0], x[1], x[2]};
-      this->AnchorTransform->SetValue( xWidth );
-      int* origin2 = this->AnchorTransform->GetComputedDisplayValue( ren );
-      double pWidth[3] = { static_cast<double>(origin2[0]), static_cast<double>(origin2[1]), 0.0 };
-      int width = static_cast<int>(sqrt(vtkMath::Distance2BetweenPoints(p, pWidth)));
-      if ( width < 20 )
+      const Internal::Candidate& c = first[i];
+      if ( c.BoundedWidth > 0 )
         {
+        // Render it
+        tpropCopy->ShallowCopy( c.Hierarchy->GetTextProperty() );
+        tpropCopy->SetOrientation( c.Orientation );
+        int origin[2] = { c.Origin[0], c.Origin[1] };
+        if( this->UseUnicodeStrings )
+          {
+          this->RenderStrategy->RenderLabel( origin, tpropCopy, c.UnicodeLabel, c.BoundedWidth );
+          }
+        else
+          {
+          this->RenderStrategy->RenderLabel( origin, tpropCopy, c.Label, c.BoundedWidth );
+          }
+        const double* bds = c.Bounds;
+        int renderedHeight = static_cast<int>( bds[3] - bds[2] );
+        int renderedWidth = static_cast<int>( (bds[1] - bds[0] < c.BoundedWidth) ? (bds[1] - bds[0]) : c.BoundedWidth );
+        renderedLabelArea += static_cast<unsigned long>( renderedWidth * renderedHeight );
+        // The bounded sizes depend on the camera, so these labels are not
+        // reused.
+        this->Buckets->PlacementsValid = false;
         continue;
         }
 
-      // Figure out if height is too small to fit
-      double xHeight[3] = {x[0], x[1] + boundedSize[1], x[2]};
-      this->AnchorTransform->SetValue( xHeight );
-      origin2 = this->AnchorTransform->GetComputedDisplayValue( ren );
-      double pHeight[3] = { static_cast<double>(origin2[0]), static_cast<double>(origin2[1]), 0.0 };
-      int height = static_cast<int>(sqrt(vtkMath::Distance2BetweenPoints(p, pHeight)));
-      if ( height < bds[3] - bds[2] )
+      const double* ll = c.LowerLeft;
+      const double* ur = c.UpperRight;
+      if ( this->Debug )
         {
-        continue;
+        vtkDebugMacro("Try: " << c.LabelId << " (" << ll[0] << ", " << ll[1] << "  " << ur[0] << "," << ur[1] << ")");
+        if ( c.Type == 0 )
+          {
+          if( this->UseUnicodeStrings )
+            {
+            vtkDebugMacro("Area: " << renderedLabelArea << "  /  " << allowableLabelArea << " \"" << c.UnicodeLabel.utf8_str() << "\"");
+            }
+          else
+            {
+            vtkDebugMacro("Area: " << renderedLabelArea << "  /  " << allowableLabelArea << " \"" << c.Label.c_str() << "\"");
+            }
+          }
+        else
+          {
+          vtkDebugMacro("Area: " << renderedLabelArea << "  /  " << allowableLabelArea);
+          }
         }
 
-      // Label is not text
-      if ( labelType != 0 )
-        {
-        continue;
-        }
+      double sz[2] = { ur[0] - ll[0], ur[1] - ll[1] };
+      iteratedLabelArea += static_cast<unsigned long>( sz[0] * sz[1] );
 
-      // Render it
-      if( this->UseUnicodeStrings )
+      if ( ! open[i] )
         {
-        this->RenderStrategy->RenderLabel( origin, tpropCopy, inIter->GetUnicodeLabel(), width );
+        continue;
         }
-      else
+      const LabelRect& r = rects[i];
+      if ( ! this->PlaceAllLabels )
         {
-        this->RenderStrategy->RenderLabel( origin, tpropCopy, inIter->GetLabel(), width );
-        }
-      int renderedHeight = static_cast<int>( bds[3] - bds[2] );
-      int renderedWidth = static_cast<int>( (bds[1] - bds[0] < width) ? (bds[1] - bds[0]) : width );
-      renderedLabelArea += static_cast<unsigned long>( renderedWidth * renderedHeight );
-      continue;
-      }
-
-    if ( this->Debug )
-      {
-      vtkDebugMacro("Try: " << inIter->GetLabelId() << " (" << ll[0] << ", " << ll[1] << "  " << ur[0] << "," << ur[1] << ")");
-      if ( labelType == 0 )
-        {
-        if( this->UseUnicodeStrings )
+        // Only the labels placed in this band are left to test.
+        bool overlaps = false;
+        for ( size_t j = 0; j < bandPlaced.size() && ! overlaps; ++ j )
           {
-          vtkDebugMacro("Area: " << renderedLabelArea << "  /  " << allowableLabelArea << " \"" << inIter->GetUnicodeLabel().utf8_str() << "\"");
+          overlaps = r.Overlaps( bandPlaced[j] );
           }
-        else
+        if ( overlaps )
           {
-          vtkDebugMacro("Area: " << renderedLabelArea << "  /  " << allowableLabelArea << " \"" << inIter->GetLabel().c_str() << "\"");
+          continue;
           }
+        this->Buckets->Insert( r );
+        bandPlaced.push_back( r );
         }
-      else
-        {
-        vtkDebugMacro("Area: " << renderedLabelArea << "  /  " << allowableLabelArea);
-        }
-      }
 
-    iteratedLabelArea += static_cast<unsigned long>( sz[0] * sz[1] );
-
-    double orient = tpropCopy->GetOrientation();
-
-    // Translate to origin to simplify bucketing
-    double xTrans[4];
-    xTrans[0] = ll[0] - kdbounds[0];
-    xTrans[1] = ur[0] - kdbounds[0];
-    xTrans[2] = ll[1] - kdbounds[2];
-    xTrans[3] = ur[1] - kdbounds[2];
-
-    double originTrans[2];
-    originTrans[0] = origin[0] - kdbounds[0];
-    originTrans[1] = origin[1] - kdbounds[2];
-
-    double orientRad = vtkMath::RadiansFromDegrees(orient);
-    LabelRect r( xTrans, originTrans, orientRad );
-
-    if ( this->PlaceAllLabels || this->Buckets->PlaceLabel( r ) )
-      {
       r.Render(ren, this->Shape, this->Style, this->Margin, this->BackgroundColor, this->BackgroundOpacity);
       renderedLabelArea += static_cast<unsigned long>( sz[0] * sz[1] );
-      if ( labelType == 0 )
+      if ( c.Type == 0 )
         {
         // label is text
+        int origin[2] = { c.Origin[0], c.Origin[1] };
+        tpropCopy->ShallowCopy( c.Hierarchy->GetTextProperty() );
+        tpropCopy->SetOrientation( c.Orientation );
         if( this->UseUnicodeStrings )
           {
-          this->RenderStrategy->RenderLabel( origin, tpropCopy, inIter->GetUnicodeLabel() );
+          this->RenderStrategy->RenderLabel( origin, tpropCopy, c.UnicodeLabel );
           }
         else
           {
-          this->RenderStrategy->RenderLabel( origin, tpropCopy, inIter->GetLabel() );
+          this->RenderStrategy->RenderLabel( origin, tpropCopy, c.Label );
           }
 
         // TODO: 1. Perturb coincident points.
@@ -852,14 +1207,39 @@ void vtkLabelPlacementMapper::RenderOverlay(vtkViewport *viewport,
         // TODO: Do something ...
         }
 
-      vtkDebugMacro("Placed: " << inIter->GetLabelId() << " (" << ll[0] << ", " << ll[1] << "  " << ur[0] << "," << ur[1] << ") " << labelType);
+      vtkDebugMacro("Placed: " << c.LabelId << " (" << ll[0] << ", " << ll[1] << "  " << ur[0] << "," << ur[1] << ") " << c.Type);
       placed++;
+      if ( ! reuse )
+        {
+        this->Buckets->Placements.push_back( c );
+        }
+      }
+    }
+
+  this->NumberOfPlacedLabels = placed;
+  this->PlacementsReused = reuse;
+  if ( ! reuse )
+    {
+    this->LastRendererSize[0] = renSize[0];
+    this->LastRendererSize[1] = renSize[1];
+    cam->GetPosition( this->LastCameraPosition );
+    cam->GetFocalPoint( this->LastCameraFocalPoint );
+    cam->GetViewUp( this->LastCameraViewUp );
+    this->LastCameraParallelScale = cam->GetParallelScale();
+    this->LastCameraViewAngle = cam->GetViewAngle();
+    this->LastCameraParallelProjection = cam->GetParallelProjection();
+    for ( int i = 0; i < 4; ++ i )
+      {
+      this->Buckets->PlacementFrame[i] = kdbounds[i];
       }
+    this->Buckets->PlacementCoordinateSystem =
+      this->AnchorTransform->GetCoordinateSystem();
     }
 
   // Done rendering labels
   this->RenderStrategy->EndFrame();
   this->RenderStrategy->SetRenderer(0);
+  this->Buckets->PlacementTime = GetPlacementTime( this );
 
   if ( this->OutputTraversedBounds )
     {
@@ -910,4 +1290,9 @@ void vtkLabelPlacementMapper::PrintSelf( ostream& os, vtkIndent indent )
   os << indent << "Margin: " << this->Margin << "\n";
   os << indent << "BackgroundColor: " << this->BackgroundColor[0] << ", " << this->BackgroundColor[1] << ", " << this->BackgroundColor[2] << endl;
   os << indent << "BackgroundOpacity: " << this->BackgroundOpacity << "\n";
+  os << indent << "PlacementReuseTolerance: "
+    << this->PlacementReuseTolerance << "\n";
+  os << indent << "NumberOfPlacedLabels: " << this->NumberOfPlacedLabels << "\n";
+  os << indent << "PlacementsReused: "
+    << (this->PlacementsReused ? "ON" : "OFF" ) << "\n";
 }
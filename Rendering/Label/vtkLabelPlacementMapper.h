@@ -28,6 +28,14 @@
 // frame will decide which labels and/or icons to place in order of priority,
 // and will render only those labels/icons. A label render strategy is used to
 // render the labels, and can use e.g. FreeType or Qt for rendering.
+//
+// The labels are taken from the hierarchies in bands of decreasing
+// priority. The labels of a band are tested in parallel against those
+// placed in the bands before, and then placed one after the other in order
+// of priority, so that the labels placed do not depend on the number of
+// threads. When the view has not changed since the last frame, or has
+// changed less than PlacementReuseTolerance, the labels placed in the last
+// frame are reused rather than placed again.
 
 #ifndef vtkLabelPlacementMapper_h
 #define vtkLabelPlacementMapper_h
@@ -163,6 +171,24 @@ public:
   vtkSetClampMacro(BackgroundOpacity, double, 0.0, 1.0);
   vtkGetMacro(BackgroundOpacity, double);
 
+  // Description:
+  // The largest distance, in pixels, by which the anchor points of the
+  // labels may move before the labels are placed again. While the camera
+  // moves less than this, the labels placed last are kept at their new
+  // positions, less those that come to overlap, which saves placing the
+  // labels during small interactive motions but shows no new labels until
+  // the camera moves further. The default is 0: the labels are placed again
+  // whenever the view changes. The labels are always placed again when the
+  // depth buffer is used or when some labels have bounded sizes.
+  vtkSetClampMacro(PlacementReuseTolerance, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(PlacementReuseTolerance, double);
+
+  // Description:
+  // The number of labels placed in the last frame, and whether they were
+  // the labels placed in a frame before, reused rather than placed again.
+  vtkGetMacro(NumberOfPlacedLabels, int);
+  vtkGetMacro(PlacementsReused, bool);
+
   // Description:
   // Get the transform for the anchor points.
   vtkGetObjectMacro(AnchorTransform,vtkCoordinate);
@@ -196,7 +222,12 @@ protected:
   double LastCameraFocalPoint[3];
   double LastCameraViewUp[3];
   double LastCameraParallelScale;
+  double LastCameraViewAngle;
+  int LastCameraParallelProjection;
   int IteratorType;
+  double PlacementReuseTolerance;
+  int NumberOfPlacedLabels;
+  bool PlacementsReused;
 
   int Style;
   int Shape;
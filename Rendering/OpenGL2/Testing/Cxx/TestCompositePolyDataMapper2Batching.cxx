@@ -0,0 +1,137 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkCompositePolyDataMapper2 draws the blocks that share the
+// same color and opacity with one call, that changing the block attributes
+// does not rebuild the buffer objects, and that modifying one block only
+// packs that block again.
+
+#include "vtkActor.h"
+#include "vtkCellArray.h"
+#include "vtkCompositeDataDisplayAttributes.h"
+#include "vtkCompositePolyDataMapper2.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkRenderer.h"
+#include "vtkRenderWindow.h"
+#include "vtkSmartPointer.h"
+
+// a small grid of quads
+static vtkSmartPointer<vtkPolyData> MakeBlock(int block, int size)
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  for (int j = 0; j < size; ++j)
+    {
+    for (int i = 0; i < size; ++i)
+      {
+      points->InsertNextPoint(i + (block % 16)*size, j + (block / 16)*size,
+                              0.0);
+      }
+    }
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  for (int j = 0; j < size - 1; ++j)
+    {
+    for (int i = 0; i < size - 1; ++i)
+      {
+      vtkIdType quad[4] = { j*size + i, j*size + i + 1,
+                            (j + 1)*size + i + 1, (j + 1)*size + i };
+      polys->InsertNextCell(4, quad);
+      }
+    }
+  vtkSmartPointer<vtkPolyData> poly = vtkSmartPointer<vtkPolyData>::New();
+  poly->SetPoints(points);
+  poly->SetPolys(polys);
+  return poly;
+}
+
+static int CheckRender(vtkRenderWindow *renderWindow,
+                       vtkCompositePolyDataMapper2 *mapper, int drawCalls,
+                       int blockBuilds, const char *change)
+{
+  int builds = mapper->GetBlockBufferBuildCount();
+  renderWindow->Render();
+  builds = mapper->GetBlockBufferBuildCount() - builds;
+  if (mapper->GetDrawCallCount() != drawCalls || builds != blockBuilds)
+    {
+    cerr << "After changing " << change << " there were "
+         << mapper->GetDrawCallCount() << " draw calls and " << builds
+         << " blocks were packed, instead of " << drawCalls << " and "
+         << blockBuilds << endl;
+    return 1;
+    }
+  return 0;
+}
+
+int TestCompositePolyDataMapper2Batching(int, char *[])
+{
+  const int numBlocks = 64;
+  vtkNew<vtkMultiBlockDataSet> data;
+  data->SetNumberOfBlocks(numBlocks);
+  for (int b = 0; b < numBlocks; ++b)
+    {
+    data->SetBlock(b, MakeBlock(b, 5));
+    }
+
+  vtkNew<vtkCompositePolyDataMapper2> mapper;
+  vtkNew<vtkCompositeDataDisplayAttributes> attributes;
+  mapper->SetCompositeDataDisplayAttributes(attributes.GetPointer());
+  mapper->SetInputDataObject(data.GetPointer());
+  vtkNew<vtkActor> actor;
+  actor->SetMapper(mapper.GetPointer());
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddActor(actor.GetPointer());
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(200, 200);
+  renderWindow->AddRenderer(renderer.GetPointer());
+
+  vtkRenderWindow *win = renderWindow.GetPointer();
+  vtkCompositePolyDataMapper2 *m = mapper.GetPointer();
+  int rval = 0;
+  rval |= CheckRender(win, m, 1, numBlocks, "nothing yet");
+
+  // two colors, interleaved, are two draws whatever the number of blocks,
+  // the flat index of block b is b + 1
+  for (int b = 0; b < numBlocks; b += 2)
+    {
+    mapper->SetBlockColor(b + 1, 1.0, 0.5, 0.0);
+    }
+  rval |= CheckRender(win, m, 2, 0, "the block colors");
+  mapper->SetBlockOpacity(2, 0.5);
+  rval |= CheckRender(win, m, 3, 0, "the block opacity");
+  mapper->SetBlockVisibility(2, false);
+  mapper->SetBlockVisibility(3, false);
+  rval |= CheckRender(win, m, 2, 0, "the block visibility");
+  mapper->RemoveBlockColors();
+  mapper->RemoveBlockVisibilites();
+  mapper->RemoveBlockOpacities();
+  rval |= CheckRender(win, m, 1, 0, "nothing at all");
+
+  // moving the points of a block packs that block only
+  vtkPolyData *block = vtkPolyData::SafeDownCast(data->GetBlock(10));
+  block->GetPoints()->SetPoint(3, 1.0, 2.0, 3.0);
+  block->GetPoints()->Modified();
+  rval |= CheckRender(win, m, 1, 1, "the points of a block");
+
+  // a block that no longer fits in its place is packed once on its own,
+  // then with all the others
+  data->GetBlock(20)->ShallowCopy(MakeBlock(20, 7));
+  rval |= CheckRender(win, m, 1, numBlocks + 1, "the size of a block");
+
+  // anything but the blocks packs all of them again
+  mapper->SetScalarVisibility(0);
+  rval |= CheckRender(win, m, 1, numBlocks, "the mapper");
+
+  return rval;
+}
@@ -0,0 +1,381 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks the buffers packed in parallel by the vtkgl helpers against
+// buffers packed one cell and one point at a time, with enough cells for
+// many chunks, then renders a surface with point and with cell data and
+// reports the time taken by each stage of building the buffer objects.
+
+#include "vtkActor.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkOpenGLPolyDataMapper.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkProperty.h"
+#include "vtkRenderer.h"
+#include "vtkRenderWindow.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkglVBOHelper.h"
+
+#include <math.h>
+#include <vector>
+
+static const int gridSize[2] = { 150, 120 };
+
+// A surface with a mixture of cells of three to six points, with polygons
+// of eight points if largePolygons is set, and with verts and lines.
+static void MakePolyData(vtkPolyData *poly, bool largePolygons)
+{
+  int nx = gridSize[0];
+  int ny = gridSize[1];
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  for (int j = 0; j < ny; ++j)
+    {
+    for (int i = 0; i < nx; ++i)
+      {
+      points->InsertNextPoint(i, j, 0.1*sin(0.1*i)*cos(0.2*j));
+      }
+    }
+
+  vtkNew<vtkCellArray> polys;
+  for (int j = 0; j < ny - 1; ++j)
+    {
+    for (int i = 0; i < nx - 1; ++i)
+      {
+      vtkIdType p[4] = { j*nx + i, j*nx + i + 1, (j + 1)*nx + i + 1,
+                         (j + 1)*nx + i };
+      int type = (i*7 + j*3) % 6;
+      if (type == 0)
+        {
+        vtkIdType t0[3] = { p[0], p[1], p[2] };
+        vtkIdType t1[3] = { p[0], p[2], p[3] };
+        polys->InsertNextCell(3, t0);
+        polys->InsertNextCell(3, t1);
+        }
+      else if (type == 1 && i < nx - 2)
+        {
+        // a pentagon and a hexagon that share their corners
+        vtkIdType pent[5] = { p[0], p[1], p[1] + 1, p[2], p[3] };
+        vtkIdType hex[6] = { p[0], p[1], p[1] + 1, p[2] + 1, p[2], p[3] };
+        polys->InsertNextCell(5, pent);
+        polys->InsertNextCell(6, hex);
+        }
+      else if (type == 2 && largePolygons)
+        {
+        // an octagon on new points around the middle of the cell
+        vtkIdType oct[8];
+        for (int k = 0; k < 8; ++k)
+          {
+          double a = 2.0*vtkMath::Pi()*k/8;
+          oct[k] = points->InsertNextPoint(i + 0.5 + 0.4*cos(a),
+                                           j + 0.5 + 0.4*sin(a), 0.0);
+          }
+        polys->InsertNextCell(8, oct);
+        }
+      else if (type == 3)
+        {
+        // degenerate cells are ignored for triangles
+        polys->InsertNextCell(2, p);
+        }
+      else
+        {
+        polys->InsertNextCell(4, p);
+        }
+      }
+    }
+
+  vtkNew<vtkCellArray> verts;
+  vtkNew<vtkCellArray> lines;
+  for (vtkIdType i = 0; i < nx*ny; i += 1 + i % 3)
+    {
+    vtkIdType ids[5] = { i, (i + 7) % (nx*ny), (i + 11) % (nx*ny),
+                         (i + 13) % (nx*ny), (i + 17) % (nx*ny) };
+    verts->InsertNextCell(1 + i % 3, ids);
+    lines->InsertNextCell(2 + i % 4, ids);
+    }
+
+  poly->SetPoints(points.GetPointer());
+  poly->SetPolys(polys.GetPointer());
+  poly->SetVerts(verts.GetPointer());
+  poly->SetLines(lines.GetPointer());
+}
+
+// Compare an index array with the expected indices after start.
+static int CompareIndices(const std::vector<unsigned int> &result,
+                          const std::vector<unsigned int> &expected,
+                          size_t start, const char *name)
+{
+  if (result.size() != start + expected.size())
+    {
+    cerr << name << ": " << result.size() - start << " indices instead of "
+         << expected.size() << endl;
+    return 1;
+    }
+  for (size_t i = 0; i < expected.size(); ++i)
+    {
+    if (result[start + i] != expected[i])
+      {
+      cerr << name << ": index " << i << " is " << result[start + i]
+           << " instead of " << expected[i] << endl;
+      return 1;
+      }
+    }
+  return 0;
+}
+
+static int TestIndexBuffers()
+{
+  vtkNew<vtkPolyData> poly;
+  MakePolyData(poly.GetPointer(), false);
+  vtkCellArray *polys = poly->GetPolys();
+  const vtkIdType vOffset = 17;
+
+  // compute the indices one cell at a time
+  std::vector<unsigned int> points;
+  std::vector<unsigned int> lines;
+  std::vector<unsigned int> tris;
+  vtkIdType npts;
+  vtkIdType *pts;
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts); )
+    {
+    for (vtkIdType i = 0; i < npts; ++i)
+      {
+      points.push_back(pts[i] + vOffset);
+      lines.push_back(pts[i] + vOffset);
+      lines.push_back(pts[(i + 1) % npts] + vOffset);
+      }
+    static const int hexagon[12] = { 0, 1, 2, 0, 2, 3, 0, 3, 5, 3, 4, 5 };
+    for (vtkIdType i = 2; i < npts; ++i)
+      {
+      if (npts == 6)
+        {
+        for (int k = 0; k < 3; ++k)
+          {
+          tris.push_back(pts[hexagon[3*(i - 2) + k]] + vOffset);
+          }
+        }
+      else
+        {
+        tris.push_back(pts[0] + vOffset);
+        tris.push_back(pts[i - 1] + vOffset);
+        tris.push_back(pts[i] + vOffset);
+        }
+      }
+    }
+
+  // append to arrays that already have some indices
+  std::vector<unsigned int> result(5, 3);
+  int rval = 0;
+  vtkgl::AppendPointIndexBuffer(result, polys, vOffset);
+  rval |= CompareIndices(result, points, 5, "Points");
+  result.resize(5);
+  vtkgl::AppendTriangleLineIndexBuffer(result, polys, vOffset);
+  rval |= CompareIndices(result, lines, 5, "Lines");
+  result.resize(5);
+  std::vector<unsigned int> pointPointMap;
+  vtkgl::AppendTriangleIndexBuffer(result, polys, poly->GetPoints(),
+                                   pointPointMap, vOffset);
+  rval |= CompareIndices(result, tris, 5, "Triangles");
+
+  // polygons with more than six points are triangulated serially
+  vtkNew<vtkPolyData> large;
+  MakePolyData(large.GetPointer(), true);
+  result.clear();
+  vtkgl::AppendTriangleIndexBuffer(result, large->GetPolys(),
+                                   large->GetPoints(), pointPointMap, 0);
+  size_t expectedSize = 0;
+  polys = large->GetPolys();
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts); )
+    {
+    expectedSize += (npts < 3 ? 0 : 3*(npts - 2));
+    }
+  if (result.size() != expectedSize)
+    {
+    cerr << "Large polygons: " << result.size() << " indices instead of "
+         << expectedSize << endl;
+    rval = 1;
+    }
+
+  return rval;
+}
+
+static int TestVBO(int colorComponents)
+{
+  vtkNew<vtkPolyData> poly;
+  MakePolyData(poly.GetPointer(), false);
+  vtkPoints *points = poly->GetPoints();
+  vtkIdType numPts = points->GetNumberOfPoints();
+  vtkIdType numCells = poly->GetPolys()->GetNumberOfCells();
+
+  // normals and colors for the cells, which are used for the points that
+  // have no cell, and double texture coordinates
+  vtkIdType numTuples = numPts + numCells;
+  vtkNew<vtkFloatArray> normals;
+  normals->SetNumberOfComponents(3);
+  normals->SetNumberOfTuples(numTuples);
+  vtkNew<vtkDoubleArray> tcoords;
+  tcoords->SetNumberOfComponents(2);
+  tcoords->SetNumberOfTuples(numPts);
+  vtkNew<vtkUnsignedCharArray> colors;
+  colors->SetNumberOfComponents(colorComponents);
+  colors->SetNumberOfTuples(numTuples);
+  for (vtkIdType i = 0; i < numTuples; ++i)
+    {
+    normals->SetTuple3(i, 0.1*(i % 10), 0.2*(i % 5), 1.0);
+    for (int c = 0; c < colorComponents; ++c)
+      {
+      colors->SetComponent(i, c, (i*31 + c*57) % 256);
+      }
+    }
+  for (vtkIdType i = 0; i < numPts; ++i)
+    {
+    tcoords->SetTuple2(i, 0.5*i, 0.25*i);
+    }
+
+  // duplicate some of the points, and give some of them a cell
+  std::vector<unsigned int> pointPointMap(numPts + numPts/3);
+  std::vector<unsigned int> pointCellMap(pointPointMap.size());
+  for (size_t i = 0; i < pointPointMap.size(); ++i)
+    {
+    pointPointMap[i] = static_cast<unsigned int>((i*7) % numPts);
+    pointCellMap[i] = (i % 3 == 0 ? 0 :
+                       static_cast<unsigned int>(i % numCells) + 1);
+    }
+
+  // append after a first set of points
+  vtkgl::VBOLayout layout;
+  layout.VertexCount = 0;
+  vtkgl::AppendVBO(layout, points, 10, normals.GetPointer(),
+                   tcoords.GetPointer(), colors->GetPointer(0),
+                   colorComponents, NULL, NULL, false, false);
+  vtkgl::AppendVBO(layout, points,
+                   static_cast<unsigned int>(pointPointMap.size()),
+                   normals.GetPointer(), tcoords.GetPointer(),
+                   colors->GetPointer(0), colorComponents,
+                   &pointPointMap[0], &pointCellMap[0], true, true);
+
+  if (layout.VertexCount != 10 + pointPointMap.size() ||
+      layout.Stride != static_cast<int>(9*sizeof(float)) ||
+      layout.PackedVBO.size() != 9*layout.VertexCount)
+    {
+    cerr << "The layout has " << layout.VertexCount << " vertices of "
+         << layout.Stride << " bytes" << endl;
+    return 1;
+    }
+
+  for (size_t i = 0; i < pointPointMap.size(); ++i)
+    {
+    const float *block = &layout.PackedVBO[9*(10 + i)];
+    vtkIdType ptId = pointPointMap[i];
+    vtkIdType cellId = (pointCellMap[i] > 0 ? pointCellMap[i] - 1 : ptId);
+    double x[3];
+    points->GetPoint(ptId, x);
+    double *n = normals->GetTuple3(cellId);
+    double *t = tcoords->GetTuple2(ptId);
+    float expected[8] = {
+      static_cast<float>(x[0]), static_cast<float>(x[1]),
+      static_cast<float>(x[2]), static_cast<float>(n[0]),
+      static_cast<float>(n[1]), static_cast<float>(n[2]),
+      static_cast<float>(t[0]), static_cast<float>(t[1]) };
+    unsigned char rgba[4];
+    for (int c = 0; c < 4; ++c)
+      {
+      rgba[c] = (c < colorComponents ?
+                 colors->GetValue(cellId*colorComponents + c) : 255);
+      }
+    const unsigned char *color =
+      reinterpret_cast<const unsigned char *>(block + 8);
+    bool match = true;
+    for (int k = 0; k < 8; ++k)
+      {
+      match &= (block[k] == expected[k]);
+      }
+    for (int c = 0; c < 4; ++c)
+      {
+      match &= (color[c] == rgba[c]);
+      }
+    if (!match)
+      {
+      cerr << colorComponents << " color components: vertex " << i
+           << " is not packed correctly" << endl;
+      return 1;
+      }
+    }
+
+  return 0;
+}
+
+int TestVBOBuildBufferObjects(int, char *[])
+{
+  int rval = TestIndexBuffers();
+  rval |= TestVBO(3);
+  rval |= TestVBO(4);
+
+  vtkNew<vtkPolyData> poly;
+  MakePolyData(poly.GetPointer(), true);
+  vtkNew<vtkUnsignedCharArray> cellColors;
+  cellColors->SetNumberOfComponents(3);
+  cellColors->SetNumberOfTuples(poly->GetNumberOfCells());
+  for (vtkIdType i = 0; i < poly->GetNumberOfCells(); ++i)
+    {
+    cellColors->SetTuple3(i, i % 256, (i*3) % 256, 128);
+    }
+  poly->GetCellData()->SetScalars(cellColors.GetPointer());
+
+  vtkNew<vtkOpenGLPolyDataMapper> mapper;
+  mapper->SetInputData(poly.GetPointer());
+  vtkNew<vtkActor> actor;
+  actor->SetMapper(mapper.GetPointer());
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddActor(actor.GetPointer());
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(300, 300);
+  renderWindow->AddRenderer(renderer.GetPointer());
+
+  // the cell colors need the cell support arrays, point colors do not
+  const char *names[2] = { "CellScalars", "PointScalars" };
+  for (int pass = 0; pass < 2; ++pass)
+    {
+    if (pass == 1)
+      {
+      mapper->SetScalarModeToUsePointData();
+      actor->GetProperty()->SetRepresentationToWireframe();
+      }
+    renderWindow->Render();
+    if (mapper->GetCellSupportArraysTime() < 0 ||
+        mapper->GetVertexBufferTime() < 0 ||
+        mapper->GetIndexBufferTime() < 0)
+      {
+      cerr << "The buffer objects were not timed" << endl;
+      rval = 1;
+      }
+    cout << "<DartMeasurement name=\"" << names[pass] << "CellSupportArrays"
+         << "\" type=\"numeric/double\">" << mapper->GetCellSupportArraysTime()
+         << "</DartMeasurement>\n"
+         << "<DartMeasurement name=\"" << names[pass] << "VertexBuffer"
+         << "\" type=\"numeric/double\">" << mapper->GetVertexBufferTime()
+         << "</DartMeasurement>\n"
+         << "<DartMeasurement name=\"" << names[pass] << "IndexBuffer"
+         << "\" type=\"numeric/double\">" << mapper->GetIndexBufferTime()
+         << "</DartMeasurement>" << endl;
+    }
+
+  return rval;
+}
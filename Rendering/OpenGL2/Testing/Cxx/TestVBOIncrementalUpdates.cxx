@@ -0,0 +1,153 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkOpenGLPolyDataMapper keeps its index buffers and only
+// uploads the changed attribute of its vertex buffer when only the points
+// or the scalars of its input change, keeps all of its buffers when only
+// the color of the property changes, and rebuilds the index buffers when
+// the cells, the polydata or the representation change.
+
+#include "vtkActor.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkFloatArray.h"
+#include "vtkNew.h"
+#include "vtkOpenGLPolyDataMapper.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkProperty.h"
+#include "vtkRenderer.h"
+#include "vtkRenderWindow.h"
+
+static int CheckBuilds(vtkRenderWindow *renderWindow,
+                       vtkOpenGLPolyDataMapper *mapper, int vertexBuilds,
+                       int streamUpdates, int indexBuilds,
+                       const char *change)
+{
+  int vbo = mapper->GetVertexBufferBuildCount();
+  int streams = mapper->GetVertexStreamUpdateCount();
+  int ibo = mapper->GetIndexBufferBuildCount();
+  renderWindow->Render();
+  vbo = mapper->GetVertexBufferBuildCount() - vbo;
+  streams = mapper->GetVertexStreamUpdateCount() - streams;
+  ibo = mapper->GetIndexBufferBuildCount() - ibo;
+  if (vbo != vertexBuilds || streams != streamUpdates || ibo != indexBuilds)
+    {
+    cerr << "After changing " << change << " the VBO was built " << vbo
+         << " times, " << streams << " of its attributes were uploaded"
+         << " and the IBOs were built " << ibo << " times, instead of "
+         << vertexBuilds << ", " << streamUpdates << " and " << indexBuilds
+         << endl;
+    return 1;
+    }
+  return 0;
+}
+
+int TestVBOIncrementalUpdates(int, char *[])
+{
+  const int nx = 40;
+  const int ny = 30;
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkFloatArray> pointScalars;
+  for (int j = 0; j < ny; ++j)
+    {
+    for (int i = 0; i < nx; ++i)
+      {
+      points->InsertNextPoint(i, j, 0.0);
+      pointScalars->InsertNextValue(i + j);
+      }
+    }
+  vtkNew<vtkCellArray> polys;
+  vtkNew<vtkFloatArray> cellScalars;
+  for (int j = 0; j < ny - 1; ++j)
+    {
+    for (int i = 0; i < nx - 1; ++i)
+      {
+      vtkIdType quad[4] = { j*nx + i, j*nx + i + 1, (j + 1)*nx + i + 1,
+                            (j + 1)*nx + i };
+      polys->InsertNextCell(4, quad);
+      cellScalars->InsertNextValue(i*j);
+      }
+    }
+  vtkNew<vtkPolyData> poly;
+  poly->SetPoints(points.GetPointer());
+  poly->SetPolys(polys.GetPointer());
+  poly->GetPointData()->SetScalars(pointScalars.GetPointer());
+  poly->GetCellData()->SetScalars(cellScalars.GetPointer());
+
+  vtkNew<vtkOpenGLPolyDataMapper> mapper;
+  mapper->SetInputData(poly.GetPointer());
+  mapper->SetScalarRange(0, 100);
+  vtkNew<vtkActor> actor;
+  actor->SetMapper(mapper.GetPointer());
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddActor(actor.GetPointer());
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(200, 200);
+  renderWindow->AddRenderer(renderer.GetPointer());
+
+  vtkRenderWindow *win = renderWindow.GetPointer();
+  vtkOpenGLPolyDataMapper *m = mapper.GetPointer();
+  int rval = 0;
+  for (int useCellScalars = 0; useCellScalars < 2; ++useCellScalars)
+    {
+    if (useCellScalars)
+      {
+      mapper->SetScalarModeToUseCellData();
+      rval |= CheckBuilds(win, m, 1, 0, 1, "the scalar mode");
+      }
+    else
+      {
+      rval |= CheckBuilds(win, m, 1, 0, 1, "nothing yet");
+      }
+
+    // deform the mesh
+    points->SetPoint(5, 5.0, 0.0, 1.0);
+    points->Modified();
+    rval |= CheckBuilds(win, m, 0, 1, 0, "the points");
+
+    // recolor the mesh
+    vtkFloatArray *scalars = (useCellScalars ? cellScalars.GetPointer() :
+                              pointScalars.GetPointer());
+    scalars->SetValue(7, 50.0f);
+    scalars->Modified();
+    rval |= CheckBuilds(win, m, 0, 1, 0, "the scalars");
+    mapper->SetScalarRange(0, 200);
+    rval |= CheckBuilds(win, m, 0, 1, 0, "the scalar range");
+
+    // the colors are mapped again for any change of the input
+    poly->GetPointData()->Modified();
+    rval |= CheckBuilds(win, m, 0, 1, 0, "the point data");
+
+    // this does not change the buffers at all
+    actor->GetProperty()->SetDiffuseColor(0.5, 0.2, 1.0);
+    rval |= CheckBuilds(win, m, 0, 0, 0, "the color of the property");
+
+    // cells edited in place are only marked by the polydata, which
+    // rebuilds all the buffers
+    vtkIdType *cell = polys->GetPointer() + 1;
+    cell[0] = cell[1];
+    poly->Modified();
+    rval |= CheckBuilds(win, m, 1, 0, 1, "the cells");
+
+    // this changes the index buffers, and the duplicated points for cell
+    // scalars
+    actor->GetProperty()->SetRepresentationToWireframe();
+    rval |= CheckBuilds(win, m, useCellScalars, 0, 1, "the representation");
+    actor->GetProperty()->SetRepresentationToSurface();
+    rval |= CheckBuilds(win, m, useCellScalars, 0, 1, "the representation");
+    }
+
+  return rval;
+}
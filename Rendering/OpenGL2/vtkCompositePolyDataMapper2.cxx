@@ -14,6 +14,8 @@
 =========================================================================*/
 #include "vtkCompositePolyDataMapper2.h"
 
+#include "vtkBoundingVolumeHierarchy.h"
+#include "vtkCamera.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCommand.h"
@@ -21,7 +23,10 @@
 #include "vtkDataObjectTreeIterator.h"
 #include "vtkFloatArray.h"
 #include "vtkHardwareSelector.h"
+#include "vtkIdList.h"
 #include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkMatrix4x4.h"
 #include "vtkMultiBlockDataSet.h"
 #include "vtkMultiPieceDataSet.h"
 #include "vtkObjectFactory.h"
@@ -34,23 +39,41 @@
      #include "vtkLookupTable.h"
 #include "vtkShaderProgram.h"
 
+#include <algorithm>
+#include <map>
+
 vtkStandardNewMacro(vtkCompositePolyDataMapper2);
 
 //----------------------------------------------------------------------------
 vtkCompositePolyDataMapper2::vtkCompositePolyDataMapper2()
 {
   this->UseGeneric = true;
+  this->BlockBufferBuildCount = 0;
+  this->DrawCallCount = 0;
+  this->BlockHierarchy = vtkBoundingVolumeHierarchy::New();
+  this->BlockCulling = 1;
+  this->MinimumBlockCoverage = 0.0;
+  this->VisibleBlockCount = 0;
 }
 
 //----------------------------------------------------------------------------
 vtkCompositePolyDataMapper2::~vtkCompositePolyDataMapper2()
 {
+  this->BlockHierarchy->Delete();
 }
 
 //----------------------------------------------------------------------------
 void vtkCompositePolyDataMapper2::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "DrawCallCount: " << this->DrawCallCount << endl;
+  os << indent << "BlockBufferBuildCount: "
+     << this->BlockBufferBuildCount << endl;
+  os << indent << "BlockCulling: "
+     << (this->BlockCulling ? "On" : "Off") << endl;
+  os << indent << "MinimumBlockCoverage: "
+     << this->MinimumBlockCoverage << endl;
+  os << indent << "VisibleBlockCount: " << this->VisibleBlockCount << endl;
 }
 
 void vtkCompositePolyDataMapper2::FreeStructures()
@@ -61,6 +84,12 @@ void vtkCompositePolyDataMapper2::FreeStructures()
   this->EdgeIndexArray.resize(0);
   this->EdgeIndexOffsets.resize(0);
   this->RenderValues.resize(0);
+  this->BlockBuffers.resize(0);
+  this->DrawBatches.resize(0);
+  this->EdgeBatch.Offsets.resize(0);
+  this->EdgeBatch.Counts.resize(0);
+  this->BlockInFrustum.resize(0);
+  this->BlockHierarchy->SetNumberOfItems(0);
 }
 
 // ---------------------------------------------------------------------------
@@ -204,7 +233,6 @@ void vtkCompositePolyDataMapper2::BuildRenderValues(
   unsigned int &lastIndex,
   unsigned int &lastEdgeIndex)
 {
-  vtkHardwareSelector *selector = renderer->GetSelector();
   vtkCompositeDataDisplayAttributes* cda = this->GetCompositeDataDisplayAttributes();
   bool overrides_visibility = (cda && cda->HasBlockVisibility(flat_index));
   if (overrides_visibility)
@@ -254,46 +282,31 @@ void vtkCompositePolyDataMapper2::BuildRenderValues(
     }
   else
     {
-    double op = this->BlockState.Opacity.top();
-    bool vis = this->BlockState.Visibility.top();
-    vtkColor3d color = this->BlockState.AmbientColor.top();
-    if (this->RenderValues.size() == 0)
+    // one value per block, the blocks are grouped by BuildDrawBatches
+    vtkCompositePolyDataMapper2::RenderValue rv;
+    rv.StartVertex = lastVertex;
+    rv.StartIndex = lastIndex;
+    rv.StartEdgeIndex = lastEdgeIndex;
+    rv.Opacity = this->BlockState.Opacity.top();
+    rv.Visibility = this->BlockState.Visibility.top();
+    rv.Color = this->BlockState.AmbientColor.top();
+    rv.PickId = my_flat_index;
+    vtkPolyData *pd = vtkPolyData::SafeDownCast(dobj);
+    if (pd)
       {
-      vtkCompositePolyDataMapper2::RenderValue rv;
-      rv.StartVertex = 0;
-      rv.StartIndex = 0;
-      rv.StartEdgeIndex = 0;
-      rv.Opacity = op;
-      rv.Visibility = vis;
-      rv.Color = color;
-      rv.PickId = my_flat_index;
-      this->RenderValues.push_back(rv);
+      pd->GetBounds(rv.Bounds);
       }
-
-    // has something changed?
-    if (this->RenderValues.back().Opacity != op ||
-        this->RenderValues.back().Visibility != vis ||
-        this->RenderValues.back().Color != color ||
-        selector)
+    else
       {
-      // close old group
-      this->RenderValues.back().EndVertex = lastVertex - 1;
-      this->RenderValues.back().EndIndex = lastIndex - 1;
-      this->RenderValues.back().EndEdgeIndex = lastEdgeIndex - 1;
-      // open a new group
-      vtkCompositePolyDataMapper2::RenderValue rv;
-      rv.StartVertex = lastVertex;
-      rv.StartIndex = lastIndex;
-      rv.StartEdgeIndex = lastEdgeIndex;
-      rv.Opacity = op;
-      rv.Visibility = vis;
-      rv.Color = color;
-      rv.PickId = my_flat_index;
-      this->RenderValues.push_back(rv);
+      vtkMath::UninitializeBounds(rv.Bounds);
       }
     lastVertex = this->VertexOffsets[my_flat_index];
     lastIndex = this->IndexOffsets[my_flat_index];
     lastEdgeIndex = this->EdgeIndexOffsets[my_flat_index];
+    rv.EndVertex = lastVertex - 1;
+    rv.EndIndex = lastIndex - 1;
+    rv.EndEdgeIndex = lastEdgeIndex - 1;
+    this->RenderValues.push_back(rv);
     }
 
   if (overrides_color)
@@ -312,6 +325,180 @@ void vtkCompositePolyDataMapper2::BuildRenderValues(
     }
 }
 
+//-----------------------------------------------------------------------------
+namespace
+{
+// the key the blocks are grouped by when drawing
+struct DrawBatchKey
+{
+  double Values[4];
+  bool operator<(const DrawBatchKey &other) const
+    {
+    return std::lexicographical_compare(this->Values, this->Values + 4,
+                                        other.Values, other.Values + 4);
+    }
+};
+
+// add a range of indices to a batch, extending its last range when the
+// new one follows it
+template <class BatchT>
+void AddToDrawBatch(unsigned int startIndex, unsigned int endIndex,
+                    unsigned int startVertex, unsigned int endVertex,
+                    BatchT &batch)
+{
+  unsigned int count = endIndex - startIndex + 1;
+  GLintptr offset = static_cast<GLintptr>(startIndex*sizeof(GLuint));
+  if (count == 0)
+    {
+    return;
+    }
+  if (batch.Counts.empty())
+    {
+    batch.StartVertex = startVertex;
+    batch.EndVertex = endVertex;
+    }
+  else
+    {
+    batch.StartVertex = std::min(batch.StartVertex, startVertex);
+    batch.EndVertex = std::max(batch.EndVertex, endVertex);
+    if (batch.Offsets.back() + batch.Counts.back()*sizeof(GLuint) ==
+        static_cast<size_t>(offset))
+      {
+      batch.Counts.back() += count;
+      return;
+      }
+    }
+  batch.Offsets.push_back(offset);
+  batch.Counts.push_back(count);
+}
+
+// draw the ranges of a batch, with a single call
+template <class BatchT>
+void DrawBatchElements(GLenum mode, BatchT &batch)
+{
+  if (batch.Counts.size() == 1)
+    {
+    glDrawRangeElements(mode,
+      static_cast<GLuint>(batch.StartVertex),
+      static_cast<GLuint>(batch.EndVertex),
+      static_cast<GLsizei>(batch.Counts[0]),
+      GL_UNSIGNED_INT,
+      reinterpret_cast<const GLvoid *>(batch.Offsets[0]));
+    }
+  else
+    {
+    glMultiDrawElements(mode,
+      (GLsizei *)(&batch.Counts[0]),
+      GL_UNSIGNED_INT,
+      reinterpret_cast<const GLvoid **>(&(batch.Offsets[0])),
+      (GLsizei)batch.Offsets.size());
+    }
+}
+
+// override the opacity and color of the property
+void SetBlockUniforms(vtkShaderProgram *prog, double opacity,
+                      const vtkColor3d &color, double aIntensity,
+                      double dIntensity)
+{
+  prog->SetUniformf("opacityUniform", opacity);
+  float ambientColor[3] = {static_cast<float>(color[0] * aIntensity),
+    static_cast<float>(color[1] * aIntensity),
+    static_cast<float>(color[2] * aIntensity)};
+  float diffuseColor[3] = {static_cast<float>(color[0] * dIntensity),
+    static_cast<float>(color[1] * dIntensity),
+    static_cast<float>(color[2] * dIntensity)};
+  prog->SetUniform3f("ambientColorUniform", ambientColor);
+  prog->SetUniform3f("diffuseColorUniform", diffuseColor);
+}
+}
+
+//-----------------------------------------------------------------------------
+void vtkCompositePolyDataMapper2::BuildDrawBatches()
+{
+  this->DrawBatches.resize(0);
+  this->EdgeBatch.Offsets.resize(0);
+  this->EdgeBatch.Counts.resize(0);
+
+  this->VisibleBlockCount = 0;
+
+  std::map<DrawBatchKey, size_t> batchIds;
+  std::vector<
+    vtkCompositePolyDataMapper2::RenderValue>::iterator it;
+  for (it = this->RenderValues.begin(); it != this->RenderValues.end(); it++)
+    {
+    if (!it->Visibility ||
+        !this->BlockInFrustum[it - this->RenderValues.begin()])
+      {
+      continue;
+      }
+    this->VisibleBlockCount++;
+    DrawBatchKey key = {
+      { it->Opacity, it->Color[0], it->Color[1], it->Color[2] } };
+    std::map<DrawBatchKey, size_t>::iterator found = batchIds.find(key);
+    if (found == batchIds.end())
+      {
+      found = batchIds.insert(
+        std::make_pair(key, this->DrawBatches.size())).first;
+      this->DrawBatches.push_back(vtkCompositePolyDataMapper2::DrawBatch());
+      this->DrawBatches.back().Opacity = it->Opacity;
+      this->DrawBatches.back().Color = it->Color;
+      }
+    AddToDrawBatch(it->StartIndex, it->EndIndex,
+                   it->StartVertex, it->EndVertex,
+                   this->DrawBatches[found->second]);
+    AddToDrawBatch(it->StartEdgeIndex, it->EndEdgeIndex,
+                   it->StartVertex, it->EndVertex, this->EdgeBatch);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkCompositePolyDataMapper2::CullBlocks(vtkRenderer *ren, vtkActor *act)
+{
+  std::vector<unsigned char> inFrustum(this->RenderValues.size(),
+                                       this->BlockCulling ? 0 : 1);
+  if (this->BlockCulling && !inFrustum.empty())
+    {
+    double planes[24];
+    ren->GetActiveCamera()->GetFrustumPlanes(ren->GetTiledAspectRatio(),
+                                             planes);
+
+    // bring the planes to the coordinates of the blocks
+    vtkMatrix4x4 *matrix = act->GetMatrix();
+    if (!act->GetIsIdentity())
+      {
+      for (int i = 0; i < 6; i++)
+        {
+        double plane[4];
+        for (int j = 0; j < 4; j++)
+          {
+          plane[j] = planes[4*i]*matrix->GetElement(0, j) +
+            planes[4*i + 1]*matrix->GetElement(1, j) +
+            planes[4*i + 2]*matrix->GetElement(2, j) +
+            planes[4*i + 3]*matrix->GetElement(3, j);
+          }
+        double norm = vtkMath::Norm(plane);
+        for (int j = 0; j < 4; j++)
+          {
+          planes[4*i + j] = (norm > 0.0 ? plane[j]/norm : plane[j]);
+          }
+        }
+      }
+
+    vtkIdList *ids = vtkIdList::New();
+    this->BlockHierarchy->FindItemsInFrustum(planes,
+      this->MinimumBlockCoverage, ids);
+    for (vtkIdType i = 0; i < ids->GetNumberOfIds(); i++)
+      {
+      inFrustum[ids->GetId(i)] = 1;
+      }
+    ids->Delete();
+    }
+
+  bool changed = (inFrustum != this->BlockInFrustum);
+  this->BlockInFrustum.swap(inFrustum);
+  return changed;
+}
+
 //-----------------------------------------------------------------------------
 void vtkCompositePolyDataMapper2::RenderPieceDraw(
   vtkRenderer* ren, vtkActor *actor)
@@ -331,9 +518,11 @@ void vtkCompositePolyDataMapper2::RenderPieceDraw(
   bool picking = (ren->GetIsPicking() || selector != NULL);
 
   // rebuild the render values if needed
-  if (this->RenderValuesBuildTime < this->GetMTime() ||
-      this->RenderValuesBuildTime < this->VBOBuildTime ||
-      this->LastSelectionState || picking)
+  bool rebuild = (this->RenderValuesBuildTime < this->GetMTime() ||
+    this->RenderValuesBuildTime < actor->GetMTime() ||
+    this->RenderValuesBuildTime < this->VBOBuildTime ||
+    this->LastSelectionState || picking);
+  if (rebuild)
     {
     vtkCompositeDataSet *input = vtkCompositeDataSet::SafeDownCast(
       this->GetInputDataObject(0, 0));
@@ -344,14 +533,25 @@ void vtkCompositePolyDataMapper2::RenderPieceDraw(
     unsigned int flat_index = 0;
     this->BuildRenderValues(ren, actor, input,
       flat_index, lastVertex, lastIndex, lastEdgeIndex);
-    // close last group
-    this->RenderValues.back().EndVertex = lastVertex - 1;
-    this->RenderValues.back().EndIndex = lastIndex - 1;
-    this->RenderValues.back().EndEdgeIndex = lastEdgeIndex - 1;
+    this->BlockHierarchy->SetNumberOfItems(
+      static_cast<vtkIdType>(this->RenderValues.size()));
+    for (size_t i = 0; i < this->RenderValues.size(); i++)
+      {
+      this->BlockHierarchy->SetItemBounds(static_cast<vtkIdType>(i),
+        this->RenderValues[i].Bounds);
+      }
     this->RenderValuesBuildTime.Modified();
     }
 
+  // group the blocks again when the blocks in view have changed
+  bool culled = this->CullBlocks(ren, actor);
+  if (rebuild || culled)
+    {
+    this->BuildDrawBatches();
+    }
+
   // draw polygons
+  this->DrawCallCount = 0;
   if (this->Tris.indexCount)
     {
     // First we do the triangles, update the shader, set uniforms, etc.
@@ -365,39 +565,51 @@ void vtkCompositePolyDataMapper2::RenderPieceDraw(
     double dIntensity = this->DrawingEdges ? 0.0 : ppty->GetDiffuse();
     vtkShaderProgram *prog = this->Tris.Program;
 
-    std::vector<
-      vtkCompositePolyDataMapper2::RenderValue>::iterator it;
-    for (it = this->RenderValues.begin(); it != this->RenderValues.end(); it++)
+    // each block has its own id when picking, so draw them one by one
+    if (selector &&
+        selector->GetCurrentPass() ==
+          vtkHardwareSelector::COMPOSITE_INDEX_PASS)
       {
-      // reset the offset so each compsoite starts at 0
-      this->pickingAttributeIDOffset = 0;
-      if (it->Visibility)
+      std::vector<
+        vtkCompositePolyDataMapper2::RenderValue>::iterator it;
+      for (it = this->RenderValues.begin();
+           it != this->RenderValues.end(); it++)
         {
-        if (selector &&
-            selector->GetCurrentPass() ==
-              vtkHardwareSelector::COMPOSITE_INDEX_PASS)
+        // reset the offset so each compsoite starts at 0
+        this->pickingAttributeIDOffset = 0;
+        if (it->Visibility && it->EndIndex + 1 != it->StartIndex &&
+            this->BlockInFrustum[it - this->RenderValues.begin()])
           {
           selector->RenderCompositeIndex(it->PickId);
           prog->SetUniform3f("mapperIndex", selector->GetPropColorValue());
+          SetBlockUniforms(prog, it->Opacity, it->Color,
+                           aIntensity, dIntensity);
+          glDrawRangeElements(mode,
+            static_cast<GLuint>(it->StartVertex),
+            static_cast<GLuint>(it->EndVertex),
+            static_cast<GLsizei>(it->EndIndex - it->StartIndex + 1),
+            GL_UNSIGNED_INT,
+            reinterpret_cast<const GLvoid *>(it->StartIndex*sizeof(GLuint)));
+          this->DrawCallCount++;
+          }
+        }
+      }
+    else
+      {
+      std::vector<
+        vtkCompositePolyDataMapper2::DrawBatch>::iterator it;
+      for (it = this->DrawBatches.begin();
+           it != this->DrawBatches.end(); it++)
+        {
+        // reset the offset so each compsoite starts at 0
+        this->pickingAttributeIDOffset = 0;
+        if (!it->Counts.empty())
+          {
+          SetBlockUniforms(prog, it->Opacity, it->Color,
+                           aIntensity, dIntensity);
+          DrawBatchElements(mode, *it);
+          this->DrawCallCount++;
           }
-        // override the opacity and color
-        prog->SetUniformf("opacityUniform", it->Opacity);
-        vtkColor3d &aColor = it->Color;
-        float ambientColor[3] = {static_cast<float>(aColor[0] * aIntensity),
-          static_cast<float>(aColor[1] * aIntensity),
-          static_cast<float>(aColor[2] * aIntensity)};
-        vtkColor3d &dColor = it->Color;
-        float diffuseColor[3] = {static_cast<float>(dColor[0] * dIntensity),
-          static_cast<float>(dColor[1] * dIntensity),
-          static_cast<float>(dColor[2] * dIntensity)};
-        prog->SetUniform3f("ambientColorUniform", ambientColor);
-        prog->SetUniform3f("diffuseColorUniform", diffuseColor);
-        glDrawRangeElements(mode,
-          static_cast<GLuint>(it->StartVertex),
-          static_cast<GLuint>(it->EndVertex),
-          static_cast<GLsizei>(it->EndIndex - it->StartIndex + 1),
-          GL_UNSIGNED_INT,
-          reinterpret_cast<const GLvoid *>(it->StartIndex*sizeof(GLuint)));
         }
       }
 
@@ -421,26 +633,13 @@ void vtkCompositePolyDataMapper2::RenderEdges(
 
   this->DrawingEdges = true;
 
-  // draw polygons
-  if (this->TrisEdges.indexCount)
+  // draw the edges of all the visible blocks at once
+  if (this->TrisEdges.indexCount && !this->EdgeBatch.Counts.empty())
     {
     // First we do the triangles, update the shader, set uniforms, etc.
     this->UpdateShader(this->TrisEdges, ren, actor);
     this->TrisEdges.ibo.Bind();
-    std::vector<
-      vtkCompositePolyDataMapper2::RenderValue>::iterator it;
-    for (it = this->RenderValues.begin(); it != this->RenderValues.end(); it++)
-      {
-      if (it->Visibility)
-        {
-        glDrawRangeElements(GL_LINES,
-          static_cast<GLuint>(it->StartVertex),
-          static_cast<GLuint>(it->EndVertex),
-          static_cast<GLsizei>(it->EndEdgeIndex - it->StartEdgeIndex + 1),
-          GL_UNSIGNED_INT,
-          reinterpret_cast<const GLvoid *>(it->StartEdgeIndex*sizeof(GLuint)));
-        }
-      }
+    DrawBatchElements(GL_LINES, this->EdgeBatch);
     this->TrisEdges.ibo.Release();
     }
 
@@ -539,16 +738,192 @@ int vtkCompositePolyDataMapper2::CanUseTextureMapForColoring(vtkDataObject*)
   return this->CanUseTextureMapForColoringValue;
 }
 
+//-------------------------------------------------------------------------
+bool vtkCompositePolyDataMapper2::GetNeedToRebuildBufferObjects(
+  vtkRenderer *ren, vtkActor *act)
+{
+  // the block attributes are applied when drawing, so they are left out
+  // of the time of the mapper
+  vtkDataObject *input = this->GetInputDataObject(0, 0);
+  if (this->VBOBuildTime < this->vtkOpenGLPolyDataMapper::GetMTime() ||
+      this->VBOBuildTime < act->GetMTime() ||
+      this->VBOBuildTime < input->GetMTime())
+    {
+    return true;
+    }
+
+  // has any block been modified, or replaced
+  vtkSmartPointer<vtkDataObjectTreeIterator> iter =
+    vtkSmartPointer<vtkDataObjectTreeIterator>::New();
+  iter->SetDataSet(vtkCompositeDataSet::SafeDownCast(input));
+  iter->SkipEmptyNodesOn();
+  iter->VisitOnlyLeavesOn();
+  size_t blockId = 0;
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal();
+       iter->GoToNextItem(), blockId++)
+    {
+    vtkDataObject *dso = iter->GetCurrentDataObject();
+    if (blockId >= this->BlockBuffers.size() ||
+        this->BlockBuffers[blockId].Data != dso ||
+        this->VBOBuildTime < dso->GetMTime())
+      {
+      return true;
+      }
+    }
+  if (blockId != this->BlockBuffers.size())
+    {
+    return true;
+    }
+
+  vtkHardwareSelector* selector = ren->GetSelector();
+  bool picking = (ren->GetIsPicking() || selector != NULL);
+  if ((this->LastSelectionState || picking) && selector &&
+      selector->GetFieldAssociation() ==
+        vtkDataObject::FIELD_ASSOCIATION_POINTS)
+    {
+    return true;
+    }
+  return false;
+}
+
+//-------------------------------------------------------------------------
+int vtkCompositePolyDataMapper2::GetIndexBufferRepresentation(
+  vtkRenderer *ren, vtkActor *act)
+{
+  int representation = act->GetProperty()->GetRepresentation();
+
+  vtkHardwareSelector* selector = ren->GetSelector();
+  if (selector && this->PopulateSelectionSettings &&
+      selector->GetFieldAssociation() == vtkDataObject::FIELD_ASSOCIATION_POINTS &&
+      selector->GetCurrentPass() > vtkHardwareSelector::ACTOR_PASS)
+    {
+    representation = VTK_POINTS;
+    }
+  return representation;
+}
+
+//-------------------------------------------------------------------------
+bool vtkCompositePolyDataMapper2::UpdateChangedBlocks(
+  vtkRenderer *ren,
+  vtkActor *act)
+{
+  // anything but the blocks themselves changes all the buffers
+  vtkCompositeDataSet *input = vtkCompositeDataSet::SafeDownCast(
+    this->GetInputDataObject(0, 0));
+  if (this->BlockBuffers.empty() ||
+      this->VBOBuildTime < this->vtkOpenGLPolyDataMapper::GetMTime() ||
+      this->VBOBuildTime < act->GetMTime() ||
+      this->VBOBuildTime < input->GetMTime() ||
+      this->GetIndexBufferRepresentation(ren, act) !=
+        this->BufferRepresentation)
+    {
+    return false;
+    }
+
+  // find the blocks that have been modified
+  std::vector<size_t> changedBlocks;
+  vtkSmartPointer<vtkDataObjectTreeIterator> iter =
+    vtkSmartPointer<vtkDataObjectTreeIterator>::New();
+  iter->SetDataSet(input);
+  iter->SkipEmptyNodesOn();
+  iter->VisitOnlyLeavesOn();
+  size_t blockId = 0;
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal();
+       iter->GoToNextItem(), blockId++)
+    {
+    vtkDataObject *dso = iter->GetCurrentDataObject();
+    if (blockId >= this->BlockBuffers.size() ||
+        this->BlockBuffers[blockId].Data != dso ||
+        this->BlockBuffers[blockId].FlatIndex != iter->GetCurrentFlatIndex())
+      {
+      return false;
+      }
+    if (this->BlockBuffers[blockId].DataMTime != dso->GetMTime())
+      {
+      changedBlocks.push_back(blockId);
+      }
+    }
+  if (blockId != this->BlockBuffers.size())
+    {
+    return false;
+    }
+
+  // pack each block on its own, with the offset of its vertices, and
+  // upload it in place if it has kept its size and layout
+  vtkgl::VBOLayout layout = this->Layout;
+  this->CanUseTextureMapForColoringSet = false;
+  bool updated = true;
+  for (size_t i = 0; i < changedBlocks.size() && updated; i++)
+    {
+    vtkCompositePolyDataMapper2::BlockBuffer &block =
+      this->BlockBuffers[changedBlocks[i]];
+    this->Layout.VertexCount = 0;
+    this->Layout.PackedVBO.resize(0);
+    this->IndexArray.resize(0);
+    this->EdgeIndexArray.resize(0);
+    this->AppendOneBufferObject(ren, act, block.Data, block.StartVertex);
+    this->BlockBufferBuildCount++;
+
+    updated =
+      this->Layout.VertexCount == block.VertexCount &&
+      this->IndexArray.size() == block.IndexCount &&
+      this->EdgeIndexArray.size() == block.EdgeIndexCount &&
+      (block.VertexCount == 0 ||
+       (this->Layout.Stride == layout.Stride &&
+        this->Layout.NormalOffset == layout.NormalOffset &&
+        this->Layout.TCoordOffset == layout.TCoordOffset &&
+        this->Layout.TCoordComponents == layout.TCoordComponents &&
+        this->Layout.ColorOffset == layout.ColorOffset &&
+        this->Layout.ColorComponents == layout.ColorComponents));
+    if (updated && block.VertexCount)
+      {
+      size_t blockSize = layout.Stride/sizeof(float);
+      updated = this->VBO.UploadRange(&this->Layout.PackedVBO[0],
+        block.StartVertex*blockSize, this->Layout.PackedVBO.size(),
+        vtkgl::BufferObject::ArrayBuffer);
+      }
+    if (updated && block.IndexCount)
+      {
+      updated = this->Tris.ibo.UploadRange(&this->IndexArray[0],
+        block.StartIndex, block.IndexCount,
+        vtkgl::BufferObject::ElementArrayBuffer);
+      }
+    if (updated && block.EdgeIndexCount)
+      {
+      updated = this->TrisEdges.ibo.UploadRange(&this->EdgeIndexArray[0],
+        block.StartEdgeIndex, block.EdgeIndexCount,
+        vtkgl::BufferObject::ElementArrayBuffer);
+      }
+    block.DataMTime = block.Data->GetMTime();
+    }
+
+  this->Layout = layout;
+  this->IndexArray.resize(0);
+  this->EdgeIndexArray.resize(0);
+  return updated;
+}
+
 //-------------------------------------------------------------------------
 void vtkCompositePolyDataMapper2::BuildBufferObjects(
   vtkRenderer *ren,
   vtkActor *act)
 {
+  // when only some of the blocks have changed, only pack those again
+  if (this->UpdateChangedBlocks(ren, act))
+    {
+    return;
+    }
+
   vtkCompositeDataSet *input = vtkCompositeDataSet::SafeDownCast(
     this->GetInputDataObject(0, 0));
 
   // render using the composite data attributes
   this->Layout.VertexCount = 0;
+  this->Layout.PackedVBO.resize(0);
+  this->IndexArray.resize(0);
+  this->EdgeIndexArray.resize(0);
+  this->BlockBuffers.resize(0);
+  this->BufferRepresentation = this->GetIndexBufferRepresentation(ren, act);
 
   // compute the MaximumFlatIndex
   this->MaximumFlatIndex = 0;
@@ -572,7 +947,19 @@ void vtkCompositePolyDataMapper2::BuildBufferObjects(
     unsigned int fidx = iter->GetCurrentFlatIndex();
     vtkDataObject *dso = iter->GetCurrentDataObject();
     vtkPolyData *pd = vtkPolyData::SafeDownCast(dso);
+
+    // remember where the block is packed, for updating it later
+    vtkCompositePolyDataMapper2::BlockBuffer block;
+    block.Data = pd;
+    block.DataMTime = pd->GetMTime();
+    block.FlatIndex = fidx;
+    block.StartVertex = voffset;
+    block.StartIndex = static_cast<unsigned int>(this->IndexArray.size());
+    block.StartEdgeIndex =
+      static_cast<unsigned int>(this->EdgeIndexArray.size());
+
     this->AppendOneBufferObject(ren, act, pd, voffset);
+    this->BlockBufferBuildCount++;
     this->VertexOffsets[fidx] =
       static_cast<unsigned int>(this->Layout.VertexCount);
     voffset = static_cast<unsigned int>(this->Layout.VertexCount);
@@ -580,6 +967,12 @@ void vtkCompositePolyDataMapper2::BuildBufferObjects(
       static_cast<unsigned int>(this->IndexArray.size());
     this->EdgeIndexOffsets[fidx] =
       static_cast<unsigned int>(this->EdgeIndexArray.size());
+
+    block.VertexCount = voffset - block.StartVertex;
+    block.IndexCount = this->IndexOffsets[fidx] - block.StartIndex;
+    block.EdgeIndexCount =
+      this->EdgeIndexOffsets[fidx] - block.StartEdgeIndex;
+    this->BlockBuffers.push_back(block);
     }
 
   this->VBO.Upload(this->Layout.PackedVBO, vtkgl::BufferObject::ArrayBuffer);
@@ -712,15 +1105,7 @@ void vtkCompositePolyDataMapper2::AppendOneBufferObject(
             cellScalars, cellNormals);
 
   // now create the IBOs
-  int representation = act->GetProperty()->GetRepresentation();
-
-  vtkHardwareSelector* selector = ren->GetSelector();
-  if (selector && this->PopulateSelectionSettings &&
-      selector->GetFieldAssociation() == vtkDataObject::FIELD_ASSOCIATION_POINTS &&
-      selector->GetCurrentPass() > vtkHardwareSelector::ACTOR_PASS)
-    {
-    representation = VTK_POINTS;
-    }
+  int representation = this->GetIndexBufferRepresentation(ren, act);
 
   if (representation == VTK_POINTS)
     {
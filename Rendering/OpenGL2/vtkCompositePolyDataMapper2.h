@@ -19,6 +19,18 @@
 // same properties (normals, tcoord, scalars, etc) It will only draw
 // polys and it does not support edge flags. The advantage to using
 // this class is that it generally should be faster
+//
+// All the blocks are packed into one set of buffer objects.  When drawing,
+// the visible blocks that share the same color and opacity are drawn with
+// a single call, so that changing the visibility, color or opacity of a
+// block only regroups the blocks.  When only some of the blocks of the
+// input have been modified, and their sizes have not changed, only those
+// blocks are packed and uploaded again.
+//
+// With BlockCulling on, the blocks outside the view frustum are not drawn.
+// They are found with a vtkBoundingVolumeHierarchy of the bounds of the
+// blocks, which is refit when blocks change, so that the cost of culling
+// follows the number of blocks in view rather than the number of blocks.
 
 #ifndef vtkCompositePolyDataMapper2_h
 #define vtkCompositePolyDataMapper2_h
@@ -26,6 +38,8 @@
 #include "vtkRenderingOpenGL2Module.h" // For export macro
 #include "vtkGenericCompositePolyDataMapper2.h"
 
+class vtkBoundingVolumeHierarchy;
+
 class VTKRENDERINGOPENGL2_EXPORT vtkCompositePolyDataMapper2 : public vtkGenericCompositePolyDataMapper2
 {
 public:
@@ -41,6 +55,31 @@ public:
   virtual void RenderPieceDraw(vtkRenderer *ren, vtkActor *act);
   virtual void RenderEdges(vtkRenderer *ren, vtkActor *act);
 
+  // Description:
+  // The number of draw calls issued for the surface by the last render,
+  // and the number of times blocks have been packed into the buffer
+  // objects, for measuring the batching and the partial updates.
+  vtkGetMacro(DrawCallCount, int);
+  vtkGetMacro(BlockBufferBuildCount, int);
+
+  // Description:
+  // Turn on/off skipping the blocks whose bounds are outside the view
+  // frustum.  On by default.
+  vtkSetMacro(BlockCulling, int);
+  vtkGetMacro(BlockCulling, int);
+  vtkBooleanMacro(BlockCulling, int);
+
+  // Description:
+  // With BlockCulling on, also skip the blocks whose bounding spheres cover
+  // less than this fraction of the view, as the MinimumCoverage of
+  // vtkFrustumCoverageCuller.  The default is 0, which skips none.
+  vtkSetClampMacro(MinimumBlockCoverage, double, 0.0, 1.0);
+  vtkGetMacro(MinimumBlockCoverage, double);
+
+  // Description:
+  // The number of blocks drawn by the last render.
+  vtkGetMacro(VisibleBlockCount, int);
+
 protected:
   vtkCompositePolyDataMapper2();
   ~vtkCompositePolyDataMapper2();
@@ -51,6 +90,40 @@ protected:
   virtual void AppendOneBufferObject(vtkRenderer *ren,
     vtkActor *act, vtkPolyData *pd, unsigned int flat_index);
 
+  // Description:
+  // Does the VBO/IBO need to be rebuilt.  Overridden to leave out the
+  // changes of the block attributes and to check each block of the input.
+  virtual bool GetNeedToRebuildBufferObjects(vtkRenderer *ren, vtkActor *act);
+
+  // Description:
+  // Pack again the blocks that have been modified since the buffer objects
+  // were built, and upload them in place.  Returns false if the blocks are
+  // not those the buffer objects were built from, or if a block has changed
+  // size or layout, in which case all the buffer objects must be rebuilt.
+  bool UpdateChangedBlocks(vtkRenderer *ren, vtkActor *act);
+
+  // Description:
+  // The representation the index buffers are built for, which is points
+  // when selecting points.
+  int GetIndexBufferRepresentation(vtkRenderer *ren, vtkActor *act);
+
+  // what each block of the buffer objects was built from, and where
+  class BlockBuffer
+    {
+    public:
+      vtkPolyData *Data;
+      unsigned long DataMTime;
+      unsigned int FlatIndex;
+      unsigned int StartVertex;
+      unsigned int VertexCount;
+      unsigned int StartIndex;
+      unsigned int IndexCount;
+      unsigned int StartEdgeIndex;
+      unsigned int EdgeIndexCount;
+    };
+  std::vector<BlockBuffer> BlockBuffers;
+  int BlockBufferBuildCount;
+
   std::vector<unsigned int> VertexOffsets;
   std::vector<unsigned int> IndexOffsets;
   std::vector<unsigned int> IndexArray;
@@ -71,11 +144,45 @@ protected:
       bool Visibility;
       vtkColor3d Color;
       unsigned int PickId;
+      double Bounds[6];
     };
 
+  // one value per block
   std::vector<RenderValue> RenderValues;
   vtkTimeStamp RenderValuesBuildTime;
 
+  // the index ranges of the visible blocks with the same opacity and color
+  class DrawBatch
+    {
+    public:
+      double Opacity;
+      vtkColor3d Color;
+      unsigned int StartVertex;
+      unsigned int EndVertex;
+      std::vector<GLintptr> Offsets;
+      std::vector<unsigned int> Counts;
+    };
+
+  // Description:
+  // Group the visible blocks of RenderValues by opacity and color, merging
+  // the index ranges of consecutive blocks.  The edges of all the visible
+  // blocks are gathered in EdgeBatch.
+  void BuildDrawBatches();
+  std::vector<DrawBatch> DrawBatches;
+  DrawBatch EdgeBatch;
+  int DrawCallCount;
+
+  // Description:
+  // Find the blocks of RenderValues that are in the view frustum, in
+  // BlockInFrustum, and return true if they are not those of the last
+  // render.
+  bool CullBlocks(vtkRenderer *ren, vtkActor *act);
+  vtkBoundingVolumeHierarchy *BlockHierarchy;
+  std::vector<unsigned char> BlockInFrustum;
+  int BlockCulling;
+  double MinimumBlockCoverage;
+  int VisibleBlockCount;
+
   bool UseGeneric;  // use the generic render
   vtkTimeStamp GenericTestTime;
 
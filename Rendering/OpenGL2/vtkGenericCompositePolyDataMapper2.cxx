@@ -329,7 +329,7 @@ void vtkGenericCompositePolyDataMapper2::SetBlockVisibility(unsigned int index,
   if(this->CompositeAttributes)
     {
     this->CompositeAttributes->SetBlockVisibility(index, visible);
-    this->Modified();
+    this->BlockAttributesTime.Modified();
     }
 }
 
@@ -352,7 +352,7 @@ void vtkGenericCompositePolyDataMapper2::RemoveBlockVisibility(unsigned int inde
   if(this->CompositeAttributes)
     {
     this->CompositeAttributes->RemoveBlockVisibility(index);
-    this->Modified();
+    this->BlockAttributesTime.Modified();
     }
 }
 
@@ -362,7 +362,7 @@ void vtkGenericCompositePolyDataMapper2::RemoveBlockVisibilites()
   if(this->CompositeAttributes)
     {
     this->CompositeAttributes->RemoveBlockVisibilites();
-    this->Modified();
+    this->BlockAttributesTime.Modified();
     }
 }
 
@@ -372,7 +372,7 @@ void vtkGenericCompositePolyDataMapper2::SetBlockColor(unsigned int index, doubl
   if(this->CompositeAttributes)
     {
     this->CompositeAttributes->SetBlockColor(index, color);
-    this->Modified();
+    this->BlockAttributesTime.Modified();
     }
 }
 
@@ -398,7 +398,7 @@ void vtkGenericCompositePolyDataMapper2::RemoveBlockColor(unsigned int index)
   if(this->CompositeAttributes)
     {
     this->CompositeAttributes->RemoveBlockColor(index);
-    this->Modified();
+    this->BlockAttributesTime.Modified();
     }
 }
 
@@ -408,7 +408,7 @@ void vtkGenericCompositePolyDataMapper2::RemoveBlockColors()
   if(this->CompositeAttributes)
     {
     this->CompositeAttributes->RemoveBlockColors();
-    this->Modified();
+    this->BlockAttributesTime.Modified();
     }
 }
 
@@ -418,7 +418,7 @@ void vtkGenericCompositePolyDataMapper2::SetBlockOpacity(unsigned int index, dou
   if(this->CompositeAttributes)
     {
     this->CompositeAttributes->SetBlockOpacity(index, opacity);
-    this->Modified();
+    this->BlockAttributesTime.Modified();
     }
 }
 
@@ -438,7 +438,7 @@ void vtkGenericCompositePolyDataMapper2::RemoveBlockOpacity(unsigned int index)
   if(this->CompositeAttributes)
     {
     this->CompositeAttributes->RemoveBlockOpacity(index);
-    this->Modified();
+    this->BlockAttributesTime.Modified();
     }
 }
 
@@ -448,7 +448,7 @@ void vtkGenericCompositePolyDataMapper2::RemoveBlockOpacities()
   if(this->CompositeAttributes)
     {
     this->CompositeAttributes->RemoveBlockOpacities();
-    this->Modified();
+    this->BlockAttributesTime.Modified();
     }
 }
 
@@ -476,6 +476,13 @@ void vtkGenericCompositePolyDataMapper2::PrintSelf(ostream& os, vtkIndent indent
   this->Superclass::PrintSelf(os, indent);
 }
 
+//----------------------------------------------------------------------------
+unsigned long vtkGenericCompositePolyDataMapper2::GetMTime()
+{
+  return std::max(this->Superclass::GetMTime(),
+                  this->BlockAttributesTime.GetMTime());
+}
+
 //-----------------------------------------------------------------------------
 void vtkGenericCompositePolyDataMapper2::RenderBlock(vtkRenderer *renderer,
                                               vtkActor *actor,
@@ -51,6 +51,11 @@ public:
   // opaque geometry.
   virtual bool GetIsOpaque();
 
+  // Description:
+  // Overridden to include the time of the last change of the block
+  // visibilities, colors and opacities.
+  unsigned long GetMTime();
+
   // Description:
   // Set/get the composite data set attributes.
   void SetCompositeDataDisplayAttributes(vtkCompositeDataDisplayAttributes *attributes);
@@ -111,6 +116,12 @@ protected:
   // Time stamp for computation of bounds.
   vtkTimeStamp BoundsMTime;
 
+  // Description:
+  // Time of the last change of the block visibilities, colors or
+  // opacities.  These are applied when drawing, so they do not modify the
+  // mapper itself and do not cause its buffer objects to be rebuilt.
+  vtkTimeStamp BlockAttributesTime;
+
   // what "index" are we currently rendering, -1 means none
   int CurrentFlatIndex;
   std::map<const vtkShaderProgram *, bool> ShadersInitialized;
@@ -43,7 +43,9 @@
 #include "vtkScalarsToColors.h"
 #include "vtkShader.h"
 #include "vtkShaderProgram.h"
+#include "vtkTimerLog.h"
 #include "vtkTransform.h"
+#include "vtkUnsignedCharArray.h"
 
 #include "vtkOpenGLError.h"
 
@@ -78,6 +80,13 @@ vtkOpenGLPolyDataMapper::vtkOpenGLPolyDataMapper()
   this->TempMatrix3 = vtkMatrix3x3::New();
   this->DrawingEdges = false;
   this->ForceTextureCoordinates = false;
+  this->CellSupportArraysTime = 0.0;
+  this->VertexBufferTime = 0.0;
+  this->IndexBufferTime = 0.0;
+  this->VertexBufferBuildCount = 0;
+  this->VertexStreamUpdateCount = 0;
+  this->IndexBufferBuildCount = 0;
+  this->ResetBufferSources();
 }
 
 
@@ -101,6 +110,7 @@ void vtkOpenGLPolyDataMapper::ReleaseGraphicsResources(vtkWindow* win)
   this->Lines.ReleaseGraphicsResources(win);
   this->Tris.ReleaseGraphicsResources(win);
   this->TriStrips.ReleaseGraphicsResources(win);
+  this->ResetBufferSources();
 
   if (this->InternalColorTexture)
     {
@@ -109,6 +119,23 @@ void vtkOpenGLPolyDataMapper::ReleaseGraphicsResources(vtkWindow* win)
   this->Modified();
 }
 
+//-----------------------------------------------------------------------------
+void vtkOpenGLPolyDataMapper::ResetBufferSources()
+{
+  for (int i = 0; i < NumberOfBufferSources; i++)
+    {
+    this->BufferSources[i] = NULL;
+    this->BufferSourceMTimes[i] = 0;
+    }
+  this->BufferRepresentation = -1;
+  this->BufferSurfaceWithEdges = false;
+  this->BufferCellSupport = false;
+  this->BufferCellScalars = false;
+  this->BufferCellNormals = false;
+  this->BufferNumberOfPoints = -1;
+  this->TrianglesDependOnPoints = false;
+}
+
 bool vtkOpenGLPolyDataMapper::IsShaderVariableUsed(const char *name)
 {
   return std::binary_search(this->ShaderVariablesUsed.begin(),
@@ -746,7 +773,7 @@ void vtkOpenGLPolyDataMapper::SetMapperShaderParameters(vtkgl::CellBO &cellBO,
     cellBO.vao.Bind();
     if (!cellBO.vao.AddAttributeArray(cellBO.Program, this->VBO,
                                     "vertexMC", layout.VertexOffset,
-                                    layout.Stride, VTK_FLOAT, 3, false))
+                                    layout.GetVertexStride(), VTK_FLOAT, 3, false))
       {
       vtkErrorMacro(<< "Error setting 'vertexMC' in shader VAO.");
       }
@@ -754,7 +781,7 @@ void vtkOpenGLPolyDataMapper::SetMapperShaderParameters(vtkgl::CellBO &cellBO,
       {
       if (!cellBO.vao.AddAttributeArray(cellBO.Program, this->VBO,
                                       "normalMC", layout.NormalOffset,
-                                      layout.Stride, VTK_FLOAT, 3, false))
+                                      layout.GetNormalStride(), VTK_FLOAT, 3, false))
         {
         vtkErrorMacro(<< "Error setting 'normalMC' in shader VAO.");
         }
@@ -763,7 +790,7 @@ void vtkOpenGLPolyDataMapper::SetMapperShaderParameters(vtkgl::CellBO &cellBO,
       {
       if (!cellBO.vao.AddAttributeArray(cellBO.Program, this->VBO,
                                       "tcoordMC", layout.TCoordOffset,
-                                      layout.Stride, VTK_FLOAT, layout.TCoordComponents, false))
+                                      layout.GetTCoordStride(), VTK_FLOAT, layout.TCoordComponents, false))
         {
         vtkErrorMacro(<< "Error setting 'tcoordMC' in shader VAO.");
         }
@@ -772,7 +799,7 @@ void vtkOpenGLPolyDataMapper::SetMapperShaderParameters(vtkgl::CellBO &cellBO,
       {
       if (!cellBO.vao.AddAttributeArray(cellBO.Program, this->VBO,
                                       "scalarColor", layout.ColorOffset,
-                                      layout.Stride, VTK_UNSIGNED_CHAR,
+                                      layout.GetColorStride(), VTK_UNSIGNED_CHAR,
                                       layout.ColorComponents, true))
         {
         vtkErrorMacro(<< "Error setting 'scalarColor' in shader VAO.");
@@ -1543,20 +1570,6 @@ void vtkOpenGLPolyDataMapper::BuildBufferObjects(vtkRenderer *ren, vtkActor *act
     n = poly->GetCellData()->GetNormals();
     }
 
-  // if we have cell scalars then we have to
-  // explode the data
-  vtkCellArray *prims[4];
-  prims[0] =  poly->GetVerts();
-  prims[1] =  poly->GetLines();
-  prims[2] =  poly->GetPolys();
-  prims[3] =  poly->GetStrips();
-  std::vector<unsigned int> cellPointMap;
-  std::vector<unsigned int> pointCellMap;
-  if (cellScalars || cellNormals)
-    {
-    vtkgl::CreateCellSupportArrays(poly, prims, cellPointMap, pointCellMap);
-    }
-
   // do we have texture maps?
   bool haveTextures = (this->ColorTextureMap || act->GetTexture() ||
     act->GetProperty()->GetNumberOfTextures() ||
@@ -1578,22 +1591,6 @@ void vtkOpenGLPolyDataMapper::BuildBufferObjects(vtkRenderer *ren, vtkActor *act
       }
     }
 
-  // Build the VBO
-  this->Layout =
-    CreateVBO(poly->GetPoints(),
-              cellPointMap.size() > 0 ? (unsigned int)cellPointMap.size() : poly->GetPoints()->GetNumberOfPoints(),
-              n, tcoords,
-              this->Colors ? (unsigned char *)this->Colors->GetVoidPointer(0) : NULL,
-              this->Colors ? this->Colors->GetNumberOfComponents() : 0,
-              this->VBO,
-              cellPointMap.size() > 0 ? &cellPointMap.front() : NULL,
-              pointCellMap.size() > 0 ? &pointCellMap.front() : NULL,
-              cellScalars, cellNormals);
-
-  // now create the IBOs
-  this->Points.indexCount = CreatePointIndexBuffer(prims[0],
-                                                   this->Points.ibo);
-
   int representation = act->GetProperty()->GetRepresentation();
 
   vtkHardwareSelector* selector = ren->GetSelector();
@@ -1604,6 +1601,198 @@ void vtkOpenGLPolyDataMapper::BuildBufferObjects(vtkRenderer *ren, vtkActor *act
     representation = VTK_POINTS;
     }
 
+  // when drawing edges also build the edge IBOs
+  vtkProperty *prop = act->GetProperty();
+  bool draw_surface_with_edges =
+    (prop->GetEdgeVisibility() && prop->GetRepresentation() == VTK_SURFACE);
+
+  vtkDataArray *ef = poly->GetPointData()->GetAttribute(
+                      vtkDataSetAttributes::EDGEFLAG);
+  if (ef)
+    {
+    if (ef->GetNumberOfComponents() != 1)
+      {
+      vtkDebugMacro(<< "Currently only 1d edge flags are supported.");
+      ef = NULL;
+      }
+    else if (!ef->IsA("vtkUnsignedCharArray"))
+      {
+      vtkDebugMacro(<< "Currently only unsigned char edge flags are suported.");
+      ef = NULL;
+      }
+    }
+
+  vtkCellArray *prims[4];
+  prims[0] =  poly->GetVerts();
+  prims[1] =  poly->GetLines();
+  prims[2] =  poly->GetPolys();
+  prims[3] =  poly->GetStrips();
+  vtkIdType numPts = poly->GetPoints()->GetNumberOfPoints();
+
+  // The IBOs only depend on the cells and on how they are drawn, so they
+  // are kept when only the points or the attributes have changed, which is
+  // what happens for a deforming or recolored mesh.  The VBO holds each
+  // attribute in its own range, so only the attributes that have changed
+  // are uploaded again.  A change of the polydata itself may come from any
+  // of its arrays, edited in place, so it rebuilds everything.
+  bool polyDataChanged = this->UpdateBufferSource(PolyDataSource, poly,
+    poly->vtkObject::GetMTime());
+  bool pointsChanged =
+    this->UpdateBufferSource(PointsSource, poly->GetPoints());
+  bool cellsChanged = polyDataChanged;
+  for (int primType = 0; primType < 4; primType++)
+    {
+    cellsChanged = this->UpdateBufferSource(
+      VertsSource + primType, prims[primType]) || cellsChanged;
+    }
+  cellsChanged = this->UpdateBufferSource(EdgeFlagsSource, ef) ||
+    cellsChanged;
+  cellsChanged = (cellsChanged ||
+    (pointsChanged && this->TrianglesDependOnPoints) ||
+    (cellScalars || cellNormals) != this->BufferCellSupport ||
+    numPts != this->BufferNumberOfPoints ||
+    representation != this->BufferRepresentation ||
+    draw_surface_with_edges != this->BufferSurfaceWithEdges);
+
+  bool streamsChanged[4];
+  streamsChanged[vtkgl::VertexStream] = pointsChanged;
+  streamsChanged[vtkgl::NormalStream] =
+    this->UpdateBufferSource(NormalsSource, n);
+  streamsChanged[vtkgl::TCoordStream] =
+    this->UpdateBufferSource(TCoordsSource, tcoords);
+  streamsChanged[vtkgl::ColorStream] =
+    this->UpdateBufferSource(ColorsSource, this->Colors);
+
+  // the duplicated points of the cell data depend on the cells
+  bool rebuildVBO = (polyDataChanged || !this->Layout.Split ||
+    cellScalars != this->BufferCellScalars ||
+    cellNormals != this->BufferCellNormals ||
+    (cellsChanged && (cellScalars || cellNormals)));
+
+  this->BufferCellSupport = (cellScalars || cellNormals);
+  this->BufferNumberOfPoints = numPts;
+  this->BufferRepresentation = representation;
+  this->BufferSurfaceWithEdges = draw_surface_with_edges;
+  this->BufferCellScalars = cellScalars;
+  this->BufferCellNormals = cellNormals;
+  this->CellSupportArraysTime = 0.0;
+  this->VertexBufferTime = 0.0;
+  this->IndexBufferTime = 0.0;
+
+  // if we have cell scalars then we have to
+  // explode the data
+  double startTime = vtkTimerLog::GetUniversalTime();
+  if ((cellScalars || cellNormals) && cellsChanged)
+    {
+    this->CellPointMap.clear();
+    this->PointCellMap.clear();
+    vtkgl::CreateCellSupportArrays(poly, prims, this->CellPointMap,
+                                   this->PointCellMap);
+    this->CellSupportArraysTime =
+      vtkTimerLog::GetUniversalTime() - startTime;
+    }
+  else if (!(cellScalars || cellNormals))
+    {
+    this->CellPointMap.clear();
+    this->PointCellMap.clear();
+    }
+  std::vector<unsigned int> &cellPointMap = this->CellPointMap;
+  std::vector<unsigned int> &pointCellMap = this->PointCellMap;
+
+  // Upload the attributes that have changed, if the VBO has kept its
+  // layout, otherwise build the VBO
+  unsigned int numVertices = cellPointMap.size() > 0 ?
+    (unsigned int)cellPointMap.size() :
+    poly->GetPoints()->GetNumberOfPoints();
+  unsigned char *colors = this->Colors ?
+    (unsigned char *)this->Colors->GetVoidPointer(0) : NULL;
+  int colorComponents = this->Colors ?
+    this->Colors->GetNumberOfComponents() : 0;
+  startTime = vtkTimerLog::GetUniversalTime();
+  for (int stream = vtkgl::VertexStream;
+       stream <= vtkgl::ColorStream && !rebuildVBO; stream++)
+    {
+    if (streamsChanged[stream])
+      {
+      rebuildVBO = !vtkgl::UpdateSplitVBO(this->Layout,
+        static_cast<vtkgl::VBOStream>(stream),
+        poly->GetPoints(), numVertices, n, tcoords,
+        colors, colorComponents, this->VBO,
+        cellPointMap.size() > 0 ? &cellPointMap.front() : NULL,
+        pointCellMap.size() > 0 ? &pointCellMap.front() : NULL,
+        cellScalars, cellNormals);
+      if (!rebuildVBO)
+        {
+        this->VertexStreamUpdateCount++;
+        }
+      }
+    }
+  if (rebuildVBO)
+    {
+    this->Layout =
+      CreateSplitVBO(poly->GetPoints(), numVertices,
+                n, tcoords, colors, colorComponents,
+                this->VBO,
+                cellPointMap.size() > 0 ? &cellPointMap.front() : NULL,
+                pointCellMap.size() > 0 ? &pointCellMap.front() : NULL,
+                cellScalars, cellNormals);
+    this->VertexBufferBuildCount++;
+    }
+  this->VertexBufferTime = vtkTimerLog::GetUniversalTime() - startTime;
+
+  // now create the IBOs
+  if (cellsChanged)
+    {
+    startTime = vtkTimerLog::GetUniversalTime();
+    this->BuildIndexBuffers(poly, prims, representation,
+                            draw_surface_with_edges, ef);
+    this->IndexBufferTime = vtkTimerLog::GetUniversalTime() - startTime;
+    this->IndexBufferBuildCount++;
+    }
+
+  // free up new cell arrays
+  if ((cellScalars || cellNormals) && cellsChanged)
+    {
+    for (int primType = 0; primType < 4; primType++)
+      {
+      prims[primType]->UnRegister(this);
+      }
+    }
+  vtkOpenGLCheckErrorMacro("failed after BuildBufferObjects");
+}
+
+//-----------------------------------------------------------------------------
+bool vtkOpenGLPolyDataMapper::UpdateBufferSource(int slot, vtkObject *source)
+{
+  return this->UpdateBufferSource(slot, source,
+                                  source ? source->GetMTime() : 0);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkOpenGLPolyDataMapper::UpdateBufferSource(int slot, vtkObject *source,
+                                                 unsigned long mtime)
+{
+  if (this->BufferSources[slot] == source &&
+      this->BufferSourceMTimes[slot] == mtime)
+    {
+    return false;
+    }
+  this->BufferSources[slot] = source;
+  this->BufferSourceMTimes[slot] = mtime;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void vtkOpenGLPolyDataMapper::BuildIndexBuffers(vtkPolyData *poly,
+  vtkCellArray *prims[4], int representation, bool drawSurfaceWithEdges,
+  vtkDataArray *ef)
+{
+  this->Points.indexCount = CreatePointIndexBuffer(prims[0],
+                                                   this->Points.ibo);
+
+  // only the triangulation of large polygons depends on the points
+  this->TrianglesDependOnPoints = false;
+
   if (representation == VTK_POINTS)
     {
     this->Lines.indexCount = CreatePointIndexBuffer(prims[1],
@@ -1623,21 +1812,6 @@ void vtkOpenGLPolyDataMapper::BuildBufferObjects(vtkRenderer *ren, vtkActor *act
 
     if (representation == VTK_WIREFRAME)
       {
-      vtkDataArray *ef = poly->GetPointData()->GetAttribute(
-                        vtkDataSetAttributes::EDGEFLAG);
-      if (ef)
-        {
-        if (ef->GetNumberOfComponents() != 1)
-          {
-          vtkDebugMacro(<< "Currently only 1d edge flags are supported.");
-          ef = NULL;
-          }
-        if (!ef->IsA("vtkUnsignedCharArray"))
-          {
-          vtkDebugMacro(<< "Currently only unsigned char edge flags are suported.");
-          ef = NULL;
-          }
-        }
       if (ef)
         {
         this->Tris.indexCount = CreateEdgeFlagIndexBuffer(prims[2],
@@ -1655,10 +1829,11 @@ void vtkOpenGLPolyDataMapper::BuildBufferObjects(vtkRenderer *ren, vtkActor *act
       }
    else // SURFACE
       {
+      this->TrianglesDependOnPoints = (prims[2]->GetMaxCellSize() > 6);
       this->Tris.indexCount = CreateTriangleIndexBuffer(prims[2],
                                                 this->Tris.ibo,
                                                 poly->GetPoints(),
-                                                cellPointMap);
+                                                this->CellPointMap);
       this->TriStrips.indexCount = CreateMultiIndexBuffer(prims[3],
                            this->TriStrips.ibo,
                            this->TriStrips.offsetArray,
@@ -1667,26 +1842,8 @@ void vtkOpenGLPolyDataMapper::BuildBufferObjects(vtkRenderer *ren, vtkActor *act
     }
 
   // when drawing edges also build the edge IBOs
-  vtkProperty *prop = act->GetProperty();
-  bool draw_surface_with_edges =
-    (prop->GetEdgeVisibility() && prop->GetRepresentation() == VTK_SURFACE);
-  if (draw_surface_with_edges)
+  if (drawSurfaceWithEdges)
     {
-    vtkDataArray *ef = poly->GetPointData()->GetAttribute(
-                        vtkDataSetAttributes::EDGEFLAG);
-    if (ef)
-      {
-      if (ef->GetNumberOfComponents() != 1)
-        {
-        vtkDebugMacro(<< "Currently only 1d edge flags are supported.");
-        ef = NULL;
-        }
-      if (!ef->IsA("vtkUnsignedCharArray"))
-        {
-        vtkDebugMacro(<< "Currently only unsigned char edge flags are suported.");
-        ef = NULL;
-        }
-      }
     if (ef)
       {
       this->TrisEdges.indexCount = CreateEdgeFlagIndexBuffer(prims[2],
@@ -1702,16 +1859,6 @@ void vtkOpenGLPolyDataMapper::BuildBufferObjects(vtkRenderer *ren, vtkActor *act
                          this->TriStripsEdges.offsetArray,
                          this->TriStripsEdges.elementsArray, true);
     }
-
-  // free up new cell arrays
-  if (cellScalars || cellNormals)
-    {
-    for (int primType = 0; primType < 4; primType++)
-      {
-      prims[primType]->UnRegister(this);
-      }
-    }
-  vtkOpenGLCheckErrorMacro("failed after BuildBufferObjects");
 }
 
 //-----------------------------------------------------------------------------
@@ -1904,4 +2051,14 @@ vtkIdType vtkOpenGLPolyDataMapper::GetConvertedPickValue(vtkIdType idIn, int fie
 void vtkOpenGLPolyDataMapper::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "CellSupportArraysTime: " << this->CellSupportArraysTime
+     << "\n";
+  os << indent << "VertexBufferTime: " << this->VertexBufferTime << "\n";
+  os << indent << "IndexBufferTime: " << this->IndexBufferTime << "\n";
+  os << indent << "VertexBufferBuildCount: " << this->VertexBufferBuildCount
+     << "\n";
+  os << indent << "VertexStreamUpdateCount: "
+     << this->VertexStreamUpdateCount << "\n";
+  os << indent << "IndexBufferBuildCount: " << this->IndexBufferBuildCount
+     << "\n";
 }
@@ -71,6 +71,27 @@ public:
   // opaque geometry.
   virtual bool GetIsOpaque();
 
+  // Description:
+  // The time in seconds taken by each stage of the last build of the buffer
+  // objects: duplicating the shared points of cells for cell scalars or
+  // normals, packing and uploading the VBO, and building and uploading the
+  // IBOs.  The packing is done in parallel with vtkSMPTools.
+  vtkGetMacro(CellSupportArraysTime, double);
+  vtkGetMacro(VertexBufferTime, double);
+  vtkGetMacro(IndexBufferTime, double);
+
+  // Description:
+  // The number of times the VBO and the IBOs have been built, and the number
+  // of attributes (points, normals, texture coordinates or colors) uploaded
+  // on their own.  The IBOs only depend on the cells and on how they are
+  // drawn, so they are kept when only the points or the attributes change.
+  // The VBO holds each attribute in its own range, so when only some of the
+  // arrays packed into it change, only those are uploaded again.  Marking
+  // the polydata itself as modified rebuilds all the buffers.
+  vtkGetMacro(VertexBufferBuildCount, int);
+  vtkGetMacro(VertexStreamUpdateCount, int);
+  vtkGetMacro(IndexBufferBuildCount, int);
+
   // used by RenderPiece and functions it calls to reduce
   // calls to get the input and allow for rendering of
   // other polydata (not the input)
@@ -163,6 +184,25 @@ protected:
   // Build the VBO/IBO, called by UpdateBufferObjects
   virtual void BuildBufferObjects(vtkRenderer *ren, vtkActor *act);
 
+  // Description:
+  // Build the IBOs, called by BuildBufferObjects when the cells or the way
+  // they are drawn have changed.
+  void BuildIndexBuffers(vtkPolyData *poly, vtkCellArray *prims[4],
+                         int representation, bool drawSurfaceWithEdges,
+                         vtkDataArray *edgeFlags);
+
+  // Description:
+  // Record the array, or other object, in one of the slots below and
+  // return whether it differs from the one recorded when the buffer
+  // objects were last built, or has been modified since.
+  bool UpdateBufferSource(int slot, vtkObject *source);
+  bool UpdateBufferSource(int slot, vtkObject *source, unsigned long mtime);
+
+  // Description:
+  // Forget what the buffer objects were built from, so that they are all
+  // rebuilt.
+  void ResetBufferSources();
+
   // The VBO and its layout.
   vtkgl::BufferObject VBO;
   vtkgl::VBOLayout Layout;
@@ -189,6 +229,39 @@ protected:
 
   bool UsingScalarColoring;
   vtkTimeStamp VBOBuildTime; // When was the OpenGL VBO updated?
+  double CellSupportArraysTime;
+  double VertexBufferTime;
+  double IndexBufferTime;
+  int VertexBufferBuildCount;
+  int VertexStreamUpdateCount;
+  int IndexBufferBuildCount;
+
+  // What the buffer objects were last built from.
+  enum BufferSourceSlot
+    {
+    PolyDataSource = 0,
+    PointsSource,
+    NormalsSource,
+    TCoordsSource,
+    ColorsSource,
+    VertsSource,
+    LinesSource,
+    PolysSource,
+    StripsSource,
+    EdgeFlagsSource,
+    NumberOfBufferSources
+    };
+  vtkObject *BufferSources[NumberOfBufferSources];
+  unsigned long BufferSourceMTimes[NumberOfBufferSources];
+  int BufferRepresentation;
+  bool BufferSurfaceWithEdges;
+  bool BufferCellSupport;
+  bool BufferCellScalars;
+  bool BufferCellNormals;
+  vtkIdType BufferNumberOfPoints;
+  bool TrianglesDependOnPoints;
+  std::vector<unsigned int> CellPointMap;
+  std::vector<unsigned int> PointCellMap;
   vtkOpenGLTexture* InternalColorTexture;
 
   int PopulateSelectionSettings;
@@ -33,9 +33,10 @@ inline GLenum convertType(BufferObject::ObjectType type)
 
 struct BufferObject::Private
 {
-  Private() : handle(0) {}
+  Private() : handle(0), size(0) {}
   GLenum type;
   GLuint handle;
+  size_t size;
 };
 
 BufferObject::BufferObject(ObjectType type)
@@ -67,6 +68,7 @@ void BufferObject::ReleaseGraphicsResources()
     glBindBuffer(this->d->type, 0);
     glDeleteBuffers(1, &this->d->handle);
     this->d->handle = 0;
+    this->d->size = 0;
     }
 }
 
@@ -126,8 +128,33 @@ bool BufferObject::UploadInternal(const void *buffer, size_t size,
   glBindBuffer(this->d->type, this->d->handle);
   glBufferData(this->d->type, size, static_cast<const GLvoid *>(buffer),
                GL_STATIC_DRAW);
+  this->d->size = size;
   this->Dirty = false;
   return true;
 }
 
+bool BufferObject::UploadRangeInternal(const void *buffer, size_t offset,
+                                       size_t size, ObjectType objectType)
+{
+  if (this->d->handle == 0 || this->Dirty)
+    {
+    this->Error = "Trying to upload a range to an empty buffer.";
+    return false;
+    }
+  if (this->d->type != convertType(objectType))
+    {
+    this->Error = "Trying to upload array buffer to incompatible buffer.";
+    return false;
+    }
+  if (offset + size > this->d->size)
+    {
+    this->Error = "Trying to upload a range past the end of the buffer.";
+    return false;
+    }
+  glBindBuffer(this->d->type, this->d->handle);
+  glBufferSubData(this->d->type, static_cast<GLintptr>(offset), size,
+                  static_cast<const GLvoid *>(buffer));
+  return true;
+}
+
 }
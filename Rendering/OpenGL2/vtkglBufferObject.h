@@ -62,6 +62,15 @@ public:
   template <class T>
   bool Upload(const T *array, size_t numElements, ObjectType type);
 
+  /**
+   * Replace @a numElements values of the buffer object, starting at the
+   * value @a offset, with those of @a array, without reallocating it. The
+   * buffer must have been uploaded before and be large enough.
+   */
+  template <class T>
+  bool UploadRange(const T *array, size_t offset, size_t numElements,
+                   ObjectType type);
+
   /**
    * Bind the buffer object ready for rendering.
    * @note Only one ARRAY_BUFFER and one ELEMENT_ARRAY_BUFFER may be bound at
@@ -86,6 +95,8 @@ public:
 
 private:
   bool UploadInternal(const void *buffer, size_t size, ObjectType objectType);
+  bool UploadRangeInternal(const void *buffer, size_t offset, size_t size,
+                           ObjectType objectType);
 
   struct Private;
   Private *d;
@@ -122,6 +133,21 @@ inline bool BufferObject::Upload(const T *array, size_t numElements,
                               objectType);
 }
 
+template <class T>
+inline bool BufferObject::UploadRange(const T *array, size_t offset,
+                                      size_t numElements,
+                                      BufferObject::ObjectType objectType)
+{
+  if (!array || numElements == 0)
+    {
+    this->Error = "Refusing to upload empty array.";
+    return false;
+    }
+
+  return this->UploadRangeInternal(array, offset * sizeof(T),
+                                   numElements * sizeof(T), objectType);
+}
+
 }
 
 #endif
@@ -18,6 +18,7 @@
 #include "vtkPolygon.h"
 #include "vtkPolyData.h"
 #include "vtkShaderProgram.h"
+#include "vtkSMPTools.h"
 
 
 // we only instantiate some cases to avoid template explosion
@@ -28,6 +29,84 @@
 
 namespace vtkgl {
 
+// Packs a range of points into the interleaved buffer.  Each point has its
+// own block of the buffer, so ranges of points can be packed in parallel.
+template<typename T, typename T2, typename T3>
+class AppendVBOFunctor
+{
+public:
+  float *Buffer;
+  int BlockSize;
+  T *Points;
+  T2 *Normals;
+  T3 *TCoords;
+  int TextureComponents;
+  unsigned char *Colors;
+  int ColorComponents;
+  unsigned int *PointPointMap;
+  unsigned int *PointCellMap;
+  bool CellScalars;
+  bool CellNormals;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    float *it = this->Buffer + begin*this->BlockSize;
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      vtkIdType ptId = (this->PointPointMap ? this->PointPointMap[i] : i);
+
+      // Vertices
+      T *pointPtr = this->Points + ptId*3;
+      *(it++) = *(pointPtr++);
+      *(it++) = *(pointPtr++);
+      *(it++) = *(pointPtr++);
+      if (this->Normals)
+        {
+        T2 *normalPtr = this->Normals + ptId*3;
+        if (this->CellNormals && this->PointCellMap &&
+            this->PointCellMap[i] > 0)
+          {
+          normalPtr = this->Normals + (this->PointCellMap[i]-1)*3;
+          }
+        *(it++) = *(normalPtr++);
+        *(it++) = *(normalPtr++);
+        *(it++) = *(normalPtr++);
+        }
+      if (this->TCoords)
+        {
+        T3 *tcoordPtr = this->TCoords + ptId*this->TextureComponents;
+        for (int j = 0; j < this->TextureComponents; ++j)
+          {
+          *(it++) = *(tcoordPtr++);
+          }
+        }
+      if (this->Colors)
+        {
+        unsigned char *colorPtr = this->Colors + ptId*this->ColorComponents;
+        if (this->CellScalars && this->PointCellMap &&
+            this->PointCellMap[i] > 0)
+          {
+          colorPtr = this->Colors +
+            (this->PointCellMap[i]-1)*this->ColorComponents;
+          }
+        if (this->ColorComponents == 4)
+          {
+          *(it++) = *reinterpret_cast<float *>(colorPtr);
+          }
+        else
+          {
+          unsigned char c[4];
+          c[0] = *(colorPtr++);
+          c[1] = *(colorPtr++);
+          c[2] = *(colorPtr);
+          c[3] =  255;
+          *(it++) = *reinterpret_cast<float *>(c);
+          }
+        }
+      }
+  }
+};
+
 // internal function called by AppendVBO
 template<typename T, typename T2, typename T3>
 void TemplatedAppendVBO3(VBOLayout &layout,
@@ -65,75 +144,27 @@ void TemplatedAppendVBO3(VBOLayout &layout,
     }
   layout.Stride = sizeof(float) * blockSize;
 
-  // Create a buffer, and copy the data over.
+  // Create a buffer, and pack the points into it in parallel.
   layout.PackedVBO.resize(blockSize * (numPts + layout.VertexCount));
-  std::vector<float>::iterator it = layout.PackedVBO.begin()
-    + (layout.VertexCount*layout.Stride/sizeof(float));
-
-  T *pointPtr;
-  T2 *normalPtr;
-  T3 *tcoordPtr;
-  unsigned char *colorPtr;
-
-  // TODO: optimize this somehow, lots of if statements in here
-  for (vtkIdType i = 0; i < numPts; ++i)
+  if (numPts == 0)
     {
-    if (pointPointMap)
-      {
-      pointPtr = points + (pointPointMap[i])*3;
-      normalPtr = normals + (pointPointMap[i])*3;
-      tcoordPtr = tcoords + (pointPointMap[i])*textureComponents;
-      colorPtr = colors + (pointPointMap[i])*colorComponents;
-      }
-    else
-      {
-      pointPtr = points + i*3;
-      normalPtr = normals + i*3;
-      tcoordPtr = tcoords + i*textureComponents;
-      colorPtr = colors + i*colorComponents;
-      }
-    // Vertices
-    *(it++) = *(pointPtr++);
-    *(it++) = *(pointPtr++);
-    *(it++) = *(pointPtr++);
-    if (normals)
-      {
-      if (cellNormals && pointCellMap && pointCellMap[i] > 0)
-        {
-        normalPtr = normals + (pointCellMap[i]-1)*3;
-        }
-      *(it++) = *(normalPtr++);
-      *(it++) = *(normalPtr++);
-      *(it++) = *(normalPtr++);
-      }
-    if (tcoords)
-      {
-      for (int j = 0; j < textureComponents; ++j)
-        {
-        *(it++) = *(tcoordPtr++);
-        }
-      }
-    if (colors)
-      {
-      if (cellScalars && pointCellMap && pointCellMap[i] > 0)
-        {
-        colorPtr = colors + (pointCellMap[i]-1)*colorComponents;
-        }
-      if (colorComponents == 4)
-        {
-        *(it++) = *reinterpret_cast<float *>(colorPtr);
-        }
-      else
-        {
-        unsigned char c[4];
-        c[0] = *(colorPtr++);
-        c[1] = *(colorPtr++);
-        c[2] = *(colorPtr);
-        c[3] =  255;
-        *(it++) = *reinterpret_cast<float *>(c);
-        }
-      }
+    return;
     }
+  AppendVBOFunctor<T, T2, T3> functor;
+  functor.Buffer = &layout.PackedVBO[0] + layout.VertexCount*blockSize;
+  functor.BlockSize = blockSize;
+  functor.Points = points;
+  functor.Normals = normals;
+  functor.TCoords = tcoords;
+  functor.TextureComponents = textureComponents;
+  functor.Colors = colors;
+  functor.ColorComponents = colorComponents;
+  functor.PointPointMap = pointPointMap;
+  functor.PointCellMap = pointCellMap;
+  functor.CellScalars = cellScalars;
+  functor.CellNormals = cellNormals;
+  vtkSMPTools::For(0, numPts, functor);
+
   layout.VertexCount += numPts;
 }
 
@@ -263,6 +294,274 @@ VBOLayout CreateVBO(
   return layout;
 }
 
+// Packs a range of the values of one attribute into its own range of a
+// split buffer, converting them to floats.
+template<typename T>
+class PackVBOStreamFunctor
+{
+public:
+  float *Buffer;
+  T *Values;
+  int Components;
+  unsigned int *PointPointMap;
+  unsigned int *PointCellMap; // set to use the values of the cells
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    float *it = this->Buffer + begin*this->Components;
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      vtkIdType id = (this->PointPointMap ? this->PointPointMap[i] : i);
+      if (this->PointCellMap && this->PointCellMap[i] > 0)
+        {
+        id = this->PointCellMap[i] - 1;
+        }
+      T *valuePtr = this->Values + id*this->Components;
+      for (int j = 0; j < this->Components; ++j)
+        {
+        *(it++) = static_cast<float>(*(valuePtr++));
+        }
+      }
+  }
+};
+
+// Packs a range of colors into the color range of a split buffer, four
+// unsigned chars in each float as in the interleaved buffer.
+class PackVBOColorsFunctor
+{
+public:
+  float *Buffer;
+  unsigned char *Colors;
+  int ColorComponents;
+  unsigned int *PointPointMap;
+  unsigned int *PointCellMap; // set to use the colors of the cells
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    unsigned char *it = reinterpret_cast<unsigned char *>(this->Buffer + begin);
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      vtkIdType id = (this->PointPointMap ? this->PointPointMap[i] : i);
+      if (this->PointCellMap && this->PointCellMap[i] > 0)
+        {
+        id = this->PointCellMap[i] - 1;
+        }
+      unsigned char *colorPtr = this->Colors + id*this->ColorComponents;
+      *(it++) = colorPtr[0];
+      *(it++) = colorPtr[1];
+      *(it++) = colorPtr[2];
+      *(it++) = (this->ColorComponents == 4 ? colorPtr[3] : 255);
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+template<typename T>
+void TemplatedPackVBOStream(float *buffer, T *values, int components,
+  vtkIdType numPts, unsigned int *pointPointMap, unsigned int *pointCellMap)
+{
+  PackVBOStreamFunctor<T> functor;
+  functor.Buffer = buffer;
+  functor.Values = values;
+  functor.Components = components;
+  functor.PointPointMap = pointPointMap;
+  functor.PointCellMap = pointCellMap;
+  vtkSMPTools::For(0, numPts, functor);
+}
+
+// Pack one attribute of a split VBO at the start of buffer, which must hold
+// the number of floats given by GetSplitVBOStreamSize.
+static void PackVBOStream(VBOStream stream, float *buffer,
+  vtkPoints *points, unsigned int numPts,
+  vtkDataArray *normals,
+  vtkDataArray *tcoords,
+  unsigned char *colors, int colorComponents,
+  unsigned int *pointPointMap, unsigned int *pointCellMap,
+  bool cellScalars, bool cellNormals)
+{
+  switch (stream)
+    {
+    case VertexStream:
+      switch(points->GetDataType())
+        {
+        vtkTemplateMacro(
+          TemplatedPackVBOStream(buffer,
+            static_cast<VTK_TT*>(points->GetVoidPointer(0)), 3,
+            numPts, pointPointMap, static_cast<unsigned int *>(NULL)));
+        }
+      break;
+    case NormalStream:
+      switch(normals->GetDataType())
+        {
+        vtkFloatDoubleTemplateMacro(
+          TemplatedPackVBOStream(buffer,
+            static_cast<VTK_TT*>(normals->GetVoidPointer(0)), 3,
+            numPts, pointPointMap, cellNormals ? pointCellMap : NULL));
+        }
+      break;
+    case TCoordStream:
+      switch(tcoords->GetDataType())
+        {
+        vtkFloatDoubleTemplateMacro(
+          TemplatedPackVBOStream(buffer,
+            static_cast<VTK_TT*>(tcoords->GetVoidPointer(0)),
+            tcoords->GetNumberOfComponents(),
+            numPts, pointPointMap, static_cast<unsigned int *>(NULL)));
+        }
+      break;
+    case ColorStream:
+      {
+      PackVBOColorsFunctor functor;
+      functor.Buffer = buffer;
+      functor.Colors = colors;
+      functor.ColorComponents = colorComponents;
+      functor.PointPointMap = pointPointMap;
+      functor.PointCellMap = cellScalars ? pointCellMap : NULL;
+      vtkSMPTools::For(0, static_cast<vtkIdType>(numPts), functor);
+      }
+      break;
+    }
+}
+
+// The offset and the number of floats of one attribute of a split VBO.
+static void GetSplitVBOStreamRange(const VBOLayout &layout, VBOStream stream,
+  size_t &offset, size_t &size)
+{
+  size_t numPts = layout.VertexCount;
+  switch (stream)
+    {
+    case VertexStream:
+      offset = layout.VertexOffset;
+      size = 3*numPts;
+      break;
+    case NormalStream:
+      offset = layout.NormalOffset;
+      size = (layout.NormalOffset ? 3*numPts : 0);
+      break;
+    case TCoordStream:
+      offset = layout.TCoordOffset;
+      size = layout.TCoordComponents*numPts;
+      break;
+    case ColorStream:
+      offset = layout.ColorOffset;
+      size = (layout.ColorComponents ? numPts : 0);
+      break;
+    }
+  offset /= sizeof(float);
+}
+
+// create a VBO with one range per attribute, then upload it
+VBOLayout CreateSplitVBO(
+  vtkPoints *points, unsigned int numPts,
+  vtkDataArray *normals,
+  vtkDataArray *tcoords,
+  unsigned char *colors, int colorComponents,
+  BufferObject &vertexBuffer,
+  unsigned int *pointPointMap, unsigned int *pointCellMap,
+  bool cellScalars, bool cellNormals)
+{
+  VBOLayout layout;
+  layout.Split = true;
+  layout.VertexCount = numPts;
+  layout.Stride = 3*sizeof(float);
+
+  // the offset of an attribute is also the size of the attributes before it
+  size_t bufferSize = 3*numPts;
+  if (normals)
+    {
+    layout.NormalOffset = static_cast<int>(sizeof(float)*bufferSize);
+    bufferSize += 3*numPts;
+    }
+  if (tcoords)
+    {
+    layout.TCoordOffset = static_cast<int>(sizeof(float)*bufferSize);
+    layout.TCoordComponents = tcoords->GetNumberOfComponents();
+    bufferSize += layout.TCoordComponents*numPts;
+    }
+  if (colors)
+    {
+    layout.ColorOffset = static_cast<int>(sizeof(float)*bufferSize);
+    layout.ColorComponents = colorComponents;
+    bufferSize += numPts;
+    }
+
+  // fast path, the buffer is the points
+  if (bufferSize == 3*numPts && !pointPointMap &&
+      points->GetDataType() == VTK_FLOAT)
+    {
+    vertexBuffer.Upload((float *)(points->GetVoidPointer(0)), numPts*3,
+      vtkgl::BufferObject::ArrayBuffer);
+    return layout;
+    }
+
+  layout.PackedVBO.resize(bufferSize);
+  if (numPts)
+    {
+    for (int stream = VertexStream; stream <= ColorStream; ++stream)
+      {
+      size_t offset, size;
+      GetSplitVBOStreamRange(layout, static_cast<VBOStream>(stream),
+                             offset, size);
+      if (size)
+        {
+        PackVBOStream(static_cast<VBOStream>(stream),
+          &layout.PackedVBO[offset], points, numPts, normals, tcoords,
+          colors, colorComponents, pointPointMap, pointCellMap,
+          cellScalars, cellNormals);
+        }
+      }
+    }
+  vertexBuffer.Upload(layout.PackedVBO, vtkgl::BufferObject::ArrayBuffer);
+  layout.PackedVBO.resize(0);
+  return layout;
+}
+
+// repack one attribute of a split VBO and upload it in place
+bool UpdateSplitVBO(VBOLayout &layout, VBOStream stream,
+  vtkPoints *points, unsigned int numPts,
+  vtkDataArray *normals,
+  vtkDataArray *tcoords,
+  unsigned char *colors, int colorComponents,
+  BufferObject &vertexBuffer,
+  unsigned int *pointPointMap, unsigned int *pointCellMap,
+  bool cellScalars, bool cellNormals)
+{
+  size_t offset, size;
+  GetSplitVBOStreamRange(layout, stream, offset, size);
+  bool compatible = (layout.Split && size > 0 && numPts == layout.VertexCount);
+  switch (stream)
+    {
+    case VertexStream:
+      compatible = compatible && points;
+      break;
+    case NormalStream:
+      compatible = compatible && normals &&
+        normals->GetNumberOfComponents() == 3;
+      break;
+    case TCoordStream:
+      compatible = compatible && tcoords &&
+        tcoords->GetNumberOfComponents() == layout.TCoordComponents;
+      break;
+    case ColorStream:
+      compatible = compatible && colors &&
+        colorComponents == layout.ColorComponents;
+      break;
+    }
+  if (!compatible)
+    {
+    return false;
+    }
+
+  layout.PackedVBO.resize(size);
+  PackVBOStream(stream, &layout.PackedVBO[0], points, numPts, normals,
+    tcoords, colors, colorComponents, pointPointMap, pointCellMap,
+    cellScalars, cellNormals);
+  bool uploaded = vertexBuffer.UploadRange(&layout.PackedVBO[0], offset,
+    size, vtkgl::BufferObject::ArrayBuffer);
+  layout.PackedVBO.resize(0);
+  return uploaded;
+}
+
 // Process the string, and return a version with replacements.
 std::string replace(std::string source, const std::string &search,
                     const std::string replace, bool all)
@@ -299,6 +598,165 @@ bool substitute(std::string &source, const std::string &search,
   return replaced;
 }
 
+// The index buffers are filled in parallel over chunks of cells.  A serial
+// pass over the connectivity first finds where each chunk starts, in the
+// cell array and in the index array, and then each chunk writes its own
+// part of the preallocated index array.
+enum IndexBufferMode
+{
+  PointIndices,
+  LineIndices,
+  TriangleIndices
+};
+
+const vtkIdType IndexBufferChunkSize = 4096;
+
+// the number of indices written for a cell of npts points
+inline size_t IndexBufferCount(int mode, vtkIdType npts)
+{
+  if (mode == PointIndices)
+    {
+    return npts;
+    }
+  else if (mode == LineIndices)
+    {
+    return 2*npts;
+    }
+  return (npts < 3 ? 0 : 3*(npts - 2));
+}
+
+// Find the start of each chunk of cells, and the number of indices written
+// before it.  The last entries are the end of the cells and the total.
+// Returns false if the number of indices cannot be known in advance, which
+// is the case for triangles from polygons with more than six points.
+bool SplitIndexBuffer(vtkCellArray *cells, int mode,
+                      std::vector<vtkIdType> &locations,
+                      std::vector<size_t> &offsets)
+{
+  const vtkIdType *connectivity = cells->GetPointer();
+  vtkIdType size = cells->GetNumberOfConnectivityEntries();
+  vtkIdType numChunks =
+    (cells->GetNumberOfCells() + IndexBufferChunkSize - 1)/
+    IndexBufferChunkSize;
+  locations.reserve(numChunks + 1);
+  offsets.reserve(numChunks + 1);
+
+  size_t count = 0;
+  vtkIdType cellId = 0;
+  for (vtkIdType loc = 0; loc < size; loc += connectivity[loc] + 1)
+    {
+    if (mode == TriangleIndices && connectivity[loc] > 6)
+      {
+      return false;
+      }
+    if (cellId++ % IndexBufferChunkSize == 0)
+      {
+      locations.push_back(loc);
+      offsets.push_back(count);
+      }
+    count += IndexBufferCount(mode, connectivity[loc]);
+    }
+  locations.push_back(size);
+  offsets.push_back(count);
+  return true;
+}
+
+// Fills the indices of a range of chunks of cells.
+class AppendIndexBufferFunctor
+{
+public:
+  const vtkIdType *Connectivity;
+  const vtkIdType *Locations;
+  const size_t *Offsets;
+  unsigned int *Output;
+  vtkIdType VertexOffset;
+  int Mode;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    vtkIdType vOffset = this->VertexOffset;
+    for (vtkIdType chunk = begin; chunk < end; ++chunk)
+      {
+      unsigned int *out = this->Output + this->Offsets[chunk];
+      for (vtkIdType loc = this->Locations[chunk];
+           loc < this->Locations[chunk + 1];
+           loc += this->Connectivity[loc] + 1)
+        {
+        vtkIdType npts = this->Connectivity[loc];
+        const vtkIdType *indices = this->Connectivity + loc + 1;
+        if (this->Mode == PointIndices)
+          {
+          for (vtkIdType i = 0; i < npts; ++i)
+            {
+            *(out++) = static_cast<unsigned int>(indices[i]+vOffset);
+            }
+          }
+        else if (this->Mode == LineIndices)
+          {
+          for (vtkIdType i = 0; i < npts; ++i)
+            {
+            *(out++) = static_cast<unsigned int>(indices[i]+vOffset);
+            *(out++) = static_cast<unsigned int>(
+              indices[i < npts-1 ? i+1 : 0] + vOffset);
+            }
+          }
+        else if (npts == 6)
+          {
+          // hexagons are split the same way as by the serial code
+          static const int hexagon[12] = { 0, 1, 2, 0, 2, 3, 0, 3, 5,
+                                           3, 4, 5 };
+          for (int i = 0; i < 12; ++i)
+            {
+            *(out++) = static_cast<unsigned int>(indices[hexagon[i]]+vOffset);
+            }
+          }
+        else
+          {
+          // triangles, and fans for quads and pentagons
+          for (vtkIdType i = 2; i < npts; ++i)
+            {
+            *(out++) = static_cast<unsigned int>(indices[0]+vOffset);
+            *(out++) = static_cast<unsigned int>(indices[i-1]+vOffset);
+            *(out++) = static_cast<unsigned int>(indices[i]+vOffset);
+            }
+          }
+        }
+      }
+  }
+};
+
+// Append the indices of the cells to indexArray in parallel, returns false
+// if the cells must be done serially.
+bool AppendIndexBufferInParallel(
+  std::vector<unsigned int> &indexArray,
+  vtkCellArray *cells,
+  vtkIdType vOffset, int mode)
+{
+  std::vector<vtkIdType> locations;
+  std::vector<size_t> offsets;
+  if (!SplitIndexBuffer(cells, mode, locations, offsets))
+    {
+    return false;
+    }
+
+  size_t oldSize = indexArray.size();
+  indexArray.resize(oldSize + offsets.back());
+  if (offsets.back() == 0)
+    {
+    return true;
+    }
+
+  AppendIndexBufferFunctor functor;
+  functor.Connectivity = cells->GetPointer();
+  functor.Locations = &locations[0];
+  functor.Offsets = &offsets[0];
+  functor.Output = &indexArray[oldSize];
+  functor.VertexOffset = vOffset;
+  functor.Mode = mode;
+  vtkSMPTools::For(0, static_cast<vtkIdType>(locations.size() - 1), functor);
+  return true;
+}
+
 // used to create an IBO for triangle primatives
 void AppendTriangleIndexBuffer(
   std::vector<unsigned int> &indexArray,
@@ -321,6 +779,13 @@ void AppendTriangleIndexBuffer(
     indexArray.reserve(targetSize);
     }
 
+  // only polygons with more than six points have to be done serially
+  if (AppendIndexBufferInParallel(indexArray, cells, vOffset,
+                                  TriangleIndices))
+    {
+    return;
+    }
+
   // the folowing are only used if we have to triangulate a polygon
   // otherwise they just sit at NULL
   vtkPolygon *polygon = NULL;
@@ -442,8 +907,6 @@ void AppendPointIndexBuffer(
   vtkCellArray *cells,
   vtkIdType vOffset)
 {
-  vtkIdType* indices(NULL);
-  vtkIdType npts(0);
   size_t targetSize = indexArray.size() +
     cells->GetNumberOfConnectivityEntries() -
     cells->GetNumberOfCells();
@@ -456,13 +919,7 @@ void AppendPointIndexBuffer(
     indexArray.reserve(targetSize);
     }
 
-  for (cells->InitTraversal(); cells->GetNextCell(npts, indices); )
-    {
-    for (int i = 0; i < npts; ++i)
-      {
-      indexArray.push_back(static_cast<unsigned int>(*(indices++)+vOffset));
-      }
-    }
+  AppendIndexBufferInParallel(indexArray, cells, vOffset, PointIndices);
 }
 
 // used to create an IBO for triangle primatives
@@ -489,8 +946,6 @@ void AppendTriangleLineIndexBuffer(
   vtkCellArray *cells,
   vtkIdType vOffset)
 {
-  vtkIdType* indices(NULL);
-  vtkIdType npts(0);
   size_t targetSize = indexArray.size() + 2*(
     cells->GetNumberOfConnectivityEntries() -
     cells->GetNumberOfCells());
@@ -503,15 +958,7 @@ void AppendTriangleLineIndexBuffer(
     indexArray.reserve(targetSize);
     }
 
-  for (cells->InitTraversal(); cells->GetNextCell(npts, indices); )
-    {
-    for (int i = 0; i < npts; ++i)
-      {
-      indexArray.push_back(static_cast<unsigned int>(indices[i]+vOffset));
-      indexArray.push_back(static_cast<unsigned int>(
-        indices[i < npts-1 ? i+1 : 0] + vOffset));
-      }
-    }
+  AppendIndexBufferInParallel(indexArray, cells, vOffset, LineIndices);
 }
 
 // used to create an IBO for primatives as lines.  This method treats each line segment
@@ -654,6 +1101,8 @@ void CreateCellSupportArrays(vtkPolyData *poly, vtkCellArray *prims[4],
   for (int primType = 0; primType < 4; primType++)
     {
     newPrims[primType] = vtkCellArray::New();
+    newPrims[primType]->Allocate(
+      prims[primType]->GetNumberOfConnectivityEntries());
     for (prims[primType]->InitTraversal(); prims[primType]->GetNextCell(npts, indices); )
       {
       newPrims[primType]->InsertNextCell(npts);
@@ -49,8 +49,9 @@ size_t CreateTriangleIndexBuffer(vtkCellArray *cells,
   BufferObject &indexBuffer,
   vtkPoints *points, std::vector<unsigned int> &cellPointMap);
 
-// used to create an IBO for triangle primatives
-void AppendTriangleIndexBuffer(
+// used to create an IBO for triangle primatives, polygons with more than
+// six points are triangulated serially and everything else in parallel
+void VTKRENDERINGOPENGL2_EXPORT AppendTriangleIndexBuffer(
   std::vector<unsigned int> &indexArray,
   vtkCellArray *cells,
   vtkPoints *points,
@@ -62,7 +63,7 @@ size_t CreateTriangleLineIndexBuffer(vtkCellArray *cells,
   BufferObject &indexBuffer);
 
 // create a IBO for wireframe polys/tris
-void AppendTriangleLineIndexBuffer(
+void VTKRENDERINGOPENGL2_EXPORT AppendTriangleLineIndexBuffer(
   std::vector<unsigned int> &indexArray,
   vtkCellArray *cells,
   vtkIdType vertexOffset);
@@ -71,7 +72,7 @@ void AppendTriangleLineIndexBuffer(
 size_t CreatePointIndexBuffer(vtkCellArray *cells, BufferObject &indexBuffer);
 
 // used to create an IBO for primatives as points
-void AppendPointIndexBuffer(
+void VTKRENDERINGOPENGL2_EXPORT AppendPointIndexBuffer(
   std::vector<unsigned int> &indexArray,
   vtkCellArray *cells,
   vtkIdType vertexOffset);
@@ -117,13 +118,41 @@ struct VBOLayout
   int TCoordComponents; // Number of texture dimensions
   int ColorOffset;  // Offset of the color
   int ColorComponents; // Number of color components
+  bool Split; // Each attribute is tightly packed in its own range
   std::vector<float> PackedVBO; // the data
+
+  VBOLayout() : VertexCount(0), Stride(0), VertexOffset(0), NormalOffset(0),
+    TCoordOffset(0), TCoordComponents(0), ColorOffset(0),
+    ColorComponents(0), Split(false) {}
+
+  // The stride of each attribute, which is Stride unless the layout is split.
+  int GetVertexStride() const
+    { return this->Split ? 3*sizeof(float) : this->Stride; }
+  int GetNormalStride() const
+    { return this->Split ? 3*sizeof(float) : this->Stride; }
+  int GetTCoordStride() const
+    {
+    return this->Split ?
+      this->TCoordComponents*static_cast<int>(sizeof(float)) : this->Stride;
+    }
+  int GetColorStride() const
+    { return this->Split ? 4 : this->Stride; }
+};
+
+// The attributes of a split VBO, in the order they are stored in.
+enum VBOStream
+{
+  VertexStream = 0,
+  NormalStream,
+  TCoordStream,
+  ColorStream
 };
 
 // Take the points, and pack them into the VBO object supplied. This currently
 // takes whatever the input type might be and packs them into a VBO using
 // floats for the vertices and normals, and unsigned char for the colors (if
-// the array is non-null).
+// the array is non-null).  The points are packed in parallel with
+// vtkSMPTools, as are the index buffers built by the functions above.
 VBOLayout CreateVBO(vtkPoints *points, unsigned int numPoints,
     vtkDataArray *normals,
     vtkDataArray *tcoords,
@@ -131,7 +160,34 @@ VBOLayout CreateVBO(vtkPoints *points, unsigned int numPoints,
     BufferObject &vertexBuffer,
     unsigned int *cellPointMap, unsigned int *pointCellMap,
     bool cellScalars, bool cellNormals);
-void AppendVBO(VBOLayout &layout, vtkPoints *points, unsigned int numPoints,
+
+// Same as CreateVBO, but the VBO holds each attribute in its own range, one
+// after the other in the order of VBOStream, instead of interleaving them.
+// This lets UpdateSplitVBO replace one attribute without uploading the
+// others.
+VBOLayout CreateSplitVBO(vtkPoints *points, unsigned int numPoints,
+    vtkDataArray *normals,
+    vtkDataArray *tcoords,
+    unsigned char *colors, int colorComponents,
+    BufferObject &vertexBuffer,
+    unsigned int *cellPointMap, unsigned int *pointCellMap,
+    bool cellScalars, bool cellNormals);
+
+// Pack one attribute of a VBO made by CreateSplitVBO and upload it in place.
+// The arguments are those given to CreateSplitVBO, with the new values of
+// the attribute. Returns false, uploading nothing, if the VBO was not made
+// with that attribute or with the same number of vertices and components.
+bool UpdateSplitVBO(VBOLayout &layout, VBOStream stream,
+    vtkPoints *points, unsigned int numPoints,
+    vtkDataArray *normals,
+    vtkDataArray *tcoords,
+    unsigned char *colors, int colorComponents,
+    BufferObject &vertexBuffer,
+    unsigned int *cellPointMap, unsigned int *pointCellMap,
+    bool cellScalars, bool cellNormals);
+
+void VTKRENDERINGOPENGL2_EXPORT AppendVBO(VBOLayout &layout,
+    vtkPoints *points, unsigned int numPoints,
     vtkDataArray *normals,
     vtkDataArray *tcoords,
     unsigned char *colors, int colorComponents,
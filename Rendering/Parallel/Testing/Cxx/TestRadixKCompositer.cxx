@@ -0,0 +1,162 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestRadixKCompositer.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Composites synthetic images with vtkRadixKCompositer for several radices,
+// on all the processes and on a subset of them, and checks the result on
+// process 0 against the nearest pixel of all the images.  Also checks that
+// a single process, with a vtkDummyController, leaves the image unchanged.
+
+#include "vtkDummyController.h"
+#include "vtkFloatArray.h"
+#include "vtkMPIController.h"
+#include "vtkNew.h"
+#include "vtkRadixKCompositer.h"
+#include "vtkUnsignedCharArray.h"
+
+namespace
+{
+
+const int ImageWidth = 97;
+const int ImageHeight = 61;
+
+// The depth of each process at each pixel, 1.0 where it draws nothing.
+// Process 1 draws nothing at all, and no two processes draw at the same
+// depth.
+double PixelDepth(int proc, int x, int y)
+{
+  if (proc == 1 || x < proc*7 || x >= proc*7 + 40 || y % (proc + 2) == 0)
+    {
+    return 1.0;
+    }
+  return ((x*7 + y*13 + proc*29) % 97)/100.0 + proc*1e-4;
+}
+
+void FillImage(int proc, vtkDataArray *pixels, vtkFloatArray *depths)
+{
+  pixels->SetNumberOfComponents(4);
+  pixels->SetNumberOfTuples(ImageWidth*ImageHeight);
+  depths->SetNumberOfTuples(ImageWidth*ImageHeight);
+  for (int y = 0; y < ImageHeight; ++y)
+    {
+    for (int x = 0; x < ImageWidth; ++x)
+      {
+      int i = y*ImageWidth + x;
+      double depth = PixelDepth(proc, x, y);
+      depths->SetValue(i, static_cast<float>(depth));
+      if (depth < 1.0)
+        {
+        pixels->SetTuple4(i, proc*20, x, y, 255);
+        }
+      else
+        {
+        pixels->SetTuple4(i, 0, 0, 0, 255);
+        }
+      }
+    }
+}
+
+int CheckImage(int numProcs, vtkDataArray *pixels, vtkFloatArray *depths)
+{
+  for (int y = 0; y < ImageHeight; ++y)
+    {
+    for (int x = 0; x < ImageWidth; ++x)
+      {
+      int i = y*ImageWidth + x;
+      int nearest = 0;
+      for (int proc = 1; proc < numProcs; ++proc)
+        {
+        if (PixelDepth(proc, x, y) < PixelDepth(nearest, x, y))
+          {
+          nearest = proc;
+          }
+        }
+      double depth = PixelDepth(nearest, x, y);
+      double color = (depth < 1.0 ? nearest*20 : 0);
+      if (depths->GetValue(i) != static_cast<float>(depth) ||
+          pixels->GetComponent(i, 0) != color)
+        {
+        cerr << "Pixel (" << x << ", " << y << ") has depth "
+             << depths->GetValue(i) << " and red " << pixels->GetComponent(i, 0)
+             << " instead of " << depth << " and " << color << endl;
+        return 1;
+        }
+      }
+    }
+  return 0;
+}
+
+int Composite(vtkMultiProcessController *controller, int numProcs,
+              int radix, vtkDataArray *pixels, vtkDataArray *pTmp)
+{
+  int myId = controller->GetLocalProcessId();
+  vtkNew<vtkFloatArray> depths;
+  vtkNew<vtkFloatArray> zTmp;
+  FillImage(myId, pixels, depths.GetPointer());
+
+  vtkNew<vtkRadixKCompositer> compositer;
+  compositer->SetController(controller);
+  compositer->SetNumberOfProcesses(numProcs);
+  compositer->SetRadix(radix);
+  compositer->CompositeBuffer(pixels, depths.GetPointer(), pTmp,
+                              zTmp.GetPointer());
+
+  if (myId != 0)
+    {
+    return 0;
+    }
+  cout << numProcs << " processes, radix " << radix << ", "
+       << compositer->GetBytesSent() << " bytes sent by process 0" << endl;
+  return CheckImage(numProcs, pixels, depths.GetPointer());
+}
+
+}
+
+int TestRadixKCompositer(int argc, char *argv[])
+{
+  vtkNew<vtkMPIController> controller;
+  controller->Initialize(&argc, &argv);
+  int myId = controller->GetLocalProcessId();
+  int numProcs = controller->GetNumberOfProcesses();
+  int rval = 0;
+
+  if (myId == 0)
+    {
+    vtkNew<vtkDummyController> dummy;
+    vtkNew<vtkUnsignedCharArray> pixels;
+    vtkNew<vtkUnsignedCharArray> pTmp;
+    rval |= Composite(dummy.GetPointer(), 1, 2, pixels.GetPointer(),
+                      pTmp.GetPointer());
+    }
+
+  int radices[3] = { 2, 4, 8 };
+  for (int r = 0; r < 3; ++r)
+    {
+    for (int n = 2; n <= numProcs; ++n)
+      {
+      vtkNew<vtkUnsignedCharArray> pixels;
+      vtkNew<vtkUnsignedCharArray> pTmp;
+      rval |= Composite(controller.GetPointer(), n, radices[r],
+                        pixels.GetPointer(), pTmp.GetPointer());
+      }
+    }
+
+  vtkNew<vtkFloatArray> pixels;
+  vtkNew<vtkFloatArray> pTmp;
+  rval |= Composite(controller.GetPointer(), numProcs, 2,
+                    pixels.GetPointer(), pTmp.GetPointer());
+
+  controller->Broadcast(&rval, 1, 0);
+  controller->Finalize();
+  return rval;
+}
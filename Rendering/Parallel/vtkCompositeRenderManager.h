@@ -38,7 +38,8 @@ public:
   virtual void PrintSelf(ostream &os, vtkIndent indent);
 
   // Description:
-  // Set/Get the composite algorithm.
+  // Set/Get the composite algorithm.  vtkCompressCompositer is used by
+  // default, vtkRadixKCompositer scales better to many processes.
   void SetCompositer(vtkCompositer *c);
   vtkGetObjectMacro(Compositer, vtkCompositer);
 
@@ -34,7 +34,8 @@ public:
   void PrintSelf(ostream& os, vtkIndent indent);
 
   // Description:
-  // Get/Set the composite. vtkTreeCompositer is used by default.
+  // Get/Set the composite. vtkTreeCompositer is used by default,
+  // vtkRadixKCompositer scales better to many processes.
   void SetCompositer(vtkCompositer*);
   vtkGetObjectMacro(Compositer, vtkCompositer);
 
@@ -0,0 +1,350 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkRadixKCompositer.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkRadixKCompositer.h"
+#include "vtkObjectFactory.h"
+#include "vtkFloatArray.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkMultiProcessController.h"
+
+#include <string.h>
+
+vtkStandardNewMacro(vtkRadixKCompositer);
+
+//-------------------------------------------------------------------------
+// The largest power of two that is not above n.
+static int vtkRadixKCompositerPow2(int n)
+{
+  int p = 1;
+  while (2*p <= n)
+    {
+    p *= 2;
+    }
+  return p;
+}
+
+//-------------------------------------------------------------------------
+// The start of part i of the n parts of the region of the given length.
+static vtkIdType vtkRadixKCompositerSplit(vtkIdType begin, vtkIdType length,
+                                          int i, int n)
+{
+  return begin + static_cast<vtkIdType>(
+    static_cast<vtkTypeInt64>(length)*i/n);
+}
+
+//-------------------------------------------------------------------------
+// Encode the active pixels of [begin, end), the ones in front of the far
+// plane, as runs.  The buffer holds the number of runs and of active
+// pixels, then a (skipped, active) pair of counts for each run, then the
+// depths and the colors of the active pixels.
+static void vtkRadixKCompositerEncode(const float *depths,
+                                      const unsigned char *pixels,
+                                      int pixelSize,
+                                      vtkIdType begin, vtkIdType end,
+                                      vtkUnsignedCharArray *buffer)
+{
+  vtkIdType numRuns = 0;
+  vtkIdType numActive = 0;
+  bool inRun = false;
+  vtkIdType i;
+  for (i = begin; i < end; ++i)
+    {
+    if (depths[i] < 1.0f)
+      {
+      numRuns += (inRun ? 0 : 1);
+      ++numActive;
+      inRun = true;
+      }
+    else
+      {
+      inRun = false;
+      }
+    }
+
+  vtkIdType size = (2 + 2*numRuns)*sizeof(vtkIdType) +
+    numActive*(sizeof(float) + pixelSize);
+  vtkCompositer::ResizeUnsignedCharArray(buffer, 1, size);
+  vtkIdType *runs = reinterpret_cast<vtkIdType*>(buffer->GetPointer(0));
+  *runs++ = numRuns;
+  *runs++ = numActive;
+  float *z = reinterpret_cast<float*>(runs + 2*numRuns);
+  unsigned char *p = reinterpret_cast<unsigned char*>(z + numActive);
+
+  vtkIdType last = begin;
+  i = begin;
+  while (i < end)
+    {
+    if (depths[i] >= 1.0f)
+      {
+      ++i;
+      continue;
+      }
+    vtkIdType start = i;
+    while (i < end && depths[i] < 1.0f)
+      {
+      ++i;
+      }
+    *runs++ = start - last;
+    *runs++ = i - start;
+    memcpy(z, depths + start, (i - start)*sizeof(float));
+    memcpy(p, pixels + start*pixelSize, (i - start)*pixelSize);
+    z += i - start;
+    p += (i - start)*pixelSize;
+    last = i;
+    }
+}
+
+//-------------------------------------------------------------------------
+// Depth composite the encoded pixels into [begin, end), or copy them over
+// the local ones when replace is set.  Returns false if the buffer does
+// not fit the region.
+static bool vtkRadixKCompositerDecode(const unsigned char *buffer,
+                                      vtkIdType size, float *depths,
+                                      unsigned char *pixels, int pixelSize,
+                                      vtkIdType begin, vtkIdType end,
+                                      bool replace)
+{
+  const vtkIdType *runs = reinterpret_cast<const vtkIdType*>(buffer);
+  if (size < static_cast<vtkIdType>(2*sizeof(vtkIdType)))
+    {
+    return false;
+    }
+  vtkIdType numRuns = *runs++;
+  vtkIdType numActive = *runs++;
+  if (numRuns < 0 || numActive < 0 || size !=
+      static_cast<vtkIdType>((2 + 2*numRuns)*sizeof(vtkIdType) +
+                             numActive*(sizeof(float) + pixelSize)))
+    {
+    return false;
+    }
+  const float *z = reinterpret_cast<const float*>(runs + 2*numRuns);
+  const unsigned char *p = reinterpret_cast<const unsigned char*>(
+    z + numActive);
+
+  vtkIdType i = begin;
+  for (vtkIdType run = 0; run < numRuns; ++run)
+    {
+    i += *runs++;
+    vtkIdType count = *runs++;
+    if (i < begin || count < 0 || i + count > end)
+      {
+      return false;
+      }
+    if (replace)
+      {
+      memcpy(depths + i, z, count*sizeof(float));
+      memcpy(pixels + i*pixelSize, p, count*pixelSize);
+      z += count;
+      p += count*pixelSize;
+      i += count;
+      continue;
+      }
+    for (vtkIdType j = 0; j < count; ++j, ++i, ++z, p += pixelSize)
+      {
+      if (*z < depths[i])
+        {
+        depths[i] = *z;
+        memcpy(pixels + i*pixelSize, p, pixelSize);
+        }
+      }
+    }
+  return true;
+}
+
+//-------------------------------------------------------------------------
+vtkRadixKCompositer::vtkRadixKCompositer()
+{
+  this->Radix = 2;
+  this->BytesSent = 0;
+  this->SendBuffer = vtkUnsignedCharArray::New();
+  this->ReceiveBuffer = vtkUnsignedCharArray::New();
+}
+
+//-------------------------------------------------------------------------
+vtkRadixKCompositer::~vtkRadixKCompositer()
+{
+  vtkCompositer::DeleteArray(this->SendBuffer);
+  vtkCompositer::DeleteArray(this->ReceiveBuffer);
+}
+
+//-------------------------------------------------------------------------
+void vtkRadixKCompositer::ComputeRegion(int id, int numProcs, int radix,
+                                        vtkIdType numPixels,
+                                        vtkIdType &begin, vtkIdType &end)
+{
+  int numActive = vtkRadixKCompositerPow2(numProcs);
+  radix = vtkRadixKCompositerPow2(radix < 2 ? 2 : radix);
+  begin = 0;
+  end = (id < numActive ? numPixels : 0);
+  for (int stride = 1; stride < numActive && id < numActive; )
+    {
+    int groupSize = (radix < numActive/stride ? radix : numActive/stride);
+    int member = (id/stride) % groupSize;
+    vtkIdType length = end - begin;
+    end = vtkRadixKCompositerSplit(begin, length, member + 1, groupSize);
+    begin = vtkRadixKCompositerSplit(begin, length, member, groupSize);
+    stride *= groupSize;
+    }
+}
+
+//-------------------------------------------------------------------------
+void vtkRadixKCompositer::SendRegion(vtkDataArray *pBuf, vtkFloatArray *zBuf,
+                                     vtkIdType begin, vtkIdType end,
+                                     int remoteId)
+{
+  int pixelSize = pBuf->GetNumberOfComponents()*pBuf->GetDataTypeSize();
+  vtkRadixKCompositerEncode(
+    zBuf->GetPointer(0),
+    static_cast<unsigned char*>(pBuf->GetVoidPointer(0)),
+    pixelSize, begin, end, this->SendBuffer);
+
+  vtkIdType size = this->SendBuffer->GetNumberOfTuples();
+  this->Controller->Send(&size, 1, remoteId, REGION_SIZE_TAG);
+  this->Controller->Send(this->SendBuffer->GetPointer(0), size, remoteId,
+                         REGION_DATA_TAG);
+  this->BytesSent += size;
+}
+
+//-------------------------------------------------------------------------
+void vtkRadixKCompositer::ReceiveRegion(vtkDataArray *pBuf,
+                                        vtkFloatArray *zBuf,
+                                        vtkIdType begin, vtkIdType end,
+                                        int remoteId, bool replace)
+{
+  vtkIdType size = 0;
+  this->Controller->Receive(&size, 1, remoteId, REGION_SIZE_TAG);
+  vtkCompositer::ResizeUnsignedCharArray(this->ReceiveBuffer, 1, size);
+  this->Controller->Receive(this->ReceiveBuffer->GetPointer(0), size,
+                            remoteId, REGION_DATA_TAG);
+
+  int pixelSize = pBuf->GetNumberOfComponents()*pBuf->GetDataTypeSize();
+  if (!vtkRadixKCompositerDecode(
+        this->ReceiveBuffer->GetPointer(0), size, zBuf->GetPointer(0),
+        static_cast<unsigned char*>(pBuf->GetVoidPointer(0)), pixelSize,
+        begin, end, replace))
+    {
+    vtkErrorMacro("Corrupt image region received from process "
+                  << remoteId << ".");
+    }
+}
+
+//-------------------------------------------------------------------------
+void vtkRadixKCompositer::CompositeBuffer(vtkDataArray *pBuf,
+                                          vtkFloatArray *zBuf,
+                                          vtkDataArray *pTmp,
+                                          vtkFloatArray *zTmp)
+{
+  // The pixels are composited in place, no temporary image is needed.
+  (void)pTmp;
+  (void)zTmp;
+
+  this->BytesSent = 0;
+  int numProcs = this->NumberOfProcesses;
+  if (this->Controller == NULL || numProcs <= 1)
+    {
+    return;
+    }
+  int myId = this->Controller->GetLocalProcessId();
+  if (myId >= numProcs)
+    {
+    return;
+    }
+  if (pBuf->GetNumberOfTuples() != zBuf->GetNumberOfTuples() ||
+      (pBuf->GetDataType() != VTK_UNSIGNED_CHAR &&
+       pBuf->GetDataType() != VTK_FLOAT))
+    {
+    vtkErrorMacro("Unexpected pixel type or number of pixels.");
+    return;
+    }
+
+  vtkIdType numPixels = zBuf->GetNumberOfTuples();
+  int numActive = vtkRadixKCompositerPow2(numProcs);
+  int radix = vtkRadixKCompositerPow2(this->Radix);
+
+  // The processes past the largest power of two hand their image over.
+  if (myId >= numActive)
+    {
+    this->SendRegion(pBuf, zBuf, 0, numPixels, myId - numActive);
+    return;
+    }
+  if (myId + numActive < numProcs)
+    {
+    this->ReceiveRegion(pBuf, zBuf, 0, numPixels, myId + numActive, false);
+    }
+
+  // At each round, the members of a group differ by one digit in base
+  // groupSize of their id, and all own the same region.
+  vtkIdType begin = 0;
+  vtkIdType end = numPixels;
+  for (int stride = 1; stride < numActive; )
+    {
+    int groupSize = (radix < numActive/stride ? radix : numActive/stride);
+    int member = (myId/stride) % groupSize;
+    int first = myId - member*stride;
+    vtkIdType length = end - begin;
+    vtkIdType myBegin =
+      vtkRadixKCompositerSplit(begin, length, member, groupSize);
+    vtkIdType myEnd =
+      vtkRadixKCompositerSplit(begin, length, member + 1, groupSize);
+
+    // Pairing the members by xor matches all of them at each step, and
+    // the lower one of each pair sends first so that blocking sends do
+    // not deadlock.
+    for (int step = 1; step < groupSize; ++step)
+      {
+      int other = member ^ step;
+      int otherId = first + other*stride;
+      vtkIdType otherBegin =
+        vtkRadixKCompositerSplit(begin, length, other, groupSize);
+      vtkIdType otherEnd =
+        vtkRadixKCompositerSplit(begin, length, other + 1, groupSize);
+      if (member < other)
+        {
+        this->SendRegion(pBuf, zBuf, otherBegin, otherEnd, otherId);
+        this->ReceiveRegion(pBuf, zBuf, myBegin, myEnd, otherId, false);
+        }
+      else
+        {
+        this->ReceiveRegion(pBuf, zBuf, myBegin, myEnd, otherId, false);
+        this->SendRegion(pBuf, zBuf, otherBegin, otherEnd, otherId);
+        }
+      }
+
+    begin = myBegin;
+    end = myEnd;
+    stride *= groupSize;
+    }
+
+  // Gather the regions on process 0.
+  if (myId != 0)
+    {
+    this->SendRegion(pBuf, zBuf, begin, end, 0);
+    return;
+    }
+  for (int id = 1; id < numActive; ++id)
+    {
+    vtkRadixKCompositer::ComputeRegion(id, numProcs, radix, numPixels,
+                                       begin, end);
+    this->ReceiveRegion(pBuf, zBuf, begin, end, id, true);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkRadixKCompositer::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Radix: " << this->Radix << endl;
+  os << indent << "BytesSent: " << this->BytesSent << endl;
+}
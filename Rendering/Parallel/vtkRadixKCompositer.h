@@ -0,0 +1,106 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkRadixKCompositer.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkRadixKCompositer - Implements radix-k and binary swap compositing.
+//
+// .SECTION Description
+// vtkRadixKCompositer composites the color and depth buffers of all the
+// processes so that every process works at every round, unlike the tree
+// based compositers.  At each round the processes are split in groups of
+// Radix processes, each member of a group takes a part of the image region
+// the group shares, sends the other parts to the other members and depth
+// composites the parts it receives.  After the last round each process
+// owns a distinct part of the image, and the parts are gathered on
+// process 0.  A Radix of 2 is binary swap.
+//
+// When the number of processes is not a power of two, the processes past
+// the largest power of two first send their image to a process below it
+// and take no further part.
+//
+// The images are sent with a run length encoding of the active pixels, the
+// pixels whose depth is less than 1.0, so that the background costs
+// nothing to send or to composite.  It will not handle transparency.
+//
+// .SECTION See Also
+// vtkCompositer vtkCompressCompositer vtkTreeCompositer
+
+#ifndef vtkRadixKCompositer_h
+#define vtkRadixKCompositer_h
+
+#include "vtkRenderingParallelModule.h" // For export macro
+#include "vtkCompositer.h"
+
+class vtkUnsignedCharArray;
+
+class VTKRENDERINGPARALLEL_EXPORT vtkRadixKCompositer : public vtkCompositer
+{
+public:
+  static vtkRadixKCompositer *New();
+  vtkTypeMacro(vtkRadixKCompositer,vtkCompositer);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  virtual void CompositeBuffer(vtkDataArray *pBuf, vtkFloatArray *zBuf,
+                               vtkDataArray *pTmp, vtkFloatArray *zTmp);
+
+  // Description:
+  // The number of processes in a group at each round, rounded down to a
+  // power of two.  2 is binary swap, the default, while larger values
+  // take fewer rounds with more messages each.
+  vtkSetClampMacro(Radix, int, 2, 64);
+  vtkGetMacro(Radix, int);
+
+  // Description:
+  // The number of bytes this process sent during the last composite.
+  vtkGetMacro(BytesSent, vtkIdType);
+
+  // Description:
+  // The part of the image of numPixels pixels that process id owns after
+  // the last round, when numProcs processes composite with the given
+  // radix.  It is empty for the processes that take no part in the rounds.
+  static void ComputeRegion(int id, int numProcs, int radix,
+                            vtkIdType numPixels,
+                            vtkIdType &begin, vtkIdType &end);
+
+protected:
+  vtkRadixKCompositer();
+  ~vtkRadixKCompositer();
+
+  // Description:
+  // Send the pixels in [begin, end) encoded, or receive pixels encoded the
+  // same way and depth composite them, or copy them over the local ones
+  // when replace is set.
+  void SendRegion(vtkDataArray *pBuf, vtkFloatArray *zBuf,
+                  vtkIdType begin, vtkIdType end, int remoteId);
+  void ReceiveRegion(vtkDataArray *pBuf, vtkFloatArray *zBuf,
+                     vtkIdType begin, vtkIdType end, int remoteId,
+                     bool replace);
+
+  enum
+    {
+    REGION_SIZE_TAG = 15201,
+    REGION_DATA_TAG = 15202
+    };
+
+  int Radix;
+  vtkIdType BytesSent;
+
+  vtkUnsignedCharArray *SendBuffer;
+  vtkUnsignedCharArray *ReceiveBuffer;
+
+private:
+  vtkRadixKCompositer(const vtkRadixKCompositer&); // Not implemented
+  void operator=(const vtkRadixKCompositer&); // Not implemented
+};
+
+#endif
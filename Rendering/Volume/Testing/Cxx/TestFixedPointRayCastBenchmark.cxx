@@ -0,0 +1,201 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestFixedPointRayCastBenchmark.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Benchmarks the render times of vtkFixedPointVolumeRayCastMapper for each
+// of its helpers, on one thread and on the default number of threads (at
+// least two), and checks that the ray cast image does not depend on the
+// number of threads.
+
+#include "vtkCamera.h"
+#include "vtkColorTransferFunction.h"
+#include "vtkFixedPointRayCastImage.h"
+#include "vtkFixedPointVolumeRayCastMapper.h"
+#include "vtkImageShiftScale.h"
+#include "vtkNew.h"
+#include "vtkPiecewiseFunction.h"
+#include "vtkRTAnalyticSource.h"
+#include "vtkRenderWindow.h"
+#include "vtkRenderer.h"
+#include "vtkTimerLog.h"
+#include "vtkVolume.h"
+#include "vtkVolumeProperty.h"
+
+#include <vector>
+
+namespace
+{
+
+struct BenchmarkCase
+{
+  const char *Name;
+  int UnsignedChar;
+  int Interpolation;
+  int Shade;
+  int GradientOpacity;
+  int BlendMode;
+};
+
+const BenchmarkCase Cases[] =
+{
+  { "Composite nearest",             0, VTK_NEAREST_INTERPOLATION, 0, 0,
+    vtkVolumeMapper::COMPOSITE_BLEND },
+  { "Composite linear",              0, VTK_LINEAR_INTERPOLATION,  0, 0,
+    vtkVolumeMapper::COMPOSITE_BLEND },
+  { "Composite simple nearest",      1, VTK_NEAREST_INTERPOLATION, 0, 0,
+    vtkVolumeMapper::COMPOSITE_BLEND },
+  { "Composite simple linear",       1, VTK_LINEAR_INTERPOLATION,  0, 0,
+    vtkVolumeMapper::COMPOSITE_BLEND },
+  { "Composite shade",               0, VTK_LINEAR_INTERPOLATION,  1, 0,
+    vtkVolumeMapper::COMPOSITE_BLEND },
+  { "Composite gradient opacity",    0, VTK_LINEAR_INTERPOLATION,  0, 1,
+    vtkVolumeMapper::COMPOSITE_BLEND },
+  { "Composite gradient opacity shade",
+                                     0, VTK_LINEAR_INTERPOLATION,  1, 1,
+    vtkVolumeMapper::COMPOSITE_BLEND },
+  { "Maximum intensity",             0, VTK_LINEAR_INTERPOLATION,  0, 0,
+    vtkVolumeMapper::MAXIMUM_INTENSITY_BLEND },
+  { "Minimum intensity",             0, VTK_LINEAR_INTERPOLATION,  0, 0,
+    vtkVolumeMapper::MINIMUM_INTENSITY_BLEND }
+};
+
+// Copies the part of the ray cast image in use, row by row.
+void GetImage(vtkFixedPointVolumeRayCastMapper *mapper,
+              std::vector<unsigned short> &pixels)
+{
+  vtkFixedPointRayCastImage *image = mapper->GetRayCastImage();
+  int *inUse = image->GetImageInUseSize();
+  int *memory = image->GetImageMemorySize();
+  pixels.clear();
+  for (int j = 0; j < inUse[1]; ++j)
+    {
+    unsigned short *row = image->GetImage() + 4*j*memory[0];
+    pixels.insert(pixels.end(), row, row + 4*inUse[0]);
+    }
+}
+
+}
+
+int TestFixedPointRayCastBenchmark(int, char *[])
+{
+  cout << "CTEST_FULL_OUTPUT (Avoid ctest truncation of output)" << endl;
+
+  vtkNew<vtkRTAnalyticSource> wavelet;
+  wavelet->SetWholeExtent(-63, 64, -63, 64, -63, 64);
+  wavelet->SetCenter(0.0, 0.0, 0.0);
+  vtkNew<vtkImageShiftScale> toUnsignedChar;
+  toUnsignedChar->SetInputConnection(wavelet->GetOutputPort());
+  toUnsignedChar->SetShift(-37.3531);
+  toUnsignedChar->SetScale(255.0 / (276.829 - 37.3531));
+  toUnsignedChar->SetOutputScalarTypeToUnsignedChar();
+  toUnsignedChar->ClampOverflowOn();
+
+  vtkNew<vtkFixedPointVolumeRayCastMapper> volumeMapper;
+  volumeMapper->AutoAdjustSampleDistancesOff();
+  volumeMapper->IntermixIntersectingGeometryOff();
+  // at least two threads, so that the images are compared on one core too
+  int numThreads = volumeMapper->GetNumberOfThreads();
+  numThreads = (numThreads < 2 ? 2 : numThreads);
+
+  vtkNew<vtkColorTransferFunction> ctf;
+  vtkNew<vtkPiecewiseFunction> pwf;
+  vtkNew<vtkPiecewiseFunction> gradientPwf;
+  gradientPwf->AddPoint(0.0, 0.2);
+  gradientPwf->AddPoint(20.0, 1.0);
+  vtkNew<vtkPiecewiseFunction> noGradientPwf;
+  noGradientPwf->AddPoint(0.0, 1.0);
+
+  vtkNew<vtkVolume> volume;
+  volume->SetMapper(volumeMapper.GetPointer());
+  volume->GetProperty()->SetColor(ctf.GetPointer());
+  volume->GetProperty()->SetScalarOpacity(pwf.GetPointer());
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(500, 500);
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddVolume(volume.GetPointer());
+  renderWindow->AddRenderer(renderer.GetPointer());
+  volumeMapper->SetInputConnection(wavelet->GetOutputPort());
+  renderer->ResetCamera();
+  renderer->GetActiveCamera()->Azimuth(30.0);
+  renderer->GetActiveCamera()->Elevation(20.0);
+  renderer->ResetCameraClippingRange();
+
+  const int numRenders = 5;
+  int rval = 0;
+  for (size_t c = 0; c < sizeof(Cases) / sizeof(Cases[0]); ++c)
+    {
+    const BenchmarkCase &bc = Cases[c];
+
+    // the unsigned char data needs no scale and shift in the kernels
+    double range[2] = { 37.3531, 276.829 };
+    if (bc.UnsignedChar)
+      {
+      volumeMapper->SetInputConnection(toUnsignedChar->GetOutputPort());
+      range[0] = 0.0;
+      range[1] = 255.0;
+      }
+    else
+      {
+      volumeMapper->SetInputConnection(wavelet->GetOutputPort());
+      }
+    ctf->RemoveAllPoints();
+    ctf->AddRGBPoint(range[0], 0.2, 0.29, 1.0);
+    ctf->AddRGBPoint(range[1], 0.7, 0.015, 0.15);
+    pwf->RemoveAllPoints();
+    pwf->AddPoint(range[0], 0.0);
+    pwf->AddPoint(0.5 * (range[0] + range[1]), 0.0);
+    pwf->AddPoint(range[1], 0.3);
+
+    volume->GetProperty()->SetInterpolationType(bc.Interpolation);
+    volume->GetProperty()->SetShade(bc.Shade);
+    volume->GetProperty()->SetGradientOpacity(
+      bc.GradientOpacity ? gradientPwf.GetPointer()
+                         : noGradientPwf.GetPointer());
+    volumeMapper->SetBlendMode(bc.BlendMode);
+
+    std::vector<unsigned short> images[2];
+    double times[2];
+    for (int threaded = 0; threaded < 2; ++threaded)
+      {
+      volumeMapper->SetNumberOfThreads(threaded ? numThreads : 1);
+      renderWindow->Render(); // the first render builds the tables
+
+      vtkNew<vtkTimerLog> timer;
+      timer->StartTimer();
+      for (int i = 0; i < numRenders; ++i)
+        {
+        renderWindow->Render();
+        }
+      timer->StopTimer();
+      times[threaded] = timer->GetElapsedTime() / numRenders;
+
+      // the mapper only clears the pixels it no longer casts rays for, so
+      // clear the image to compare every pixel of one render
+      volumeMapper->GetRayCastImage()->ClearImage();
+      renderWindow->Render();
+      GetImage(volumeMapper.GetPointer(), images[threaded]);
+      }
+
+    cout << bc.Name << ": " << times[0] << " s on 1 thread, "
+         << times[1] << " s on " << numThreads << " threads" << endl;
+    if (images[0].empty() || images[0] != images[1])
+      {
+      cerr << bc.Name << ": the image depends on the number of threads"
+           << endl;
+      rval = 1;
+      }
+    }
+
+  return rval;
+}
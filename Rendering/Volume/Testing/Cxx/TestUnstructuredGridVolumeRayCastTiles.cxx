@@ -0,0 +1,100 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestUnstructuredGridVolumeRayCastTiles.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkUnstructuredGridVolumeRayCastMapper renders the same image
+// whatever the number of threads and the size of the tiles they take.
+
+#include "vtkCamera.h"
+#include "vtkColorTransferFunction.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkImageData.h"
+#include "vtkNew.h"
+#include "vtkPiecewiseFunction.h"
+#include "vtkPointData.h"
+#include "vtkRTAnalyticSource.h"
+#include "vtkRenderWindow.h"
+#include "vtkRenderer.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkUnstructuredGridVolumeRayCastMapper.h"
+#include "vtkVolume.h"
+#include "vtkVolumeProperty.h"
+#include "vtkWindowToImageFilter.h"
+
+#include <cstring>
+
+int TestUnstructuredGridVolumeRayCastTiles(int, char *[])
+{
+  vtkNew<vtkRTAnalyticSource> source;
+  source->SetWholeExtent(-10, 10, -10, 10, -10, 10);
+  vtkNew<vtkDataSetTriangleFilter> tetra;
+  tetra->SetInputConnection(source->GetOutputPort());
+
+  vtkNew<vtkUnstructuredGridVolumeRayCastMapper> mapper;
+  mapper->SetInputConnection(tetra->GetOutputPort());
+  mapper->AutoAdjustSampleDistancesOff();
+
+  vtkNew<vtkPiecewiseFunction> opacity;
+  opacity->AddPoint(37.0, 0.0);
+  opacity->AddPoint(276.0, 0.1);
+  vtkNew<vtkColorTransferFunction> color;
+  color->AddRGBPoint(37.0, 1.0, 0.0, 0.0);
+  color->AddRGBPoint(276.0, 0.0, 0.0, 1.0);
+  vtkNew<vtkVolume> volume;
+  volume->SetMapper(mapper.GetPointer());
+  volume->GetProperty()->SetScalarOpacity(opacity.GetPointer());
+  volume->GetProperty()->SetColor(color.GetPointer());
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddVolume(volume.GetPointer());
+  vtkNew<vtkRenderWindow> renWin;
+  renWin->SetSize(200, 200);
+  renWin->AddRenderer(renderer.GetPointer());
+  renderer->ResetCamera();
+  renderer->GetActiveCamera()->Azimuth(30.0);
+  renderer->GetActiveCamera()->Elevation(20.0);
+  renderer->ResetCameraClippingRange();
+
+  const int threads[3] = { 1, 4, 3 };
+  const int tileSizes[3] = { 200, 16, 7 };
+  vtkNew<vtkUnsignedCharArray> reference;
+  int rval = 0;
+  for (int i = 0; i < 3; ++i)
+    {
+    mapper->SetNumberOfThreads(threads[i]);
+    mapper->SetTileSize(tileSizes[i]);
+    renWin->Render();
+
+    vtkNew<vtkWindowToImageFilter> grab;
+    grab->SetInput(renWin.GetPointer());
+    grab->Update();
+    vtkUnsignedCharArray *pixels = vtkUnsignedCharArray::SafeDownCast(
+      grab->GetOutput()->GetPointData()->GetScalars());
+    if (i == 0)
+      {
+      reference->DeepCopy(pixels);
+      continue;
+      }
+    if (pixels->GetNumberOfTuples() != reference->GetNumberOfTuples() ||
+        memcmp(pixels->GetPointer(0), reference->GetPointer(0),
+               pixels->GetDataSize()) != 0)
+      {
+      cerr << "The image rendered with " << threads[i] << " threads and "
+           << tileSizes[i] << " pixel tiles differs from the one rendered "
+           << "with one thread" << endl;
+      rval = 1;
+      }
+    }
+
+  return rval;
+}
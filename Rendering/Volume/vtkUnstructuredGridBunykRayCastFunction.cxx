@@ -35,10 +35,12 @@
 #include "vtkSmartPointer.h"
 #include "vtkCellIterator.h"
 #include "vtkDataArrayIteratorMacro.h"
+#include "vtkSMPTools.h"
 
-vtkStandardNewMacro(vtkUnstructuredGridBunykRayCastFunction);
+#include <algorithm>
+#include <vector>
 
-#define VTK_BUNYKRCF_NUMLISTS 100000
+vtkStandardNewMacro(vtkUnstructuredGridBunykRayCastFunction);
 
 template <class T, class ScalarIterator>
 vtkIdType TemplateCastRay(
@@ -210,6 +212,637 @@ vtkIdType vtkUnstructuredGridBunykRayCastIterator::GetNextIntersections(
 
 //-----------------------------------------------------------------------------
 
+namespace
+{
+
+typedef vtkUnstructuredGridBunykRayCastFunction::Triangle BunykTriangle;
+typedef vtkUnstructuredGridBunykRayCastFunction::Intersection BunykIntersection;
+
+// The number of chunks the items are cut into to sort them into bins
+const vtkIdType BinningChunks = 32;
+
+// The number of buckets the faces are sorted into, by their smallest point
+// id, to find the faces shared by two tetra
+const int FaceBuckets = 16384;
+
+// The height of the bands of rows of the image the boundary triangles are
+// rasterized in
+const int BandHeight = 16;
+
+// Counts the items of each chunk going into each bin or, once the counts
+// are turned into offsets, stores the items there.  Binner::GetBins gives
+// the range of bins of an item, which is empty if first > last.
+template <class Binner>
+class BinItemsFunctor
+{
+public:
+  const Binner *Bins;
+  vtkIdType NumberOfItems;
+  vtkIdType ChunkSize;
+  int NumberOfBins;
+  vtkIdType *Counts;
+  vtkIdType *Items;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for (vtkIdType chunk = begin; chunk < end; ++chunk)
+      {
+      vtkIdType *counts = this->Counts + chunk*this->NumberOfBins;
+      vtkIdType first = chunk*this->ChunkSize;
+      vtkIdType last = std::min(first + this->ChunkSize, this->NumberOfItems);
+      for (vtkIdType i = first; i < last; ++i)
+        {
+        int firstBin, lastBin;
+        this->Bins->GetBins(i, firstBin, lastBin);
+        for (int bin = firstBin; bin <= lastBin; ++bin)
+          {
+          if (this->Items)
+            {
+            this->Items[counts[bin]++] = i;
+            }
+          else
+            {
+            ++counts[bin];
+            }
+          }
+        }
+      }
+  }
+};
+
+// Sorts the items into bins, keeping them in order in each bin: the items
+// of bin b are items[offsets[b]] to items[offsets[b + 1] - 1].
+template <class Binner>
+void BinItems(const Binner &bins, vtkIdType numItems, int numBins,
+              std::vector<vtkIdType> &offsets, std::vector<vtkIdType> &items)
+{
+  std::vector<vtkIdType> counts(BinningChunks*numBins, 0);
+  BinItemsFunctor<Binner> functor;
+  functor.Bins = &bins;
+  functor.NumberOfItems = numItems;
+  functor.ChunkSize = (numItems + BinningChunks - 1) / BinningChunks;
+  functor.NumberOfBins = numBins;
+  functor.Counts = &counts[0];
+  functor.Items = NULL;
+  vtkSMPTools::For(0, BinningChunks, 1, functor);
+
+  // The items of each bin are stored chunk after chunk
+  offsets.resize(numBins + 1);
+  vtkIdType total = 0;
+  for (int bin = 0; bin < numBins; ++bin)
+    {
+    offsets[bin] = total;
+    for (vtkIdType chunk = 0; chunk < BinningChunks; ++chunk)
+      {
+      vtkIdType count = counts[chunk*numBins + bin];
+      counts[chunk*numBins + bin] = total;
+      total += count;
+      }
+    }
+  offsets[numBins] = total;
+
+  items.resize(total);
+  if (total > 0)
+    {
+    functor.Items = &items[0];
+    vtkSMPTools::For(0, BinningChunks, 1, functor);
+    }
+}
+
+// Stores the four faces of a tetra as their sorted point ids followed by
+// the fourth point of the tetra, or marks them unused if the cell is not a
+// tetra.
+bool StoreTetraFaces(int cellType, const vtkIdType *pts, vtkIdType *faces)
+{
+  if (cellType != VTK_TETRA)
+    {
+    for (int j = 0; j < 4; ++j)
+      {
+      faces[4*j] = -1;
+      }
+    return false;
+    }
+
+  for (int j = 0; j < 4; ++j)
+    {
+    vtkIdType *tri = faces + 4*j;
+    int idx = 0;
+    for (int i = 0; i < 4; ++i)
+      {
+      if (i != j)
+        {
+        tri[idx++] = pts[i];
+        }
+      }
+    if (tri[0] > tri[1])
+      {
+      std::swap(tri[0], tri[1]);
+      }
+    if (tri[1] > tri[2])
+      {
+      std::swap(tri[1], tri[2]);
+      }
+    if (tri[0] > tri[1])
+      {
+      std::swap(tri[0], tri[1]);
+      }
+    tri[3] = pts[j];
+    }
+  return true;
+}
+
+// Stores the faces of the tetra of an unstructured grid, whose cells can
+// be read from several threads.
+class TetraFacesFunctor
+{
+public:
+  vtkUnstructuredGrid *Input;
+  vtkIdType NumberOfCells;
+  vtkIdType ChunkSize;
+  vtkIdType *Faces;
+  unsigned char *NonTetra;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for (vtkIdType chunk = begin; chunk < end; ++chunk)
+      {
+      vtkIdType first = chunk*this->ChunkSize;
+      vtkIdType last = std::min(first + this->ChunkSize, this->NumberOfCells);
+      for (vtkIdType cellId = first; cellId < last; ++cellId)
+        {
+        vtkIdType npts, *pts;
+        this->Input->GetCellPoints(cellId, npts, pts);
+        int cellType = (npts == 4 ? this->Input->GetCellType(cellId) : 0);
+        if (!StoreTetraFaces(cellType, pts, this->Faces + 16*cellId))
+          {
+          this->NonTetra[chunk] = 1;
+          }
+        }
+      }
+  }
+};
+
+bool SameFace(const vtkIdType *a, const vtkIdType *b)
+{
+  return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+}
+
+// Orders faces by their sorted point ids.
+class FaceLess
+{
+public:
+  const vtkIdType *Faces;
+
+  bool operator()(vtkIdType a, vtkIdType b) const
+  {
+    const vtkIdType *fa = this->Faces + 4*a;
+    const vtkIdType *fb = this->Faces + 4*b;
+    return fa[0] < fb[0] ||
+      (fa[0] == fb[0] && (fa[1] < fb[1] || (fa[1] == fb[1] && fa[2] < fb[2])));
+  }
+};
+
+// Bins the used faces by their smallest point id.
+class FaceBins
+{
+public:
+  const vtkIdType *Faces;
+
+  void GetBins(vtkIdType i, int &first, int &last) const
+  {
+    vtkIdType id = this->Faces[4*i];
+    if (id < 0)
+      {
+      first = 1;
+      last = 0;
+      }
+    else
+      {
+      first = last = static_cast<int>(id % FaceBuckets);
+      }
+  }
+};
+
+// Sorts the faces of each bucket so that the faces of a triangle follow
+// each other, in the order of their tetra, and counts the triangles.
+class SortFacesFunctor
+{
+public:
+  const vtkIdType *Faces;
+  const vtkIdType *Offsets;
+  vtkIdType *Items;
+  vtkIdType *NumberOfTriangles;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    FaceLess less;
+    less.Faces = this->Faces;
+    for (vtkIdType bucket = begin; bucket < end; ++bucket)
+      {
+      vtkIdType *first = this->Items + this->Offsets[bucket];
+      vtkIdType *last = this->Items + this->Offsets[bucket + 1];
+      std::stable_sort(first, last, less);
+      vtkIdType count = 0;
+      for (vtkIdType *p = first; p < last; ++p)
+        {
+        if (p == first ||
+            !SameFace(this->Faces + 4*p[-1], this->Faces + 4*p[0]))
+          {
+          ++count;
+          }
+        }
+      this->NumberOfTriangles[bucket] = count;
+      }
+  }
+};
+
+// Builds the triangles of each bucket from its sorted faces, and links
+// the tetra to them.
+class BuildTrianglesFunctor
+{
+public:
+  const vtkIdType *Faces;
+  const vtkIdType *Offsets;
+  const vtkIdType *Items;
+  const vtkIdType *TriangleOffsets;
+  BunykTriangle *Triangles;
+  BunykTriangle **TetraTriangles;
+  vtkIdType *OppositePoints;
+  unsigned char *Degenerate;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for (vtkIdType bucket = begin; bucket < end; ++bucket)
+      {
+      BunykTriangle *triPtr = this->Triangles + this->TriangleOffsets[bucket];
+      vtkIdType *opposite =
+        this->OppositePoints + this->TriangleOffsets[bucket];
+      const vtkIdType *p = this->Items + this->Offsets[bucket];
+      const vtkIdType *last = this->Items + this->Offsets[bucket + 1];
+      while (p < last)
+        {
+        const vtkIdType *face = this->Faces + 4*p[0];
+        triPtr->PointIndex[0] = face[0];
+        triPtr->PointIndex[1] = face[1];
+        triPtr->PointIndex[2] = face[2];
+        triPtr->ReferredByTetra[0] = p[0] / 4;
+        triPtr->ReferredByTetra[1] = -1;
+        triPtr->Next = triPtr + 1;
+        *opposite = face[3];
+        this->TetraTriangles[p[0]] = triPtr;
+        for (++p; p < last && SameFace(face, this->Faces + 4*p[0]); ++p)
+          {
+          if (triPtr->ReferredByTetra[1] != -1)
+            {
+            this->Degenerate[bucket] = 1;
+            }
+          triPtr->ReferredByTetra[1] = p[0] / 4;
+          this->TetraTriangles[p[0]] = triPtr;
+          }
+        ++triPtr;
+        ++opposite;
+        }
+      }
+  }
+};
+
+// Transforms the points into view coordinates.
+class TransformPointsFunctor
+{
+public:
+  vtkUnstructuredGridBase *Input;
+  double Matrix[16];
+  int ImageViewportSize[2];
+  int ImageOrigin[2];
+  double *Points;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    double in[4], out[4];
+    in[3] = 1.0;
+    double *transformedPtr = this->Points + 3*begin;
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      this->Input->GetPoint(i, in);
+      vtkMatrix4x4::MultiplyPoint(this->Matrix, in, out);
+      transformedPtr[0] = (out[0]/out[3] + 1.0)/2.0 *
+        (double)this->ImageViewportSize[0] - this->ImageOrigin[0];
+      transformedPtr[1] = (out[1]/out[3] + 1.0)/2.0 *
+        (double)this->ImageViewportSize[1] - this->ImageOrigin[1];
+      transformedPtr[2] =  out[2]/out[3];
+
+      transformedPtr += 3;
+      }
+  }
+};
+
+// Computes the plane equation and barycentric coefficients of the
+// triangles in view coordinates.
+class ViewDependentInfoFunctor
+{
+public:
+  BunykTriangle *Triangles;
+  const double *Points;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    const double *points = this->Points;
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      BunykTriangle *triPtr = this->Triangles + i;
+      double P1[3], P2[3];
+      double A[3], B[3], C[3];
+
+      A[0] = points[3*triPtr->PointIndex[0]];
+      A[1] = points[3*triPtr->PointIndex[0]+1];
+      A[2] = points[3*triPtr->PointIndex[0]+2];
+      B[0] = points[3*triPtr->PointIndex[1]];
+      B[1] = points[3*triPtr->PointIndex[1]+1];
+      B[2] = points[3*triPtr->PointIndex[1]+2];
+      C[0] = points[3*triPtr->PointIndex[2]];
+      C[1] = points[3*triPtr->PointIndex[2]+1];
+      C[2] = points[3*triPtr->PointIndex[2]+2];
+
+      P1[0] = B[0] - A[0];
+      P1[1] = B[1] - A[1];
+      P1[2] = B[2] - A[2];
+
+      P2[0] = C[0] - A[0];
+      P2[1] = C[1] - A[1];
+      P2[2] = C[2] - A[2];
+
+      triPtr->Denominator = P1[0]*P2[1] - P2[0]*P1[1];
+
+      if ( triPtr->Denominator < 0 )
+        {
+        double T[3];
+        triPtr->Denominator = -triPtr->Denominator;
+        T[0]  = P1[0];
+        T[1]  = P1[1];
+        T[2]  = P1[2];
+        P1[0] = P2[0];
+        P1[1] = P2[1];
+        P1[2] = P2[2];
+        P2[0] = T[0];
+        P2[1] = T[1];
+        P2[2] = T[2];
+        vtkIdType tmpIndex = triPtr->PointIndex[1];
+        triPtr->PointIndex[1] = triPtr->PointIndex[2];
+        triPtr->PointIndex[2] = tmpIndex;
+        }
+
+      triPtr->P1X = P1[0];
+      triPtr->P1Y = P1[1];
+      triPtr->P2X = P2[0];
+      triPtr->P2Y = P2[1];
+
+      double result[3];
+      vtkMath::Cross( P1, P2, result );
+      triPtr->A = result[0];
+      triPtr->B = result[1];
+      triPtr->C = result[2];
+      triPtr->D = -(A[0]*result[0] + A[1]*result[1] + A[2]*result[2]);
+      }
+  }
+};
+
+// Finds the pixels each front facing boundary triangle may cover, as the
+// box minX, maxX, minY, maxY, which is empty (minY > maxY) for the other
+// triangles.  A boundary triangle is front facing if the fourth point of
+// its tetra is behind the plane containing the triangle.
+class BoundaryBoxesFunctor
+{
+public:
+  const BunykTriangle *Triangles;
+  const vtkIdType *Boundary;
+  const double *Points;
+  int ImageSize[2];
+  int *Boxes;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    const double *points = this->Points;
+    for (vtkIdType k = begin; k < end; ++k)
+      {
+      const BunykTriangle *triPtr = this->Triangles + this->Boundary[2*k];
+      const double *opposite = points + 3*this->Boundary[2*k + 1];
+      int *box = this->Boxes + 4*k;
+      box[2] = 1;
+      box[3] = 0;
+
+      double d = triPtr->A*opposite[0] + triPtr->B*opposite[1] +
+        triPtr->C*opposite[2] + triPtr->D;
+      if ( d <= 0 )
+        {
+        continue;
+        }
+
+      int   minX = static_cast<int>(points[3*triPtr->PointIndex[0]]);
+      int   maxX = minX+1;
+      int   minY = static_cast<int>(points[3*triPtr->PointIndex[0]+1]);
+      int   maxY = minY+1;
+
+      int tmp;
+
+      tmp = static_cast<int>(points[3*triPtr->PointIndex[1]]);
+      minX = (tmp<minX)?(tmp):(minX);
+      maxX = ((tmp+1)>maxX)?(tmp+1):(maxX);
+
+      tmp = static_cast<int>(points[3*triPtr->PointIndex[1]+1]);
+      minY = (tmp<minY)?(tmp):(minY);
+      maxY = ((tmp+1)>maxY)?(tmp+1):(maxY);
+
+      tmp = static_cast<int>(points[3*triPtr->PointIndex[2]]);
+      minX = (tmp<minX)?(tmp):(minX);
+      maxX = ((tmp+1)>maxX)?(tmp+1):(maxX);
+
+      tmp = static_cast<int>(points[3*triPtr->PointIndex[2]+1]);
+      minY = (tmp<minY)?(tmp):(minY);
+      maxY = ((tmp+1)>maxY)?(tmp+1):(maxY);
+
+      double minZ = points[3*triPtr->PointIndex[0]+2];
+      double ftmp;
+
+      ftmp = points[3*triPtr->PointIndex[1]+2];
+      minZ = (ftmp<minZ)?(ftmp):(minZ);
+
+      ftmp = points[3*triPtr->PointIndex[2]+2];
+      minZ = (ftmp<minZ)?(ftmp):(minZ);
+
+      if ( minX < this->ImageSize[0] - 1 &&
+           minY < this->ImageSize[1] - 1 &&
+           maxX >= 0 && maxY >= 0 && minZ > 0.0 )
+        {
+        box[0] = (minX<0)?(0):(minX);
+        box[1] = (maxX>(this->ImageSize[0]-1))?(this->ImageSize[0]-1):(maxX);
+        box[2] = (minY<0)?(0):(minY);
+        box[3] = (maxY>(this->ImageSize[1]-1))?(this->ImageSize[1]-1):(maxY);
+        }
+      }
+  }
+};
+
+// Bins the boxes of the boundary triangles by the bands they overlap.
+class BandBins
+{
+public:
+  const int *Boxes;
+
+  void GetBins(vtkIdType i, int &first, int &last) const
+  {
+    const int *box = this->Boxes + 4*i;
+    if (box[2] > box[3])
+      {
+      first = 1;
+      last = 0;
+      }
+    else
+      {
+      first = box[2] / BandHeight;
+      last = box[3] / BandHeight;
+      }
+  }
+};
+
+// The memory of the intersections of a band, allocated in arrays of
+// VTK_BUNYKRCF_ARRAY_SIZE elements that are kept from render to render.
+class IntersectionPool
+{
+public:
+  IntersectionPool() : Used(0) {}
+  ~IntersectionPool()
+  {
+    for (size_t i = 0; i < this->Arrays.size(); ++i)
+      {
+      delete [] this->Arrays[i];
+      }
+  }
+
+  BunykIntersection *NewIntersection()
+  {
+    if (this->Used == this->Arrays.size()*VTK_BUNYKRCF_ARRAY_SIZE)
+      {
+      this->Arrays.push_back(new BunykIntersection[VTK_BUNYKRCF_ARRAY_SIZE]);
+      }
+    BunykIntersection *intersect =
+      this->Arrays[this->Used / VTK_BUNYKRCF_ARRAY_SIZE] +
+      this->Used % VTK_BUNYKRCF_ARRAY_SIZE;
+    ++this->Used;
+    return intersect;
+  }
+
+  void Reset() { this->Used = 0; }
+
+  std::vector<BunykIntersection*> Arrays;
+  size_t Used;
+};
+
+// Adds the intersections of the boundary triangles with the pixels of each
+// band to the intersection lists, sorted by depth.  The triangles of a band
+// are taken in order, so that the lists do not depend on the threads.
+class RasterizeFunctor
+{
+public:
+  vtkUnstructuredGridBunykRayCastFunction *Self;
+  BunykTriangle *Triangles;
+  const vtkIdType *Boundary;
+  const int *Boxes;
+  const double *Points;
+  const vtkIdType *BandOffsets;
+  const vtkIdType *BandItems;
+  IntersectionPool * const *Pools;
+  BunykIntersection **Image;
+  int ImageWidth;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    BunykIntersection **image = this->Image;
+    int width = this->ImageWidth;
+    for (vtkIdType band = begin; band < end; ++band)
+      {
+      IntersectionPool *pool = this->Pools[band];
+      int bandMinY = static_cast<int>(band)*BandHeight;
+      int bandMaxY = bandMinY + BandHeight - 1;
+      for (vtkIdType k = this->BandOffsets[band];
+           k < this->BandOffsets[band + 1]; ++k)
+        {
+        vtkIdType i = this->BandItems[k];
+        BunykTriangle *triPtr = this->Triangles + this->Boundary[2*i];
+        const int *box = this->Boxes + 4*i;
+        int minY = (box[2]<bandMinY)?(bandMinY):(box[2]);
+        int maxY = (box[3]>bandMaxY)?(bandMaxY):(box[3]);
+
+        int x, y;
+        double ax, ay, az;
+        ax = this->Points[3*triPtr->PointIndex[0]];
+        ay = this->Points[3*triPtr->PointIndex[0]+1];
+        az = this->Points[3*triPtr->PointIndex[0]+2];
+
+        for ( y = minY; y <= maxY; y++ )
+          {
+          double qy = (double)y - ay;
+          for ( x = box[0]; x <= box[1]; x++ )
+            {
+            double qx = (double)x - ax;
+            if ( this->Self->InTriangle( qx, qy, triPtr ) )
+              {
+              BunykIntersection *intersect = pool->NewIntersection();
+              intersect->TriPtr = triPtr;
+              intersect->Z      = az;
+              intersect->Next   = NULL;
+
+              BunykIntersection **pixel = image + y*width + x;
+              if ( !*pixel || intersect->Z < (*pixel)->Z )
+                {
+                intersect->Next = *pixel;
+                *pixel = intersect;
+                }
+              else
+                {
+                BunykIntersection *test = *pixel;
+                while ( test->Next && intersect->Z > test->Next->Z )
+                  {
+                  test = test->Next;
+                  }
+                intersect->Next = test->Next;
+                test->Next = intersect;
+                }
+              }
+            }
+          }
+        }
+      }
+  }
+};
+
+}
+
+class vtkUnstructuredGridBunykRayCastFunctionInternals
+{
+public:
+  ~vtkUnstructuredGridBunykRayCastFunctionInternals()
+  {
+    for (size_t i = 0; i < this->Pools.size(); ++i)
+      {
+      delete this->Pools[i];
+      }
+  }
+
+  // The boundary triangles, as the index of the triangle followed by the
+  // fourth point of its tetra
+  std::vector<vtkIdType> Boundary;
+
+  // The boxes of the boundary triangles, and their indices binned by band
+  std::vector<int>       Boxes;
+  std::vector<vtkIdType> BandOffsets;
+  std::vector<vtkIdType> BandItems;
+
+  // The memory of the intersections, one pool per band
+  std::vector<IntersectionPool*> Pools;
+};
+
+//-----------------------------------------------------------------------------
+
 // Constructor - initially everything to null, and create a matrix for use later
 vtkUnstructuredGridBunykRayCastFunction::vtkUnstructuredGridBunykRayCastFunction()
 {
@@ -220,18 +853,22 @@ vtkUnstructuredGridBunykRayCastFunction::vtkUnstructuredGridBunykRayCastFunction
   this->Points            = NULL;
   this->Image             = NULL;
   this->TriangleList      = NULL;
+  this->NumberOfTriangles = 0;
   this->TetraTriangles    = NULL;
   this->TetraTrianglesSize= 0;
   this->NumberOfPoints    = 0;
   this->ImageSize[0]      = 0;
   this->ImageSize[1]      = 0;
   this->ViewToWorldMatrix = vtkMatrix4x4::New();
+  this->Internals = new vtkUnstructuredGridBunykRayCastFunctionInternals;
 
+#ifndef VTK_LEGACY_REMOVE
   for (int i = 0; i < VTK_BUNYKRCF_MAX_ARRAYS; i++ )
     {
     this->IntersectionBuffer[i] = NULL;
     this->IntersectionBufferCount[i] = 0;
     }
+#endif
 
   this->SavedTriangleListInput       = NULL;
 }
@@ -246,27 +883,22 @@ vtkUnstructuredGridBunykRayCastFunction::~vtkUnstructuredGridBunykRayCastFunctio
   this->Image = NULL;
 
   delete [] this->TetraTriangles;
+  delete [] this->TriangleList;
+  delete this->Internals;
 
-  int i;
-  for (i = 0; i < 20; i++ )
+#ifndef VTK_LEGACY_REMOVE
+  for (int i = 0; i < VTK_BUNYKRCF_MAX_ARRAYS; i++ )
     {
     delete [] this->IntersectionBuffer[i];
     }
-
-  while ( this->TriangleList )
-    {
-    Triangle *tmp;
-    tmp = this->TriangleList->Next;
-    delete this->TriangleList;
-    this->TriangleList = tmp;
-    }
+#endif
 
   this->ViewToWorldMatrix->Delete();
 }
 
 // Clear the intersection image. This does NOT release memory -
 // it just sets the link pointers to NULL. The memory is
-// contained in the IntersectionBuffer arrays.
+// contained in the intersection pools of the bands.
 void vtkUnstructuredGridBunykRayCastFunction::ClearImage()
 {
   int i;
@@ -278,20 +910,29 @@ void vtkUnstructuredGridBunykRayCastFunction::ClearImage()
       }
     }
 
+#ifndef VTK_LEGACY_REMOVE
   for ( i = 0; i < VTK_BUNYKRCF_MAX_ARRAYS; i++ )
     {
     this->IntersectionBufferCount[i] = 0;
     }
+#endif
+
+  for ( size_t j = 0; j < this->Internals->Pools.size(); j++ )
+    {
+    this->Internals->Pools[j]->Reset();
+    }
 }
 
-// Since we are managing the memory ourself for these intersections,
-// we need a new method. In this method we return an unused
-// intersection element from our storage arrays. If we don't
-// have one, we create a new storage array (unless we have run
-// out of memory). The memory can never shrink, and will only be
+#ifndef VTK_LEGACY_REMOVE
+// Return an unused intersection element from the IntersectionBuffer
+// arrays. If there is none, create a new storage array (unless we have
+// run out of memory). The memory can never shrink, and will only be
 // deleted when the class is destructed.
 void *vtkUnstructuredGridBunykRayCastFunction::NewIntersection()
 {
+  VTK_LEGACY_BODY(vtkUnstructuredGridBunykRayCastFunction::NewIntersection,
+                  "VTK 6.3");
+
   // Look for the first buffer that has enough space, or the
   // first one that has not yet been allocated
   int i;
@@ -321,8 +962,42 @@ void *vtkUnstructuredGridBunykRayCastFunction::NewIntersection()
 
   // Return the first unused element
   return (this->IntersectionBuffer[i] + (this->IntersectionBufferCount[i]++));
+}
+
+int vtkUnstructuredGridBunykRayCastFunction::IsTriangleFrontFacing(
+  Triangle *triPtr, vtkIdType tetraIndex )
+{
+  VTK_LEGACY_BODY(
+    vtkUnstructuredGridBunykRayCastFunction::IsTriangleFrontFacing,
+    "VTK 6.3");
+  vtkCell *cell = this->Mapper->GetInput()->GetCell(tetraIndex);
+
+  vtkIdType pts[4];
+  pts[0] = cell->GetPointId(0);
+  pts[1] = cell->GetPointId(1);
+  pts[2] = cell->GetPointId(2);
+  pts[3] = cell->GetPointId(3);
 
+  int i;
+  for( i = 0; i < 4; i++ )
+    {
+    if ( pts[i] != triPtr->PointIndex[0] &&
+         pts[i] != triPtr->PointIndex[1] &&
+         pts[i] != triPtr->PointIndex[2] )
+      {
+      break;
+      }
+    }
+
+  double d =
+    triPtr->A*this->Points[3*pts[i]] +
+    triPtr->B*this->Points[3*pts[i]+1] +
+    triPtr->C*this->Points[3*pts[i]+2] +
+    triPtr->D;
+
+  return (d>0);
 }
+#endif
 
 // The Intialize method is called from the ray caster at the start of
 // rendering. In this method we check if the render is valid (there is
@@ -476,29 +1151,16 @@ void vtkUnstructuredGridBunykRayCastFunction::TransformPoints()
   this->ViewToWorldMatrix->DeepCopy(perspectiveTransform->GetMatrix());
   this->ViewToWorldMatrix->Invert();
 
-  double *origPtr;
-  double *transformedPtr = this->Points;
-  double in[4], out[4];
-  in[3] = 1.0;
-  vtkUnstructuredGridBase *input = this->Mapper->GetInput();
-  int numPoints = input->GetNumberOfPoints();
-
-  // Loop through all the points and transform them
-  for ( int i = 0; i < numPoints; i++ )
-    {
-    origPtr = input->GetPoint( i );
-    in[0] = origPtr[0];
-    in[1] = origPtr[1];
-    in[2] = origPtr[2];
-    perspectiveMatrix->MultiplyPoint( in, out );
-    transformedPtr[0] = (out[0]/out[3] + 1.0)/2.0 *
-      (double)this->ImageViewportSize[0] - this->ImageOrigin[0];
-    transformedPtr[1] = (out[1]/out[3] + 1.0)/2.0 *
-      (double)this->ImageViewportSize[1] - this->ImageOrigin[1];
-    transformedPtr[2] =  out[2]/out[3];
-
-    transformedPtr += 3;
-    }
+  // Transform all the points in parallel
+  TransformPointsFunctor functor;
+  functor.Input = this->Mapper->GetInput();
+  vtkMatrix4x4::DeepCopy(functor.Matrix, perspectiveMatrix);
+  functor.ImageViewportSize[0] = this->ImageViewportSize[0];
+  functor.ImageViewportSize[1] = this->ImageViewportSize[1];
+  functor.ImageOrigin[0] = this->ImageOrigin[0];
+  functor.ImageOrigin[1] = this->ImageOrigin[1];
+  functor.Points = this->Points;
+  vtkSMPTools::For(0, functor.Input->GetNumberOfPoints(), functor);
 
   perspectiveTransform->Delete();
   perspectiveMatrix->Delete();
@@ -535,24 +1197,10 @@ void  vtkUnstructuredGridBunykRayCastFunction::UpdateTriangleList()
 
 
   // Clear out the old triangle list
-  while ( this->TriangleList )
-    {
-    Triangle *tmp;
-    tmp = this->TriangleList->Next;
-    delete this->TriangleList;
-    this->TriangleList = tmp;
-    }
+  delete [] this->TriangleList;
   this->TriangleList = NULL;
-
-  // A temporary structure to reduce search time - VTK_BUNYKRCF_NUMLISTS small
-  // lists instead of one big one
-  Triangle *tmpList[VTK_BUNYKRCF_NUMLISTS];
-
-  vtkIdType i;
-  for ( i = 0; i < VTK_BUNYKRCF_NUMLISTS; i++ )
-    {
-    tmpList[i] = NULL;
-    }
+  this->NumberOfTriangles = 0;
+  this->Internals->Boundary.clear();
 
   vtkIdType numCells = input->GetNumberOfCells();
 
@@ -574,95 +1222,107 @@ void  vtkUnstructuredGridBunykRayCastFunction::UpdateTriangleList()
     this->TetraTrianglesSize=numCells;
     }
 
-  // Loop through all the cells
-  vtkSmartPointer<vtkCellIterator> cellIter =
-      vtkSmartPointer<vtkCellIterator>::Take(input->NewCellIterator());
-  for (cellIter->InitTraversal(); !cellIter->IsDoneWithTraversal();
-       cellIter->GoToNextCell())
+  if ( numCells > 0 )
     {
-    // We only handle tetra
-    if (cellIter->GetCellType() != VTK_TETRA)
+    // Store the four faces of each tetra. The cells of an unstructured
+    // grid are read in parallel, the others through a cell iterator.
+    std::vector<vtkIdType> faces(16*numCells);
+    vtkUnstructuredGrid *grid = vtkUnstructuredGrid::SafeDownCast(input);
+    if ( grid )
       {
-      nonTetraWarningNeeded = 1;
-      continue;
+      unsigned char nonTetra[BinningChunks] = { 0 };
+      TetraFacesFunctor functor;
+      functor.Input = grid;
+      functor.NumberOfCells = numCells;
+      functor.ChunkSize = (numCells + BinningChunks - 1) / BinningChunks;
+      functor.Faces = &faces[0];
+      functor.NonTetra = nonTetra;
+      vtkSMPTools::For(0, BinningChunks, 1, functor);
+      for ( vtkIdType chunk = 0; chunk < BinningChunks; chunk++ )
+        {
+        nonTetraWarningNeeded |= nonTetra[chunk];
+        }
       }
-
-    // Get the four points
-    i = cellIter->GetCellId();
-    vtkIdList *ptIds = cellIter->GetPointIds();
-    vtkIdType pts[4];
-    pts[0] = ptIds->GetId(0);
-    pts[1] = ptIds->GetId(1);
-    pts[2] = ptIds->GetId(2);
-    pts[3] = ptIds->GetId(3);
-
-    // Build each of the four triangles
-    int ii, jj;
-    for ( jj = 0; jj < 4; jj++ )
+    else
       {
-      vtkIdType tri[3];
-      int idx = 0;
-      for ( ii = 0; ii < 4; ii++ )
+      vtkSmartPointer<vtkCellIterator> cellIter =
+          vtkSmartPointer<vtkCellIterator>::Take(input->NewCellIterator());
+      for (cellIter->InitTraversal(); !cellIter->IsDoneWithTraversal();
+           cellIter->GoToNextCell())
         {
-        if ( ii != jj )
+        vtkIdList *ptIds = cellIter->GetPointIds();
+        int cellType = (ptIds->GetNumberOfIds() == 4 ?
+                        cellIter->GetCellType() : VTK_EMPTY_CELL);
+        if (!StoreTetraFaces(cellType, ptIds->GetPointer(0),
+                             &faces[16*cellIter->GetCellId()]))
           {
-          tri[idx++] = pts[ii];
+          nonTetraWarningNeeded = 1;
           }
         }
+      }
 
-      if ( tri[0] > tri[1] )
-        {
-        vtkIdType tmptri = tri[0];
-        tri[0] = tri[1];
-        tri[1] = tmptri;
-        }
-      if ( tri[1] > tri[2] )
-        {
-        vtkIdType tmptri = tri[1];
-        tri[1] = tri[2];
-        tri[2] = tmptri;
-        }
-      if ( tri[0] > tri[1] )
-        {
-        vtkIdType tmptri = tri[0];
-        tri[0] = tri[1];
-        tri[1] = tmptri;
-        }
+    // Sort the faces into buckets, then the faces of each bucket so that
+    // the faces shared by two tetra follow each other. Each group of
+    // equal faces becomes one triangle.
+    FaceBins faceBins;
+    faceBins.Faces = &faces[0];
+    std::vector<vtkIdType> offsets, items;
+    BinItems(faceBins, 4*numCells, FaceBuckets, offsets, items);
+
+    std::vector<vtkIdType> triangleOffsets(FaceBuckets + 1, 0);
+    if ( !items.empty() )
+      {
+      SortFacesFunctor sortFaces;
+      sortFaces.Faces = &faces[0];
+      sortFaces.Offsets = &offsets[0];
+      sortFaces.Items = &items[0];
+      sortFaces.NumberOfTriangles = &triangleOffsets[0];
+      vtkSMPTools::For(0, FaceBuckets, sortFaces);
+      }
+
+    vtkIdType numTriangles = 0;
+    for ( int bucket = 0; bucket < FaceBuckets; bucket++ )
+      {
+      vtkIdType count = triangleOffsets[bucket];
+      triangleOffsets[bucket] = numTriangles;
+      numTriangles += count;
+      }
+    triangleOffsets[FaceBuckets] = numTriangles;
 
-      // Do we have this triangle already?
-      Triangle *triPtr = tmpList[tri[0]%VTK_BUNYKRCF_NUMLISTS];
-      while ( triPtr )
+    if ( numTriangles > 0 )
+      {
+      // The triangles are linked in the order of the array
+      this->TriangleList = new Triangle[numTriangles];
+      this->NumberOfTriangles = numTriangles;
+      std::vector<vtkIdType> oppositePoints(numTriangles);
+      unsigned char degenerate[FaceBuckets] = { 0 };
+
+      BuildTrianglesFunctor build;
+      build.Faces = &faces[0];
+      build.Offsets = &offsets[0];
+      build.Items = &items[0];
+      build.TriangleOffsets = &triangleOffsets[0];
+      build.Triangles = this->TriangleList;
+      build.TetraTriangles = this->TetraTriangles;
+      build.OppositePoints = &oppositePoints[0];
+      build.Degenerate = degenerate;
+      vtkSMPTools::For(0, FaceBuckets, build);
+      this->TriangleList[numTriangles - 1].Next = NULL;
+
+      for ( int bucket = 0; bucket < FaceBuckets; bucket++ )
         {
-        if ( triPtr->PointIndex[0] == tri[0] &&
-             triPtr->PointIndex[1] == tri[1] &&
-             triPtr->PointIndex[2] == tri[2] )
-          {
-          break;
-          }
-        triPtr = triPtr->Next;
+        faceUsed3TimesWarning |= degenerate[bucket];
         }
 
-      if ( triPtr )
+      // Keep the boundary triangles with the fourth point of their tetra
+      // to find which ones are front facing at each render
+      for ( vtkIdType i = 0; i < numTriangles; i++ )
         {
-        if ( triPtr->ReferredByTetra[1] != -1 )
+        if ( this->TriangleList[i].ReferredByTetra[1] == -1 )
           {
-          faceUsed3TimesWarning = 1;
+          this->Internals->Boundary.push_back(i);
+          this->Internals->Boundary.push_back(oppositePoints[i]);
           }
-        triPtr->ReferredByTetra[1] = i;
-        this->TetraTriangles[i*4+jj] = triPtr;
-        }
-      else
-        {
-        Triangle *next = new Triangle;
-        next->PointIndex[0] = tri[0];
-        next->PointIndex[1] = tri[1];
-        next->PointIndex[2] = tri[2];
-        next->ReferredByTetra[0] =  i;
-        next->ReferredByTetra[1] = -1;
-
-        next->Next = tmpList[tri[0]%VTK_BUNYKRCF_NUMLISTS];
-        tmpList[tri[0]%VTK_BUNYKRCF_NUMLISTS] = next;
-        this->TetraTriangles[i*4+jj] = next;
         }
       }
     }
@@ -676,185 +1336,68 @@ void  vtkUnstructuredGridBunykRayCastFunction::UpdateTriangleList()
     vtkWarningMacro("Degenerate topology - cell face used more than twice");
     }
 
-  // Put the list together
-  for ( i = 0; i < VTK_BUNYKRCF_NUMLISTS; i++ )
-    {
-    if ( tmpList[i] )
-      {
-      Triangle *last = tmpList[i];
-      while ( last->Next )
-        {
-        last = last->Next;
-        }
-      last->Next = this->TriangleList;
-      this->TriangleList = tmpList[i];
-      }
-    }
-
   this->SavedTriangleListInput = input;
   this->SavedTriangleListMTime.Modified();
 }
 
 void  vtkUnstructuredGridBunykRayCastFunction::ComputeViewDependentInfo()
 {
-  Triangle *triPtr = this->TriangleList;
-  while ( triPtr )
-    {
-    double P1[3], P2[3];
-    double A[3], B[3], C[3];
-
-    A[0] = this->Points[3*triPtr->PointIndex[0]];
-    A[1] = this->Points[3*triPtr->PointIndex[0]+1];
-    A[2] = this->Points[3*triPtr->PointIndex[0]+2];
-    B[0] = this->Points[3*triPtr->PointIndex[1]];
-    B[1] = this->Points[3*triPtr->PointIndex[1]+1];
-    B[2] = this->Points[3*triPtr->PointIndex[1]+2];
-    C[0] = this->Points[3*triPtr->PointIndex[2]];
-    C[1] = this->Points[3*triPtr->PointIndex[2]+1];
-    C[2] = this->Points[3*triPtr->PointIndex[2]+2];
-
-    P1[0] = B[0] - A[0];
-    P1[1] = B[1] - A[1];
-    P1[2] = B[2] - A[2];
-
-    P2[0] = C[0] - A[0];
-    P2[1] = C[1] - A[1];
-    P2[2] = C[2] - A[2];
-
-    triPtr->Denominator = P1[0]*P2[1] - P2[0]*P1[1];
-
-    if ( triPtr->Denominator < 0 )
-      {
-      double T[3];
-      triPtr->Denominator = -triPtr->Denominator;
-      T[0]  = P1[0];
-      T[1]  = P1[1];
-      T[2]  = P1[2];
-      P1[0] = P2[0];
-      P1[1] = P2[1];
-      P1[2] = P2[2];
-      P2[0] = T[0];
-      P2[1] = T[1];
-      P2[2] = T[2];
-      vtkIdType tmpIndex = triPtr->PointIndex[1];
-      triPtr->PointIndex[1] = triPtr->PointIndex[2];
-      triPtr->PointIndex[2] = tmpIndex;
-      }
-
-    triPtr->P1X = P1[0];
-    triPtr->P1Y = P1[1];
-    triPtr->P2X = P2[0];
-    triPtr->P2Y = P2[1];
-
-    double result[3];
-    vtkMath::Cross( P1, P2, result );
-    triPtr->A = result[0];
-    triPtr->B = result[1];
-    triPtr->C = result[2];
-    triPtr->D = -(A[0]*result[0] + A[1]*result[1] + A[2]*result[2]);
-
-    triPtr = triPtr->Next;
-    }
+  ViewDependentInfoFunctor functor;
+  functor.Triangles = this->TriangleList;
+  functor.Points = this->Points;
+  vtkSMPTools::For(0, this->NumberOfTriangles, functor);
 }
 
 void vtkUnstructuredGridBunykRayCastFunction::ComputePixelIntersections()
 {
-  Triangle *triPtr = this->TriangleList;
-  while ( triPtr )
+  vtkUnstructuredGridBunykRayCastFunctionInternals *internals =
+    this->Internals;
+  vtkIdType numBoundary =
+    static_cast<vtkIdType>(internals->Boundary.size() / 2);
+  if ( numBoundary == 0 )
     {
-    if ( triPtr->ReferredByTetra[1] == -1 )
-      {
-      if ( this->IsTriangleFrontFacing( triPtr, triPtr->ReferredByTetra[0] ) )
-        {
-        int   minX = static_cast<int>(this->Points[3*triPtr->PointIndex[0]]);
-        int   maxX = minX+1;
-        int   minY = static_cast<int>(this->Points[3*triPtr->PointIndex[0]+1]);
-        int   maxY = minY+1;
-
-        int tmp;
-
-        tmp = static_cast<int>(this->Points[3*triPtr->PointIndex[1]]);
-        minX = (tmp<minX)?(tmp):(minX);
-        maxX = ((tmp+1)>maxX)?(tmp+1):(maxX);
-
-        tmp = static_cast<int>(this->Points[3*triPtr->PointIndex[1]+1]);
-        minY = (tmp<minY)?(tmp):(minY);
-        maxY = ((tmp+1)>maxY)?(tmp+1):(maxY);
-
-        tmp = static_cast<int>(this->Points[3*triPtr->PointIndex[2]]);
-        minX = (tmp<minX)?(tmp):(minX);
-        maxX = ((tmp+1)>maxX)?(tmp+1):(maxX);
-
-        tmp = static_cast<int>(this->Points[3*triPtr->PointIndex[2]+1]);
-        minY = (tmp<minY)?(tmp):(minY);
-        maxY = ((tmp+1)>maxY)?(tmp+1):(maxY);
-
-        double minZ = this->Points[3*triPtr->PointIndex[0]+2];
-        double ftmp;
-
-        ftmp = this->Points[3*triPtr->PointIndex[1]+2];
-        minZ = (ftmp<minZ)?(ftmp):(minZ);
-
-        ftmp = this->Points[3*triPtr->PointIndex[2]+2];
-        minZ = (ftmp<minZ)?(ftmp):(minZ);
-
-        if ( minX < this->ImageSize[0] - 1 &&
-             minY < this->ImageSize[1] - 1 &&
-             maxX >= 0 && maxY >= 0 && minZ > 0.0 )
-          {
-          minX = (minX<0)?(0):(minX);
-          maxX = (maxX>(this->ImageSize[0]-1))?(this->ImageSize[0]-1):(maxX);
-
-          minY = (minY<0)?(0):(minY);
-          maxY = (maxY>(this->ImageSize[1]-1))?(this->ImageSize[1]-1):(maxY);
-
-          int x, y;
-          double ax, ay, az;
-          ax = this->Points[3*triPtr->PointIndex[0]];
-          ay = this->Points[3*triPtr->PointIndex[0]+1];
-          az = this->Points[3*triPtr->PointIndex[0]+2];
+    return;
+    }
 
-          for ( y = minY; y <= maxY; y++ )
-            {
-            double qy = (double)y - ay;
-            for ( x = minX; x <= maxX; x++ )
-              {
-              double qx = (double)x - ax;
-              if ( this->InTriangle( qx, qy, triPtr ) )
-                {
-                Intersection *intersect = (Intersection *)this->NewIntersection();
-                if ( intersect )
-                  {
-                  intersect->TriPtr = triPtr;
-                  intersect->Z      = az;
-                  intersect->Next   = NULL;
-
-                  if ( !this->Image[y*this->ImageSize[0] + x] ||
-                       intersect->Z < this->Image[y*this->ImageSize[0] + x]->Z )
-                    {
-                    intersect->Next = this->Image[y*this->ImageSize[0] + x];
-                    this->Image[y*this->ImageSize[0] + x] = intersect;
-                    }
-                  else
-                    {
-                    Intersection *test = this->Image[y*this->ImageSize[0] + x];
-                    while ( test->Next && intersect->Z > test->Next->Z )
-                      {
-                      test = test->Next;
-                      }
-                    Intersection *tmpNext = test->Next;
-                    test->Next = intersect;
-                    intersect->Next = tmpNext;
-                    }
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
-    triPtr = triPtr->Next;
+  // Find the pixels the front facing boundary triangles may cover
+  internals->Boxes.resize(4*numBoundary);
+  BoundaryBoxesFunctor boxes;
+  boxes.Triangles = this->TriangleList;
+  boxes.Boundary = &internals->Boundary[0];
+  boxes.Points = this->Points;
+  boxes.ImageSize[0] = this->ImageSize[0];
+  boxes.ImageSize[1] = this->ImageSize[1];
+  boxes.Boxes = &internals->Boxes[0];
+  vtkSMPTools::For(0, numBoundary, boxes);
+
+  // Then rasterize them band by band, each band with its own memory
+  int numBands = (this->ImageSize[1] + BandHeight - 1) / BandHeight;
+  if ( numBands == 0 )
+    {
+    return;
     }
+  while ( static_cast<int>(internals->Pools.size()) < numBands )
+    {
+    internals->Pools.push_back(new IntersectionPool);
+    }
+  BandBins bandBins;
+  bandBins.Boxes = &internals->Boxes[0];
+  BinItems(bandBins, numBoundary, numBands,
+           internals->BandOffsets, internals->BandItems);
+
+  RasterizeFunctor rasterize;
+  rasterize.Self = this;
+  rasterize.Triangles = this->TriangleList;
+  rasterize.Boundary = &internals->Boundary[0];
+  rasterize.Boxes = &internals->Boxes[0];
+  rasterize.Points = this->Points;
+  rasterize.BandOffsets = &internals->BandOffsets[0];
+  rasterize.BandItems =
+    (internals->BandItems.empty() ? NULL : &internals->BandItems[0]);
+  rasterize.Pools = &internals->Pools[0];
+  rasterize.Image = this->Image;
+  rasterize.ImageWidth = this->ImageSize[0];
+  vtkSMPTools::For(0, numBands, 1, rasterize);
 }
 
 // Taken from equation on bottom of left column of page 3 - but note that the
@@ -877,36 +1420,6 @@ int  vtkUnstructuredGridBunykRayCastFunction::InTriangle( double x, double y, Tr
     }
 }
 
-int  vtkUnstructuredGridBunykRayCastFunction::IsTriangleFrontFacing( Triangle *triPtr, vtkIdType tetraIndex )
-{
-  vtkCell *cell = this->Mapper->GetInput()->GetCell(tetraIndex);
-
-  vtkIdType pts[4];
-  pts[0] = cell->GetPointId(0);
-  pts[1] = cell->GetPointId(1);
-  pts[2] = cell->GetPointId(2);
-  pts[3] = cell->GetPointId(3);
-
-  int i;
-  for( i = 0; i < 4; i++ )
-    {
-    if ( pts[i] != triPtr->PointIndex[0] &&
-         pts[i] != triPtr->PointIndex[1] &&
-         pts[i] != triPtr->PointIndex[2] )
-      {
-      break;
-      }
-    }
-
-  double d =
-    triPtr->A*this->Points[3*pts[i]] +
-    triPtr->B*this->Points[3*pts[i]+1] +
-    triPtr->C*this->Points[3*pts[i]+2] +
-    triPtr->D;
-
-  return (d>0);
-}
-
 template <class T, class ScalarIterator>
 vtkIdType TemplateCastRay(
   const ScalarIterator scalars,
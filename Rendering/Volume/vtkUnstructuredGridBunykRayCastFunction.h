@@ -45,12 +45,23 @@
 //      add this to the sorted (by depth) intersection list at each
 //      pixel.
 //
+// Enumerating the triangles and the per render precomputation of steps 3
+// and 4 are done in parallel with vtkSMPTools: the faces of the tetra are
+// matched by sorting them in buckets, and the intersection lists are built
+// in bands of rows of the image, each with its own memory.
+//
 //   5) For each ray cast, traverse the intersection list. At each
 //      intersection, accumulate opacity and color contribution
 //      per tetra along the ray until you reach an exiting triangle
 //      (on the boundary).
 //
 
+// .SECTION Caveats
+// The protected NewIntersection(), IsTriangleFrontFacing(),
+// IntersectionBuffer and IntersectionBufferCount are deprecated, and
+// are no longer used to build the intersection lists.  Subclasses that
+// use them should walk the lists of Image instead.
+
 // .SECTION See Also
 // vtkUnstructuredGridVolumeRayCastMapper
 
@@ -70,10 +81,12 @@ class vtkUnstructuredGridBase;
 class vtkIdList;
 class vtkDoubleArray;
 class vtkDataArray;
+class vtkUnstructuredGridBunykRayCastFunctionInternals;
 
 // We manage the memory for the list of intersections ourself - this is the
-// storage used. We keep 10,000 elements in each array, and we can have up to
-// 1,000 arrays.
+// storage used. Each band of rows of the image allocates arrays of 10,000
+// elements as it needs them, so the number of arrays is no longer limited.
+// VTK_BUNYKRCF_MAX_ARRAYS is kept for the deprecated IntersectionBuffer.
 #define VTK_BUNYKRCF_MAX_ARRAYS 10000
 #define VTK_BUNYKRCF_ARRAY_SIZE 10000
 
@@ -206,29 +219,43 @@ protected:
   Triangle **TetraTriangles;
   vtkIdType TetraTrianglesSize;
 
+  // The triangles are allocated in one array, and linked in the
+  // order of the array.
   Triangle  *TriangleList;
+  vtkIdType  NumberOfTriangles;
 
   // Compute whether a boundary triangle is front facing by
   // looking at the fourth point in the tetra to see if it is
   // in front (triangle is backfacing) or behind (triangle is
-  // front facing) the plane containing the triangle.
-  int  IsTriangleFrontFacing( Triangle *triPtr, vtkIdType tetraIndex );
+  // front facing) the plane containing the triangle.  This is no
+  // longer used: the boundary triangles are oriented as they are found.
+  VTK_LEGACY(int IsTriangleFrontFacing( Triangle *triPtr, vtkIdType tetraIndex ));
 
   // The image contains lists of intersections per pixel - we
   // need to clear this during the initialization phase for each
   // render.
   void ClearImage();
 
-  // This is the memory buffer used to build the intersection
+  // This holds the boundary triangles with the fourth point of their
+  // tetra, and the memory buffers used to build the intersection
   // lists. We do our own memory management here because allocating
   // a bunch of small elements during rendering is too slow.
+  vtkUnstructuredGridBunykRayCastFunctionInternals *Internals;
+
+#ifndef VTK_LEGACY_REMOVE
+  // The memory buffers of the intersections returned by
+  // NewIntersection().  These are deprecated along with it, and are
+  // removed with the legacy code: the intersection lists built for
+  // rendering no longer use them.
   Intersection *IntersectionBuffer[VTK_BUNYKRCF_MAX_ARRAYS];
   int           IntersectionBufferCount[VTK_BUNYKRCF_MAX_ARRAYS];
+#endif
 
   // This method replaces new for creating a new element - it
-  // returns one from the big block already allocated (it
-  // allocates another big block if necessary)
-  void         *NewIntersection();
+  // returns one from the IntersectionBuffer arrays, which are
+  // reused when the image is cleared.  This is no longer used:
+  // each band allocates its own intersections.
+  VTK_LEGACY(void *NewIntersection());
 
   // This method is used during the initialization process to
   // check the validity of the objects - missing information
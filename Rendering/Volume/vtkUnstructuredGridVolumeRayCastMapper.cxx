@@ -63,6 +63,7 @@ vtkUnstructuredGridVolumeRayCastMapper::vtkUnstructuredGridVolumeRayCastMapper()
 
   this->Threader               = vtkMultiThreader::New();
   this->NumberOfThreads        = this->Threader->GetNumberOfThreads();
+  this->TileSize               = 16;
 
   this->Image                  = NULL;
 
@@ -436,7 +437,9 @@ void vtkUnstructuredGridVolumeRayCastMapper::Render( vtkRenderer *ren, vtkVolume
     }
 
   // Set the number of threads to use for ray casting,
-  // then set the execution method and do it.
+  // then set the execution method and do it. The threads take the
+  // tiles of the image from the first one.
+  this->NextTile = 0;
   this->Threader->SetNumberOfThreads( this->NumberOfThreads );
   this->Threader->SetSingleMethod( UnstructuredGridVolumeRayCastMapper_CastRays,
                                    (void *)this);
@@ -550,16 +553,23 @@ void vtkUnstructuredGridVolumeRayCastMapper::CastRays( int threadID, int threadC
   vtkDataArray *nearIntersections = this->NearIntersectionsBuffer[threadID];
   vtkDataArray *farIntersections = this->FarIntersectionsBuffer[threadID];
 
-  for ( j = 0; j < this->ImageInUseSize[1]; j++ )
+  // Take the tiles one at a time until none is left
+  int tileSize = this->TileSize;
+  int tilesX = (this->ImageInUseSize[0] + tileSize - 1) / tileSize;
+  int tilesY = (this->ImageInUseSize[1] + tileSize - 1) / tileSize;
+  int numTiles = tilesX * tilesY;
+
+  for (;;)
     {
-    if ( j%threadCount != threadID )
+    int tile = ++this->NextTile - 1;
+    if ( tile >= numTiles )
       {
-      continue;
+      break;
       }
 
     if ( !threadID )
       {
-      this->UpdateProgress((double)j/this->ImageInUseSize[1]);
+      this->UpdateProgress((double)tile/numTiles);
       if ( renWin->CheckAbortStatus() )
         {
         break;
@@ -570,92 +580,103 @@ void vtkUnstructuredGridVolumeRayCastMapper::CastRays( int threadID, int threadC
       break;
       }
 
-    ucptr = this->Image + 4*j*this->ImageMemorySize[0];
+    int tileX = (tile % tilesX) * tileSize;
+    int tileY = (tile / tilesX) * tileSize;
+    int endX = tileX + tileSize;
+    int endY = tileY + tileSize;
+    endX = (endX > this->ImageInUseSize[0])?(this->ImageInUseSize[0]):(endX);
+    endY = (endY > this->ImageInUseSize[1])?(this->ImageInUseSize[1]):(endY);
 
-    for ( i = 0; i < this->ImageInUseSize[0]; i++ )
+    for ( j = tileY; j < endY; j++ )
       {
-      int x = i + this->ImageOrigin[0];
-      int y = j + this->ImageOrigin[1];
+      ucptr = this->Image + 4*(j*this->ImageMemorySize[0] + tileX);
 
-      double bounds[2] = {0.0,1.0};
-      float color[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-
-      if ( this->ZBuffer )
+      for ( i = tileX; i < endX; i++ )
         {
-        bounds[1] = this->GetZBufferValue( x, y );
-        }
+        int x = i + this->ImageOrigin[0];
+        int y = j + this->ImageOrigin[1];
 
-      iterator->SetBounds(bounds);
-      iterator->Initialize(x, y);
+        double bounds[2] = {0.0,1.0};
+        float color[4] = {0.0f, 0.0f, 0.0f, 0.0f};
 
-      vtkIdType numIntersections;
-      do
-        {
-        if (this->CellScalars)
+        if ( this->ZBuffer )
+          {
+          bounds[1] = this->GetZBufferValue( x, y );
+          }
+
+        iterator->SetBounds(bounds);
+        iterator->Initialize(x, y);
+
+        vtkIdType numIntersections;
+        do
           {
-          numIntersections = iterator->GetNextIntersections(intersectedCells,
-                                                            intersectionLengths,
-                                                            NULL,
-                                                            NULL, NULL);
-          nearIntersections
-            ->SetNumberOfComponents(this->Scalars->GetNumberOfComponents());
-          nearIntersections->SetNumberOfTuples(numIntersections);
-          switch (this->Scalars->GetDataType())
+          if (this->CellScalars)
+            {
+            numIntersections
+              = iterator->GetNextIntersections(intersectedCells,
+                                               intersectionLengths,
+                                               NULL, NULL, NULL);
+            nearIntersections
+              ->SetNumberOfComponents(this->Scalars->GetNumberOfComponents());
+            nearIntersections->SetNumberOfTuples(numIntersections);
+            switch (this->Scalars->GetDataType())
+              {
+              vtkTemplateMacro(vtkUGVRCMLookupCopy
+                (static_cast<const VTK_TT*>(this->Scalars->GetVoidPointer(0)),
+                 static_cast<VTK_TT*>(nearIntersections->GetVoidPointer(0)),
+                 intersectedCells->GetPointer(0),
+                 this->Scalars->GetNumberOfComponents(),
+                 numIntersections));
+              }
+            }
+          else
             {
-            vtkTemplateMacro(vtkUGVRCMLookupCopy
-                             ((const VTK_TT*)this->Scalars->GetVoidPointer(0),
-                              (VTK_TT*)nearIntersections->GetVoidPointer(0),
-                              intersectedCells->GetPointer(0),
-                              this->Scalars->GetNumberOfComponents(),
-                              numIntersections));
+            numIntersections
+              = iterator->GetNextIntersections(NULL,
+                                               intersectionLengths,
+                                               this->Scalars,
+                                               nearIntersections,
+                                               farIntersections);
             }
+          if (numIntersections < 1) break;
+          this->RealRayIntegrator->Integrate(intersectionLengths,
+                                             nearIntersections,
+                                             farIntersections,
+                                             color);
+          } while (color[3] < 0.99);
+
+        if ( color[3] > 0.0 )
+          {
+          int val;
+          val = static_cast<int>(color[0]*255.0);
+          val = (val > 255)?(255):(val);
+          val = (val <   0)?(  0):(val);
+          ucptr[0] = static_cast<unsigned char>(val);
+
+          val = static_cast<int>(color[1]*255.0);
+          val = (val > 255)?(255):(val);
+          val = (val <   0)?(  0):(val);
+          ucptr[1] = static_cast<unsigned char>(val);
+
+          val = static_cast<int>(color[2]*255.0);
+          val = (val > 255)?(255):(val);
+          val = (val <   0)?(  0):(val);
+          ucptr[2] = static_cast<unsigned char>(val);
+
+          val = static_cast<int>(color[3]*255.0);
+          val = (val > 255)?(255):(val);
+          val = (val <   0)?(  0):(val);
+          ucptr[3] = static_cast<unsigned char>(val);
           }
         else
           {
-          numIntersections = iterator->GetNextIntersections(NULL,
-                                                            intersectionLengths,
-                                                            this->Scalars,
-                                                            nearIntersections,
-                                                            farIntersections);
+          ucptr[0] = 0;
+          ucptr[1] = 0;
+          ucptr[2] = 0;
+          ucptr[3] = 0;
           }
-        if (numIntersections < 1) break;
-        this->RealRayIntegrator->Integrate(intersectionLengths,
-                                           nearIntersections,
-                                           farIntersections,
-                                           color);
-        } while (color[3] < 0.99);
-
-      if ( color[3] > 0.0 )
-        {
-        int val;
-        val = static_cast<int>(color[0]*255.0);
-        val = (val > 255)?(255):(val);
-        val = (val <   0)?(  0):(val);
-        ucptr[0] = static_cast<unsigned char>(val);
-
-        val = static_cast<int>(color[1]*255.0);
-        val = (val > 255)?(255):(val);
-        val = (val <   0)?(  0):(val);
-        ucptr[1] = static_cast<unsigned char>(val);
-
-        val = static_cast<int>(color[2]*255.0);
-        val = (val > 255)?(255):(val);
-        val = (val <   0)?(  0):(val);
-        ucptr[2] = static_cast<unsigned char>(val);
-
-        val = static_cast<int>(color[3]*255.0);
-        val = (val > 255)?(255):(val);
-        val = (val <   0)?(  0):(val);
-        ucptr[3] = static_cast<unsigned char>(val);
-        }
-      else
-        {
-        ucptr[0] = 0;
-        ucptr[1] = 0;
-        ucptr[2] = 0;
-        ucptr[3] = 0;
+        ucptr+=4;
         }
-      ucptr+=4;
       }
     }
 }
@@ -739,6 +760,7 @@ void vtkUnstructuredGridVolumeRayCastMapper::PrintSelf(ostream& os, vtkIndent in
     << (this->IntermixIntersectingGeometry ? "On\n" : "Off\n");
 
   os << indent << "Number Of Threads: " << this->NumberOfThreads << "\n";
+  os << indent << "Tile Size: " << this->TileSize << "\n";
 
   if (this->RayCastFunction)
     {
@@ -25,6 +25,7 @@
 
 #include "vtkRenderingVolumeModule.h" // For export macro
 #include "vtkUnstructuredGridVolumeMapper.h"
+#include "vtkAtomicInt.h" // For NextTile
 
 class vtkDoubleArray;
 class vtkIdList;
@@ -78,6 +79,14 @@ public:
   vtkSetMacro( NumberOfThreads, int );
   vtkGetMacro( NumberOfThreads, int );
 
+  // Description:
+  // Set/Get the size, in pixels, of the square tiles the image is cut
+  // into. Each thread casts the rays of one tile at a time and takes the
+  // next tile left when done, so that threads finishing cheap tiles go on
+  // with the rest instead of waiting. The default is 16.
+  vtkSetClampMacro( TileSize, int, 1, 1024 );
+  vtkGetMacro( TileSize, int );
+
   // Description:
   // If IntermixIntersectingGeometry is turned on, the zbuffer will be
   // captured and used to limit the traversal of the rays.
@@ -129,6 +138,12 @@ protected:
   vtkMultiThreader  *Threader;
   int               NumberOfThreads;
 
+  // The tiles of the image are taken in order by the threads
+  int                       TileSize;
+//BTX
+  vtkAtomicInt<vtkTypeInt32> NextTile;
+//ETX
+
   vtkRayCastImageDisplayHelper *ImageDisplayHelper;
 
   // This is how big the image would be if it covered the entire viewport